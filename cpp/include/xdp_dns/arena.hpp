@@ -0,0 +1,76 @@
+#pragma once
+
+#include "common.hpp"
+#include <memory_resource>
+
+namespace xdp_dns {
+
+class CountingResource;
+
+// Arena 选项
+struct ArenaOptions {
+    bool enabled = true;                     // false: 逐个 malloc/free
+    bool huge_pages = false;                 // 2MB 大页 (MAP_HUGETLB, 失败时回退到 THP)
+    size_t huge_min_chunk = 2 * 1024 * 1024; // 块达到此大小才用大页, 小 Trie 不独占 2MB
+    size_t initial_chunk = 64 * 1024;        // 首个块大小, 之后每次翻倍
+    size_t max_chunk = 2 * 1024 * 1024;      // 块大小上限
+    int numa_node = -1;                      // 块优先放置的 NUMA 节点, -1 不绑定
+    bool numa_replicas = false;              // Trie 每个 NUMA 节点一份只读副本 (单节点主机忽略)
+};
+
+// 进程默认 Arena 选项 (DomainTrie / FilterEngine 的默认构造使用)
+ArenaOptions defaultArenaOptions();
+void setDefaultArenaOptions(const ArenaOptions& opts);
+
+constexpr size_t kHugePageSize = 2 * 1024 * 1024;
+
+// 单调 Arena - 从 mmap 块中顺序分配, deallocate 为空操作, 析构时整体释放
+//
+// 非线程安全: 由持有者的锁保护 (Trie 写锁 / 构建中的私有代).
+// 映射的字节数计入 account 的实际占用, 用于计算碎片率.
+class Arena : public std::pmr::memory_resource {
+public:
+    explicit Arena(const ArenaOptions& opts, CountingResource* account = nullptr);
+    ~Arena() override;
+
+    Arena(const Arena&) = delete;
+    Arena& operator=(const Arena&) = delete;
+
+    // 释放所有块
+    void release();
+
+    size_t reserved() const { return reserved_; }         // 已映射字节
+    size_t used() const { return used_; }                 // 已分配字节
+    size_t hugePageBytes() const { return huge_bytes_; }  // 其中由大页支撑的字节
+
+private:
+    struct Chunk {
+        Chunk* next;
+        size_t size;
+    };
+
+    void* do_allocate(size_t bytes, size_t alignment) override;
+    void do_deallocate(void* p, size_t bytes, size_t alignment) override {}
+    bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override {
+        return this == &other;
+    }
+
+    void newChunk(size_t min_bytes);
+
+    ArenaOptions opts_;
+    CountingResource* account_;
+    Chunk* chunks_ = nullptr;
+    uintptr_t cur_ = 0;
+    uintptr_t end_ = 0;
+    size_t next_chunk_;
+    size_t reserved_ = 0;
+    size_t used_ = 0;
+    size_t huge_bytes_ = 0;
+};
+
+// 映射 size 字节的匿名内存 (huge_pages 时按 2MB 对齐), 失败返回 nullptr
+// *is_huge 输出是否由 hugetlbfs 大页支撑; numa_node >= 0 时在首次访问前 mbind 到该节点
+void* mapPages(size_t size, bool huge_pages, bool* is_huge, int numa_node = -1);
+void unmapPages(void* p, size_t size);
+
+} // namespace xdp_dns
@@ -18,6 +18,22 @@ typedef enum {
     XDP_DNS_ACTION_LOG = 3
 } XDPDNSAction;
 
+// 阻断规则的应答方式 (与 xdp_dns::BlockMode 一致)
+typedef enum {
+    XDP_DNS_BLOCK_NXDOMAIN = 0,     // NXDOMAIN + 合成 SOA
+    XDP_DNS_BLOCK_NODATA = 1,       // NOERROR 空回答 + 合成 SOA
+    XDP_DNS_BLOCK_REFUSED = 2,
+    XDP_DNS_BLOCK_NULL_ADDRESS = 3, // 0.0.0.0 / ::
+    XDP_DNS_BLOCK_DROP = 4          // 不应答, 数据面返回 XDP_DROP
+} XDPDNSBlockMode;
+
+// ANY 查询策略 (RuleSet YAML 顶层键 any_policy, RFC 8482)
+typedef enum {
+    XDP_DNS_ANY_FORWARD = 0,        // 原样转发上游
+    XDP_DNS_ANY_HINFO = 1,          // 合成最小 HINFO 回答
+    XDP_DNS_ANY_TRUNCATE = 2        // 空回答并置 TC=1
+} XDPDNSAnyPolicy;
+
 // DNS 查询类型
 typedef enum {
     XDP_DNS_TYPE_A = 1,
@@ -27,7 +43,9 @@ typedef enum {
     XDP_DNS_TYPE_TXT = 16,
     XDP_DNS_TYPE_NS = 2,
     XDP_DNS_TYPE_SOA = 6,
-    XDP_DNS_TYPE_PTR = 12
+    XDP_DNS_TYPE_PTR = 12,
+    XDP_DNS_TYPE_HINFO = 13,
+    XDP_DNS_TYPE_ANY = 255
 } XDPDNSType;
 
 // DNS 解析结果 (传递给 Go 进行匹配)
@@ -51,9 +69,25 @@ typedef struct {
     uint64_t packets_redirected;
     uint64_t parse_errors;
     uint64_t response_built;
-    uint64_t total_latency_ns;
+    uint64_t sampled_latency_ns;    // 采样包的解析延迟之和, 不是全部包的总和
+    uint64_t latency_samples;       // 采样包数 (每线程每 64 个包采一个)
 } XDPDNSStats;
 
+// 内存占用 (进程内所有 Trie / FilterEngine 之和)
+typedef struct {
+    uint64_t node_bytes;            // TrieNode 对象
+    uint64_t label_bytes;           // 标签字节
+    uint64_t rule_bytes;            // Rule 对象及存储数组
+    uint64_t cache_bytes;           // 缓存
+    uint64_t index_bytes;           // 子节点表等辅助索引
+    uint64_t total_bytes;           // 以上之和 (请求字节)
+    uint64_t reserved_bytes;        // 实际占用 (含分配器开销)
+    uint64_t allocations;           // 存活分配次数
+    uint64_t rule_count;
+    double   bytes_per_rule;        // reserved_bytes / rule_count
+    double   fragmentation;         // 1 - total_bytes / reserved_bytes
+} XDPDNSMemoryStats;
+
 // 错误码
 typedef enum {
     XDP_DNS_OK = 0,
@@ -62,12 +96,16 @@ typedef enum {
     XDP_DNS_ERR_BUFFER_TOO_SMALL = -3,
     XDP_DNS_ERR_NOT_INITIALIZED = -4,
     XDP_DNS_ERR_NOT_DNS_QUERY = -5,
+    XDP_DNS_ERR_SYSTEM = -6,            // 系统调用失败 (shm_open/mmap 等)
+    XDP_DNS_ERR_INVALID_RULES = -7,     // 规则 YAML 无法解析或规则文件不可读
 } XDPDNSError;
 
 // ==================== 初始化/清理 ====================
 
 /**
  * 初始化 XDP DNS 核心库
+ *
+ * 同时按 CPU 选定 SIMD 内核 (可用环境变量 XDP_DNS_SIMD 限制级别)
  * @return 0 成功，负值错误
  */
 int xdp_dns_init(void);
@@ -77,6 +115,12 @@ int xdp_dns_init(void);
  */
 void xdp_dns_cleanup(void);
 
+/**
+ * 获取选定的 SIMD 内核级别
+ * @return "scalar" / "sse4.2" / "avx2" / "avx512"
+ */
+const char* xdp_dns_simd_level(void);
+
 // ==================== DNS 解析 (C++ 高性能实现) ====================
 
 /**
@@ -95,7 +139,76 @@ int xdp_dns_parse(
     XDPDNSParseResult* result
 );
 
+// ==================== 帧解析 (L2-L4) ====================
+//
+// 从以太网帧定位 DNS 负载: 802.1Q / QinQ、IPv4 选项、IPv6 扩展头与分片.
+// 结果只有偏移与原始地址, 不分配内存.
+
+// flags 取值
+#define XDP_DNS_FRAME_VLAN        0x01
+#define XDP_DNS_FRAME_QINQ        0x02
+#define XDP_DNS_FRAME_IPV6        0x04
+#define XDP_DNS_FRAME_IP_OPTIONS  0x08
+#define XDP_DNS_FRAME_IPV6_EXT    0x10
+#define XDP_DNS_FRAME_FRAGMENT    0x20   // 首个分片, DNS 负载不完整
+
+// 帧解析结果 (64 字节, 与 C++ FrameInfo 一致)
+typedef struct {
+    uint16_t l3_offset;
+    uint16_t l4_offset;
+    uint16_t payload_offset;        // DNS 消息在帧中的偏移
+    uint16_t payload_len;
+    uint16_t src_port;              // 主机字节序
+    uint16_t dst_port;
+    uint16_t vlan_tci[2];           // 外层在前
+    uint8_t  num_vlans;
+    uint8_t  ip_version;            // 4 或 6
+    uint8_t  flags;                 // XDP_DNS_FRAME_*
+    uint8_t  hop_limit;
+    uint8_t  src_mac[6];
+    uint8_t  dst_mac[6];
+    uint8_t  src_addr[16];          // 网络字节序, IPv4 只用前 4 字节
+    uint8_t  dst_addr[16];
+} XDPDNSFrameInfo;
+
+// RX 描述符 (与 struct xdp_desc 布局一致)
+typedef struct {
+    uint64_t addr;                  // 相对 UMEM 起始的偏移
+    uint32_t len;
+    uint32_t options;
+} XDPDNSFrameDesc;
+
+/**
+ * 解析单个以太网帧
+ *
+ * @return 0 成功; XDP_DNS_ERR_PARSE_FAILED 非 UDP、非首个分片或头部损坏
+ */
+int xdp_dns_parse_frame(const uint8_t* frame, size_t len, XDPDNSFrameInfo* info);
+
+/**
+ * 批量解析 UMEM 中的一批 RX 帧 (整批一次 cgo 调用)
+ *
+ * @param umem      UMEM 起始地址
+ * @param umem_len  UMEM 字节数, 越界的描述符视为解析失败
+ * @param descs     RX 描述符
+ * @param count     描述符数, 不超过 64
+ * @param out       至少 count 个元素
+ * @param ok_mask   第 i 位为 1 表示 descs[i] 解析成功
+ * @return 0 成功, XDP_DNS_ERR_INVALID_PARAM 参数错误
+ */
+int xdp_dns_parse_frames(
+    const uint8_t* umem,
+    size_t umem_len,
+    const XDPDNSFrameDesc* descs,
+    size_t count,
+    XDPDNSFrameInfo* out,
+    uint64_t* ok_mask
+);
+
 // ==================== 响应构建 (C++ 高性能实现) ====================
+//
+// response_buf 由调用者提供, 可以直接是 AF_XDP TX 帧; 也可以与 original_packet
+// 指向同一缓冲区, 在 RX 帧上原地改写 (缓冲区需容纳追加的回答记录).
 
 /**
  * 构建 NXDOMAIN 响应
@@ -159,6 +272,72 @@ int xdp_dns_build_aaaa_response(
     size_t* response_len
 );
 
+/**
+ * 构建带合成 SOA 的 NXDOMAIN 响应 (RFC 2308 否定缓存)
+ *
+ * SOA 所有者为 QNAME 的父域, TTL 与 MINIMUM 均为 negative_ttl.
+ * response_buf 需比查询多 59 字节 (EDNS OPT 不保留).
+ *
+ * @param negative_ttl     下游否定缓存时长 (秒)
+ * @return 0 成功
+ */
+int xdp_dns_build_nxdomain_soa(
+    const uint8_t* original_packet,
+    size_t original_len,
+    uint32_t negative_ttl,
+    uint8_t* response_buf,
+    size_t response_buf_size,
+    size_t* response_len
+);
+
+/**
+ * 构建带合成 SOA 的 NODATA 响应 (NOERROR, 无回答)
+ *
+ * 参数与 xdp_dns_build_nxdomain_soa 相同.
+ */
+int xdp_dns_build_nodata(
+    const uint8_t* original_packet,
+    size_t original_len,
+    uint32_t negative_ttl,
+    uint8_t* response_buf,
+    size_t response_buf_size,
+    size_t* response_len
+);
+
+/**
+ * 构建 REFUSED 响应 (只含问题部分)
+ *
+ * @return 0 成功
+ */
+int xdp_dns_build_refused(
+    const uint8_t* original_packet,
+    size_t original_len,
+    uint8_t* response_buf,
+    size_t response_buf_size,
+    size_t* response_len
+);
+
+/**
+ * 按阻断规则的应答方式构建响应 (XDPDNSCheckResult.block_mode)
+ *
+ * XDP_DNS_BLOCK_DROP 返回 0 且 *response_len = 0, 调用者丢弃查询.
+ *
+ * @param block_mode       XDPDNSBlockMode
+ * @param ttl              XDP_DNS_BLOCK_NULL_ADDRESS 回答的 TTL
+ * @param negative_ttl     合成 SOA 的 TTL
+ * @return 0 成功
+ */
+int xdp_dns_build_blocked(
+    const uint8_t* original_packet,
+    size_t original_len,
+    uint8_t block_mode,
+    uint32_t ttl,
+    uint32_t negative_ttl,
+    uint8_t* response_buf,
+    size_t response_buf_size,
+    size_t* response_len
+);
+
 // ==================== 统计信息 ====================
 
 /**
@@ -171,6 +350,472 @@ void xdp_dns_get_stats(XDPDNSStats* stats);
  */
 void xdp_dns_reset_stats(void);
 
+/**
+ * 获取内存占用统计
+ */
+void xdp_dns_get_memory_stats(XDPDNSMemoryStats* stats);
+
+/**
+ * 设置之后新建的 Trie / 过滤引擎使用的内存放置选项
+ *
+ * @param huge_pages  非 0: 使用 2MB 大页 (MAP_HUGETLB, 失败时回退到 THP)
+ * @param numa_node   内存优先放置的 NUMA 节点, -1 不绑定
+ * @return 0 成功，XDP_DNS_ERR_INVALID_PARAM 节点不存在
+ */
+int xdp_dns_set_memory_options(int huge_pages, int numa_node);
+
+/**
+ * 设置之后新建的 Trie 是否在每个 NUMA 节点保留一份只读副本
+ *
+ * 单节点主机上无效果。副本随规则更新一起原子发布，查询读取本节点副本。
+ *
+ * @param enabled  非 0: 启用
+ */
+void xdp_dns_set_numa_replicas(int enabled);
+
+/**
+ * 查询网卡所在的 NUMA 节点
+ *
+ * @param ifname  网卡名
+ * @return 节点号，未知返回 -1
+ */
+int xdp_dns_netdev_numa_node(const char* ifname);
+
+// ==================== 共享内存统计 ====================
+
+/**
+ * 创建共享内存统计区并启动后台发布线程
+ *
+ * 布局见 stats_shm.h, 读端 mmap 后无需 cgo 即可读取.
+ * 重复调用时沿用已创建的区域.
+ *
+ * @param name         共享内存对象名 (如 "/xdp_dns_stats"), NULL 使用默认名
+ * @param interval_ms  发布间隔 (毫秒, > 0)
+ * @return 0 成功，负值错误
+ */
+int xdp_dns_stats_shm_start(const char* name, uint32_t interval_ms);
+
+/**
+ * 停止发布并删除共享内存对象
+ */
+void xdp_dns_stats_shm_stop(void);
+
+/**
+ * 立即发布一次快照 (不等待发布间隔)
+ * @return 0 成功，XDP_DNS_ERR_NOT_INITIALIZED 未启动
+ */
+int xdp_dns_stats_shm_publish(void);
+
+/**
+ * 更新规则代数信息 (规则重载后由控制面调用)
+ *
+ * @param generation  规则代数
+ * @param rule_count  当前规则数
+ */
+void xdp_dns_stats_set_rule_info(uint64_t generation, uint64_t rule_count);
+
+// ==================== 过滤引擎 ====================
+//
+// 每个句柄持有一个独立的 C++ FilterEngine, 同一进程可创建多个 (如 A/B 规则集).
+// 同一句柄上的 check 与规则增删改可在不同线程并发调用; 整体替换 (load /
+// update) 在锁外构建新引擎, 只在指针交换时短暂阻塞 check.
+
+// 过滤引擎句柄 (不透明)
+typedef struct XDPDNSEngine XDPDNSEngine;
+
+// 引擎内存选项
+typedef struct {
+    int huge_pages;                 // 非 0: 2MB 大页
+    int numa_node;                  // 优先放置的 NUMA 节点, -1 不绑定
+    int numa_replicas;              // 非 0: 每个 NUMA 节点一份 Trie 副本
+} XDPDNSEngineOptions;
+
+// 规则 (批量增删改的元素)
+typedef struct {
+    char     domain[256];           // "example.com" 或 "*.example.com", NUL 结尾
+    uint32_t id;
+    uint8_t  action;                // XDPDNSAction
+    uint8_t  block_mode;            // XDPDNSBlockMode, 仅对 XDP_DNS_ACTION_BLOCK 有效
+    uint32_t redirect_ip;           // 网络字节序
+    uint32_t ttl;
+    char     rule_id[32];
+} XDPDNSRule;
+
+// 匹配结果
+typedef struct {
+    uint8_t  action;                // XDPDNSAction, 未命中为 XDP_DNS_ACTION_ALLOW
+    uint8_t  matched;               // 1: 命中规则, 以下字段有效
+    uint8_t  block_mode;            // XDPDNSBlockMode
+    uint32_t id;
+    uint32_t redirect_ip;
+    uint32_t ttl;
+    char     rule_id[32];
+} XDPDNSCheckResult;
+
+// 引擎统计 (含已被 load / update 替换掉的规则集)
+typedef struct {
+    uint64_t total_checks;
+    uint64_t allowed;
+    uint64_t blocked;
+    uint64_t redirected;
+    uint64_t logged;
+    uint64_t rule_count;            // 当前规则数
+} XDPDNSEngineStats;
+
+/**
+ * 创建过滤引擎
+ *
+ * @param opts  内存选项, NULL 使用 xdp_dns_set_memory_options 设置的进程默认值
+ * @return 句柄, 参数无效时返回 NULL
+ */
+XDPDNSEngine* xdp_dns_engine_create(const XDPDNSEngineOptions* opts);
+
+/**
+ * 销毁过滤引擎 (调用者保证没有其它线程仍在使用)
+ */
+void xdp_dns_engine_destroy(XDPDNSEngine* engine);
+
+/**
+ * 从内存中的 RuleSet YAML 整体替换规则
+ *
+ * 格式同 pkg/filter 的规则文件; 未启用的规则被跳过. 顶层 local_zones /
+ * local_data 声明的本地权威区随规则一起替换.
+ * @return 0 成功, XDP_DNS_ERR_INVALID_RULES 解析失败 (原规则保持不变)
+ */
+int xdp_dns_engine_load_rules(XDPDNSEngine* engine, const char* yaml, size_t len);
+
+/**
+ * 从文件整体替换规则
+ */
+int xdp_dns_engine_load_rules_file(XDPDNSEngine* engine, const char* path);
+
+/**
+ * 批量添加规则 (同一域名后者覆盖)
+ */
+int xdp_dns_engine_add_rules(XDPDNSEngine* engine, const XDPDNSRule* rules, size_t count);
+
+/**
+ * 批量删除规则, 按 domain 字段匹配
+ *
+ * @param removed  输出: 实际删除的条数 (可为 NULL)
+ */
+int xdp_dns_engine_remove_rules(
+    XDPDNSEngine* engine,
+    const XDPDNSRule* rules,
+    size_t count,
+    size_t* removed
+);
+
+/**
+ * 以 rules 整体替换现有规则 (原子发布), 规则集策略与本地权威区保持不变
+ */
+int xdp_dns_engine_update_rules(XDPDNSEngine* engine, const XDPDNSRule* rules, size_t count);
+
+/**
+ * 检查单个域名
+ *
+ * @param domain  小写域名 (不含末尾的点)
+ */
+int xdp_dns_engine_check(
+    XDPDNSEngine* engine,
+    const char* domain,
+    size_t domain_len,
+    uint16_t qtype,
+    XDPDNSCheckResult* result
+);
+
+/**
+ * 批量检查 xdp_dns_parse 的解析结果
+ *
+ * 整批只取一次引擎读锁.
+ * @param results  输出数组, 至少 count 个元素
+ */
+int xdp_dns_engine_check_batch(
+    XDPDNSEngine* engine,
+    const XDPDNSParseResult* queries,
+    size_t count,
+    XDPDNSCheckResult* results
+);
+
+/**
+ * 获取 / 重置引擎统计
+ */
+void xdp_dns_engine_get_stats(XDPDNSEngine* engine, XDPDNSEngineStats* stats);
+void xdp_dns_engine_reset_stats(XDPDNSEngine* engine);
+
+/**
+ * 获取引擎内存占用
+ */
+void xdp_dns_engine_get_memory_stats(XDPDNSEngine* engine, XDPDNSMemoryStats* stats);
+
+/**
+ * 获取当前规则集的 ANY 策略
+ *
+ * @param ttl  输出: HINFO 回答的 TTL (可为 NULL)
+ * @return XDPDNSAnyPolicy, 句柄无效时返回 XDP_DNS_ERR_INVALID_PARAM
+ */
+int xdp_dns_engine_any_policy(XDPDNSEngine* engine, uint32_t* ttl);
+
+/**
+ * 当前规则集阻断应答合成 SOA 的 TTL (RuleSet YAML 顶层键 negative_ttl)
+ *
+ * 句柄无效时返回 0
+ */
+uint32_t xdp_dns_engine_negative_ttl(XDPDNSEngine* engine);
+
+/**
+ * 按当前规则集的 ANY 策略构建响应
+ *
+ * 非 ANY 查询或策略为 XDP_DNS_ANY_FORWARD 时返回 0 且 *response_len = 0,
+ * 调用者照常转发. response_buf 可与 query 为同一缓冲区.
+ * @return 0 成功, 其它为错误码
+ */
+int xdp_dns_engine_answer_any(
+    XDPDNSEngine* engine,
+    const uint8_t* query,
+    size_t query_len,
+    uint8_t* response_buf,
+    size_t response_buf_size,
+    size_t* response_len
+);
+
+/**
+ * 原子交换两个句柄的规则集 (统计随规则集一起交换)
+ *
+ * 典型用法: 在备用句柄上加载并验证新规则, 再与线上句柄交换.
+ */
+int xdp_dns_engine_swap(XDPDNSEngine* a, XDPDNSEngine* b);
+
+/**
+ * 标记为线上句柄: 之后每次加载 / 交换 / 增删都把规则代数与规则数写入
+ * 共享内存统计区 (rule_generation / rule_count). 标记不随 swap 交换.
+ * 数据面创建时自动标记它使用的句柄.
+ */
+void xdp_dns_engine_publish_rule_info(XDPDNSEngine* engine, int enabled);
+
+// ==================== 响应缓存 ====================
+//
+// 线上格式的上游响应缓存 (response_cache.hpp): 命中时复制报文并改写 ID、
+// 问题名大小写与 TTL. 可单独使用, 也可挂到数据面上由 worker 直接应答.
+
+// 响应缓存句柄 (不透明)
+typedef struct XDPDNSCache XDPDNSCache;
+
+typedef struct {
+    uint32_t capacity;              // 总条目数, 0 使用 10000
+    uint32_t shards;                // 分片数, 0 使用 16
+    uint32_t max_entry_size;        // 可缓存的最大响应长度, 0 使用 512
+    uint32_t max_ttl;               // TTL 上限 (秒), 0 不限制
+    uint32_t prefetch_percent;      // 剩余 TTL 不足该百分比时要求刷新, 0 使用 10
+    uint32_t stale_window;          // 过期后仍可应答的时长 (秒, RFC 8767), 0 关闭
+    uint32_t stale_ttl;             // 过期应答的 TTL (秒), 0 使用 30
+    int      disable_prefetch;      // 非 0: 不做预取刷新 (过期应答仍要求刷新)
+    uint32_t max_negative_ttl;      // NXDOMAIN / NODATA 的 TTL 上限 (秒), 0 不限制
+    int      disable_nxdomain_cut;  // 非 0: NXDOMAIN 不覆盖其下的名字 (RFC 8020)
+} XDPDNSCacheOptions;
+
+typedef struct {
+    uint64_t hits;
+    uint64_t misses;                // 含已过期
+    uint64_t stale_hits;            // 过期后在 stale_window 内应答
+    uint64_t prefetches;            // 要求刷新的次数
+    uint64_t cut_hits;              // 由 NXDOMAIN 截断点应答
+    uint64_t expired;
+    uint64_t inserts;
+    uint64_t negative_inserts;      // 其中的否定应答
+    uint64_t evictions;
+    uint64_t rejected;              // 不可缓存的响应
+    uint64_t entries;
+    uint64_t capacity;
+    uint64_t memory_bytes;          // 实际占用
+} XDPDNSCacheStats;
+
+/**
+ * 创建响应缓存 (内存一次分配, 之后不再增长)
+ *
+ * @param opts  NULL 使用默认值
+ */
+XDPDNSCache* xdp_dns_cache_create(const XDPDNSCacheOptions* opts);
+
+void xdp_dns_cache_destroy(XDPDNSCache* cache);
+
+/**
+ * 插入上游响应
+ *
+ * @return 1 已缓存, 0 不可缓存 (截断、其它 RCODE、否定应答无 SOA、TTL 为 0 或过长), <0 错误码
+ */
+int xdp_dns_cache_insert(XDPDNSCache* cache, const uint8_t* response, size_t len);
+
+/**
+ * 查找查询对应的缓存响应
+ *
+ * 未命中时返回 0 且 *response_len = 0. response_buf 可与 query 为同一缓冲区.
+ * @return 0 成功, 其它为错误码
+ */
+int xdp_dns_cache_lookup(
+    XDPDNSCache* cache,
+    const uint8_t* query,
+    size_t query_len,
+    uint8_t* response_buf,
+    size_t response_buf_size,
+    size_t* response_len
+);
+
+void xdp_dns_cache_clear(XDPDNSCache* cache);
+
+void xdp_dns_cache_get_stats(XDPDNSCache* cache, XDPDNSCacheStats* stats);
+
+// ==================== 上游转发器 ====================
+//
+// 把未在本地应答的查询复用到少量上游 UDP socket (forwarder.hpp): 随机
+// 上游 ID、超时换上游重发, 用尽后以 SERVFAIL 应答; 相同的在途查询合并为
+// 一次上游查询. 挂到数据面上时, 上游响应由 worker 经包源的发送路径送回客户端.
+
+// 转发器句柄 (不透明)
+typedef struct XDPDNSForwarder XDPDNSForwarder;
+
+typedef struct {
+    const char* const* servers;     // "ip[:port]" 或 "[ipv6]:port", 默认端口 53
+    uint32_t num_servers;
+    uint32_t num_sockets;           // 0 使用 4
+    uint32_t max_inflight;          // 在途查询上限, 0 使用 4096
+    uint32_t num_owners;            // 完成队列数, 不少于数据面 worker 数; 0 视为 1
+    uint32_t timeout_ms;            // 0 使用 1000
+    uint32_t retries;               // 超时后换上游重发的次数
+    int      disable_coalescing;    // 非 0: 相同的在途查询不合并
+} XDPDNSForwarderOptions;
+
+typedef struct {
+    uint64_t submitted;
+    uint64_t coalesced;             // 挂到相同在途查询上, 未单独发出
+    uint64_t rejected;              // 表满或查询无效
+    uint64_t sent;                  // 含重发
+    uint64_t send_errors;
+    uint64_t responses;
+    uint64_t mismatched;            // 未知 ID、来源或问题不符
+    uint64_t retries;
+    uint64_t timeouts;              // 以 SERVFAIL 应答
+    uint64_t truncated;             // 响应过长, 以 TC=1 应答
+    uint64_t completed;
+    uint64_t inflight;
+} XDPDNSForwarderStats;
+
+/**
+ * 创建并启动转发器 (创建 socket 与 I/O 线程)
+ *
+ * @return 句柄, 上游地址无效或 socket 创建失败返回 NULL
+ */
+XDPDNSForwarder* xdp_dns_forwarder_create(const XDPDNSForwarderOptions* opts);
+
+/**
+ * 停止并销毁转发器; 挂载它的数据面需先销毁
+ */
+void xdp_dns_forwarder_destroy(XDPDNSForwarder* fwd);
+
+void xdp_dns_forwarder_get_stats(XDPDNSForwarder* fwd, XDPDNSForwarderStats* stats);
+
+// ==================== C++ 数据面 ====================
+//
+// worker 线程在 C++ 内完成收包、解析、匹配与响应, 每包不经过 cgo.
+// Go 通过共享内存环 (ring_shm.h, Go 侧为 pkg/dns/shmring) 推送规则增量
+// 与配置变更, 并读取采样 / 日志事件.
+
+// 数据面句柄 (不透明)
+typedef struct XDPDNSDataplane XDPDNSDataplane;
+
+typedef struct {
+    const char* shm_name;           // 共享内存环名, NULL 使用 XDP_DNS_RING_DEFAULT_NAME
+    uint32_t num_workers;           // worker 数 (即事件环数), 0 视为 1
+    uint32_t ring_capacity;         // 每个环的槽数, 0 使用 4096
+    uint32_t sample_interval;       // 每 N 个查询采样一个事件, 0 关闭
+    int      log_blocked;           // 非 0: 阻断 / 重定向也发送日志事件
+    XDPDNSCache* cache;             // 非 NULL: 放行的查询先查缓存, 需比数据面存活更久
+    XDPDNSForwarder* forwarder;     // 非 NULL: 未应答的查询转发上游, 需比数据面存活更久
+} XDPDNSDataplaneOptions;
+
+typedef struct {
+    uint64_t packets;
+    uint64_t responded;
+    uint64_t passed;
+    uint64_t parse_errors;
+    uint64_t events;                // 已写入事件环
+    uint64_t events_dropped;        // 事件环满丢弃
+    uint64_t control_applied;       // 已应用的控制消息
+    uint64_t any_answered;          // 按 any_policy 直接应答的 ANY 查询
+    uint64_t cache_hits;            // 由响应缓存应答
+    uint64_t cache_refreshes;       // 为预取 / 过期应答提交的刷新查询
+    uint64_t forwarded;             // 已交给转发器
+    uint64_t upstream_replies;      // 已发回客户端的上游响应
+    uint64_t dropped;               // 阻断规则要求静默丢弃
+    uint64_t local_answered;        // 由本地权威区 (local_zones / local_data) 应答
+} XDPDNSDataplaneStats;
+
+/**
+ * 创建数据面并建立共享内存环
+ *
+ * @param engine  规则引擎, 需比数据面存活更久; 控制环上的规则增量作用于它,
+ *                并标记为线上句柄 (见 xdp_dns_engine_publish_rule_info)
+ * @return 句柄, 失败返回 NULL
+ */
+XDPDNSDataplane* xdp_dns_dataplane_create(XDPDNSEngine* engine, const XDPDNSDataplaneOptions* opts);
+
+/**
+ * 为 worker 设置重放包源 (traffic_gen 原始格式文件, 压测与集成测试用)
+ *
+ * @param loops  重放次数, 0 无限循环
+ */
+int xdp_dns_dataplane_add_replay(XDPDNSDataplane* dp, uint32_t worker, const char* raw_path, uint64_t loops);
+
+// 控制面已映射的 AF_XDP 环 (见 xsk_source.hpp); size 为 2 的幂
+typedef struct {
+    uint32_t* producer;
+    uint32_t* consumer;
+    void*     descs;                // fill / completion: uint64_t[]; rx / tx: struct xdp_desc[]
+    uint32_t  size;
+} XDPDNSXskRing;
+
+typedef struct {
+    int       fd;                   // 已绑定到网卡队列的 AF_XDP socket
+    uint8_t*  umem;
+    uint64_t  umem_size;
+    uint32_t  frame_size;
+    uint32_t  tx_reserve;           // 留给上游响应的空闲帧, 0 使用默认值 (64)
+    uint32_t  mtu;                  // 0 使用默认值 (1500)
+    XDPDNSXskRing fill;
+    XDPDNSXskRing completion;
+    XDPDNSXskRing rx;
+    XDPDNSXskRing tx;
+} XDPDNSXskConfig;
+
+/**
+ * 为 worker 设置 AF_XDP 包源: worker 直接驱动 socket 的四个环
+ *
+ * 调用之后控制面不得再操作这些环; UMEM 与 socket 需比数据面存活更久.
+ */
+int xdp_dns_dataplane_add_xsk(XDPDNSDataplane* dp, uint32_t worker, const XDPDNSXskConfig* cfg);
+
+/**
+ * 启动控制线程与已设置包源的 worker
+ */
+int xdp_dns_dataplane_start(XDPDNSDataplane* dp);
+
+/**
+ * 停止所有线程 (共享内存环保持映射, 可继续读取剩余事件)
+ */
+void xdp_dns_dataplane_stop(XDPDNSDataplane* dp);
+
+/**
+ * 停止并销毁数据面, 删除共享内存环
+ */
+void xdp_dns_dataplane_destroy(XDPDNSDataplane* dp);
+
+/**
+ * 所有重放包源是否都已处理完毕
+ */
+int xdp_dns_dataplane_replay_done(XDPDNSDataplane* dp);
+
+void xdp_dns_dataplane_get_stats(XDPDNSDataplane* dp, XDPDNSDataplaneStats* stats);
+
 #ifdef __cplusplus
 }
 #endif
@@ -17,6 +17,9 @@ enum class Error : int {
     InvalidLabel = -5,
     BufferTooSmall = -6,
     NotQuery = -7,
+    InvalidRule = -8,
+    NotUDP = -9,
+    Fragmented = -10,
 };
 
 // 网络字节序转换 (使用编译器内置函数)
@@ -44,6 +47,29 @@ inline uint32_t htonl(uint32_t h) {
     return ntohl(h);
 }
 
+// 包内字段读写 (网络字节序, 不要求对齐)
+inline uint16_t readU16(const uint8_t* p) {
+    uint16_t v;
+    std::memcpy(&v, p, sizeof(v));
+    return ntohs(v);
+}
+
+inline uint32_t readU32(const uint8_t* p) {
+    uint32_t v;
+    std::memcpy(&v, p, sizeof(v));
+    return ntohl(v);
+}
+
+inline void writeU16(uint8_t* p, uint16_t h) {
+    uint16_t v = htons(h);
+    std::memcpy(p, &v, sizeof(v));
+}
+
+inline void writeU32(uint8_t* p, uint32_t h) {
+    uint32_t v = htonl(h);
+    std::memcpy(p, &v, sizeof(v));
+}
+
 // DNS 类型
 namespace dns_type {
     constexpr uint16_t A     = 1;
@@ -51,9 +77,12 @@ namespace dns_type {
     constexpr uint16_t CNAME = 5;
     constexpr uint16_t SOA   = 6;
     constexpr uint16_t PTR   = 12;
+    constexpr uint16_t HINFO = 13;
     constexpr uint16_t MX    = 15;
     constexpr uint16_t TXT   = 16;
     constexpr uint16_t AAAA  = 28;
+    constexpr uint16_t SRV   = 33;
+    constexpr uint16_t OPT   = 41;
     constexpr uint16_t ANY   = 255;
 }
 
@@ -80,19 +109,49 @@ enum class Action : uint8_t {
     Log = 3,
 };
 
+// 阻断规则的应答方式, 数据面按值查表构建响应
+enum class BlockMode : uint8_t {
+    NXDomain = 0,       // NXDOMAIN + 合成 SOA
+    NoData = 1,         // NOERROR 空回答 + 合成 SOA
+    Refused = 2,
+    NullAddress = 3,    // A 回答 0.0.0.0, AAAA 回答 ::, 其它类型 NODATA
+    Drop = 4,           // 不应答, 丢弃查询 (XDP_DROP)
+};
+
+constexpr size_t kBlockModeCount = 5;
+
 // 过滤规则
 struct Rule {
     uint32_t id;
     Action action;
+    BlockMode block_mode;  // 仅对 Action::Block 有效
+    uint16_t answer;       // 重定向的预编译应答 (规则集 AnswerTable 句柄), 0 时回答 redirect_ip
     uint32_t redirect_ip;  // 网络字节序
     uint32_t ttl;
+    bool subdomains_only;  // "*.name" 只匹配子域名, 不匹配 name 本身 (RPZ / DNS 通配语义)
     char rule_id[32];
     
-    Rule() : id(0), action(Action::Allow), redirect_ip(0), ttl(300) {
+    Rule()
+        : id(0), action(Action::Allow), block_mode(BlockMode::NXDomain), answer(0),
+          redirect_ip(0), ttl(300), subdomains_only(false) {
         rule_id[0] = '\0';
     }
 };
 
+// ANY 查询的处理策略 (RFC 8482)
+enum class AnyPolicy : uint8_t {
+    Forward = 0,    // 原样转发上游
+    Hinfo = 1,      // 合成最小 HINFO 回答 ("RFC8482", "")
+    Truncate = 2,   // 空回答并置 TC=1, 迫使客户端改用 TCP
+};
+
+// 规则集级别的策略 (RuleSet YAML 顶层键)
+struct RuleSetPolicy {
+    AnyPolicy any_policy = AnyPolicy::Forward;
+    uint32_t any_ttl = 3600;        // HINFO 回答的 TTL
+    uint32_t negative_ttl = 300;    // 阻断应答合成 SOA 的 TTL, 即下游的否定缓存时长
+};
+
 // 过滤结果
 struct FilterResult {
     Action action;
@@ -0,0 +1,200 @@
+#pragma once
+
+#include "engine_slot.hpp"
+#include "forwarder.hpp"
+#include "response_cache.hpp"
+#include "ring.hpp"
+#include <atomic>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace xdp_dns {
+
+// ==================== C++ 数据面 ====================
+//
+// worker 线程独占收包、解析、匹配和响应构建, 与 Go 控制面只通过共享内存
+// 环交互 (布局见 ring_shm.h): 每包不经过 cgo, 也不切换 goroutine.
+// 控制线程消费控制环, 把规则增量应用到 EngineSlot.
+
+// 数据面中的一个包 (DNS 负载, 即 UDP payload)
+struct PacketBuf {
+    uint8_t* data;
+    uint32_t len;
+    uint32_t capacity;              // 原地构建响应时可用的字节数
+    uint64_t cookie = 0;            // 包源定义的客户端上下文, 转发的响应经 transmit 带回
+};
+
+enum class PacketVerdict : uint8_t {
+    Pass = 0,                       // 原样放行 (转发上游)
+    Respond = 1,                    // data 已原地改写为响应
+    Drop = 2,                       // 不应答 (阻断规则 BlockMode::Drop), XDP 层返回 XDP_DROP
+    Forwarded = 3,                  // 已交给转发器, 响应稍后经 PacketSource::transmit 发出
+};
+
+// 包源 - 每个 worker 独占一个 (AF_XDP 队列、重放文件等)
+class PacketSource {
+public:
+    virtual ~PacketSource() = default;
+
+    // 取最多 max 个包, 返回 0 表示暂时没有
+    virtual size_t receive(PacketBuf* pkts, size_t max) = 0;
+
+    // 本批处理完毕; verdicts[i] 为 Respond 时 pkts[i] 已是响应
+    virtual void complete(const PacketBuf* pkts, const PacketVerdict* verdicts, size_t n) = 0;
+
+    // 发送转发器带回的响应 (worker 线程调用), cookie 为原查询的 PacketBuf::cookie.
+    // 不支持异步发送的包源返回 false
+    virtual bool transmit(uint64_t cookie, const uint8_t* data, size_t len) {
+        (void)cookie;
+        (void)data;
+        (void)len;
+        return false;
+    }
+};
+
+// 循环重放内存中的查询 (压测与集成测试)
+class ReplaySource : public PacketSource {
+public:
+    // loops 为 0 时无限循环
+    ReplaySource(std::vector<std::string> queries, uint64_t loops);
+
+    // 读取 traffic_gen::writeRaw 格式的文件, 失败返回 nullptr
+    static std::unique_ptr<ReplaySource> fromRawFile(const char* path, uint64_t loops);
+
+    size_t receive(PacketBuf* pkts, size_t max) override;
+    void complete(const PacketBuf* pkts, const PacketVerdict* verdicts, size_t n) override;
+    bool transmit(uint64_t cookie, const uint8_t* data, size_t len) override;
+
+    // 所有循环都已交给 worker 并处理完毕
+    bool done() const { return done_.load(std::memory_order_acquire); }
+    uint64_t responded() const { return responded_.load(std::memory_order_relaxed); }
+    uint64_t transmitted() const { return transmitted_.load(std::memory_order_relaxed); }
+
+    static constexpr size_t kFrameSize = 512;
+    static constexpr size_t kMaxBatch = 64;
+
+private:
+    std::vector<std::string> queries_;
+    uint64_t loops_;
+    uint64_t loop_ = 0;
+    size_t next_ = 0;
+    std::vector<uint8_t> frames_;
+
+    std::atomic<uint64_t> responded_{0};
+    std::atomic<uint64_t> transmitted_{0};
+    std::atomic<bool> done_{false};
+};
+
+struct DataplaneOptions {
+    uint32_t num_workers = 1;
+    uint32_t ring_capacity = 4096;  // 每个环的槽数
+    uint32_t sample_interval = 1024; // 每 N 个查询采样一个事件, 0 关闭
+    bool log_blocked = false;       // 阻断 / 重定向也发送日志事件
+    uint32_t idle_sleep_us = 50;    // 包源为空时 worker 的休眠时间
+    ResponseCache* cache = nullptr; // 非空时放行的查询先查缓存, 需比 Dataplane 存活更久
+    Forwarder* forwarder = nullptr; // 非空时未应答的查询转发上游, numOwners() 不少于 worker 数
+                                    // 同时挂缓存时上游响应写入缓存, 并负责预取刷新
+};
+
+struct DataplaneStats {
+    uint64_t packets;
+    uint64_t responded;
+    uint64_t passed;
+    uint64_t parse_errors;          // 含头部预筛拒绝
+    uint64_t any_answered;          // 按 any_policy 直接应答的 ANY 查询
+    uint64_t dropped;               // 阻断规则要求静默丢弃
+    uint64_t local_answered;        // 由本地权威区应答
+    uint64_t cache_hits;            // 由响应缓存应答
+    uint64_t cache_refreshes;       // 为预取 / 过期应答提交的刷新查询
+    uint64_t forwarded;             // 已交给转发器
+    uint64_t upstream_replies;      // 经 transmit 发出的上游响应
+    uint64_t events;                // 已写入事件环
+    uint64_t events_dropped;        // 事件环满丢弃
+    uint64_t control_applied;       // 已应用的控制消息
+};
+
+class Dataplane {
+public:
+    // engine 需比 Dataplane 存活更久; 构造时标记为线上引擎 (EngineSlot::setPublishRuleInfo)
+    Dataplane(EngineSlot* engine, const DataplaneOptions& opts);
+    ~Dataplane();
+
+    Dataplane(const Dataplane&) = delete;
+    Dataplane& operator=(const Dataplane&) = delete;
+
+    // 创建共享内存通道
+    bool open(const char* shm_name);
+
+    // 设置 worker 的包源 (start 之前)
+    bool setSource(uint32_t worker, std::unique_ptr<PacketSource> source);
+
+    // 启动控制线程与所有已设置包源的 worker
+    bool start();
+
+    // 停止并等待所有线程退出 (通道保持打开, 可继续读取事件)
+    void stop();
+
+    DataplaneStats stats() const;
+    const RingChannel& channel() const { return channel_; }
+
+    static constexpr size_t kBatchSize = 64;
+
+    // 刷新查询的 cookie: 完成后只写入缓存, 不发给客户端
+    static constexpr uint64_t kRefreshCookie = ~0ULL;
+
+private:
+    // 头部 + 最长问题 + OPT
+    static constexpr size_t kRefreshQuerySize = DNS_HEADER_SIZE + MAX_DOMAIN_LENGTH + 1 + 4 + 11;
+
+    struct alignas(64) Worker {
+        std::unique_ptr<PacketSource> source;
+        ShmRing events;
+        std::thread thread;
+        uint32_t sample_tick = 0;
+        uint64_t batch_ns = 0;      // 本批的单调时钟, 缓存过期与 TTL 递减共用
+        uint32_t rr_tick = 0;       // 多地址应答 (重定向 / 本地区) 的轮转起点
+
+        // 本批缓存命中要求的刷新查询, 随 forwardBatch 一起提交
+        uint8_t refresh[kBatchSize][kRefreshQuerySize];
+        uint32_t refresh_lens[kBatchSize];
+        size_t num_refresh = 0;
+
+        std::atomic<uint64_t> packets{0};
+        std::atomic<uint64_t> responded{0};
+        std::atomic<uint64_t> passed{0};
+        std::atomic<uint64_t> parse_errors{0};
+        std::atomic<uint64_t> any_answered{0};
+        std::atomic<uint64_t> dropped{0};
+        std::atomic<uint64_t> local_answered{0};
+        std::atomic<uint64_t> cache_hits{0};
+        std::atomic<uint64_t> cache_refreshes{0};
+        std::atomic<uint64_t> forwarded{0};
+        std::atomic<uint64_t> upstream_replies{0};
+        std::atomic<uint64_t> events_sent{0};
+    };
+
+    void runWorker(uint32_t index);
+    void forwardBatch(uint32_t index, const PacketBuf* pkts, PacketVerdict* verdicts, size_t n);
+    void drainForwarder(uint32_t index);
+    void runControl();
+    void applyControl(const XDPDNSRingMsg& msg);
+
+    // candidate: 头部预筛结果, false 时不解析直接放行
+    PacketVerdict process(const FilterEngine& engine, uint32_t index, PacketBuf* pkt,
+                          bool candidate);
+    void sendEvent(uint32_t index, uint16_t type, const char* domain, size_t domain_len,
+                   uint16_t qtype, const FilterResult& result);
+
+    EngineSlot* engine_;
+    DataplaneOptions opts_;
+    RingChannel channel_;
+    std::vector<std::unique_ptr<Worker>> workers_;
+    std::thread control_thread_;
+    std::atomic<bool> running_{false};
+    std::atomic<uint32_t> sample_interval_;
+    std::atomic<uint64_t> control_applied_{0};
+};
+
+} // namespace xdp_dns
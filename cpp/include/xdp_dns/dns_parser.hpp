@@ -18,12 +18,15 @@ struct DNSHeader {
     uint16_t getFlags() const { return ntohs(flags); }
     uint16_t getQDCount() const { return ntohs(qd_count); }
     uint16_t getANCount() const { return ntohs(an_count); }
+    uint16_t getNSCount() const { return ntohs(ns_count); }
+    uint16_t getARCount() const { return ntohs(ar_count); }
     
     // 标志位检查
     bool isQuery() const { return (getFlags() & 0x8000) == 0; }
     bool isResponse() const { return !isQuery(); }
     uint8_t getRCode() const { return getFlags() & 0x000F; }
     bool isRecursionDesired() const { return (getFlags() & 0x0100) != 0; }
+    bool isTruncated() const { return (getFlags() & 0x0200) != 0; }
 } __attribute__((packed));
 
 static_assert(sizeof(DNSHeader) == 12, "DNSHeader size must be 12 bytes");
@@ -48,6 +51,33 @@ struct DNSParseResult {
     bool is_query;               // 是否是查询
 };
 
+// 权威区的 SOA 记录 (RFC 2308 否定应答), 名字已展开为非压缩线上格式
+struct DNSSoaRecord {
+    size_t offset;               // 记录在报文中的起始位置
+    uint16_t rclass;
+    uint32_t ttl;
+    uint32_t serial;
+    uint32_t refresh;
+    uint32_t retry;
+    uint32_t expire;
+    uint32_t minimum;
+    size_t owner_len;
+    size_t mname_len;
+    size_t rname_len;
+    uint8_t owner[MAX_DOMAIN_LENGTH + 1];
+    uint8_t mname[MAX_DOMAIN_LENGTH + 1];
+    uint8_t rname[MAX_DOMAIN_LENGTH + 1];
+
+    // 否定应答可缓存的时长: min(SOA TTL, MINIMUM)
+    uint32_t negativeTtl() const { return ttl < minimum ? ttl : minimum; }
+};
+
+// 查询的 EDNS 状态 (DNSParser::queryEdns)
+enum EdnsFlags : uint8_t {
+    EDNS_PRESENT = 0x01,        // 附加区带 OPT 记录
+    EDNS_DO = 0x02,             // DNSSEC OK
+};
+
 // DNS 解析器类
 class DNSParser {
 public:
@@ -58,6 +88,41 @@ public:
         DNSParseResult* result
     );
     
+    // 批量头部预筛 (SIMD, n ≤ 64): 第 i 位为 1 表示 pkts[i] 是值得详细解析的
+    // 标准查询 (QR=0, OPCODE=QUERY, QDCOUNT=1, ANCOUNT=NSCOUNT=0, ARCOUNT≤1),
+    // 为 0 的包可以不经 parse 直接放行或丢弃
+    static uint64_t classifyHeaders(
+        const uint8_t* const* pkts,
+        const uint32_t* lens,
+        size_t n
+    );
+
+    // 紧跟问题之后的 OPT 记录 (ARCOUNT=1 的标准查询), 返回 EdnsFlags 组合
+    static uint8_t queryEdns(
+        const uint8_t* data,
+        size_t len,
+        const DNSParseResult& parsed
+    );
+
+    // 跳过回答区, 取权威区第一条 SOA 记录 (NXDOMAIN / NODATA 响应)
+    static Error findAuthoritySoa(
+        const uint8_t* data,
+        size_t len,
+        const DNSParseResult& parsed,
+        DNSSoaRecord* soa
+    );
+
+    // 把域名展开为非压缩线上格式 (保留大小写), out 至少 MAX_DOMAIN_LENGTH + 1;
+    // end_offset 为名字在原位置之后的偏移
+    static Error expandName(
+        const uint8_t* packet,
+        size_t packet_len,
+        size_t name_offset,
+        uint8_t* out,
+        size_t* out_len,
+        size_t* end_offset
+    );
+
     // 解码域名到缓冲区
     static Error decodeName(
         const uint8_t* packet,
@@ -87,6 +152,13 @@ public:
     );
 
 private:
+    // parse 的实现 (不含探针)
+    static Error parseQuery(
+        const uint8_t* data,
+        size_t len,
+        DNSParseResult* result
+    );
+
     // 解析域名，返回结束位置
     static Error parseName(
         const uint8_t* data,
@@ -117,6 +189,28 @@ public:
         size_t response_buf_size
     );
     
+    // 构建带合成 SOA 的 NXDOMAIN 响应, 下游解析器可据此否定缓存 (RFC 2308).
+    // SOA 所有者为指向 QNAME 父域的压缩指针, TTL 与 MINIMUM 为 negative_ttl
+    static size_t buildNXDomain(
+        const uint8_t* query,
+        size_t query_len,
+        const DNSParseResult& parsed,
+        uint32_t negative_ttl,
+        uint8_t* response,
+        size_t response_buf_size
+    );
+
+    // 构建带合成 SOA 的 NODATA 响应 (NOERROR, 无回答), 如 IPv4 重定向
+    // 规则收到的 AAAA 查询
+    static size_t buildNoData(
+        const uint8_t* query,
+        size_t query_len,
+        const DNSParseResult& parsed,
+        uint32_t negative_ttl,
+        uint8_t* response,
+        size_t response_buf_size
+    );
+
     // 构建 A 记录响应
     static size_t buildAResponse(
         const uint8_t* query,
@@ -148,7 +242,69 @@ public:
         size_t response_buf_size
     );
 
+    // 构建 SERVFAIL 响应 (上游超时)
+    static size_t buildServFail(
+        const uint8_t* query,
+        size_t query_len,
+        const DNSParseResult& parsed,
+        uint8_t* response,
+        size_t response_buf_size
+    );
+
+    // 按阻断规则的应答方式构建响应, 以 mode 为下标查表分派.
+    // NullAddress 的回答 TTL 为 rule_ttl, 合成 SOA 的 TTL 为 negative_ttl;
+    // Drop 不构建响应, 返回 0 (调用者应先判断并丢弃查询)
+    static size_t buildBlocked(
+        const uint8_t* query,
+        size_t query_len,
+        const DNSParseResult& parsed,
+        BlockMode mode,
+        uint32_t rule_ttl,
+        uint32_t negative_ttl,
+        uint8_t* response,
+        size_t response_buf_size
+    );
+
+    // 构建 RFC 8482 最小 HINFO 响应 (回答 ANY 查询, 不转发上游)
+    static size_t buildHInfo(
+        const uint8_t* query,
+        size_t query_len,
+        const DNSParseResult& parsed,
+        uint32_t ttl,
+        uint8_t* response,
+        size_t response_buf_size
+    );
+
+    // 构建 TC=1 的空响应, 客户端改用 TCP 重试
+    static size_t buildTruncated(
+        const uint8_t* query,
+        size_t query_len,
+        const DNSParseResult& parsed,
+        uint8_t* response,
+        size_t response_buf_size
+    );
+
+    // 按规则集的 any_policy 构建 ANY 查询的响应; Forward 或非 ANY 查询返回 0
+    static size_t buildAnyResponse(
+        const uint8_t* query,
+        size_t query_len,
+        const DNSParseResult& parsed,
+        const RuleSetPolicy& policy,
+        uint8_t* response,
+        size_t response_buf_size
+    );
+
 private:
+    // 否定应答: 问题 + 权威区合成 SOA
+    static size_t buildNegative(
+        const uint8_t* query,
+        const DNSParseResult& parsed,
+        uint8_t rcode,
+        uint32_t negative_ttl,
+        uint8_t* response,
+        size_t response_buf_size
+    );
+
     // 复制问题部分
     static size_t copyQuestion(
         const uint8_t* query,
@@ -1,9 +1,13 @@
 #pragma once
 
 #include "common.hpp"
+#include "memory.hpp"
+#include "simd.hpp"
 #include <string>
+#include <string_view>
 #include <unordered_map>
 #include <memory>
+#include <memory_resource>
 #include <shared_mutex>
 #include <vector>
 #include <atomic>
@@ -11,20 +15,55 @@
 
 namespace xdp_dns {
 
-// Trie 节点
+// Trie 节点 (节点、子节点表和标签都从所属代的资源分配)
 struct TrieNode {
-    std::unordered_map<std::string, std::unique_ptr<TrieNode>> children;
+    // 键指向 Labels 资源中的标签字节, 由 TrieGeneration 负责释放
+    std::pmr::unordered_map<std::string_view, TrieNode*, LabelHash> children;
     const Rule* exact_rule = nullptr;     // 精确匹配规则
-    const Rule* wildcard_rule = nullptr;  // 通配符规则
+    const Rule* wildcard_rule = nullptr;  // 通配符规则 (subdomains_only 时不匹配本节点)
     
-    TrieNode() = default;
+    explicit TrieNode(std::pmr::memory_resource* index) : children(index) {}
+};
+
+// 一代 Trie: 根节点、规则存储及其内存一起创建、一起释放
+//
+// 启用 Arena 时节点、标签、规则和子节点表分别来自该代独占的 Arena,
+// 析构只需解除映射; 否则逐个节点释放.
+struct TrieGeneration {
+    explicit TrieGeneration(const ArenaOptions& arena);
+    ~TrieGeneration();
+
+    TrieGeneration(const TrieGeneration&) = delete;
+    TrieGeneration& operator=(const TrieGeneration&) = delete;
+
+    TrieNode* newNode();
+    Rule* newRule(const Rule& rule);
+
+    // 沿标签路径插入 (无锁, 调用者保证独占)
+    void insert(const std::vector<std::string>& labels, bool is_wildcard, const Rule* rule);
+
+    MemoryAccounting memory;
+    TrieNode* root;
+    std::pmr::vector<Rule*> rules;  // 规则存储 (保持规则生命周期)
+    size_t rule_count = 0;
+
+private:
+    void destroyTree(TrieNode* node);
 };
 
 // 域名 Trie - 线程安全
+//
+// ArenaOptions.numa_replicas 启用且主机有多个 NUMA 节点时, 每个节点持有一份
+// 放置在本节点内存上的完整副本. 所有修改同时作用于全部副本, 并在同一次写锁内
+// 发布; match 读取调用线程所在节点的副本.
+//
+// match 返回的指针在释放读锁后仍会被使用, 因此 clear / updateRules 换下的旧代
+// 不立即释放, 而是保留到 Trie 析构. 需要回收内存的热重载应整体替换引擎
+// (EngineSlot::replace), 而不是反复原地重载.
 class DomainTrie {
 public:
-    DomainTrie();
-    ~DomainTrie() = default;
+    explicit DomainTrie(const ArenaOptions& arena = defaultArenaOptions());
+    ~DomainTrie();
     
     // 禁止拷贝
     DomainTrie(const DomainTrie&) = delete;
@@ -42,55 +81,108 @@ public:
     bool remove(const char* domain, size_t domain_len);
     bool remove(const std::string& domain);
     
-    // 清空所有规则
+    // 清空所有规则 (旧代保留到析构)
     void clear();
     
     // 获取规则数量
     size_t size() const;
     
-    // 批量更新规则 (最小化锁时间)
+    // 批量更新规则 (最小化锁时间, 旧代保留到析构)
     void updateRules(const std::vector<std::pair<std::string, Rule>>& rules);
 
+    // 内存占用 (节点 / 标签 / 规则 / 子节点表, 含全部副本, 不含已退役的旧代)
+    MemoryUsage memoryUsage() const;
+
+    // 副本数 (未启用 NUMA 复制时为 1)
+    size_t replicaCount() const;
+
 private:
+    using Generations = std::vector<std::unique_ptr<TrieGeneration>>;
+
+    // 每个副本一代空 Trie, 副本 i 的内存放置在节点 nodes_[i] 上
+    Generations makeGenerations() const;
+
+    // 调用线程应读取的副本 (调用者持有锁)
+    const TrieGeneration& local() const;
+
+    // 发布 next 并把换下的旧代移入 retired_ (调用者持有写锁)
+    void retire(Generations* next);
+
     // 将域名分割为标签并反转
     static std::vector<std::string> splitAndReverse(const char* domain, size_t len);
     
     // 内部匹配实现 (无锁)
     const Rule* matchImpl(const TrieNode* node, 
                           const std::vector<std::string>& labels) const;
-    
-    // 内部插入实现 (无锁)
-    void insertImpl(TrieNode* node, 
-                    const std::vector<std::string>& labels,
-                    bool is_wildcard,
-                    const Rule* rule);
+
+    ArenaOptions arena_;
+    std::vector<int> nodes_;  // 副本所在节点号 (未复制时为空)
+    size_t replicas_;
 
     mutable std::shared_mutex mutex_;
-    std::unique_ptr<TrieNode> root_;
-    size_t rule_count_;
-    
-    // 规则存储 (保持规则生命周期)
-    std::vector<std::unique_ptr<Rule>> rules_storage_;
+    Generations gens_;
+    Generations retired_;  // 被换下的旧代, 其规则指针可能仍被 match 的调用者持有
 };
 
 // 过滤引擎 - 组合 Trie 和其他匹配逻辑
+class LocalZones;
+class AnswerTable;
+struct RedirectAnswer;
+
 class FilterEngine {
 public:
-    FilterEngine();
-    ~FilterEngine() = default;
+    explicit FilterEngine(const ArenaOptions& arena = defaultArenaOptions());
+    ~FilterEngine();
 
-    // 加载规则
+    // 加载规则 (pkg/filter RuleSet YAML), 整体替换现有规则、规则集策略、
+    // 本地权威区与应答表; 不可与 check 并发
     Error loadRules(const char* yaml_content, size_t len);
 
+    // 整体替换规则 (新一代在锁外构建)
+    void updateRules(const std::vector<std::pair<std::string, Rule>>& rules);
+
     // 检查域名
     FilterResult check(const char* domain, size_t domain_len, uint16_t qtype) const;
 
-    // 添加单条规则
+    // 添加单条规则; 应答句柄只在所属规则集的应答表内有效, 增量规则的
+    // answer 被清零 (重定向回答 redirect_ip)
     void addRule(const Rule& rule, const char* domain, size_t domain_len);
 
     // 删除规则
     bool removeRule(const char* rule_id);
 
+    // 按域名删除规则 ("*.example.com" 删除通配符规则)
+    bool removeDomain(const char* domain, size_t domain_len);
+
+    // 规则集策略 (ANY 处理等), 可与 check 并发读写
+    RuleSetPolicy policy() const {
+        RuleSetPolicy p;
+        p.any_policy = any_policy_.load(std::memory_order_relaxed);
+        p.any_ttl = any_ttl_.load(std::memory_order_relaxed);
+        p.negative_ttl = negative_ttl_.load(std::memory_order_relaxed);
+        return p;
+    }
+    void setPolicy(const RuleSetPolicy& policy) {
+        any_policy_.store(policy.any_policy, std::memory_order_relaxed);
+        any_ttl_.store(policy.any_ttl, std::memory_order_relaxed);
+        negative_ttl_.store(policy.negative_ttl, std::memory_order_relaxed);
+    }
+
+    // 本地权威区, 随规则集一起加载 / 替换; 引擎发布后不再修改, 可为空
+    const LocalZones* localZones() const { return local_zones_.get(); }
+    const std::shared_ptr<const LocalZones>& sharedLocalZones() const { return local_zones_; }
+    void setLocalZones(std::shared_ptr<const LocalZones> zones) { local_zones_ = std::move(zones); }
+
+    // 重定向规则的预编译应答表, 与本地权威区一样随规则集替换, 可为空
+    const std::shared_ptr<const AnswerTable>& sharedAnswers() const { return answers_; }
+    void setAnswers(std::shared_ptr<const AnswerTable> answers) { answers_ = std::move(answers); }
+
+    // rule 的预编译应答, 没有时返回 nullptr (回答 redirect_ip)
+    const RedirectAnswer* redirectAnswer(const Rule& rule) const;
+
+    // 规则数
+    size_t ruleCount() const { return trie_.size(); }
+
     // 获取统计
     struct Stats {
         uint64_t total_checks;
@@ -98,16 +190,29 @@ public:
         uint64_t blocked;
         uint64_t redirected;
         uint64_t logged;
+
+        Stats& operator+=(const Stats& other);
     };
     Stats getStats() const;
     void resetStats();
 
+    // 内存占用 (Trie + 引擎自身的规则存储、缓存与索引)
+    MemoryUsage memoryUsage() const;
+
 private:
     DomainTrie trie_;
+    MemoryAccounting memory_;
 
     // 规则存储 (保持规则生命周期)
     mutable std::mutex rules_mutex_;
-    std::vector<std::unique_ptr<Rule>> rules_storage_;
+    std::pmr::vector<Rule*> rules_storage_;
+
+    std::shared_ptr<const LocalZones> local_zones_;
+    std::shared_ptr<const AnswerTable> answers_;
+
+    std::atomic<AnyPolicy> any_policy_{AnyPolicy::Forward};
+    std::atomic<uint32_t> any_ttl_{RuleSetPolicy{}.any_ttl};
+    std::atomic<uint32_t> negative_ttl_{RuleSetPolicy{}.negative_ttl};
 
     // 统计计数器 (原子操作)
     mutable std::atomic<uint64_t> total_checks_{0};
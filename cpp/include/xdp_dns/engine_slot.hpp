@@ -0,0 +1,81 @@
+#pragma once
+
+#include "domain_trie.hpp"
+#include "rule_loader.hpp"
+#include <atomic>
+#include <memory>
+#include <shared_mutex>
+
+namespace xdp_dns {
+
+// 可整体替换的过滤引擎 - C API 句柄与 Dataplane 共用
+//
+// 读写锁只保护引擎指针: check 与增删走共享锁 (Trie 内部另有锁),
+// replace / swap 走独占锁. 整体替换在锁外构建新引擎, 旧引擎在锁外析构.
+// Rule 指针只在 read() 回调内有效.
+class EngineSlot {
+public:
+    explicit EngineSlot(const ArenaOptions& arena = defaultArenaOptions());
+    ~EngineSlot();
+
+    EngineSlot(const EngineSlot&) = delete;
+    EngineSlot& operator=(const EngineSlot&) = delete;
+
+    // 在共享锁内以 const FilterEngine& 调用 fn, 批量检查时整批只加锁一次
+    template <typename Fn>
+    decltype(auto) read(Fn&& fn) const {
+        std::shared_lock<std::shared_mutex> lock(mutex_);
+        return fn(static_cast<const FilterEngine&>(*impl_));
+    }
+
+    // 整体替换规则; 规则集策略、本地权威区与应答表随新引擎一起生效,
+    // 旧规则集的应答表随旧引擎释放
+    void replace(const RuleEntries& entries, const RuleSetPolicy& policy = {},
+                 std::shared_ptr<const LocalZones> zones = nullptr,
+                 std::shared_ptr<const AnswerTable> answers = nullptr);
+
+    // 只替换规则: 策略与本地权威区在交换的独占锁内取自当前引擎,
+    // 与并发的 replace 不会交错成新旧混合
+    void replaceRules(const RuleEntries& entries);
+
+    // 增量添加 (同一域名后者覆盖) / 按域名删除, 返回删除条数
+    void addRules(const RuleEntries& entries);
+    size_t removeDomains(const std::vector<std::string>& domains);
+
+    // 统计含已被替换掉的引擎
+    FilterEngine::Stats stats() const;
+    void resetStats();
+
+    size_t ruleCount() const;
+    RuleSetPolicy policy() const;
+    std::shared_ptr<const LocalZones> localZones() const;
+    MemoryUsage memoryUsage() const;
+
+    // 交换两个槽的引擎 (统计与代数随引擎一起交换, 发布标记留在槽上)
+    void swap(EngineSlot& other);
+
+    // 规则代数: 每次 replace 取进程内递增的新值, 未加载过为 0
+    uint64_t generation() const;
+
+    // 标记为线上引擎: 立即并在之后每次 replace / swap / 增删后把代数与规则数
+    // 写入 StatsRegistry (共享内存统计区的 rule_generation / rule_count)
+    void setPublishRuleInfo(bool enabled);
+
+private:
+    ArenaOptions arena_;
+
+    mutable std::shared_mutex mutex_;
+    std::unique_ptr<FilterEngine> impl_;
+    FilterEngine::Stats retired_{};
+    uint64_t generation_ = 0;
+    std::atomic<bool> publish_rule_info_{false};
+
+    // 持有 mutex_ (共享或独占) 时调用
+    void publishRuleInfoLocked() const;
+
+    // 发布新引擎, *next 换出旧引擎由调用者在锁外析构;
+    // inherit_rule_set 时先从当前引擎复制策略与本地权威区
+    void install(std::unique_ptr<FilterEngine>* next, bool inherit_rule_set);
+};
+
+} // namespace xdp_dns
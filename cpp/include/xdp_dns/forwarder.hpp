@@ -0,0 +1,176 @@
+#pragma once
+
+#include "common.hpp"
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace xdp_dns {
+
+// ==================== 上游转发器 ====================
+//
+// 把客户端查询复用到少量上游 UDP socket 上: 每个在途查询占用一个表项,
+// 以 (socket, 上游 ID) 索引. 上游 ID 随机选取, 响应按 ID 找回表项后
+// 校验来源地址与问题部分, 恢复客户端 ID, 放入提交者 (owner) 的完成队列.
+//
+// 提交方 (数据面 worker) 用 sendmmsg 整批发送; 一个 I/O 线程用 recvmmsg
+// 整批接收, 并负责超时扫描: 超时后换下一个上游重发, 次数用尽则以
+// SERVFAIL 完成. 表项分配、ID 映射与完成队列均无锁.
+//
+// 请求合并: 与在途查询 (小写 QNAME, QTYPE, QCLASS, EDNS/DO) 相同的查询
+// 不再发往上游, 挂到领头表项上等待; 领头完成时把同一响应分发给每个
+// 等待者, 各自换上自己的 ID、RD 位与问题名大小写.
+
+struct ForwarderOptions {
+    std::vector<std::string> servers;   // "ip[:port]" 或 "[ipv6]:port", 默认端口 53
+    uint32_t num_sockets = 4;
+    uint32_t max_inflight = 4096;       // 取整到 2 的幂, 上限 65536
+    uint32_t num_owners = 1;            // 完成队列数, 每个提交线程一个
+    uint32_t timeout_ms = 1000;
+    uint32_t retries = 2;               // 超时后换上游重发的次数
+    bool coalesce = true;               // 合并相同的在途查询
+};
+
+struct ForwarderStats {
+    uint64_t submitted;
+    uint64_t coalesced;                 // 挂到相同在途查询上, 未单独发出
+    uint64_t rejected;                  // 表满或查询无效
+    uint64_t sent;                      // 发往上游的报文 (含重发)
+    uint64_t send_errors;
+    uint64_t responses;                 // 匹配到在途查询的上游响应
+    uint64_t mismatched;                // 未知 ID、来源或问题不符
+    uint64_t retries;
+    uint64_t timeouts;                  // 重发用尽, 以 SERVFAIL 完成
+    uint64_t truncated;                 // 超过缓冲区, 以 TC=1 完成
+    uint64_t completed;                 // 已交给 owner
+    uint64_t inflight;
+};
+
+// 待转发的查询; query 只在 submit 期间使用
+struct ForwardRequest {
+    const uint8_t* query;
+    uint32_t len;
+    uint32_t owner;                     // 完成队列
+    uint64_t cookie;                    // 客户端上下文, 原样带回
+};
+
+// 已完成的查询: response 已恢复客户端 ID, release 前有效
+struct ForwardCompletion {
+    const uint8_t* response;
+    uint32_t len;
+    uint32_t entry;
+    uint64_t cookie;
+};
+
+class Forwarder {
+public:
+    explicit Forwarder(const ForwarderOptions& opts);
+    ~Forwarder();
+
+    Forwarder(const Forwarder&) = delete;
+    Forwarder& operator=(const Forwarder&) = delete;
+
+    // 解析上游地址、创建 socket 并启动 I/O 线程
+    bool start();
+
+    // 停止 I/O 线程; 在途查询不再完成
+    void stop();
+
+    // 提交一批查询 (任意线程), 同一 socket 的查询一次 sendmmsg 发出.
+    // accepted[i] 表示第 i 个是否被接受, 返回接受的个数
+    size_t submit(const ForwardRequest* reqs, size_t n, bool* accepted);
+
+    // 取出 owner 的已完成查询; 每个 owner 只能由一个线程调用
+    size_t poll(uint32_t owner, ForwardCompletion* out, size_t max);
+
+    // 归还 poll 取出的表项
+    void release(const ForwardCompletion* done, size_t n);
+
+    ForwarderStats stats() const;
+
+    // I/O 线程使用的本地地址 (测试与诊断)
+    uint16_t localPort(uint32_t socket) const;
+
+    uint32_t numOwners() const { return num_owners_; }
+    bool running() const { return running_.load(std::memory_order_acquire); }
+
+    static constexpr size_t kMaxQuery = 512;
+    static constexpr size_t kMaxResponse = 1232;    // DNS Flag Day 2020 建议的 EDNS 大小
+    static constexpr size_t kBatch = 64;
+
+private:
+    struct Entry;
+    struct Server;
+    struct CompletionQueue;
+
+    // 取得表项 / 归还表项 (Treiber 栈, 高 32 位为防 ABA 标记)
+    uint32_t allocEntry();
+    void freeEntry(uint32_t index);
+
+    // 为表项在 socket 上占用一个随机上游 ID, 改写查询头部
+    bool bindId(uint32_t index, uint32_t socket);
+    void unbindId(const Entry& entry);
+
+    // 按 socket 分组 sendmmsg
+    void sendEntries(const uint32_t* indexes, size_t n);
+
+    void runIo();
+    void receive(uint32_t socket);
+    void expire(uint64_t now_ns);
+
+    // 登记为领头, 或挂到已有的相同查询上; 返回 true 表示已挂上
+    bool coalesceOrLead(uint32_t index);
+
+    // 领头完成: 从合并表摘除并把响应分发给等待者, 然后完成自身 (I/O 线程)
+    void complete(uint32_t index);
+
+    // 表项转为完成状态并放入 owner 的队列
+    void finish(uint32_t index);
+
+    ForwarderOptions opts_;
+    uint32_t num_sockets_;
+    uint32_t num_owners_;
+    uint32_t capacity_;
+    uint64_t timeout_ns_;
+
+    std::unique_ptr<Entry[]> entries_;
+    std::unique_ptr<std::atomic<uint32_t>[]> next_free_;
+    std::atomic<uint64_t> free_head_;
+    std::unique_ptr<std::atomic<uint32_t>[]> ids_;  // num_sockets × 65536, 值为表项 + 1
+    std::unique_ptr<CompletionQueue[]> queues_;
+
+    // 合并表: 按键哈希分桶的领头链表 (表项 + 1), 分段加锁
+    struct alignas(64) KeyLock {
+        std::mutex mutex;
+    };
+    static constexpr size_t kKeyLocks = 64;
+    std::unique_ptr<uint32_t[]> key_buckets_;
+    std::unique_ptr<KeyLock[]> key_locks_;
+
+    std::vector<Server> servers_;
+    std::vector<int> fds_;
+    int family_ = 0;
+
+    std::atomic<uint32_t> next_server_{0};
+    std::atomic<uint64_t> id_seed_;
+    std::thread io_thread_;
+    std::atomic<bool> running_{false};
+
+    std::atomic<uint64_t> submitted_{0};
+    std::atomic<uint64_t> coalesced_{0};
+    std::atomic<uint64_t> rejected_{0};
+    std::atomic<uint64_t> sent_{0};
+    std::atomic<uint64_t> send_errors_{0};
+    std::atomic<uint64_t> responses_{0};
+    std::atomic<uint64_t> mismatched_{0};
+    std::atomic<uint64_t> retries_{0};
+    std::atomic<uint64_t> timeouts_{0};
+    std::atomic<uint64_t> truncated_{0};
+    std::atomic<uint64_t> completed_{0};
+    std::atomic<uint64_t> inflight_{0};
+};
+
+} // namespace xdp_dns
@@ -0,0 +1,68 @@
+#pragma once
+
+#include "common.hpp"
+
+namespace xdp_dns {
+
+// ==================== L2-L4 帧解析 ====================
+//
+// 从以太网帧定位 UDP 负载: 802.1Q / QinQ 标签、IPv4 选项、IPv6 扩展头链
+// 与分片. 结果是偏移与原始地址的 POD, 不分配内存, 不复制负载.
+
+// FrameInfo::flags
+enum FrameFlags : uint8_t {
+    FRAME_VLAN = 0x01,          // 至少一层 VLAN 标签
+    FRAME_QINQ = 0x02,          // 两层 VLAN 标签 (802.1ad / QinQ)
+    FRAME_IPV6 = 0x04,
+    FRAME_IP_OPTIONS = 0x08,    // IPv4 头部带选项 (IHL > 5)
+    FRAME_IPV6_EXT = 0x10,      // IPv6 带扩展头
+    FRAME_FRAGMENT = 0x20,      // 首个分片: UDP 头可用, 负载不完整
+};
+
+constexpr size_t MAX_VLAN_TAGS = 2;
+constexpr size_t MAX_IPV6_EXT_HEADERS = 8;
+
+struct FrameInfo {
+    uint16_t l3_offset;         // IP 头
+    uint16_t l4_offset;         // UDP 头
+    uint16_t payload_offset;    // UDP 负载 (DNS 消息)
+    uint16_t payload_len;       // 受 UDP 长度、IP 长度与帧长共同限制
+    uint16_t src_port;          // 主机字节序
+    uint16_t dst_port;
+    uint16_t vlan_tci[MAX_VLAN_TAGS];   // 外层在前, 主机字节序
+    uint8_t  num_vlans;
+    uint8_t  ip_version;        // 4 或 6
+    uint8_t  flags;             // FrameFlags
+    uint8_t  hop_limit;         // IPv4 TTL / IPv6 hop limit
+    uint8_t  src_mac[6];
+    uint8_t  dst_mac[6];
+    uint8_t  src_addr[16];      // 网络字节序, IPv4 只用前 4 字节
+    uint8_t  dst_addr[16];
+};
+
+static_assert(sizeof(FrameInfo) == 64, "FrameInfo is mirrored by XDPDNSFrameInfo");
+
+class FrameParser {
+public:
+    // 解析单个以太网帧
+    //
+    // 非 IP 或非 UDP (含 ESP 等无法跳过的扩展头) 返回 Error::NotUDP;
+    // 非首个分片返回 Error::Fragmented; 首个分片成功返回并置 FRAME_FRAGMENT.
+    static Error parse(const uint8_t* frame, size_t len, FrameInfo* info);
+
+    // 批量解析 (n ≤ 64), 第 i 位为 1 表示 frames[i] 解析成功
+    static uint64_t parseBatch(
+        const uint8_t* const* frames,
+        const uint32_t* lens,
+        size_t n,
+        FrameInfo* out
+    );
+
+private:
+    static Error parseIPv4(const uint8_t* frame, size_t len, FrameInfo* info,
+                           size_t* l4_offset, size_t* ip_end);
+    static Error parseIPv6(const uint8_t* frame, size_t len, FrameInfo* info,
+                           size_t* l4_offset, size_t* ip_end);
+};
+
+} // namespace xdp_dns
@@ -0,0 +1,111 @@
+#pragma once
+
+#include "response_writer.hpp"
+#include "simd.hpp"
+#include <deque>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+namespace xdp_dns {
+
+// ==================== 本地权威区 (local-data) ====================
+//
+// 内部名字 (split-horizon) 由本地数据直接应答, 不转发上游. 加载时为每个
+// (名字, 查询类型) 预编译好回答区 / 权威区记录 (RRBlob), 应答时只需保留
+// 查询的头部与问题 (ID 与大小写原样带回), 整段复制记录并写回 AA 与计数.
+//
+// 区内规则:
+//   - 名字存在且有该类型: 回答该 RRset (多条 A / AAAA 轮转);
+//   - 名字是 CNAME: 回答 CNAME, 目标在本地数据中时一并回答其 RRset;
+//   - 名字存在 (含空的中间节点) 但无该类型: NODATA + SOA;
+//   - 名字不存在: 最近祖先下有 "*" 时由通配符合成, 否则 NXDOMAIN + SOA.
+// 区顶点没有 SOA 记录时合成 "localhost. nobody.invalid." 的 SOA.
+class LocalZones {
+public:
+    static constexpr uint32_t kDefaultTtl = 3600;
+
+    LocalZones() = default;
+    LocalZones(const LocalZones&) = delete;
+    LocalZones& operator=(const LocalZones&) = delete;
+
+    // 声明区顶点 ("corp.example", 可带结尾的点)
+    Error addZone(std::string_view apex);
+
+    // 添加一条记录: "name [ttl] [IN] type rdata", 支持 A / AAAA / CNAME /
+    // TXT / SRV / PTR / SOA; 名字须在已声明的区内 (compile 时检查)
+    Error addRecord(std::string_view text);
+
+    // 生成名字索引与预编译应答; negative_ttl 用于合成的 SOA
+    Error compile(uint32_t negative_ttl);
+
+    // 查询落在某个本地区内时构建应答并返回长度, 否则返回 0.
+    // domain 为小写点分形式 (DNSParser::decodeName 的输出), response 可与
+    // query 为同一缓冲区
+    size_t answer(const uint8_t* query, const DNSParseResult& parsed,
+                  const char* domain, size_t domain_len,
+                  uint8_t* response, size_t capacity, uint32_t rotation) const;
+
+    bool empty() const { return zones_.empty(); }
+    size_t zoneCount() const { return zones_.size(); }
+    size_t nameCount() const { return nodes_.size(); }
+    size_t recordCount() const { return records_.size(); }
+
+private:
+    static constexpr uint32_t kNone = UINT32_MAX;
+
+    struct Record {
+        std::string owner;              // 小写点分, 无结尾的点
+        uint16_t type;
+        uint32_t ttl;
+        std::vector<uint8_t> rdata;     // 非压缩线上格式
+    };
+
+    struct Zone {
+        std::string apex;
+        uint32_t negative = kNone;      // 权威区只含 SOA 的 blob
+    };
+
+    // 预编译应答; qtype 为 0 的一项是其它类型的默认应答
+    struct Entry {
+        uint16_t qtype;
+        uint8_t rcode;
+        uint32_t blob;
+    };
+
+    struct Node {
+        uint32_t zone;
+        uint32_t wildcard = kNone;      // "*.<本名字>" 的节点
+        uint32_t first_entry = 0;
+        uint32_t num_entries = 0;
+    };
+
+    using Index = std::unordered_map<std::string_view, uint32_t, LabelHash>;
+
+    uint32_t findZone(std::string_view name) const;
+    uint32_t internNode(std::string_view name, uint32_t zone);
+    uint32_t addBlob(RRBlob&& blob);
+    bool compileNode(uint32_t node, const std::vector<uint32_t>& records,
+                     const std::unordered_map<std::string_view, std::vector<uint32_t>>& by_name);
+    size_t respond(const Node& node, uint16_t qtype, const uint8_t* query,
+                   const DNSParseResult& parsed, uint8_t* response, size_t capacity,
+                   uint32_t rotation) const;
+    size_t respondNegative(uint32_t zone, uint8_t rcode, const uint8_t* query,
+                           const DNSParseResult& parsed, uint8_t* response,
+                           size_t capacity) const;
+
+    std::vector<Record> records_;
+    std::deque<Zone> zones_;            // apex 是索引键的存储
+    Index zone_index_;
+
+    std::deque<std::string> names_;     // 节点名字 (索引键的存储)
+    std::vector<Node> nodes_;
+    Index node_index_;
+    std::vector<Entry> entries_;
+    std::vector<RRBlob> blobs_;
+
+    uint64_t tld_mask_ = 0;             // 各区最后一个标签的哈希位, 快速排除区外查询
+};
+
+} // namespace xdp_dns
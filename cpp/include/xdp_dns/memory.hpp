@@ -0,0 +1,129 @@
+#pragma once
+
+#include "common.hpp"
+#include "arena.hpp"
+#include <atomic>
+#include <memory>
+#include <memory_resource>
+
+namespace xdp_dns {
+
+// 内存分类 (与 XDPDNSMemoryStats / XDPDNSShmMemory 字段顺序一致)
+enum class MemCategory : uint8_t {
+    Nodes = 0,      // TrieNode 对象
+    Labels,         // 标签字节
+    Rules,          // Rule 对象及其存储数组
+    Cache,          // 响应/否定缓存
+    Index,          // 哈希表桶、子节点表等辅助索引
+    kCount,
+};
+
+constexpr size_t kMemCategoryCount = static_cast<size_t>(MemCategory::kCount);
+
+const char* memCategoryName(MemCategory c);
+
+// 内存占用快照
+struct MemoryUsage {
+    uint64_t bytes[kMemCategoryCount] = {};  // 按分类请求的字节数
+    uint64_t reserved_bytes = 0;             // 实际占用 (含分配器开销与未用空间)
+    uint64_t allocations = 0;                // 存活分配次数
+    uint64_t huge_page_bytes = 0;            // 由大页支撑的 Arena 字节
+    uint64_t rule_count = 0;
+
+    uint64_t totalBytes() const;
+
+    // 每条规则平均字节数 (按 reserved_bytes 计算)
+    double bytesPerRule() const;
+
+    // 1 - 请求字节 / 实际占用, 0 表示没有浪费
+    double fragmentation() const;
+
+    MemoryUsage& operator+=(const MemoryUsage& other);
+};
+
+// 分配失败: 启用异常时抛 std::bad_alloc, 否则 abort
+[[noreturn]] void allocationFailed();
+
+// 计数内存资源 - 记录请求字节、实际占用和存活分配数, 并累加到父资源
+//
+// 未指定上游时直接使用 malloc, 以 malloc_usable_size 作为实际占用;
+// 指定上游 (Arena) 时实际占用由上游通过 adjustReserved 报告.
+class CountingResource : public std::pmr::memory_resource {
+public:
+    CountingResource() = default;
+    explicit CountingResource(CountingResource* parent,
+                              std::pmr::memory_resource* upstream = nullptr)
+        : parent_(parent), upstream_(upstream) {}
+
+    void setParent(CountingResource* parent) { parent_ = parent; }
+    void setUpstream(std::pmr::memory_resource* upstream) { upstream_ = upstream; }
+
+    uint64_t bytes() const { return bytes_.load(std::memory_order_relaxed); }
+    uint64_t reserved() const { return reserved_.load(std::memory_order_relaxed); }
+    uint64_t allocations() const { return allocations_.load(std::memory_order_relaxed); }
+    uint64_t hugePageBytes() const { return huge_bytes_.load(std::memory_order_relaxed); }
+
+    // 上游映射/释放内存时调整实际占用 (huge: 这部分由大页支撑)
+    void adjustReserved(int64_t delta, bool huge = false);
+
+    // 上游被整体释放: 从父资源中扣除本资源剩余的计数并清零
+    void releaseAll();
+
+private:
+    void* do_allocate(size_t bytes, size_t alignment) override;
+    void do_deallocate(void* p, size_t bytes, size_t alignment) override;
+    bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override {
+        return this == &other;
+    }
+
+    void account(int64_t bytes, int64_t reserved, int64_t allocations);
+
+    CountingResource* parent_ = nullptr;
+    std::pmr::memory_resource* upstream_ = nullptr;
+    std::atomic<uint64_t> bytes_{0};
+    std::atomic<uint64_t> reserved_{0};
+    std::atomic<uint64_t> allocations_{0};
+    std::atomic<uint64_t> huge_bytes_{0};
+};
+
+// 一组按分类计数的资源 (每代 Trie / 每个 FilterEngine 一份)
+//
+// 所有实例都累加到 global(), 供 C API 和共享内存统计报告进程级占用.
+// 启用 Arena 后节点、标签、规则和索引各自使用独立的 Arena (索引经
+// 池资源复用 rehash 释放的桶), 析构时整体释放, 无需逐个 deallocate.
+class MemoryAccounting {
+public:
+    MemoryAccounting();
+    explicit MemoryAccounting(const ArenaOptions& arena);
+    ~MemoryAccounting();
+
+    MemoryAccounting(const MemoryAccounting&) = delete;
+    MemoryAccounting& operator=(const MemoryAccounting&) = delete;
+
+    std::pmr::memory_resource* resource(MemCategory c) {
+        return &resources_[static_cast<size_t>(c)];
+    }
+
+    // 是否由 Arena 支撑 (此时逐个释放可以省略)
+    bool usesArenas() const { return arenas_[0] != nullptr; }
+
+    // 规则数增减 (同步累加到 global)
+    void addRules(int64_t delta);
+
+    MemoryUsage usage() const;
+
+    // 进程级汇总
+    static MemoryAccounting& global();
+
+private:
+    struct GlobalTag {};
+    explicit MemoryAccounting(GlobalTag);
+
+    CountingResource resources_[kMemCategoryCount];
+    std::unique_ptr<Arena> arenas_[kMemCategoryCount];
+    std::unique_ptr<std::pmr::unsynchronized_pool_resource> index_pool_;
+    std::atomic<int64_t> rule_count_{0};
+    MemoryAccounting* parent_ = nullptr;
+};
+
+} // namespace xdp_dns
@@ -0,0 +1,43 @@
+#pragma once
+
+#include "common.hpp"
+#include <vector>
+
+namespace xdp_dns {
+
+// ==================== NUMA 放置 ====================
+//
+// 直接读取 sysfs 并通过 mbind 系统调用绑定, 不依赖 libnuma.
+// 单节点主机上所有函数都退化为空操作.
+
+constexpr int kNumaNodeAny = -1;
+
+// 在线 NUMA 节点数 (读取失败时返回 1)
+int numaNodeCount();
+
+// 在线 NUMA 节点号, 升序; 节点号可能不连续 (如 "0,2"), 读取失败时为 {0}
+const std::vector<int>& numaOnlineNodes();
+
+// node 是否为在线节点
+bool numaNodeOnline(int node);
+
+// 解析 sysfs 节点列表 ("0-1,3")
+std::vector<int> numaParseNodeList(const char* list);
+
+// 指定 CPU 所在节点, 未知返回 kNumaNodeAny
+int numaNodeOfCpu(int cpu);
+
+// 调用线程当前所在节点
+int numaCurrentNode();
+
+// 调用线程所在节点, 每个线程首次调用时确定后缓存 (热路径使用, 工作线程应绑核)
+int numaLocalNode();
+
+// 网卡所在节点 (/sys/class/net/<ifname>/device/numa_node), 未知返回 kNumaNodeAny
+int numaNodeOfNetdev(const char* ifname);
+
+// 将 [addr, addr+len) 的页面优先放到 node 上 (MPOL_PREFERRED)
+// 必须在页面首次访问前调用; node < 0 或单节点主机时直接返回 true
+bool numaBind(void* addr, size_t len, int node);
+
+} // namespace xdp_dns
@@ -0,0 +1,37 @@
+#pragma once
+
+// USDT 静态探针 (provider: xdp_dns)
+//
+// 启用时每个探针只是一条 nop 指令, 参数使用已在寄存器中的值;
+// bpftrace / perf 附加后才会触发. 未找到 <sys/sdt.h> 或 ENABLE_USDT=OFF
+// 时展开为空语句. 探针列表见 tools/usdt/README.md.
+//
+//   parse__start        (const uint8_t* data, size_t len)
+//   parse__end          (int err, uint16_t qtype)
+//   match               (const char* domain, size_t len, uint32_t rule_id, int action)
+//   filter__check       (const char* domain, size_t len, uint32_t rule_id, int action)
+//   response__built     (uint8_t rcode, uint16_t an_count, size_t len)
+//   reload__start       (size_t rule_count)
+//   reload__end         (size_t rule_count)
+//   bridge__parse__start(const uint8_t* data, size_t len)
+//   bridge__parse__end  (int ret, const char* domain)
+//   bridge__build       (int kind, int ret, size_t len)
+
+#if defined(XDP_DNS_ENABLE_USDT) && defined(__has_include)
+#if __has_include(<sys/sdt.h>)
+#include <sys/sdt.h>
+#define XDP_DNS_USDT_ACTIVE 1
+#endif
+#endif
+
+#ifdef XDP_DNS_USDT_ACTIVE
+#define XDP_DNS_PROBE1(name, a1) DTRACE_PROBE1(xdp_dns, name, a1)
+#define XDP_DNS_PROBE2(name, a1, a2) DTRACE_PROBE2(xdp_dns, name, a1, a2)
+#define XDP_DNS_PROBE3(name, a1, a2, a3) DTRACE_PROBE3(xdp_dns, name, a1, a2, a3)
+#define XDP_DNS_PROBE4(name, a1, a2, a3, a4) DTRACE_PROBE4(xdp_dns, name, a1, a2, a3, a4)
+#else
+#define XDP_DNS_PROBE1(name, a1) do {} while (0)
+#define XDP_DNS_PROBE2(name, a1, a2) do {} while (0)
+#define XDP_DNS_PROBE3(name, a1, a2, a3) do {} while (0)
+#define XDP_DNS_PROBE4(name, a1, a2, a3, a4) do {} while (0)
+#endif
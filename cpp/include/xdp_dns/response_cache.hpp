@@ -0,0 +1,186 @@
+#pragma once
+
+#include "dns_parser.hpp"
+#include "memory.hpp"
+#include <atomic>
+#include <memory>
+#include <mutex>
+
+namespace xdp_dns {
+
+// ==================== 线上格式响应缓存 ====================
+//
+// 以 (小写 QNAME, QTYPE, QCLASS, EDNS/DO) 为键保存上游响应的原始报文.
+// 命中时整段复制, 换上客户端的 ID、RD 位与问题名大小写, 按插入时间原地
+// 递减各记录的 TTL, 不重新编码.
+//
+// 分片 × 组相联: 键哈希选定分片与组, 每组 kWays 个定长槽, 组内 CLOCK
+// 淘汰 (命中置引用位, 插入时指针跳过并清除有引用位的槽). 全部内存在构造
+// 时一次分配 (计入 MemCategory::Cache), 之后不再增长.
+//
+// 预取与过期应答: 命中落在条目 TTL 的最后 prefetch_percent% 时, lookup 通过
+// refresh 要求调用方异步向上游刷新; 过期后 stale_window 秒内仍以 stale_ttl
+// 应答并要求刷新 (RFC 8767), 上游慢或不可用时不会让热点条目全部未命中.
+// 同一条目每 kRefreshIntervalNs 最多要求一次刷新, 刷新结果经 insert 覆盖原槽.
+//
+// 否定应答: NXDOMAIN 与 NODATA 按同样的键缓存, TTL 取权威区 SOA 的
+// min(TTL, MINIMUM) (RFC 2308). 不带 CNAME 的 NXDOMAIN 同时记为截断点
+// (RFC 8020): 键为 (节点名, kCutType, QCLASS), 保存非压缩的 SOA, 之后
+// 该节点及其下任何名字、任何类型的查询未命中时都直接以 NXDOMAIN 应答.
+// DO 查询需要 NSEC 证明, 不走截断点.
+
+struct ResponseCacheOptions {
+    uint32_t capacity = 10000;      // 总槽数, 向上取整到 shards × kWays 的倍数
+    uint32_t shards = 16;           // 取整到 2 的幂
+    uint32_t max_entry_size = 512;  // 更长的响应不缓存
+    uint32_t max_ttl = 300;         // TTL 上限 (秒), 0 不限制
+    uint32_t prefetch_percent = 10; // 剩余 TTL 不足原 TTL 该百分比时要求刷新, 0 关闭
+    uint32_t stale_window = 0;      // 过期后仍可应答的时长 (秒), 0 关闭
+    uint32_t stale_ttl = 30;        // 过期应答的 TTL (秒, RFC 8767 建议 30)
+    uint32_t max_negative_ttl = 300; // 否定应答 TTL 上限 (秒), 0 不限制
+    bool nxdomain_cut = true;       // NXDOMAIN 覆盖其下所有名字 (RFC 8020)
+};
+
+struct ResponseCacheStats {
+    uint64_t hits;                  // 含过期应答
+    uint64_t misses;                // 含已过期
+    uint64_t stale_hits;            // 过期后在 stale_window 内应答
+    uint64_t prefetches;            // 要求调用方刷新的次数
+    uint64_t cut_hits;              // 由 NXDOMAIN 截断点应答
+    uint64_t expired;               // 超过 stale_window 被清除
+    uint64_t inserts;
+    uint64_t negative_inserts;      // 其中的否定应答
+    uint64_t evictions;             // 淘汰仍有效的条目
+    uint64_t rejected;              // 不可缓存的响应
+    uint64_t entries;               // 当前占用的槽 (含已过期未清除)
+};
+
+class ResponseCache {
+public:
+    explicit ResponseCache(const ResponseCacheOptions& opts = ResponseCacheOptions());
+    ~ResponseCache();
+
+    ResponseCache(const ResponseCache&) = delete;
+    ResponseCache& operator=(const ResponseCache&) = delete;
+
+    // 命中时把响应写入 response (可与 query 为同一缓冲区), 返回长度;
+    // 未命中、已过期或缓冲区不足返回 0. refresh 非空时置为是否需要刷新
+    // (预取窗口内或过期应答), 调用方据此用 buildRefreshQuery 发起刷新
+    size_t lookup(
+        const uint8_t* query,
+        size_t query_len,
+        const DNSParseResult& parsed,
+        uint64_t now_ns,
+        uint8_t* response,
+        size_t response_buf_size,
+        bool* refresh = nullptr
+    );
+
+    // 由缓存应答还原等价查询 (问题部分原样, RD=1, 带 OPT 时保留 DO),
+    // 刷新结果与原条目键相同; 返回长度, 响应无效或缓冲区不足返回 0
+    static size_t buildRefreshQuery(const uint8_t* response, size_t len, uint16_t id,
+                                    uint8_t* out, size_t out_size);
+
+    // 插入上游响应; 不可缓存时返回 false
+    //
+    // 缓存完整响应 (TC=0): 带回答记录的 NOERROR, 以及权威区带 SOA 的
+    // NXDOMAIN / NODATA. 其它 RCODE、最小 TTL 为 0、超过 max_entry_size
+    // 或记录数超过 kMaxRecords 的响应被拒绝.
+    bool insert(const uint8_t* response, size_t len, uint64_t now_ns);
+
+    // 清空所有条目 (统计保留)
+    void clear();
+
+    ResponseCacheStats stats() const;
+    MemoryUsage memoryUsage() const { return memory_.usage(); }
+    size_t capacity() const { return static_cast<size_t>(num_shards_) * sets_ * kWays; }
+
+    static constexpr size_t kWays = 8;
+    static constexpr size_t kMaxRecords = 24;
+    static constexpr uint64_t kRefreshIntervalNs = 1000000000ULL;
+    static constexpr uint16_t kCutType = 0;         // 截断点条目的 QTYPE (保留值)
+
+private:
+    // 槽元数据, 报文本身在 Shard::data 中按槽下标定长存放
+    struct Slot {
+        uint64_t key;               // 0 表示空槽
+        uint64_t inserted_ns;
+        uint64_t expires_ns;
+        uint64_t refresh_ns;        // 上次要求刷新的时间, 0 表示未要求
+        uint16_t len;
+        uint8_t  name_len;          // 问题名线上长度 (QNAME 从偏移 12 开始)
+        uint8_t  edns;              // EdnsFlags
+        uint8_t  num_ttls;
+        uint8_t  referenced;        // CLOCK 引用位
+        uint16_t ttl_offsets[kMaxRecords];
+    };
+
+    struct alignas(64) Shard {
+        std::mutex mutex;
+        Slot* slots = nullptr;      // sets_ × kWays
+        uint8_t* data = nullptr;    // sets_ × kWays × entry_size_
+        uint8_t* hands = nullptr;   // 每组的 CLOCK 指针
+
+        uint64_t hits = 0;
+        uint64_t misses = 0;
+        uint64_t stale_hits = 0;
+        uint64_t prefetches = 0;
+        uint64_t cut_hits = 0;
+        uint64_t expired = 0;
+        uint64_t inserts = 0;
+        uint64_t negative_inserts = 0;
+        uint64_t evictions = 0;
+    };
+
+    // 键哈希 (非 0), lowered 为小写问题名
+    static uint64_t makeKey(const uint8_t* lowered, size_t name_len, uint16_t qtype,
+                            uint16_t qclass, uint8_t edns);
+
+    Shard& shardOf(uint64_t key) { return shards_[key & (num_shards_ - 1)]; }
+    size_t setOf(uint64_t key) const {
+        return static_cast<size_t>(((key >> 32) * sets_) >> 32);
+    }
+    uint8_t* slotData(Shard& shard, size_t slot) { return shard.data + slot * entry_size_; }
+
+    // 组内查找与 key、问题一致的槽, 没有时返回 kWays
+    size_t findWay(Shard& shard, size_t base, uint64_t key, const uint8_t* lowered,
+                   size_t name_len, uint16_t qtype, uint16_t qclass, uint8_t edns);
+
+    // 截断点查找: 问题名及各级祖先, 命中时以节点的 SOA 合成 NXDOMAIN
+    size_t lookupCut(const uint8_t* name, const uint8_t* lowered, size_t name_len,
+                     uint16_t qtype, uint16_t qclass, uint16_t id, uint16_t rd, uint8_t edns,
+                     uint64_t now_ns, uint8_t* response, size_t response_buf_size);
+
+    // 换上客户端的 ID、RD 位与问题名
+    static void patchClient(uint8_t* response, uint16_t id, uint16_t rd, const uint8_t* name,
+                            size_t name_len);
+
+    // 各记录 TTL 减去插入以来的整秒数
+    static void decrementTtls(uint8_t* response, const Slot& slot, uint64_t now_ns);
+
+    // 由 NXDOMAIN 响应的 SOA 生成截断点条目
+    void insertCut(const uint8_t* response, size_t len, const uint8_t* lowered,
+                   size_t name_len, uint16_t qclass, uint64_t now_ns);
+
+    // 选槽 (同一问题 / 空槽或过期槽 / CLOCK 淘汰) 并写入条目
+    void store(const uint8_t* data, size_t len, const uint8_t* lowered, size_t name_len,
+               uint16_t qtype, uint16_t qclass, uint8_t edns, const uint16_t* ttl_offsets,
+               const uint32_t* ttls, size_t num_ttls, uint32_t min_ttl, bool negative,
+               uint64_t now_ns);
+
+    MemoryAccounting memory_;
+    std::unique_ptr<Shard[]> shards_;
+    uint32_t num_shards_;
+    uint32_t sets_;                 // 每分片的组数
+    uint32_t entry_size_;
+    uint32_t max_ttl_;
+    uint32_t prefetch_percent_;
+    uint64_t stale_window_ns_;
+    uint32_t stale_ttl_;
+    uint32_t max_negative_ttl_;
+    bool nxdomain_cut_;
+    std::atomic<uint64_t> rejected_{0};
+    std::atomic<uint64_t> cut_inserts_{0};          // 为 0 时未命中不查截断点
+};
+
+} // namespace xdp_dns
@@ -0,0 +1,160 @@
+#pragma once
+
+#include "dns_parser.hpp"
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace xdp_dns {
+
+// ==================== 应答记录写入 ====================
+//
+// 在调用者的缓冲区 (可以就是 RX 帧) 上逐条追加回答记录, 不分配内存.
+//
+// 名字压缩: 写出的每个非压缩标签按 "后缀哈希 → 报文内偏移" 登记在小字典
+// 里; 之后的名字从最长后缀开始查字典, 命中 (并逐字节确认) 后只写出前面的
+// 标签与一个压缩指针. 问题名在第一次写名字时登记, 以问题名为所有者的
+// 记录直接写 0xC00C.
+//
+// 预编译: 规则的固定应答 (重定向的 CNAME 与地址) 在加载时用同一个写入器
+// 编译成 RRBlob. blob 内指向 blob 自身名字的压缩指针以 blob 起点为基准
+// 保存, addBlob 整段复制后加上写入位置即可; 末尾等长的 A / AAAA 记录按
+// rotation 轮转起点 (round-robin).
+
+// 预编译的回答记录
+struct RRBlob {
+    std::vector<uint8_t> wire;
+    std::vector<uint16_t> relocs;   // 需要重定位的压缩指针在 wire 中的偏移
+    uint16_t count = 0;             // 回答区记录数
+    uint16_t ns_count = 0;          // 其后的权威区记录数
+    uint16_t rotate_offset = 0;     // 可轮转记录的起点
+    uint16_t rotate_size = 0;       // 每条长度
+    uint16_t rotate_count = 0;      // 条数, 小于 2 时不轮转
+};
+
+class ResponseWriter {
+public:
+    static constexpr size_t kDictSize = 16;
+    static constexpr size_t kMaxRelocs = 64;
+    static constexpr size_t kMaxRecords = 64;   // 仅编译 blob 时记录
+
+    // 以 query 的头部与问题部分开始响应: QR/RA 置位, RCODE=NOERROR, 各计数
+    // 清零. response 可与 query 为同一缓冲区. 空间不足返回 false
+    bool begin(const uint8_t* query, const DNSParseResult& parsed,
+               uint8_t* response, size_t capacity);
+
+    // 开始编译 RRBlob: 字典为空, 指向 blob 内部的指针记为重定位项
+    void beginBlob(uint8_t* buf, size_t capacity);
+
+    // owner / target 为非压缩线上格式名字, owner 为 nullptr 表示问题名.
+    // 失败 (空间不足) 后的追加一律忽略, finish 返回 0
+    bool addA(const uint8_t* owner, uint32_t ttl, uint32_t ip);     // ip 网络字节序
+    bool addAAAA(const uint8_t* owner, uint32_t ttl, const uint8_t* ip6);
+    bool addCNAME(const uint8_t* owner, uint32_t ttl, const uint8_t* target);
+    bool addPTR(const uint8_t* owner, uint32_t ttl, const uint8_t* target);
+    bool addTXT(const uint8_t* owner, uint32_t ttl, const char* text, size_t len);
+    // RDATA 原样写出 (其中的名字不压缩, 如 SRV / SOA)
+    bool addRaw(const uint8_t* owner, uint16_t type, uint32_t ttl,
+                const uint8_t* rdata, size_t rdata_len);
+
+    // 之后的记录写入权威区 (不能再回到回答区)
+    void beginAuthority() { authority_ = true; }
+
+    // 追加预编译记录 (须在 beginAuthority 之前), rotation 选择轮转起点
+    bool addBlob(const RRBlob& blob, uint32_t rotation);
+
+    void setRCode(uint8_t rcode) { rcode_ = rcode; }
+    void setAuthoritative(bool aa) { aa_ = aa; }
+
+    // 写回计数、AA 与 RCODE, 返回响应长度; 之前有追加失败时返回 0
+    size_t finish();
+
+    // 导出 beginBlob 之后写入的记录
+    bool finishBlob(RRBlob* out) const;
+
+    size_t length() const { return pos_; }
+
+    // "www.example.com" (可带结尾的点) → 非压缩线上格式, 返回长度;
+    // 空名字为根. 标签为空或过长时返回 0
+    static size_t encodeName(const char* name, size_t len, uint8_t* out, size_t out_size);
+
+private:
+    bool beginRecord(const uint8_t* owner, uint16_t type, uint32_t ttl, size_t rdata_len);
+    void rememberQuestion();
+    bool writeName(const uint8_t* name);
+    void writePointer(size_t target);
+    bool suffixEquals(const uint8_t* name, size_t offset) const;
+    void remember(uint32_t hash, size_t offset);
+    bool fail() { failed_ = true; return false; }
+
+    struct DictEntry {
+        uint32_t hash;
+        uint16_t offset;
+    };
+
+    uint8_t* buf_ = nullptr;
+    size_t capacity_ = 0;
+    size_t pos_ = 0;
+    bool blob_ = false;
+    bool failed_ = false;
+    bool authority_ = false;
+    bool aa_ = false;
+    uint8_t rcode_ = 0;
+    uint16_t an_count_ = 0;
+    uint16_t ns_count_ = 0;
+    size_t question_ = 0;           // 待登记的问题名偏移, 0 表示无
+
+    DictEntry dict_[kDictSize];
+    size_t dict_len_ = 0;
+
+    // 仅 blob 模式
+    uint16_t relocs_[kMaxRelocs];
+    size_t num_relocs_ = 0;
+    uint16_t starts_[kMaxRecords];
+    uint16_t types_[kMaxRecords];
+};
+
+// ==================== 规则的预编译应答 ====================
+
+// 重定向规则按查询类型选用的记录
+struct RedirectAnswer {
+    RRBlob a;                       // A / ANY 查询: [CNAME] + A
+    RRBlob aaaa;                    // AAAA 查询: [CNAME] + AAAA
+    RRBlob other;                   // 其它类型: [CNAME], 为空时回答 NODATA
+
+    const RRBlob& forType(uint16_t qtype) const {
+        if (qtype == dns_type::A || qtype == dns_type::ANY) return a;
+        if (qtype == dns_type::AAAA) return aaaa;
+        return other;
+    }
+
+    // 编译: cname 为非压缩线上格式目标 (可为 nullptr); 地址为网络字节序,
+    // v6 为连续的 num_v6 个 16 字节地址
+    static bool compile(const uint8_t* cname, const uint32_t* v4, size_t num_v4,
+                        const uint8_t* v6, size_t num_v6, uint32_t ttl,
+                        RedirectAnswer* out);
+};
+
+// 规则集的应答表: 与规则、本地权威区一起由解析器填充, 随规则集所属的
+// FilterEngine 发布与释放, 重新加载规则不会累积旧应答. 相同内容去重,
+// Rule::answer 保存句柄, 只在同一张表内有效. 发布后只读, 可并发 get.
+class AnswerTable {
+public:
+    // 登记应答, 返回句柄 (从 1 开始); 表满 (65535 个不同应答) 返回 0
+    uint16_t intern(RedirectAnswer&& answer);
+
+    // 0 或未知句柄返回 nullptr
+    const RedirectAnswer* get(uint16_t handle) const {
+        return handle && handle <= answers_.size() ? answers_[handle - 1].get() : nullptr;
+    }
+
+    size_t size() const { return answers_.size(); }
+    bool empty() const { return answers_.empty(); }
+
+private:
+    std::vector<std::unique_ptr<RedirectAnswer>> answers_;
+    std::unordered_map<std::string, uint16_t> index_;
+};
+
+} // namespace xdp_dns
@@ -0,0 +1,72 @@
+#pragma once
+
+#include "common.hpp"
+#include "ring_shm.h"
+#include <string>
+
+namespace xdp_dns {
+
+// 共享内存中的 SPSC 环 (协议见 ring_shm.h)
+//
+// 一个 ShmRing 对象只能由一方使用: 生产者只调用 push, 消费者只调用 pop.
+// 各自缓存对端的计数, 只有缓存值显示满 / 空时才读取对端缓存行.
+class ShmRing {
+public:
+    ShmRing() = default;
+    ShmRing(XDPDNSRingHeader* header, XDPDNSRingMsg* slots);
+
+    // 环满时计入 dropped 并返回 false, 从不阻塞
+    bool push(const XDPDNSRingMsg& msg);
+
+    bool pop(XDPDNSRingMsg* msg);
+
+    // 当前积压的记录数 (近似值)
+    size_t size() const;
+    uint64_t dropped() const;
+
+    bool valid() const { return header_ != nullptr; }
+
+private:
+    XDPDNSRingHeader* header_ = nullptr;
+    XDPDNSRingMsg* slots_ = nullptr;
+    uint64_t mask_ = 0;
+    uint64_t cached_peer_ = 0;   // 生产者缓存 tail, 消费者缓存 head
+};
+
+// 共享内存环形通道 - 1 个控制环 + 每个 worker 1 个事件环
+class RingChannel {
+public:
+    RingChannel() = default;
+    ~RingChannel();
+
+    RingChannel(const RingChannel&) = delete;
+    RingChannel& operator=(const RingChannel&) = delete;
+
+    // 创建 (或覆盖) /dev/shm/<name>; capacity 向上取整为 2 的幂
+    bool create(const char* name, uint32_t num_event_rings, uint32_t capacity);
+
+    // 映射已存在的通道, 校验 magic 和版本 (对端 / 测试使用)
+    bool open(const char* name);
+
+    // 解除映射; 创建者同时删除共享内存对象
+    void close();
+
+    bool isOpen() const { return region_ != nullptr; }
+    uint32_t numEventRings() const;
+
+    // 返回新的环视图 (每个使用者各持有一个)
+    ShmRing control() const;
+    ShmRing events(uint32_t index) const;
+
+    static size_t regionSize(uint32_t num_event_rings, uint32_t capacity);
+
+private:
+    ShmRing ring(XDPDNSRingHeader* header) const;
+
+    XDPDNSRingRegion* region_ = nullptr;
+    size_t size_ = 0;
+    std::string name_;
+    bool owner_ = false;
+};
+
+} // namespace xdp_dns
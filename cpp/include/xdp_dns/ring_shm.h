@@ -0,0 +1,100 @@
+#ifndef XDP_DNS_RING_SHM_H
+#define XDP_DNS_RING_SHM_H
+
+/*
+ * 共享内存环形通道布局 (Go 控制面 ↔ C++ 数据面)
+ *
+ * C++ Dataplane 创建 /dev/shm/<name>, 区域内包含:
+ *   - 1 个控制环: Go 写入规则增量与配置变更, C++ 控制线程读取并应用到引擎
+ *   - 每个 worker 1 个事件环: worker 写入采样 / 日志事件, Go 读取
+ * 每个环只有一个生产者和一个消费者 (SPSC), 双方只用原子读写, 无锁、
+ * 无系统调用、无 cgo.
+ *
+ * 环协议 (head / tail 为单调递增的记录计数, 槽下标 = 计数 & (capacity-1)):
+ *   生产者: t = tail (acquire); head - t == capacity 时环满, dropped++ 并放弃;
+ *           否则写槽 head, 再 head = head + 1 (release)
+ *   消费者: h = head (acquire); tail == h 时为空; 否则读槽 tail,
+ *           再 tail = tail + 1 (release)
+ *
+ * 创建者最后以 release 写入 magic, 对端看到 magic 后其余头部字段有效.
+ * 布局只允许在末尾追加字段; 不兼容的修改必须提升 XDP_DNS_RING_VERSION.
+ * 所有字段为主机字节序.
+ */
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define XDP_DNS_RING_MAGIC        0x474e5258u   /* "XRNG" */
+#define XDP_DNS_RING_VERSION      1
+#define XDP_DNS_RING_MAX_WORKERS  64
+#define XDP_DNS_RING_DEFAULT_NAME "/xdp_dns_ring"
+
+// 消息类型
+typedef enum {
+    // 事件 (C++ → Go)
+    XDP_DNS_RING_EVENT_SAMPLE = 1,      // 每 sample_interval 个查询采样一个
+    XDP_DNS_RING_EVENT_LOG = 2,         // 命中 Log 规则 (log_blocked 时也包括阻断/重定向)
+
+    // 控制 (Go → C++)
+    XDP_DNS_RING_CTRL_ADD_RULE = 16,    // 添加规则: domain + id/action/block_mode/redirect_ip/ttl/rule_id
+    XDP_DNS_RING_CTRL_REMOVE_RULE = 17, // 按 domain 删除规则
+    XDP_DNS_RING_CTRL_LOAD_RULES = 18,  // domain 字段为 RuleSet YAML 路径, 整体替换
+    XDP_DNS_RING_CTRL_SET_SAMPLE = 19,  // value 为新的采样间隔, 0 关闭采样
+} XDPDNSRingMsgType;
+
+// 消息 (320 字节, 5 个缓存行)
+typedef struct {
+    uint16_t type;                  // XDPDNSRingMsgType
+    uint16_t qtype;
+    uint16_t domain_len;
+    uint8_t  action;                // XDPDNSAction
+    uint8_t  block_mode;            // XDPDNSBlockMode (ADD_RULE 与事件)
+    uint32_t id;                    // 规则数字 ID
+    uint32_t redirect_ip;           // 网络字节序
+    uint32_t ttl;
+    uint32_t value;                 // 事件: worker 序号; SET_SAMPLE: 采样间隔
+    uint64_t timestamp_ns;          // CLOCK_REALTIME
+    char     rule_id[32];
+    char     domain[256];           // NUL 结尾
+} XDPDNSRingMsg;
+
+// 单个环的头部 (3 个缓存行, 生产者与消费者各写各的)
+typedef struct {
+    uint32_t capacity;              // 槽数, 2 的幂
+    uint32_t reserved0;
+    uint64_t slots_offset;          // 槽数组相对区域起始的字节偏移
+    uint64_t reserved1[6];
+
+    uint64_t head;                  // 生产者: 已发布的记录数
+    uint64_t dropped;               // 生产者: 环满丢弃的记录数
+    uint64_t head_pad[6];
+
+    uint64_t tail;                  // 消费者: 已消费的记录数
+    uint64_t tail_pad[7];
+} XDPDNSRingHeader;
+
+typedef struct {
+    // ---- 头部 (64 字节) ----
+    uint32_t magic;
+    uint32_t version;
+    uint32_t size;                  // 整个区域的字节数
+    uint32_t num_event_rings;       // 有效的 events[] 条目数 (= worker 数)
+    uint32_t msg_size;              // sizeof(XDPDNSRingMsg)
+    uint32_t reserved0;
+    uint64_t start_time_ns;         // 创建时间 (CLOCK_REALTIME)
+    uint64_t reserved[4];
+
+    XDPDNSRingHeader control;
+    XDPDNSRingHeader events[XDP_DNS_RING_MAX_WORKERS];
+
+    // 之后依次为控制环与各事件环的槽数组 (偏移见各自的 slots_offset)
+} XDPDNSRingRegion;
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // XDP_DNS_RING_SHM_H
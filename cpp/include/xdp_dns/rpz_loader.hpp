@@ -0,0 +1,47 @@
+#pragma once
+
+#include "rule_loader.hpp"
+#include <string_view>
+
+namespace xdp_dns {
+
+// ==================== RPZ (Response Policy Zone) ====================
+//
+// 把威胁情报厂商发布的 RPZ 区文件 (主文件格式) 直接编译为规则, 追加到 out,
+// 再经 DomainTrie::updateRules 批量构建; 不经过 YAML.
+//
+// 触发器只支持 QNAME: 区内名字 "name" 精确匹配, "*.name" 只匹配其子域名
+// (Rule::subdomains_only; 与 YAML 的 "*.name" 不同, name 本身需要单独的
+// 触发器). 动作:
+//   CNAME .                → Block / NXDOMAIN
+//   CNAME *.               → Block / NODATA
+//   CNAME rpz-passthru.    → Allow (旧式的 CNAME 指向自身同样视为 PASSTHRU)
+//   CNAME rpz-drop.        → Block / Drop
+//   CNAME <其它名字>        → Redirect 到该 CNAME (local data)
+//   A / AAAA               → Redirect 到这些地址 (local data, 多地址轮转)
+// rpz-ip / rpz-nsip / rpz-nsdname / rpz-client-ip 触发器、rpz-tcp-only、通配
+// CNAME 目标及其它类型的 local data 不支持, 计入 skipped; 区顶点的 SOA / NS
+// 不计入. 同一名字的记录须相邻 (服务器导出的区文件总是如此).
+//
+// CNAME 改写与多地址的 local data 编译到 answers (见 parseRuleYaml); answers
+// 为 nullptr 时这些触发器计入 skipped, 单个 A 记录仍走 redirect_ip.
+//
+// 规则的 rule_id 为区名 (截断到 31 字节), id 为规则在 out 中的位置 (从 1 开始),
+// 多个区追加到同一列表时不重复.
+struct RpzStats {
+    size_t records = 0;     // 资源记录数
+    size_t triggers = 0;    // 输出的规则数
+    size_t skipped = 0;     // 未转换为规则的记录 (不支持的触发器 / 动作 / 类型)
+};
+
+// 解析 RPZ 区. origin 为区名, 为空时取第一个 $ORIGIN 或 SOA 记录的所有者名.
+// 支持 $ORIGIN / $TTL, 括号续行, ";" 注释, 省略所有者 / TTL / 类, BIND 风格
+// TTL ("1h30m"); $INCLUDE 与语法错误返回 InvalidRule.
+Error parseRpzZone(const char* data, size_t len, std::string_view origin,
+                   RuleEntries* out, RpzStats* stats = nullptr, AnswerTable* answers = nullptr);
+
+// mmap 文件后按 parseRpzZone 解析, 不复制文件内容
+Error loadRpzFile(const char* path, std::string_view origin, RuleEntries* out,
+                  RpzStats* stats = nullptr, AnswerTable* answers = nullptr);
+
+} // namespace xdp_dns
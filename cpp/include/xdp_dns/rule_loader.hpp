@@ -0,0 +1,40 @@
+#pragma once
+
+#include "common.hpp"
+#include "local_zone.hpp"
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace xdp_dns {
+
+// (域名, 规则) 列表, DomainTrie::updateRules 的输入
+using RuleEntries = std::vector<std::pair<std::string, Rule>>;
+
+// 解析 pkg/filter RuleSet YAML 的 rules 部分
+//
+// 支持 writeRuleYaml / configs/rules.yaml 使用的子集: 块列表与 [a, b] 流式列表,
+// 单/双引号标量, # 注释. 未启用的规则被跳过; 每个域名只输出一次, 由 priority
+// 最高的规则生效 (相同时后出现者生效).
+//
+// 顶层键 any_policy (forward | hinfo | truncate) 与 any_ttl 写入 policy
+// (可为 nullptr), 未出现时取默认值. local_zones (区顶点列表) 与 local_data
+// (记录文本列表, 见 LocalZones::addRecord) 加载到 zones 并完成编译, zones 为
+// nullptr 时忽略; 其它顶层键 (ip_blacklist 等) 忽略.
+//
+// rpz_files 列出 RPZ 区文件 ("路径 [区名]", 见 loadRpzFile), 其触发器排在
+// YAML 规则之前输出, 同名时 YAML 规则在 Trie 中覆盖 RPZ 触发器. YAML 规则的
+// id 为其在 rules 中的序号 (从 1 开始), RPZ 触发器的 id 依次排在其后.
+//
+// 重定向的 redirect_ips / redirect_cname 与 RPZ local data 编译到 answers,
+// Rule::answer 为其中的句柄; answers 应与规则一起交给 FilterEngine. answers
+// 为 nullptr 时重定向只回答第一个 IPv4 地址.
+Error parseRuleYaml(const char* data, size_t len, RuleEntries* out,
+                    RuleSetPolicy* policy = nullptr, LocalZones* zones = nullptr,
+                    AnswerTable* answers = nullptr);
+
+// 读取文件后按 parseRuleYaml 解析
+Error loadRuleFile(const char* path, RuleEntries* out, RuleSetPolicy* policy = nullptr,
+                   LocalZones* zones = nullptr, AnswerTable* answers = nullptr);
+
+} // namespace xdp_dns
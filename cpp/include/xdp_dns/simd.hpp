@@ -0,0 +1,120 @@
+#pragma once
+
+#include "common.hpp"
+
+namespace xdp_dns {
+
+// ==================== SIMD 运行时分派 ====================
+//
+// 热点内核按 ISA 分别编译 (simd_sse42.cpp / simd_avx2.cpp / simd_avx512.cpp,
+// 各自带 -m 选项), 进程内首次调用 simd() 时按 cpuid 选定一次, 此后不再切换.
+// 库本身按基线 x86-64 编译, 同一个二进制可部署到所有主机.
+//
+// XDP_DNS_SIMD=scalar|sse4.2|avx2|avx512 可把级别限制到不高于指定值.
+
+enum class SimdLevel : int {
+    Scalar = 0,
+    SSE42 = 1,
+    AVX2 = 2,
+    AVX512 = 3,
+};
+
+struct SimdKernels {
+    SimdLevel level;
+
+    // 复制 n 字节并把 ASCII 大写字母转为小写 (dst 与 src 可以相同)
+    void (*lower_copy)(char* dst, const uint8_t* src, size_t n);
+
+    // 标签哈希 (CRC32C), 所有级别结果一致
+    uint64_t (*hash)(const void* data, size_t n);
+
+    // DNS 头部批量预筛 (n ≤ 64): 第 i 位为 1 表示 pkts[i] 长度足够且
+    // QR=0, OPCODE=QUERY, QDCOUNT=1, ANCOUNT=NSCOUNT=0, ARCOUNT≤1
+    uint64_t (*classify_headers)(const uint8_t* const* pkts, const uint32_t* lens, size_t n);
+};
+
+// 当前选中的内核表 (首次调用时完成选择, 线程安全)
+const SimdKernels& simd();
+
+// 指定级别的内核表; 未编译或 CPU 不支持时返回 nullptr
+const SimdKernels* simdKernels(SimdLevel level);
+
+// CPU 支持的最高级别 (不受 XDP_DNS_SIMD 影响)
+SimdLevel simdCpuLevel();
+
+const char* simdLevelName(SimdLevel level);
+
+// 标准库容器使用的标签哈希
+struct LabelHash {
+    size_t operator()(const void* data, size_t n) const {
+        return static_cast<size_t>(simd().hash(data, n));
+    }
+    template <typename View>
+    size_t operator()(const View& s) const {
+        return (*this)(s.data(), s.size());
+    }
+};
+
+namespace detail {
+
+// 各 ISA 的内核表, 定义在对应的翻译单元中 (未编译时为 nullptr)
+extern const SimdKernels* const kSse42Kernels;
+extern const SimdKernels* const kAvx2Kernels;
+extern const SimdKernels* const kAvx512Kernels;
+
+// SSE4.2 crc32 指令实现的哈希, AVX2 / AVX-512 内核表复用
+uint64_t hashCrc32c(const void* data, size_t n);
+
+// 以下辅助函数为 static: 每个 ISA 翻译单元各有一份, 避免链接器把
+// 以 -mavx512bw 编译的外联副本交给基线代码使用
+
+// 向量循环剩余部分的标量实现
+static inline void lowerCopyTail(char* dst, const uint8_t* src, size_t n) {
+    for (size_t i = 0; i < n; i++) {
+        uint8_t c = src[i];
+        // 无分支: 大小写混合的查询名上条件分支预测失败率很高
+        dst[i] = static_cast<char>(c | ((static_cast<unsigned>(c - 'A') < 26) << 5));
+    }
+}
+
+// 头部预筛: ((header ^ kHeaderExpect) & kHeaderMask) == 0 即为候选查询.
+// 字节 2 的 QR 与 OPCODE, QD/AN/NSCOUNT 全部, ARCOUNT 的高 15 位参与比较;
+// ID、RD/CD 等其余标志位与字节 12-15 (问题名开头) 不参与
+alignas(16) static constexpr uint8_t kHeaderMask[16] = {
+    0x00, 0x00, 0xF8, 0x00, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFE, 0, 0, 0, 0,
+};
+alignas(16) static constexpr uint8_t kHeaderExpect[16] = {
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x01, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0, 0, 0, 0,
+};
+alignas(16) static constexpr uint8_t kZeroHeader[16] = {};
+
+// 向量加载的起点: 过短的包换成全零块 (QDCOUNT=0, 必然不匹配),
+// 候选包至少 MIN_DNS_QUERY_SIZE 字节, 读 16 字节不会越界
+static inline const uint8_t* headerLoadPtr(const uint8_t* pkt, uint32_t len) {
+    return len >= MIN_DNS_QUERY_SIZE ? pkt : kZeroHeader;
+}
+
+// 单个头部的标量判定
+static inline bool headerCandidate(const uint8_t* pkt, uint32_t len) {
+    const uint8_t* p = headerLoadPtr(pkt, len);
+    uint64_t lo, mask_lo, expect_lo;
+    uint32_t hi, mask_hi, expect_hi;
+    std::memcpy(&lo, p, 8);
+    std::memcpy(&hi, p + 8, 4);
+    std::memcpy(&mask_lo, kHeaderMask, 8);
+    std::memcpy(&mask_hi, kHeaderMask + 8, 4);
+    std::memcpy(&expect_lo, kHeaderExpect, 8);
+    std::memcpy(&expect_hi, kHeaderExpect + 8, 4);
+    return (((lo ^ expect_lo) & mask_lo) | ((hi ^ expect_hi) & mask_hi)) == 0;
+}
+
+// CRC32C 后的混合, 使低位也均匀 (unordered_map 按桶数取模)
+static inline uint64_t hashFinalize(uint32_t crc, size_t n) {
+    uint64_t h = (static_cast<uint64_t>(crc) << 32 | crc) ^ n;
+    h *= 0x9E3779B97F4A7C15ULL;
+    return h ^ (h >> 29);
+}
+
+} // namespace detail
+
+} // namespace xdp_dns
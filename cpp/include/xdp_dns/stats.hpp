@@ -0,0 +1,130 @@
+#pragma once
+
+#include "common.hpp"
+#include "stats_shm.h"
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <string>
+#include <thread>
+
+namespace xdp_dns {
+
+// 每核计数器 (缓存行对齐, 由绑定到该槽的线程写入, 避免伪共享)
+struct alignas(64) CoreCounters {
+    std::atomic<uint64_t> packets_received{0};
+    std::atomic<uint64_t> packets_parsed{0};
+    std::atomic<uint64_t> packets_allowed{0};
+    std::atomic<uint64_t> packets_blocked{0};
+    std::atomic<uint64_t> packets_redirected{0};
+    std::atomic<uint64_t> parse_errors{0};
+    std::atomic<uint64_t> response_built{0};
+    std::atomic<uint64_t> sampled_latency_ns{0};    // 仅采样包
+
+    std::atomic<uint64_t> latency_samples{0};
+    std::atomic<uint64_t> latency_hist[XDP_DNS_SHM_HIST_BUCKETS];
+
+    CoreCounters();
+    void reset();
+};
+
+// 进程级统计注册表 - 数据路径只写本线程的槽
+class StatsRegistry {
+public:
+    static StatsRegistry& instance();
+
+    // 当前线程的计数槽 (首次调用时按所在 CPU 绑定)
+    CoreCounters& local();
+
+    // 本包是否需要计时 (每线程每 kSampleInterval 个包采样一次)
+    static bool shouldSample();
+
+    // 记录一次采样延迟
+    void recordLatency(uint64_t ns);
+
+    // 规则代数信息 (控制面每次重载后调用)
+    void setRuleInfo(uint64_t generation, uint64_t rule_count);
+
+    // 所有槽之和
+    XDPDNSShmCounters total() const;
+    uint64_t latencySamples() const;
+
+    // 填充计数器、直方图、规则信息和内存占用 (不修改头部)
+    void snapshot(XDPDNSShmStats* out) const;
+
+    void reset();
+
+    static constexpr uint32_t kSampleInterval = 64;
+
+private:
+    StatsRegistry() = default;
+
+    CoreCounters cores_[XDP_DNS_SHM_MAX_CORES];
+    std::atomic<uint32_t> num_slots_{0};
+    std::atomic<uint64_t> rule_generation_{0};
+    std::atomic<uint64_t> rule_count_{0};
+    std::atomic<uint64_t> rule_update_time_ns_{0};
+};
+
+// 共享内存发布者 - 单写者, seqlock 保护
+class StatsPublisher {
+public:
+    StatsPublisher() = default;
+    ~StatsPublisher();
+
+    StatsPublisher(const StatsPublisher&) = delete;
+    StatsPublisher& operator=(const StatsPublisher&) = delete;
+
+    // 创建 (或覆盖) /dev/shm/<name> 并映射
+    bool open(const char* name);
+
+    // 发布一次快照
+    void publish();
+
+    // 启动后台发布线程
+    bool start(uint32_t interval_ms);
+
+    // 停止后台线程, 解除映射并删除共享内存对象
+    void close();
+
+    bool isOpen() const { return region_ != nullptr; }
+
+private:
+    void run(uint32_t interval_ms);
+
+    XDPDNSShmStats* region_ = nullptr;
+    std::string name_;
+    std::thread thread_;
+    std::mutex mutex_;
+    std::condition_variable cv_;
+    bool running_ = false;
+};
+
+// 共享内存读取者 - 无锁, 无系统调用 (映射之后)
+class StatsReader {
+public:
+    StatsReader() = default;
+    ~StatsReader();
+
+    StatsReader(const StatsReader&) = delete;
+    StatsReader& operator=(const StatsReader&) = delete;
+
+    // 只读映射, 校验 magic 和版本
+    bool open(const char* name);
+
+    // 读取一致的快照, 写端持续更新时最多重试 max_retries 次
+    bool read(XDPDNSShmStats* out, int max_retries = 1000) const;
+
+    void close();
+
+private:
+    const XDPDNSShmStats* region_ = nullptr;
+};
+
+// 当前 CLOCK_REALTIME (ns)
+uint64_t wallClockNs();
+
+// 单调时钟 (ns), 用于缓存过期等只比较差值的场合
+uint64_t monotonicNs();
+
+} // namespace xdp_dns
@@ -0,0 +1,87 @@
+#ifndef XDP_DNS_STATS_SHM_H
+#define XDP_DNS_STATS_SHM_H
+
+/*
+ * 共享内存统计区布局 (版本化, seqlock 保护)
+ *
+ * C++ 端由后台线程周期性发布到 /dev/shm/<name>, 读端 (Go exporter,
+ * xdp_dns_stats 工具) 只需 mmap 一次, 之后读取不需要系统调用、锁或 cgo.
+ *
+ * 读协议:
+ *   1. s1 = seq (acquire), 若为奇数则写端正在更新, 重试
+ *   2. 复制所需字段
+ *   3. s2 = seq (acquire 栅栏之后读取), s1 != s2 则重试
+ *
+ * 布局只允许在末尾追加字段; 不兼容的修改必须提升 XDP_DNS_SHM_VERSION.
+ * 所有字段为主机字节序.
+ */
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define XDP_DNS_SHM_MAGIC        0x534e4458u   /* "XDNS" */
+#define XDP_DNS_SHM_VERSION      1
+#define XDP_DNS_SHM_MAX_CORES    128
+#define XDP_DNS_SHM_HIST_BUCKETS 64
+#define XDP_DNS_SHM_DEFAULT_NAME "/xdp_dns_stats"
+
+// 计数器 (与 XDPDNSStats 字段顺序一致)
+typedef struct {
+    uint64_t packets_received;
+    uint64_t packets_parsed;
+    uint64_t packets_allowed;
+    uint64_t packets_blocked;
+    uint64_t packets_redirected;
+    uint64_t parse_errors;
+    uint64_t response_built;
+    uint64_t sampled_latency_ns;    // 采样包的延迟之和, 与 latency_samples / 直方图对应
+} XDPDNSShmCounters;
+
+// 内存占用 (进程级汇总, 分类见 memory.hpp)
+typedef struct {
+    uint64_t node_bytes;
+    uint64_t label_bytes;
+    uint64_t rule_bytes;
+    uint64_t cache_bytes;
+    uint64_t index_bytes;
+    uint64_t reserved_bytes;        // 实际占用 (含分配器开销)
+    uint64_t allocations;           // 存活分配次数
+    uint64_t rule_count;
+} XDPDNSShmMemory;
+
+typedef struct {
+    // ---- 头部 (128 字节) ----
+    uint32_t magic;
+    uint32_t version;
+    uint32_t size;                  // 整个区域的字节数
+    uint32_t num_cores;             // cores[] 中有效的条目数
+    uint64_t seq;                   // seqlock 序号, 奇数表示正在写
+    uint64_t publish_count;         // 发布次数
+    uint64_t publish_time_ns;       // 最近一次发布时间 (CLOCK_REALTIME)
+    uint64_t start_time_ns;         // 发布者启动时间 (CLOCK_REALTIME)
+    uint64_t rule_generation;       // 规则代数, 每次重载递增
+    uint64_t rule_count;            // 当前规则数
+    uint64_t rule_update_time_ns;   // 最近一次规则更新时间 (CLOCK_REALTIME)
+    uint64_t reserved[7];
+
+    // ---- 计数器 ----
+    XDPDNSShmCounters total;                            // 所有核之和
+    XDPDNSShmCounters cores[XDP_DNS_SHM_MAX_CORES];     // 按核 (线程首次使用时所在 CPU)
+
+    // ---- 直方图 ----
+    // 采样的单包 C++ 处理延迟, 桶 i 统计 [2^(i-1), 2^i) ns, 桶 0 为 0ns
+    uint64_t latency_samples;
+    uint64_t latency_hist[XDP_DNS_SHM_HIST_BUCKETS];
+
+    // ---- 内存占用 ----
+    XDPDNSShmMemory memory;
+} XDPDNSShmStats;
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // XDP_DNS_STATS_SHM_H
@@ -0,0 +1,117 @@
+#pragma once
+
+#include "common.hpp"
+#include <string>
+#include <vector>
+#include <random>
+
+namespace xdp_dns {
+namespace traffic_gen {
+
+// ==================== 规则集生成 ====================
+
+// 规则集生成参数
+struct RuleSetOptions {
+    size_t num_rules = 10000;       // 规则数量 (10k ~ 10M)
+    uint64_t seed = 1;              // 随机种子 (相同种子输出相同)
+    double wildcard_ratio = 0.3;    // 通配符规则 (*.) 比例
+    double dga_ratio = 0.1;         // DGA 风格随机标签比例
+    double redirect_ratio = 0.05;   // 重定向规则比例
+    double log_ratio = 0.02;        // 仅记录规则比例
+};
+
+// 生成的规则
+struct GeneratedRule {
+    std::string domain;             // 不含 "*." 前缀, 小写
+    bool wildcard;
+    Action action;
+};
+
+// 生成规则集
+// 标签深度、TLD 和通配符比例按真实黑名单分布抽样, 域名互不重复
+std::vector<GeneratedRule> generateRuleSet(const RuleSetOptions& opts);
+
+// ==================== 查询流生成 ====================
+
+// 查询类别
+enum class QueryKind : uint8_t {
+    Hit = 0,        // 命中规则
+    Miss = 1,       // 正常未命中流量
+    Attack = 2,     // 随机子域攻击 (water torture)
+};
+
+// 查询流生成参数
+struct QueryStreamOptions {
+    size_t num_queries = 100000;
+    uint64_t seed = 2;
+    double zipf_s = 1.0;            // Zipf 指数
+    double hit_ratio = 0.2;         // 命中规则的比例
+    double attack_ratio = 0.0;      // 随机子域攻击比例
+    size_t attack_targets = 4;      // 被攻击的域名数量
+    double compression_ratio = 0.0; // 问题名使用压缩指针的比例
+    double mixed_case_ratio = 0.0;  // 0x20 大小写随机化比例
+    double aaaa_ratio = 0.25;       // AAAA 查询比例 (其余为 A)
+    size_t miss_universe = 50000;   // 未命中流量的域名池大小
+};
+
+// 查询流 - 所有 DNS 负载连续存放, 便于基准测试顺序遍历
+struct QueryStream {
+    std::vector<uint8_t> data;
+    std::vector<uint32_t> offsets;
+    std::vector<uint16_t> lengths;
+    std::vector<std::string> domains;   // 期望解码结果 (小写)
+    std::vector<QueryKind> kinds;
+
+    size_t size() const { return offsets.size(); }
+    const uint8_t* packet(size_t i) const { return data.data() + offsets[i]; }
+    size_t packetLength(size_t i) const { return lengths[i]; }
+};
+
+// 根据规则集生成查询流
+QueryStream generateQueries(
+    const std::vector<GeneratedRule>& rules,
+    const QueryStreamOptions& opts
+);
+
+// ==================== 输出 ====================
+
+// 每行一条规则 ("*.example.com" / "example.com")
+bool writeRuleList(const std::vector<GeneratedRule>& rules, const char* path);
+
+// pkg/filter RuleSet YAML 格式, 同动作的域名按 chunk 条合并为一条规则
+bool writeRuleYaml(
+    const std::vector<GeneratedRule>& rules,
+    const char* path,
+    size_t chunk = 1000
+);
+
+// pcap (Ethernet/IPv4/UDP → 53), 可直接用于 tcpreplay 等重放工具
+bool writePcap(const QueryStream& stream, const char* path);
+
+// 原始格式: 每条记录为 2 字节长度 (网络字节序) + DNS 负载
+bool writeRaw(const QueryStream& stream, const char* path);
+
+// ==================== 采样器 ====================
+
+// Zipf 采样 (rejection-inversion, O(1) 内存, 适用于千万级规模)
+class ZipfSampler {
+public:
+    ZipfSampler(uint64_t n, double s);
+
+    // 返回 [1, n] 的排名
+    uint64_t sample(std::mt19937_64& rng);
+
+private:
+    double h(double x) const;
+    double hIntegral(double x) const;
+    double hIntegralInverse(double x) const;
+
+    uint64_t n_;
+    double s_;
+    double h_integral_x1_;
+    double h_integral_n_;
+    double threshold_;
+};
+
+} // namespace traffic_gen
+} // namespace xdp_dns
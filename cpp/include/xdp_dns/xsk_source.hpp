@@ -0,0 +1,104 @@
+#pragma once
+
+#include "dataplane.hpp"
+#include "frame_parser.hpp"
+#include <atomic>
+#include <vector>
+
+namespace xdp_dns {
+
+// ==================== AF_XDP 包源 ====================
+//
+// 直接驱动控制面 (Go xdp.Socket) 已创建并映射好的 AF_XDP socket: UMEM 与
+// fill / completion / rx / tx 四个环. 交给 XskSource 之后控制面不再操作
+// 这些环, 由一个 worker 线程独占.
+//
+// 收到的以太网帧经 FrameParser 定位 DNS 负载, 响应在原帧内构建, 再原地
+// 交换 MAC / IP / 端口、改写长度与校验和后放入 tx 环. 非首个分片、带
+// IPv6 扩展头的帧与非 UDP 帧直接回收. AF_XDP 不能把帧交还内核协议栈,
+// Pass / Drop 的帧都回收到 fill 环; 需要放行的查询应配置 Forwarder,
+// 上游响应经 transmit 按保存的客户端头部发回.
+
+// 一个已映射的环; size 为 2 的幂
+struct XskRing {
+    uint32_t* producer = nullptr;
+    uint32_t* consumer = nullptr;
+    void* descs = nullptr;              // fill / completion: uint64_t[]; rx / tx: xdp_desc[]
+    uint32_t size = 0;
+};
+
+struct XskConfig {
+    int fd = -1;                        // < 0 时不唤醒内核 (测试用内存模拟的环)
+    uint8_t* umem = nullptr;
+    uint64_t umem_size = 0;             // 只用前 umem_size / frame_size 个帧
+    uint32_t frame_size = 2048;
+    XskRing fill;
+    XskRing completion;
+    XskRing rx;
+    XskRing tx;
+    uint32_t tx_reserve = 64;           // 留给 transmit 的空闲帧
+    uint32_t mtu = 1500;                // 响应 IP 包的上限, 超出时由响应构建截断
+};
+
+struct XskSourceStats {
+    uint64_t rx_frames;
+    uint64_t rx_skipped;                // 非 DNS / 分片 / 扩展头, 直接回收
+    uint64_t tx_frames;
+    uint64_t tx_dropped;                // tx 环满或没有空闲帧
+};
+
+class XskSource : public PacketSource {
+public:
+    explicit XskSource(const XskConfig& cfg);
+
+    // 环与 UMEM 参数是否可用 (size 为 2 的幂, 帧数足够)
+    static bool valid(const XskConfig& cfg);
+
+    size_t receive(PacketBuf* pkts, size_t max) override;
+    void complete(const PacketBuf* pkts, const PacketVerdict* verdicts, size_t n) override;
+    bool transmit(uint64_t cookie, const uint8_t* data, size_t len) override;
+
+    XskSourceStats stats() const;
+
+    static constexpr size_t kMaxBatch = 64;
+    static constexpr uint32_t kPendingBits = 12;   // 等待上游响应的客户端头部槽数 (2 的幂)
+
+private:
+    // 一个收到的帧在本批中的位置
+    struct RxFrame {
+        uint64_t addr;
+        FrameInfo info;
+    };
+
+    // 转发查询的客户端头部 (L2-L4), 上游响应按 cookie 找回
+    struct Pending {
+        uint64_t cookie = 0;
+        FrameInfo info;
+        uint8_t header[128];            // 两层 VLAN + 带选项的 IPv4 头仍不超过 90 字节
+    };
+
+    void reclaim();                     // completion → 空闲表
+    void refill();                      // 空闲表 → fill, 保留 tx_reserve
+    bool enqueueTx(uint64_t addr, uint32_t len);
+    void kick();
+    uint32_t capacityOf(uint64_t addr, const FrameInfo& info) const;
+
+    XskConfig cfg_;
+    std::vector<uint64_t> free_;
+    RxFrame batch_[kMaxBatch];
+    std::vector<Pending> pending_;
+    uint64_t next_cookie_ = 0;
+    bool tx_pending_ = false;
+
+    std::atomic<uint64_t> rx_frames_{0};
+    std::atomic<uint64_t> rx_skipped_{0};
+    std::atomic<uint64_t> tx_frames_{0};
+    std::atomic<uint64_t> tx_dropped_{0};
+};
+
+// 把 frame 中 DNS 负载长度为 payload_len 的请求帧改写为发回客户端的响应
+// 帧: 交换 MAC / IP / 端口, 改写 IP / UDP 长度, 重算 IPv4 头部校验和与
+// UDP 校验和 (IPv4 置 0, IPv6 必须计算). 返回整个帧的新长度.
+uint32_t reflectFrame(uint8_t* frame, const FrameInfo& info, uint32_t payload_len);
+
+} // namespace xdp_dns
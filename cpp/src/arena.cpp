@@ -0,0 +1,163 @@
+#include "xdp_dns/arena.hpp"
+#include "xdp_dns/memory.hpp"
+#include "xdp_dns/numa.hpp"
+#include <sys/mman.h>
+#include <unistd.h>
+#include <algorithm>
+#include <mutex>
+
+#ifndef MAP_HUGE_SHIFT
+#define MAP_HUGE_SHIFT 26
+#endif
+#ifndef MAP_HUGE_2MB
+#define MAP_HUGE_2MB (21 << MAP_HUGE_SHIFT)
+#endif
+
+namespace xdp_dns {
+
+namespace {
+
+size_t roundUp(size_t n, size_t align) {
+    return (n + align - 1) & ~(align - 1);
+}
+
+std::mutex g_default_mutex;
+ArenaOptions g_default_options;
+
+// hugetlbfs 页在 mmap 时尚未分配 (未用 MAP_POPULATE), mbind 仍然生效
+void* placed(void* p, size_t size, int numa_node) {
+    if (p && numa_node >= 0) {
+        numaBind(p, size, numa_node);
+    }
+    return p;
+}
+
+} // anonymous namespace
+
+ArenaOptions defaultArenaOptions() {
+    std::lock_guard<std::mutex> lock(g_default_mutex);
+    return g_default_options;
+}
+
+void setDefaultArenaOptions(const ArenaOptions& opts) {
+    std::lock_guard<std::mutex> lock(g_default_mutex);
+    g_default_options = opts;
+}
+
+void* mapPages(size_t size, bool huge_pages, bool* is_huge, int numa_node) {
+    *is_huge = false;
+
+    if (huge_pages) {
+        size = roundUp(size, kHugePageSize);
+
+        // 1. hugetlbfs 预留的大页
+        void* p = mmap(nullptr, size, PROT_READ | PROT_WRITE,
+                       MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB | MAP_HUGE_2MB, -1, 0);
+        if (p != MAP_FAILED) {
+            *is_huge = true;
+            return placed(p, size, numa_node);
+        }
+
+        // 2. 回退到 THP: 多映射 2MB 后裁剪出对齐区间, 再 madvise
+        size_t span = size + kHugePageSize;
+        void* raw = mmap(nullptr, span, PROT_READ | PROT_WRITE,
+                         MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        if (raw == MAP_FAILED) return nullptr;
+
+        uintptr_t start = reinterpret_cast<uintptr_t>(raw);
+        uintptr_t aligned = roundUp(start, kHugePageSize);
+        if (aligned > start) {
+            munmap(raw, aligned - start);
+        }
+        uintptr_t tail = aligned + size;
+        uintptr_t raw_end = start + span;
+        if (raw_end > tail) {
+            munmap(reinterpret_cast<void*>(tail), raw_end - tail);
+        }
+
+        p = reinterpret_cast<void*>(aligned);
+        madvise(p, size, MADV_HUGEPAGE);
+        return placed(p, size, numa_node);
+    }
+
+    void* p = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    return p == MAP_FAILED ? nullptr : placed(p, size, numa_node);
+}
+
+void unmapPages(void* p, size_t size) {
+    if (p) munmap(p, size);
+}
+
+// ==================== Arena ====================
+
+Arena::Arena(const ArenaOptions& opts, CountingResource* account)
+    : opts_(opts), account_(account), next_chunk_(opts.initial_chunk) {
+    if (opts_.huge_pages) {
+        // 普通页块逐步翻倍, 增长到阈值后的块才用大页
+        opts_.max_chunk = std::max(roundUp(opts_.max_chunk, kHugePageSize), kHugePageSize);
+    }
+}
+
+Arena::~Arena() {
+    release();
+}
+
+void Arena::release() {
+    Chunk* c = chunks_;
+    while (c) {
+        Chunk* next = c->next;
+        unmapPages(c, c->size);
+        c = next;
+    }
+
+    if (account_ && reserved_ > 0) {
+        account_->adjustReserved(-static_cast<int64_t>(reserved_ - huge_bytes_));
+        account_->adjustReserved(-static_cast<int64_t>(huge_bytes_), true);
+    }
+
+    chunks_ = nullptr;
+    cur_ = end_ = 0;
+    next_chunk_ = opts_.initial_chunk;
+    reserved_ = used_ = huge_bytes_ = 0;
+}
+
+void* Arena::do_allocate(size_t bytes, size_t alignment) {
+    uintptr_t p = roundUp(cur_, alignment);
+    if (p + bytes > end_ || cur_ == 0) {
+        newChunk(bytes + alignment);
+        p = roundUp(cur_, alignment);
+    }
+
+    cur_ = p + bytes;
+    used_ += bytes;
+    return reinterpret_cast<void*>(p);
+}
+
+void Arena::newChunk(size_t min_bytes) {
+    static const size_t page = static_cast<size_t>(sysconf(_SC_PAGESIZE));
+
+    size_t size = std::max(next_chunk_, roundUp(min_bytes + sizeof(Chunk), page));
+    bool huge = opts_.huge_pages && size >= opts_.huge_min_chunk;
+    if (huge) {
+        size = roundUp(size, kHugePageSize);
+    }
+
+    bool is_huge = false;
+    void* mem = mapPages(size, huge, &is_huge, opts_.numa_node);
+    if (!mem) allocationFailed();
+
+    Chunk* c = static_cast<Chunk*>(mem);
+    c->next = chunks_;
+    c->size = size;
+    chunks_ = c;
+
+    cur_ = reinterpret_cast<uintptr_t>(c + 1);
+    end_ = reinterpret_cast<uintptr_t>(mem) + size;
+    next_chunk_ = std::min(next_chunk_ * 2, opts_.max_chunk);
+
+    reserved_ += size;
+    if (is_huge) huge_bytes_ += size;
+    if (account_) account_->adjustReserved(static_cast<int64_t>(size), is_huge);
+}
+
+} // namespace xdp_dns
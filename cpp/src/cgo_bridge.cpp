@@ -8,55 +8,58 @@
 
 #include "xdp_dns/cgo_bridge.h"
 #include "xdp_dns/dns_parser.hpp"
+#include "xdp_dns/frame_parser.hpp"
+#include "xdp_dns/memory.hpp"
+#include "xdp_dns/numa.hpp"
+#include "xdp_dns/probes.hpp"
+#include "xdp_dns/simd.hpp"
+#include "xdp_dns/stats.hpp"
 #include <atomic>
+#include <chrono>
+#include <cstddef>
 #include <cstring>
+#include <mutex>
+
+static_assert(sizeof(XDPDNSFrameInfo) == sizeof(xdp_dns::FrameInfo), "frame info layout");
+static_assert(offsetof(XDPDNSFrameInfo, flags) == offsetof(xdp_dns::FrameInfo, flags),
+              "frame info layout");
+static_assert(offsetof(XDPDNSFrameInfo, dst_addr) == offsetof(xdp_dns::FrameInfo, dst_addr),
+              "frame info layout");
 
 namespace {
 
 // 全局状态
 std::atomic<bool> g_initialized{false};
 
-// 统计计数器
-std::atomic<uint64_t> g_packets_received{0};
-std::atomic<uint64_t> g_packets_parsed{0};
-std::atomic<uint64_t> g_parse_errors{0};
-std::atomic<uint64_t> g_response_built{0};
-std::atomic<uint64_t> g_total_latency_ns{0};
-
-} // anonymous namespace
-
-extern "C" {
-
-// ==================== 初始化/清理 ====================
-
-int xdp_dns_init(void) {
-    g_initialized.store(true, std::memory_order_release);
-    return XDP_DNS_OK;
-}
-
-void xdp_dns_cleanup(void) {
-    g_initialized.store(false, std::memory_order_release);
-}
-
-// ==================== DNS 解析 (C++ 高性能实现) ====================
-
-int xdp_dns_parse(
+// 共享内存统计发布者 (xdp_dns_stats_shm_start 创建)
+std::mutex g_shm_mutex;
+xdp_dns::StatsPublisher g_shm_publisher;
+
+// bridge__build 探针的响应类型 (与 tools/usdt/README.md 保持一致)
+enum BuildKind : int {
+    BUILD_NXDOMAIN = 0,
+    BUILD_A = 1,
+    BUILD_AAAA = 2,
+    BUILD_NODATA = 3,
+    BUILD_REFUSED = 4,
+    BUILD_BLOCKED = 5,
+};
+
+// 解析并解码域名 (xdp_dns_parse 的实现)
+int parsePacket(
     const uint8_t* packet_data,
     size_t packet_len,
     XDPDNSParseResult* result
 ) {
-    if (!packet_data || !result || packet_len < 12) {
-        return XDP_DNS_ERR_INVALID_PARAM;
-    }
-
-    g_packets_received.fetch_add(1, std::memory_order_relaxed);
+    xdp_dns::CoreCounters& stats = xdp_dns::StatsRegistry::instance().local();
+    stats.packets_received.fetch_add(1, std::memory_order_relaxed);
 
     // 使用 C++ 解析器
     xdp_dns::DNSParseResult parsed;
     auto err = xdp_dns::DNSParser::parse(packet_data, packet_len, &parsed);
 
     if (err != xdp_dns::Error::Success) {
-        g_parse_errors.fetch_add(1, std::memory_order_relaxed);
+        stats.parse_errors.fetch_add(1, std::memory_order_relaxed);
         return static_cast<int>(err);
     }
 
@@ -83,13 +86,107 @@ int xdp_dns_parse(
     );
 
     if (err != xdp_dns::Error::Success) {
-        g_parse_errors.fetch_add(1, std::memory_order_relaxed);
+        stats.parse_errors.fetch_add(1, std::memory_order_relaxed);
         return static_cast<int>(err);
     }
 
     result->domain_len = domain_len;
-    g_packets_parsed.fetch_add(1, std::memory_order_relaxed);
+    stats.packets_parsed.fetch_add(1, std::memory_order_relaxed);
+
+    return XDP_DNS_OK;
+}
+
+} // anonymous namespace
+
+extern "C" {
+
+// ==================== 初始化/清理 ====================
+
+int xdp_dns_init(void) {
+    // 在任何 Trie 建立之前选定内核, 之后哈希函数不再变化
+    xdp_dns::simd();
+    g_initialized.store(true, std::memory_order_release);
+    return XDP_DNS_OK;
+}
+
+void xdp_dns_cleanup(void) {
+    xdp_dns_stats_shm_stop();
+    g_initialized.store(false, std::memory_order_release);
+}
+
+const char* xdp_dns_simd_level(void) {
+    return xdp_dns::simdLevelName(xdp_dns::simd().level);
+}
+
+// ==================== DNS 解析 (C++ 高性能实现) ====================
+
+int xdp_dns_parse(
+    const uint8_t* packet_data,
+    size_t packet_len,
+    XDPDNSParseResult* result
+) {
+    if (!packet_data || !result || packet_len < 12) {
+        return XDP_DNS_ERR_INVALID_PARAM;
+    }
 
+    XDP_DNS_PROBE2(bridge__parse__start, packet_data, packet_len);
+
+    // 每线程每 kSampleInterval 个包计时一次, 避免每包读时钟
+    if (xdp_dns::StatsRegistry::shouldSample()) {
+        auto t0 = std::chrono::steady_clock::now();
+        int ret = parsePacket(packet_data, packet_len, result);
+        auto ns = std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now() - t0).count();
+        xdp_dns::StatsRegistry::instance().recordLatency(static_cast<uint64_t>(ns));
+        XDP_DNS_PROBE2(bridge__parse__end, ret, ret == XDP_DNS_OK ? result->domain : nullptr);
+        return ret;
+    }
+
+    int ret = parsePacket(packet_data, packet_len, result);
+    XDP_DNS_PROBE2(bridge__parse__end, ret, ret == XDP_DNS_OK ? result->domain : nullptr);
+    return ret;
+}
+
+// ==================== 帧解析 (L2-L4) ====================
+
+int xdp_dns_parse_frame(const uint8_t* frame, size_t len, XDPDNSFrameInfo* info) {
+    if (!frame || !info) {
+        return XDP_DNS_ERR_INVALID_PARAM;
+    }
+
+    xdp_dns::FrameInfo parsed;
+    if (xdp_dns::FrameParser::parse(frame, len, &parsed) != xdp_dns::Error::Success) {
+        return XDP_DNS_ERR_PARSE_FAILED;
+    }
+    std::memcpy(info, &parsed, sizeof(*info));
+    return XDP_DNS_OK;
+}
+
+int xdp_dns_parse_frames(
+    const uint8_t* umem,
+    size_t umem_len,
+    const XDPDNSFrameDesc* descs,
+    size_t count,
+    XDPDNSFrameInfo* out,
+    uint64_t* ok_mask
+) {
+    if (!umem || !ok_mask || count > 64 || (count && (!descs || !out))) {
+        return XDP_DNS_ERR_INVALID_PARAM;
+    }
+
+    uint64_t ok = 0;
+    xdp_dns::FrameInfo parsed;
+    for (size_t i = 0; i < count; i++) {
+        const XDPDNSFrameDesc& d = descs[i];
+        if (d.addr > umem_len || d.len > umem_len - d.addr) {
+            continue;
+        }
+        if (xdp_dns::FrameParser::parse(umem + d.addr, d.len, &parsed) == xdp_dns::Error::Success) {
+            std::memcpy(&out[i], &parsed, sizeof(out[i]));
+            ok |= 1ULL << i;
+        }
+    }
+    *ok_mask = ok;
     return XDP_DNS_OK;
 }
 
@@ -124,7 +221,8 @@ int xdp_dns_build_nxdomain(
     }
 
     *response_len = built_len;
-    g_response_built.fetch_add(1, std::memory_order_relaxed);
+    xdp_dns::StatsRegistry::instance().local().response_built.fetch_add(1, std::memory_order_relaxed);
+    XDP_DNS_PROBE3(bridge__build, BUILD_NXDOMAIN, XDP_DNS_OK, built_len);
 
     return XDP_DNS_OK;
 }
@@ -161,7 +259,8 @@ int xdp_dns_build_a_response(
     }
 
     *response_len = built_len;
-    g_response_built.fetch_add(1, std::memory_order_relaxed);
+    xdp_dns::StatsRegistry::instance().local().response_built.fetch_add(1, std::memory_order_relaxed);
+    XDP_DNS_PROBE3(bridge__build, BUILD_A, XDP_DNS_OK, built_len);
 
     return XDP_DNS_OK;
 }
@@ -198,7 +297,149 @@ int xdp_dns_build_aaaa_response(
     }
 
     *response_len = built_len;
-    g_response_built.fetch_add(1, std::memory_order_relaxed);
+    xdp_dns::StatsRegistry::instance().local().response_built.fetch_add(1, std::memory_order_relaxed);
+    XDP_DNS_PROBE3(bridge__build, BUILD_AAAA, XDP_DNS_OK, built_len);
+
+    return XDP_DNS_OK;
+}
+
+int xdp_dns_build_nxdomain_soa(
+    const uint8_t* original_packet,
+    size_t original_len,
+    uint32_t negative_ttl,
+    uint8_t* response_buf,
+    size_t response_buf_size,
+    size_t* response_len
+) {
+    if (!original_packet || !response_buf || !response_len) {
+        return XDP_DNS_ERR_INVALID_PARAM;
+    }
+
+    xdp_dns::DNSParseResult parsed;
+    auto err = xdp_dns::DNSParser::parse(original_packet, original_len, &parsed);
+    if (err != xdp_dns::Error::Success) {
+        return static_cast<int>(err);
+    }
+
+    size_t built_len = xdp_dns::DNSResponseBuilder::buildNXDomain(
+        original_packet, original_len, parsed, negative_ttl,
+        response_buf, response_buf_size
+    );
+
+    if (built_len == 0) {
+        return XDP_DNS_ERR_BUFFER_TOO_SMALL;
+    }
+
+    *response_len = built_len;
+    xdp_dns::StatsRegistry::instance().local().response_built.fetch_add(1, std::memory_order_relaxed);
+    XDP_DNS_PROBE3(bridge__build, BUILD_NXDOMAIN, XDP_DNS_OK, built_len);
+
+    return XDP_DNS_OK;
+}
+
+int xdp_dns_build_nodata(
+    const uint8_t* original_packet,
+    size_t original_len,
+    uint32_t negative_ttl,
+    uint8_t* response_buf,
+    size_t response_buf_size,
+    size_t* response_len
+) {
+    if (!original_packet || !response_buf || !response_len) {
+        return XDP_DNS_ERR_INVALID_PARAM;
+    }
+
+    xdp_dns::DNSParseResult parsed;
+    auto err = xdp_dns::DNSParser::parse(original_packet, original_len, &parsed);
+    if (err != xdp_dns::Error::Success) {
+        return static_cast<int>(err);
+    }
+
+    size_t built_len = xdp_dns::DNSResponseBuilder::buildNoData(
+        original_packet, original_len, parsed, negative_ttl,
+        response_buf, response_buf_size
+    );
+
+    if (built_len == 0) {
+        return XDP_DNS_ERR_BUFFER_TOO_SMALL;
+    }
+
+    *response_len = built_len;
+    xdp_dns::StatsRegistry::instance().local().response_built.fetch_add(1, std::memory_order_relaxed);
+    XDP_DNS_PROBE3(bridge__build, BUILD_NODATA, XDP_DNS_OK, built_len);
+
+    return XDP_DNS_OK;
+}
+
+int xdp_dns_build_refused(
+    const uint8_t* original_packet,
+    size_t original_len,
+    uint8_t* response_buf,
+    size_t response_buf_size,
+    size_t* response_len
+) {
+    if (!original_packet || !response_buf || !response_len) {
+        return XDP_DNS_ERR_INVALID_PARAM;
+    }
+
+    xdp_dns::DNSParseResult parsed;
+    auto err = xdp_dns::DNSParser::parse(original_packet, original_len, &parsed);
+    if (err != xdp_dns::Error::Success) {
+        return static_cast<int>(err);
+    }
+
+    size_t built_len = xdp_dns::DNSResponseBuilder::buildRefused(
+        original_packet, original_len, parsed,
+        response_buf, response_buf_size
+    );
+
+    if (built_len == 0) {
+        return XDP_DNS_ERR_BUFFER_TOO_SMALL;
+    }
+
+    *response_len = built_len;
+    xdp_dns::StatsRegistry::instance().local().response_built.fetch_add(1, std::memory_order_relaxed);
+    XDP_DNS_PROBE3(bridge__build, BUILD_REFUSED, XDP_DNS_OK, built_len);
+
+    return XDP_DNS_OK;
+}
+
+int xdp_dns_build_blocked(
+    const uint8_t* original_packet,
+    size_t original_len,
+    uint8_t block_mode,
+    uint32_t ttl,
+    uint32_t negative_ttl,
+    uint8_t* response_buf,
+    size_t response_buf_size,
+    size_t* response_len
+) {
+    if (!original_packet || !response_buf || !response_len || block_mode > XDP_DNS_BLOCK_DROP) {
+        return XDP_DNS_ERR_INVALID_PARAM;
+    }
+
+    *response_len = 0;
+    if (block_mode == XDP_DNS_BLOCK_DROP) return XDP_DNS_OK;
+
+    xdp_dns::DNSParseResult parsed;
+    auto err = xdp_dns::DNSParser::parse(original_packet, original_len, &parsed);
+    if (err != xdp_dns::Error::Success) {
+        return static_cast<int>(err);
+    }
+
+    size_t built_len = xdp_dns::DNSResponseBuilder::buildBlocked(
+        original_packet, original_len, parsed,
+        static_cast<xdp_dns::BlockMode>(block_mode), ttl, negative_ttl,
+        response_buf, response_buf_size
+    );
+
+    if (built_len == 0) {
+        return XDP_DNS_ERR_BUFFER_TOO_SMALL;
+    }
+
+    *response_len = built_len;
+    xdp_dns::StatsRegistry::instance().local().response_built.fetch_add(1, std::memory_order_relaxed);
+    XDP_DNS_PROBE3(bridge__build, BUILD_BLOCKED, XDP_DNS_OK, built_len);
 
     return XDP_DNS_OK;
 }
@@ -208,11 +449,13 @@ int xdp_dns_build_aaaa_response(
 void xdp_dns_get_stats(XDPDNSStats* stats) {
     if (!stats) return;
 
-    stats->packets_received = g_packets_received.load(std::memory_order_relaxed);
-    stats->packets_parsed = g_packets_parsed.load(std::memory_order_relaxed);
-    stats->parse_errors = g_parse_errors.load(std::memory_order_relaxed);
-    stats->response_built = g_response_built.load(std::memory_order_relaxed);
-    stats->total_latency_ns = g_total_latency_ns.load(std::memory_order_relaxed);
+    XDPDNSShmCounters total = xdp_dns::StatsRegistry::instance().total();
+    stats->packets_received = total.packets_received;
+    stats->packets_parsed = total.packets_parsed;
+    stats->parse_errors = total.parse_errors;
+    stats->response_built = total.response_built;
+    stats->sampled_latency_ns = total.sampled_latency_ns;
+    stats->latency_samples = xdp_dns::StatsRegistry::instance().latencySamples();
 
     // 这些由 Go 端填充
     stats->packets_allowed = 0;
@@ -221,11 +464,84 @@ void xdp_dns_get_stats(XDPDNSStats* stats) {
 }
 
 void xdp_dns_reset_stats(void) {
-    g_packets_received.store(0, std::memory_order_relaxed);
-    g_packets_parsed.store(0, std::memory_order_relaxed);
-    g_parse_errors.store(0, std::memory_order_relaxed);
-    g_response_built.store(0, std::memory_order_relaxed);
-    g_total_latency_ns.store(0, std::memory_order_relaxed);
+    xdp_dns::StatsRegistry::instance().reset();
+}
+
+void xdp_dns_get_memory_stats(XDPDNSMemoryStats* stats) {
+    if (!stats) return;
+
+    using xdp_dns::MemCategory;
+    xdp_dns::MemoryUsage usage = xdp_dns::MemoryAccounting::global().usage();
+    stats->node_bytes = usage.bytes[static_cast<size_t>(MemCategory::Nodes)];
+    stats->label_bytes = usage.bytes[static_cast<size_t>(MemCategory::Labels)];
+    stats->rule_bytes = usage.bytes[static_cast<size_t>(MemCategory::Rules)];
+    stats->cache_bytes = usage.bytes[static_cast<size_t>(MemCategory::Cache)];
+    stats->index_bytes = usage.bytes[static_cast<size_t>(MemCategory::Index)];
+    stats->total_bytes = usage.totalBytes();
+    stats->reserved_bytes = usage.reserved_bytes;
+    stats->allocations = usage.allocations;
+    stats->rule_count = usage.rule_count;
+    stats->bytes_per_rule = usage.bytesPerRule();
+    stats->fragmentation = usage.fragmentation();
+}
+
+int xdp_dns_set_memory_options(int huge_pages, int numa_node) {
+    if (numa_node < -1 || (numa_node >= 0 && !xdp_dns::numaNodeOnline(numa_node))) {
+        return XDP_DNS_ERR_INVALID_PARAM;
+    }
+
+    xdp_dns::ArenaOptions opts = xdp_dns::defaultArenaOptions();
+    opts.huge_pages = huge_pages != 0;
+    opts.numa_node = numa_node;
+    xdp_dns::setDefaultArenaOptions(opts);
+    return XDP_DNS_OK;
+}
+
+void xdp_dns_set_numa_replicas(int enabled) {
+    xdp_dns::ArenaOptions opts = xdp_dns::defaultArenaOptions();
+    opts.numa_replicas = enabled != 0;
+    xdp_dns::setDefaultArenaOptions(opts);
+}
+
+int xdp_dns_netdev_numa_node(const char* ifname) {
+    return xdp_dns::numaNodeOfNetdev(ifname);
+}
+
+// ==================== 共享内存统计 ====================
+
+int xdp_dns_stats_shm_start(const char* name, uint32_t interval_ms) {
+    if (interval_ms == 0) {
+        return XDP_DNS_ERR_INVALID_PARAM;
+    }
+
+    std::lock_guard<std::mutex> lock(g_shm_mutex);
+    if (!g_shm_publisher.isOpen() &&
+        !g_shm_publisher.open(name ? name : XDP_DNS_SHM_DEFAULT_NAME)) {
+        return XDP_DNS_ERR_SYSTEM;
+    }
+    if (!g_shm_publisher.start(interval_ms)) {
+        g_shm_publisher.close();
+        return XDP_DNS_ERR_SYSTEM;
+    }
+    return XDP_DNS_OK;
+}
+
+void xdp_dns_stats_shm_stop(void) {
+    std::lock_guard<std::mutex> lock(g_shm_mutex);
+    g_shm_publisher.close();
+}
+
+int xdp_dns_stats_shm_publish(void) {
+    std::lock_guard<std::mutex> lock(g_shm_mutex);
+    if (!g_shm_publisher.isOpen()) {
+        return XDP_DNS_ERR_NOT_INITIALIZED;
+    }
+    g_shm_publisher.publish();
+    return XDP_DNS_OK;
+}
+
+void xdp_dns_stats_set_rule_info(uint64_t generation, uint64_t rule_count) {
+    xdp_dns::StatsRegistry::instance().setRuleInfo(generation, rule_count);
 }
 
 } // extern "C"
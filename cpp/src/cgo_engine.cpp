@@ -0,0 +1,540 @@
+/**
+ * XDP DNS Filter - 过滤引擎与数据面句柄 C API
+ *
+ * 每个引擎句柄包装一个 EngineSlot (锁与整体替换的语义见 engine_slot.hpp),
+ * 数据面句柄包装一个作用于该引擎的 Dataplane.
+ */
+
+#include "xdp_dns/cgo_bridge.h"
+#include "xdp_dns/dataplane.hpp"
+#include "xdp_dns/dns_parser.hpp"
+#include "xdp_dns/engine_slot.hpp"
+#include "xdp_dns/forwarder.hpp"
+#include "xdp_dns/numa.hpp"
+#include "xdp_dns/response_cache.hpp"
+#include "xdp_dns/stats.hpp"
+#include "xdp_dns/xsk_source.hpp"
+#include <cstring>
+#include <new>
+
+struct XDPDNSEngine {
+    explicit XDPDNSEngine(const xdp_dns::ArenaOptions& opts) : slot(opts) {}
+
+    xdp_dns::EngineSlot slot;
+};
+
+struct XDPDNSCache {
+    explicit XDPDNSCache(const xdp_dns::ResponseCacheOptions& opts) : impl(opts) {}
+
+    xdp_dns::ResponseCache impl;
+};
+
+struct XDPDNSForwarder {
+    explicit XDPDNSForwarder(const xdp_dns::ForwarderOptions& opts) : impl(opts) {}
+
+    xdp_dns::Forwarder impl;
+};
+
+struct XDPDNSDataplane {
+    XDPDNSDataplane(xdp_dns::EngineSlot* engine, const xdp_dns::DataplaneOptions& opts)
+        : impl(engine, opts) {}
+
+    xdp_dns::Dataplane impl;
+    std::vector<xdp_dns::ReplaySource*> replays;    // 按 worker 下标, 由 impl 持有
+};
+
+namespace {
+
+bool toEntry(const XDPDNSRule& in, xdp_dns::RuleEntries* out) {
+    size_t len = strnlen(in.domain, sizeof(in.domain));
+    if (len == 0 || len == sizeof(in.domain) || in.action > XDP_DNS_ACTION_LOG ||
+        in.block_mode > XDP_DNS_BLOCK_DROP) {
+        return false;
+    }
+
+    xdp_dns::Rule rule;
+    rule.id = in.id;
+    rule.action = static_cast<xdp_dns::Action>(in.action);
+    rule.block_mode = static_cast<xdp_dns::BlockMode>(in.block_mode);
+    rule.redirect_ip = in.redirect_ip;
+    rule.ttl = in.ttl;
+    std::memcpy(rule.rule_id, in.rule_id, sizeof(rule.rule_id));
+    rule.rule_id[sizeof(rule.rule_id) - 1] = '\0';
+
+    out->emplace_back(std::string(in.domain, len), rule);
+    return true;
+}
+
+int toEntries(const XDPDNSRule* rules, size_t count, xdp_dns::RuleEntries* out) {
+    if (count && !rules) return XDP_DNS_ERR_INVALID_PARAM;
+
+    out->reserve(count);
+    for (size_t i = 0; i < count; i++) {
+        if (!toEntry(rules[i], out)) return XDP_DNS_ERR_INVALID_PARAM;
+    }
+    return XDP_DNS_OK;
+}
+
+void fillResult(const xdp_dns::FilterResult& r, XDPDNSCheckResult* out) {
+    out->action = static_cast<uint8_t>(r.action);
+    out->matched = r.matched_rule != nullptr;
+    if (r.matched_rule) {
+        out->block_mode = static_cast<uint8_t>(r.matched_rule->block_mode);
+        out->id = r.matched_rule->id;
+        out->redirect_ip = r.matched_rule->redirect_ip;
+        out->ttl = r.matched_rule->ttl;
+        std::memcpy(out->rule_id, r.matched_rule->rule_id, sizeof(out->rule_id));
+    } else {
+        out->block_mode = XDP_DNS_BLOCK_NXDOMAIN;
+        out->id = 0;
+        out->redirect_ip = 0;
+        out->ttl = 0;
+        out->rule_id[0] = '\0';
+    }
+}
+
+} // anonymous namespace
+
+extern "C" {
+
+XDPDNSEngine* xdp_dns_engine_create(const XDPDNSEngineOptions* opts) {
+    xdp_dns::ArenaOptions arena = xdp_dns::defaultArenaOptions();
+    if (opts) {
+        if (opts->numa_node < -1 ||
+            (opts->numa_node >= 0 && !xdp_dns::numaNodeOnline(opts->numa_node))) {
+            return nullptr;
+        }
+        arena.huge_pages = opts->huge_pages != 0;
+        arena.numa_node = opts->numa_node;
+        arena.numa_replicas = opts->numa_replicas != 0;
+    }
+    return new (std::nothrow) XDPDNSEngine(arena);
+}
+
+void xdp_dns_engine_destroy(XDPDNSEngine* engine) {
+    delete engine;
+}
+
+int xdp_dns_engine_load_rules(XDPDNSEngine* engine, const char* yaml, size_t len) {
+    if (!engine || (len && !yaml)) return XDP_DNS_ERR_INVALID_PARAM;
+
+    xdp_dns::RuleEntries entries;
+    xdp_dns::RuleSetPolicy policy;
+    auto zones = std::make_shared<xdp_dns::LocalZones>();
+    auto answers = std::make_shared<xdp_dns::AnswerTable>();
+    if (xdp_dns::parseRuleYaml(yaml ? yaml : "", len, &entries, &policy, zones.get(),
+                               answers.get()) != xdp_dns::Error::Success) {
+        return XDP_DNS_ERR_INVALID_RULES;
+    }
+    engine->slot.replace(entries, policy, std::move(zones), std::move(answers));
+    return XDP_DNS_OK;
+}
+
+int xdp_dns_engine_load_rules_file(XDPDNSEngine* engine, const char* path) {
+    if (!engine || !path) return XDP_DNS_ERR_INVALID_PARAM;
+
+    xdp_dns::RuleEntries entries;
+    xdp_dns::RuleSetPolicy policy;
+    auto zones = std::make_shared<xdp_dns::LocalZones>();
+    auto answers = std::make_shared<xdp_dns::AnswerTable>();
+    if (xdp_dns::loadRuleFile(path, &entries, &policy, zones.get(), answers.get()) !=
+        xdp_dns::Error::Success) {
+        return XDP_DNS_ERR_INVALID_RULES;
+    }
+    engine->slot.replace(entries, policy, std::move(zones), std::move(answers));
+    return XDP_DNS_OK;
+}
+
+int xdp_dns_engine_any_policy(XDPDNSEngine* engine, uint32_t* ttl) {
+    if (!engine) return XDP_DNS_ERR_INVALID_PARAM;
+
+    xdp_dns::RuleSetPolicy policy = engine->slot.policy();
+    if (ttl) *ttl = policy.any_ttl;
+    return static_cast<int>(policy.any_policy);
+}
+
+uint32_t xdp_dns_engine_negative_ttl(XDPDNSEngine* engine) {
+    if (!engine) return 0;
+    return engine->slot.policy().negative_ttl;
+}
+
+int xdp_dns_engine_answer_any(
+    XDPDNSEngine* engine,
+    const uint8_t* query,
+    size_t query_len,
+    uint8_t* response_buf,
+    size_t response_buf_size,
+    size_t* response_len
+) {
+    if (!engine || !query || !response_buf || !response_len) return XDP_DNS_ERR_INVALID_PARAM;
+
+    *response_len = 0;
+    xdp_dns::DNSParseResult parsed;
+    auto err = xdp_dns::DNSParser::parse(query, query_len, &parsed);
+    if (err != xdp_dns::Error::Success) {
+        return static_cast<int>(err);
+    }
+    if (parsed.question.qtype != xdp_dns::dns_type::ANY) {
+        return XDP_DNS_OK;
+    }
+
+    xdp_dns::RuleSetPolicy policy = engine->slot.policy();
+    if (policy.any_policy == xdp_dns::AnyPolicy::Forward) {
+        return XDP_DNS_OK;
+    }
+    size_t built_len = xdp_dns::DNSResponseBuilder::buildAnyResponse(
+        query, query_len, parsed, policy, response_buf, response_buf_size);
+    if (built_len == 0) {
+        return XDP_DNS_ERR_BUFFER_TOO_SMALL;
+    }
+    *response_len = built_len;
+    return XDP_DNS_OK;
+}
+
+int xdp_dns_engine_add_rules(XDPDNSEngine* engine, const XDPDNSRule* rules, size_t count) {
+    if (!engine) return XDP_DNS_ERR_INVALID_PARAM;
+
+    // 先整体校验, 避免只加入一部分
+    xdp_dns::RuleEntries entries;
+    int ret = toEntries(rules, count, &entries);
+    if (ret != XDP_DNS_OK) return ret;
+
+    engine->slot.addRules(entries);
+    return XDP_DNS_OK;
+}
+
+int xdp_dns_engine_remove_rules(
+    XDPDNSEngine* engine,
+    const XDPDNSRule* rules,
+    size_t count,
+    size_t* removed
+) {
+    if (!engine || (count && !rules)) return XDP_DNS_ERR_INVALID_PARAM;
+
+    std::vector<std::string> domains;
+    domains.reserve(count);
+    for (size_t i = 0; i < count; i++) {
+        domains.emplace_back(rules[i].domain, strnlen(rules[i].domain, sizeof(rules[i].domain)));
+    }
+    size_t n = engine->slot.removeDomains(domains);
+
+    if (removed) *removed = n;
+    return XDP_DNS_OK;
+}
+
+int xdp_dns_engine_update_rules(XDPDNSEngine* engine, const XDPDNSRule* rules, size_t count) {
+    if (!engine) return XDP_DNS_ERR_INVALID_PARAM;
+
+    xdp_dns::RuleEntries entries;
+    int ret = toEntries(rules, count, &entries);
+    if (ret != XDP_DNS_OK) return ret;
+    // 只替换规则, 保留当前规则集的策略与本地权威区
+    engine->slot.replaceRules(entries);
+    return XDP_DNS_OK;
+}
+
+int xdp_dns_engine_check(
+    XDPDNSEngine* engine,
+    const char* domain,
+    size_t domain_len,
+    uint16_t qtype,
+    XDPDNSCheckResult* result
+) {
+    if (!engine || !domain || !result) return XDP_DNS_ERR_INVALID_PARAM;
+
+    // 规则字段在锁内复制: 锁外旧引擎可能已被替换并释放
+    engine->slot.read([&](const xdp_dns::FilterEngine& impl) {
+        fillResult(impl.check(domain, domain_len, qtype), result);
+    });
+    return XDP_DNS_OK;
+}
+
+int xdp_dns_engine_check_batch(
+    XDPDNSEngine* engine,
+    const XDPDNSParseResult* queries,
+    size_t count,
+    XDPDNSCheckResult* results
+) {
+    if (!engine || (count && (!queries || !results))) return XDP_DNS_ERR_INVALID_PARAM;
+
+    engine->slot.read([&](const xdp_dns::FilterEngine& impl) {
+        for (size_t i = 0; i < count; i++) {
+            const XDPDNSParseResult& q = queries[i];
+            fillResult(impl.check(q.domain, q.domain_len, q.qtype), &results[i]);
+        }
+    });
+    return XDP_DNS_OK;
+}
+
+void xdp_dns_engine_get_stats(XDPDNSEngine* engine, XDPDNSEngineStats* stats) {
+    if (!engine || !stats) return;
+
+    xdp_dns::FilterEngine::Stats total = engine->slot.stats();
+
+    stats->total_checks = total.total_checks;
+    stats->allowed = total.allowed;
+    stats->blocked = total.blocked;
+    stats->redirected = total.redirected;
+    stats->logged = total.logged;
+    stats->rule_count = engine->slot.ruleCount();
+}
+
+void xdp_dns_engine_reset_stats(XDPDNSEngine* engine) {
+    if (!engine) return;
+
+    engine->slot.resetStats();
+}
+
+void xdp_dns_engine_get_memory_stats(XDPDNSEngine* engine, XDPDNSMemoryStats* stats) {
+    if (!engine || !stats) return;
+
+    xdp_dns::MemoryUsage usage = engine->slot.memoryUsage();
+
+    using xdp_dns::MemCategory;
+    stats->node_bytes = usage.bytes[static_cast<size_t>(MemCategory::Nodes)];
+    stats->label_bytes = usage.bytes[static_cast<size_t>(MemCategory::Labels)];
+    stats->rule_bytes = usage.bytes[static_cast<size_t>(MemCategory::Rules)];
+    stats->cache_bytes = usage.bytes[static_cast<size_t>(MemCategory::Cache)];
+    stats->index_bytes = usage.bytes[static_cast<size_t>(MemCategory::Index)];
+    stats->total_bytes = usage.totalBytes();
+    stats->reserved_bytes = usage.reserved_bytes;
+    stats->allocations = usage.allocations;
+    stats->rule_count = usage.rule_count;
+    stats->bytes_per_rule = usage.bytesPerRule();
+    stats->fragmentation = usage.fragmentation();
+}
+
+int xdp_dns_engine_swap(XDPDNSEngine* a, XDPDNSEngine* b) {
+    if (!a || !b) return XDP_DNS_ERR_INVALID_PARAM;
+    a->slot.swap(b->slot);
+    return XDP_DNS_OK;
+}
+
+void xdp_dns_engine_publish_rule_info(XDPDNSEngine* engine, int enabled) {
+    if (engine) engine->slot.setPublishRuleInfo(enabled != 0);
+}
+
+// ==================== 响应缓存 ====================
+
+XDPDNSCache* xdp_dns_cache_create(const XDPDNSCacheOptions* opts) {
+    xdp_dns::ResponseCacheOptions cache_opts;
+    if (opts) {
+        if (opts->capacity) cache_opts.capacity = opts->capacity;
+        if (opts->shards) cache_opts.shards = opts->shards;
+        if (opts->max_entry_size) cache_opts.max_entry_size = opts->max_entry_size;
+        cache_opts.max_ttl = opts->max_ttl;
+        if (opts->prefetch_percent) cache_opts.prefetch_percent = opts->prefetch_percent;
+        if (opts->disable_prefetch) cache_opts.prefetch_percent = 0;
+        cache_opts.stale_window = opts->stale_window;
+        if (opts->stale_ttl) cache_opts.stale_ttl = opts->stale_ttl;
+        cache_opts.max_negative_ttl = opts->max_negative_ttl;
+        cache_opts.nxdomain_cut = opts->disable_nxdomain_cut == 0;
+    }
+    return new (std::nothrow) XDPDNSCache(cache_opts);
+}
+
+void xdp_dns_cache_destroy(XDPDNSCache* cache) {
+    delete cache;
+}
+
+int xdp_dns_cache_insert(XDPDNSCache* cache, const uint8_t* response, size_t len) {
+    if (!cache || !response) return XDP_DNS_ERR_INVALID_PARAM;
+    return cache->impl.insert(response, len, xdp_dns::monotonicNs()) ? 1 : 0;
+}
+
+int xdp_dns_cache_lookup(
+    XDPDNSCache* cache,
+    const uint8_t* query,
+    size_t query_len,
+    uint8_t* response_buf,
+    size_t response_buf_size,
+    size_t* response_len
+) {
+    if (!cache || !query || !response_buf || !response_len) return XDP_DNS_ERR_INVALID_PARAM;
+
+    *response_len = 0;
+    xdp_dns::DNSParseResult parsed;
+    auto err = xdp_dns::DNSParser::parse(query, query_len, &parsed);
+    if (err != xdp_dns::Error::Success) {
+        return static_cast<int>(err);
+    }
+    *response_len = cache->impl.lookup(query, query_len, parsed, xdp_dns::monotonicNs(),
+                                       response_buf, response_buf_size);
+    return XDP_DNS_OK;
+}
+
+void xdp_dns_cache_clear(XDPDNSCache* cache) {
+    if (cache) cache->impl.clear();
+}
+
+void xdp_dns_cache_get_stats(XDPDNSCache* cache, XDPDNSCacheStats* stats) {
+    if (!cache || !stats) return;
+
+    xdp_dns::ResponseCacheStats s = cache->impl.stats();
+    stats->hits = s.hits;
+    stats->misses = s.misses;
+    stats->stale_hits = s.stale_hits;
+    stats->prefetches = s.prefetches;
+    stats->cut_hits = s.cut_hits;
+    stats->expired = s.expired;
+    stats->inserts = s.inserts;
+    stats->negative_inserts = s.negative_inserts;
+    stats->evictions = s.evictions;
+    stats->rejected = s.rejected;
+    stats->entries = s.entries;
+    stats->capacity = cache->impl.capacity();
+    stats->memory_bytes = cache->impl.memoryUsage().reserved_bytes;
+}
+
+// ==================== 上游转发器 ====================
+
+XDPDNSForwarder* xdp_dns_forwarder_create(const XDPDNSForwarderOptions* opts) {
+    if (!opts || !opts->servers || opts->num_servers == 0) return nullptr;
+
+    xdp_dns::ForwarderOptions fwd_opts;
+    for (uint32_t i = 0; i < opts->num_servers; i++) {
+        if (!opts->servers[i]) return nullptr;
+        fwd_opts.servers.emplace_back(opts->servers[i]);
+    }
+    if (opts->num_sockets) fwd_opts.num_sockets = opts->num_sockets;
+    if (opts->max_inflight) fwd_opts.max_inflight = opts->max_inflight;
+    if (opts->num_owners) fwd_opts.num_owners = opts->num_owners;
+    if (opts->timeout_ms) fwd_opts.timeout_ms = opts->timeout_ms;
+    fwd_opts.retries = opts->retries;
+    fwd_opts.coalesce = opts->disable_coalescing == 0;
+
+    auto* fwd = new (std::nothrow) XDPDNSForwarder(fwd_opts);
+    if (fwd && !fwd->impl.start()) {
+        delete fwd;
+        return nullptr;
+    }
+    return fwd;
+}
+
+void xdp_dns_forwarder_destroy(XDPDNSForwarder* fwd) {
+    delete fwd;
+}
+
+void xdp_dns_forwarder_get_stats(XDPDNSForwarder* fwd, XDPDNSForwarderStats* stats) {
+    if (!fwd || !stats) return;
+
+    xdp_dns::ForwarderStats s = fwd->impl.stats();
+    stats->submitted = s.submitted;
+    stats->coalesced = s.coalesced;
+    stats->rejected = s.rejected;
+    stats->sent = s.sent;
+    stats->send_errors = s.send_errors;
+    stats->responses = s.responses;
+    stats->mismatched = s.mismatched;
+    stats->retries = s.retries;
+    stats->timeouts = s.timeouts;
+    stats->truncated = s.truncated;
+    stats->completed = s.completed;
+    stats->inflight = s.inflight;
+}
+
+// ==================== C++ 数据面 ====================
+
+XDPDNSDataplane* xdp_dns_dataplane_create(XDPDNSEngine* engine, const XDPDNSDataplaneOptions* opts) {
+    if (!engine) return nullptr;
+
+    xdp_dns::DataplaneOptions dp_opts;
+    const char* name = XDP_DNS_RING_DEFAULT_NAME;
+    if (opts) {
+        if (opts->shm_name) name = opts->shm_name;
+        dp_opts.num_workers = opts->num_workers;
+        if (opts->ring_capacity) dp_opts.ring_capacity = opts->ring_capacity;
+        dp_opts.sample_interval = opts->sample_interval;
+        dp_opts.log_blocked = opts->log_blocked != 0;
+        if (opts->cache) dp_opts.cache = &opts->cache->impl;
+        if (opts->forwarder) dp_opts.forwarder = &opts->forwarder->impl;
+    }
+
+    auto* dp = new (std::nothrow) XDPDNSDataplane(&engine->slot, dp_opts);
+    if (dp && !dp->impl.open(name)) {
+        delete dp;
+        return nullptr;
+    }
+    return dp;
+}
+
+int xdp_dns_dataplane_add_replay(XDPDNSDataplane* dp, uint32_t worker, const char* raw_path, uint64_t loops) {
+    if (!dp || !raw_path) return XDP_DNS_ERR_INVALID_PARAM;
+
+    auto source = xdp_dns::ReplaySource::fromRawFile(raw_path, loops);
+    if (!source) return XDP_DNS_ERR_SYSTEM;
+
+    xdp_dns::ReplaySource* raw = source.get();
+    if (!dp->impl.setSource(worker, std::move(source))) return XDP_DNS_ERR_INVALID_PARAM;
+    if (dp->replays.size() <= worker) dp->replays.resize(worker + 1, nullptr);
+    dp->replays[worker] = raw;
+    return XDP_DNS_OK;
+}
+
+int xdp_dns_dataplane_add_xsk(XDPDNSDataplane* dp, uint32_t worker, const XDPDNSXskConfig* cfg) {
+    if (!dp || !cfg) return XDP_DNS_ERR_INVALID_PARAM;
+
+    auto ring = [](const XDPDNSXskRing& r) {
+        return xdp_dns::XskRing{r.producer, r.consumer, r.descs, r.size};
+    };
+    xdp_dns::XskConfig xsk;
+    xsk.fd = cfg->fd;
+    xsk.umem = cfg->umem;
+    xsk.umem_size = cfg->umem_size;
+    xsk.frame_size = cfg->frame_size;
+    if (cfg->tx_reserve) xsk.tx_reserve = cfg->tx_reserve;
+    if (cfg->mtu) xsk.mtu = cfg->mtu;
+    xsk.fill = ring(cfg->fill);
+    xsk.completion = ring(cfg->completion);
+    xsk.rx = ring(cfg->rx);
+    xsk.tx = ring(cfg->tx);
+    if (xsk.fd < 0 || !xdp_dns::XskSource::valid(xsk)) return XDP_DNS_ERR_INVALID_PARAM;
+
+    if (!dp->impl.setSource(worker, std::make_unique<xdp_dns::XskSource>(xsk))) {
+        return XDP_DNS_ERR_INVALID_PARAM;
+    }
+    return XDP_DNS_OK;
+}
+
+int xdp_dns_dataplane_start(XDPDNSDataplane* dp) {
+    if (!dp) return XDP_DNS_ERR_INVALID_PARAM;
+    return dp->impl.start() ? XDP_DNS_OK : XDP_DNS_ERR_SYSTEM;
+}
+
+void xdp_dns_dataplane_stop(XDPDNSDataplane* dp) {
+    if (dp) dp->impl.stop();
+}
+
+void xdp_dns_dataplane_destroy(XDPDNSDataplane* dp) {
+    delete dp;
+}
+
+int xdp_dns_dataplane_replay_done(XDPDNSDataplane* dp) {
+    if (!dp) return 0;
+    for (const auto* r : dp->replays) {
+        if (r && !r->done()) return 0;
+    }
+    return 1;
+}
+
+void xdp_dns_dataplane_get_stats(XDPDNSDataplane* dp, XDPDNSDataplaneStats* stats) {
+    if (!dp || !stats) return;
+
+    xdp_dns::DataplaneStats s = dp->impl.stats();
+    stats->packets = s.packets;
+    stats->responded = s.responded;
+    stats->passed = s.passed;
+    stats->parse_errors = s.parse_errors;
+    stats->events = s.events;
+    stats->events_dropped = s.events_dropped;
+    stats->control_applied = s.control_applied;
+    stats->any_answered = s.any_answered;
+    stats->cache_hits = s.cache_hits;
+    stats->cache_refreshes = s.cache_refreshes;
+    stats->forwarded = s.forwarded;
+    stats->upstream_replies = s.upstream_replies;
+    stats->dropped = s.dropped;
+    stats->local_answered = s.local_answered;
+}
+
+} // extern "C"
@@ -0,0 +1,467 @@
+#include "xdp_dns/dataplane.hpp"
+#include "xdp_dns/dns_parser.hpp"
+#include "xdp_dns/local_zone.hpp"
+#include "xdp_dns/response_writer.hpp"
+#include "xdp_dns/stats.hpp"
+#include <chrono>
+#include <cstddef>
+#include <cstdio>
+#include <cstring>
+
+namespace xdp_dns {
+
+// ==================== ReplaySource ====================
+
+ReplaySource::ReplaySource(std::vector<std::string> queries, uint64_t loops)
+    : queries_(std::move(queries)), loops_(loops), frames_(kMaxBatch * kFrameSize) {
+    if (queries_.empty()) {
+        done_.store(true, std::memory_order_release);
+    }
+}
+
+std::unique_ptr<ReplaySource> ReplaySource::fromRawFile(const char* path, uint64_t loops) {
+    if (!path) return nullptr;
+
+    FILE* f = std::fopen(path, "rb");
+    if (!f) return nullptr;
+
+    std::vector<std::string> queries;
+    uint8_t len_buf[2];
+    bool ok = true;
+    while (std::fread(len_buf, 1, sizeof(len_buf), f) == sizeof(len_buf)) {
+        size_t len = static_cast<size_t>(len_buf[0]) << 8 | len_buf[1];
+        std::string payload(len, '\0');
+        if (len > kFrameSize || std::fread(&payload[0], 1, len, f) != len) {
+            ok = false;
+            break;
+        }
+        queries.push_back(std::move(payload));
+    }
+    ok = ok && !std::ferror(f);
+    std::fclose(f);
+    if (!ok) return nullptr;
+
+    return std::make_unique<ReplaySource>(std::move(queries), loops);
+}
+
+size_t ReplaySource::receive(PacketBuf* pkts, size_t max) {
+    if (queries_.empty() || (loops_ && loop_ >= loops_)) return 0;
+
+    size_t n = 0;
+    max = max < kMaxBatch ? max : kMaxBatch;
+    while (n < max && (!loops_ || loop_ < loops_)) {
+        const std::string& q = queries_[next_];
+        uint8_t* frame = &frames_[n * kFrameSize];
+        std::memcpy(frame, q.data(), q.size());
+        pkts[n] = PacketBuf{frame, static_cast<uint32_t>(q.size()),
+                            static_cast<uint32_t>(kFrameSize), next_};
+        n++;
+
+        if (++next_ == queries_.size()) {
+            next_ = 0;
+            loop_++;
+        }
+    }
+    return n;
+}
+
+void ReplaySource::complete(const PacketBuf*, const PacketVerdict* verdicts, size_t n) {
+    uint64_t responded = 0;
+    for (size_t i = 0; i < n; i++) {
+        responded += verdicts[i] == PacketVerdict::Respond;
+    }
+    responded_.fetch_add(responded, std::memory_order_relaxed);
+
+    if (loops_ && loop_ >= loops_) {
+        done_.store(true, std::memory_order_release);
+    }
+}
+
+bool ReplaySource::transmit(uint64_t, const uint8_t*, size_t) {
+    transmitted_.fetch_add(1, std::memory_order_relaxed);
+    return true;
+}
+
+// ==================== Dataplane ====================
+
+Dataplane::Dataplane(EngineSlot* engine, const DataplaneOptions& opts)
+    : engine_(engine), opts_(opts), sample_interval_(opts.sample_interval) {
+    engine_->setPublishRuleInfo(true);
+    if (opts_.num_workers == 0) opts_.num_workers = 1;
+    if (opts_.num_workers > XDP_DNS_RING_MAX_WORKERS) opts_.num_workers = XDP_DNS_RING_MAX_WORKERS;
+
+    workers_.reserve(opts_.num_workers);
+    for (uint32_t i = 0; i < opts_.num_workers; i++) {
+        workers_.push_back(std::make_unique<Worker>());
+    }
+}
+
+Dataplane::~Dataplane() {
+    stop();
+}
+
+bool Dataplane::open(const char* shm_name) {
+    if (!channel_.create(shm_name, opts_.num_workers, opts_.ring_capacity)) {
+        return false;
+    }
+    for (uint32_t i = 0; i < opts_.num_workers; i++) {
+        workers_[i]->events = channel_.events(i);
+    }
+    return true;
+}
+
+bool Dataplane::setSource(uint32_t worker, std::unique_ptr<PacketSource> source) {
+    if (worker >= workers_.size() || running_.load(std::memory_order_acquire)) {
+        return false;
+    }
+    workers_[worker]->source = std::move(source);
+    return true;
+}
+
+bool Dataplane::start() {
+    if (!channel_.isOpen()) return false;
+    if (opts_.forwarder && opts_.forwarder->numOwners() < workers_.size()) return false;
+    if (running_.exchange(true)) return false;
+
+    control_thread_ = std::thread(&Dataplane::runControl, this);
+    for (uint32_t i = 0; i < workers_.size(); i++) {
+        if (workers_[i]->source) {
+            workers_[i]->thread = std::thread(&Dataplane::runWorker, this, i);
+        }
+    }
+    return true;
+}
+
+void Dataplane::stop() {
+    if (!running_.exchange(false)) return;
+
+    for (auto& w : workers_) {
+        if (w->thread.joinable()) w->thread.join();
+    }
+    if (control_thread_.joinable()) control_thread_.join();
+}
+
+DataplaneStats Dataplane::stats() const {
+    DataplaneStats s{};
+    for (const auto& w : workers_) {
+        s.packets += w->packets.load(std::memory_order_relaxed);
+        s.responded += w->responded.load(std::memory_order_relaxed);
+        s.passed += w->passed.load(std::memory_order_relaxed);
+        s.parse_errors += w->parse_errors.load(std::memory_order_relaxed);
+        s.any_answered += w->any_answered.load(std::memory_order_relaxed);
+        s.dropped += w->dropped.load(std::memory_order_relaxed);
+        s.local_answered += w->local_answered.load(std::memory_order_relaxed);
+        s.cache_hits += w->cache_hits.load(std::memory_order_relaxed);
+        s.cache_refreshes += w->cache_refreshes.load(std::memory_order_relaxed);
+        s.forwarded += w->forwarded.load(std::memory_order_relaxed);
+        s.upstream_replies += w->upstream_replies.load(std::memory_order_relaxed);
+        s.events += w->events_sent.load(std::memory_order_relaxed);
+        if (w->events.valid()) s.events_dropped += w->events.dropped();
+    }
+    s.control_applied = control_applied_.load(std::memory_order_relaxed);
+    return s;
+}
+
+void Dataplane::runWorker(uint32_t index) {
+    Worker& w = *workers_[index];
+    PacketBuf pkts[kBatchSize];
+    PacketVerdict verdicts[kBatchSize];
+    const uint8_t* data[kBatchSize];
+    uint32_t lens[kBatchSize];
+
+    while (running_.load(std::memory_order_relaxed)) {
+        if (opts_.forwarder) drainForwarder(index);
+
+        size_t n = w.source->receive(pkts, kBatchSize);
+        if (n == 0) {
+            std::this_thread::sleep_for(std::chrono::microseconds(opts_.idle_sleep_us));
+            continue;
+        }
+
+        // 先整批预筛头部, 畸形包与非标准查询不进入详细解析
+        for (size_t i = 0; i < n; i++) {
+            data[i] = pkts[i].data;
+            lens[i] = pkts[i].len;
+        }
+        uint64_t candidates = DNSParser::classifyHeaders(data, lens, n);
+        if (opts_.cache) w.batch_ns = monotonicNs();
+
+        // 整批只取一次引擎读锁
+        engine_->read([&](const FilterEngine& engine) {
+            for (size_t i = 0; i < n; i++) {
+                verdicts[i] = process(engine, index, &pkts[i], candidates >> i & 1);
+            }
+        });
+        if (opts_.forwarder) forwardBatch(index, pkts, verdicts, n);
+        w.source->complete(pkts, verdicts, n);
+    }
+}
+
+void Dataplane::forwardBatch(uint32_t index, const PacketBuf* pkts, PacketVerdict* verdicts,
+                             size_t n) {
+    Worker& w = *workers_[index];
+    ForwardRequest reqs[kBatchSize * 2];
+    uint32_t slots[kBatchSize];
+    bool accepted[kBatchSize * 2];
+    size_t count = 0;
+    for (size_t i = 0; i < n; i++) {
+        if (verdicts[i] != PacketVerdict::Forwarded) continue;
+        reqs[count] = ForwardRequest{pkts[i].data, pkts[i].len, index, pkts[i].cookie};
+        slots[count++] = static_cast<uint32_t>(i);
+    }
+    size_t refreshes = w.num_refresh;
+    for (size_t i = 0; i < refreshes; i++) {
+        reqs[count + i] = ForwardRequest{w.refresh[i], w.refresh_lens[i], index, kRefreshCookie};
+    }
+    w.num_refresh = 0;
+    if (count + refreshes == 0) return;
+
+    // 整批一次 sendmmsg; 表满时客户端查询退回原样放行, 刷新查询直接放弃
+    opts_.forwarder->submit(reqs, count + refreshes, accepted);
+    size_t sent = 0;
+    for (size_t i = 0; i < count; i++) {
+        if (accepted[i]) {
+            sent++;
+        } else {
+            verdicts[slots[i]] = PacketVerdict::Pass;
+        }
+    }
+    size_t refreshed = 0;
+    for (size_t i = count; i < count + refreshes; i++) refreshed += accepted[i];
+    w.forwarded.fetch_add(sent, std::memory_order_relaxed);
+    w.passed.fetch_add(count - sent, std::memory_order_relaxed);
+    w.cache_refreshes.fetch_add(refreshed, std::memory_order_relaxed);
+}
+
+void Dataplane::drainForwarder(uint32_t index) {
+    Worker& w = *workers_[index];
+    ForwardCompletion done[kBatchSize];
+    size_t n = opts_.forwarder->poll(index, done, kBatchSize);
+    if (n == 0) return;
+
+    // 上游响应先写入缓存 (不可缓存的由 insert 拒绝), 刷新查询的结果不发出
+    uint64_t now_ns = opts_.cache ? monotonicNs() : 0;
+    uint64_t replies = 0;
+    for (size_t i = 0; i < n; i++) {
+        if (!done[i].len) continue;
+        if (opts_.cache) opts_.cache->insert(done[i].response, done[i].len, now_ns);
+        if (done[i].cookie == kRefreshCookie) continue;
+        replies += w.source->transmit(done[i].cookie, done[i].response, done[i].len);
+    }
+    opts_.forwarder->release(done, n);
+    w.upstream_replies.fetch_add(replies, std::memory_order_relaxed);
+}
+
+PacketVerdict Dataplane::process(const FilterEngine& engine, uint32_t index, PacketBuf* pkt,
+                                 bool candidate) {
+    Worker& w = *workers_[index];
+    CoreCounters& stats = StatsRegistry::instance().local();
+    stats.packets_received.fetch_add(1, std::memory_order_relaxed);
+    w.packets.fetch_add(1, std::memory_order_relaxed);
+
+    DNSParseResult parsed;
+    char domain[MAX_DOMAIN_LENGTH + 1];
+    size_t domain_len = 0;
+    if (!candidate || DNSParser::parse(pkt->data, pkt->len, &parsed) != Error::Success ||
+        DNSParser::decodeName(pkt->data, pkt->len, parsed.question.name_offset,
+                              domain, sizeof(domain), &domain_len) != Error::Success) {
+        stats.parse_errors.fetch_add(1, std::memory_order_relaxed);
+        w.parse_errors.fetch_add(1, std::memory_order_relaxed);
+        w.passed.fetch_add(1, std::memory_order_relaxed);
+        return PacketVerdict::Pass;
+    }
+    stats.packets_parsed.fetch_add(1, std::memory_order_relaxed);
+
+    uint16_t qtype = parsed.question.qtype;
+    FilterResult result = engine.check(domain, domain_len, qtype);
+    const Rule* rule = result.matched_rule;
+
+    size_t response_len = 0;
+    bool drop = false;
+    switch (result.action) {
+        case Action::Block:
+            // 应答方式由规则决定 (查表); 静默丢弃不构建响应
+            stats.packets_blocked.fetch_add(1, std::memory_order_relaxed);
+            if (rule->block_mode == BlockMode::Drop) {
+                drop = true;
+                break;
+            }
+            response_len = DNSResponseBuilder::buildBlocked(
+                pkt->data, pkt->len, parsed, rule->block_mode, rule->ttl,
+                engine.policy().negative_ttl, pkt->data, pkt->capacity);
+            break;
+        case Action::Redirect:
+            // 预编译应答 (CNAME / 多地址轮转) 整段复制; 单个 IPv4 地址的规则
+            // 对其它类型 (如 AAAA) 回答 NODATA
+            stats.packets_redirected.fetch_add(1, std::memory_order_relaxed);
+            if (const RedirectAnswer* answer = engine.redirectAnswer(*rule)) {
+                const RRBlob& blob = answer->forType(qtype);
+                ResponseWriter writer;
+                if (!blob.count) {
+                    response_len = DNSResponseBuilder::buildNoData(
+                        pkt->data, pkt->len, parsed, engine.policy().negative_ttl,
+                        pkt->data, pkt->capacity);
+                } else if (writer.begin(pkt->data, parsed, pkt->data, pkt->capacity) &&
+                           writer.addBlob(blob, w.rr_tick++)) {
+                    response_len = writer.finish();
+                }
+            } else if (qtype == dns_type::A || qtype == dns_type::ANY) {
+                response_len = DNSResponseBuilder::buildAResponse(
+                    pkt->data, pkt->len, parsed, rule->redirect_ip, rule->ttl,
+                    pkt->data, pkt->capacity);
+            } else {
+                response_len = DNSResponseBuilder::buildNoData(
+                    pkt->data, pkt->len, parsed, engine.policy().negative_ttl,
+                    pkt->data, pkt->capacity);
+            }
+            break;
+        default:
+            stats.packets_allowed.fetch_add(1, std::memory_order_relaxed);
+            // 本地权威区内的名字 (含 ANY) 由预编译应答回答, 不查缓存也不转发
+            if (const LocalZones* zones = engine.localZones()) {
+                response_len = zones->answer(pkt->data, parsed, domain, domain_len, pkt->data,
+                                             pkt->capacity, w.rr_tick++);
+                if (response_len) w.local_answered.fetch_add(1, std::memory_order_relaxed);
+            }
+            // 放行的 ANY 查询不转发上游 (RFC 8482)
+            if (!response_len && qtype == dns_type::ANY) {
+                response_len = DNSResponseBuilder::buildAnyResponse(
+                    pkt->data, pkt->len, parsed, engine.policy(), pkt->data, pkt->capacity);
+                if (response_len) w.any_answered.fetch_add(1, std::memory_order_relaxed);
+            }
+            if (!response_len && opts_.cache) {
+                bool refresh = false;
+                response_len = opts_.cache->lookup(pkt->data, pkt->len, parsed, w.batch_ns,
+                                                   pkt->data, pkt->capacity,
+                                                   opts_.forwarder ? &refresh : nullptr);
+                if (response_len) w.cache_hits.fetch_add(1, std::memory_order_relaxed);
+                // 刷新查询由应答还原, 客户端仍立即得到缓存应答
+                if (refresh) {
+                    size_t len = ResponseCache::buildRefreshQuery(
+                        pkt->data, response_len, parsed.id, w.refresh[w.num_refresh],
+                        kRefreshQuerySize);
+                    if (len) w.refresh_lens[w.num_refresh++] = static_cast<uint32_t>(len);
+                }
+            }
+            break;
+    }
+
+    bool log = result.action == Action::Log ||
+               (opts_.log_blocked && result.action != Action::Allow);
+    if (log) {
+        sendEvent(index, XDP_DNS_RING_EVENT_LOG, domain, domain_len, qtype, result);
+    } else if (uint32_t interval = sample_interval_.load(std::memory_order_relaxed)) {
+        if (++w.sample_tick >= interval) {
+            w.sample_tick = 0;
+            sendEvent(index, XDP_DNS_RING_EVENT_SAMPLE, domain, domain_len, qtype, result);
+        }
+    }
+
+    if (drop) {
+        w.dropped.fetch_add(1, std::memory_order_relaxed);
+        return PacketVerdict::Drop;
+    }
+    if (response_len) {
+        pkt->len = static_cast<uint32_t>(response_len);
+        stats.response_built.fetch_add(1, std::memory_order_relaxed);
+        w.responded.fetch_add(1, std::memory_order_relaxed);
+        return PacketVerdict::Respond;
+    }
+    if (opts_.forwarder && result.action != Action::Block && result.action != Action::Redirect) {
+        return PacketVerdict::Forwarded;
+    }
+    w.passed.fetch_add(1, std::memory_order_relaxed);
+    return PacketVerdict::Pass;
+}
+
+void Dataplane::sendEvent(uint32_t index, uint16_t type, const char* domain, size_t domain_len,
+                          uint16_t qtype, const FilterResult& result) {
+    Worker& w = *workers_[index];
+
+    XDPDNSRingMsg msg;
+    std::memset(&msg, 0, offsetof(XDPDNSRingMsg, domain));
+    msg.type = type;
+    msg.qtype = qtype;
+    msg.domain_len = static_cast<uint16_t>(domain_len);
+    msg.action = static_cast<uint8_t>(result.action);
+    msg.value = index;
+    msg.timestamp_ns = wallClockNs();
+    if (const Rule* rule = result.matched_rule) {
+        msg.id = rule->id;
+        msg.block_mode = static_cast<uint8_t>(rule->block_mode);
+        msg.redirect_ip = rule->redirect_ip;
+        msg.ttl = rule->ttl;
+        std::memcpy(msg.rule_id, rule->rule_id, sizeof(msg.rule_id));
+    }
+    std::memcpy(msg.domain, domain, domain_len);
+    msg.domain[domain_len] = '\0';
+
+    // 环满时丢弃 (计入 dropped), 数据面从不等待控制面
+    if (w.events.push(msg)) {
+        w.events_sent.fetch_add(1, std::memory_order_relaxed);
+    }
+}
+
+void Dataplane::runControl() {
+    ShmRing control = channel_.control();
+    XDPDNSRingMsg msg;
+
+    while (running_.load(std::memory_order_relaxed)) {
+        bool any = false;
+        while (control.pop(&msg)) {
+            applyControl(msg);
+            any = true;
+        }
+        if (!any) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+    }
+}
+
+void Dataplane::applyControl(const XDPDNSRingMsg& msg) {
+    size_t domain_len = strnlen(msg.domain, sizeof(msg.domain));
+    if (domain_len == sizeof(msg.domain)) return;
+
+    switch (msg.type) {
+        case XDP_DNS_RING_CTRL_ADD_RULE: {
+            if (domain_len == 0 || msg.action > static_cast<uint8_t>(Action::Log) ||
+                msg.block_mode >= kBlockModeCount) {
+                return;
+            }
+
+            Rule rule;
+            rule.id = msg.id;
+            rule.action = static_cast<Action>(msg.action);
+            rule.block_mode = static_cast<BlockMode>(msg.block_mode);
+            rule.redirect_ip = msg.redirect_ip;
+            rule.ttl = msg.ttl;
+            std::memcpy(rule.rule_id, msg.rule_id, sizeof(rule.rule_id));
+            rule.rule_id[sizeof(rule.rule_id) - 1] = '\0';
+            engine_->addRules({{std::string(msg.domain, domain_len), rule}});
+            break;
+        }
+        case XDP_DNS_RING_CTRL_REMOVE_RULE:
+            engine_->removeDomains({std::string(msg.domain, domain_len)});
+            break;
+        case XDP_DNS_RING_CTRL_LOAD_RULES: {
+            RuleEntries entries;
+            RuleSetPolicy policy;
+            auto zones = std::make_shared<LocalZones>();
+            auto answers = std::make_shared<AnswerTable>();
+            if (loadRuleFile(msg.domain, &entries, &policy, zones.get(), answers.get()) !=
+                Error::Success) {
+                return;
+            }
+            engine_->replace(entries, policy, std::move(zones), std::move(answers));
+            break;
+        }
+        case XDP_DNS_RING_CTRL_SET_SAMPLE:
+            sample_interval_.store(msg.value, std::memory_order_relaxed);
+            break;
+        default:
+            return;
+    }
+    control_applied_.fetch_add(1, std::memory_order_relaxed);
+}
+
+} // namespace xdp_dns
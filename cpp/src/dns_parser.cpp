@@ -1,4 +1,6 @@
 #include "xdp_dns/dns_parser.hpp"
+#include "xdp_dns/probes.hpp"
+#include "xdp_dns/simd.hpp"
 
 namespace xdp_dns {
 
@@ -6,6 +8,42 @@ Error DNSParser::parse(
     const uint8_t* data,
     size_t len,
     DNSParseResult* result
+) {
+    XDP_DNS_PROBE2(parse__start, data, len);
+    Error err = parseQuery(data, len, result);
+    XDP_DNS_PROBE2(parse__end, static_cast<int>(err),
+                   err == Error::Success ? result->question.qtype : 0);
+    return err;
+}
+
+uint64_t DNSParser::classifyHeaders(
+    const uint8_t* const* pkts,
+    const uint32_t* lens,
+    size_t n
+) {
+    return simd().classify_headers(pkts, lens, n < 64 ? n : 64);
+}
+
+uint8_t DNSParser::queryEdns(
+    const uint8_t* data,
+    size_t len,
+    const DNSParseResult& parsed
+) {
+    // 根域名 (1) + TYPE + CLASS + TTL (扩展 RCODE、版本、标志) + RDLENGTH
+    size_t off = parsed.question_end;
+    if (parsed.header->getARCount() != 1 || off + 11 > len ||
+        data[off] != 0 || readU16(data + off + 1) != dns_type::OPT) {
+        return 0;
+    }
+    uint8_t flags = EDNS_PRESENT;
+    if (readU16(data + off + 7) & 0x8000) flags |= EDNS_DO;
+    return flags;
+}
+
+Error DNSParser::parseQuery(
+    const uint8_t* data,
+    size_t len,
+    DNSParseResult* result
 ) {
     if (!data || !result) {
         return Error::InvalidHeader;
@@ -47,8 +85,8 @@ Error DNSParser::parse(
         return Error::TruncatedMessage;
     }
 
-    result->question.qtype = ntohs(*reinterpret_cast<const uint16_t*>(data + name_end));
-    result->question.qclass = ntohs(*reinterpret_cast<const uint16_t*>(data + name_end + 2));
+    result->question.qtype = readU16(data + name_end);
+    result->question.qclass = readU16(data + name_end + 2);
     result->total_consumed = name_end + 4;
     result->question_end = name_end + 4;  // 问题部分结束位置
 
@@ -122,6 +160,124 @@ Error DNSParser::parseName(
     return Error::PointerLoop;
 }
 
+Error DNSParser::findAuthoritySoa(
+    const uint8_t* data,
+    size_t len,
+    const DNSParseResult& parsed,
+    DNSSoaRecord* soa
+) {
+    size_t answers = parsed.header->getANCount();
+    size_t records = answers + parsed.header->getNSCount();
+    size_t offset = parsed.question_end;
+
+    for (size_t i = 0; i < records; i++) {
+        size_t name_end = 0;
+        size_t wire_len = 0;
+        Error err = parseName(data, len, offset, &name_end, &wire_len);
+        if (err != Error::Success) {
+            return err;
+        }
+        // TYPE + CLASS + TTL + RDLENGTH
+        if (name_end + 10 > len) {
+            return Error::TruncatedMessage;
+        }
+        size_t rdata = name_end + 10;
+        size_t rdata_end = rdata + readU16(data + name_end + 8);
+        if (rdata_end > len) {
+            return Error::TruncatedMessage;
+        }
+
+        if (i >= answers && readU16(data + name_end) == dns_type::SOA) {
+            size_t pos = 0;
+            soa->offset = offset;
+            soa->rclass = readU16(data + name_end + 2);
+            soa->ttl = readU32(data + name_end + 4);
+            if (soa->ttl & 0x80000000u) soa->ttl = 0;  // RFC 2181
+            if ((err = expandName(data, rdata_end, offset, soa->owner, &soa->owner_len,
+                                  &pos)) != Error::Success ||
+                (err = expandName(data, rdata_end, rdata, soa->mname, &soa->mname_len,
+                                  &pos)) != Error::Success ||
+                (err = expandName(data, rdata_end, pos, soa->rname, &soa->rname_len,
+                                  &pos)) != Error::Success) {
+                return err;
+            }
+            if (pos + 20 != rdata_end) {
+                return Error::TruncatedMessage;
+            }
+            soa->serial = readU32(data + pos);
+            soa->refresh = readU32(data + pos + 4);
+            soa->retry = readU32(data + pos + 8);
+            soa->expire = readU32(data + pos + 12);
+            soa->minimum = readU32(data + pos + 16);
+            return Error::Success;
+        }
+        offset = rdata_end;
+    }
+
+    return Error::InvalidHeader;
+}
+
+Error DNSParser::expandName(
+    const uint8_t* packet,
+    size_t packet_len,
+    size_t name_offset,
+    uint8_t* out,
+    size_t* out_len,
+    size_t* end_offset
+) {
+    size_t offset = name_offset;
+    size_t pos = 0;
+    size_t jump_count = 0;
+    bool jumped = false;
+
+    while (jump_count < MAX_LABELS) {
+        if (offset >= packet_len) {
+            return Error::TruncatedMessage;
+        }
+
+        uint8_t label_len = packet[offset];
+
+        if (label_len == 0) {
+            out[pos++] = 0;
+            *out_len = pos;
+            if (!jumped) {
+                *end_offset = offset + 1;
+            }
+            return Error::Success;
+        }
+
+        // 压缩指针
+        if ((label_len & 0xC0) == 0xC0) {
+            if (offset + 1 >= packet_len) {
+                return Error::TruncatedMessage;
+            }
+            if (!jumped) {
+                *end_offset = offset + 2;
+                jumped = true;
+            }
+            offset = ((label_len & 0x3F) << 8) | packet[offset + 1];
+            jump_count++;
+            continue;
+        }
+
+        if (label_len > MAX_LABEL_LENGTH) {
+            return Error::InvalidLabel;
+        }
+        if (offset + 1 + label_len > packet_len) {
+            return Error::TruncatedMessage;
+        }
+        // 结束符也要放得下
+        if (pos + 1 + label_len + 1 > MAX_DOMAIN_LENGTH) {
+            return Error::BufferTooSmall;
+        }
+        std::memcpy(out + pos, packet + offset, 1 + label_len);
+        pos += 1 + label_len;
+        offset += 1 + label_len;
+    }
+
+    return Error::PointerLoop;
+}
+
 Error DNSParser::decodeName(
     const uint8_t* packet,
     size_t packet_len,
@@ -175,9 +331,11 @@ Error DNSParser::decodeName(
         }
         
         offset++;
-        for (uint8_t i = 0; i < label_len; i++) {
-            out_buf[buf_pos++] = std::tolower(packet[offset + i]);
+        if (offset + label_len > packet_len) {
+            return Error::TruncatedMessage;
         }
+        simd().lower_copy(out_buf + buf_pos, packet + offset, label_len);
+        buf_pos += label_len;
         offset += label_len;
     }
     
@@ -272,6 +430,27 @@ bool DNSParser::domainEndsWith(
 
 // ==================== DNS Response Builder ====================
 
+namespace {
+
+// 合成 SOA 记录所有者之后的部分, 编译期生成, 构建时只填 TTL 与 MINIMUM:
+//   IN SOA localhost. nobody.invalid. 1 3600 600 86400 <negative_ttl>
+constexpr uint8_t kSyntheticSoa[] = {
+    0x00, 0x06, 0x00, 0x01,                         // TYPE SOA, CLASS IN
+    0x00, 0x00, 0x00, 0x00,                         // TTL
+    0x00, 0x2F,                                     // RDLENGTH 47
+    9, 'l', 'o', 'c', 'a', 'l', 'h', 'o', 's', 't', 0,
+    6, 'n', 'o', 'b', 'o', 'd', 'y', 7, 'i', 'n', 'v', 'a', 'l', 'i', 'd', 0,
+    0x00, 0x00, 0x00, 0x01,                         // SERIAL
+    0x00, 0x00, 0x0E, 0x10,                         // REFRESH 3600
+    0x00, 0x00, 0x02, 0x58,                         // RETRY 600
+    0x00, 0x01, 0x51, 0x80,                         // EXPIRE 86400
+    0x00, 0x00, 0x00, 0x00,                         // MINIMUM
+};
+constexpr size_t kSoaTtlOffset = 4;
+constexpr size_t kSoaMinimumOffset = sizeof(kSyntheticSoa) - 4;
+
+} // anonymous namespace
+
 size_t DNSResponseBuilder::buildNXDomain(
     const uint8_t* query,
     size_t query_len,
@@ -283,8 +462,8 @@ size_t DNSResponseBuilder::buildNXDomain(
         return 0;
     }
 
-    // 复制查询
-    std::memcpy(response, query, parsed.total_consumed);
+    // 复制查询 (response 可与 query 为同一缓冲区, 即原地改写)
+    std::memmove(response, query, parsed.total_consumed);
 
     // 修改标志位: QR=1, AA=0, TC=0, RD=1, RA=1, RCODE=3(NXDOMAIN)
     DNSHeader* hdr = reinterpret_cast<DNSHeader*>(response);
@@ -300,9 +479,88 @@ size_t DNSResponseBuilder::buildNXDomain(
     hdr->ns_count = 0;
     hdr->ar_count = 0;
 
+    XDP_DNS_PROBE3(response__built, static_cast<uint8_t>(flags & 0x000F), 0, parsed.total_consumed);
     return parsed.total_consumed;
 }
 
+size_t DNSResponseBuilder::buildNXDomain(
+    const uint8_t* query,
+    size_t query_len,
+    const DNSParseResult& parsed,
+    uint32_t negative_ttl,
+    uint8_t* response,
+    size_t response_buf_size
+) {
+    return buildNegative(query, parsed, dns_rcode::NXDOMAIN, negative_ttl,
+                         response, response_buf_size);
+}
+
+size_t DNSResponseBuilder::buildNoData(
+    const uint8_t* query,
+    size_t query_len,
+    const DNSParseResult& parsed,
+    uint32_t negative_ttl,
+    uint8_t* response,
+    size_t response_buf_size
+) {
+    return buildNegative(query, parsed, dns_rcode::NOERROR, negative_ttl,
+                         response, response_buf_size);
+}
+
+size_t DNSResponseBuilder::buildNegative(
+    const uint8_t* query,
+    const DNSParseResult& parsed,
+    uint8_t rcode,
+    uint32_t negative_ttl,
+    uint8_t* response,
+    size_t response_buf_size
+) {
+    // SOA 所有者: QNAME 的父域 (指向问题中第二个标签的指针); 单标签名或
+    // 问题名以指针开头时为根
+    size_t qname = parsed.question.name_offset;
+    uint8_t first = query[qname];
+    size_t parent = qname + 1 + first;
+    bool has_parent = first != 0 && first <= MAX_LABEL_LENGTH && query[parent] != 0;
+    size_t owner_len = has_parent ? 2 : 1;
+
+    size_t total_size = parsed.total_consumed + owner_len + sizeof(kSyntheticSoa);
+    if (response_buf_size < total_size) {
+        return 0;
+    }
+
+    // 复制查询 (response 可与 query 为同一缓冲区, 即原地改写)
+    std::memmove(response, query, parsed.total_consumed);
+
+    // 标志位: QR=1, AA=0, TC=0, RD 不变, RA=1
+    DNSHeader* hdr = reinterpret_cast<DNSHeader*>(response);
+    uint16_t flags = parsed.header->getFlags();
+    flags |= 0x8000;  // QR = 1
+    flags |= 0x0080;  // RA = 1
+    flags &= 0xFFF0;
+    flags |= rcode;
+    hdr->flags = htons(flags);
+
+    hdr->an_count = 0;
+    hdr->ns_count = htons(1);
+    hdr->ar_count = 0;
+
+    // 权威区: 所有者 + 预生成的 SOA
+    size_t offset = parsed.total_consumed;
+    if (has_parent) {
+        response[offset++] = static_cast<uint8_t>(0xC0 | (parent >> 8));
+        response[offset++] = static_cast<uint8_t>(parent);
+    } else {
+        response[offset++] = 0;
+    }
+    std::memcpy(response + offset, kSyntheticSoa, sizeof(kSyntheticSoa));
+    writeU32(response + offset + kSoaTtlOffset, negative_ttl);
+    writeU32(response + offset + kSoaMinimumOffset, negative_ttl);
+    offset += sizeof(kSyntheticSoa);
+
+    XDP_DNS_PROBE3(response__built, rcode, 0, offset);
+    return offset;
+}
+
 size_t DNSResponseBuilder::buildAResponse(
     const uint8_t* query,
     size_t query_len,
@@ -320,8 +578,8 @@ size_t DNSResponseBuilder::buildAResponse(
         return 0;
     }
 
-    // 复制查询
-    std::memcpy(response, query, parsed.total_consumed);
+    // 复制查询 (response 可与 query 为同一缓冲区, 即原地改写)
+    std::memmove(response, query, parsed.total_consumed);
 
     // 修改标志位
     DNSHeader* hdr = reinterpret_cast<DNSHeader*>(response);
@@ -332,6 +590,8 @@ size_t DNSResponseBuilder::buildAResponse(
     flags &= 0xFFF0;  // RCODE = 0
     hdr->flags = htons(flags);
     hdr->an_count = htons(1);
+    hdr->ns_count = 0;
+    hdr->ar_count = 0;  // 只复制到问题末尾, 丢弃查询中的 OPT
 
     // 写入回答记录
     size_t offset = parsed.total_consumed;
@@ -341,25 +601,26 @@ size_t DNSResponseBuilder::buildAResponse(
     response[offset++] = DNS_HEADER_SIZE;
 
     // 类型 A
-    *reinterpret_cast<uint16_t*>(response + offset) = htons(dns_type::A);
+    writeU16(response + offset, dns_type::A);
     offset += 2;
 
     // 类别 IN
-    *reinterpret_cast<uint16_t*>(response + offset) = htons(dns_class::IN);
+    writeU16(response + offset, dns_class::IN);
     offset += 2;
 
     // TTL
-    *reinterpret_cast<uint32_t*>(response + offset) = htonl(ttl);
+    writeU32(response + offset, ttl);
     offset += 4;
 
     // RDLENGTH
-    *reinterpret_cast<uint16_t*>(response + offset) = htons(4);
+    writeU16(response + offset, 4);
     offset += 2;
 
     // IP 地址
-    *reinterpret_cast<uint32_t*>(response + offset) = ip;
+    std::memcpy(response + offset, &ip, 4);
     offset += 4;
 
+    XDP_DNS_PROBE3(response__built, dns_rcode::NOERROR, 1, offset);
     return offset;
 }
 
@@ -380,8 +641,8 @@ size_t DNSResponseBuilder::buildAAAAResponse(
         return 0;
     }
 
-    // 复制查询
-    std::memcpy(response, query, parsed.total_consumed);
+    // 复制查询 (response 可与 query 为同一缓冲区, 即原地改写)
+    std::memmove(response, query, parsed.total_consumed);
 
     // 修改标志位
     DNSHeader* hdr = reinterpret_cast<DNSHeader*>(response);
@@ -392,6 +653,8 @@ size_t DNSResponseBuilder::buildAAAAResponse(
     flags &= 0xFFF0;  // RCODE = 0
     hdr->flags = htons(flags);
     hdr->an_count = htons(1);
+    hdr->ns_count = 0;
+    hdr->ar_count = 0;  // 只复制到问题末尾, 丢弃查询中的 OPT
 
     // 写入回答记录
     size_t offset = parsed.total_consumed;
@@ -401,25 +664,26 @@ size_t DNSResponseBuilder::buildAAAAResponse(
     response[offset++] = DNS_HEADER_SIZE;
 
     // 类型 AAAA (28)
-    *reinterpret_cast<uint16_t*>(response + offset) = htons(dns_type::AAAA);
+    writeU16(response + offset, dns_type::AAAA);
     offset += 2;
 
     // 类别 IN
-    *reinterpret_cast<uint16_t*>(response + offset) = htons(dns_class::IN);
+    writeU16(response + offset, dns_class::IN);
     offset += 2;
 
     // TTL
-    *reinterpret_cast<uint32_t*>(response + offset) = htonl(ttl);
+    writeU32(response + offset, ttl);
     offset += 4;
 
     // RDLENGTH (16 for IPv6)
-    *reinterpret_cast<uint16_t*>(response + offset) = htons(16);
+    writeU16(response + offset, 16);
     offset += 2;
 
     // IPv6 地址 (16 字节)
     std::memcpy(response + offset, ipv6, 16);
     offset += 16;
 
+    XDP_DNS_PROBE3(response__built, dns_rcode::NOERROR, 1, offset);
     return offset;
 }
 
@@ -434,7 +698,8 @@ size_t DNSResponseBuilder::buildRefused(
         return 0;
     }
 
-    std::memcpy(response, query, parsed.total_consumed);
+    // response 可与 query 为同一缓冲区 (原地改写)
+    std::memmove(response, query, parsed.total_consumed);
 
     DNSHeader* hdr = reinterpret_cast<DNSHeader*>(response);
     uint16_t flags = parsed.header->getFlags();
@@ -448,8 +713,200 @@ size_t DNSResponseBuilder::buildRefused(
     hdr->ns_count = 0;
     hdr->ar_count = 0;
 
+    XDP_DNS_PROBE3(response__built, static_cast<uint8_t>(flags & 0x000F), 0, parsed.total_consumed);
     return parsed.total_consumed;
 }
 
-} // namespace xdp_dns
+size_t DNSResponseBuilder::buildServFail(
+    const uint8_t* query,
+    size_t query_len,
+    const DNSParseResult& parsed,
+    uint8_t* response,
+    size_t response_buf_size
+) {
+    if (response_buf_size < parsed.total_consumed) {
+        return 0;
+    }
+
+    std::memmove(response, query, parsed.total_consumed);
+
+    DNSHeader* hdr = reinterpret_cast<DNSHeader*>(response);
+    uint16_t flags = parsed.header->getFlags();
+    flags |= 0x8000;  // QR = 1
+    flags |= 0x0080;  // RA = 1
+    flags &= 0xFFF0;
+    flags |= 0x0002;  // RCODE = 2 (SERVFAIL)
+    hdr->flags = htons(flags);
+
+    hdr->an_count = 0;
+    hdr->ns_count = 0;
+    hdr->ar_count = 0;
+
+    XDP_DNS_PROBE3(response__built, dns_rcode::SERVFAIL, 0, parsed.total_consumed);
+    return parsed.total_consumed;
+}
+
+namespace {
+
+using BlockBuilder = size_t (*)(const uint8_t* query, size_t query_len,
+                                const DNSParseResult& parsed, uint32_t rule_ttl,
+                                uint32_t negative_ttl, uint8_t* response,
+                                size_t response_buf_size);
+
+constexpr uint8_t kNullAddress6[16] = {};
+
+// 下标为 BlockMode 的值
+constexpr BlockBuilder kBlockBuilders[kBlockModeCount] = {
+    // NXDomain
+    [](const uint8_t* q, size_t len, const DNSParseResult& p, uint32_t, uint32_t neg,
+       uint8_t* out, size_t size) {
+        return DNSResponseBuilder::buildNXDomain(q, len, p, neg, out, size);
+    },
+    // NoData
+    [](const uint8_t* q, size_t len, const DNSParseResult& p, uint32_t, uint32_t neg,
+       uint8_t* out, size_t size) {
+        return DNSResponseBuilder::buildNoData(q, len, p, neg, out, size);
+    },
+    // Refused
+    [](const uint8_t* q, size_t len, const DNSParseResult& p, uint32_t, uint32_t,
+       uint8_t* out, size_t size) {
+        return DNSResponseBuilder::buildRefused(q, len, p, out, size);
+    },
+    // NullAddress: 没有对应地址族的类型回答 NODATA
+    [](const uint8_t* q, size_t len, const DNSParseResult& p, uint32_t ttl, uint32_t neg,
+       uint8_t* out, size_t size) {
+        switch (p.question.qtype) {
+            case dns_type::A:
+                return DNSResponseBuilder::buildAResponse(q, len, p, 0, ttl, out, size);
+            case dns_type::AAAA:
+                return DNSResponseBuilder::buildAAAAResponse(q, len, p, kNullAddress6, ttl,
+                                                             out, size);
+            default:
+                return DNSResponseBuilder::buildNoData(q, len, p, neg, out, size);
+        }
+    },
+    // Drop
+    [](const uint8_t*, size_t, const DNSParseResult&, uint32_t, uint32_t, uint8_t*, size_t) {
+        return size_t(0);
+    },
+};
+
+} // anonymous namespace
+
+size_t DNSResponseBuilder::buildBlocked(
+    const uint8_t* query,
+    size_t query_len,
+    const DNSParseResult& parsed,
+    BlockMode mode,
+    uint32_t rule_ttl,
+    uint32_t negative_ttl,
+    uint8_t* response,
+    size_t response_buf_size
+) {
+    size_t index = static_cast<size_t>(mode);
+    if (index >= kBlockModeCount) return 0;
+    return kBlockBuilders[index](query, query_len, parsed, rule_ttl, negative_ttl,
+                                 response, response_buf_size);
+}
 
+size_t DNSResponseBuilder::buildHInfo(
+    const uint8_t* query,
+    size_t query_len,
+    const DNSParseResult& parsed,
+    uint32_t ttl,
+    uint8_t* response,
+    size_t response_buf_size
+) {
+    // RDATA: CPU = "RFC8482", OS = "" (RFC 8482 4.2)
+    static constexpr uint8_t kRData[] = {7, 'R', 'F', 'C', '8', '4', '8', '2', 0};
+
+    // 域名指针2 + 类型2 + 类别2 + TTL4 + 长度2 + RDATA
+    size_t answer_size = 12 + sizeof(kRData);
+    size_t total_size = parsed.total_consumed + answer_size;
+
+    if (response_buf_size < total_size) {
+        return 0;
+    }
+
+    std::memmove(response, query, parsed.total_consumed);
+
+    DNSHeader* hdr = reinterpret_cast<DNSHeader*>(response);
+    uint16_t flags = parsed.header->getFlags();
+    flags |= 0x8000;  // QR = 1
+    flags |= 0x0080;  // RA = 1
+    flags &= 0xFFF0;  // RCODE = 0
+    hdr->flags = htons(flags);
+    hdr->an_count = htons(1);
+    hdr->ns_count = 0;
+    hdr->ar_count = 0;  // 只复制到问题末尾, 丢弃查询中的 OPT
+
+    size_t offset = parsed.total_consumed;
+    response[offset++] = 0xC0;
+    response[offset++] = DNS_HEADER_SIZE;
+    writeU16(response + offset, dns_type::HINFO);
+    offset += 2;
+    writeU16(response + offset, dns_class::IN);
+    offset += 2;
+    writeU32(response + offset, ttl);
+    offset += 4;
+    writeU16(response + offset, sizeof(kRData));
+    offset += 2;
+    std::memcpy(response + offset, kRData, sizeof(kRData));
+    offset += sizeof(kRData);
+
+    XDP_DNS_PROBE3(response__built, dns_rcode::NOERROR, 1, offset);
+    return offset;
+}
+
+size_t DNSResponseBuilder::buildTruncated(
+    const uint8_t* query,
+    size_t query_len,
+    const DNSParseResult& parsed,
+    uint8_t* response,
+    size_t response_buf_size
+) {
+    if (response_buf_size < parsed.total_consumed) {
+        return 0;
+    }
+
+    std::memmove(response, query, parsed.total_consumed);
+
+    DNSHeader* hdr = reinterpret_cast<DNSHeader*>(response);
+    uint16_t flags = parsed.header->getFlags();
+    flags |= 0x8000;  // QR = 1
+    flags |= 0x0200;  // TC = 1
+    flags |= 0x0080;  // RA = 1
+    flags &= 0xFFF0;  // RCODE = 0
+    hdr->flags = htons(flags);
+
+    hdr->an_count = 0;
+    hdr->ns_count = 0;
+    hdr->ar_count = 0;
+
+    XDP_DNS_PROBE3(response__built, dns_rcode::NOERROR, 0, parsed.total_consumed);
+    return parsed.total_consumed;
+}
+
+size_t DNSResponseBuilder::buildAnyResponse(
+    const uint8_t* query,
+    size_t query_len,
+    const DNSParseResult& parsed,
+    const RuleSetPolicy& policy,
+    uint8_t* response,
+    size_t response_buf_size
+) {
+    if (parsed.question.qtype != dns_type::ANY) {
+        return 0;
+    }
+    switch (policy.any_policy) {
+        case AnyPolicy::Hinfo:
+            return buildHInfo(query, query_len, parsed, policy.any_ttl,
+                              response, response_buf_size);
+        case AnyPolicy::Truncate:
+            return buildTruncated(query, query_len, parsed, response, response_buf_size);
+        default:
+            return 0;
+    }
+}
+
+} // namespace xdp_dns
@@ -1,13 +1,131 @@
 #include "xdp_dns/domain_trie.hpp"
+#include "xdp_dns/numa.hpp"
+#include "xdp_dns/probes.hpp"
 #include <algorithm>
 #include <sstream>
 
 namespace xdp_dns {
 
+namespace {
+
+// 原地转小写 (SIMD 内核)
+inline void toLower(std::string* s) {
+    simd().lower_copy(&(*s)[0], reinterpret_cast<const uint8_t*>(s->data()), s->size());
+}
+
+} // anonymous namespace
+
+// ==================== TrieGeneration ====================
+
+TrieGeneration::TrieGeneration(const ArenaOptions& arena)
+    : memory(arena), root(nullptr), rules(memory.resource(MemCategory::Rules)) {
+    root = newNode();
+}
+
+TrieGeneration::~TrieGeneration() {
+    // Arena 模式下内存随 memory 一起整体释放
+    if (memory.usesArenas()) {
+        return;
+    }
+
+    destroyTree(root);
+    for (Rule* r : rules) {
+        r->~Rule();
+        memory.resource(MemCategory::Rules)->deallocate(r, sizeof(Rule), alignof(Rule));
+    }
+}
+
+TrieNode* TrieGeneration::newNode() {
+    void* p = memory.resource(MemCategory::Nodes)->allocate(sizeof(TrieNode), alignof(TrieNode));
+    return new (p) TrieNode(memory.resource(MemCategory::Index));
+}
+
+Rule* TrieGeneration::newRule(const Rule& rule) {
+    void* p = memory.resource(MemCategory::Rules)->allocate(sizeof(Rule), alignof(Rule));
+    return new (p) Rule(rule);
+}
+
+void TrieGeneration::insert(
+    const std::vector<std::string>& labels,
+    bool is_wildcard,
+    const Rule* rule
+) {
+    TrieNode* node = root;
+    for (const auto& label : labels) {
+        auto it = node->children.find(label);
+        if (it == node->children.end()) {
+            // 标签只在新建边时复制一次, 节点销毁时随边一起释放
+            char* bytes = static_cast<char*>(
+                memory.resource(MemCategory::Labels)->allocate(label.size(), 1));
+            std::memcpy(bytes, label.data(), label.size());
+            it = node->children.emplace(std::string_view(bytes, label.size()), newNode()).first;
+        }
+        node = it->second;
+    }
+    
+    if (is_wildcard) {
+        node->wildcard_rule = rule;
+    } else {
+        node->exact_rule = rule;
+    }
+}
+
+void TrieGeneration::destroyTree(TrieNode* node) {
+    for (auto& child : node->children) {
+        destroyTree(child.second);
+        memory.resource(MemCategory::Labels)->deallocate(
+            const_cast<char*>(child.first.data()), child.first.size(), 1);
+    }
+    node->~TrieNode();
+    memory.resource(MemCategory::Nodes)->deallocate(node, sizeof(TrieNode), alignof(TrieNode));
+}
+
 // ==================== DomainTrie ====================
 
-DomainTrie::DomainTrie() 
-    : root_(std::make_unique<TrieNode>()), rule_count_(0) {}
+DomainTrie::DomainTrie(const ArenaOptions& arena)
+    : arena_(arena),
+      nodes_(arena.numa_replicas && numaNodeCount() > 1 ? numaOnlineNodes() : std::vector<int>()),
+      replicas_(nodes_.empty() ? 1 : nodes_.size()),
+      gens_(makeGenerations()) {}
+
+DomainTrie::~DomainTrie() = default;
+
+DomainTrie::Generations DomainTrie::makeGenerations() const {
+    Generations gens;
+    gens.reserve(replicas_);
+    for (size_t i = 0; i < replicas_; i++) {
+        ArenaOptions opts = arena_;
+        if (replicas_ > 1) {
+            opts.numa_node = nodes_[i];
+        }
+        gens.push_back(std::make_unique<TrieGeneration>(opts));
+    }
+    return gens;
+}
+
+const TrieGeneration& DomainTrie::local() const {
+    if (replicas_ == 1) return *gens_[0];
+
+    // 节点号可能不连续, 按节点号查找副本; 未知节点读第一个副本
+    int node = numaLocalNode();
+    for (size_t i = 0; i < replicas_; i++) {
+        if (nodes_[i] == node) return *gens_[i];
+    }
+    return *gens_[0];
+}
+
+void DomainTrie::retire(Generations* next) {
+    gens_.swap(*next);
+    for (auto& gen : *next) {
+        // 内存仍计入统计, 规则数不再计入
+        gen->memory.addRules(-static_cast<int64_t>(gen->rule_count));
+        retired_.push_back(std::move(gen));
+    }
+}
+
+size_t DomainTrie::replicaCount() const {
+    return replicas_;
+}
 
 void DomainTrie::insert(const char* domain, size_t domain_len, const Rule* rule) {
     if (!domain || domain_len == 0 || !rule) return;
@@ -24,11 +142,14 @@ void DomainTrie::insert(const char* domain, size_t domain_len, const Rule* rule)
     }
     
     // 转小写
-    std::transform(dom.begin(), dom.end(), dom.begin(), ::tolower);
+    toLower(&dom);
     
     auto labels = splitAndReverse(dom.c_str(), dom.size());
-    insertImpl(root_.get(), labels, is_wildcard, rule);
-    rule_count_++;
+    for (auto& gen : gens_) {
+        gen->insert(labels, is_wildcard, rule);
+        gen->rule_count++;
+        gen->memory.addRules(1);
+    }
 }
 
 void DomainTrie::insert(const std::string& domain, const Rule* rule) {
@@ -41,10 +162,14 @@ const Rule* DomainTrie::match(const char* domain, size_t domain_len) const {
     std::shared_lock lock(mutex_);
     
     std::string dom(domain, domain_len);
-    std::transform(dom.begin(), dom.end(), dom.begin(), ::tolower);
+    toLower(&dom);
     
     auto labels = splitAndReverse(dom.c_str(), dom.size());
-    return matchImpl(root_.get(), labels);
+    const Rule* rule = matchImpl(local().root, labels);
+    XDP_DNS_PROBE4(match, domain, domain_len,
+                   rule ? rule->id : 0,
+                   rule ? static_cast<int>(rule->action) : -1);
+    return rule;
 }
 
 const Rule* DomainTrie::match(const std::string& domain) const {
@@ -63,33 +188,32 @@ bool DomainTrie::remove(const char* domain, size_t domain_len) {
         dom = dom.substr(2);
     }
     
-    std::transform(dom.begin(), dom.end(), dom.begin(), ::tolower);
+    toLower(&dom);
     auto labels = splitAndReverse(dom.c_str(), dom.size());
     
-    TrieNode* node = root_.get();
-    for (const auto& label : labels) {
-        auto it = node->children.find(label);
-        if (it == node->children.end()) {
-            return false;
-        }
-        node = it->second.get();
-    }
-    
-    if (is_wildcard) {
-        if (node->wildcard_rule) {
-            node->wildcard_rule = nullptr;
-            rule_count_--;
-            return true;
+    // 副本结构一致, 各副本的结果相同
+    bool removed = false;
+    for (auto& gen : gens_) {
+        TrieNode* node = gen->root;
+        for (const auto& label : labels) {
+            auto it = node->children.find(label);
+            if (it == node->children.end()) {
+                return false;
+            }
+            node = it->second;
         }
-    } else {
-        if (node->exact_rule) {
-            node->exact_rule = nullptr;
-            rule_count_--;
-            return true;
+
+        const Rule*& slot = is_wildcard ? node->wildcard_rule : node->exact_rule;
+        if (!slot) {
+            return false;
         }
+        slot = nullptr;
+        gen->rule_count--;
+        gen->memory.addRules(-1);
+        removed = true;
     }
-    
-    return false;
+
+    return removed;
 }
 
 bool DomainTrie::remove(const std::string& domain) {
@@ -97,15 +221,76 @@ bool DomainTrie::remove(const std::string& domain) {
 }
 
 void DomainTrie::clear() {
-    std::unique_lock lock(mutex_);
-    root_ = std::make_unique<TrieNode>();
-    rule_count_ = 0;
-    rules_storage_.clear();
+    Generations fresh = makeGenerations();
+    {
+        std::unique_lock lock(mutex_);
+        retire(&fresh);
+    }
 }
 
 size_t DomainTrie::size() const {
     std::shared_lock lock(mutex_);
-    return rule_count_;
+    return gens_[0]->rule_count;
+}
+
+void DomainTrie::updateRules(const std::vector<std::pair<std::string, Rule>>& rules) {
+    XDP_DNS_PROBE1(reload__start, rules.size());
+
+    // 标签只切分一次, 再分别插入各副本
+    struct Entry {
+        std::vector<std::string> labels;
+        bool is_wildcard;
+        const Rule* rule;
+    };
+    std::vector<Entry> entries;
+    entries.reserve(rules.size());
+
+    for (const auto& entry : rules) {
+        const std::string& domain = entry.first;
+        if (domain.empty()) continue;
+
+        std::string dom = domain;
+        bool is_wildcard = false;
+        if (dom.size() > 2 && dom[0] == '*' && dom[1] == '.') {
+            is_wildcard = true;
+            dom = dom.substr(2);
+        }
+        toLower(&dom);
+
+        entries.push_back({splitAndReverse(dom.c_str(), dom.size()), is_wildcard, &entry.second});
+    }
+
+    // 在锁外构建新一代; 每个副本持有自己的规则拷贝, 命中后读取的也是本节点内存
+    Generations next = makeGenerations();
+    for (auto& gen : next) {
+        gen->rules.reserve(entries.size());
+        for (const Entry& e : entries) {
+            gen->rules.push_back(gen->newRule(*e.rule));
+            gen->insert(e.labels, e.is_wildcard, gen->rules.back());
+            gen->rule_count++;
+        }
+        gen->memory.addRules(static_cast<int64_t>(gen->rule_count));
+    }
+    [[maybe_unused]] size_t new_count = next[0]->rule_count;
+
+    // 仅在交换时持有写锁, 所有副本一起发布
+    {
+        std::unique_lock lock(mutex_);
+        retire(&next);
+    }
+
+    XDP_DNS_PROBE1(reload__end, new_count);
+}
+
+MemoryUsage DomainTrie::memoryUsage() const {
+    std::shared_lock lock(mutex_);
+    MemoryUsage usage;
+    for (const auto& gen : gens_) {
+        usage += gen->memory.usage();
+    }
+    // 规则数按一份计, bytesPerRule 反映全部副本的总开销
+    usage.rule_count = gens_[0]->rule_count;
+    return usage;
 }
 
 std::vector<std::string> DomainTrie::splitAndReverse(const char* domain, size_t len) {
@@ -148,39 +333,18 @@ const Rule* DomainTrie::matchImpl(
         if (it == node->children.end()) {
             return matched_wildcard;
         }
-        node = it->second.get();
+        node = it->second;
     }
     
-    // 检查最终节点
+    // 检查最终节点; 只匹配子域名的通配符规则不命中 name 本身
     if (node->exact_rule) {
         return node->exact_rule;
     }
-    if (node->wildcard_rule) {
+    if (node->wildcard_rule && !node->wildcard_rule->subdomains_only) {
         return node->wildcard_rule;
     }
     
     return matched_wildcard;
 }
 
-void DomainTrie::insertImpl(
-    TrieNode* node,
-    const std::vector<std::string>& labels,
-    bool is_wildcard,
-    const Rule* rule
-) {
-    for (const auto& label : labels) {
-        auto& child = node->children[label];
-        if (!child) {
-            child = std::make_unique<TrieNode>();
-        }
-        node = child.get();
-    }
-    
-    if (is_wildcard) {
-        node->wildcard_rule = rule;
-    } else {
-        node->exact_rule = rule;
-    }
-}
-
 } // namespace xdp_dns
@@ -0,0 +1,129 @@
+#include "xdp_dns/engine_slot.hpp"
+#include "xdp_dns/local_zone.hpp"
+#include "xdp_dns/stats.hpp"
+#include <mutex>
+
+namespace xdp_dns {
+
+namespace {
+
+std::atomic<uint64_t> g_generation{0};
+
+} // anonymous namespace
+
+EngineSlot::EngineSlot(const ArenaOptions& arena)
+    : arena_(arena), impl_(std::make_unique<FilterEngine>(arena)) {}
+
+EngineSlot::~EngineSlot() = default;
+
+void EngineSlot::replace(const RuleEntries& entries, const RuleSetPolicy& policy,
+                         std::shared_ptr<const LocalZones> zones,
+                         std::shared_ptr<const AnswerTable> answers) {
+    auto next = std::make_unique<FilterEngine>(arena_);
+    next->updateRules(entries);
+    next->setPolicy(policy);
+    if (zones && !zones->empty()) next->setLocalZones(std::move(zones));
+    if (answers && !answers->empty()) next->setAnswers(std::move(answers));
+    install(&next, false);
+    // next 持有旧引擎, 在锁外析构
+}
+
+void EngineSlot::replaceRules(const RuleEntries& entries) {
+    auto next = std::make_unique<FilterEngine>(arena_);
+    next->updateRules(entries);
+    install(&next, true);
+}
+
+void EngineSlot::install(std::unique_ptr<FilterEngine>* next, bool inherit_rule_set) {
+    uint64_t generation = g_generation.fetch_add(1, std::memory_order_relaxed) + 1;
+    std::unique_lock<std::shared_mutex> lock(mutex_);
+    if (inherit_rule_set) {
+        (*next)->setPolicy(impl_->policy());
+        (*next)->setLocalZones(impl_->sharedLocalZones());
+    }
+    retired_ += impl_->getStats();
+    impl_.swap(*next);
+    generation_ = generation;
+    publishRuleInfoLocked();
+}
+
+void EngineSlot::addRules(const RuleEntries& entries) {
+    std::shared_lock<std::shared_mutex> lock(mutex_);
+    for (const auto& [domain, rule] : entries) {
+        impl_->addRule(rule, domain.data(), domain.size());
+    }
+    publishRuleInfoLocked();
+}
+
+size_t EngineSlot::removeDomains(const std::vector<std::string>& domains) {
+    std::shared_lock<std::shared_mutex> lock(mutex_);
+    size_t removed = 0;
+    for (const auto& domain : domains) {
+        if (impl_->removeDomain(domain.data(), domain.size())) removed++;
+    }
+    if (removed > 0) publishRuleInfoLocked();
+    return removed;
+}
+
+FilterEngine::Stats EngineSlot::stats() const {
+    std::shared_lock<std::shared_mutex> lock(mutex_);
+    FilterEngine::Stats total = retired_;
+    total += impl_->getStats();
+    return total;
+}
+
+void EngineSlot::resetStats() {
+    std::unique_lock<std::shared_mutex> lock(mutex_);
+    retired_ = {};
+    impl_->resetStats();
+}
+
+size_t EngineSlot::ruleCount() const {
+    std::shared_lock<std::shared_mutex> lock(mutex_);
+    return impl_->ruleCount();
+}
+
+RuleSetPolicy EngineSlot::policy() const {
+    std::shared_lock<std::shared_mutex> lock(mutex_);
+    return impl_->policy();
+}
+
+std::shared_ptr<const LocalZones> EngineSlot::localZones() const {
+    std::shared_lock<std::shared_mutex> lock(mutex_);
+    return impl_->sharedLocalZones();
+}
+
+MemoryUsage EngineSlot::memoryUsage() const {
+    std::shared_lock<std::shared_mutex> lock(mutex_);
+    return impl_->memoryUsage();
+}
+
+void EngineSlot::swap(EngineSlot& other) {
+    if (this == &other) return;
+
+    std::scoped_lock lock(mutex_, other.mutex_);
+    impl_.swap(other.impl_);
+    std::swap(retired_, other.retired_);
+    std::swap(arena_, other.arena_);
+    std::swap(generation_, other.generation_);
+    publishRuleInfoLocked();
+    other.publishRuleInfoLocked();
+}
+
+uint64_t EngineSlot::generation() const {
+    std::shared_lock<std::shared_mutex> lock(mutex_);
+    return generation_;
+}
+
+void EngineSlot::setPublishRuleInfo(bool enabled) {
+    std::shared_lock<std::shared_mutex> lock(mutex_);
+    publish_rule_info_.store(enabled, std::memory_order_relaxed);
+    publishRuleInfoLocked();
+}
+
+void EngineSlot::publishRuleInfoLocked() const {
+    if (!publish_rule_info_.load(std::memory_order_relaxed)) return;
+    StatsRegistry::instance().setRuleInfo(generation_, impl_->ruleCount());
+}
+
+} // namespace xdp_dns
@@ -1,10 +1,22 @@
 #include "xdp_dns/domain_trie.hpp"
+#include "xdp_dns/probes.hpp"
+#include "xdp_dns/rule_loader.hpp"
 
 namespace xdp_dns {
 
 // ==================== FilterEngine ====================
 
-FilterEngine::FilterEngine() = default;
+FilterEngine::FilterEngine(const ArenaOptions& arena)
+    : trie_(arena), memory_(arena), rules_storage_(memory_.resource(MemCategory::Rules)) {}
+
+FilterEngine::~FilterEngine() {
+    if (memory_.usesArenas()) return;
+
+    for (Rule* r : rules_storage_) {
+        r->~Rule();
+        memory_.resource(MemCategory::Rules)->deallocate(r, sizeof(Rule), alignof(Rule));
+    }
+}
 
 FilterResult FilterEngine::check(
     const char* domain,
@@ -17,6 +29,8 @@ FilterResult FilterEngine::check(
     
     if (!rule) {
         allowed_.fetch_add(1, std::memory_order_relaxed);
+        XDP_DNS_PROBE4(filter__check, domain, domain_len, 0,
+                       static_cast<int>(Action::Allow));
         return FilterResult(Action::Allow);
     }
     
@@ -36,6 +50,8 @@ FilterResult FilterEngine::check(
             break;
     }
     
+    XDP_DNS_PROBE4(filter__check, domain, domain_len, rule->id,
+                   static_cast<int>(rule->action));
     return FilterResult(rule->action, rule);
 }
 
@@ -44,19 +60,60 @@ void FilterEngine::addRule(
     const char* domain,
     size_t domain_len
 ) {
-    // 创建规则副本并存储
-    auto rule_copy = std::make_unique<Rule>(rule);
-    const Rule* rule_ptr = rule_copy.get();
-
+    // 创建规则副本并存储; Rules 资源 (Arena) 不是线程安全的, 分配也在锁内
+    Rule* rule_ptr;
     {
         std::lock_guard<std::mutex> lock(rules_mutex_);
-        rules_storage_.push_back(std::move(rule_copy));
+        void* p = memory_.resource(MemCategory::Rules)->allocate(sizeof(Rule), alignof(Rule));
+        rule_ptr = new (p) Rule(rule);
+        rule_ptr->answer = 0;
+        rules_storage_.push_back(rule_ptr);
     }
 
     // 插入到 Trie
     trie_.insert(domain, domain_len, rule_ptr);
 }
 
+Error FilterEngine::loadRules(const char* yaml_content, size_t len) {
+    RuleEntries entries;
+    RuleSetPolicy policy;
+    auto zones = std::make_shared<LocalZones>();
+    auto answers = std::make_shared<AnswerTable>();
+    Error err = parseRuleYaml(yaml_content, len, &entries, &policy, zones.get(), answers.get());
+    if (err != Error::Success) {
+        return err;
+    }
+
+    updateRules(entries);
+    setPolicy(policy);
+    setLocalZones(zones->empty() ? nullptr : std::move(zones));
+    setAnswers(answers->empty() ? nullptr : std::move(answers));
+    return Error::Success;
+}
+
+const RedirectAnswer* FilterEngine::redirectAnswer(const Rule& rule) const {
+    return answers_ ? answers_->get(rule.answer) : nullptr;
+}
+
+void FilterEngine::updateRules(const std::vector<std::pair<std::string, Rule>>& rules) {
+    // 新一代 Trie 自带规则拷贝. 并发 check 返回的规则指针可能来自旧代或
+    // addRule 存储的规则, 两者都保留到引擎析构; 反复重载应改用 EngineSlot::replace
+    trie_.updateRules(rules);
+}
+
+bool FilterEngine::removeDomain(const char* domain, size_t domain_len) {
+    return trie_.remove(domain, domain_len);
+}
+
+FilterEngine::Stats& FilterEngine::Stats::operator+=(const Stats& other) {
+    total_checks += other.total_checks;
+    allowed += other.allowed;
+    blocked += other.blocked;
+    redirected += other.redirected;
+    logged += other.logged;
+    return *this;
+}
+
 FilterEngine::Stats FilterEngine::getStats() const {
     return Stats{
         total_checks_.load(std::memory_order_relaxed),
@@ -67,6 +124,12 @@ FilterEngine::Stats FilterEngine::getStats() const {
     };
 }
 
+MemoryUsage FilterEngine::memoryUsage() const {
+    MemoryUsage usage = trie_.memoryUsage();
+    usage += memory_.usage();
+    return usage;
+}
+
 void FilterEngine::resetStats() {
     total_checks_.store(0, std::memory_order_relaxed);
     allowed_.store(0, std::memory_order_relaxed);
@@ -0,0 +1,717 @@
+#include "xdp_dns/forwarder.hpp"
+#include "xdp_dns/dns_parser.hpp"
+#include "xdp_dns/simd.hpp"
+#include "xdp_dns/stats.hpp"
+#include <arpa/inet.h>
+#include <fcntl.h>
+#include <netinet/in.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#include <cstring>
+#include <random>
+
+namespace xdp_dns {
+
+namespace {
+
+constexpr uint32_t STATE_FREE = 0;
+constexpr uint32_t STATE_PENDING = 1;
+constexpr uint32_t STATE_DONE = 2;
+constexpr uint32_t STATE_WAITING = 3;   // 挂在领头表项上
+
+constexpr uint32_t kNoEntry = 0xFFFFFFFF;
+constexpr size_t kIdSpace = 65536;
+constexpr int kIdAttempts = 16;
+
+uint64_t splitmix64(uint64_t x) {
+    x += 0x9E3779B97F4A7C15ULL;
+    x = (x ^ (x >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    x = (x ^ (x >> 27)) * 0x94D049BB133111EBULL;
+    return x ^ (x >> 31);
+}
+
+// 查询问题部分的结束偏移 (不接受压缩指针), 无效返回 0
+size_t questionEnd(const uint8_t* query, size_t len) {
+    size_t off = DNS_HEADER_SIZE;
+    while (off < len) {
+        uint8_t label = query[off];
+        if (label == 0) {
+            if (off + 1 - DNS_HEADER_SIZE > MAX_DOMAIN_LENGTH) return 0;
+            off += 1 + 4;
+            return off <= len ? off : 0;
+        }
+        if (label > MAX_LABEL_LENGTH) return 0;
+        off += 1 + label;
+    }
+    return 0;
+}
+
+// 紧跟问题之后的 OPT 记录 (同 DNSParser::queryEdns), 同时取客户端 UDP 负载上限
+uint8_t queryEdns(const uint8_t* query, size_t len, size_t qend, uint16_t* udp_size) {
+    *udp_size = 512;
+    if (readU16(query + 10) != 1 || qend + 11 > len || query[qend] != 0 ||
+        readU16(query + qend + 1) != dns_type::OPT) {
+        return 0;
+    }
+    uint16_t size = readU16(query + qend + 3);
+    if (size > 512) *udp_size = size;
+    uint8_t flags = EDNS_PRESENT;
+    if (readU16(query + qend + 7) & 0x8000) flags |= EDNS_DO;
+    return flags;
+}
+
+bool equalNoCase(const uint8_t* a, const uint8_t* b, size_t n) {
+    for (size_t i = 0; i < n; i++) {
+        uint8_t x = a[i], y = b[i];
+        if (x != y && ((x | 0x20) != (y | 0x20) ||
+                       static_cast<uint8_t>((x | 0x20) - 'a') > 'z' - 'a')) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// 解析 "ip[:port]" / "[ipv6]:port" / "ipv6"
+bool parseServer(const std::string& spec, sockaddr_storage* addr, socklen_t* addr_len) {
+    std::string host = spec;
+    uint16_t port = 53;
+
+    size_t colon = spec.rfind(':');
+    if (!spec.empty() && spec[0] == '[') {
+        size_t close = spec.find(']');
+        if (close == std::string::npos) return false;
+        host = spec.substr(1, close - 1);
+        if (close + 1 < spec.size()) {
+            if (spec[close + 1] != ':') return false;
+            colon = close + 1;
+        } else {
+            colon = std::string::npos;
+        }
+    } else if (colon != std::string::npos && spec.find(':') != colon) {
+        colon = std::string::npos;  // 不带括号的 IPv6 地址
+    } else if (colon != std::string::npos) {
+        host = spec.substr(0, colon);
+    }
+    if (colon != std::string::npos) {
+        char* end = nullptr;
+        unsigned long p = std::strtoul(spec.c_str() + colon + 1, &end, 10);
+        if (end == spec.c_str() + colon + 1 || *end != '\0' || p == 0 || p > 65535) return false;
+        port = static_cast<uint16_t>(p);
+    }
+
+    std::memset(addr, 0, sizeof(*addr));
+    auto* v4 = reinterpret_cast<sockaddr_in*>(addr);
+    if (inet_pton(AF_INET, host.c_str(), &v4->sin_addr) == 1) {
+        v4->sin_family = AF_INET;
+        v4->sin_port = htons(port);
+        *addr_len = sizeof(sockaddr_in);
+        return true;
+    }
+    auto* v6 = reinterpret_cast<sockaddr_in6*>(addr);
+    if (inet_pton(AF_INET6, host.c_str(), &v6->sin6_addr) == 1) {
+        v6->sin6_family = AF_INET6;
+        v6->sin6_port = htons(port);
+        *addr_len = sizeof(sockaddr_in6);
+        return true;
+    }
+    return false;
+}
+
+// IPv4 地址映射为 ::ffff:a.b.c.d (双栈 socket)
+void mapToV6(sockaddr_storage* addr, socklen_t* addr_len) {
+    if (addr->ss_family != AF_INET) return;
+    sockaddr_in v4 = *reinterpret_cast<sockaddr_in*>(addr);
+    auto* v6 = reinterpret_cast<sockaddr_in6*>(addr);
+    std::memset(addr, 0, sizeof(*addr));
+    v6->sin6_family = AF_INET6;
+    v6->sin6_port = v4.sin_port;
+    v6->sin6_addr.s6_addr[10] = 0xFF;
+    v6->sin6_addr.s6_addr[11] = 0xFF;
+    std::memcpy(&v6->sin6_addr.s6_addr[12], &v4.sin_addr, 4);
+    *addr_len = sizeof(sockaddr_in6);
+}
+
+bool sameAddress(const sockaddr_storage& a, const sockaddr_storage& b) {
+    if (a.ss_family != b.ss_family) return false;
+    if (a.ss_family == AF_INET) {
+        const auto& x = reinterpret_cast<const sockaddr_in&>(a);
+        const auto& y = reinterpret_cast<const sockaddr_in&>(b);
+        return x.sin_port == y.sin_port && x.sin_addr.s_addr == y.sin_addr.s_addr;
+    }
+    const auto& x = reinterpret_cast<const sockaddr_in6&>(a);
+    const auto& y = reinterpret_cast<const sockaddr_in6&>(b);
+    return x.sin6_port == y.sin6_port &&
+           std::memcmp(&x.sin6_addr, &y.sin6_addr, sizeof(x.sin6_addr)) == 0;
+}
+
+} // anonymous namespace
+
+struct Forwarder::Entry {
+    std::atomic<uint32_t> state{STATE_FREE};
+    uint32_t owner;
+    uint64_t cookie;
+    uint64_t deadline_ns;
+    uint16_t client_id;
+    uint16_t upstream_id;
+    uint16_t query_len;
+    uint16_t question_end;
+    uint16_t response_len;
+    uint8_t  socket;
+    uint8_t  server;
+    uint8_t  attempts;
+    uint8_t  edns;                  // EdnsFlags
+    uint16_t udp_size;              // 客户端可接收的 UDP 负载
+    uint64_t key;                   // 合并键哈希
+    uint32_t next_key;              // 合并表桶链 (表项 + 1)
+    uint32_t waiters;               // 等待者链头 (表项 + 1), 仅领头
+    uint32_t next_waiter;
+    bool     leader;                // 已登记在合并表中
+    uint8_t  query[kMaxQuery];      // 头部 ID 为当前上游 ID
+    uint8_t  response[kMaxResponse];
+};
+
+struct Forwarder::Server {
+    sockaddr_storage addr;
+    socklen_t addr_len;
+};
+
+// 单生产者 (I/O 线程) 单消费者 (owner) 的表项下标队列.
+// 在途表项总数不超过容量, 因此不会溢出.
+struct Forwarder::CompletionQueue {
+    std::unique_ptr<uint32_t[]> slots;
+    uint64_t mask = 0;
+    alignas(64) std::atomic<uint64_t> head{0};
+    alignas(64) std::atomic<uint64_t> tail{0};
+};
+
+Forwarder::Forwarder(const ForwarderOptions& opts) : opts_(opts) {
+    num_sockets_ = opts.num_sockets ? opts.num_sockets : 1;
+    if (num_sockets_ > 64) num_sockets_ = 64;
+    num_owners_ = opts.num_owners ? opts.num_owners : 1;
+
+    capacity_ = 1;
+    uint32_t want = opts.max_inflight ? opts.max_inflight : 1;
+    if (want > kIdSpace) want = kIdSpace;
+    while (capacity_ < want) capacity_ <<= 1;
+    timeout_ns_ = static_cast<uint64_t>(opts.timeout_ms ? opts.timeout_ms : 1) * 1000000ULL;
+
+    entries_.reset(new Entry[capacity_]);
+    next_free_.reset(new std::atomic<uint32_t>[capacity_]);
+    for (uint32_t i = 0; i < capacity_; i++) {
+        next_free_[i].store(i + 1 < capacity_ ? i + 2 : 0, std::memory_order_relaxed);
+    }
+    free_head_.store(1, std::memory_order_relaxed);
+
+    ids_.reset(new std::atomic<uint32_t>[num_sockets_ * kIdSpace]);
+    for (size_t i = 0; i < num_sockets_ * kIdSpace; i++) {
+        ids_[i].store(0, std::memory_order_relaxed);
+    }
+
+    queues_.reset(new CompletionQueue[num_owners_]);
+    for (uint32_t i = 0; i < num_owners_; i++) {
+        queues_[i].slots.reset(new uint32_t[capacity_]);
+        queues_[i].mask = capacity_ - 1;
+    }
+
+    key_buckets_.reset(new uint32_t[capacity_]());
+    key_locks_.reset(new KeyLock[kKeyLocks]);
+
+    std::random_device rd;
+    id_seed_.store(static_cast<uint64_t>(rd()) << 32 | rd(), std::memory_order_relaxed);
+}
+
+Forwarder::~Forwarder() {
+    stop();
+}
+
+bool Forwarder::start() {
+    if (running_.load(std::memory_order_acquire) || !fds_.empty()) return false;
+
+    servers_.clear();
+    bool any_v6 = false;
+    for (const std::string& spec : opts_.servers) {
+        Server s;
+        if (!parseServer(spec, &s.addr, &s.addr_len)) return false;
+        any_v6 |= s.addr.ss_family == AF_INET6;
+        servers_.push_back(s);
+    }
+    if (servers_.empty() || servers_.size() > 255) return false;
+
+    // 有 IPv6 上游时统一使用双栈 socket
+    family_ = any_v6 ? AF_INET6 : AF_INET;
+    if (any_v6) {
+        for (Server& s : servers_) mapToV6(&s.addr, &s.addr_len);
+    }
+
+    for (uint32_t i = 0; i < num_sockets_; i++) {
+        int fd = ::socket(family_, SOCK_DGRAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+        if (fd < 0) break;
+        if (any_v6) {
+            int off = 0;
+            ::setsockopt(fd, IPPROTO_IPV6, IPV6_V6ONLY, &off, sizeof(off));
+        }
+        // 绑定临时端口, 每个 socket 的源端口不同
+        sockaddr_storage local;
+        std::memset(&local, 0, sizeof(local));
+        local.ss_family = static_cast<sa_family_t>(family_);
+        socklen_t local_len = any_v6 ? sizeof(sockaddr_in6) : sizeof(sockaddr_in);
+        if (::bind(fd, reinterpret_cast<sockaddr*>(&local), local_len) != 0) {
+            ::close(fd);
+            break;
+        }
+        fds_.push_back(fd);
+    }
+    if (fds_.size() != num_sockets_) {
+        for (int fd : fds_) ::close(fd);
+        fds_.clear();
+        return false;
+    }
+
+    running_.store(true, std::memory_order_release);
+    io_thread_ = std::thread(&Forwarder::runIo, this);
+    return true;
+}
+
+void Forwarder::stop() {
+    if (running_.exchange(false) && io_thread_.joinable()) {
+        io_thread_.join();
+    }
+    for (int fd : fds_) ::close(fd);
+    fds_.clear();
+}
+
+uint16_t Forwarder::localPort(uint32_t socket) const {
+    if (socket >= fds_.size()) return 0;
+    sockaddr_storage local;
+    socklen_t len = sizeof(local);
+    if (::getsockname(fds_[socket], reinterpret_cast<sockaddr*>(&local), &len) != 0) return 0;
+    if (local.ss_family == AF_INET6) {
+        return ntohs(reinterpret_cast<sockaddr_in6&>(local).sin6_port);
+    }
+    return ntohs(reinterpret_cast<sockaddr_in&>(local).sin_port);
+}
+
+// ==================== 表项与 ID ====================
+
+uint32_t Forwarder::allocEntry() {
+    uint64_t head = free_head_.load(std::memory_order_acquire);
+    for (;;) {
+        uint32_t top = static_cast<uint32_t>(head);
+        if (top == 0) return kNoEntry;
+        uint32_t next = next_free_[top - 1].load(std::memory_order_relaxed);
+        uint64_t desired = ((head >> 32) + 1) << 32 | next;
+        if (free_head_.compare_exchange_weak(head, desired, std::memory_order_acquire,
+                                             std::memory_order_acquire)) {
+            return top - 1;
+        }
+    }
+}
+
+void Forwarder::freeEntry(uint32_t index) {
+    uint64_t head = free_head_.load(std::memory_order_relaxed);
+    for (;;) {
+        next_free_[index].store(static_cast<uint32_t>(head), std::memory_order_relaxed);
+        uint64_t desired = ((head >> 32) + 1) << 32 | (index + 1);
+        if (free_head_.compare_exchange_weak(head, desired, std::memory_order_release,
+                                             std::memory_order_relaxed)) {
+            return;
+        }
+    }
+}
+
+bool Forwarder::bindId(uint32_t index, uint32_t socket) {
+    Entry& e = entries_[index];
+    std::atomic<uint32_t>* ids = &ids_[static_cast<size_t>(socket) * kIdSpace];
+    for (int attempt = 0; attempt < kIdAttempts; attempt++) {
+        uint64_t r = splitmix64(id_seed_.fetch_add(1, std::memory_order_relaxed));
+        uint16_t id = static_cast<uint16_t>(r);
+        uint32_t expected = 0;
+        if (ids[id].compare_exchange_strong(expected, index + 1, std::memory_order_acq_rel)) {
+            e.socket = static_cast<uint8_t>(socket);
+            e.upstream_id = id;
+            writeU16(e.query, id);
+            return true;
+        }
+    }
+    return false;
+}
+
+void Forwarder::unbindId(const Entry& entry) {
+    ids_[static_cast<size_t>(entry.socket) * kIdSpace + entry.upstream_id].store(
+        0, std::memory_order_release);
+}
+
+// ==================== 提交与完成 ====================
+
+size_t Forwarder::submit(const ForwardRequest* reqs, size_t n, bool* accepted) {
+    size_t total = 0;
+    bool running = running_.load(std::memory_order_acquire);
+    uint64_t deadline = monotonicNs() + timeout_ns_;
+
+    for (size_t base = 0; base < n; base += kBatch) {
+        size_t count = n - base < kBatch ? n - base : kBatch;
+        uint32_t batch[kBatch];
+        size_t batched = 0;
+
+        for (size_t i = 0; i < count; i++) {
+            const ForwardRequest& req = reqs[base + i];
+            accepted[base + i] = false;
+
+            size_t qend = 0;
+            if (running && req.query && req.len >= DNS_HEADER_SIZE && req.len <= kMaxQuery &&
+                req.owner < num_owners_ && (req.query[2] & 0x80) == 0 &&
+                readU16(req.query + 4) == 1) {
+                qend = questionEnd(req.query, req.len);
+            }
+            uint32_t index = qend ? allocEntry() : kNoEntry;
+            if (index == kNoEntry) {
+                rejected_.fetch_add(1, std::memory_order_relaxed);
+                continue;
+            }
+
+            Entry& e = entries_[index];
+            e.owner = req.owner;
+            e.cookie = req.cookie;
+            e.deadline_ns = deadline;
+            e.client_id = readU16(req.query);
+            e.query_len = static_cast<uint16_t>(req.len);
+            e.question_end = static_cast<uint16_t>(qend);
+            e.response_len = 0;
+            e.attempts = 0;
+            e.server = static_cast<uint8_t>(
+                next_server_.fetch_add(1, std::memory_order_relaxed) % servers_.size());
+            e.edns = queryEdns(req.query, req.len, qend, &e.udp_size);
+            e.leader = false;
+            e.waiters = 0;
+            std::memcpy(e.query, req.query, req.len);
+
+            if (!bindId(index, index % num_sockets_)) {
+                freeEntry(index);
+                rejected_.fetch_add(1, std::memory_order_relaxed);
+                continue;
+            }
+            inflight_.fetch_add(1, std::memory_order_relaxed);
+            accepted[base + i] = true;
+            total++;
+            if (opts_.coalesce && coalesceOrLead(index)) {
+                continue;
+            }
+            e.state.store(STATE_PENDING, std::memory_order_release);
+            batch[batched++] = index;
+        }
+
+        sendEntries(batch, batched);
+    }
+
+    submitted_.fetch_add(total, std::memory_order_relaxed);
+    return total;
+}
+
+bool Forwarder::coalesceOrLead(uint32_t index) {
+    Entry& e = entries_[index];
+    size_t name_len = e.question_end - 4 - DNS_HEADER_SIZE;
+    const uint8_t* name = e.query + DNS_HEADER_SIZE;
+
+    char lowered[MAX_DOMAIN_LENGTH + 2];
+    simd().lower_copy(lowered, name, name_len);
+    uint64_t h = simd().hash(lowered, name_len);
+    h ^= (static_cast<uint64_t>(readU32(name + name_len)) << 8 | e.edns) * 0x9E3779B97F4A7C15ULL;
+    e.key = h ^ (h >> 31);
+
+    size_t bucket = e.key & (capacity_ - 1);
+    std::lock_guard<std::mutex> lock(key_locks_[bucket & (kKeyLocks - 1)].mutex);
+    for (uint32_t cur = key_buckets_[bucket]; cur; cur = entries_[cur - 1].next_key) {
+        Entry& lead = entries_[cur - 1];
+        if (lead.key != e.key || lead.edns != e.edns || lead.question_end != e.question_end ||
+            readU32(lead.query + e.question_end - 4) != readU32(name + name_len) ||
+            !equalNoCase(lead.query + DNS_HEADER_SIZE, name, name_len)) {
+            continue;
+        }
+        // 挂到领头上, 不占用上游 ID
+        unbindId(e);
+        e.next_waiter = lead.waiters;
+        lead.waiters = index + 1;
+        e.state.store(STATE_WAITING, std::memory_order_relaxed);
+        coalesced_.fetch_add(1, std::memory_order_relaxed);
+        return true;
+    }
+
+    e.leader = true;
+    e.next_key = key_buckets_[bucket];
+    key_buckets_[bucket] = index + 1;
+    return false;
+}
+
+void Forwarder::complete(uint32_t index) {
+    Entry& lead = entries_[index];
+    uint32_t waiters = 0;
+    if (lead.leader) {
+        // 摘除后不会再有新的等待者挂上
+        size_t bucket = lead.key & (capacity_ - 1);
+        std::lock_guard<std::mutex> lock(key_locks_[bucket & (kKeyLocks - 1)].mutex);
+        for (uint32_t* link = &key_buckets_[bucket]; *link; link = &entries_[*link - 1].next_key) {
+            if (*link == index + 1) {
+                *link = lead.next_key;
+                break;
+            }
+        }
+        lead.leader = false;
+        waiters = lead.waiters;
+        lead.waiters = 0;
+    }
+
+    size_t name_len = lead.question_end - 4 - DNS_HEADER_SIZE;
+    while (waiters) {
+        uint32_t w = waiters - 1;
+        Entry& e = entries_[w];
+        waiters = e.next_waiter;
+
+        if (lead.response_len == 0) {
+            e.response_len = 0;
+        } else if (lead.response_len > e.udp_size) {
+            // 超过该客户端的 UDP 负载上限, 让它改用 TCP
+            DNSParseResult parsed;
+            e.response_len = DNSParser::parse(e.query, e.query_len, &parsed) == Error::Success
+                ? static_cast<uint16_t>(DNSResponseBuilder::buildTruncated(
+                      e.query, e.query_len, parsed, e.response, kMaxResponse))
+                : 0;
+        } else {
+            std::memcpy(e.response, lead.response, lead.response_len);
+            writeU16(e.response, e.client_id);
+            e.response[2] = static_cast<uint8_t>((e.response[2] & ~0x01) | (e.query[2] & 0x01));
+            std::memcpy(e.response + DNS_HEADER_SIZE, e.query + DNS_HEADER_SIZE, name_len);
+            e.response_len = lead.response_len;
+        }
+        finish(w);
+    }
+    finish(index);
+}
+
+void Forwarder::sendEntries(const uint32_t* indexes, size_t n) {
+    if (n == 0) return;
+
+    mmsghdr msgs[kBatch];
+    iovec iovs[kBatch];
+    for (uint32_t s = 0; s < num_sockets_; s++) {
+        unsigned count = 0;
+        for (size_t i = 0; i < n; i++) {
+            Entry& e = entries_[indexes[i]];
+            if (e.socket != s) continue;
+            Server& server = servers_[e.server];
+            iovs[count] = iovec{e.query, e.query_len};
+            std::memset(&msgs[count], 0, sizeof(msgs[count]));
+            msgs[count].msg_hdr.msg_name = &server.addr;
+            msgs[count].msg_hdr.msg_namelen = server.addr_len;
+            msgs[count].msg_hdr.msg_iov = &iovs[count];
+            msgs[count].msg_hdr.msg_iovlen = 1;
+            count++;
+        }
+        if (count == 0) continue;
+
+        // 未发出的保持在途, 由超时重发
+        unsigned sent = 0;
+        while (sent < count) {
+            int ret = ::sendmmsg(fds_[s], msgs + sent, count - sent, MSG_DONTWAIT);
+            if (ret <= 0) break;
+            sent += static_cast<unsigned>(ret);
+        }
+        sent_.fetch_add(sent, std::memory_order_relaxed);
+        send_errors_.fetch_add(count - sent, std::memory_order_relaxed);
+    }
+}
+
+void Forwarder::finish(uint32_t index) {
+    Entry& e = entries_[index];
+    e.state.store(STATE_DONE, std::memory_order_relaxed);
+
+    CompletionQueue& q = queues_[e.owner];
+    uint64_t head = q.head.load(std::memory_order_relaxed);
+    q.slots[head & q.mask] = index;
+    q.head.store(head + 1, std::memory_order_release);
+}
+
+size_t Forwarder::poll(uint32_t owner, ForwardCompletion* out, size_t max) {
+    if (owner >= num_owners_) return 0;
+
+    CompletionQueue& q = queues_[owner];
+    uint64_t tail = q.tail.load(std::memory_order_relaxed);
+    uint64_t head = q.head.load(std::memory_order_acquire);
+    size_t n = 0;
+    while (n < max && tail != head) {
+        uint32_t index = q.slots[tail & q.mask];
+        const Entry& e = entries_[index];
+        out[n++] = ForwardCompletion{e.response, e.response_len, index, e.cookie};
+        tail++;
+    }
+    q.tail.store(tail, std::memory_order_release);
+    completed_.fetch_add(n, std::memory_order_relaxed);
+    return n;
+}
+
+void Forwarder::release(const ForwardCompletion* done, size_t n) {
+    for (size_t i = 0; i < n; i++) {
+        if (done[i].entry >= capacity_) continue;
+        entries_[done[i].entry].state.store(STATE_FREE, std::memory_order_relaxed);
+        freeEntry(done[i].entry);
+    }
+    inflight_.fetch_sub(n, std::memory_order_relaxed);
+}
+
+ForwarderStats Forwarder::stats() const {
+    ForwarderStats s{};
+    s.submitted = submitted_.load(std::memory_order_relaxed);
+    s.coalesced = coalesced_.load(std::memory_order_relaxed);
+    s.rejected = rejected_.load(std::memory_order_relaxed);
+    s.sent = sent_.load(std::memory_order_relaxed);
+    s.send_errors = send_errors_.load(std::memory_order_relaxed);
+    s.responses = responses_.load(std::memory_order_relaxed);
+    s.mismatched = mismatched_.load(std::memory_order_relaxed);
+    s.retries = retries_.load(std::memory_order_relaxed);
+    s.timeouts = timeouts_.load(std::memory_order_relaxed);
+    s.truncated = truncated_.load(std::memory_order_relaxed);
+    s.completed = completed_.load(std::memory_order_relaxed);
+    s.inflight = inflight_.load(std::memory_order_relaxed);
+    return s;
+}
+
+// ==================== I/O 线程 ====================
+
+void Forwarder::runIo() {
+    std::vector<pollfd> pfds(fds_.size());
+    for (size_t i = 0; i < fds_.size(); i++) {
+        pfds[i] = pollfd{fds_[i], POLLIN, 0};
+    }
+
+    // 超时扫描间隔: 超时的 1/8, 1 ~ 10 ms
+    uint64_t scan_ns = timeout_ns_ / 8;
+    if (scan_ns < 1000000ULL) scan_ns = 1000000ULL;
+    if (scan_ns > 10000000ULL) scan_ns = 10000000ULL;
+    uint64_t next_scan = monotonicNs() + scan_ns;
+
+    while (running_.load(std::memory_order_relaxed)) {
+        int ready = ::poll(pfds.data(), pfds.size(), static_cast<int>(scan_ns / 1000000ULL));
+        if (ready > 0) {
+            for (uint32_t s = 0; s < pfds.size(); s++) {
+                if (pfds[s].revents & POLLIN) receive(s);
+            }
+        }
+
+        uint64_t now = monotonicNs();
+        if (now >= next_scan) {
+            expire(now);
+            next_scan = now + scan_ns;
+        }
+    }
+}
+
+void Forwarder::receive(uint32_t socket) {
+    static thread_local std::vector<uint8_t> buffers(kBatch * kMaxResponse);
+    mmsghdr msgs[kBatch];
+    iovec iovs[kBatch];
+    sockaddr_storage from[kBatch];
+
+    for (;;) {
+        for (size_t i = 0; i < kBatch; i++) {
+            iovs[i] = iovec{&buffers[i * kMaxResponse], kMaxResponse};
+            std::memset(&msgs[i], 0, sizeof(msgs[i]));
+            msgs[i].msg_hdr.msg_name = &from[i];
+            msgs[i].msg_hdr.msg_namelen = sizeof(from[i]);
+            msgs[i].msg_hdr.msg_iov = &iovs[i];
+            msgs[i].msg_hdr.msg_iovlen = 1;
+        }
+        int ret = ::recvmmsg(fds_[socket], msgs, kBatch, MSG_DONTWAIT, nullptr);
+        if (ret <= 0) return;
+
+        for (int i = 0; i < ret; i++) {
+            const uint8_t* data = &buffers[i * kMaxResponse];
+            size_t len = msgs[i].msg_len;
+            bool truncated = (msgs[i].msg_hdr.msg_flags & MSG_TRUNC) != 0;
+            if (len < DNS_HEADER_SIZE || (data[2] & 0x80) == 0) {
+                mismatched_.fetch_add(1, std::memory_order_relaxed);
+                continue;
+            }
+
+            uint16_t id = readU16(data);
+            uint32_t slot = ids_[static_cast<size_t>(socket) * kIdSpace + id].load(
+                std::memory_order_acquire);
+            if (slot == 0) {
+                mismatched_.fetch_add(1, std::memory_order_relaxed);
+                continue;
+            }
+            uint32_t index = slot - 1;
+            Entry& e = entries_[index];
+
+            // 来源必须是本次发往的上游, 问题部分逐字节一致 (含 0x20 大小写)
+            if (e.state.load(std::memory_order_acquire) != STATE_PENDING ||
+                e.upstream_id != id || e.socket != socket ||
+                !sameAddress(from[i], servers_[e.server].addr) ||
+                len < e.question_end || readU16(data + 4) != 1 ||
+                std::memcmp(data + DNS_HEADER_SIZE, e.query + DNS_HEADER_SIZE,
+                            e.question_end - DNS_HEADER_SIZE) != 0) {
+                mismatched_.fetch_add(1, std::memory_order_relaxed);
+                continue;
+            }
+
+            unbindId(e);
+            if (truncated) {
+                // 放不下的响应让客户端改用 TCP
+                writeU16(e.query, e.client_id);
+                DNSParseResult parsed;
+                e.response_len = DNSParser::parse(e.query, e.query_len, &parsed) == Error::Success
+                    ? static_cast<uint16_t>(DNSResponseBuilder::buildTruncated(
+                          e.query, e.query_len, parsed, e.response, kMaxResponse))
+                    : 0;
+                truncated_.fetch_add(1, std::memory_order_relaxed);
+            } else {
+                std::memcpy(e.response, data, len);
+                writeU16(e.response, e.client_id);
+                e.response_len = static_cast<uint16_t>(len);
+            }
+            responses_.fetch_add(1, std::memory_order_relaxed);
+            complete(index);
+        }
+        if (static_cast<size_t>(ret) < kBatch) return;
+    }
+}
+
+void Forwarder::expire(uint64_t now_ns) {
+    uint32_t resend[kBatch];
+    size_t count = 0;
+
+    for (uint32_t index = 0; index < capacity_; index++) {
+        Entry& e = entries_[index];
+        if (e.state.load(std::memory_order_acquire) != STATE_PENDING || e.deadline_ns > now_ns) {
+            continue;
+        }
+
+        unbindId(e);
+        if (e.attempts < opts_.retries) {
+            // 换下一个上游, 用新 ID 重发
+            e.attempts++;
+            e.server = static_cast<uint8_t>((e.server + 1) % servers_.size());
+            if (bindId(index, e.socket)) {
+                e.deadline_ns = now_ns + timeout_ns_;
+                retries_.fetch_add(1, std::memory_order_relaxed);
+                resend[count++] = index;
+                if (count == kBatch) {
+                    sendEntries(resend, count);
+                    count = 0;
+                }
+                continue;
+            }
+        }
+
+        writeU16(e.query, e.client_id);
+        DNSParseResult parsed;
+        e.response_len = DNSParser::parse(e.query, e.query_len, &parsed) == Error::Success
+            ? static_cast<uint16_t>(DNSResponseBuilder::buildServFail(
+                  e.query, e.query_len, parsed, e.response, kMaxResponse))
+            : 0;
+        timeouts_.fetch_add(1, std::memory_order_relaxed);
+        complete(index);
+    }
+    sendEntries(resend, count);
+}
+
+} // namespace xdp_dns
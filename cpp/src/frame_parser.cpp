@@ -0,0 +1,231 @@
+#include "xdp_dns/frame_parser.hpp"
+
+namespace xdp_dns {
+
+namespace {
+
+constexpr size_t ETH_HEADER_LEN = 14;
+constexpr size_t VLAN_TAG_LEN = 4;
+constexpr size_t IPV4_MIN_HEADER_LEN = 20;
+constexpr size_t IPV6_HEADER_LEN = 40;
+constexpr size_t UDP_HEADER_LEN = 8;
+
+constexpr uint16_t ETH_TYPE_IPV4 = 0x0800;
+constexpr uint16_t ETH_TYPE_IPV6 = 0x86DD;
+constexpr uint16_t ETH_TYPE_8021Q = 0x8100;
+constexpr uint16_t ETH_TYPE_8021AD = 0x88A8;
+constexpr uint16_t ETH_TYPE_QINQ_LEGACY = 0x9100;
+
+constexpr uint8_t IP_PROTO_HOPOPTS = 0;
+constexpr uint8_t IP_PROTO_UDP = 17;
+constexpr uint8_t IP_PROTO_ROUTING = 43;
+constexpr uint8_t IP_PROTO_FRAGMENT = 44;
+constexpr uint8_t IP_PROTO_AH = 51;
+constexpr uint8_t IP_PROTO_DSTOPTS = 60;
+
+inline bool isVlan(uint16_t ether_type) {
+    return ether_type == ETH_TYPE_8021Q || ether_type == ETH_TYPE_8021AD ||
+           ether_type == ETH_TYPE_QINQ_LEGACY;
+}
+
+} // anonymous namespace
+
+Error FrameParser::parse(const uint8_t* frame, size_t len, FrameInfo* info) {
+    if (!frame || !info) {
+        return Error::InvalidHeader;
+    }
+    if (len < ETH_HEADER_LEN) {
+        return Error::PacketTooShort;
+    }
+
+    std::memset(info, 0, sizeof(*info));
+    std::memcpy(info->dst_mac, frame, 6);
+    std::memcpy(info->src_mac, frame + 6, 6);
+
+    // VLAN 标签 (外层 802.1ad / 0x9100, 内层 802.1Q)
+    size_t offset = 12;
+    uint16_t ether_type = readU16(frame + offset);
+    offset += 2;
+    while (isVlan(ether_type)) {
+        if (info->num_vlans == MAX_VLAN_TAGS) {
+            return Error::InvalidHeader;
+        }
+        if (offset + VLAN_TAG_LEN > len) {
+            return Error::PacketTooShort;
+        }
+        info->vlan_tci[info->num_vlans++] = readU16(frame + offset);
+        ether_type = readU16(frame + offset + 2);
+        offset += VLAN_TAG_LEN;
+    }
+    if (info->num_vlans) info->flags |= FRAME_VLAN;
+    if (info->num_vlans == 2) info->flags |= FRAME_QINQ;
+
+    info->l3_offset = static_cast<uint16_t>(offset);
+
+    size_t l4 = 0;
+    size_t ip_end = 0;
+    Error err;
+    switch (ether_type) {
+        case ETH_TYPE_IPV4:
+            err = parseIPv4(frame, len, info, &l4, &ip_end);
+            break;
+        case ETH_TYPE_IPV6:
+            err = parseIPv6(frame, len, info, &l4, &ip_end);
+            break;
+        default:
+            return Error::NotUDP;
+    }
+    if (err != Error::Success) {
+        return err;
+    }
+
+    // UDP 头
+    if (l4 + UDP_HEADER_LEN > ip_end) {
+        return Error::PacketTooShort;
+    }
+    size_t udp_len = readU16(frame + l4 + 4);
+    if (udp_len < UDP_HEADER_LEN) {
+        return Error::InvalidHeader;
+    }
+
+    // 以太网最小帧填充与截断帧: 负载同时受 UDP 长度与 IP 长度限制
+    size_t payload = l4 + UDP_HEADER_LEN;
+    size_t end = l4 + udp_len < ip_end ? l4 + udp_len : ip_end;
+
+    info->l4_offset = static_cast<uint16_t>(l4);
+    info->payload_offset = static_cast<uint16_t>(payload);
+    info->payload_len = static_cast<uint16_t>(end - payload);
+    info->src_port = readU16(frame + l4);
+    info->dst_port = readU16(frame + l4 + 2);
+    return Error::Success;
+}
+
+Error FrameParser::parseIPv4(const uint8_t* frame, size_t len, FrameInfo* info,
+                             size_t* l4_offset, size_t* ip_end) {
+    size_t l3 = info->l3_offset;
+    if (l3 + IPV4_MIN_HEADER_LEN > len) {
+        return Error::PacketTooShort;
+    }
+
+    const uint8_t* ip = frame + l3;
+    size_t ihl = static_cast<size_t>(ip[0] & 0x0F) * 4;
+    if ((ip[0] >> 4) != 4 || ihl < IPV4_MIN_HEADER_LEN) {
+        return Error::InvalidHeader;
+    }
+    if (l3 + ihl > len) {
+        return Error::PacketTooShort;
+    }
+    size_t total_len = readU16(ip + 2);
+    if (total_len < ihl) {
+        return Error::InvalidHeader;
+    }
+    if (ip[9] != IP_PROTO_UDP) {
+        return Error::NotUDP;
+    }
+
+    // 非首个分片没有 UDP 头; 首个分片 (MF=1, offset=0) 交给调用者决定
+    uint16_t frag = readU16(ip + 6);
+    if (frag & 0x1FFF) {
+        return Error::Fragmented;
+    }
+    if (frag & 0x2000) {
+        info->flags |= FRAME_FRAGMENT;
+    }
+    if (ihl > IPV4_MIN_HEADER_LEN) {
+        info->flags |= FRAME_IP_OPTIONS;
+    }
+
+    info->ip_version = 4;
+    info->hop_limit = ip[8];
+    std::memcpy(info->src_addr, ip + 12, 4);
+    std::memcpy(info->dst_addr, ip + 16, 4);
+
+    *l4_offset = l3 + ihl;
+    *ip_end = l3 + total_len < len ? l3 + total_len : len;
+    return Error::Success;
+}
+
+Error FrameParser::parseIPv6(const uint8_t* frame, size_t len, FrameInfo* info,
+                             size_t* l4_offset, size_t* ip_end) {
+    size_t l3 = info->l3_offset;
+    if (l3 + IPV6_HEADER_LEN > len) {
+        return Error::PacketTooShort;
+    }
+
+    const uint8_t* ip = frame + l3;
+    if ((ip[0] >> 4) != 6) {
+        return Error::InvalidHeader;
+    }
+
+    info->flags |= FRAME_IPV6;
+    info->ip_version = 6;
+    info->hop_limit = ip[7];
+    std::memcpy(info->src_addr, ip + 8, 16);
+    std::memcpy(info->dst_addr, ip + 24, 16);
+
+    // payload length 为 0 时是 Jumbogram, 以帧长为准
+    size_t payload_len = readU16(ip + 4);
+    size_t end = l3 + IPV6_HEADER_LEN + payload_len;
+    *ip_end = payload_len && end < len ? end : len;
+
+    // 扩展头链
+    uint8_t next = ip[6];
+    size_t offset = l3 + IPV6_HEADER_LEN;
+    for (size_t i = 0;; i++) {
+        size_t hdr_len;
+        switch (next) {
+            case IP_PROTO_UDP:
+                *l4_offset = offset;
+                return Error::Success;
+            case IP_PROTO_HOPOPTS:
+            case IP_PROTO_ROUTING:
+            case IP_PROTO_DSTOPTS:
+                if (offset + 2 > *ip_end) return Error::PacketTooShort;
+                hdr_len = (static_cast<size_t>(frame[offset + 1]) + 1) * 8;
+                break;
+            case IP_PROTO_AH:
+                if (offset + 2 > *ip_end) return Error::PacketTooShort;
+                hdr_len = (static_cast<size_t>(frame[offset + 1]) + 2) * 4;
+                break;
+            case IP_PROTO_FRAGMENT: {
+                if (offset + 8 > *ip_end) return Error::PacketTooShort;
+                uint16_t frag = readU16(frame + offset + 2);
+                if (frag & 0xFFF8) {
+                    return Error::Fragmented;
+                }
+                if (frag & 0x0001) {
+                    info->flags |= FRAME_FRAGMENT;
+                }
+                hdr_len = 8;
+                break;
+            }
+            default:
+                // ESP、No Next Header 与 TCP / ICMPv6 等
+                return Error::NotUDP;
+        }
+
+        if (i == MAX_IPV6_EXT_HEADERS) {
+            return Error::InvalidHeader;
+        }
+        info->flags |= FRAME_IPV6_EXT;
+        next = frame[offset];
+        offset += hdr_len;
+    }
+}
+
+uint64_t FrameParser::parseBatch(
+    const uint8_t* const* frames,
+    const uint32_t* lens,
+    size_t n,
+    FrameInfo* out
+) {
+    if (n > 64) n = 64;
+
+    uint64_t ok = 0;
+    for (size_t i = 0; i < n; i++) {
+        ok |= static_cast<uint64_t>(parse(frames[i], lens[i], &out[i]) == Error::Success) << i;
+    }
+    return ok;
+}
+
+} // namespace xdp_dns
@@ -0,0 +1,486 @@
+#include "xdp_dns/local_zone.hpp"
+#include <arpa/inet.h>
+#include <algorithm>
+#include <cctype>
+#include <cstdlib>
+#include <cstring>
+#include <strings.h>
+
+namespace xdp_dns {
+
+namespace {
+
+// 合成 SOA 的 RDATA, 与 DNSResponseBuilder 的合成 SOA 一致, MINIMUM 在编译时填入:
+//   localhost. nobody.invalid. 1 3600 600 86400 <negative_ttl>
+constexpr uint8_t kSyntheticSoaRdata[] = {
+    9, 'l', 'o', 'c', 'a', 'l', 'h', 'o', 's', 't', 0,
+    6, 'n', 'o', 'b', 'o', 'd', 'y', 7, 'i', 'n', 'v', 'a', 'l', 'i', 'd', 0,
+    0x00, 0x00, 0x00, 0x01,                         // SERIAL
+    0x00, 0x00, 0x0E, 0x10,                         // REFRESH 3600
+    0x00, 0x00, 0x02, 0x58,                         // RETRY 600
+    0x00, 0x01, 0x51, 0x80,                         // EXPIRE 86400
+    0x00, 0x00, 0x00, 0x00,                         // MINIMUM
+};
+
+struct TypeName {
+    const char* name;
+    uint16_t type;
+};
+
+constexpr TypeName kTypes[] = {
+    {"A", dns_type::A},     {"AAAA", dns_type::AAAA}, {"CNAME", dns_type::CNAME},
+    {"TXT", dns_type::TXT}, {"SRV", dns_type::SRV},   {"PTR", dns_type::PTR},
+    {"SOA", dns_type::SOA},
+};
+
+// 按空白切分, 分号之后为注释; 双引号内保留空白, 支持 \" \\ 与 \DDD 转义
+bool tokenize(std::string_view text, std::vector<std::string>* out) {
+    size_t i = 0;
+    while (i < text.size()) {
+        char c = text[i];
+        if (c == ' ' || c == '\t' || c == '\r' || c == '\n') {
+            i++;
+            continue;
+        }
+        if (c == ';') break;
+
+        std::string token;
+        if (c != '"') {
+            while (i < text.size() && text[i] != ' ' && text[i] != '\t' && text[i] != '\r' &&
+                   text[i] != '\n') {
+                token += text[i++];
+            }
+            out->push_back(std::move(token));
+            continue;
+        }
+        for (i++;; i++) {
+            if (i >= text.size()) return false;     // 引号未闭合
+            c = text[i];
+            if (c == '"') break;
+            if (c != '\\') {
+                token += c;
+                continue;
+            }
+            if (++i >= text.size()) return false;
+            if (i + 2 < text.size() && std::isdigit(static_cast<unsigned char>(text[i])) &&
+                std::isdigit(static_cast<unsigned char>(text[i + 1])) &&
+                std::isdigit(static_cast<unsigned char>(text[i + 2]))) {
+                int v = (text[i] - '0') * 100 + (text[i + 1] - '0') * 10 + (text[i + 2] - '0');
+                if (v > 255) return false;
+                token += static_cast<char>(v);
+                i += 2;
+            } else {
+                token += text[i];
+            }
+        }
+        i++;
+        out->push_back(std::move(token));
+    }
+    return true;
+}
+
+bool parseU32(const std::string& s, uint32_t max, uint32_t* out) {
+    if (s.empty() || !std::isdigit(static_cast<unsigned char>(s[0]))) return false;
+    char* end = nullptr;
+    unsigned long long v = std::strtoull(s.c_str(), &end, 10);
+    if (*end != '\0' || v > max) return false;
+    *out = static_cast<uint32_t>(v);
+    return true;
+}
+
+// 名字 → 小写点分 (无结尾的点); 标签非法时返回 false
+bool normalizeName(std::string_view name, std::string* out) {
+    uint8_t wire[MAX_DOMAIN_LENGTH];
+    if (name.empty() || ResponseWriter::encodeName(name.data(), name.size(), wire,
+                                                   sizeof(wire)) == 0) {
+        return false;
+    }
+    if (name.back() == '.') name.remove_suffix(1);
+    out->resize(name.size());
+    simd().lower_copy(out->data(), reinterpret_cast<const uint8_t*>(name.data()), name.size());
+    return true;
+}
+
+bool appendName(const std::string& name, std::vector<uint8_t>* rdata) {
+    uint8_t wire[MAX_DOMAIN_LENGTH];
+    size_t len = ResponseWriter::encodeName(name.data(), name.size(), wire, sizeof(wire));
+    if (len == 0) return false;
+    rdata->insert(rdata->end(), wire, wire + len);
+    return true;
+}
+
+void appendU16(std::vector<uint8_t>* rdata, uint16_t v) {
+    rdata->push_back(static_cast<uint8_t>(v >> 8));
+    rdata->push_back(static_cast<uint8_t>(v));
+}
+
+void appendU32(std::vector<uint8_t>* rdata, uint32_t v) {
+    appendU16(rdata, static_cast<uint16_t>(v >> 16));
+    appendU16(rdata, static_cast<uint16_t>(v));
+}
+
+// 按类型把 RDATA 文本编码为线上格式
+bool encodeRdata(uint16_t type, const std::vector<std::string>& args,
+                 std::vector<uint8_t>* rdata) {
+    switch (type) {
+        case dns_type::A: {
+            in_addr addr;
+            if (args.size() != 1 || inet_pton(AF_INET, args[0].c_str(), &addr) != 1) return false;
+            rdata->assign(reinterpret_cast<uint8_t*>(&addr), reinterpret_cast<uint8_t*>(&addr) + 4);
+            return true;
+        }
+        case dns_type::AAAA: {
+            in6_addr addr;
+            if (args.size() != 1 || inet_pton(AF_INET6, args[0].c_str(), &addr) != 1) return false;
+            rdata->assign(addr.s6_addr, addr.s6_addr + 16);
+            return true;
+        }
+        case dns_type::CNAME:
+        case dns_type::PTR:
+            return args.size() == 1 && appendName(args[0], rdata);
+        case dns_type::TXT:
+            if (args.empty()) return false;
+            for (const auto& s : args) {
+                if (s.size() > 255) return false;
+                rdata->push_back(static_cast<uint8_t>(s.size()));
+                rdata->insert(rdata->end(), s.begin(), s.end());
+            }
+            return rdata->size() <= UINT16_MAX;
+        case dns_type::SRV: {
+            uint32_t priority, weight, port;
+            if (args.size() != 4 || !parseU32(args[0], UINT16_MAX, &priority) ||
+                !parseU32(args[1], UINT16_MAX, &weight) || !parseU32(args[2], UINT16_MAX, &port)) {
+                return false;
+            }
+            appendU16(rdata, static_cast<uint16_t>(priority));
+            appendU16(rdata, static_cast<uint16_t>(weight));
+            appendU16(rdata, static_cast<uint16_t>(port));
+            return appendName(args[3], rdata);     // RFC 2782: 目标不压缩
+        }
+        case dns_type::SOA: {
+            if (args.size() != 7 || !appendName(args[0], rdata) || !appendName(args[1], rdata)) {
+                return false;
+            }
+            for (size_t i = 2; i < 7; i++) {
+                uint32_t v;
+                if (!parseU32(args[i], UINT32_MAX, &v)) return false;
+                appendU32(rdata, v);
+            }
+            return true;
+        }
+        default:
+            return false;
+    }
+}
+
+// 去掉第一个标签; 已是根时返回 false
+bool parentName(std::string_view* name) {
+    if (name->empty()) return false;
+    size_t dot = name->find('.');
+    *name = dot == std::string_view::npos ? std::string_view() : name->substr(dot + 1);
+    return true;
+}
+
+std::string_view lastLabel(std::string_view name) {
+    size_t dot = name.rfind('.');
+    return dot == std::string_view::npos ? name : name.substr(dot + 1);
+}
+
+} // anonymous namespace
+
+Error LocalZones::addZone(std::string_view apex) {
+    std::string name;
+    if (apex == "." || apex.empty()) {
+        name.clear();
+    } else if (!normalizeName(apex, &name)) {
+        return Error::InvalidRule;
+    }
+    if (zone_index_.count(name)) return Error::Success;
+
+    zones_.push_back(Zone{std::move(name)});
+    const std::string& stored = zones_.back().apex;
+    zone_index_.emplace(stored, static_cast<uint32_t>(zones_.size() - 1));
+    tld_mask_ |= stored.empty() ? ~0ULL : 1ULL << (LabelHash{}(lastLabel(stored)) & 63);
+    return Error::Success;
+}
+
+Error LocalZones::addRecord(std::string_view text) {
+    std::vector<std::string> tokens;
+    if (!tokenize(text, &tokens) || tokens.size() < 3) return Error::InvalidRule;
+
+    Record rec;
+    if (tokens[0] == ".") {
+        rec.owner.clear();
+    } else if (!normalizeName(tokens[0], &rec.owner)) {
+        return Error::InvalidRule;
+    }
+
+    // [ttl] [IN] 或 [IN] [ttl], 之后是类型
+    size_t i = 1;
+    bool have_ttl = false, have_class = false;
+    rec.ttl = kDefaultTtl;
+    for (; i < tokens.size() && !(have_ttl && have_class); i++) {
+        if (!have_ttl && parseU32(tokens[i], INT32_MAX, &rec.ttl)) {
+            have_ttl = true;
+        } else if (!have_class && strcasecmp(tokens[i].c_str(), "IN") == 0) {
+            have_class = true;
+        } else {
+            break;
+        }
+    }
+    if (i >= tokens.size()) return Error::InvalidRule;
+
+    rec.type = 0;
+    for (const auto& t : kTypes) {
+        if (strcasecmp(tokens[i].c_str(), t.name) == 0) rec.type = t.type;
+    }
+    if (rec.type == 0) return Error::InvalidRule;
+
+    std::vector<std::string> args(tokens.begin() + i + 1, tokens.end());
+    if (!encodeRdata(rec.type, args, &rec.rdata)) return Error::InvalidRule;
+    records_.push_back(std::move(rec));
+    return Error::Success;
+}
+
+uint32_t LocalZones::findZone(std::string_view name) const {
+    // 最深的包含区
+    do {
+        auto it = zone_index_.find(name);
+        if (it != zone_index_.end()) return it->second;
+    } while (parentName(&name));
+    return kNone;
+}
+
+uint32_t LocalZones::internNode(std::string_view name, uint32_t zone) {
+    auto it = node_index_.find(name);
+    if (it != node_index_.end()) return it->second;
+    names_.emplace_back(name);
+    uint32_t id = static_cast<uint32_t>(nodes_.size());
+    nodes_.push_back(Node{zone});
+    node_index_.emplace(names_.back(), id);
+    return id;
+}
+
+uint32_t LocalZones::addBlob(RRBlob&& blob) {
+    blobs_.push_back(std::move(blob));
+    return static_cast<uint32_t>(blobs_.size() - 1);
+}
+
+Error LocalZones::compile(uint32_t negative_ttl) {
+    // 没有 SOA 的区顶点补上合成的 SOA
+    for (const Zone& zone : zones_) {
+        bool has_soa = std::any_of(records_.begin(), records_.end(), [&](const Record& r) {
+            return r.type == dns_type::SOA && r.owner == zone.apex;
+        });
+        if (has_soa) continue;
+        Record soa{zone.apex, dns_type::SOA, negative_ttl,
+                   std::vector<uint8_t>(std::begin(kSyntheticSoaRdata),
+                                        std::end(kSyntheticSoaRdata))};
+        writeU32(soa.rdata.data() + soa.rdata.size() - 4, negative_ttl);
+        records_.push_back(std::move(soa));
+    }
+
+    // 名字 → 记录; 每个名字与其到区顶点之间的祖先都是节点 (空的中间节点回答 NODATA)
+    std::unordered_map<std::string_view, std::vector<uint32_t>> by_name;
+    for (uint32_t i = 0; i < records_.size(); i++) {
+        const Record& r = records_[i];
+        uint32_t zone = findZone(r.owner);
+        if (zone == kNone) return Error::InvalidRule;
+        by_name[r.owner].push_back(i);
+
+        std::string_view name = r.owner;
+        while (!node_index_.count(name)) {
+            internNode(name, zone);
+            if (name == zones_[zone].apex) break;
+            parentName(&name);
+        }
+    }
+
+    // 否定应答: 权威区一条 SOA, TTL 取 min(SOA TTL, MINIMUM) (RFC 2308)
+    std::vector<uint8_t> scratch(UINT16_MAX);
+    for (Zone& zone : zones_) {
+        const Record* soa = nullptr;
+        for (uint32_t i : by_name[zone.apex]) {
+            if (records_[i].type == dns_type::SOA) soa = &records_[i];
+        }
+        uint8_t apex[MAX_DOMAIN_LENGTH];
+        if (!soa || soa->rdata.size() < 20 ||
+            ResponseWriter::encodeName(zone.apex.data(), zone.apex.size(), apex,
+                                       sizeof(apex)) == 0) {
+            return Error::InvalidRule;
+        }
+        uint32_t ttl = std::min(soa->ttl, readU32(soa->rdata.data() + soa->rdata.size() - 4));
+
+        ResponseWriter w;
+        RRBlob blob;
+        w.beginBlob(scratch.data(), scratch.size());
+        w.beginAuthority();
+        w.addRaw(apex, dns_type::SOA, ttl, soa->rdata.data(), soa->rdata.size());
+        if (!w.finishBlob(&blob)) return Error::InvalidRule;
+        zone.negative = addBlob(std::move(blob));
+    }
+
+    // 通配符挂到父节点上
+    for (uint32_t id = 0; id < nodes_.size(); id++) {
+        std::string_view name = names_[id];
+        if (name != "*" && name.compare(0, 2, "*.") != 0) continue;
+        auto parent = node_index_.find(name.size() == 1 ? std::string_view() : name.substr(2));
+        if (parent != node_index_.end()) nodes_[parent->second].wildcard = id;
+    }
+
+    static const std::vector<uint32_t> kNoRecords;
+    for (uint32_t id = 0; id < nodes_.size(); id++) {
+        auto it = by_name.find(names_[id]);
+        if (!compileNode(id, it == by_name.end() ? kNoRecords : it->second, by_name)) {
+            return Error::InvalidRule;
+        }
+    }
+    return Error::Success;
+}
+
+bool LocalZones::compileNode(
+    uint32_t id, const std::vector<uint32_t>& records,
+    const std::unordered_map<std::string_view, std::vector<uint32_t>>& by_name) {
+    Node& node = nodes_[id];
+    node.first_entry = static_cast<uint32_t>(entries_.size());
+
+    std::vector<uint8_t> scratch(UINT16_MAX);
+    ResponseWriter w;
+    auto writeRecord = [&](const uint8_t* owner, const Record& r) {
+        if (r.type == dns_type::CNAME) return w.addCNAME(owner, r.ttl, r.rdata.data());
+        if (r.type == dns_type::PTR) return w.addPTR(owner, r.ttl, r.rdata.data());
+        return w.addRaw(owner, r.type, r.ttl, r.rdata.data(), r.rdata.size());
+    };
+    auto emit = [&](uint16_t qtype, uint8_t rcode) {
+        RRBlob blob;
+        if (!w.finishBlob(&blob)) return false;
+        entries_.push_back(Entry{qtype, rcode, addBlob(std::move(blob))});
+        return true;
+    };
+
+    // 按类型分组, 保持加载顺序
+    std::vector<uint16_t> types;
+    const Record* cname = nullptr;
+    for (uint32_t i : records) {
+        const Record& r = records_[i];
+        if (std::find(types.begin(), types.end(), r.type) == types.end()) types.push_back(r.type);
+        if (r.type == dns_type::CNAME) {
+            if (cname) return false;                // 一个名字只能有一条 CNAME
+            cname = &r;
+        }
+    }
+
+    if (cname) {
+        if (types.size() > 1) return false;         // CNAME 不能与其它数据共存
+        // 目标在本地数据中时, 按目标的各类型预编译 CNAME + RRset
+        std::string target;
+        for (size_t i = 0; cname->rdata[i] != 0; i += cname->rdata[i] + 1) {
+            if (!target.empty()) target += '.';
+            for (size_t k = 1; k <= cname->rdata[i]; k++) {
+                target += static_cast<char>(std::tolower(cname->rdata[i + k]));
+            }
+        }
+        auto chased = by_name.find(target);
+        if (chased != by_name.end()) {
+            std::vector<uint16_t> target_types;
+            for (uint32_t i : chased->second) {
+                uint16_t t = records_[i].type;
+                if (t == dns_type::CNAME ||
+                    std::find(target_types.begin(), target_types.end(), t) != target_types.end()) {
+                    continue;
+                }
+                target_types.push_back(t);
+                w.beginBlob(scratch.data(), scratch.size());
+                writeRecord(nullptr, *cname);
+                for (uint32_t k : chased->second) {
+                    if (records_[k].type == t) writeRecord(cname->rdata.data(), records_[k]);
+                }
+                if (!emit(t, dns_rcode::NOERROR)) return false;
+            }
+        }
+        w.beginBlob(scratch.data(), scratch.size());
+        writeRecord(nullptr, *cname);
+        if (!emit(0, dns_rcode::NOERROR)) return false;
+    } else {
+        for (uint16_t t : types) {
+            w.beginBlob(scratch.data(), scratch.size());
+            for (uint32_t i : records) {
+                if (records_[i].type == t) writeRecord(nullptr, records_[i]);
+            }
+            if (!emit(t, dns_rcode::NOERROR)) return false;
+        }
+        if (!types.empty()) {
+            w.beginBlob(scratch.data(), scratch.size());
+            for (uint32_t i : records) writeRecord(nullptr, records_[i]);
+            if (!emit(dns_type::ANY, dns_rcode::NOERROR)) return false;
+        }
+        // 默认: NODATA
+        entries_.push_back(Entry{0, dns_rcode::NOERROR, zones_[node.zone].negative});
+    }
+
+    node.num_entries = static_cast<uint32_t>(entries_.size()) - node.first_entry;
+    return true;
+}
+
+size_t LocalZones::answer(const uint8_t* query, const DNSParseResult& parsed,
+                          const char* domain, size_t domain_len,
+                          uint8_t* response, size_t capacity, uint32_t rotation) const {
+    if (zones_.empty()) return 0;
+
+    // 最后一个标签不属于任何区时直接排除, 区外查询只多一次短哈希
+    std::string_view name(domain, domain_len);
+    if (!(tld_mask_ >> (LabelHash{}(lastLabel(name)) & 63) & 1)) return 0;
+
+    uint16_t qtype = parsed.question.qtype;
+    auto it = node_index_.find(name);
+    if (it != node_index_.end()) {
+        return respond(nodes_[it->second], qtype, query, parsed, response, capacity, rotation);
+    }
+
+    // 名字不存在: 最近的存在祖先 (closest encloser) 决定通配符或 NXDOMAIN
+    while (parentName(&name)) {
+        it = node_index_.find(name);
+        if (it == node_index_.end()) continue;
+        const Node& encloser = nodes_[it->second];
+        if (encloser.wildcard != kNone) {
+            return respond(nodes_[encloser.wildcard], qtype, query, parsed, response, capacity,
+                           rotation);
+        }
+        return respondNegative(encloser.zone, dns_rcode::NXDOMAIN, query, parsed, response,
+                               capacity);
+    }
+    return 0;
+}
+
+size_t LocalZones::respond(const Node& node, uint16_t qtype, const uint8_t* query,
+                           const DNSParseResult& parsed, uint8_t* response, size_t capacity,
+                           uint32_t rotation) const {
+    // 最后一项为默认应答
+    const Entry* entry = &entries_[node.first_entry + node.num_entries - 1];
+    for (uint32_t i = node.first_entry; i + 1 < node.first_entry + node.num_entries; i++) {
+        if (entries_[i].qtype == qtype) {
+            entry = &entries_[i];
+            break;
+        }
+    }
+
+    ResponseWriter w;
+    if (!w.begin(query, parsed, response, capacity)) return 0;
+    w.setAuthoritative(true);
+    w.setRCode(entry->rcode);
+    w.addBlob(blobs_[entry->blob], rotation);
+    return w.finish();
+}
+
+size_t LocalZones::respondNegative(uint32_t zone, uint8_t rcode, const uint8_t* query,
+                                   const DNSParseResult& parsed, uint8_t* response,
+                                   size_t capacity) const {
+    ResponseWriter w;
+    if (!w.begin(query, parsed, response, capacity)) return 0;
+    w.setAuthoritative(true);
+    w.setRCode(rcode);
+    w.addBlob(blobs_[zones_[zone].negative], 0);
+    return w.finish();
+}
+
+} // namespace xdp_dns
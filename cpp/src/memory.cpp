@@ -0,0 +1,200 @@
+#include "xdp_dns/memory.hpp"
+#include <malloc.h>
+#include <cstdlib>
+#include <new>
+
+namespace xdp_dns {
+
+namespace {
+
+void* mallocAligned(size_t bytes, size_t alignment) {
+    if (bytes == 0) bytes = 1;
+    if (alignment <= alignof(std::max_align_t)) {
+        return std::malloc(bytes);
+    }
+    // aligned_alloc 要求 size 是 alignment 的整数倍
+    return std::aligned_alloc(alignment, (bytes + alignment - 1) & ~(alignment - 1));
+}
+
+} // anonymous namespace
+
+void allocationFailed() {
+#if defined(__cpp_exceptions)
+    throw std::bad_alloc();
+#else
+    std::abort();
+#endif
+}
+
+const char* memCategoryName(MemCategory c) {
+    switch (c) {
+        case MemCategory::Nodes:  return "nodes";
+        case MemCategory::Labels: return "labels";
+        case MemCategory::Rules:  return "rules";
+        case MemCategory::Cache:  return "cache";
+        case MemCategory::Index:  return "index";
+        default:                  return "unknown";
+    }
+}
+
+// ==================== MemoryUsage ====================
+
+uint64_t MemoryUsage::totalBytes() const {
+    uint64_t total = 0;
+    for (uint64_t b : bytes) {
+        total += b;
+    }
+    return total;
+}
+
+double MemoryUsage::bytesPerRule() const {
+    if (rule_count == 0) return 0;
+    return static_cast<double>(reserved_bytes) / static_cast<double>(rule_count);
+}
+
+double MemoryUsage::fragmentation() const {
+    if (reserved_bytes == 0) return 0;
+    uint64_t used = totalBytes();
+    if (used >= reserved_bytes) return 0;
+    return 1.0 - static_cast<double>(used) / static_cast<double>(reserved_bytes);
+}
+
+MemoryUsage& MemoryUsage::operator+=(const MemoryUsage& other) {
+    for (size_t i = 0; i < kMemCategoryCount; i++) {
+        bytes[i] += other.bytes[i];
+    }
+    reserved_bytes += other.reserved_bytes;
+    allocations += other.allocations;
+    huge_page_bytes += other.huge_page_bytes;
+    rule_count += other.rule_count;
+    return *this;
+}
+
+// ==================== CountingResource ====================
+
+void* CountingResource::do_allocate(size_t bytes, size_t alignment) {
+    void* p;
+    size_t reserved;
+    if (upstream_) {
+        p = upstream_->allocate(bytes, alignment);
+        reserved = 0;
+    } else {
+        p = mallocAligned(bytes, alignment);
+        if (!p) allocationFailed();
+        reserved = malloc_usable_size(p);
+    }
+
+    account(static_cast<int64_t>(bytes), static_cast<int64_t>(reserved), 1);
+    return p;
+}
+
+void CountingResource::do_deallocate(void* p, size_t bytes, size_t alignment) {
+    if (!p) return;
+
+    size_t reserved;
+    if (upstream_) {
+        reserved = 0;
+        upstream_->deallocate(p, bytes, alignment);
+    } else {
+        reserved = malloc_usable_size(p);
+        std::free(p);
+    }
+
+    account(-static_cast<int64_t>(bytes), -static_cast<int64_t>(reserved), -1);
+}
+
+void CountingResource::account(int64_t bytes, int64_t reserved, int64_t allocations) {
+    for (CountingResource* r = this; r; r = r->parent_) {
+        r->bytes_.fetch_add(static_cast<uint64_t>(bytes), std::memory_order_relaxed);
+        r->reserved_.fetch_add(static_cast<uint64_t>(reserved), std::memory_order_relaxed);
+        r->allocations_.fetch_add(static_cast<uint64_t>(allocations), std::memory_order_relaxed);
+    }
+}
+
+void CountingResource::adjustReserved(int64_t delta, bool huge) {
+    account(0, delta, 0);
+    if (huge) {
+        for (CountingResource* r = this; r; r = r->parent_) {
+            r->huge_bytes_.fetch_add(static_cast<uint64_t>(delta), std::memory_order_relaxed);
+        }
+    }
+}
+
+void CountingResource::releaseAll() {
+    int64_t bytes = static_cast<int64_t>(bytes_.load(std::memory_order_relaxed));
+    int64_t reserved = static_cast<int64_t>(reserved_.load(std::memory_order_relaxed));
+    int64_t allocations = static_cast<int64_t>(allocations_.load(std::memory_order_relaxed));
+    int64_t huge = static_cast<int64_t>(huge_bytes_.load(std::memory_order_relaxed));
+    account(-bytes, -reserved, -allocations);
+    if (huge != 0) {
+        for (CountingResource* r = this; r; r = r->parent_) {
+            r->huge_bytes_.fetch_sub(static_cast<uint64_t>(huge), std::memory_order_relaxed);
+        }
+    }
+}
+
+// ==================== MemoryAccounting ====================
+
+MemoryAccounting::MemoryAccounting() : parent_(&global()) {
+    for (size_t i = 0; i < kMemCategoryCount; i++) {
+        resources_[i].setParent(&parent_->resources_[i]);
+    }
+}
+
+MemoryAccounting::MemoryAccounting(const ArenaOptions& arena) : MemoryAccounting() {
+    if (!arena.enabled) return;
+
+    // 缓存条目频繁增删, 仍走 malloc
+    for (MemCategory c : {MemCategory::Nodes, MemCategory::Labels,
+                          MemCategory::Rules, MemCategory::Index}) {
+        size_t i = static_cast<size_t>(c);
+        arenas_[i] = std::make_unique<Arena>(arena, &resources_[i]);
+        resources_[i].setUpstream(arenas_[i].get());
+    }
+
+    size_t index = static_cast<size_t>(MemCategory::Index);
+    index_pool_ = std::make_unique<std::pmr::unsynchronized_pool_resource>(arenas_[index].get());
+    resources_[index].setUpstream(index_pool_.get());
+}
+
+MemoryAccounting::~MemoryAccounting() {
+    if (!parent_) return;
+
+    // 先整体释放 Arena (扣除映射字节), 再扣除剩余的请求字节与分配数
+    index_pool_.reset();
+    for (auto& arena : arenas_) {
+        arena.reset();
+    }
+    for (auto& r : resources_) {
+        r.releaseAll();
+    }
+    parent_->addRules(-rule_count_.load(std::memory_order_relaxed));
+}
+
+MemoryAccounting::MemoryAccounting(GlobalTag) {}
+
+MemoryAccounting& MemoryAccounting::global() {
+    static MemoryAccounting accounting{GlobalTag{}};
+    return accounting;
+}
+
+void MemoryAccounting::addRules(int64_t delta) {
+    for (MemoryAccounting* a = this; a; a = a->parent_) {
+        a->rule_count_.fetch_add(delta, std::memory_order_relaxed);
+    }
+}
+
+MemoryUsage MemoryAccounting::usage() const {
+    MemoryUsage u;
+    for (size_t i = 0; i < kMemCategoryCount; i++) {
+        u.bytes[i] = resources_[i].bytes();
+        u.reserved_bytes += resources_[i].reserved();
+        u.allocations += resources_[i].allocations();
+        u.huge_page_bytes += resources_[i].hugePageBytes();
+    }
+    int64_t rules = rule_count_.load(std::memory_order_relaxed);
+    u.rule_count = rules > 0 ? static_cast<uint64_t>(rules) : 0;
+    return u;
+}
+
+} // namespace xdp_dns
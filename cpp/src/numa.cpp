@@ -0,0 +1,127 @@
+#include "xdp_dns/numa.hpp"
+#include <linux/mempolicy.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#include <dirent.h>
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+namespace xdp_dns {
+
+namespace {
+
+// 读取 sysfs 中的单个整数, 失败返回 fallback
+int readIntFile(const char* path, int fallback) {
+    FILE* f = std::fopen(path, "r");
+    if (!f) return fallback;
+    int value;
+    if (std::fscanf(f, "%d", &value) != 1) value = fallback;
+    std::fclose(f);
+    return value;
+}
+
+constexpr int kMaxNumaNodes = 1024;
+
+} // anonymous namespace
+
+// 解析 "0-1,3" 形式的节点列表
+std::vector<int> numaParseNodeList(const char* list) {
+    std::vector<int> nodes;
+    const char* p = list;
+    while (*p && *p != '\n') {
+        char* end;
+        long lo = std::strtol(p, &end, 10);
+        if (end == p) break;
+        long hi = lo;
+        if (*end == '-') {
+            p = end + 1;
+            hi = std::strtol(p, &end, 10);
+        }
+        if (lo < 0 || hi >= kMaxNumaNodes) break;
+        for (long n = lo; n <= hi; n++) {
+            nodes.push_back(static_cast<int>(n));
+        }
+        p = (*end == ',') ? end + 1 : end;
+    }
+    return nodes;
+}
+
+int numaNodeCount() {
+    return static_cast<int>(numaOnlineNodes().size());
+}
+
+const std::vector<int>& numaOnlineNodes() {
+    static const std::vector<int> nodes = [] {
+        std::vector<int> online;
+        if (FILE* f = std::fopen("/sys/devices/system/node/online", "r")) {
+            char buf[256] = {};
+            if (std::fgets(buf, sizeof(buf), f)) online = numaParseNodeList(buf);
+            std::fclose(f);
+        }
+        if (online.empty()) online.push_back(0);
+        return online;
+    }();
+    return nodes;
+}
+
+bool numaNodeOnline(int node) {
+    const std::vector<int>& nodes = numaOnlineNodes();
+    return std::binary_search(nodes.begin(), nodes.end(), node);
+}
+
+int numaNodeOfCpu(int cpu) {
+    char path[64];
+    std::snprintf(path, sizeof(path), "/sys/devices/system/cpu/cpu%d", cpu);
+
+    DIR* dir = opendir(path);
+    if (!dir) return kNumaNodeAny;
+
+    // cpuN 目录下有一个名为 nodeM 的符号链接
+    int node = kNumaNodeAny;
+    while (struct dirent* e = readdir(dir)) {
+        if (std::strncmp(e->d_name, "node", 4) == 0 &&
+            e->d_name[4] >= '0' && e->d_name[4] <= '9') {
+            node = std::atoi(e->d_name + 4);
+            break;
+        }
+    }
+    closedir(dir);
+    return node;
+}
+
+int numaCurrentNode() {
+    unsigned cpu = 0, node = 0;
+    if (syscall(SYS_getcpu, &cpu, &node, nullptr) != 0) return kNumaNodeAny;
+    return static_cast<int>(node);
+}
+
+int numaLocalNode() {
+    thread_local int node = numaCurrentNode();
+    return node;
+}
+
+int numaNodeOfNetdev(const char* ifname) {
+    if (!ifname || !*ifname || std::strchr(ifname, '/')) return kNumaNodeAny;
+
+    char path[128];
+    std::snprintf(path, sizeof(path), "/sys/class/net/%s/device/numa_node", ifname);
+    // 虚拟网卡没有 device 目录; 固件未上报时内核给出 -1
+    int node = readIntFile(path, kNumaNodeAny);
+    return node >= 0 ? node : kNumaNodeAny;
+}
+
+bool numaBind(void* addr, size_t len, int node) {
+    if (node < 0 || numaNodeCount() <= 1) return true;
+    if (node >= kMaxNumaNodes) return false;
+
+    unsigned long mask[kMaxNumaNodes / (8 * sizeof(unsigned long))] = {};
+    mask[node / (8 * sizeof(unsigned long))] = 1UL << (node % (8 * sizeof(unsigned long)));
+
+    // PREFERRED 而非 BIND: 目标节点内存耗尽时回退到其他节点, 不触发 OOM
+    return syscall(SYS_mbind, addr, len, MPOL_PREFERRED, mask,
+                   static_cast<unsigned long>(kMaxNumaNodes), 0) == 0;
+}
+
+} // namespace xdp_dns
@@ -0,0 +1,540 @@
+#include "xdp_dns/response_cache.hpp"
+#include "xdp_dns/simd.hpp"
+#include <algorithm>
+
+namespace xdp_dns {
+
+namespace {
+
+constexpr size_t RR_FIXED_LEN = 10;     // TYPE + CLASS + TTL + RDLENGTH
+
+uint32_t roundUpPow2(uint32_t v) {
+    uint32_t p = 1;
+    while (p < v) p <<= 1;
+    return p;
+}
+
+// 未压缩的问题名长度 (含结束符), 带指针或越界返回 0
+size_t plainNameLen(const uint8_t* data, size_t len, size_t offset) {
+    size_t start = offset;
+    while (offset < len) {
+        uint8_t label = data[offset];
+        if (label == 0) return offset + 1 - start;
+        if (label > MAX_LABEL_LENGTH) return 0;
+        offset += 1 + label;
+    }
+    return 0;
+}
+
+// 跳过记录的所有者名 (可以以压缩指针结尾), 失败返回 0
+size_t skipName(const uint8_t* data, size_t len, size_t offset) {
+    while (offset < len) {
+        uint8_t label = data[offset];
+        if (label == 0) return offset + 1;
+        if ((label & 0xC0) == 0xC0) return offset + 2 <= len ? offset + 2 : 0;
+        if (label > MAX_LABEL_LENGTH) return 0;
+        offset += 1 + label;
+    }
+    return 0;
+}
+
+struct ScannedResponse {
+    size_t name_len;
+    size_t end;                     // 最后一条记录之后
+    uint16_t qtype;
+    uint16_t qclass;
+    uint8_t rcode;
+    uint8_t edns;
+    bool negative;                  // NXDOMAIN 或 NODATA
+    uint32_t min_ttl;               // 已按上限截断
+    size_t num_ttls;
+    uint16_t ttl_offsets[ResponseCache::kMaxRecords];
+    uint32_t ttls[ResponseCache::kMaxRecords];     // 写入缓存的 TTL
+};
+
+// 校验并遍历上游响应: 只接受完整的标准查询响应 (QDCOUNT=1, TC=0), 收集
+// OPT 之外各记录 TTL 的偏移. 带回答记录的 NOERROR 为肯定应答; NXDOMAIN 与
+// 无回答的 NOERROR 为否定应答, 需在权威区带 SOA, 其 TTL 取 min(TTL, MINIMUM)
+// (RFC 2308), 上限为 max_negative_ttl
+bool scanResponse(const uint8_t* data, size_t len, uint32_t max_ttl, uint32_t max_negative_ttl,
+                  ScannedResponse* out) {
+    if (len < MIN_DNS_QUERY_SIZE) return false;
+    uint16_t flags = readU16(data + 2);
+    out->rcode = flags & 0x000F;
+    if (!(flags & 0x8000) || (flags & 0x7A00) ||                  // QR, OPCODE/TC
+        (out->rcode != dns_rcode::NOERROR && out->rcode != dns_rcode::NXDOMAIN) ||
+        readU16(data + 4) != 1) {
+        return false;
+    }
+
+    out->name_len = plainNameLen(data, len, DNS_HEADER_SIZE);
+    size_t off = DNS_HEADER_SIZE + out->name_len + 4;
+    if (!out->name_len || off > len) return false;
+    out->qtype = readU16(data + off - 4);
+    out->qclass = readU16(data + off - 2);
+    out->edns = 0;
+    out->min_ttl = UINT32_MAX;
+    out->num_ttls = 0;
+
+    size_t answers = readU16(data + 6);
+    size_t authority_end = answers + readU16(data + 8);
+    out->negative = out->rcode == dns_rcode::NXDOMAIN || answers == 0;
+    uint32_t cap = out->negative ? max_negative_ttl : max_ttl;
+    bool soa = false;
+
+    size_t records = authority_end + readU16(data + 10);
+    for (size_t i = 0; i < records; i++) {
+        off = skipName(data, len, off);
+        if (!off || off + RR_FIXED_LEN > len) return false;
+        uint16_t type = readU16(data + off);
+        uint16_t rdlen = readU16(data + off + 8);
+
+        if (type == dns_type::OPT) {
+            out->edns |= EDNS_PRESENT;
+            if (readU16(data + off + 6) & 0x8000) out->edns |= EDNS_DO;
+        } else {
+            if (out->num_ttls == ResponseCache::kMaxRecords) return false;
+            uint32_t ttl = readU32(data + off + 4);
+            if (ttl & 0x80000000u) ttl = 0;  // RFC 2181: 最高位置位视为 0
+
+            // MINIMUM 是 SOA RDATA 的最后 4 字节
+            if (out->negative && !soa && type == dns_type::SOA && i >= answers &&
+                i < authority_end && rdlen >= 22 && off + RR_FIXED_LEN + rdlen <= len) {
+                soa = true;
+                uint32_t minimum = readU32(data + off + RR_FIXED_LEN + rdlen - 4);
+                if (minimum < ttl) ttl = minimum;
+            }
+            if (cap && ttl > cap) ttl = cap;
+            if (ttl < out->min_ttl) out->min_ttl = ttl;
+            out->ttl_offsets[out->num_ttls] = static_cast<uint16_t>(off + 4);
+            out->ttls[out->num_ttls++] = ttl;
+        }
+        off += RR_FIXED_LEN + rdlen;
+        if (off > len) return false;
+    }
+
+    out->end = off;
+    if (out->negative && !soa) return false;
+    return out->min_ttl != 0 && out->min_ttl != UINT32_MAX;
+}
+
+} // anonymous namespace
+
+ResponseCache::ResponseCache(const ResponseCacheOptions& opts) {
+    num_shards_ = roundUpPow2(opts.shards ? opts.shards : 1);
+    size_t per_shard = (static_cast<size_t>(opts.capacity) + num_shards_ - 1) / num_shards_;
+    sets_ = static_cast<uint32_t>((per_shard + kWays - 1) / kWays);
+    if (sets_ == 0) sets_ = 1;
+    entry_size_ = std::clamp<uint32_t>(opts.max_entry_size, MIN_DNS_QUERY_SIZE, 0xFFFF);
+    max_ttl_ = opts.max_ttl;
+    prefetch_percent_ = std::min<uint32_t>(opts.prefetch_percent, 100);
+    stale_window_ns_ = static_cast<uint64_t>(opts.stale_window) * 1000000000ULL;
+    stale_ttl_ = opts.stale_ttl;
+    max_negative_ttl_ = opts.max_negative_ttl;
+    nxdomain_cut_ = opts.nxdomain_cut;
+
+    std::pmr::memory_resource* res = memory_.resource(MemCategory::Cache);
+    size_t slots = static_cast<size_t>(sets_) * kWays;
+    shards_ = std::make_unique<Shard[]>(num_shards_);
+    for (uint32_t i = 0; i < num_shards_; i++) {
+        Shard& s = shards_[i];
+        s.slots = static_cast<Slot*>(res->allocate(slots * sizeof(Slot), alignof(Slot)));
+        s.data = static_cast<uint8_t*>(res->allocate(slots * entry_size_, 8));
+        s.hands = static_cast<uint8_t*>(res->allocate(sets_, 1));
+        std::memset(s.slots, 0, slots * sizeof(Slot));
+        std::memset(s.hands, 0, sets_);
+    }
+}
+
+ResponseCache::~ResponseCache() {
+    std::pmr::memory_resource* res = memory_.resource(MemCategory::Cache);
+    size_t slots = static_cast<size_t>(sets_) * kWays;
+    for (uint32_t i = 0; i < num_shards_; i++) {
+        Shard& s = shards_[i];
+        res->deallocate(s.slots, slots * sizeof(Slot), alignof(Slot));
+        res->deallocate(s.data, slots * entry_size_, 8);
+        res->deallocate(s.hands, sets_, 1);
+    }
+}
+
+uint64_t ResponseCache::makeKey(const uint8_t* lowered, size_t name_len, uint16_t qtype,
+                                uint16_t qclass, uint8_t edns) {
+    uint64_t h = simd().hash(lowered, name_len);
+    h ^= (static_cast<uint64_t>(qtype) << 24 | static_cast<uint64_t>(qclass) << 8 | edns) *
+         0x9E3779B97F4A7C15ULL;
+    h ^= h >> 31;
+    return h ? h : 1;
+}
+
+size_t ResponseCache::findWay(Shard& shard, size_t base, uint64_t key, const uint8_t* lowered,
+                              size_t name_len, uint16_t qtype, uint16_t qclass, uint8_t edns) {
+    for (size_t way = 0; way < kWays; way++) {
+        const Slot& slot = shard.slots[base + way];
+        if (slot.key != key || slot.name_len != name_len || slot.edns != edns) continue;
+
+        // 哈希碰撞时以存储的小写问题为准
+        const uint8_t* q = slotData(shard, base + way) + DNS_HEADER_SIZE;
+        if (std::memcmp(q, lowered, name_len) == 0 && readU16(q + name_len) == qtype &&
+            readU16(q + name_len + 2) == qclass) {
+            return way;
+        }
+    }
+    return kWays;
+}
+
+size_t ResponseCache::lookup(
+    const uint8_t* query,
+    size_t query_len,
+    const DNSParseResult& parsed,
+    uint64_t now_ns,
+    uint8_t* response,
+    size_t response_buf_size,
+    bool* refresh
+) {
+    if (refresh) *refresh = false;
+
+    // 问题名带压缩指针的查询不走缓存
+    size_t name_len = parsed.question.name_wire_len;
+    if (parsed.question_end != DNS_HEADER_SIZE + name_len + 4) {
+        return 0;
+    }
+
+    // 先取出客户端的字段: response 可能与 query 是同一缓冲区
+    uint8_t name[MAX_DOMAIN_LENGTH + 1];
+    uint8_t lowered[MAX_DOMAIN_LENGTH + 1];
+    std::memcpy(name, query + DNS_HEADER_SIZE, name_len);
+    simd().lower_copy(reinterpret_cast<char*>(lowered), name, name_len);
+    uint16_t id = parsed.id;
+    uint16_t rd = parsed.flags & 0x0100;
+    uint16_t qtype = parsed.question.qtype;
+    uint16_t qclass = parsed.question.qclass;
+    uint8_t edns = DNSParser::queryEdns(query, query_len, parsed);
+
+    uint64_t key = makeKey(lowered, name_len, qtype, qclass, edns);
+    Shard& shard = shardOf(key);
+    size_t base = setOf(key) * kWays;
+
+    {
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        size_t way = findWay(shard, base, key, lowered, name_len, qtype, qclass, edns);
+        Slot* slot = way == kWays ? nullptr : &shard.slots[base + way];
+        bool stale = slot && now_ns >= slot->expires_ns;
+        if (stale && now_ns - slot->expires_ns >= stale_window_ns_) {
+            slot->key = 0;
+            shard.expired++;
+            slot = nullptr;
+        }
+
+        if (slot && response_buf_size >= slot->len) {
+            std::memcpy(response, slotData(shard, base + way), slot->len);
+            slot->referenced = 1;
+            shard.hits++;
+            patchClient(response, id, rd, name, name_len);
+
+            // 存储的 TTL 都不小于最小 TTL, 未过期时 elapsed 不会超过它们;
+            // 过期应答统一使用 stale_ttl
+            if (stale) {
+                shard.stale_hits++;
+                for (uint8_t i = 0; i < slot->num_ttls; i++) {
+                    writeU32(response + slot->ttl_offsets[i], stale_ttl_);
+                }
+            } else {
+                decrementTtls(response, *slot, now_ns);
+            }
+
+            // 预取窗口: 剩余时间不足原 TTL 的 prefetch_percent%
+            if (refresh) {
+                uint64_t ttl_ns = slot->expires_ns - slot->inserted_ns;
+                bool want = stale || (prefetch_percent_ &&
+                                      slot->expires_ns - now_ns < ttl_ns / 100 * prefetch_percent_);
+                if (want &&
+                    (slot->refresh_ns == 0 || now_ns - slot->refresh_ns >= kRefreshIntervalNs)) {
+                    slot->refresh_ns = now_ns;
+                    shard.prefetches++;
+                    *refresh = true;
+                }
+            }
+            return slot->len;
+        }
+        if (!nxdomain_cut_ || (edns & EDNS_DO) || !cut_inserts_.load(std::memory_order_relaxed)) {
+            shard.misses++;
+            return 0;
+        }
+    }
+
+    // 问题名或其祖先已知不存在 (RFC 8020)
+    if (size_t len = lookupCut(name, lowered, name_len, qtype, qclass, id, rd, edns, now_ns,
+                               response, response_buf_size)) {
+        return len;
+    }
+    std::lock_guard<std::mutex> lock(shard.mutex);
+    shard.misses++;
+    return 0;
+}
+
+size_t ResponseCache::lookupCut(const uint8_t* name, const uint8_t* lowered, size_t name_len,
+                                uint16_t qtype, uint16_t qclass, uint16_t id, uint16_t rd,
+                                uint8_t edns, uint64_t now_ns, uint8_t* response,
+                                size_t response_buf_size) {
+    size_t question_end = DNS_HEADER_SIZE + name_len + 4;
+
+    // 从完整问题名开始, 逐级去掉最左标签, 不查根
+    for (size_t off = 0; off + 1 < name_len; off += 1 + lowered[off]) {
+        const uint8_t* node = lowered + off;
+        size_t node_len = name_len - off;
+        uint64_t key = makeKey(node, node_len, kCutType, qclass, 0);
+        Shard& shard = shardOf(key);
+        size_t base = setOf(key) * kWays;
+
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        size_t way = findWay(shard, base, key, node, node_len, kCutType, qclass, 0);
+        if (way == kWays) continue;
+        Slot& slot = shard.slots[base + way];
+        if (now_ns >= slot.expires_ns) {
+            slot.key = 0;
+            shard.expired++;
+            continue;
+        }
+
+        // 截断条目: 头部 + 节点问题 + 非压缩 SOA, 换上客户端的问题
+        const uint8_t* data = slotData(shard, base + way);
+        size_t soa_off = DNS_HEADER_SIZE + node_len + 4;
+        size_t soa_len = slot.len - soa_off;
+        size_t total = question_end + soa_len + ((edns & EDNS_PRESENT) ? 11 : 0);
+        if (total > response_buf_size) return 0;
+
+        std::memcpy(response, data, DNS_HEADER_SIZE);
+        writeU16(response + 10, (edns & EDNS_PRESENT) ? 1 : 0);
+        patchClient(response, id, rd, name, name_len);
+        writeU16(response + question_end - 4, qtype);
+        writeU16(response + question_end - 2, qclass);
+        std::memcpy(response + question_end, data + soa_off, soa_len);
+
+        uint8_t* ttl = response + question_end + (slot.ttl_offsets[0] - soa_off);
+        uint32_t elapsed = static_cast<uint32_t>((now_ns - slot.inserted_ns) / 1000000000ULL);
+        writeU32(ttl, readU32(ttl) - elapsed);
+
+        if (edns & EDNS_PRESENT) {
+            uint8_t* opt = response + question_end + soa_len;
+            opt[0] = 0;
+            writeU16(opt + 1, dns_type::OPT);
+            writeU16(opt + 3, 1232);
+            writeU32(opt + 5, 0);
+            writeU16(opt + 9, 0);
+        }
+        slot.referenced = 1;
+        shard.cut_hits++;
+        return total;
+    }
+    return 0;
+}
+
+void ResponseCache::patchClient(uint8_t* response, uint16_t id, uint16_t rd, const uint8_t* name,
+                                size_t name_len) {
+    // 客户端 ID、RD 位与问题名大小写 (0x20 编码)
+    writeU16(response, id);
+    writeU16(response + 2, static_cast<uint16_t>((readU16(response + 2) & ~0x0100) | rd));
+    std::memcpy(response + DNS_HEADER_SIZE, name, name_len);
+}
+
+void ResponseCache::decrementTtls(uint8_t* response, const Slot& slot, uint64_t now_ns) {
+    uint32_t elapsed = static_cast<uint32_t>((now_ns - slot.inserted_ns) / 1000000000ULL);
+    if (!elapsed) return;
+    for (uint8_t i = 0; i < slot.num_ttls; i++) {
+        uint8_t* p = response + slot.ttl_offsets[i];
+        writeU32(p, readU32(p) - elapsed);
+    }
+}
+
+bool ResponseCache::insert(const uint8_t* response, size_t len, uint64_t now_ns) {
+    ScannedResponse scan;
+    if (!scanResponse(response, len, max_ttl_, max_negative_ttl_, &scan) ||
+        scan.end > entry_size_) {
+        rejected_.fetch_add(1, std::memory_order_relaxed);
+        return false;
+    }
+
+    uint8_t lowered[MAX_DOMAIN_LENGTH + 1];
+    simd().lower_copy(reinterpret_cast<char*>(lowered), response + DNS_HEADER_SIZE,
+                      scan.name_len);
+    store(response, scan.end, lowered, scan.name_len, scan.qtype, scan.qclass, scan.edns,
+          scan.ttl_offsets, scan.ttls, scan.num_ttls, scan.min_ttl, scan.negative, now_ns);
+
+    // 不带 CNAME 链的 NXDOMAIN: 问题名本身不存在, 记为截断点
+    if (nxdomain_cut_ && scan.rcode == dns_rcode::NXDOMAIN && readU16(response + 6) == 0) {
+        insertCut(response, len, lowered, scan.name_len, scan.qclass, now_ns);
+    }
+    return true;
+}
+
+void ResponseCache::insertCut(const uint8_t* response, size_t len, const uint8_t* lowered,
+                              size_t name_len, uint16_t qclass, uint64_t now_ns) {
+    DNSParseResult parsed;
+    DNSSoaRecord soa;
+    if (DNSParser::parse(response, len, &parsed) != Error::Success ||
+        DNSParser::findAuthoritySoa(response, len, parsed, &soa) != Error::Success) {
+        return;
+    }
+    uint32_t ttl = soa.negativeTtl();
+    if (max_negative_ttl_ && ttl > max_negative_ttl_) ttl = max_negative_ttl_;
+    size_t question_end = DNS_HEADER_SIZE + name_len + 4;
+    size_t total = question_end + soa.owner_len + RR_FIXED_LEN + soa.mname_len +
+                   soa.rname_len + 20;
+    if (ttl == 0 || total > entry_size_) return;
+
+    // 头部沿用上游标志, 去掉 AA/AD: 截断应答是推导出来的
+    uint8_t entry[DNS_HEADER_SIZE + (MAX_DOMAIN_LENGTH + 1) * 4 + 4 + RR_FIXED_LEN + 20];
+    std::memcpy(entry, response, 4);
+    writeU16(entry + 2, static_cast<uint16_t>(readU16(entry + 2) & ~0x0420));
+    writeU16(entry + 4, 1);
+    writeU16(entry + 6, 0);
+    writeU16(entry + 8, 1);
+    writeU16(entry + 10, 0);
+    std::memcpy(entry + DNS_HEADER_SIZE, lowered, name_len);
+    writeU16(entry + question_end - 4, kCutType);
+    writeU16(entry + question_end - 2, qclass);
+
+    uint8_t* p = entry + question_end;
+    std::memcpy(p, soa.owner, soa.owner_len);
+    p += soa.owner_len;
+    uint16_t ttl_offset = static_cast<uint16_t>(p + 4 - entry);
+    writeU16(p, dns_type::SOA);
+    writeU16(p + 2, soa.rclass);
+    writeU32(p + 4, ttl);
+    writeU16(p + 8, static_cast<uint16_t>(soa.mname_len + soa.rname_len + 20));
+    p += RR_FIXED_LEN;
+    std::memcpy(p, soa.mname, soa.mname_len);
+    p += soa.mname_len;
+    std::memcpy(p, soa.rname, soa.rname_len);
+    p += soa.rname_len;
+    writeU32(p, soa.serial);
+    writeU32(p + 4, soa.refresh);
+    writeU32(p + 8, soa.retry);
+    writeU32(p + 12, soa.expire);
+    writeU32(p + 16, soa.minimum);
+
+    store(entry, total, lowered, name_len, kCutType, qclass, 0, &ttl_offset, &ttl, 1, ttl, false,
+          now_ns);
+    cut_inserts_.fetch_add(1, std::memory_order_relaxed);
+}
+
+void ResponseCache::store(const uint8_t* data, size_t len, const uint8_t* lowered,
+                          size_t name_len, uint16_t qtype, uint16_t qclass, uint8_t edns,
+                          const uint16_t* ttl_offsets, const uint32_t* ttls, size_t num_ttls,
+                          uint32_t min_ttl, bool negative, uint64_t now_ns) {
+    uint64_t key = makeKey(lowered, name_len, qtype, qclass, edns);
+    Shard& shard = shardOf(key);
+    size_t set = setOf(key);
+    size_t base = set * kWays;
+
+    std::lock_guard<std::mutex> lock(shard.mutex);
+
+    // 同一问题覆盖原槽; 否则取空槽或过期槽, 都没有时按 CLOCK 淘汰
+    size_t way = findWay(shard, base, key, lowered, name_len, qtype, qclass, edns);
+    if (way == kWays) {
+        for (size_t w = 0; w < kWays; w++) {
+            const Slot& s = shard.slots[base + w];
+            if (s.key == 0 || now_ns >= s.expires_ns) {
+                way = w;
+                break;
+            }
+        }
+    }
+    if (way == kWays) {
+        uint8_t& hand = shard.hands[set];
+        while (shard.slots[base + hand].referenced) {
+            shard.slots[base + hand].referenced = 0;
+            hand = static_cast<uint8_t>((hand + 1) % kWays);
+        }
+        way = hand;
+        hand = static_cast<uint8_t>((hand + 1) % kWays);
+        shard.evictions++;
+    }
+
+    // 尾部多余字节不保存; 问题名存小写, TTL 写入截断后的值
+    Slot& slot = shard.slots[base + way];
+    uint8_t* entry = slotData(shard, base + way);
+    std::memcpy(entry, data, len);
+    std::memcpy(entry + DNS_HEADER_SIZE, lowered, name_len);
+    for (size_t i = 0; i < num_ttls; i++) {
+        writeU32(entry + ttl_offsets[i], ttls[i]);
+    }
+
+    slot.key = key;
+    slot.inserted_ns = now_ns;
+    slot.expires_ns = now_ns + static_cast<uint64_t>(min_ttl) * 1000000000ULL;
+    slot.refresh_ns = 0;
+    slot.len = static_cast<uint16_t>(len);
+    slot.name_len = static_cast<uint8_t>(name_len);
+    slot.edns = edns;
+    slot.num_ttls = static_cast<uint8_t>(num_ttls);
+    slot.referenced = 0;
+    std::memcpy(slot.ttl_offsets, ttl_offsets, num_ttls * sizeof(uint16_t));
+    shard.inserts++;
+    if (negative) shard.negative_inserts++;
+}
+
+size_t ResponseCache::buildRefreshQuery(const uint8_t* response, size_t len, uint16_t id,
+                                        uint8_t* out, size_t out_size) {
+    ScannedResponse scan;
+    if (!scanResponse(response, len, 0, 0, &scan)) return 0;
+
+    size_t question_end = DNS_HEADER_SIZE + scan.name_len + 4;
+    size_t total = question_end + ((scan.edns & EDNS_PRESENT) ? 11 : 0);
+    if (total > out_size) return 0;
+
+    std::memcpy(out + DNS_HEADER_SIZE, response + DNS_HEADER_SIZE,
+                question_end - DNS_HEADER_SIZE);
+    writeU16(out, id);
+    writeU16(out + 2, 0x0100);                     // RD
+    writeU16(out + 4, 1);
+    writeU16(out + 6, 0);
+    writeU16(out + 8, 0);
+    writeU16(out + 10, (scan.edns & EDNS_PRESENT) ? 1 : 0);
+    if (scan.edns & EDNS_PRESENT) {
+        uint8_t* opt = out + question_end;
+        opt[0] = 0;                                 // 根名
+        writeU16(opt + 1, dns_type::OPT);
+        writeU16(opt + 3, 1232);                    // UDP 载荷大小
+        writeU32(opt + 5, (scan.edns & EDNS_DO) ? 0x8000 : 0);
+        writeU16(opt + 9, 0);
+    }
+    return total;
+}
+
+void ResponseCache::clear() {
+    size_t slots = static_cast<size_t>(sets_) * kWays;
+    for (uint32_t i = 0; i < num_shards_; i++) {
+        Shard& s = shards_[i];
+        std::lock_guard<std::mutex> lock(s.mutex);
+        for (size_t j = 0; j < slots; j++) {
+            s.slots[j].key = 0;
+            s.slots[j].referenced = 0;
+        }
+    }
+}
+
+ResponseCacheStats ResponseCache::stats() const {
+    ResponseCacheStats total{};
+    total.rejected = rejected_.load(std::memory_order_relaxed);
+    size_t slots = static_cast<size_t>(sets_) * kWays;
+    for (uint32_t i = 0; i < num_shards_; i++) {
+        Shard& s = shards_[i];
+        std::lock_guard<std::mutex> lock(s.mutex);
+        total.hits += s.hits;
+        total.misses += s.misses;
+        total.stale_hits += s.stale_hits;
+        total.prefetches += s.prefetches;
+        total.negative_inserts += s.negative_inserts;
+        total.cut_hits += s.cut_hits;
+        total.expired += s.expired;
+        total.inserts += s.inserts;
+        total.evictions += s.evictions;
+        for (size_t j = 0; j < slots; j++) {
+            if (s.slots[j].key) total.entries++;
+        }
+    }
+    return total;
+}
+
+} // namespace xdp_dns
@@ -0,0 +1,434 @@
+#include "xdp_dns/response_writer.hpp"
+#include "xdp_dns/probes.hpp"
+#include <cstring>
+
+namespace xdp_dns {
+
+namespace {
+
+constexpr uint32_t kRootHash = 2166136261u;
+constexpr size_t kMaxPointerHops = 16;
+
+inline uint8_t lowerAscii(uint8_t c) {
+    return (c >= 'A' && c <= 'Z') ? static_cast<uint8_t>(c | 0x20) : c;
+}
+
+// 后缀哈希: 在父后缀的哈希上混入本标签的长度与首尾字符 (小写). 命中后
+// 还要逐字节确认, 哈希只需便宜地筛掉大部分候选
+inline uint32_t mixLabel(uint32_t h, const uint8_t* label) {
+    uint32_t v = label[0];
+    if (v) v |= uint32_t(lowerAscii(label[1])) << 8 | uint32_t(lowerAscii(label[v])) << 16;
+    return (h ^ v) * 16777619u;
+}
+
+// 非压缩名字的标签偏移, 返回标签数; 格式错误返回 SIZE_MAX
+size_t labelOffsets(const uint8_t* name, size_t* offsets) {
+    size_t off = 0, n = 0;
+    while (name[off] != 0) {
+        if (name[off] > MAX_LABEL_LENGTH || n == MAX_LABELS ||
+            off + name[off] + 1 >= MAX_DOMAIN_LENGTH) {
+            return SIZE_MAX;
+        }
+        offsets[n++] = off;
+        off += name[off] + 1;
+    }
+    offsets[n] = off;   // 根
+    return n;
+}
+
+} // anonymous namespace
+
+// ==================== ResponseWriter ====================
+
+bool ResponseWriter::begin(const uint8_t* query, const DNSParseResult& parsed,
+                           uint8_t* response, size_t capacity) {
+    buf_ = response;
+    capacity_ = capacity;
+    pos_ = 0;
+    blob_ = false;
+    failed_ = false;
+    authority_ = false;
+    aa_ = false;
+    rcode_ = dns_rcode::NOERROR;
+    an_count_ = 0;
+    ns_count_ = 0;
+    dict_len_ = 0;
+    num_relocs_ = 0;
+    question_ = 0;
+
+    if (capacity < parsed.total_consumed) return fail();
+
+    // 复制头部与问题 (response 可与 query 为同一缓冲区)
+    std::memmove(response, query, parsed.total_consumed);
+    pos_ = parsed.total_consumed;
+
+    DNSHeader* hdr = reinterpret_cast<DNSHeader*>(response);
+    uint16_t flags = parsed.header->getFlags();
+    flags |= 0x8000;  // QR = 1
+    flags |= 0x0080;  // RA = 1
+    flags &= 0xFFF0;
+    hdr->flags = htons(flags);
+    hdr->an_count = 0;
+    hdr->ns_count = 0;
+    hdr->ar_count = 0;
+
+    question_ = parsed.question.name_offset;
+    return true;
+}
+
+void ResponseWriter::rememberQuestion() {
+    // 登记问题名的各个后缀; 只追加预编译记录时用不到, 推迟到第一次写名字
+    size_t qname = question_;
+    question_ = 0;
+    size_t offsets[MAX_LABELS + 1];
+    size_t n = labelOffsets(buf_ + qname, offsets);
+    if (n == SIZE_MAX) return;
+    uint32_t hashes[MAX_LABELS + 1];
+    hashes[n] = kRootHash;
+    for (size_t i = n; i-- > 0;) hashes[i] = mixLabel(hashes[i + 1], buf_ + qname + offsets[i]);
+    for (size_t i = 0; i < n; i++) remember(hashes[i], qname + offsets[i]);
+}
+
+void ResponseWriter::beginBlob(uint8_t* buf, size_t capacity) {
+    buf_ = buf;
+    capacity_ = capacity;
+    pos_ = 0;
+    blob_ = true;
+    failed_ = false;
+    authority_ = false;
+    aa_ = false;
+    rcode_ = dns_rcode::NOERROR;
+    an_count_ = 0;
+    ns_count_ = 0;
+    dict_len_ = 0;
+    num_relocs_ = 0;
+    question_ = 0;
+}
+
+void ResponseWriter::remember(uint32_t hash, size_t offset) {
+    // 指针只能指向前 16KB
+    if (dict_len_ == kDictSize || offset >= 0x4000) return;
+    dict_[dict_len_++] = DictEntry{hash, static_cast<uint16_t>(offset)};
+}
+
+bool ResponseWriter::suffixEquals(const uint8_t* name, size_t offset) const {
+    size_t hops = 0;
+    size_t i = 0;
+    while (offset < pos_) {
+        uint8_t len = buf_[offset];
+        if ((len & 0xC0) == 0xC0) {
+            if (offset + 1 >= pos_ || ++hops > kMaxPointerHops) return false;
+            offset = static_cast<size_t>(len & 0x3F) << 8 | buf_[offset + 1];
+            continue;
+        }
+        if (len != name[i]) return false;
+        if (len == 0) return true;
+        if (offset + 1 + len > pos_) return false;
+        for (size_t k = 1; k <= len; k++) {
+            if (lowerAscii(buf_[offset + k]) != lowerAscii(name[i + k])) return false;
+        }
+        offset += len + 1;
+        i += len + 1;
+    }
+    return false;
+}
+
+void ResponseWriter::writePointer(size_t target) {
+    if (blob_) {
+        // blob 内的目标以 blob 起点为基准, addBlob 时加上写入位置
+        if (num_relocs_ == kMaxRelocs) {
+            fail();
+            return;
+        }
+        relocs_[num_relocs_++] = static_cast<uint16_t>(pos_);
+    }
+    writeU16(buf_ + pos_, static_cast<uint16_t>(0xC000 | target));
+    pos_ += 2;
+}
+
+bool ResponseWriter::writeName(const uint8_t* name) {
+    if (question_) rememberQuestion();
+
+    size_t offsets[MAX_LABELS + 1];
+    size_t n = labelOffsets(name, offsets);
+    if (n == SIZE_MAX) return fail();
+
+    uint32_t hashes[MAX_LABELS + 1];
+    hashes[n] = kRootHash;
+    for (size_t i = n; i-- > 0;) hashes[i] = mixLabel(hashes[i + 1], name + offsets[i]);
+
+    // 最长的已登记后缀
+    size_t match = n;
+    size_t target = 0;
+    for (size_t i = 0; i < n && match == n; i++) {
+        for (size_t d = 0; d < dict_len_; d++) {
+            if (dict_[d].hash == hashes[i] && suffixEquals(name + offsets[i], dict_[d].offset)) {
+                match = i;
+                target = dict_[d].offset;
+                break;
+            }
+        }
+    }
+
+    size_t prefix = offsets[match];
+    if (pos_ + prefix + (match < n ? 2 : 1) > capacity_) return fail();
+
+    for (size_t i = 0; i < match; i++) remember(hashes[i], pos_ + offsets[i]);
+    std::memcpy(buf_ + pos_, name, prefix);
+    pos_ += prefix;
+    if (match < n) {
+        writePointer(target);
+    } else {
+        buf_[pos_++] = 0;
+    }
+    return !failed_;
+}
+
+bool ResponseWriter::beginRecord(const uint8_t* owner, uint16_t type, uint32_t ttl,
+                                 size_t rdata_len) {
+    if (failed_) return false;
+    size_t index = an_count_ + ns_count_;
+    if (blob_ && index == kMaxRecords) return fail();
+
+    size_t start = pos_;
+    if (owner) {
+        if (!writeName(owner)) return false;
+    } else {
+        if (pos_ + 2 > capacity_) return fail();
+        writeU16(buf_ + pos_, static_cast<uint16_t>(0xC000 | sizeof(DNSHeader)));  // 问题名
+        pos_ += 2;
+    }
+    if (pos_ + 10 + rdata_len > capacity_) return fail();
+
+    writeU16(buf_ + pos_, type);
+    writeU16(buf_ + pos_ + 2, dns_class::IN);
+    writeU32(buf_ + pos_ + 4, ttl);
+    writeU16(buf_ + pos_ + 8, static_cast<uint16_t>(rdata_len));
+    pos_ += 10;
+
+    if (blob_) {
+        starts_[index] = static_cast<uint16_t>(start);
+        types_[index] = type;
+    }
+    if (authority_) {
+        ns_count_++;
+    } else {
+        an_count_++;
+    }
+    return true;
+}
+
+bool ResponseWriter::addA(const uint8_t* owner, uint32_t ttl, uint32_t ip) {
+    if (!beginRecord(owner, dns_type::A, ttl, 4)) return false;
+    std::memcpy(buf_ + pos_, &ip, 4);
+    pos_ += 4;
+    return true;
+}
+
+bool ResponseWriter::addAAAA(const uint8_t* owner, uint32_t ttl, const uint8_t* ip6) {
+    if (!beginRecord(owner, dns_type::AAAA, ttl, 16)) return false;
+    std::memcpy(buf_ + pos_, ip6, 16);
+    pos_ += 16;
+    return true;
+}
+
+bool ResponseWriter::addCNAME(const uint8_t* owner, uint32_t ttl, const uint8_t* target) {
+    if (!beginRecord(owner, dns_type::CNAME, ttl, 0)) return false;
+    size_t rdata = pos_;
+    if (!writeName(target)) return false;
+    writeU16(buf_ + rdata - 2, static_cast<uint16_t>(pos_ - rdata));
+    return true;
+}
+
+bool ResponseWriter::addPTR(const uint8_t* owner, uint32_t ttl, const uint8_t* target) {
+    if (!beginRecord(owner, dns_type::PTR, ttl, 0)) return false;
+    size_t rdata = pos_;
+    if (!writeName(target)) return false;
+    writeU16(buf_ + rdata - 2, static_cast<uint16_t>(pos_ - rdata));
+    return true;
+}
+
+bool ResponseWriter::addTXT(const uint8_t* owner, uint32_t ttl, const char* text, size_t len) {
+    // 按 255 字节切成多个 character-string
+    size_t chunks = len == 0 ? 1 : (len + 254) / 255;
+    size_t rdata_len = len + chunks;
+    if (rdata_len > UINT16_MAX) return fail();
+    if (!beginRecord(owner, dns_type::TXT, ttl, rdata_len)) return false;
+
+    for (size_t done = 0, c = 0; c < chunks; c++) {
+        size_t n = len - done < 255 ? len - done : 255;
+        buf_[pos_++] = static_cast<uint8_t>(n);
+        std::memcpy(buf_ + pos_, text + done, n);
+        pos_ += n;
+        done += n;
+    }
+    return true;
+}
+
+bool ResponseWriter::addRaw(const uint8_t* owner, uint16_t type, uint32_t ttl,
+                            const uint8_t* rdata, size_t rdata_len) {
+    if (rdata_len > UINT16_MAX) return fail();
+    if (!beginRecord(owner, type, ttl, rdata_len)) return false;
+    std::memcpy(buf_ + pos_, rdata, rdata_len);
+    pos_ += rdata_len;
+    return true;
+}
+
+bool ResponseWriter::addBlob(const RRBlob& blob, uint32_t rotation) {
+    if (failed_ || blob_ || authority_) return fail();
+    size_t len = blob.wire.size();
+    if (pos_ + len > capacity_) return fail();
+    if (!blob.relocs.empty() && pos_ + len > 0x3FFF) return fail();
+
+    uint8_t* dst = buf_ + pos_;
+    const uint8_t* src = blob.wire.data();
+    if (blob.rotate_count > 1) {
+        // 等长记录 [k, n) 接 [0, k)
+        size_t k = rotation % blob.rotate_count;
+        size_t head = blob.rotate_offset;
+        size_t size = blob.rotate_size;
+        size_t region = size * blob.rotate_count;
+        std::memcpy(dst, src, head);
+        std::memcpy(dst + head, src + head + k * size, region - k * size);
+        std::memcpy(dst + head + region - k * size, src + head, k * size);
+        std::memcpy(dst + head + region, src + head + region, len - head - region);
+    } else {
+        std::memcpy(dst, src, len);
+    }
+
+    for (uint16_t r : blob.relocs) {
+        uint16_t target = readU16(dst + r) & 0x3FFF;
+        writeU16(dst + r, static_cast<uint16_t>(0xC000 | (target + pos_)));
+    }
+    pos_ += len;
+    an_count_ += blob.count;
+    ns_count_ += blob.ns_count;
+    return true;
+}
+
+size_t ResponseWriter::finish() {
+    if (failed_ || blob_) return 0;
+
+    DNSHeader* hdr = reinterpret_cast<DNSHeader*>(buf_);
+    uint16_t flags = (ntohs(hdr->flags) & 0xFBF0) | rcode_;
+    if (aa_) flags |= 0x0400;
+    hdr->flags = htons(flags);
+    hdr->an_count = htons(an_count_);
+    hdr->ns_count = htons(ns_count_);
+
+    XDP_DNS_PROBE3(response__built, rcode_, an_count_, pos_);
+    return pos_;
+}
+
+bool ResponseWriter::finishBlob(RRBlob* out) const {
+    if (failed_ || !blob_) return false;
+
+    out->wire.assign(buf_, buf_ + pos_);
+    out->relocs.assign(relocs_, relocs_ + num_relocs_);
+    out->count = an_count_;
+    out->ns_count = ns_count_;
+    out->rotate_offset = 0;
+    out->rotate_size = 0;
+    out->rotate_count = 0;
+    if (an_count_ < 2) return true;
+
+    // 回答区末尾连续的同类型等长地址记录可轮转
+    size_t total = an_count_ + ns_count_;
+    auto sizeOf = [&](size_t i) {
+        return (i + 1 < total ? starts_[i + 1] : pos_) - starts_[i];
+    };
+    size_t last = an_count_ - 1;
+    uint16_t type = types_[last];
+    if (type != dns_type::A && type != dns_type::AAAA) return true;
+    // 所有者与固定部分须逐字节相同, 重定位项在各条记录中的位置才一致
+    size_t size = sizeOf(last);
+    size_t fixed = size - (type == dns_type::A ? 4 : 16);
+    size_t first = last;
+    while (first > 0 && types_[first - 1] == type && sizeOf(first - 1) == size &&
+           std::memcmp(buf_ + starts_[first - 1], buf_ + starts_[last], fixed) == 0) {
+        first--;
+    }
+    if (first == last) return true;
+
+    // 轮转区内不能有被指针引用的名字
+    size_t begin = starts_[first];
+    size_t end = begin + size * (last - first + 1);
+    for (size_t i = 0; i < num_relocs_; i++) {
+        size_t target = readU16(buf_ + relocs_[i]) & 0x3FFF;
+        if (target >= begin && target < end) return true;
+    }
+    out->rotate_offset = static_cast<uint16_t>(begin);
+    out->rotate_size = static_cast<uint16_t>(size);
+    out->rotate_count = static_cast<uint16_t>(last - first + 1);
+    return true;
+}
+
+size_t ResponseWriter::encodeName(const char* name, size_t len, uint8_t* out, size_t out_size) {
+    if (len > 0 && name[len - 1] == '.') len--;
+    size_t wire_len = len == 0 ? 1 : len + 2;
+    if (wire_len > MAX_DOMAIN_LENGTH || wire_len > out_size) return 0;
+
+    size_t pos = 0, start = 0;
+    for (size_t i = 0; len > 0 && i <= len; i++) {
+        if (i < len && name[i] != '.') continue;
+        size_t label = i - start;
+        if (label == 0 || label > MAX_LABEL_LENGTH) return 0;
+        out[pos++] = static_cast<uint8_t>(label);
+        std::memcpy(out + pos, name + start, label);
+        pos += label;
+        start = i + 1;
+    }
+    out[pos++] = 0;
+    return pos;
+}
+
+// ==================== RedirectAnswer ====================
+
+bool RedirectAnswer::compile(const uint8_t* cname, const uint32_t* v4, size_t num_v4,
+                             const uint8_t* v6, size_t num_v6, uint32_t ttl,
+                             RedirectAnswer* out) {
+    uint8_t buf[4096];
+    ResponseWriter w;
+
+    // 地址记录的所有者: 有 CNAME 时为其目标 (压缩为指向 CNAME RDATA 的指针)
+    w.beginBlob(buf, sizeof(buf));
+    if (cname) w.addCNAME(nullptr, ttl, cname);
+    for (size_t i = 0; i < num_v4; i++) w.addA(cname, ttl, v4[i]);
+    if (!w.finishBlob(&out->a)) return false;
+
+    w.beginBlob(buf, sizeof(buf));
+    if (cname) w.addCNAME(nullptr, ttl, cname);
+    for (size_t i = 0; i < num_v6; i++) w.addAAAA(cname, ttl, v6 + i * 16);
+    if (!w.finishBlob(&out->aaaa)) return false;
+
+    w.beginBlob(buf, sizeof(buf));
+    if (cname) w.addCNAME(nullptr, ttl, cname);
+    return w.finishBlob(&out->other);
+}
+
+// ==================== AnswerTable ====================
+
+uint16_t AnswerTable::intern(RedirectAnswer&& answer) {
+    // 去重键: 三组记录的全部字段
+    std::string key;
+    for (const RRBlob* blob : {&answer.a, &answer.aaaa, &answer.other}) {
+        uint16_t fields[] = {blob->count, blob->rotate_offset, blob->rotate_size,
+                             blob->rotate_count, static_cast<uint16_t>(blob->relocs.size()),
+                             static_cast<uint16_t>(blob->wire.size())};
+        key.append(reinterpret_cast<const char*>(fields), sizeof(fields));
+        key.append(reinterpret_cast<const char*>(blob->relocs.data()),
+                   blob->relocs.size() * sizeof(uint16_t));
+        key.append(reinterpret_cast<const char*>(blob->wire.data()), blob->wire.size());
+    }
+
+    auto it = index_.find(key);
+    if (it != index_.end()) return it->second;
+    if (answers_.size() >= 65535) return 0;
+
+    answers_.push_back(std::make_unique<RedirectAnswer>(std::move(answer)));
+    uint16_t handle = static_cast<uint16_t>(answers_.size());
+    index_.emplace(std::move(key), handle);
+    return handle;
+}
+
+} // namespace xdp_dns
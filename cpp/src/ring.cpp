@@ -0,0 +1,214 @@
+#include "xdp_dns/ring.hpp"
+#include "xdp_dns/stats.hpp"
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <cstddef>
+#include <cstring>
+
+namespace xdp_dns {
+
+namespace {
+
+static_assert(sizeof(XDPDNSRingMsg) == 320, "XDPDNSRingMsg must be 5 cache lines");
+static_assert(sizeof(XDPDNSRingHeader) == 192, "XDPDNSRingHeader must be 3 cache lines");
+static_assert(offsetof(XDPDNSRingHeader, head) == 64, "head must start a cache line");
+static_assert(offsetof(XDPDNSRingHeader, tail) == 128, "tail must start a cache line");
+static_assert(offsetof(XDPDNSRingRegion, control) == 64, "region header must be 64 bytes");
+
+constexpr uint32_t kMaxCapacity = 1u << 16;    // 区域大小需放得进 uint32_t size
+
+// 槽数组必须落在映射范围内
+bool ringFits(const XDPDNSRingHeader& h, size_t size) {
+    uint64_t cap = h.capacity;
+    return cap && (cap & (cap - 1)) == 0 && cap <= kMaxCapacity &&
+           h.slots_offset >= sizeof(XDPDNSRingRegion) &&
+           h.slots_offset + cap * sizeof(XDPDNSRingMsg) <= size;
+}
+
+uint32_t roundUpPow2(uint32_t v) {
+    if (v <= 1) return 1;
+    return 1u << (32 - __builtin_clz(v - 1));
+}
+
+} // anonymous namespace
+
+// ==================== ShmRing ====================
+
+ShmRing::ShmRing(XDPDNSRingHeader* header, XDPDNSRingMsg* slots)
+    : header_(header), slots_(slots), mask_(header->capacity - 1) {}
+
+bool ShmRing::push(const XDPDNSRingMsg& msg) {
+    uint64_t head = __atomic_load_n(&header_->head, __ATOMIC_RELAXED);
+    if (head - cached_peer_ > mask_) {
+        cached_peer_ = __atomic_load_n(&header_->tail, __ATOMIC_ACQUIRE);
+        if (head - cached_peer_ > mask_) {
+            __atomic_store_n(&header_->dropped,
+                             __atomic_load_n(&header_->dropped, __ATOMIC_RELAXED) + 1,
+                             __ATOMIC_RELAXED);
+            return false;
+        }
+    }
+
+    std::memcpy(&slots_[head & mask_], &msg, sizeof(msg));
+    __atomic_store_n(&header_->head, head + 1, __ATOMIC_RELEASE);
+    return true;
+}
+
+bool ShmRing::pop(XDPDNSRingMsg* msg) {
+    uint64_t tail = __atomic_load_n(&header_->tail, __ATOMIC_RELAXED);
+    // >=: 新建的视图 cached_peer_ 为 0, 不能据此认为有数据
+    if (tail >= cached_peer_) {
+        cached_peer_ = __atomic_load_n(&header_->head, __ATOMIC_ACQUIRE);
+        if (tail >= cached_peer_) return false;
+    }
+
+    std::memcpy(msg, &slots_[tail & mask_], sizeof(*msg));
+    __atomic_store_n(&header_->tail, tail + 1, __ATOMIC_RELEASE);
+    return true;
+}
+
+size_t ShmRing::size() const {
+    uint64_t tail = __atomic_load_n(&header_->tail, __ATOMIC_ACQUIRE);
+    uint64_t head = __atomic_load_n(&header_->head, __ATOMIC_ACQUIRE);
+    return head >= tail ? static_cast<size_t>(head - tail) : 0;
+}
+
+uint64_t ShmRing::dropped() const {
+    return __atomic_load_n(&header_->dropped, __ATOMIC_RELAXED);
+}
+
+// ==================== RingChannel ====================
+
+RingChannel::~RingChannel() {
+    close();
+}
+
+size_t RingChannel::regionSize(uint32_t num_event_rings, uint32_t capacity) {
+    return sizeof(XDPDNSRingRegion) +
+           static_cast<size_t>(num_event_rings + 1) * capacity * sizeof(XDPDNSRingMsg);
+}
+
+bool RingChannel::create(const char* name, uint32_t num_event_rings, uint32_t capacity) {
+    if (!name || region_ || num_event_rings == 0 ||
+        num_event_rings > XDP_DNS_RING_MAX_WORKERS || capacity == 0 || capacity > kMaxCapacity) {
+        return false;
+    }
+    capacity = roundUpPow2(capacity);
+    size_t size = regionSize(num_event_rings, capacity);
+
+    int fd = shm_open(name, O_CREAT | O_RDWR, 0600);
+    if (fd < 0) return false;
+
+    if (ftruncate(fd, static_cast<off_t>(size)) != 0) {
+        ::close(fd);
+        return false;
+    }
+
+    void* p = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    ::close(fd);
+    if (p == MAP_FAILED) return false;
+
+    region_ = static_cast<XDPDNSRingRegion*>(p);
+    size_ = size;
+    name_ = name;
+    owner_ = true;
+
+    std::memset(region_, 0, sizeof(XDPDNSRingRegion));
+    region_->version = XDP_DNS_RING_VERSION;
+    region_->size = static_cast<uint32_t>(size);
+    region_->num_event_rings = num_event_rings;
+    region_->msg_size = sizeof(XDPDNSRingMsg);
+    region_->start_time_ns = wallClockNs();
+
+    uint64_t offset = sizeof(XDPDNSRingRegion);
+    auto setup = [&](XDPDNSRingHeader* h) {
+        h->capacity = capacity;
+        h->slots_offset = offset;
+        offset += static_cast<uint64_t>(capacity) * sizeof(XDPDNSRingMsg);
+    };
+    setup(&region_->control);
+    for (uint32_t i = 0; i < num_event_rings; i++) {
+        setup(&region_->events[i]);
+    }
+
+    __atomic_store_n(&region_->magic, XDP_DNS_RING_MAGIC, __ATOMIC_RELEASE);
+    return true;
+}
+
+bool RingChannel::open(const char* name) {
+    if (!name || region_) return false;
+
+    int fd = shm_open(name, O_RDWR, 0);
+    if (fd < 0) return false;
+
+    struct stat st;
+    if (fstat(fd, &st) != 0 || st.st_size < static_cast<off_t>(sizeof(XDPDNSRingRegion))) {
+        ::close(fd);
+        return false;
+    }
+
+    size_t size = static_cast<size_t>(st.st_size);
+    void* p = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    ::close(fd);
+    if (p == MAP_FAILED) return false;
+
+    auto* region = static_cast<XDPDNSRingRegion*>(p);
+    if (__atomic_load_n(&region->magic, __ATOMIC_ACQUIRE) != XDP_DNS_RING_MAGIC ||
+        region->version != XDP_DNS_RING_VERSION ||
+        region->msg_size != sizeof(XDPDNSRingMsg) ||
+        region->size > size ||
+        region->num_event_rings > XDP_DNS_RING_MAX_WORKERS) {
+        munmap(p, size);
+        return false;
+    }
+    bool fits = ringFits(region->control, size);
+    for (uint32_t i = 0; fits && i < region->num_event_rings; i++) {
+        fits = ringFits(region->events[i], size);
+    }
+    if (!fits) {
+        munmap(p, size);
+        return false;
+    }
+
+    region_ = region;
+    size_ = size;
+    name_ = name;
+    owner_ = false;
+    return true;
+}
+
+void RingChannel::close() {
+    if (!region_) return;
+
+    munmap(region_, size_);
+    if (owner_) {
+        shm_unlink(name_.c_str());
+    }
+    region_ = nullptr;
+    size_ = 0;
+    owner_ = false;
+    name_.clear();
+}
+
+uint32_t RingChannel::numEventRings() const {
+    return region_ ? region_->num_event_rings : 0;
+}
+
+ShmRing RingChannel::ring(XDPDNSRingHeader* header) const {
+    auto* base = reinterpret_cast<uint8_t*>(region_);
+    return ShmRing(header, reinterpret_cast<XDPDNSRingMsg*>(base + header->slots_offset));
+}
+
+ShmRing RingChannel::control() const {
+    if (!region_) return ShmRing();
+    return ring(&region_->control);
+}
+
+ShmRing RingChannel::events(uint32_t index) const {
+    if (!region_ || index >= region_->num_event_rings) return ShmRing();
+    return ring(&region_->events[index]);
+}
+
+} // namespace xdp_dns
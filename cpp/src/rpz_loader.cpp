@@ -0,0 +1,558 @@
+#include "xdp_dns/rpz_loader.hpp"
+#include "xdp_dns/response_writer.hpp"
+#include "xdp_dns/simd.hpp"
+#include <arpa/inet.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <strings.h>
+
+namespace xdp_dns {
+
+namespace {
+
+// 一条逻辑记录最多保留的字段数 (完整的 SOA 记录为 11 个), 多出的忽略
+constexpr size_t kMaxTokens = 16;
+
+// 一条逻辑记录: 括号内的换行视为空白
+struct Line {
+    std::string_view tokens[kMaxTokens];
+    size_t count = 0;
+    bool has_owner = false;     // 行首不是空白
+};
+
+// 字符分类, nextLine 按表分派, 避免逐字符的比较链
+enum CharClass : uint8_t {
+    kToken = 0,
+    kSpace,
+    kNewline,
+    kComment,
+    kOpen,
+    kClose,
+    kQuote,
+    kEscape,
+};
+
+struct CharTable {
+    uint8_t cls[256] = {};
+
+    constexpr CharTable() {
+        cls[static_cast<uint8_t>(' ')] = kSpace;
+        cls[static_cast<uint8_t>('\t')] = kSpace;
+        cls[static_cast<uint8_t>('\r')] = kSpace;
+        cls[static_cast<uint8_t>('\n')] = kNewline;
+        cls[static_cast<uint8_t>(';')] = kComment;
+        cls[static_cast<uint8_t>('(')] = kOpen;
+        cls[static_cast<uint8_t>(')')] = kClose;
+        cls[static_cast<uint8_t>('"')] = kQuote;
+        cls[static_cast<uint8_t>('\\')] = kEscape;
+    }
+
+    uint8_t operator[](char c) const { return cls[static_cast<uint8_t>(c)]; }
+};
+
+constexpr CharTable kChars;
+
+// 读取下一条逻辑记录; 括号不配对或引号未闭合返回 false
+bool nextLine(const char** cursor, const char* end, Line* line) {
+    const char* p = *cursor;
+    line->count = 0;
+    line->has_owner = p < end && kChars[*p] != kSpace;
+    int depth = 0;
+    while (p < end) {
+        switch (kChars[*p]) {
+            case kSpace:
+                p++;
+                continue;
+            case kNewline:
+                p++;
+                if (depth == 0) {
+                    *cursor = p;
+                    return true;
+                }
+                continue;
+            case kComment: {
+                const void* nl = std::memchr(p, '\n', static_cast<size_t>(end - p));
+                p = nl ? static_cast<const char*>(nl) : end;
+                continue;
+            }
+            case kOpen:
+                depth++;
+                p++;
+                continue;
+            case kClose:
+                if (--depth < 0) return false;
+                p++;
+                continue;
+            default:
+                break;
+        }
+
+        const char* start = p;
+        if (*p == '"') {
+            for (p++; p < end && *p != '"'; p++) {
+                if (*p == '\\' && p + 1 < end) p++;
+            }
+            if (p >= end) return false;
+            p++;
+        } else {
+            while (p < end) {
+                uint8_t k = kChars[*p];
+                if (k == kToken) {
+                    p++;
+                } else if (k == kEscape) {
+                    p += p + 1 < end ? 2 : 1;
+                } else {
+                    break;
+                }
+            }
+        }
+        if (line->count < kMaxTokens) {
+            line->tokens[line->count++] = std::string_view(start, static_cast<size_t>(p - start));
+        }
+    }
+    *cursor = p;
+    return depth == 0;
+}
+
+template <size_t N>
+inline bool iequals(std::string_view a, const char (&b)[N]) {
+    return a.size() == N - 1 && strncasecmp(a.data(), b, N - 1) == 0;
+}
+
+// 记录类型; 其它类型返回 0
+uint16_t recordType(std::string_view t) {
+    switch (t.size()) {
+        case 1: return (t[0] | 0x20) == 'a' ? dns_type::A : 0;
+        case 2: return iequals(t, "NS") ? dns_type::NS : 0;
+        case 3: return iequals(t, "SOA") ? dns_type::SOA : 0;
+        case 4: return iequals(t, "AAAA") ? dns_type::AAAA : 0;
+        case 5: return iequals(t, "CNAME") ? dns_type::CNAME : 0;
+        default: return 0;
+    }
+}
+
+// "3600" 或 BIND 风格的 "1h30m"; 按 RFC 2181 不超过 2^31 - 1
+bool parseTtl(std::string_view s, uint32_t* out) {
+    uint64_t total = 0;
+    uint64_t value = 0;
+    bool digits = false;
+    for (char c : s) {
+        if (c >= '0' && c <= '9') {
+            value = value * 10 + static_cast<uint64_t>(c - '0');
+            if (value > INT32_MAX) return false;
+            digits = true;
+            continue;
+        }
+        if (!digits) return false;
+        uint64_t unit;
+        switch (c | 0x20) {
+            case 's': unit = 1; break;
+            case 'm': unit = 60; break;
+            case 'h': unit = 3600; break;
+            case 'd': unit = 86400; break;
+            case 'w': unit = 604800; break;
+            default: return false;
+        }
+        total += value * unit;
+        value = 0;
+        digits = false;
+    }
+    total += value;
+    if (total > INT32_MAX) return false;
+    *out = static_cast<uint32_t>(total);
+    return true;
+}
+
+// 名字 → 小写, 去掉结尾的点
+void lowerName(std::string_view name, std::string* out) {
+    if (!name.empty() && name.back() == '.') name.remove_suffix(1);
+    out->resize(name.size());
+    simd().lower_copy(out->data(), reinterpret_cast<const uint8_t*>(name.data()), name.size());
+}
+
+// a 是 b 的子域时返回 a 中 b 之前的部分 (不含分隔的点), 相等时返回空串
+bool stripSuffix(const std::string& a, const std::string& b, std::string_view* prefix) {
+    if (a == b) {
+        *prefix = {};
+        return true;
+    }
+    if (a.size() <= b.size() + 1 || a[a.size() - b.size() - 1] != '.' ||
+        a.compare(a.size() - b.size(), b.size(), b) != 0) {
+        return false;
+    }
+    *prefix = std::string_view(a.data(), a.size() - b.size() - 1);
+    return true;
+}
+
+// QNAME 触发器是否受支持: 只有开头的 "*." 可以含通配符, 不支持转义与
+// rpz-ip 等其它触发器
+bool supportedTrigger(const std::string& trigger) {
+    if (trigger.empty() || trigger.find('\\') != std::string::npos) return false;
+    size_t star = trigger.find('*');
+    if (star != std::string::npos &&
+        (star != 0 || trigger.size() < 3 || trigger[1] != '.' ||
+         trigger.find('*', 1) != std::string::npos)) {
+        return false;
+    }
+    size_t dot = trigger.rfind('.');
+    std::string_view last = dot == std::string::npos ? std::string_view(trigger)
+                                                     : std::string_view(trigger).substr(dot + 1);
+    return last != "rpz-ip" && last != "rpz-nsip" && last != "rpz-nsdname" &&
+           last != "rpz-client-ip";
+}
+
+class RpzCompiler {
+public:
+    RpzCompiler(std::string_view origin, RuleEntries* out, RpzStats* stats, AnswerTable* answers)
+        : out_(out), stats_(stats), answers_(answers) {
+        if (!origin.empty()) lowerName(origin, &origin_);
+        originChanged();
+    }
+
+    Error run(const char* data, size_t len) {
+        // 行数是记录数的上界, 避免 5M 级区文件反复扩容
+        size_t lines = 0;
+        for (const char* p = data; p < data + len; p++) {
+            p = static_cast<const char*>(std::memchr(p, '\n', static_cast<size_t>(data + len - p)));
+            if (!p) break;
+            lines++;
+        }
+        out_->reserve(out_->size() + lines + 1);
+
+        const char* cursor = data;
+        const char* end = data + len;
+        Line line;
+        while (cursor < end) {
+            if (!nextLine(&cursor, end, &line)) return Error::InvalidRule;
+            if (line.count == 0) continue;
+            Error err = line.has_owner && line.tokens[0].front() == '$' ? directive(line)
+                                                                       : record(line);
+            if (err != Error::Success) return err;
+        }
+        return flush();
+    }
+
+private:
+    enum class Owner { Ok, Outside, Error };
+
+    Error directive(const Line& line) {
+        std::string_view name = line.tokens[0];
+        if (iequals(name, "$TTL")) {
+            if (line.count < 2 || !parseTtl(line.tokens[1], &default_ttl_)) {
+                return Error::InvalidRule;
+            }
+            has_default_ttl_ = true;
+            return Error::Success;
+        }
+        if (!iequals(name, "$ORIGIN") || line.count < 2) return Error::InvalidRule;
+
+        std::string full;
+        std::string_view arg = line.tokens[1];
+        if (arg.back() == '.') {
+            lowerName(arg, &full);
+        } else {
+            if (origin_.empty() || outside_) return Error::InvalidRule;
+            lowerName(arg, &full);
+            full += '.';
+            full += currentOrigin();
+        }
+        if (origin_.empty()) {
+            origin_ = std::move(full);
+            originChanged();
+            suffix_.clear();
+            outside_ = false;
+            return Error::Success;
+        }
+        std::string_view prefix;
+        outside_ = !stripSuffix(full, origin_, &prefix);
+        suffix_.assign(outside_ ? std::string_view() : prefix);
+        return Error::Success;
+    }
+
+    Error record(const Line& line) {
+        if (!line.has_owner && !has_owner_) return Error::InvalidRule;
+
+        size_t i = line.has_owner ? 1 : 0;
+        uint32_t ttl = has_default_ttl_ ? default_ttl_ : last_ttl_;
+        bool other_class = false;
+        for (; i < line.count; i++) {
+            std::string_view t = line.tokens[i];
+            if (t.front() >= '0' && t.front() <= '9') {
+                if (!parseTtl(t, &ttl)) return Error::InvalidRule;
+                last_ttl_ = ttl;
+            } else if (!iequals(t, "IN")) {
+                if (!iequals(t, "CH") && !iequals(t, "HS") && !iequals(t, "CS")) break;
+                other_class = true;
+            }
+        }
+        if (i >= line.count) return Error::InvalidRule;
+        uint16_t type = recordType(line.tokens[i++]);
+        const std::string_view* rdata = line.tokens + i;
+        size_t rdata_count = line.count - i;
+        if (stats_) stats_->records++;
+
+        if (line.has_owner) {
+            has_owner_ = true;
+            switch (resolveOwner(line.tokens[0], type == dns_type::SOA, &scratch_)) {
+                case Owner::Error:
+                    return Error::InvalidRule;
+                case Owner::Outside:
+                    scratch_.clear();
+                    in_zone_ = false;
+                    break;
+                case Owner::Ok:
+                    in_zone_ = true;
+                    break;
+            }
+            if (!in_zone_ || scratch_ != pending_.trigger) {
+                Error err = flush();
+                if (err != Error::Success) return err;
+                pending_.reset();
+                pending_.trigger.swap(scratch_);
+                pending_.active = in_zone_ && supportedTrigger(pending_.trigger);
+            }
+        }
+
+        if (!in_zone_ || other_class) return skip();
+        if (pending_.trigger.empty()) {
+            // 区顶点: SOA / NS 是区本身的数据
+            return type == dns_type::SOA || type == dns_type::NS ? Error::Success : skip();
+        }
+        if (!pending_.active || pending_.has_action || pending_.has_cname) return skip();
+
+        if (type == dns_type::CNAME) {
+            if (rdata_count != 1) return skip();
+            return cname(rdata[0], ttl);
+        }
+        if (type == dns_type::A || type == dns_type::AAAA) {
+            bool v6 = type == dns_type::AAAA;
+            char text[INET6_ADDRSTRLEN];
+            uint8_t addr[16];
+            if (rdata_count != 1 || rdata[0].size() >= sizeof(text)) return skip();
+            std::memcpy(text, rdata[0].data(), rdata[0].size());
+            text[rdata[0].size()] = '\0';
+            if (inet_pton(v6 ? AF_INET6 : AF_INET, text, addr) != 1) return skip();
+            if (v6) {
+                pending_.v6.insert(pending_.v6.end(), addr, addr + 16);
+            } else {
+                uint32_t ip;
+                std::memcpy(&ip, addr, 4);
+                pending_.v4.push_back(ip);
+            }
+            pending_.ttl = std::min(pending_.ttl, ttl);
+            return Error::Success;
+        }
+        return skip();
+    }
+
+    // 所有者名 → 区内相对名 (小写), 区顶点为空串
+    Owner resolveOwner(std::string_view name, bool is_soa, std::string* rel) {
+        if (name == "@") {
+            if (origin_.empty()) return Owner::Error;
+            if (outside_) return Owner::Outside;
+            rel->assign(suffix_);
+            return Owner::Ok;
+        }
+        if (name.back() == '.') {
+            lowerName(name, rel);
+            if (origin_.empty()) {
+                // 没有给出区名: 取第一个 SOA 的所有者名
+                if (!is_soa) return Owner::Error;
+                origin_.swap(*rel);
+                originChanged();
+                rel->clear();
+                return Owner::Ok;
+            }
+            std::string_view prefix;
+            if (!stripSuffix(*rel, origin_, &prefix)) return Owner::Outside;
+            rel->resize(prefix.size());
+            return Owner::Ok;
+        }
+        if (outside_) return Owner::Outside;
+        lowerName(name, rel);
+        if (!suffix_.empty()) {
+            *rel += '.';
+            *rel += suffix_;
+        }
+        return rel->size() <= MAX_DOMAIN_LENGTH ? Owner::Ok : Owner::Outside;
+    }
+
+    // 规则模板的 rule_id 为区名, 避免每条规则格式化一次
+    void originChanged() {
+        std::snprintf(base_.rule_id, sizeof(base_.rule_id), "%s", origin_.c_str());
+    }
+
+    std::string currentOrigin() const {
+        return suffix_.empty() ? origin_ : suffix_ + "." + origin_;
+    }
+
+    Error cname(std::string_view target, uint32_t ttl) {
+        if (target == ".") {
+            return action(Action::Block, BlockMode::NXDomain, ttl);
+        }
+        if (target == "*.") {
+            return action(Action::Block, BlockMode::NoData, ttl);
+        }
+        if (iequals(target, "rpz-passthru.")) {
+            return action(Action::Allow, BlockMode::NXDomain, ttl);
+        }
+        if (iequals(target, "rpz-drop.")) {
+            return action(Action::Block, BlockMode::Drop, ttl);
+        }
+        if (iequals(target, "rpz-tcp-only.") || target.front() == '*' ||
+            target.find('\\') != std::string_view::npos) {
+            return skip();
+        }
+
+        std::string name;
+        lowerName(target, &name);
+        if (target.back() != '.') {
+            if (origin_.empty() || outside_) return skip();
+            name += '.';
+            name += currentOrigin();
+        }
+        // 旧式 PASSTHRU: CNAME 指向 QNAME 本身
+        if (name == pending_.trigger) {
+            return action(Action::Allow, BlockMode::NXDomain, ttl);
+        }
+        if (!pending_.v4.empty() || !pending_.v6.empty()) return skip();
+        pending_.has_cname = true;
+        pending_.cname = std::move(name);
+        pending_.ttl = std::min(pending_.ttl, ttl);
+        return Error::Success;
+    }
+
+    Error action(Action a, BlockMode mode, uint32_t ttl) {
+        if (!pending_.v4.empty() || !pending_.v6.empty()) return skip();
+        pending_.has_action = true;
+        pending_.ttl = std::min(pending_.ttl, ttl);
+        pending_.action = a;
+        pending_.block_mode = mode;
+        return Error::Success;
+    }
+
+    Error skip() {
+        if (stats_) stats_->skipped++;
+        return Error::Success;
+    }
+
+    // 输出当前名字的规则
+    Error flush() {
+        if (!pending_.active) return Error::Success;
+        if (!pending_.has_action && !pending_.has_cname && pending_.v4.empty() &&
+            pending_.v6.empty()) {
+            return Error::Success;
+        }
+
+        Rule rule = base_;
+        rule.id = static_cast<uint32_t>(out_->size() + 1);
+        rule.ttl = pending_.ttl;
+        rule.subdomains_only = pending_.trigger[0] == '*';
+        if (pending_.has_action) {
+            rule.action = pending_.action;
+            rule.block_mode = pending_.block_mode;
+        } else {
+            rule.action = Action::Redirect;
+            if (!pending_.v4.empty()) rule.redirect_ip = pending_.v4.front();
+            if (pending_.has_cname || pending_.v4.size() > 1 || !pending_.v6.empty()) {
+                // 与 YAML 的 redirect_ips / redirect_cname 共用规则集的应答表
+                uint8_t wire[MAX_DOMAIN_LENGTH];
+                RedirectAnswer answer;
+                if (!answers_ ||
+                    (pending_.has_cname &&
+                     ResponseWriter::encodeName(pending_.cname.data(), pending_.cname.size(),
+                                                wire, sizeof(wire)) == 0) ||
+                    !RedirectAnswer::compile(pending_.has_cname ? wire : nullptr,
+                                             pending_.v4.data(), pending_.v4.size(),
+                                             pending_.v6.data(), pending_.v6.size() / 16,
+                                             rule.ttl, &answer) ||
+                    (rule.answer = answers_->intern(std::move(answer))) == 0) {
+                    return skip();
+                }
+            }
+        }
+        out_->emplace_back(pending_.trigger, rule);
+        if (stats_) stats_->triggers++;
+        return Error::Success;
+    }
+
+    struct Pending {
+        std::string trigger;        // 区内相对名, 小写; 区顶点为空串
+        bool active = false;        // 在区内且触发器受支持
+        bool has_action = false;
+        Action action = Action::Allow;
+        BlockMode block_mode = BlockMode::NXDomain;
+        bool has_cname = false;
+        std::string cname;          // local data 的 CNAME 目标
+        std::vector<uint32_t> v4;   // local data 地址, 网络字节序
+        std::vector<uint8_t> v6;    // 每 16 字节一个地址
+        uint32_t ttl = UINT32_MAX;
+
+        void reset() {
+            active = has_action = has_cname = false;
+            v4.clear();
+            v6.clear();
+            ttl = UINT32_MAX;
+        }
+    };
+
+    RuleEntries* out_;
+    RpzStats* stats_;
+    AnswerTable* answers_;
+
+    std::string origin_;            // 区名 (小写, 无结尾的点)
+    std::string suffix_;            // 当前 $ORIGIN 相对区名的前缀
+    bool outside_ = false;          // 当前 $ORIGIN 不在区内
+    uint32_t default_ttl_ = 0;
+    bool has_default_ttl_ = false;
+    uint32_t last_ttl_ = Rule().ttl;
+
+    bool has_owner_ = false;
+    bool in_zone_ = false;
+    std::string scratch_;
+    Pending pending_;
+    Rule base_;
+};
+
+} // anonymous namespace
+
+Error parseRpzZone(const char* data, size_t len, std::string_view origin,
+                   RuleEntries* out, RpzStats* stats, AnswerTable* answers) {
+    if ((!data && len) || !out) return Error::InvalidRule;
+    RpzCompiler compiler(origin, out, stats, answers);
+    return compiler.run(data, len);
+}
+
+Error loadRpzFile(const char* path, std::string_view origin, RuleEntries* out,
+                  RpzStats* stats, AnswerTable* answers) {
+    if (!path) return Error::InvalidRule;
+
+    int fd = open(path, O_RDONLY | O_CLOEXEC);
+    if (fd < 0) return Error::InvalidRule;
+    struct stat st;
+    if (fstat(fd, &st) != 0) {
+        close(fd);
+        return Error::InvalidRule;
+    }
+    size_t size = static_cast<size_t>(st.st_size);
+    if (size == 0) {
+        close(fd);
+        return parseRpzZone("", 0, origin, out, stats, answers);
+    }
+
+    void* p = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (p == MAP_FAILED) return Error::InvalidRule;
+    madvise(p, size, MADV_SEQUENTIAL);
+
+    Error err = parseRpzZone(static_cast<const char*>(p), size, origin, out, stats, answers);
+    munmap(p, size);
+    return err;
+}
+
+} // namespace xdp_dns
@@ -0,0 +1,393 @@
+#include "xdp_dns/rule_loader.hpp"
+#include "xdp_dns/response_writer.hpp"
+#include "xdp_dns/rpz_loader.hpp"
+#include <arpa/inet.h>
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <string_view>
+#include <unordered_map>
+
+namespace xdp_dns {
+
+namespace {
+
+struct PendingRule {
+    std::string id;
+    long priority = 0;
+    bool enabled = false;
+    Action action = Action::Allow;
+    BlockMode block_mode = BlockMode::NXDomain;
+    uint32_t redirect_ip = 0;
+    uint32_t ttl = 0;
+    std::vector<std::string> domains;
+    std::vector<std::string> redirect_ips;  // 多地址轮转, 可含 IPv6
+    std::string redirect_cname;             // 重定向到 CNAME 目标 (walled garden)
+};
+
+std::string_view trim(std::string_view s) {
+    while (!s.empty() && (s.front() == ' ' || s.front() == '\t')) s.remove_prefix(1);
+    while (!s.empty() && (s.back() == ' ' || s.back() == '\t' || s.back() == '\r')) s.remove_suffix(1);
+    return s;
+}
+
+// 去掉引号外的 # 注释
+std::string_view stripComment(std::string_view line) {
+    char quote = 0;
+    for (size_t i = 0; i < line.size(); i++) {
+        char c = line[i];
+        if (quote) {
+            if (c == quote) quote = 0;
+        } else if (c == '"' || c == '\'') {
+            quote = c;
+        } else if (c == '#' && (i == 0 || line[i - 1] == ' ' || line[i - 1] == '\t')) {
+            return line.substr(0, i);
+        }
+    }
+    return line;
+}
+
+std::string unquote(std::string_view s) {
+    s = trim(s);
+    if (s.size() >= 2 && (s.front() == '"' || s.front() == '\'') && s.back() == s.front()) {
+        s = s.substr(1, s.size() - 2);
+    }
+    return std::string(s);
+}
+
+// "key: value" → key / value; 不是键值对时返回 false
+bool splitKey(std::string_view s, std::string_view* key, std::string_view* value) {
+    size_t colon = s.find(':');
+    if (colon == std::string_view::npos || colon == 0) return false;
+    if (colon + 1 < s.size() && s[colon + 1] != ' ') return false;
+    *key = trim(s.substr(0, colon));
+    *value = trim(s.substr(colon + 1));
+    return true;
+}
+
+bool parseLong(std::string_view s, long* out) {
+    std::string str = unquote(s);
+    if (str.empty()) return false;
+    char* end = nullptr;
+    long v = std::strtol(str.c_str(), &end, 10);
+    if (*end != '\0') return false;
+    *out = v;
+    return true;
+}
+
+Action parseAction(const std::string& name) {
+    std::string lower(name);
+    std::transform(lower.begin(), lower.end(), lower.begin(), ::tolower);
+    if (lower == "block") return Action::Block;
+    if (lower == "redirect") return Action::Redirect;
+    if (lower == "log") return Action::Log;
+    return Action::Allow;  // 与 pkg/filter 一致: 未知动作视为放行
+}
+
+bool parseAnyPolicy(const std::string& name, AnyPolicy* out) {
+    std::string lower(name);
+    std::transform(lower.begin(), lower.end(), lower.begin(), ::tolower);
+    if (lower == "forward") {
+        *out = AnyPolicy::Forward;
+    } else if (lower == "hinfo") {
+        *out = AnyPolicy::Hinfo;
+    } else if (lower == "truncate" || lower == "tc") {
+        *out = AnyPolicy::Truncate;
+    } else {
+        return false;
+    }
+    return true;
+}
+
+bool parseBlockMode(const std::string& name, BlockMode* out) {
+    std::string lower(name);
+    std::transform(lower.begin(), lower.end(), lower.begin(), ::tolower);
+    if (lower == "nxdomain") {
+        *out = BlockMode::NXDomain;
+    } else if (lower == "nodata") {
+        *out = BlockMode::NoData;
+    } else if (lower == "refused") {
+        *out = BlockMode::Refused;
+    } else if (lower == "null" || lower == "null_ip") {
+        *out = BlockMode::NullAddress;
+    } else if (lower == "drop") {
+        *out = BlockMode::Drop;
+    } else {
+        return false;
+    }
+    return true;
+}
+
+// 规则集级别的顶层键
+Error applyTopLevelKey(RuleSetPolicy* policy, std::string_view key, std::string_view value) {
+    if (key == "any_policy") {
+        if (!parseAnyPolicy(unquote(value), &policy->any_policy)) return Error::InvalidRule;
+    } else if (key == "any_ttl") {
+        long v;
+        if (!parseLong(value, &v) || v < 0 || v > UINT32_MAX) return Error::InvalidRule;
+        policy->any_ttl = static_cast<uint32_t>(v);
+    } else if (key == "negative_ttl") {
+        long v;
+        if (!parseLong(value, &v) || v < 0 || v > INT32_MAX) return Error::InvalidRule;
+        policy->negative_ttl = static_cast<uint32_t>(v);
+    }
+    return Error::Success;
+}
+
+// 流式列表 [a, "b"]
+void parseFlowList(std::string_view s, std::vector<std::string>* out) {
+    s = trim(s);
+    s = s.substr(1, s.size() - 2);
+    while (!s.empty()) {
+        size_t comma = s.find(',');
+        std::string item = unquote(s.substr(0, comma));
+        if (!item.empty()) out->push_back(std::move(item));
+        if (comma == std::string_view::npos) break;
+        s.remove_prefix(comma + 1);
+    }
+}
+
+Error applyKey(PendingRule* rule, std::string_view key, std::string_view value) {
+    if (key == "id") {
+        rule->id = unquote(value);
+    } else if (key == "priority") {
+        if (!parseLong(value, &rule->priority)) return Error::InvalidRule;
+    } else if (key == "enabled") {
+        std::string v = unquote(value);
+        rule->enabled = v == "true" || v == "True" || v == "yes";
+    } else if (key == "action") {
+        rule->action = parseAction(unquote(value));
+    } else if (key == "block_mode") {
+        if (!parseBlockMode(unquote(value), &rule->block_mode)) return Error::InvalidRule;
+    } else if (key == "redirect_ip") {
+        // Rule 只能存 IPv4, 其它地址与 pkg/filter 无法解析时一样忽略
+        in_addr addr;
+        if (inet_pton(AF_INET, unquote(value).c_str(), &addr) == 1) {
+            rule->redirect_ip = addr.s_addr;
+        }
+    } else if (key == "redirect_ttl") {
+        long ttl;
+        if (!parseLong(value, &ttl) || ttl < 0) return Error::InvalidRule;
+        rule->ttl = static_cast<uint32_t>(ttl);
+    } else if (key == "redirect_cname") {
+        rule->redirect_cname = unquote(value);
+    } else if (key == "domains" || key == "redirect_ips") {
+        if (!value.empty()) {
+            if (value.front() != '[' || value.back() != ']') return Error::InvalidRule;
+            parseFlowList(value, key == "domains" ? &rule->domains : &rule->redirect_ips);
+        }
+    }
+    // query_types / description 等其它键忽略
+    return Error::Success;
+}
+
+// redirect_ips / redirect_cname 编译为 answers 中的应答; 只有一个
+// IPv4 地址或 answers 为 nullptr 时走 redirect_ip 的单记录路径
+Error compileRedirect(const PendingRule& pr, AnswerTable* answers, Rule* rule) {
+    if (pr.redirect_ips.empty() && pr.redirect_cname.empty()) return Error::Success;
+
+    std::vector<uint32_t> v4;
+    std::vector<uint8_t> v6;    // 每 16 字节一个地址
+    if (pr.redirect_ip) v4.push_back(pr.redirect_ip);
+    for (const auto& ip : pr.redirect_ips) {
+        in_addr addr4;
+        in6_addr addr6;
+        if (inet_pton(AF_INET, ip.c_str(), &addr4) == 1) {
+            v4.push_back(addr4.s_addr);
+        } else if (inet_pton(AF_INET6, ip.c_str(), &addr6) == 1) {
+            v6.insert(v6.end(), addr6.s6_addr, addr6.s6_addr + 16);
+        } else {
+            return Error::InvalidRule;
+        }
+    }
+    if (!v4.empty()) rule->redirect_ip = v4.front();
+    if (pr.redirect_cname.empty() && v4.size() <= 1 && v6.empty()) return Error::Success;
+
+    uint8_t cname[MAX_DOMAIN_LENGTH];
+    if (!pr.redirect_cname.empty() &&
+        ResponseWriter::encodeName(pr.redirect_cname.data(), pr.redirect_cname.size(),
+                                   cname, sizeof(cname)) == 0) {
+        return Error::InvalidRule;
+    }
+
+    RedirectAnswer answer;
+    if (!RedirectAnswer::compile(pr.redirect_cname.empty() ? nullptr : cname,
+                                 v4.data(), v4.size(),
+                                 v6.data(), v6.size() / 16,
+                                 rule->ttl, &answer)) {
+        return Error::InvalidRule;
+    }
+    if (!answers) return Error::Success;
+    rule->answer = answers->intern(std::move(answer));
+    return rule->answer ? Error::Success : Error::InvalidRule;
+}
+
+} // anonymous namespace
+
+Error parseRuleYaml(const char* data, size_t len, RuleEntries* out,
+                    RuleSetPolicy* policy, LocalZones* zones, AnswerTable* answers) {
+    if (!data || !out) return Error::InvalidRule;
+
+    RuleSetPolicy set_policy;
+    std::vector<PendingRule> rules;
+    std::vector<std::string> local_zones, local_data, rpz_files;
+    std::vector<std::string>* top_list = nullptr;  // 当前顶层块列表 (local_zones 等)
+    bool in_rules = false;
+    int dash_indent = -1;        // 规则项 "- " 的缩进
+    std::string_view list_key;   // 当前块列表所属的键
+
+    std::string_view text(data, len);
+    while (!text.empty()) {
+        size_t nl = text.find('\n');
+        std::string_view line = text.substr(0, nl);
+        text.remove_prefix(nl == std::string_view::npos ? text.size() : nl + 1);
+
+        line = stripComment(line);
+        std::string_view content = trim(line);
+        if (content.empty() || content == "---") continue;
+        int indent = static_cast<int>(line.find_first_not_of(" \t"));
+
+        // 顶层键
+        if (indent == 0 && content.front() != '-') {
+            std::string_view key, value;
+            if (!splitKey(content, &key, &value)) return Error::InvalidRule;
+            Error err = applyTopLevelKey(&set_policy, key, value);
+            if (err != Error::Success) return err;
+            in_rules = key == "rules";
+            dash_indent = -1;
+            list_key = {};
+            top_list = key == "local_zones" ? &local_zones
+                     : key == "local_data"  ? &local_data
+                     : key == "rpz_files"   ? &rpz_files
+                                            : nullptr;
+            if (top_list && !value.empty()) {
+                if (value.front() != '[') return Error::InvalidRule;
+                parseFlowList(value, top_list);
+                top_list = nullptr;
+            }
+            continue;
+        }
+        if (top_list) {
+            if (content.front() != '-' || (content.size() > 1 && content[1] != ' ')) {
+                return Error::InvalidRule;
+            }
+            std::string item = unquote(content.substr(1));
+            if (!item.empty()) top_list->push_back(std::move(item));
+            continue;
+        }
+        if (!in_rules) continue;
+
+        bool is_item = content.front() == '-' &&
+                       (content.size() == 1 || content[1] == ' ');
+        if (is_item && (dash_indent < 0 || indent == dash_indent)) {
+            // 新规则: "- key: value"
+            dash_indent = indent;
+            list_key = {};
+            rules.emplace_back();
+            content = trim(content.substr(1));
+            if (content.empty()) continue;
+        } else if (is_item && !list_key.empty()) {
+            // 块列表元素
+            if (list_key == "domains" || list_key == "redirect_ips") {
+                std::string item = unquote(content.substr(1));
+                auto& list = list_key == "domains" ? rules.back().domains
+                                                   : rules.back().redirect_ips;
+                if (!item.empty()) list.push_back(std::move(item));
+            }
+            continue;
+        } else if (rules.empty() || indent <= dash_indent) {
+            return Error::InvalidRule;
+        }
+
+        std::string_view key, value;
+        if (!splitKey(content, &key, &value)) return Error::InvalidRule;
+        list_key = value.empty() ? key : std::string_view();
+        Error err = applyKey(&rules.back(), key, value);
+        if (err != Error::Success) return err;
+    }
+
+    // priority 升序稳定排序: 同一域名由后处理的高优先级规则覆盖
+    std::vector<size_t> order(rules.size());
+    for (size_t i = 0; i < order.size(); i++) order[i] = i;
+    std::stable_sort(order.begin(), order.end(), [&](size_t a, size_t b) {
+        return rules[a].priority < rules[b].priority;
+    });
+
+    // RPZ 区在前: 同名的 YAML 规则后插入, 在 Trie 中覆盖 RPZ 触发器
+    out->clear();
+    for (const auto& item : rpz_files) {
+        std::string_view spec = trim(item);
+        size_t space = spec.find_first_of(" \t");
+        std::string path(spec.substr(0, space));
+        std::string_view origin = space == std::string_view::npos ? std::string_view()
+                                                                  : trim(spec.substr(space));
+        if (loadRpzFile(path.c_str(), origin, out, nullptr, answers) != Error::Success) {
+            return Error::InvalidRule;
+        }
+    }
+    // 各区的 id 在 out 内连续不重复, 整体排在 YAML 规则 (1..rules.size()) 之后
+    for (auto& entry : *out) {
+        entry.second.id += static_cast<uint32_t>(rules.size());
+    }
+
+    std::unordered_map<std::string, size_t> seen;  // 域名 → out 中的位置
+    for (size_t idx : order) {
+        const PendingRule& pr = rules[idx];
+        if (!pr.enabled) continue;
+
+        Rule rule;
+        rule.id = static_cast<uint32_t>(idx + 1);
+        rule.action = pr.action;
+        rule.block_mode = pr.block_mode;
+        rule.redirect_ip = pr.redirect_ip;
+        rule.ttl = pr.ttl ? pr.ttl : 300;
+        std::snprintf(rule.rule_id, sizeof(rule.rule_id), "%s", pr.id.c_str());
+        if (pr.action == Action::Redirect) {
+            Error err = compileRedirect(pr, answers, &rule);
+            if (err != Error::Success) return err;
+        }
+
+        for (const auto& domain : pr.domains) {
+            auto [it, inserted] = seen.emplace(domain, out->size());
+            if (inserted) {
+                out->emplace_back(domain, rule);
+            } else {
+                (*out)[it->second].second = rule;
+            }
+        }
+    }
+
+    if (zones) {
+        for (const auto& apex : local_zones) {
+            if (zones->addZone(apex) != Error::Success) return Error::InvalidRule;
+        }
+        for (const auto& record : local_data) {
+            if (zones->addRecord(record) != Error::Success) return Error::InvalidRule;
+        }
+        if (zones->compile(set_policy.negative_ttl) != Error::Success) return Error::InvalidRule;
+    }
+    if (policy) *policy = set_policy;
+    return Error::Success;
+}
+
+Error loadRuleFile(const char* path, RuleEntries* out, RuleSetPolicy* policy,
+                   LocalZones* zones, AnswerTable* answers) {
+    if (!path) return Error::InvalidRule;
+
+    FILE* f = std::fopen(path, "rb");
+    if (!f) return Error::InvalidRule;
+
+    std::string data;
+    char buf[64 * 1024];
+    size_t n;
+    while ((n = std::fread(buf, 1, sizeof(buf), f)) > 0) {
+        data.append(buf, n);
+    }
+    bool failed = std::ferror(f) != 0;
+    std::fclose(f);
+    if (failed) return Error::InvalidRule;
+
+    return parseRuleYaml(data.data(), data.size(), out, policy, zones, answers);
+}
+
+} // namespace xdp_dns
@@ -0,0 +1,129 @@
+#include "xdp_dns/simd.hpp"
+#include <cstdlib>
+#include <cstring>
+#include <initializer_list>
+
+namespace xdp_dns {
+
+namespace {
+
+// ==================== 标量实现 ====================
+
+void lowerCopyScalar(char* dst, const uint8_t* src, size_t n) {
+    detail::lowerCopyTail(dst, src, n);
+}
+
+// CRC32C (Castagnoli, 反射多项式 0x82F63B78) 查表
+struct Crc32cTable {
+    uint32_t entries[256];
+
+    constexpr Crc32cTable() : entries() {
+        for (uint32_t i = 0; i < 256; i++) {
+            uint32_t crc = i;
+            for (int k = 0; k < 8; k++) {
+                crc = (crc >> 1) ^ (0x82F63B78u & (0u - (crc & 1)));
+            }
+            entries[i] = crc;
+        }
+    }
+};
+
+constexpr Crc32cTable kCrc32cTable;
+
+uint64_t hashScalar(const void* data, size_t n) {
+    const uint8_t* p = static_cast<const uint8_t*>(data);
+    uint32_t crc = 0xFFFFFFFFu;
+    for (size_t i = 0; i < n; i++) {
+        crc = kCrc32cTable.entries[(crc ^ p[i]) & 0xFF] ^ (crc >> 8);
+    }
+    return detail::hashFinalize(~crc, n);
+}
+
+uint64_t classifyHeadersScalar(const uint8_t* const* pkts, const uint32_t* lens, size_t n) {
+    uint64_t bits = 0;
+    for (size_t i = 0; i < n; i++) {
+        bits |= static_cast<uint64_t>(detail::headerCandidate(pkts[i], lens[i])) << i;
+    }
+    return bits;
+}
+
+const SimdKernels kScalarKernels = {
+    SimdLevel::Scalar,
+    lowerCopyScalar,
+    hashScalar,
+    classifyHeadersScalar,
+};
+
+// XDP_DNS_SIMD 指定的级别上限, 未设置或无法识别时不限制
+SimdLevel envLevelCap() {
+    const char* env = std::getenv("XDP_DNS_SIMD");
+    if (!env) return SimdLevel::AVX512;
+
+    for (SimdLevel level : {SimdLevel::Scalar, SimdLevel::SSE42,
+                            SimdLevel::AVX2, SimdLevel::AVX512}) {
+        if (std::strcmp(env, simdLevelName(level)) == 0) return level;
+    }
+    return SimdLevel::AVX512;
+}
+
+} // anonymous namespace
+
+#ifndef XDP_DNS_SIMD_X86
+namespace detail {
+const SimdKernels* const kSse42Kernels = nullptr;
+const SimdKernels* const kAvx2Kernels = nullptr;
+const SimdKernels* const kAvx512Kernels = nullptr;
+} // namespace detail
+#endif
+
+SimdLevel simdCpuLevel() {
+#ifdef XDP_DNS_SIMD_X86
+    static const SimdLevel level = [] {
+        __builtin_cpu_init();
+        if (__builtin_cpu_supports("avx512bw")) return SimdLevel::AVX512;
+        if (__builtin_cpu_supports("avx2")) return SimdLevel::AVX2;
+        if (__builtin_cpu_supports("sse4.2")) return SimdLevel::SSE42;
+        return SimdLevel::Scalar;
+    }();
+    return level;
+#else
+    return SimdLevel::Scalar;
+#endif
+}
+
+const SimdKernels* simdKernels(SimdLevel level) {
+    if (level > simdCpuLevel()) return nullptr;
+
+    switch (level) {
+        case SimdLevel::Scalar: return &kScalarKernels;
+        case SimdLevel::SSE42:  return detail::kSse42Kernels;
+        case SimdLevel::AVX2:   return detail::kAvx2Kernels;
+        case SimdLevel::AVX512: return detail::kAvx512Kernels;
+    }
+    return nullptr;
+}
+
+const SimdKernels& simd() {
+    static const SimdKernels* const selected = [] {
+        int level = static_cast<int>(envLevelCap());
+        for (; level > 0; level--) {
+            if (const SimdKernels* k = simdKernels(static_cast<SimdLevel>(level))) {
+                return k;
+            }
+        }
+        return &kScalarKernels;
+    }();
+    return *selected;
+}
+
+const char* simdLevelName(SimdLevel level) {
+    switch (level) {
+        case SimdLevel::Scalar: return "scalar";
+        case SimdLevel::SSE42:  return "sse4.2";
+        case SimdLevel::AVX2:   return "avx2";
+        case SimdLevel::AVX512: return "avx512";
+    }
+    return "unknown";
+}
+
+} // namespace xdp_dns
@@ -0,0 +1,107 @@
+// 以 -mavx2 编译, 仅在 simdCpuLevel() >= AVX2 时被调用
+#include "xdp_dns/simd.hpp"
+#include <immintrin.h>
+
+namespace xdp_dns {
+
+namespace {
+
+// 16 字节一块, 最后一块与前一块重叠 (转换幂等)
+inline void lowerCopy128(char* dst, const uint8_t* src, size_t n) {
+    const __m128i shift = _mm_set1_epi8(63);
+    const __m128i limit = _mm_set1_epi8(-128 + 26);
+    const __m128i bit = _mm_set1_epi8(0x20);
+
+    for (size_t i = 0;; i += 16) {
+        if (i + 16 > n) i = n - 16;
+        __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i));
+        __m128i upper = _mm_cmplt_epi8(_mm_add_epi8(v, shift), limit);
+        v = _mm_or_si128(v, _mm_and_si128(upper, bit));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i), v);
+        if (i + 16 == n) break;
+    }
+}
+
+void lowerCopyAvx2(char* dst, const uint8_t* src, size_t n) {
+    if (n < 16) {
+        detail::lowerCopyTail(dst, src, n);
+        return;
+    }
+    // DNS 标签多在 32 字节以内, 用 128 位即可
+    if (n < 32) {
+        lowerCopy128(dst, src, n);
+        return;
+    }
+
+    const __m256i shift = _mm256_set1_epi8(63);
+    const __m256i limit = _mm256_set1_epi8(-128 + 26);
+    const __m256i bit = _mm256_set1_epi8(0x20);
+
+    for (size_t i = 0;; i += 32) {
+        if (i + 32 > n) i = n - 32;
+        __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src + i));
+        __m256i upper = _mm256_cmpgt_epi8(limit, _mm256_add_epi8(v, shift));
+        v = _mm256_or_si256(v, _mm256_and_si256(upper, bit));
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + i), v);
+        if (i + 32 == n) break;
+    }
+}
+
+// 两个头部拼成一个 ymm; 返回 bit0 / bit1 分别对应低 / 高 128 位的头部
+inline unsigned classifyPair(const uint8_t* p0, const uint8_t* p1, __m256i mask, __m256i expect) {
+    __m256i v = _mm256_inserti128_si256(
+        _mm256_castsi128_si256(_mm_loadu_si128(reinterpret_cast<const __m128i*>(p0))),
+        _mm_loadu_si128(reinterpret_cast<const __m128i*>(p1)), 1);
+    __m256i diff = _mm256_and_si256(_mm256_xor_si256(v, expect), mask);
+    // 每个 64 位一位, 头部占相邻两位, 都为 1 (无差异) 才是候选
+    unsigned m = static_cast<unsigned>(_mm256_movemask_pd(
+        _mm256_castsi256_pd(_mm256_cmpeq_epi64(diff, _mm256_setzero_si256()))));
+    m &= m >> 1;
+    return (m & 1) | (m >> 1 & 2);
+}
+
+// 每轮 8 个头部 (4 个 ymm), 剩余部分按 128 位逐个处理
+uint64_t classifyHeadersAvx2(const uint8_t* const* pkts, const uint32_t* lens, size_t n) {
+    const __m256i mask = _mm256_broadcastsi128_si256(
+        _mm_load_si128(reinterpret_cast<const __m128i*>(detail::kHeaderMask)));
+    const __m256i expect = _mm256_broadcastsi128_si256(
+        _mm_load_si128(reinterpret_cast<const __m128i*>(detail::kHeaderExpect)));
+
+    const uint8_t* p[8];
+    uint64_t bits = 0;
+    size_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        for (size_t k = 0; k < 8; k++) {
+            p[k] = detail::headerLoadPtr(pkts[i + k], lens[i + k]);
+        }
+        uint64_t group = classifyPair(p[0], p[1], mask, expect) |
+                         classifyPair(p[2], p[3], mask, expect) << 2 |
+                         classifyPair(p[4], p[5], mask, expect) << 4 |
+                         classifyPair(p[6], p[7], mask, expect) << 6;
+        bits |= group << i;
+    }
+
+    const __m128i mask128 = _mm256_castsi256_si128(mask);
+    const __m128i expect128 = _mm256_castsi256_si128(expect);
+    for (; i < n; i++) {
+        const uint8_t* q = detail::headerLoadPtr(pkts[i], lens[i]);
+        __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(q));
+        bits |= static_cast<uint64_t>(_mm_testz_si128(_mm_xor_si128(v, expect128), mask128)) << i;
+    }
+    return bits;
+}
+
+const SimdKernels kKernels = {
+    SimdLevel::AVX2,
+    lowerCopyAvx2,
+    detail::hashCrc32c,
+    classifyHeadersAvx2,
+};
+
+} // anonymous namespace
+
+namespace detail {
+const SimdKernels* const kAvx2Kernels = &kKernels;
+} // namespace detail
+
+} // namespace xdp_dns
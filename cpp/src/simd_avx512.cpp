@@ -0,0 +1,81 @@
+// 以 -mavx512f -mavx512bw 编译, 仅在 simdCpuLevel() >= AVX512 时被调用
+#include "xdp_dns/simd.hpp"
+#include <immintrin.h>
+
+namespace xdp_dns {
+
+namespace {
+
+void lowerCopyAvx512(char* dst, const uint8_t* src, size_t n) {
+    const __m512i shift = _mm512_set1_epi8(63);
+    const __m512i limit = _mm512_set1_epi8(-128 + 26);
+    const __m512i bit = _mm512_set1_epi8(0x20);
+
+    // 掩码加载/存储处理尾部, 被屏蔽的字节不会访问内存
+    for (size_t i = 0; i < n; i += 64) {
+        size_t rest = n - i;
+        __mmask64 m = rest >= 64 ? ~0ULL : (1ULL << rest) - 1;
+        __m512i v = _mm512_maskz_loadu_epi8(m, src + i);
+        __mmask64 upper = _mm512_cmplt_epi8_mask(_mm512_add_epi8(v, shift), limit);
+        v = _mm512_mask_add_epi8(v, upper, v, bit);
+        _mm512_mask_storeu_epi8(dst + i, m, v);
+    }
+}
+
+// 四个头部拼成一个 zmm; 返回 4 位, 第 k 位对应第 k 个 128 位的头部
+inline unsigned classifyQuad(const uint8_t* const* p, __m512i mask, __m512i expect) {
+    __m512i v = _mm512_castsi128_si512(_mm_loadu_si128(reinterpret_cast<const __m128i*>(p[0])));
+    v = _mm512_inserti32x4(v, _mm_loadu_si128(reinterpret_cast<const __m128i*>(p[1])), 1);
+    v = _mm512_inserti32x4(v, _mm_loadu_si128(reinterpret_cast<const __m128i*>(p[2])), 2);
+    v = _mm512_inserti32x4(v, _mm_loadu_si128(reinterpret_cast<const __m128i*>(p[3])), 3);
+
+    // 每个 64 位一位, 非零表示有差异; 头部占相邻两位, 都为 0 才是候选
+    unsigned nz = _mm512_test_epi64_mask(_mm512_xor_si512(v, expect), mask);
+    unsigned ok = ~(nz | nz >> 1) & 0x55;
+    ok = (ok | ok >> 1) & 0x33;
+    return (ok | ok >> 2) & 0x0F;
+}
+
+// 每轮 16 个头部 (4 个 zmm), 不足 4 个的尾部用全零块补齐
+uint64_t classifyHeadersAvx512(const uint8_t* const* pkts, const uint32_t* lens, size_t n) {
+    const __m512i mask = _mm512_broadcast_i32x4(
+        _mm_load_si128(reinterpret_cast<const __m128i*>(detail::kHeaderMask)));
+    const __m512i expect = _mm512_broadcast_i32x4(
+        _mm_load_si128(reinterpret_cast<const __m128i*>(detail::kHeaderExpect)));
+
+    const uint8_t* p[16];
+    uint64_t bits = 0;
+    size_t i = 0;
+    for (; i + 16 <= n; i += 16) {
+        for (size_t k = 0; k < 16; k++) {
+            p[k] = detail::headerLoadPtr(pkts[i + k], lens[i + k]);
+        }
+        uint64_t group = classifyQuad(p, mask, expect) |
+                         classifyQuad(p + 4, mask, expect) << 4 |
+                         classifyQuad(p + 8, mask, expect) << 8 |
+                         classifyQuad(p + 12, mask, expect) << 12;
+        bits |= group << i;
+    }
+    for (; i < n; i += 4) {
+        for (size_t k = 0; k < 4; k++) {
+            p[k] = i + k < n ? detail::headerLoadPtr(pkts[i + k], lens[i + k]) : detail::kZeroHeader;
+        }
+        bits |= static_cast<uint64_t>(classifyQuad(p, mask, expect)) << i;
+    }
+    return bits;
+}
+
+const SimdKernels kKernels = {
+    SimdLevel::AVX512,
+    lowerCopyAvx512,
+    detail::hashCrc32c,
+    classifyHeadersAvx512,
+};
+
+} // anonymous namespace
+
+namespace detail {
+const SimdKernels* const kAvx512Kernels = &kKernels;
+} // namespace detail
+
+} // namespace xdp_dns
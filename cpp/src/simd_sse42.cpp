@@ -0,0 +1,77 @@
+// 以 -msse4.2 编译, 仅在 simdCpuLevel() >= SSE42 时被调用
+#include "xdp_dns/simd.hpp"
+#include <nmmintrin.h>
+
+namespace xdp_dns {
+
+namespace {
+
+void lowerCopySse42(char* dst, const uint8_t* src, size_t n) {
+    // c + 63 把 'A'..'Z' 平移到有符号最小的 26 个值, 一次比较完成区间判断
+    const __m128i shift = _mm_set1_epi8(63);
+    const __m128i limit = _mm_set1_epi8(-128 + 26);
+    const __m128i bit = _mm_set1_epi8(0x20);
+
+    if (n < 16) {
+        detail::lowerCopyTail(dst, src, n);
+        return;
+    }
+
+    // 最后一次从 n - 16 开始, 与前一块重叠 (转换幂等), 省去标量尾部
+    for (size_t i = 0;; i += 16) {
+        if (i + 16 > n) i = n - 16;
+        __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i));
+        __m128i upper = _mm_cmplt_epi8(_mm_add_epi8(v, shift), limit);
+        v = _mm_or_si128(v, _mm_and_si128(upper, bit));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i), v);
+        if (i + 16 == n) break;
+    }
+}
+
+// 每个头部一次 16 字节加载 + ptest
+uint64_t classifyHeadersSse42(const uint8_t* const* pkts, const uint32_t* lens, size_t n) {
+    const __m128i mask = _mm_load_si128(reinterpret_cast<const __m128i*>(detail::kHeaderMask));
+    const __m128i expect = _mm_load_si128(reinterpret_cast<const __m128i*>(detail::kHeaderExpect));
+
+    uint64_t bits = 0;
+    for (size_t i = 0; i < n; i++) {
+        const uint8_t* p = detail::headerLoadPtr(pkts[i], lens[i]);
+        __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+        bits |= static_cast<uint64_t>(_mm_testz_si128(_mm_xor_si128(v, expect), mask)) << i;
+    }
+    return bits;
+}
+
+const SimdKernels kKernels = {
+    SimdLevel::SSE42,
+    lowerCopySse42,
+    detail::hashCrc32c,
+    classifyHeadersSse42,
+};
+
+} // anonymous namespace
+
+namespace detail {
+
+uint64_t hashCrc32c(const void* data, size_t n) {
+    const uint8_t* p = static_cast<const uint8_t*>(data);
+    uint64_t crc = 0xFFFFFFFFu;
+
+    size_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        uint64_t word;
+        std::memcpy(&word, p + i, sizeof(word));
+        crc = _mm_crc32_u64(crc, word);
+    }
+    uint32_t crc32 = static_cast<uint32_t>(crc);
+    for (; i < n; i++) {
+        crc32 = _mm_crc32_u8(crc32, p[i]);
+    }
+    return hashFinalize(~crc32, n);
+}
+
+const SimdKernels* const kSse42Kernels = &kKernels;
+
+} // namespace detail
+
+} // namespace xdp_dns
@@ -0,0 +1,344 @@
+#include "xdp_dns/stats.hpp"
+#include "xdp_dns/memory.hpp"
+#include <sched.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <chrono>
+#include <cstddef>
+#include <cstring>
+#include <functional>
+
+namespace xdp_dns {
+
+namespace {
+
+constexpr size_t kRegionWords = sizeof(XDPDNSShmStats) / sizeof(uint64_t);
+constexpr size_t kSeqWord = offsetof(XDPDNSShmStats, seq) / sizeof(uint64_t);
+
+static_assert(sizeof(XDPDNSShmStats) % sizeof(uint64_t) == 0,
+              "XDPDNSShmStats must be a whole number of 64-bit words");
+static_assert(offsetof(XDPDNSShmStats, seq) % sizeof(uint64_t) == 0,
+              "seq must be 64-bit aligned");
+static_assert(offsetof(XDPDNSShmStats, total) == 128, "header must be 128 bytes");
+
+thread_local int t_slot = -1;
+thread_local uint32_t t_sample_tick = 0;
+
+void addCounters(XDPDNSShmCounters* dst, const CoreCounters& c) {
+    dst->packets_received += c.packets_received.load(std::memory_order_relaxed);
+    dst->packets_parsed += c.packets_parsed.load(std::memory_order_relaxed);
+    dst->packets_allowed += c.packets_allowed.load(std::memory_order_relaxed);
+    dst->packets_blocked += c.packets_blocked.load(std::memory_order_relaxed);
+    dst->packets_redirected += c.packets_redirected.load(std::memory_order_relaxed);
+    dst->parse_errors += c.parse_errors.load(std::memory_order_relaxed);
+    dst->response_built += c.response_built.load(std::memory_order_relaxed);
+    dst->sampled_latency_ns += c.sampled_latency_ns.load(std::memory_order_relaxed);
+}
+
+uint32_t latencyBucket(uint64_t ns) {
+    if (ns == 0) return 0;
+    uint32_t b = 64 - static_cast<uint32_t>(__builtin_clzll(ns));
+    return b < XDP_DNS_SHM_HIST_BUCKETS ? b : XDP_DNS_SHM_HIST_BUCKETS - 1;
+}
+
+} // anonymous namespace
+
+uint64_t wallClockNs() {
+    return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::system_clock::now().time_since_epoch()).count());
+}
+
+uint64_t monotonicNs() {
+    return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count());
+}
+
+// ==================== CoreCounters ====================
+
+CoreCounters::CoreCounters() {
+    for (auto& b : latency_hist) {
+        b.store(0, std::memory_order_relaxed);
+    }
+}
+
+void CoreCounters::reset() {
+    packets_received.store(0, std::memory_order_relaxed);
+    packets_parsed.store(0, std::memory_order_relaxed);
+    packets_allowed.store(0, std::memory_order_relaxed);
+    packets_blocked.store(0, std::memory_order_relaxed);
+    packets_redirected.store(0, std::memory_order_relaxed);
+    parse_errors.store(0, std::memory_order_relaxed);
+    response_built.store(0, std::memory_order_relaxed);
+    sampled_latency_ns.store(0, std::memory_order_relaxed);
+    latency_samples.store(0, std::memory_order_relaxed);
+    for (auto& b : latency_hist) {
+        b.store(0, std::memory_order_relaxed);
+    }
+}
+
+// ==================== StatsRegistry ====================
+
+StatsRegistry& StatsRegistry::instance() {
+    static StatsRegistry registry;
+    return registry;
+}
+
+CoreCounters& StatsRegistry::local() {
+    if (__builtin_expect(t_slot < 0, 0)) {
+        int cpu = sched_getcpu();
+        if (cpu < 0) {
+            cpu = static_cast<int>(std::hash<std::thread::id>{}(std::this_thread::get_id()));
+        }
+        t_slot = static_cast<int>(static_cast<unsigned>(cpu) % XDP_DNS_SHM_MAX_CORES);
+
+        uint32_t needed = static_cast<uint32_t>(t_slot) + 1;
+        uint32_t cur = num_slots_.load(std::memory_order_relaxed);
+        while (cur < needed &&
+               !num_slots_.compare_exchange_weak(cur, needed, std::memory_order_relaxed)) {
+        }
+    }
+    return cores_[t_slot];
+}
+
+bool StatsRegistry::shouldSample() {
+    return (t_sample_tick++ % kSampleInterval) == 0;
+}
+
+void StatsRegistry::recordLatency(uint64_t ns) {
+    CoreCounters& c = local();
+    c.sampled_latency_ns.fetch_add(ns, std::memory_order_relaxed);
+    c.latency_samples.fetch_add(1, std::memory_order_relaxed);
+    c.latency_hist[latencyBucket(ns)].fetch_add(1, std::memory_order_relaxed);
+}
+
+void StatsRegistry::setRuleInfo(uint64_t generation, uint64_t rule_count) {
+    rule_generation_.store(generation, std::memory_order_relaxed);
+    rule_count_.store(rule_count, std::memory_order_relaxed);
+    rule_update_time_ns_.store(wallClockNs(), std::memory_order_relaxed);
+}
+
+XDPDNSShmCounters StatsRegistry::total() const {
+    XDPDNSShmCounters sum = {};
+    uint32_t n = num_slots_.load(std::memory_order_relaxed);
+    for (uint32_t i = 0; i < n; i++) {
+        addCounters(&sum, cores_[i]);
+    }
+    return sum;
+}
+
+uint64_t StatsRegistry::latencySamples() const {
+    uint64_t sum = 0;
+    uint32_t n = num_slots_.load(std::memory_order_relaxed);
+    for (uint32_t i = 0; i < n; i++) {
+        sum += cores_[i].latency_samples.load(std::memory_order_relaxed);
+    }
+    return sum;
+}
+
+void StatsRegistry::snapshot(XDPDNSShmStats* out) const {
+    uint32_t n = num_slots_.load(std::memory_order_relaxed);
+    out->num_cores = n;
+
+    out->total = {};
+    out->latency_samples = 0;
+    for (auto& b : out->latency_hist) {
+        b = 0;
+    }
+
+    for (uint32_t i = 0; i < n; i++) {
+        const CoreCounters& c = cores_[i];
+        out->cores[i] = {};
+        addCounters(&out->cores[i], c);
+        addCounters(&out->total, c);
+
+        out->latency_samples += c.latency_samples.load(std::memory_order_relaxed);
+        for (uint32_t b = 0; b < XDP_DNS_SHM_HIST_BUCKETS; b++) {
+            out->latency_hist[b] += c.latency_hist[b].load(std::memory_order_relaxed);
+        }
+    }
+
+    out->rule_generation = rule_generation_.load(std::memory_order_relaxed);
+    out->rule_count = rule_count_.load(std::memory_order_relaxed);
+    out->rule_update_time_ns = rule_update_time_ns_.load(std::memory_order_relaxed);
+
+    MemoryUsage mem = MemoryAccounting::global().usage();
+    out->memory.node_bytes = mem.bytes[static_cast<size_t>(MemCategory::Nodes)];
+    out->memory.label_bytes = mem.bytes[static_cast<size_t>(MemCategory::Labels)];
+    out->memory.rule_bytes = mem.bytes[static_cast<size_t>(MemCategory::Rules)];
+    out->memory.cache_bytes = mem.bytes[static_cast<size_t>(MemCategory::Cache)];
+    out->memory.index_bytes = mem.bytes[static_cast<size_t>(MemCategory::Index)];
+    out->memory.reserved_bytes = mem.reserved_bytes;
+    out->memory.allocations = mem.allocations;
+    out->memory.rule_count = mem.rule_count;
+}
+
+void StatsRegistry::reset() {
+    for (auto& c : cores_) {
+        c.reset();
+    }
+}
+
+// ==================== StatsPublisher ====================
+
+StatsPublisher::~StatsPublisher() {
+    close();
+}
+
+bool StatsPublisher::open(const char* name) {
+    if (!name || region_) return false;
+
+    int fd = shm_open(name, O_CREAT | O_RDWR, 0644);
+    if (fd < 0) return false;
+
+    if (ftruncate(fd, sizeof(XDPDNSShmStats)) != 0) {
+        ::close(fd);
+        return false;
+    }
+
+    void* p = mmap(nullptr, sizeof(XDPDNSShmStats), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    ::close(fd);
+    if (p == MAP_FAILED) return false;
+
+    region_ = static_cast<XDPDNSShmStats*>(p);
+    std::memset(region_, 0, sizeof(XDPDNSShmStats));
+    region_->start_time_ns = wallClockNs();
+    name_ = name;
+
+    publish();
+    return true;
+}
+
+void StatsPublisher::publish() {
+    if (!region_) return;
+
+    XDPDNSShmStats snap;
+    std::memset(&snap, 0, sizeof(snap));
+    StatsRegistry::instance().snapshot(&snap);
+
+    snap.magic = XDP_DNS_SHM_MAGIC;
+    snap.version = XDP_DNS_SHM_VERSION;
+    snap.size = sizeof(XDPDNSShmStats);
+    snap.start_time_ns = region_->start_time_ns;
+    snap.publish_count = region_->publish_count + 1;
+    snap.publish_time_ns = wallClockNs();
+
+    uint64_t* dst = reinterpret_cast<uint64_t*>(region_);
+    const uint64_t* src = reinterpret_cast<const uint64_t*>(&snap);
+    uint64_t seq = __atomic_load_n(&region_->seq, __ATOMIC_RELAXED);
+
+    // seqlock 写: 奇数 → 写数据 → 偶数
+    __atomic_store_n(&region_->seq, seq + 1, __ATOMIC_RELAXED);
+    __atomic_thread_fence(__ATOMIC_RELEASE);
+    for (size_t i = 0; i < kRegionWords; i++) {
+        if (i == kSeqWord) continue;
+        __atomic_store_n(dst + i, src[i], __ATOMIC_RELAXED);
+    }
+    __atomic_store_n(&region_->seq, seq + 2, __ATOMIC_RELEASE);
+}
+
+bool StatsPublisher::start(uint32_t interval_ms) {
+    if (!region_ || interval_ms == 0) return false;
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (running_) return true;
+    running_ = true;
+    thread_ = std::thread(&StatsPublisher::run, this, interval_ms);
+    return true;
+}
+
+void StatsPublisher::run(uint32_t interval_ms) {
+    std::unique_lock<std::mutex> lock(mutex_);
+    while (running_) {
+        cv_.wait_for(lock, std::chrono::milliseconds(interval_ms));
+        if (!running_) break;
+        lock.unlock();
+        publish();
+        lock.lock();
+    }
+}
+
+void StatsPublisher::close() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        running_ = false;
+    }
+    cv_.notify_all();
+    if (thread_.joinable()) {
+        thread_.join();
+    }
+
+    if (region_) {
+        munmap(region_, sizeof(XDPDNSShmStats));
+        region_ = nullptr;
+        shm_unlink(name_.c_str());
+        name_.clear();
+    }
+}
+
+// ==================== StatsReader ====================
+
+StatsReader::~StatsReader() {
+    close();
+}
+
+bool StatsReader::open(const char* name) {
+    if (!name || region_) return false;
+
+    int fd = shm_open(name, O_RDONLY, 0);
+    if (fd < 0) return false;
+
+    struct stat st;
+    if (fstat(fd, &st) != 0 || static_cast<size_t>(st.st_size) < sizeof(XDPDNSShmStats)) {
+        ::close(fd);
+        return false;
+    }
+
+    void* p = mmap(nullptr, sizeof(XDPDNSShmStats), PROT_READ, MAP_SHARED, fd, 0);
+    ::close(fd);
+    if (p == MAP_FAILED) return false;
+
+    const auto* region = static_cast<const XDPDNSShmStats*>(p);
+    if (__atomic_load_n(&region->magic, __ATOMIC_ACQUIRE) != XDP_DNS_SHM_MAGIC ||
+        __atomic_load_n(&region->version, __ATOMIC_RELAXED) != XDP_DNS_SHM_VERSION) {
+        munmap(p, sizeof(XDPDNSShmStats));
+        return false;
+    }
+
+    region_ = region;
+    return true;
+}
+
+bool StatsReader::read(XDPDNSShmStats* out, int max_retries) const {
+    if (!region_ || !out) return false;
+
+    const uint64_t* src = reinterpret_cast<const uint64_t*>(region_);
+    uint64_t* dst = reinterpret_cast<uint64_t*>(out);
+
+    for (int attempt = 0; attempt < max_retries; attempt++) {
+        uint64_t s1 = __atomic_load_n(&region_->seq, __ATOMIC_ACQUIRE);
+        if (s1 & 1) continue;
+
+        for (size_t i = 0; i < kRegionWords; i++) {
+            dst[i] = __atomic_load_n(src + i, __ATOMIC_RELAXED);
+        }
+
+        __atomic_thread_fence(__ATOMIC_ACQUIRE);
+        uint64_t s2 = __atomic_load_n(&region_->seq, __ATOMIC_RELAXED);
+        if (s1 == s2) {
+            out->seq = s1;
+            return true;
+        }
+    }
+    return false;
+}
+
+void StatsReader::close() {
+    if (region_) {
+        munmap(const_cast<XDPDNSShmStats*>(region_), sizeof(XDPDNSShmStats));
+        region_ = nullptr;
+    }
+}
+
+} // namespace xdp_dns
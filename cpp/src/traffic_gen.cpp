@@ -0,0 +1,592 @@
+#include "xdp_dns/traffic_gen.hpp"
+#include <cmath>
+#include <cstdio>
+#include <functional>
+#include <numeric>
+
+namespace xdp_dns {
+namespace traffic_gen {
+
+namespace {
+
+// TLD 权重 (参考公开黑名单中的 TLD 占比)
+struct WeightedTld {
+    const char* tld;
+    double weight;
+};
+
+constexpr WeightedTld kTlds[] = {
+    {"com", 46.0}, {"net", 6.0},    {"org", 5.0},    {"ru", 4.0},
+    {"de", 3.0},   {"cn", 3.0},     {"info", 3.0},   {"xyz", 3.0},
+    {"top", 3.0},  {"io", 2.0},     {"co.uk", 2.0},  {"online", 2.0},
+    {"site", 2.0}, {"com.br", 2.0}, {"jp", 1.5},     {"fr", 1.5},
+    {"in", 1.5},   {"nl", 1.0},     {"pl", 1.0},     {"biz", 1.0},
+    {"club", 1.0}, {"tk", 1.0},     {"me", 1.0},     {"cc", 1.0},
+    {"co", 1.0},
+};
+
+// 注册域之下的子域层数分布: 0, 1, 2, 3, 4
+constexpr double kSubdomainDepthWeights[] = {45.0, 33.0, 14.0, 5.0, 3.0};
+
+// 常见子域前缀
+constexpr const char* kCommonPrefixes[] = {
+    "www", "api", "cdn", "ads", "ad", "track", "tracker", "stats", "m",
+    "static", "img", "mail", "login", "secure", "pixel", "metrics",
+    "analytics", "s", "t", "app", "update", "telemetry", "beacon", "data",
+};
+
+constexpr const char* kConsonants = "bcdfghjklmnprstvwz";
+constexpr const char* kVowels = "aeiou";
+constexpr const char* kAlnum = "abcdefghijklmnopqrstuvwxyz0123456789";
+
+// 子域复用概率: 规则集中大量规则共享同一注册域
+constexpr double kParentReuseRatio = 0.2;
+constexpr size_t kMaxParentPool = 1 << 20;
+
+// 64 位哈希集合 (开放寻址), 用于千万级去重, 避免保存所有字符串
+class HashSet64 {
+public:
+    explicit HashSet64(size_t expected) {
+        size_t cap = 16;
+        while (cap < expected * 2) cap <<= 1;
+        slots_.assign(cap, 0);
+        mask_ = cap - 1;
+    }
+
+    // 插入, 已存在返回 false
+    bool insert(uint64_t h) {
+        if (h == 0) h = 1;
+        if ((count_ + 1) * 2 > slots_.size()) grow();
+        return insertNoGrow(h);
+    }
+
+    bool contains(uint64_t h) const {
+        if (h == 0) h = 1;
+        for (size_t i = h & mask_;; i = (i + 1) & mask_) {
+            if (slots_[i] == 0) return false;
+            if (slots_[i] == h) return true;
+        }
+    }
+
+private:
+    bool insertNoGrow(uint64_t h) {
+        for (size_t i = h & mask_;; i = (i + 1) & mask_) {
+            if (slots_[i] == h) return false;
+            if (slots_[i] == 0) {
+                slots_[i] = h;
+                count_++;
+                return true;
+            }
+        }
+    }
+
+    void grow() {
+        std::vector<uint64_t> old;
+        old.swap(slots_);
+        slots_.assign(old.size() * 2, 0);
+        mask_ = slots_.size() - 1;
+        count_ = 0;
+        for (uint64_t h : old) {
+            if (h != 0) insertNoGrow(h);
+        }
+    }
+
+    std::vector<uint64_t> slots_;
+    size_t mask_ = 0;
+    size_t count_ = 0;
+};
+
+uint64_t hashDomain(const std::string& s) {
+    return std::hash<std::string>{}(s);
+}
+
+double uniform01(std::mt19937_64& rng) {
+    return std::uniform_real_distribution<double>(0.0, 1.0)(rng);
+}
+
+size_t uniformIndex(std::mt19937_64& rng, size_t n) {
+    return std::uniform_int_distribution<size_t>(0, n - 1)(rng);
+}
+
+// 可读的伪单词标签 (辅音+元音音节)
+std::string wordLabel(std::mt19937_64& rng) {
+    std::string s;
+    size_t syllables = 2 + uniformIndex(rng, 3);
+    for (size_t i = 0; i < syllables; i++) {
+        s += kConsonants[uniformIndex(rng, 18)];
+        s += kVowels[uniformIndex(rng, 5)];
+    }
+    if (uniform01(rng) < 0.15) {
+        s += static_cast<char>('0' + uniformIndex(rng, 10));
+    }
+    return s;
+}
+
+// DGA 风格随机标签
+std::string randomLabel(std::mt19937_64& rng, size_t min_len, size_t max_len) {
+    size_t len = min_len + uniformIndex(rng, max_len - min_len + 1);
+    std::string s(len, 'a');
+    for (auto& c : s) {
+        c = kAlnum[uniformIndex(rng, 36)];
+    }
+    return s;
+}
+
+std::string subdomainLabel(std::mt19937_64& rng) {
+    if (uniform01(rng) < 0.6) {
+        return kCommonPrefixes[uniformIndex(rng, sizeof(kCommonPrefixes) / sizeof(kCommonPrefixes[0]))];
+    }
+    return wordLabel(rng);
+}
+
+std::discrete_distribution<size_t> makeTldDistribution() {
+    std::vector<double> weights;
+    for (const auto& t : kTlds) {
+        weights.push_back(t.weight);
+    }
+    return std::discrete_distribution<size_t>(weights.begin(), weights.end());
+}
+
+// 为 [0, n) 构造一个与生成顺序无关的排列: idx = rank * mult mod n
+uint64_t chooseMultiplier(uint64_t n) {
+    if (n <= 1) return 1;
+    uint64_t mult = 0x9E3779B97F4A7C15ULL % n;
+    if (mult == 0) mult = 1;
+    while (std::gcd(mult, n) != 1) {
+        mult = (mult + 1) % n;
+        if (mult == 0) mult = 1;
+    }
+    return mult;
+}
+
+// 规则集索引: 用于确认未命中流量确实不命中任何规则
+class RuleIndex {
+public:
+    explicit RuleIndex(const std::vector<GeneratedRule>& rules)
+        : exact_(rules.size()), wildcard_(rules.size()) {
+        for (const auto& r : rules) {
+            (r.wildcard ? wildcard_ : exact_).insert(hashDomain(r.domain));
+        }
+    }
+
+    // 与 DomainTrie 语义一致: 精确匹配, 或任意后缀 (含自身) 存在通配符规则
+    bool matches(const std::string& domain) const {
+        if (exact_.contains(hashDomain(domain))) return true;
+        size_t pos = 0;
+        while (pos != std::string::npos) {
+            if (wildcard_.contains(hashDomain(domain.substr(pos)))) return true;
+            pos = domain.find('.', pos);
+            if (pos != std::string::npos) pos++;
+        }
+        return false;
+    }
+
+private:
+    HashSet64 exact_;
+    HashSet64 wildcard_;
+};
+
+// 编码 DNS 查询并追加到流
+void appendQuery(
+    QueryStream& stream,
+    const std::string& domain,
+    QueryKind kind,
+    uint16_t qtype,
+    bool compress,
+    bool mixed_case,
+    std::mt19937_64& rng
+) {
+    std::vector<uint8_t>& out = stream.data;
+    size_t start = out.size();
+
+    uint16_t id = static_cast<uint16_t>(rng());
+    const uint8_t header[DNS_HEADER_SIZE] = {
+        static_cast<uint8_t>(id >> 8), static_cast<uint8_t>(id & 0xFF),
+        0x01, 0x00,     // 标准查询, RD=1
+        0x00, 0x01,     // QDCount = 1
+        0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    };
+    out.insert(out.end(), header, header + DNS_HEADER_SIZE);
+
+    // 切分标签
+    std::vector<std::string> labels;
+    size_t begin = 0;
+    for (size_t i = 0; i <= domain.size(); i++) {
+        if (i == domain.size() || domain[i] == '.') {
+            labels.push_back(domain.substr(begin, i - begin));
+            begin = i + 1;
+        }
+    }
+
+    auto emitLabel = [&](const std::string& label) {
+        out.push_back(static_cast<uint8_t>(label.size()));
+        for (char c : label) {
+            if (mixed_case && c >= 'a' && c <= 'z' && (rng() & 1)) {
+                c = static_cast<char>(c - 'a' + 'A');
+            }
+            out.push_back(static_cast<uint8_t>(c));
+        }
+    };
+
+    // 压缩: 首标签后接指向问题之后的后缀, 用于覆盖解析器的指针路径
+    bool use_pointer = compress && labels.size() >= 2;
+    size_t pointer_pos = 0;
+
+    emitLabel(labels[0]);
+    if (use_pointer) {
+        pointer_pos = out.size();
+        out.push_back(0xC0);
+        out.push_back(0x00);
+    } else {
+        for (size_t i = 1; i < labels.size(); i++) {
+            emitLabel(labels[i]);
+        }
+        out.push_back(0);
+    }
+
+    out.push_back(static_cast<uint8_t>(qtype >> 8));
+    out.push_back(static_cast<uint8_t>(qtype & 0xFF));
+    out.push_back(0x00);
+    out.push_back(0x01);  // Class IN
+
+    if (use_pointer) {
+        size_t target = out.size() - start;
+        out[pointer_pos] = static_cast<uint8_t>(0xC0 | (target >> 8));
+        out[pointer_pos + 1] = static_cast<uint8_t>(target & 0xFF);
+        for (size_t i = 1; i < labels.size(); i++) {
+            emitLabel(labels[i]);
+        }
+        out.push_back(0);
+    }
+
+    stream.offsets.push_back(static_cast<uint32_t>(start));
+    stream.lengths.push_back(static_cast<uint16_t>(out.size() - start));
+    stream.domains.push_back(domain);
+    stream.kinds.push_back(kind);
+}
+
+const char* actionName(Action action) {
+    switch (action) {
+        case Action::Block:    return "block";
+        case Action::Redirect: return "redirect";
+        case Action::Log:      return "log";
+        default:               return "allow";
+    }
+}
+
+void putU16(uint8_t* p, uint16_t v) {
+    p[0] = static_cast<uint8_t>(v >> 8);
+    p[1] = static_cast<uint8_t>(v & 0xFF);
+}
+
+} // anonymous namespace
+
+// ==================== ZipfSampler ====================
+
+ZipfSampler::ZipfSampler(uint64_t n, double s) : n_(n < 1 ? 1 : n), s_(s) {
+    h_integral_x1_ = hIntegral(1.5) - 1.0;
+    h_integral_n_ = hIntegral(static_cast<double>(n_) + 0.5);
+    threshold_ = 2.0 - hIntegralInverse(hIntegral(2.5) - h(2.0));
+}
+
+double ZipfSampler::h(double x) const {
+    return std::exp(-s_ * std::log(x));
+}
+
+double ZipfSampler::hIntegral(double x) const {
+    double log_x = std::log(x);
+    double t = (1.0 - s_) * log_x;
+    // expm1(t) / t, t → 0 时取极限 1
+    double helper = std::abs(t) > 1e-8 ? std::expm1(t) / t : 1.0 + t * 0.5;
+    return helper * log_x;
+}
+
+double ZipfSampler::hIntegralInverse(double x) const {
+    double t = x * (1.0 - s_);
+    if (t < -1.0) t = -1.0;
+    // log1p(t) / t, t → 0 时取极限 1
+    double helper = std::abs(t) > 1e-8 ? std::log1p(t) / t : 1.0 - t * 0.5;
+    return std::exp(helper * x);
+}
+
+uint64_t ZipfSampler::sample(std::mt19937_64& rng) {
+    for (;;) {
+        double u = h_integral_n_ + uniform01(rng) * (h_integral_x1_ - h_integral_n_);
+        double x = hIntegralInverse(u);
+        uint64_t k = static_cast<uint64_t>(x + 0.5);
+        if (k < 1) {
+            k = 1;
+        } else if (k > n_) {
+            k = n_;
+        }
+        double kd = static_cast<double>(k);
+        if (kd - x <= threshold_ || u >= hIntegral(kd + 0.5) - h(kd)) {
+            return k;
+        }
+    }
+}
+
+// ==================== 规则集生成 ====================
+
+std::vector<GeneratedRule> generateRuleSet(const RuleSetOptions& opts) {
+    std::mt19937_64 rng(opts.seed);
+    auto tld_dist = makeTldDistribution();
+    std::discrete_distribution<size_t> depth_dist(
+        std::begin(kSubdomainDepthWeights), std::end(kSubdomainDepthWeights));
+
+    std::vector<GeneratedRule> rules;
+    rules.reserve(opts.num_rules);
+    HashSet64 seen(opts.num_rules);
+    std::vector<std::string> parents;
+
+    while (rules.size() < opts.num_rules) {
+        size_t depth = depth_dist(rng);
+
+        std::string registrable;
+        if (depth > 0 && !parents.empty() && uniform01(rng) < kParentReuseRatio) {
+            registrable = parents[uniformIndex(rng, parents.size())];
+        } else {
+            std::string sld = uniform01(rng) < opts.dga_ratio
+                ? randomLabel(rng, 12, 24)
+                : wordLabel(rng);
+            registrable = sld + "." + kTlds[tld_dist(rng)].tld;
+            if (parents.size() < kMaxParentPool) {
+                parents.push_back(registrable);
+            }
+        }
+
+        std::string domain = registrable;
+        for (size_t i = 0; i < depth; i++) {
+            domain = subdomainLabel(rng) + "." + domain;
+        }
+        if (domain.size() > MAX_DOMAIN_LENGTH - 3) {
+            continue;
+        }
+        if (!seen.insert(hashDomain(domain))) {
+            continue;
+        }
+
+        GeneratedRule rule;
+        rule.domain = std::move(domain);
+        rule.wildcard = uniform01(rng) < opts.wildcard_ratio;
+
+        double a = uniform01(rng);
+        if (a < opts.redirect_ratio) {
+            rule.action = Action::Redirect;
+        } else if (a < opts.redirect_ratio + opts.log_ratio) {
+            rule.action = Action::Log;
+        } else {
+            rule.action = Action::Block;
+        }
+        rules.push_back(std::move(rule));
+    }
+
+    return rules;
+}
+
+// ==================== 查询流生成 ====================
+
+QueryStream generateQueries(
+    const std::vector<GeneratedRule>& rules,
+    const QueryStreamOptions& opts
+) {
+    std::mt19937_64 rng(opts.seed);
+    auto tld_dist = makeTldDistribution();
+    RuleIndex index(rules);
+
+    // 正常流量域名池 (保证不命中任何规则)
+    std::vector<std::string> universe;
+    universe.reserve(opts.miss_universe);
+    while (universe.size() < opts.miss_universe) {
+        std::string domain = wordLabel(rng) + "." + kTlds[tld_dist(rng)].tld;
+        if (uniform01(rng) < 0.4) {
+            domain = subdomainLabel(rng) + "." + domain;
+        }
+        if (!index.matches(domain)) {
+            universe.push_back(std::move(domain));
+        }
+    }
+
+    std::vector<std::string> targets;
+    for (size_t i = 0; i < opts.attack_targets && i < universe.size(); i++) {
+        targets.push_back(universe[i]);
+    }
+
+    ZipfSampler rule_zipf(rules.empty() ? 1 : rules.size(), opts.zipf_s);
+    ZipfSampler miss_zipf(universe.empty() ? 1 : universe.size(), opts.zipf_s);
+    uint64_t rule_mult = chooseMultiplier(rules.size());
+
+    QueryStream stream;
+    stream.data.reserve(opts.num_queries * 40);
+    stream.offsets.reserve(opts.num_queries);
+    stream.lengths.reserve(opts.num_queries);
+    stream.domains.reserve(opts.num_queries);
+    stream.kinds.reserve(opts.num_queries);
+
+    for (size_t q = 0; q < opts.num_queries; q++) {
+        double r = uniform01(rng);
+        std::string domain;
+        QueryKind kind;
+
+        if (r < opts.attack_ratio && !targets.empty()) {
+            kind = QueryKind::Attack;
+            domain = randomLabel(rng, 10, 16) + "." + targets[uniformIndex(rng, targets.size())];
+        } else if (r < opts.attack_ratio + opts.hit_ratio && !rules.empty()) {
+            kind = QueryKind::Hit;
+            uint64_t rank = rule_zipf.sample(rng) - 1;
+            const GeneratedRule& rule = rules[(rank * rule_mult) % rules.size()];
+            domain = rule.domain;
+            if (rule.wildcard && uniform01(rng) < 0.7) {
+                domain = subdomainLabel(rng) + "." + domain;
+            }
+        } else if (!universe.empty()) {
+            kind = QueryKind::Miss;
+            domain = universe[miss_zipf.sample(rng) - 1];
+        } else {
+            continue;
+        }
+
+        uint16_t qtype = uniform01(rng) < opts.aaaa_ratio ? dns_type::AAAA : dns_type::A;
+        bool compress = uniform01(rng) < opts.compression_ratio;
+        bool mixed = uniform01(rng) < opts.mixed_case_ratio;
+        appendQuery(stream, domain, kind, qtype, compress, mixed, rng);
+    }
+
+    return stream;
+}
+
+// ==================== 输出 ====================
+
+bool writeRuleList(const std::vector<GeneratedRule>& rules, const char* path) {
+    FILE* f = std::fopen(path, "w");
+    if (!f) return false;
+
+    for (const auto& r : rules) {
+        std::fprintf(f, "%s%s\n", r.wildcard ? "*." : "", r.domain.c_str());
+    }
+    return std::fclose(f) == 0;
+}
+
+bool writeRuleYaml(
+    const std::vector<GeneratedRule>& rules,
+    const char* path,
+    size_t chunk
+) {
+    FILE* f = std::fopen(path, "w");
+    if (!f) return false;
+    if (chunk == 0) chunk = 1;
+
+    std::fprintf(f, "rules:\n");
+
+    const Action actions[] = {Action::Block, Action::Redirect, Action::Log};
+    size_t rule_no = 0;
+    for (Action action : actions) {
+        size_t in_chunk = 0;
+        for (const auto& r : rules) {
+            if (r.action != action) continue;
+            if (in_chunk == 0) {
+                std::fprintf(f, "  - id: gen-%06zu\n", ++rule_no);
+                std::fprintf(f, "    priority: 100\n");
+                std::fprintf(f, "    enabled: true\n");
+                std::fprintf(f, "    action: %s\n", actionName(action));
+                if (action == Action::Redirect) {
+                    std::fprintf(f, "    redirect_ip: 10.0.0.1\n");
+                    std::fprintf(f, "    redirect_ttl: 300\n");
+                }
+                std::fprintf(f, "    domains:\n");
+            }
+            std::fprintf(f, "      - \"%s%s\"\n", r.wildcard ? "*." : "", r.domain.c_str());
+            if (++in_chunk == chunk) in_chunk = 0;
+        }
+    }
+    return std::fclose(f) == 0;
+}
+
+bool writePcap(const QueryStream& stream, const char* path) {
+    FILE* f = std::fopen(path, "wb");
+    if (!f) return false;
+
+    // pcap 全局头 (本机字节序, 微秒精度, LINKTYPE_ETHERNET)
+    struct {
+        uint32_t magic = 0xa1b2c3d4;
+        uint16_t version_major = 2;
+        uint16_t version_minor = 4;
+        int32_t thiszone = 0;
+        uint32_t sigfigs = 0;
+        uint32_t snaplen = 65535;
+        uint32_t linktype = 1;
+    } global;
+    std::fwrite(&global, sizeof(global), 1, f);
+
+    constexpr size_t kL2L4 = 14 + 20 + 8;
+    uint8_t frame[kL2L4 + 65535];
+
+    for (size_t i = 0; i < stream.size(); i++) {
+        size_t dns_len = stream.packetLength(i);
+        size_t frame_len = kL2L4 + dns_len;
+
+        // Ethernet
+        const uint8_t eth[14] = {
+            0x02, 0x00, 0x00, 0x00, 0x00, 0x01,
+            0x02, 0x00, 0x00, 0x00, 0x00, 0x02,
+            0x08, 0x00,
+        };
+        std::memcpy(frame, eth, sizeof(eth));
+
+        // IPv4 (源地址在 10.0.0.0/8 内轮转)
+        uint8_t* ip = frame + 14;
+        uint32_t src = 0x0A000000 | static_cast<uint32_t>((i * 2654435761u) & 0x00FFFFFF);
+        std::memset(ip, 0, 20);
+        ip[0] = 0x45;
+        putU16(ip + 2, static_cast<uint16_t>(20 + 8 + dns_len));
+        putU16(ip + 4, static_cast<uint16_t>(i));
+        ip[8] = 64;
+        ip[9] = 17;
+        ip[12] = static_cast<uint8_t>(src >> 24);
+        ip[13] = static_cast<uint8_t>(src >> 16);
+        ip[14] = static_cast<uint8_t>(src >> 8);
+        ip[15] = static_cast<uint8_t>(src);
+        ip[16] = 10; ip[17] = 0; ip[18] = 0; ip[19] = 53;
+        uint32_t sum = 0;
+        for (int j = 0; j < 20; j += 2) {
+            sum += (static_cast<uint32_t>(ip[j]) << 8) | ip[j + 1];
+        }
+        while (sum >> 16) sum = (sum & 0xFFFF) + (sum >> 16);
+        putU16(ip + 10, static_cast<uint16_t>(~sum));
+
+        // UDP (校验和为 0, IPv4 下合法)
+        uint8_t* udp = ip + 20;
+        putU16(udp, static_cast<uint16_t>(1024 + (i * 7919) % 64000));
+        putU16(udp + 2, 53);
+        putU16(udp + 4, static_cast<uint16_t>(8 + dns_len));
+        putU16(udp + 6, 0);
+
+        std::memcpy(frame + kL2L4, stream.packet(i), dns_len);
+
+        uint32_t rec[4] = {
+            static_cast<uint32_t>(i / 1000000),
+            static_cast<uint32_t>(i % 1000000),
+            static_cast<uint32_t>(frame_len),
+            static_cast<uint32_t>(frame_len),
+        };
+        std::fwrite(rec, sizeof(rec), 1, f);
+        std::fwrite(frame, 1, frame_len, f);
+    }
+    return std::fclose(f) == 0;
+}
+
+bool writeRaw(const QueryStream& stream, const char* path) {
+    FILE* f = std::fopen(path, "wb");
+    if (!f) return false;
+
+    for (size_t i = 0; i < stream.size(); i++) {
+        uint8_t len[2];
+        putU16(len, static_cast<uint16_t>(stream.packetLength(i)));
+        std::fwrite(len, 1, 2, f);
+        std::fwrite(stream.packet(i), 1, stream.packetLength(i), f);
+    }
+    return std::fclose(f) == 0;
+}
+
+} // namespace traffic_gen
+} // namespace xdp_dns
@@ -0,0 +1,274 @@
+#include "xdp_dns/xsk_source.hpp"
+#include <linux/if_xdp.h>
+#include <sys/socket.h>
+#include <algorithm>
+#include <cstring>
+
+namespace xdp_dns {
+
+namespace {
+
+constexpr uint32_t kPendingSize = 1u << XskSource::kPendingBits;
+constexpr uint8_t kResponseHopLimit = 64;
+
+bool isPow2(uint32_t v) {
+    return v && (v & (v - 1)) == 0;
+}
+
+bool validRing(const XskRing& r) {
+    return r.producer && r.consumer && r.descs && isPow2(r.size);
+}
+
+uint32_t loadAcquire(const uint32_t* p) {
+    return __atomic_load_n(p, __ATOMIC_ACQUIRE);
+}
+
+void storeRelease(uint32_t* p, uint32_t v) {
+    __atomic_store_n(p, v, __ATOMIC_RELEASE);
+}
+
+void swapBytes(uint8_t* a, uint8_t* b, size_t n) {
+    uint8_t tmp[16];
+    std::memcpy(tmp, a, n);
+    std::memcpy(a, b, n);
+    std::memcpy(b, tmp, n);
+}
+
+uint32_t sumWords(const uint8_t* p, size_t len, uint32_t sum) {
+    for (; len > 1; p += 2, len -= 2) {
+        sum += static_cast<uint32_t>(p[0]) << 8 | p[1];
+    }
+    if (len) sum += static_cast<uint32_t>(p[0]) << 8;
+    return sum;
+}
+
+uint16_t foldChecksum(uint32_t sum) {
+    while (sum >> 16) {
+        sum = (sum & 0xffff) + (sum >> 16);
+    }
+    return static_cast<uint16_t>(~sum);
+}
+
+} // anonymous namespace
+
+// ==================== 帧改写 ====================
+
+uint32_t reflectFrame(uint8_t* frame, const FrameInfo& info, uint32_t payload_len) {
+    uint8_t* l3 = frame + info.l3_offset;
+    uint8_t* udp = frame + info.l4_offset;
+    uint16_t udp_len = static_cast<uint16_t>(8 + payload_len);
+
+    swapBytes(frame, frame + 6, 6);
+    swapBytes(udp, udp + 2, 2);
+    writeU16(udp + 4, udp_len);
+    writeU16(udp + 6, 0);
+
+    uint16_t ip_header_len = static_cast<uint16_t>(info.l4_offset - info.l3_offset);
+    if (info.ip_version == 4) {
+        swapBytes(l3 + 12, l3 + 16, 4);
+        writeU16(l3 + 2, static_cast<uint16_t>(ip_header_len + udp_len));
+        writeU16(l3 + 6, 0);                    // 清除分片字段
+        l3[8] = kResponseHopLimit;
+        writeU16(l3 + 10, 0);
+        writeU16(l3 + 10, foldChecksum(sumWords(l3, ip_header_len, 0)));
+        // IPv4 的 UDP 校验和可选, 保持 0
+    } else {
+        swapBytes(l3 + 8, l3 + 24, 16);
+        writeU16(l3 + 4, static_cast<uint16_t>(ip_header_len - 40 + udp_len));
+        l3[7] = kResponseHopLimit;
+
+        // 伪头部: 源 / 目的地址, UDP 长度, 下一头部 (17)
+        uint32_t sum = sumWords(l3 + 8, 32, 0);
+        sum += udp_len;
+        sum += 17;
+        uint16_t csum = foldChecksum(sumWords(udp, udp_len, sum));
+        writeU16(udp + 6, csum ? csum : 0xffff);
+    }
+    return info.payload_offset + payload_len;
+}
+
+// ==================== XskSource ====================
+
+XskSource::XskSource(const XskConfig& cfg) : cfg_(cfg), pending_(kPendingSize) {
+    uint64_t frames = cfg_.umem_size / cfg_.frame_size;
+    free_.reserve(frames);
+    for (uint64_t i = frames; i > 0; i--) {
+        free_.push_back((i - 1) * cfg_.frame_size);
+    }
+    // fill 环在 worker 第一次 receive 时填充, 构造本身不改动共享的环
+}
+
+bool XskSource::valid(const XskConfig& cfg) {
+    return cfg.umem && isPow2(cfg.frame_size) && cfg.frame_size >= 1024 && cfg.mtu >= 576 &&
+           cfg.umem_size / cfg.frame_size > cfg.tx_reserve &&
+           validRing(cfg.fill) && validRing(cfg.completion) &&
+           validRing(cfg.rx) && validRing(cfg.tx);
+}
+
+size_t XskSource::receive(PacketBuf* pkts, size_t max) {
+    reclaim();
+    refill();
+    if (tx_pending_) kick();
+
+    uint32_t cons = *cfg_.rx.consumer;
+    uint32_t avail = loadAcquire(cfg_.rx.producer) - cons;
+    size_t count = std::min<size_t>({max, kMaxBatch, avail});
+    if (count == 0) return 0;
+
+    const auto* descs = static_cast<const xdp_desc*>(cfg_.rx.descs);
+    uint32_t mask = cfg_.rx.size - 1;
+    size_t n = 0;
+    size_t skipped = 0;
+    for (size_t i = 0; i < count; i++) {
+        const xdp_desc& d = descs[(cons + i) & mask];
+        uint8_t* frame = cfg_.umem + d.addr;
+        RxFrame& f = batch_[n];
+        if (FrameParser::parse(frame, d.len, &f.info) != Error::Success ||
+            (f.info.flags & (FRAME_FRAGMENT | FRAME_IPV6_EXT)) ||
+            f.info.payload_offset > sizeof(Pending::header)) {
+            free_.push_back(d.addr - d.addr % cfg_.frame_size);
+            skipped++;
+            continue;
+        }
+        f.addr = d.addr;
+        pkts[n] = PacketBuf{frame + f.info.payload_offset, f.info.payload_len,
+                            capacityOf(d.addr, f.info), ++next_cookie_};
+        n++;
+    }
+    storeRelease(cfg_.rx.consumer, cons + static_cast<uint32_t>(count));
+
+    rx_frames_.fetch_add(count, std::memory_order_relaxed);
+    if (skipped) {
+        rx_skipped_.fetch_add(skipped, std::memory_order_relaxed);
+        refill();
+    }
+    return n;
+}
+
+void XskSource::complete(const PacketBuf* pkts, const PacketVerdict* verdicts, size_t n) {
+    uint64_t dropped = 0;
+    for (size_t i = 0; i < n; i++) {
+        const RxFrame& f = batch_[i];
+        uint64_t base = f.addr - f.addr % cfg_.frame_size;
+        uint8_t* frame = cfg_.umem + f.addr;
+
+        if (verdicts[i] == PacketVerdict::Respond) {
+            uint32_t len = reflectFrame(frame, f.info, pkts[i].len);
+            if (!enqueueTx(f.addr, len)) {
+                free_.push_back(base);
+                dropped++;
+            }
+            continue;
+        }
+
+        if (verdicts[i] == PacketVerdict::Forwarded) {
+            Pending& p = pending_[pkts[i].cookie & (kPendingSize - 1)];
+            p.cookie = pkts[i].cookie;
+            p.info = f.info;
+            std::memcpy(p.header, frame, f.info.payload_offset);
+        }
+        free_.push_back(base);
+    }
+
+    if (dropped) tx_dropped_.fetch_add(dropped, std::memory_order_relaxed);
+    if (tx_pending_) kick();
+    refill();
+}
+
+bool XskSource::transmit(uint64_t cookie, const uint8_t* data, size_t len) {
+    // 槽已被更新的查询覆盖 (在途超过 kPendingSize) 时放弃
+    Pending& p = pending_[cookie & (kPendingSize - 1)];
+    uint32_t offset = p.info.payload_offset;
+    if (p.cookie != cookie || offset + len > cfg_.frame_size ||
+        len + (offset - p.info.l3_offset) > cfg_.mtu) {
+        tx_dropped_.fetch_add(1, std::memory_order_relaxed);
+        return false;
+    }
+    p.cookie = 0;
+
+    reclaim();
+    if (free_.empty()) {
+        tx_dropped_.fetch_add(1, std::memory_order_relaxed);
+        return false;
+    }
+    uint64_t addr = free_.back();
+    free_.pop_back();
+
+    uint8_t* frame = cfg_.umem + addr;
+    std::memcpy(frame, p.header, offset);
+    std::memcpy(frame + offset, data, len);
+    if (!enqueueTx(addr, reflectFrame(frame, p.info, static_cast<uint32_t>(len)))) {
+        free_.push_back(addr);
+        tx_dropped_.fetch_add(1, std::memory_order_relaxed);
+        return false;
+    }
+    // 唤醒留到下一次 receive, 一轮上游响应只发一次系统调用
+    return true;
+}
+
+XskSourceStats XskSource::stats() const {
+    XskSourceStats s;
+    s.rx_frames = rx_frames_.load(std::memory_order_relaxed);
+    s.rx_skipped = rx_skipped_.load(std::memory_order_relaxed);
+    s.tx_frames = tx_frames_.load(std::memory_order_relaxed);
+    s.tx_dropped = tx_dropped_.load(std::memory_order_relaxed);
+    return s;
+}
+
+void XskSource::reclaim() {
+    uint32_t cons = *cfg_.completion.consumer;
+    uint32_t prod = loadAcquire(cfg_.completion.producer);
+    if (cons == prod) return;
+
+    const auto* descs = static_cast<const uint64_t*>(cfg_.completion.descs);
+    uint32_t mask = cfg_.completion.size - 1;
+    for (uint32_t i = cons; i != prod; i++) {
+        uint64_t addr = descs[i & mask];
+        free_.push_back(addr - addr % cfg_.frame_size);
+    }
+    storeRelease(cfg_.completion.consumer, prod);
+}
+
+void XskSource::refill() {
+    uint32_t prod = *cfg_.fill.producer;
+    uint32_t space = cfg_.fill.size - (prod - loadAcquire(cfg_.fill.consumer));
+    if (space == 0 || free_.size() <= cfg_.tx_reserve) return;
+
+    auto* descs = static_cast<uint64_t*>(cfg_.fill.descs);
+    uint32_t mask = cfg_.fill.size - 1;
+    uint32_t start = prod;
+    while (space-- && free_.size() > cfg_.tx_reserve) {
+        descs[prod++ & mask] = free_.back();
+        free_.pop_back();
+    }
+    if (prod != start) storeRelease(cfg_.fill.producer, prod);
+}
+
+bool XskSource::enqueueTx(uint64_t addr, uint32_t len) {
+    uint32_t prod = *cfg_.tx.producer;
+    if (prod - loadAcquire(cfg_.tx.consumer) >= cfg_.tx.size) return false;
+
+    auto* descs = static_cast<xdp_desc*>(cfg_.tx.descs);
+    descs[prod & (cfg_.tx.size - 1)] = xdp_desc{addr, len, 0};
+    storeRelease(cfg_.tx.producer, prod + 1);
+    tx_pending_ = true;
+    tx_frames_.fetch_add(1, std::memory_order_relaxed);
+    return true;
+}
+
+void XskSource::kick() {
+    tx_pending_ = false;
+    if (cfg_.fd >= 0) {
+        // EAGAIN / EBUSY / ENOBUFS 表示内核仍在发送, 下一轮再唤醒
+        (void)sendto(cfg_.fd, nullptr, 0, MSG_DONTWAIT, nullptr, 0);
+    }
+}
+
+uint32_t XskSource::capacityOf(uint64_t addr, const FrameInfo& info) const {
+    uint64_t chunk_end = addr - addr % cfg_.frame_size + cfg_.frame_size;
+    uint64_t by_frame = chunk_end - (addr + info.payload_offset);
+    uint64_t by_mtu = cfg_.mtu - (info.payload_offset - info.l3_offset);
+    return static_cast<uint32_t>(std::min(by_frame, by_mtu));
+}
+
+} // namespace xdp_dns
@@ -0,0 +1,177 @@
+#include <gtest/gtest.h>
+#include "xdp_dns/arena.hpp"
+#include "xdp_dns/domain_trie.hpp"
+#include "xdp_dns/memory.hpp"
+#include "xdp_dns/numa.hpp"
+#include <cstring>
+#include <string>
+
+using namespace xdp_dns;
+
+TEST(ArenaTest, AlignedSequentialAllocation) {
+    ArenaOptions opts;
+    Arena arena(opts);
+
+    void* a = arena.allocate(3, 1);
+    void* b = arena.allocate(sizeof(uint64_t), alignof(uint64_t));
+    void* c = arena.allocate(64, 64);
+
+    EXPECT_EQ(reinterpret_cast<uintptr_t>(b) % alignof(uint64_t), 0u);
+    EXPECT_EQ(reinterpret_cast<uintptr_t>(c) % 64, 0u);
+    EXPECT_GT(b, a);
+    EXPECT_GT(c, b);
+    EXPECT_EQ(arena.used(), 3u + sizeof(uint64_t) + 64u);
+    EXPECT_EQ(arena.reserved(), opts.initial_chunk);
+
+    std::memset(c, 0xab, 64);
+    arena.deallocate(c, 64, 64);  // 空操作
+    EXPECT_EQ(arena.used(), 3u + sizeof(uint64_t) + 64u);
+}
+
+TEST(ArenaTest, ChunksGrowAndOversizedRequestsFit) {
+    ArenaOptions opts;
+    opts.initial_chunk = 4096;
+    opts.max_chunk = 16384;
+    Arena arena(opts);
+
+    for (int i = 0; i < 64; i++) {
+        void* p = arena.allocate(1000, 8);
+        std::memset(p, i, 1000);
+    }
+    EXPECT_GE(arena.reserved(), arena.used());
+
+    // 大于 max_chunk 的请求单独成块
+    void* big = arena.allocate(1 << 20, 16);
+    std::memset(big, 0, 1 << 20);
+    EXPECT_GE(arena.reserved(), (1u << 20) + 64 * 1000u);
+
+    arena.release();
+    EXPECT_EQ(arena.reserved(), 0u);
+    EXPECT_EQ(arena.used(), 0u);
+}
+
+TEST(ArenaTest, HugePageOptionFallsBackGracefully) {
+    ArenaOptions opts;
+    opts.huge_pages = true;
+    Arena arena(opts);
+
+    // 小于阈值的块用普通页, 小 Trie 不占用整个大页
+    void* p = arena.allocate(128, 8);
+    ASSERT_NE(p, nullptr);
+    EXPECT_LT(arena.reserved(), kHugePageSize);
+    EXPECT_EQ(arena.hugePageBytes(), 0u);
+
+    // 达到阈值的块按 2MB 映射; 没有预留 hugetlbfs 大页时回退到 THP
+    size_t before = arena.reserved();
+    void* big = arena.allocate(kHugePageSize, 64);
+    ASSERT_NE(big, nullptr);
+    EXPECT_EQ((arena.reserved() - before) % kHugePageSize, 0u);
+    EXPECT_LE(arena.hugePageBytes(), arena.reserved());
+}
+
+TEST(ArenaTest, NumaNodeListKeepsSparseIds) {
+    EXPECT_EQ(numaParseNodeList("0\n"), (std::vector<int>{0}));
+    EXPECT_EQ(numaParseNodeList("0,2-3\n"), (std::vector<int>{0, 2, 3}));
+    EXPECT_TRUE(numaParseNodeList("").empty());
+}
+
+TEST(ArenaTest, NumaPlacementOnLocalNode) {
+    ASSERT_GE(numaNodeCount(), 1);
+    int node = numaCurrentNode();
+    ASSERT_GE(node, 0);
+    EXPECT_TRUE(numaNodeOnline(node));
+    EXPECT_EQ(numaOnlineNodes().size(), static_cast<size_t>(numaNodeCount()));
+    EXPECT_EQ(numaNodeOfNetdev("lo"), kNumaNodeAny);
+    EXPECT_EQ(numaNodeOfNetdev("../../etc"), kNumaNodeAny);
+
+    ArenaOptions opts;
+    opts.huge_pages = true;
+    opts.numa_node = node;
+    Arena arena(opts);
+
+    void* p = arena.allocate(kHugePageSize, 64);
+    ASSERT_NE(p, nullptr);
+    std::memset(p, 0x5a, 4096);
+    EXPECT_EQ(arena.reserved() % kHugePageSize, 0u);
+}
+
+TEST(ArenaTest, DefaultOptionsApplyToNewTries) {
+    ArenaOptions saved = defaultArenaOptions();
+
+    ArenaOptions opts;
+    opts.enabled = false;
+    setDefaultArenaOptions(opts);
+    {
+        Rule rule;
+        DomainTrie trie;
+        trie.insert(std::string("a.example.com"), &rule);
+        EXPECT_GT(trie.memoryUsage().allocations, 0u);
+        // malloc 模式下实际占用只有 malloc_usable_size, 远小于一个 Arena 块
+        EXPECT_LT(trie.memoryUsage().reserved_bytes, ArenaOptions().initial_chunk);
+    }
+
+    setDefaultArenaOptions(saved);
+    EXPECT_TRUE(defaultArenaOptions().enabled);
+}
+
+TEST(ArenaTest, AccountingChargesMappedBytes) {
+    MemoryUsage before = MemoryAccounting::global().usage();
+    {
+        MemoryAccounting memory{ArenaOptions()};
+        EXPECT_TRUE(memory.usesArenas());
+
+        auto* nodes = memory.resource(MemCategory::Nodes);
+        void* p = nodes->allocate(100, 8);
+        nodes->deallocate(p, 100, 8);
+        p = nodes->allocate(200, 8);
+        ASSERT_NE(p, nullptr);
+
+        // 已释放的 100 字节不再计入请求字节, 但仍占用 Arena 空间
+        MemoryUsage u = memory.usage();
+        EXPECT_EQ(u.bytes[static_cast<size_t>(MemCategory::Nodes)], 200u);
+        EXPECT_EQ(u.allocations, 1u);
+        EXPECT_GE(u.reserved_bytes, ArenaOptions().initial_chunk);
+        EXPECT_GT(u.fragmentation(), 0.9);
+    }
+    // 整代释放后全局计数恢复
+    MemoryUsage after = MemoryAccounting::global().usage();
+    EXPECT_EQ(after.totalBytes(), before.totalBytes());
+    EXPECT_EQ(after.reserved_bytes, before.reserved_bytes);
+    EXPECT_EQ(after.allocations, before.allocations);
+}
+
+TEST(ArenaTest, TrieWithAndWithoutArenaMatchesSame) {
+    ArenaOptions malloc_opts;
+    malloc_opts.enabled = false;
+
+    DomainTrie arena_trie;
+    DomainTrie malloc_trie(malloc_opts);
+
+    std::vector<std::pair<std::string, Rule>> rules;
+    for (int i = 0; i < 1000; i++) {
+        Rule r;
+        r.id = static_cast<uint32_t>(i);
+        r.action = Action::Block;
+        rules.emplace_back((i % 3 == 0 ? "*.d" : "d") + std::to_string(i) + ".example.com", r);
+    }
+    arena_trie.updateRules(rules);
+    malloc_trie.updateRules(rules);
+
+    for (int i = 0; i < 1000; i++) {
+        std::string q = (i % 3 == 0 ? "x.d" : "d") + std::to_string(i) + ".example.com";
+        const Rule* a = arena_trie.match(q);
+        const Rule* m = malloc_trie.match(q);
+        ASSERT_NE(a, nullptr);
+        ASSERT_NE(m, nullptr);
+        EXPECT_EQ(a->id, m->id);
+    }
+    EXPECT_EQ(arena_trie.match("nothing.example.com"), nullptr);
+
+    // 请求字节数相同, 只有实际占用不同
+    MemoryUsage ua = arena_trie.memoryUsage();
+    MemoryUsage um = malloc_trie.memoryUsage();
+    EXPECT_EQ(ua.bytes[static_cast<size_t>(MemCategory::Nodes)],
+              um.bytes[static_cast<size_t>(MemCategory::Nodes)]);
+    EXPECT_EQ(ua.bytes[static_cast<size_t>(MemCategory::Labels)],
+              um.bytes[static_cast<size_t>(MemCategory::Labels)]);
+}
@@ -1,7 +1,29 @@
 #include <benchmark/benchmark.h>
+#include "xdp_dns/arena.hpp"
 #include "xdp_dns/dns_parser.hpp"
 #include "xdp_dns/domain_trie.hpp"
+#include "xdp_dns/forwarder.hpp"
+#include "xdp_dns/frame_parser.hpp"
+#include "xdp_dns/local_zone.hpp"
+#include "xdp_dns/numa.hpp"
+#include "xdp_dns/response_cache.hpp"
+#include "xdp_dns/response_writer.hpp"
+#include "xdp_dns/rpz_loader.hpp"
+#include "xdp_dns/simd.hpp"
+#include "xdp_dns/traffic_gen.hpp"
+#include "perf_counters.hpp"
+#include <netinet/in.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#include <algorithm>
+#include <atomic>
+#include <cstdio>
+#include <cstring>
+#include <map>
+#include <memory>
 #include <random>
+#include <thread>
 #include <vector>
 
 using namespace xdp_dns;
@@ -34,6 +56,7 @@ std::vector<uint8_t> buildQuery(const std::string& domain) {
 static void BM_DNSParse(benchmark::State& state) {
     auto packet = buildQuery("www.example.com");
     
+    bench::PerfScope perf(state);
     for (auto _ : state) {
         DNSParseResult result;
         auto err = DNSParser::parse(packet.data(), packet.size(), &result);
@@ -53,6 +76,7 @@ static void BM_DNSDecodeName(benchmark::State& state) {
     char domain[256];
     size_t domain_len;
     
+    bench::PerfScope perf(state);
     for (auto _ : state) {
         DNSParser::decodeName(
             packet.data(), packet.size(),
@@ -74,6 +98,7 @@ static void BM_DNSDomainEquals(benchmark::State& state) {
     const char* target = "www.example.com";
     size_t target_len = strlen(target);
     
+    bench::PerfScope perf(state);
     for (auto _ : state) {
         bool result = DNSParser::domainEquals(
             packet.data(), packet.size(), parsed.question,
@@ -105,6 +130,7 @@ static void BM_TrieMatch(benchmark::State& state) {
     wildcard_rule.action = Action::Log;
     trie.insert("*.test.com", &wildcard_rule);
     
+    bench::PerfScope perf(state);
     for (auto _ : state) {
         auto result = trie.match("domain500.example.com");
         benchmark::DoNotOptimize(result);
@@ -120,6 +146,7 @@ static void BM_TrieMatchWildcard(benchmark::State& state) {
     rule.action = Action::Block;
     trie.insert("*.example.com", &rule);
     
+    bench::PerfScope perf(state);
     for (auto _ : state) {
         auto result = trie.match("sub.domain.example.com");
         benchmark::DoNotOptimize(result);
@@ -138,6 +165,7 @@ static void BM_BuildNXDomain(benchmark::State& state) {
     
     uint8_t response[512];
     
+    bench::PerfScope perf(state);
     for (auto _ : state) {
         size_t len = DNSResponseBuilder::buildNXDomain(
             query.data(), query.size(), parsed,
@@ -156,9 +184,10 @@ static void BM_BuildAResponse(benchmark::State& state) {
     DNSParseResult parsed;
     DNSParser::parse(query.data(), query.size(), &parsed);
     
-    uint32_t ip = htonl(0xC0A80164);
+    uint32_t ip = ::htonl(0xC0A80164);
     uint8_t response[512];
     
+    bench::PerfScope perf(state);
     for (auto _ : state) {
         size_t len = DNSResponseBuilder::buildAResponse(
             query.data(), query.size(), parsed,
@@ -172,5 +201,744 @@ static void BM_BuildAResponse(benchmark::State& state) {
 }
 BENCHMARK(BM_BuildAResponse);
 
-BENCHMARK_MAIN();
+// 重定向: CNAME + 4 条 A, arg 0 逐条写入 (名字压缩), 1 复制预编译 blob
+static void BM_ResponseWriterRedirect(benchmark::State& state) {
+    auto query = buildQuery("ads.tracker.example.com");
+    DNSParseResult parsed;
+    DNSParser::parse(query.data(), query.size(), &parsed);
+
+    uint8_t cname[MAX_DOMAIN_LENGTH];
+    ResponseWriter::encodeName("portal.example.com", 18, cname, sizeof(cname));
+    uint32_t v4[] = {::htonl(0x0A000001), ::htonl(0x0A000002), ::htonl(0x0A000003),
+                     ::htonl(0x0A000004)};
+    RedirectAnswer answer;
+    RedirectAnswer::compile(cname, v4, 4, nullptr, 0, 300, &answer);
+    bool precompiled = state.range(0) != 0;
+
+    uint8_t response[512];
+    uint32_t tick = 0;
+    bench::PerfScope perf(state);
+    for (auto _ : state) {
+        ResponseWriter w;
+        w.begin(query.data(), parsed, response, sizeof(response));
+        if (precompiled) {
+            w.addBlob(answer.a, tick++);
+        } else {
+            w.addCNAME(nullptr, 300, cname);
+            for (uint32_t ip : v4) w.addA(cname, 300, ip);
+        }
+        size_t len = w.finish();
+        benchmark::DoNotOptimize(len);
+        benchmark::DoNotOptimize(response);
+    }
+
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_ResponseWriterRedirect)->ArgName("precompiled")->DenseRange(0, 1);
+
+// 本地权威区: 1024 个名字的区, arg 0 精确命中 (2 条 A), 1 NXDOMAIN + SOA, 2 通配符
+static void BM_LocalZoneAnswer(benchmark::State& state) {
+    LocalZones zones;
+    zones.addZone("corp.example");
+    for (int i = 0; i < 1024; i++) {
+        std::string host = "host" + std::to_string(i) + ".corp.example. 60 A ";
+        zones.addRecord(host + "10.0.0.1");
+        zones.addRecord(host + "10.0.0.2");
+    }
+    zones.addRecord("*.dev.corp.example. 60 A 10.0.1.1");
+    zones.compile(300);
+
+    const char* prefix = state.range(0) == 0 ? "host" : state.range(0) == 1 ? "gone" : "box";
+    const char* suffix = state.range(0) == 2 ? ".dev.corp.example" : ".corp.example";
+    std::vector<std::vector<uint8_t>> queries;
+    std::vector<std::string> domains;
+    for (int i = 0; i < 1024; i++) {
+        domains.push_back(prefix + std::to_string(i) + suffix);
+        queries.push_back(buildQuery(domains.back()));
+    }
+    std::vector<DNSParseResult> parsed(queries.size());
+    for (size_t i = 0; i < queries.size(); i++) {
+        DNSParser::parse(queries[i].data(), queries[i].size(), &parsed[i]);
+    }
+
+    uint8_t response[512];
+    size_t i = 0;
+    uint32_t tick = 0;
+    bench::PerfScope perf(state);
+    for (auto _ : state) {
+        size_t len = zones.answer(queries[i].data(), parsed[i], domains[i].data(),
+                                  domains[i].size(), response, sizeof(response), tick++);
+        benchmark::DoNotOptimize(len);
+        benchmark::DoNotOptimize(response);
+        i = (i + 1) & 1023;
+    }
+
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_LocalZoneAnswer)->ArgName("kind")->DenseRange(0, 2);
+
+// 响应缓存命中: 复制报文并改写 ID、问题名与 TTL
+static void BM_ResponseCacheHit(benchmark::State& state) {
+    ResponseCache cache;
+    std::vector<std::vector<uint8_t>> queries;
+    for (int i = 0; i < 1024; i++) {
+        auto query = buildQuery("host" + std::to_string(i) + ".example.com");
+        DNSParseResult parsed;
+        DNSParser::parse(query.data(), query.size(), &parsed);
+        uint8_t upstream[512];
+        size_t len = DNSResponseBuilder::buildAResponse(
+            query.data(), query.size(), parsed, ::htonl(0x0A000001), 300,
+            upstream, sizeof(upstream));
+        cache.insert(upstream, len, 0);
+        queries.push_back(std::move(query));
+    }
+    std::vector<DNSParseResult> parsed(queries.size());
+    for (size_t i = 0; i < queries.size(); i++) {
+        DNSParser::parse(queries[i].data(), queries[i].size(), &parsed[i]);
+    }
+
+    uint8_t response[512];
+    size_t i = 0;
+    bench::PerfScope perf(state);
+    for (auto _ : state) {
+        size_t len = cache.lookup(queries[i].data(), queries[i].size(), parsed[i],
+                                  30ULL * 1000000000ULL, response, sizeof(response));
+        benchmark::DoNotOptimize(len);
+        benchmark::DoNotOptimize(response);
+        i = (i + 1) & 1023;
+    }
+
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_ResponseCacheHit);
+
+// NXDOMAIN 截断点: 已知不存在节点之下的随机子域 (随机子域攻击)
+static void BM_ResponseCacheNxdomainCut(benchmark::State& state) {
+    ResponseCache cache;
+    auto nx_query = buildQuery("gone.example.com");
+    DNSParseResult nx_parsed;
+    DNSParser::parse(nx_query.data(), nx_query.size(), &nx_parsed);
+    uint8_t upstream[512];
+    size_t len = DNSResponseBuilder::buildNXDomain(nx_query.data(), nx_query.size(), nx_parsed,
+                                                   upstream, sizeof(upstream));
+    // 权威区 SOA, 名字以指针指向问题中的 "example.com"
+    const uint8_t soa[] = {0xC0, 0x11, 0x00, 0x06, 0x00, 0x01, 0x00, 0x00, 0x0E, 0x10,
+                           0x00, 0x18, 0xC0, 0x11, 0xC0, 0x11,
+                           0x00, 0x00, 0x00, 0x01, 0x00, 0x00, 0x0E, 0x10, 0x00, 0x00,
+                           0x02, 0x58, 0x00, 0x09, 0x3A, 0x80, 0x00, 0x00, 0x01, 0x2C};
+    std::memcpy(upstream + len, soa, sizeof(soa));
+    writeU16(upstream + 8, 1);
+    cache.insert(upstream, len + sizeof(soa), 0);
+
+    std::vector<std::vector<uint8_t>> queries;
+    std::vector<DNSParseResult> parsed(1024);
+    for (int i = 0; i < 1024; i++) {
+        queries.push_back(buildQuery("r" + std::to_string(i * 7919) + ".gone.example.com"));
+        DNSParser::parse(queries[i].data(), queries[i].size(), &parsed[i]);
+    }
+
+    uint8_t response[512];
+    size_t i = 0;
+    bench::PerfScope perf(state);
+    for (auto _ : state) {
+        size_t n = cache.lookup(queries[i].data(), queries[i].size(), parsed[i],
+                                30ULL * 1000000000ULL, response, sizeof(response));
+        benchmark::DoNotOptimize(n);
+        benchmark::DoNotOptimize(response);
+        i = (i + 1) & 1023;
+    }
+
+    state.counters["cut_hits"] = static_cast<double>(cache.stats().cut_hits);
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_ResponseCacheNxdomainCut);
+
+// ==================== 合成流量基准测试 ====================
+
+namespace {
+
+// 查询流长度 (2 的幂, 便于取模)
+constexpr size_t kStreamSize = 1 << 18;
+
+// 规则集 + 查询流 (按规模缓存, 各基准共享)
+struct Dataset {
+    std::vector<traffic_gen::GeneratedRule> rules;
+    std::vector<Rule> rule_storage;
+    traffic_gen::QueryStream queries;
+};
+
+const Dataset& getDataset(size_t num_rules) {
+    static std::map<size_t, std::unique_ptr<Dataset>> cache;
+    auto& slot = cache[num_rules];
+    if (!slot) {
+        slot = std::make_unique<Dataset>();
+
+        traffic_gen::RuleSetOptions rule_opts;
+        rule_opts.num_rules = num_rules;
+        slot->rules = traffic_gen::generateRuleSet(rule_opts);
+
+        slot->rule_storage.resize(slot->rules.size());
+        for (size_t i = 0; i < slot->rules.size(); i++) {
+            slot->rule_storage[i].id = static_cast<uint32_t>(i);
+            slot->rule_storage[i].action = slot->rules[i].action;
+        }
+
+        traffic_gen::QueryStreamOptions query_opts;
+        query_opts.num_queries = kStreamSize;
+        query_opts.hit_ratio = 0.2;
+        query_opts.attack_ratio = 0.05;
+        query_opts.compression_ratio = 0.1;
+        query_opts.mixed_case_ratio = 0.2;
+        slot->queries = traffic_gen::generateQueries(slot->rules, query_opts);
+    }
+    return *slot;
+}
+
+void buildTrie(const Dataset& ds, DomainTrie* trie) {
+    for (size_t i = 0; i < ds.rules.size(); i++) {
+        const auto& r = ds.rules[i];
+        trie->insert((r.wildcard ? "*." : "") + r.domain, &ds.rule_storage[i]);
+    }
+}
+
+// 规则集 → updateRules 输入
+std::vector<std::pair<std::string, Rule>> ruleEntries(const Dataset& ds) {
+    std::vector<std::pair<std::string, Rule>> entries;
+    entries.reserve(ds.rules.size());
+    for (size_t i = 0; i < ds.rules.size(); i++) {
+        const auto& r = ds.rules[i];
+        entries.emplace_back((r.wildcard ? "*." : "") + r.domain, ds.rule_storage[i]);
+    }
+    return entries;
+}
+
+// 内存后端: 0 = malloc, 1 = Arena, 2 = Arena + 2MB 大页
+enum MemoryMode : int64_t {
+    kMalloc = 0,
+    kArena = 1,
+    kArenaHuge = 2,
+};
+
+ArenaOptions arenaOptions(int64_t mode) {
+    ArenaOptions opts;
+    opts.enabled = mode != kMalloc;
+    opts.huge_pages = mode == kArenaHuge;
+    return opts;
+}
+
+void memoryModeArgs(benchmark::internal::Benchmark* b, std::initializer_list<int64_t> sizes) {
+    b->ArgNames({"rules", "mem"});
+    for (int64_t n : sizes) {
+        for (int64_t mode : {kMalloc, kArena, kArenaHuge}) {
+            b->Args({n, mode});
+        }
+    }
+}
+
+// 内存占用计数器, 用于发现内存回归
+void reportMemory(benchmark::State& state, const MemoryUsage& usage) {
+    state.counters["bytes/rule"] = usage.bytesPerRule();
+    state.counters["fragmentation"] = usage.fragmentation();
+    state.counters["reserved_MB"] = static_cast<double>(usage.reserved_bytes) / (1 << 20);
+}
+
+} // anonymous namespace
+
+static void BM_TrieMatchRealistic(benchmark::State& state) {
+    const Dataset& ds = getDataset(static_cast<size_t>(state.range(0)));
+    DomainTrie trie(arenaOptions(state.range(1)));
+    buildTrie(ds, &trie);
+    reportMemory(state, trie.memoryUsage());
+
+    size_t i = 0;
+    bench::PerfScope perf(state);
+    for (auto _ : state) {
+        const std::string& domain = ds.queries.domains[i++ & (kStreamSize - 1)];
+        auto result = trie.match(domain);
+        benchmark::DoNotOptimize(result);
+    }
+
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_TrieMatchRealistic)->Apply([](benchmark::internal::Benchmark* b) {
+    memoryModeArgs(b, {10000, 100000, 1000000});
+});
+
+// 整代构建 (updateRules), 不含释放
+static void BM_TrieBuild(benchmark::State& state) {
+    const Dataset& ds = getDataset(static_cast<size_t>(state.range(0)));
+    auto entries = ruleEntries(ds);
+    ArenaOptions opts = arenaOptions(state.range(1));
+
+    bench::PerfScope perf(state, static_cast<double>(entries.size()));
+    for (auto _ : state) {
+        auto trie = std::make_unique<DomainTrie>(opts);
+        trie->updateRules(entries);
+        benchmark::DoNotOptimize(trie.get());
+
+        state.PauseTiming();
+        perf.pause();
+        trie.reset();
+        perf.resume();
+        state.ResumeTiming();
+    }
+
+    state.SetItemsProcessed(state.iterations() * static_cast<int64_t>(entries.size()));
+}
+BENCHMARK(BM_TrieBuild)->Unit(benchmark::kMillisecond)->Apply([](benchmark::internal::Benchmark* b) {
+    memoryModeArgs(b, {10000, 100000, 1000000});
+});
+
+// 整代释放 (clear / 热重载后丢弃旧代)
+static void BM_TrieTeardown(benchmark::State& state) {
+    const Dataset& ds = getDataset(static_cast<size_t>(state.range(0)));
+    auto entries = ruleEntries(ds);
+    ArenaOptions opts = arenaOptions(state.range(1));
+
+    bench::PerfScope perf(state, static_cast<double>(entries.size()));
+    for (auto _ : state) {
+        state.PauseTiming();
+        perf.pause();
+        auto trie = std::make_unique<DomainTrie>(opts);
+        trie->updateRules(entries);
+        perf.resume();
+        state.ResumeTiming();
+
+        trie.reset();
+    }
+
+    state.SetItemsProcessed(state.iterations() * static_cast<int64_t>(entries.size()));
+}
+BENCHMARK(BM_TrieTeardown)->Unit(benchmark::kMillisecond)->Apply([](benchmark::internal::Benchmark* b) {
+    memoryModeArgs(b, {10000, 100000, 1000000});
+});
+
+namespace {
+
+// 威胁情报 RPZ 区: 以二级域名为主, 5% 为通配触发器, 动作按 NXDOMAIN / NODATA /
+// DROP / PASSTHRU 混合; 写入临时文件
+std::string writeRpzZone(size_t num_records) {
+    static const char* kTlds[] = {"com", "net", "org", "info", "xyz", "top", "ru", "cn"};
+    static const char* kActions[] = {".", ".", ".", ".", ".", ".", ".", "*.", "rpz-drop.",
+                                     "rpz-passthru."};
+    char path[] = "/tmp/xdp_dns_bench_rpz_XXXXXX";
+    int fd = mkstemp(path);
+    if (fd < 0) return {};
+    FILE* f = fdopen(fd, "w");
+    std::fprintf(f, "$TTL 2h\n@ SOA ns.rpz.example. admin.rpz.example. 1 3600 600 86400 300\n"
+                    "  NS ns.rpz.example.\n");
+    std::mt19937_64 rng(42);
+    for (size_t i = 0; i < num_records; i++) {
+        uint64_t r = rng();
+        std::fprintf(f, "%s%llx.%s CNAME %s\n", i % 20 == 0 ? "*." : "",
+                     static_cast<unsigned long long>(r >> 28), kTlds[r & 7],
+                     kActions[(r >> 3) % 10]);
+    }
+    std::fclose(f);
+    return path;
+}
+
+} // anonymous namespace
+
+// RPZ 加载: build 0 只解析 (mmap + 编译为规则), 1 再经 updateRules 构建 Trie;
+// 规则与 Trie 的释放不计入
+static void BM_RpzLoad(benchmark::State& state) {
+    size_t num_records = static_cast<size_t>(state.range(0));
+    bool build = state.range(1) != 0;
+    std::string path = writeRpzZone(num_records);
+
+    bench::PerfScope perf(state, static_cast<double>(num_records));
+    for (auto _ : state) {
+        RuleEntries entries;
+        auto engine = std::make_unique<FilterEngine>();
+        Error err = loadRpzFile(path.c_str(), "rpz.example", &entries);
+        if (build) engine->updateRules(entries);
+        benchmark::DoNotOptimize(err);
 
+        state.PauseTiming();
+        perf.pause();
+        state.counters["rules"] = static_cast<double>(entries.size());
+        entries = RuleEntries();
+        engine.reset();
+        perf.resume();
+        state.ResumeTiming();
+    }
+    std::remove(path.c_str());
+
+    state.SetItemsProcessed(state.iterations() * static_cast<int64_t>(num_records));
+}
+BENCHMARK(BM_RpzLoad)->Unit(benchmark::kMillisecond)->ArgNames({"records", "build"})
+    ->ArgsProduct({{100000, 1000000, 5000000}, {0, 1}})->Iterations(1);
+
+// NUMA 放置: 0 = Trie 在本节点, 1 = Trie 在远端节点, 2 = 每节点副本
+//
+// 单节点主机上远端放置会被跳过. 无多路服务器时可用 numactl 在虚拟机
+// (qemu -numa) 或 numa=fake=2 内核参数下模拟:
+//   numactl --cpunodebind=0 xdp_dns_benchmark --benchmark_filter=TrieMatchNuma
+static void BM_TrieMatchNuma(benchmark::State& state) {
+    const Dataset& ds = getDataset(static_cast<size_t>(state.range(0)));
+    const int64_t placement = state.range(1);
+    const int local = std::max(numaCurrentNode(), 0);
+
+    ArenaOptions opts;
+    if (placement == 1) {
+        if (numaNodeCount() < 2) {
+            state.SkipWithError("single NUMA node");
+            return;
+        }
+        const std::vector<int>& nodes = numaOnlineNodes();
+        opts.numa_node = nodes[0] != local ? nodes[0] : nodes[1];
+    } else if (placement == 2) {
+        opts.numa_replicas = true;
+    } else {
+        opts.numa_node = local;
+    }
+
+    DomainTrie trie(opts);
+    trie.updateRules(ruleEntries(ds));
+    reportMemory(state, trie.memoryUsage());
+    state.counters["replicas"] = static_cast<double>(trie.replicaCount());
+
+    size_t i = 0;
+    bench::PerfScope perf(state);
+    for (auto _ : state) {
+        const std::string& domain = ds.queries.domains[i++ & (kStreamSize - 1)];
+        auto result = trie.match(domain);
+        benchmark::DoNotOptimize(result);
+    }
+
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_TrieMatchNuma)->ArgNames({"rules", "numa"})->ArgsProduct({{100000, 1000000}, {0, 1, 2}});
+
+// UMEM 帧访问: 按随机帧顺序读取每帧前 64 字节 (以太网/IP/UDP/DNS 头),
+// 对比 4K 页与 2MB 大页下的 dTLB 未命中. 内存绑定到当前线程所在 NUMA 节点.
+static void BM_UmemFrameTouch(benchmark::State& state) {
+    constexpr size_t kFrameSize = 2048;
+    const size_t num_frames = static_cast<size_t>(state.range(0));
+    const size_t size = num_frames * kFrameSize;
+    const bool huge = state.range(1) != 0;
+
+    bool is_huge = false;
+    size_t mapped = huge ? (size + kHugePageSize - 1) & ~(kHugePageSize - 1) : size;
+    auto* umem = static_cast<uint8_t*>(mapPages(mapped, huge, &is_huge, numaCurrentNode()));
+    if (!umem) {
+        state.SkipWithError("mmap failed");
+        return;
+    }
+    std::memset(umem, 0x5a, mapped);
+
+    // 模拟 NIC 以乱序完成的 Fill Ring 地址
+    std::vector<uint32_t> order(num_frames);
+    for (size_t i = 0; i < num_frames; i++) order[i] = static_cast<uint32_t>(i);
+    std::shuffle(order.begin(), order.end(), std::mt19937(42));
+
+    size_t i = 0;
+    uint64_t sum = 0;
+    bench::PerfScope perf(state);
+    for (auto _ : state) {
+        const uint8_t* frame = umem + static_cast<size_t>(order[i++ % num_frames]) * kFrameSize;
+        uint64_t words[8];
+        std::memcpy(words, frame, sizeof(words));
+        sum += words[0] ^ words[7];
+        benchmark::DoNotOptimize(sum);
+    }
+
+    state.counters["hugetlb"] = is_huge ? 1 : 0;
+    state.SetItemsProcessed(state.iterations());
+    unmapPages(umem, mapped);
+}
+BENCHMARK(BM_UmemFrameTouch)->ArgNames({"frames", "huge"})->ArgsProduct({{4096, 65536, 262144}, {0, 1}});
+
+// ==================== L2-L4 帧解析基准测试 ====================
+
+// 以 buildQuery 为负载的以太网帧: 0 = IPv4, 1 = QinQ + IPv4 选项,
+// 2 = VLAN + IPv6 (Hop-by-Hop + Fragment 扩展头)
+static std::vector<uint8_t> buildFrame(int kind) {
+    std::vector<uint8_t> dns = buildQuery("www.example.com");
+    std::vector<uint8_t> f = {0x02, 0, 0, 0, 0, 0x01, 0x02, 0, 0, 0, 0, 0x02};
+    auto u16 = [&f](uint16_t v) {
+        f.push_back(static_cast<uint8_t>(v >> 8));
+        f.push_back(static_cast<uint8_t>(v));
+    };
+
+    uint16_t udp_len = static_cast<uint16_t>(8 + dns.size());
+    if (kind == 0 || kind == 1) {
+        size_t options = 0;
+        if (kind == 1) {
+            u16(0x88A8); u16(100);
+            u16(0x8100); u16(200);
+            options = 8;
+        }
+        u16(0x0800);
+        f.push_back(static_cast<uint8_t>(0x45 + options / 4));
+        f.push_back(0);
+        u16(static_cast<uint16_t>(20 + options + udp_len));
+        f.insert(f.end(), {0, 0, 0, 0, 64, 17, 0, 0, 192, 0, 2, 1, 10, 0, 0, 53});
+        f.insert(f.end(), options, 0);
+    } else {
+        u16(0x8100); u16(300);
+        u16(0x86DD);
+        f.insert(f.end(), {0x60, 0, 0, 0});
+        u16(static_cast<uint16_t>(16 + udp_len));
+        f.insert(f.end(), {0, 64});
+        f.insert(f.end(), 32, 0x20);
+        f.insert(f.end(), {44, 0, 0, 0, 0, 0, 0, 0});
+        f.insert(f.end(), {17, 0, 0, 0, 0, 0, 0, 1});
+    }
+    u16(40000); u16(53); u16(udp_len); u16(0);
+    f.insert(f.end(), dns.begin(), dns.end());
+    return f;
+}
+
+static void BM_FrameParse(benchmark::State& state) {
+    auto frame = buildFrame(static_cast<int>(state.range(0)));
+
+    FrameInfo info;
+    bench::PerfScope perf(state);
+    for (auto _ : state) {
+        auto err = FrameParser::parse(frame.data(), frame.size(), &info);
+        benchmark::DoNotOptimize(err);
+        benchmark::DoNotOptimize(info);
+    }
+
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_FrameParse)->ArgName("kind")->DenseRange(0, 2);
+
+// 64 帧一批, 三种帧混合
+static void BM_FrameParseBatch(benchmark::State& state) {
+    std::vector<std::vector<uint8_t>> frames;
+    const uint8_t* ptrs[64];
+    uint32_t lens[64];
+    for (int i = 0; i < 64; i++) {
+        frames.push_back(buildFrame(i % 3));
+    }
+    for (size_t i = 0; i < 64; i++) {
+        ptrs[i] = frames[i].data();
+        lens[i] = static_cast<uint32_t>(frames[i].size());
+    }
+
+    FrameInfo out[64];
+    bench::PerfScope perf(state, 64);
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(FrameParser::parseBatch(ptrs, lens, 64, out));
+        benchmark::ClobberMemory();
+    }
+
+    state.SetItemsProcessed(state.iterations() * 64);
+}
+BENCHMARK(BM_FrameParseBatch);
+
+// ==================== SIMD 内核基准测试 ====================
+
+// 各级别内核 (本机不支持的级别跳过), 与 -DENABLE_NATIVE_ARCH=ON 构建对比
+static void BM_SimdLowerCopy(benchmark::State& state) {
+    const SimdKernels* k = simdKernels(static_cast<SimdLevel>(state.range(0)));
+    if (!k) {
+        state.SkipWithError("ISA not supported");
+        return;
+    }
+
+    const Dataset& ds = getDataset(10000);
+    char buf[MAX_DOMAIN_LENGTH + 1];
+    size_t bytes = 0;
+
+    size_t i = 0;
+    bench::PerfScope perf(state);
+    for (auto _ : state) {
+        const std::string& domain = ds.queries.domains[i++ & (kStreamSize - 1)];
+        k->lower_copy(buf, reinterpret_cast<const uint8_t*>(domain.data()), domain.size());
+        benchmark::DoNotOptimize(buf);
+        bytes += domain.size();
+    }
+
+    state.SetLabel(simdLevelName(k->level));
+    state.SetBytesProcessed(static_cast<int64_t>(bytes));
+}
+BENCHMARK(BM_SimdLowerCopy)->DenseRange(0, 3);
+
+static void BM_SimdLabelHash(benchmark::State& state) {
+    const SimdKernels* k = simdKernels(static_cast<SimdLevel>(state.range(0)));
+    if (!k) {
+        state.SkipWithError("ISA not supported");
+        return;
+    }
+
+    const Dataset& ds = getDataset(10000);
+    size_t i = 0;
+    bench::PerfScope perf(state);
+    for (auto _ : state) {
+        const std::string& domain = ds.queries.domains[i++ & (kStreamSize - 1)];
+        benchmark::DoNotOptimize(k->hash(domain.data(), domain.size()));
+    }
+
+    state.SetLabel(simdLevelName(k->level));
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_SimdLabelHash)->DenseRange(0, 3);
+
+// 64 包一批的头部预筛, 一半为合法查询, 其余为响应 / 截断 / 随机字节
+static void BM_SimdClassifyHeaders(benchmark::State& state) {
+    const SimdKernels* k = simdKernels(static_cast<SimdLevel>(state.range(0)));
+    if (!k) {
+        state.SkipWithError("ISA not supported");
+        return;
+    }
+
+    std::mt19937 rng(7);
+    std::vector<std::vector<uint8_t>> packets;
+    for (size_t i = 0; i < 64; i++) {
+        std::vector<uint8_t> pkt = buildQuery("www.example.com");
+        switch (i % 4) {
+            case 1: pkt[2] |= 0x80; break;
+            case 2: pkt.resize(8); break;
+            case 3: for (auto& b : pkt) b = static_cast<uint8_t>(rng()); break;
+        }
+        packets.push_back(std::move(pkt));
+    }
+    const uint8_t* data[64];
+    uint32_t lens[64];
+    for (size_t i = 0; i < 64; i++) {
+        data[i] = packets[i].data();
+        lens[i] = static_cast<uint32_t>(packets[i].size());
+    }
+
+    bench::PerfScope perf(state, 64);
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(k->classify_headers(data, lens, 64));
+    }
+
+    state.SetLabel(simdLevelName(k->level));
+    state.SetItemsProcessed(state.iterations() * 64);
+}
+BENCHMARK(BM_SimdClassifyHeaders)->DenseRange(0, 3);
+
+static void BM_DNSParseStream(benchmark::State& state) {
+    const Dataset& ds = getDataset(10000);
+    char domain[MAX_DOMAIN_LENGTH + 1];
+    size_t domain_len;
+
+    size_t i = 0;
+    bench::PerfScope perf(state);
+    for (auto _ : state) {
+        size_t idx = i++ & (kStreamSize - 1);
+        const uint8_t* pkt = ds.queries.packet(idx);
+        size_t len = ds.queries.packetLength(idx);
+
+        DNSParseResult parsed;
+        auto err = DNSParser::parse(pkt, len, &parsed);
+        if (err == Error::Success) {
+            DNSParser::decodeName(pkt, len, parsed.question.name_offset,
+                                  domain, sizeof(domain), &domain_len);
+        }
+        benchmark::DoNotOptimize(domain);
+    }
+
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_DNSParseStream);
+
+// ==================== 上游转发基准测试 ====================
+
+// 回环桩上游: 每个查询以一条 A 记录应答
+class StubUpstream {
+public:
+    StubUpstream() {
+        fd_ = ::socket(AF_INET, SOCK_DGRAM, 0);
+        sockaddr_in addr{};
+        addr.sin_family = AF_INET;
+        addr.sin_addr.s_addr = ::htonl(INADDR_LOOPBACK);
+        ::bind(fd_, reinterpret_cast<sockaddr*>(&addr), sizeof(addr));
+        socklen_t len = sizeof(addr);
+        ::getsockname(fd_, reinterpret_cast<sockaddr*>(&addr), &len);
+        address_ = "127.0.0.1:" + std::to_string(::ntohs(addr.sin_port));
+        thread_ = std::thread([this] { run(); });
+    }
+
+    ~StubUpstream() {
+        running_ = false;
+        thread_.join();
+        ::close(fd_);
+    }
+
+    const std::string& address() const { return address_; }
+    uint64_t received() const { return received_.load(std::memory_order_relaxed); }
+
+private:
+    void run() {
+        uint8_t buf[512];
+        uint8_t resp[512];
+        while (running_) {
+            pollfd pfd{fd_, POLLIN, 0};
+            if (::poll(&pfd, 1, 10) <= 0) continue;
+            sockaddr_in from{};
+            socklen_t from_len = sizeof(from);
+            ssize_t n = ::recvfrom(fd_, buf, sizeof(buf), MSG_DONTWAIT,
+                                   reinterpret_cast<sockaddr*>(&from), &from_len);
+            if (n <= 0) continue;
+            received_.fetch_add(1, std::memory_order_relaxed);
+            DNSParseResult parsed;
+            if (DNSParser::parse(buf, n, &parsed) != Error::Success) continue;
+            size_t len = DNSResponseBuilder::buildAResponse(
+                buf, n, parsed, ::htonl(0x0A000001), 60, resp, sizeof(resp));
+            ::sendto(fd_, resp, len, 0, reinterpret_cast<sockaddr*>(&from), from_len);
+        }
+    }
+
+    int fd_ = -1;
+    std::string address_;
+    std::thread thread_;
+    std::atomic<bool> running_{true};
+    std::atomic<uint64_t> received_{0};
+};
+
+// 热门名字过期瞬间: 256 个客户端同时查询同一问题, 等全部应答.
+// coalesce=1 时只有 1 个查询发往上游
+static void BM_ForwarderThunderingHerd(benchmark::State& state) {
+    constexpr size_t kHerd = 256;
+    StubUpstream upstream;
+    ForwarderOptions opts;
+    opts.servers = {upstream.address()};
+    opts.coalesce = state.range(0) != 0;
+    Forwarder fwd(opts);
+    if (!fwd.start()) {
+        state.SkipWithError("forwarder start failed");
+        return;
+    }
+
+    std::vector<std::vector<uint8_t>> queries;
+    std::vector<ForwardRequest> reqs;
+    for (size_t i = 0; i < kHerd; i++) {
+        queries.push_back(buildQuery("popular.example.com"));
+        writeU16(queries.back().data(), static_cast<uint16_t>(i));
+    }
+    for (size_t i = 0; i < kHerd; i++) {
+        reqs.push_back(ForwardRequest{queries[i].data(), static_cast<uint32_t>(queries[i].size()),
+                                      0, i});
+    }
+    bool accepted[kHerd];
+    ForwardCompletion done[kHerd];
+
+    // 只统计提交 / 收割线程, 不含转发器的收发线程
+    bench::PerfScope perf(state, kHerd);
+    for (auto _ : state) {
+        fwd.submit(reqs.data(), kHerd, accepted);
+        size_t completed = 0;
+        while (completed < kHerd) {
+            size_t n = fwd.poll(0, done, kHerd);
+            fwd.release(done, n);
+            completed += n;
+        }
+    }
+
+    ForwarderStats stats = fwd.stats();
+    state.counters["upstream_per_herd"] =
+        static_cast<double>(upstream.received()) / static_cast<double>(state.iterations());
+    state.counters["coalesced_per_herd"] =
+        static_cast<double>(stats.coalesced) / static_cast<double>(state.iterations());
+    state.SetItemsProcessed(state.iterations() * kHerd);
+}
+BENCHMARK(BM_ForwarderThunderingHerd)->ArgName("coalesce")->Arg(0)->Arg(1)->UseRealTime();
+
+BENCHMARK_MAIN();
@@ -150,6 +150,172 @@ TEST(DNSParserTest, BuildNXDomainResponse) {
     EXPECT_EQ(hdr->getRCode(), dns_rcode::NXDOMAIN);
 }
 
+TEST(DNSParserTest, BuildNegativeResponseWithSyntheticSoa) {
+    auto query = buildDNSQuery("Blocked.Example.com", dns_type::AAAA);
+    DNSParseResult parsed;
+    ASSERT_EQ(DNSParser::parse(query.data(), query.size(), &parsed), Error::Success);
+
+    uint8_t response[512];
+    size_t len = DNSResponseBuilder::buildNXDomain(
+        query.data(), query.size(), parsed, 120, response, sizeof(response));
+    ASSERT_EQ(len, query.size() + 59);
+
+    auto* hdr = reinterpret_cast<const DNSHeader*>(response);
+    EXPECT_EQ(hdr->getId(), 0x1234);
+    EXPECT_TRUE(hdr->isResponse());
+    EXPECT_EQ(hdr->getRCode(), dns_rcode::NXDOMAIN);
+    EXPECT_EQ(hdr->getANCount(), 0);
+    EXPECT_EQ(hdr->getNSCount(), 1);
+
+    // SOA 所有者为父域, TTL 与 MINIMUM 为否定缓存时长
+    DNSParseResult reparsed;
+    ASSERT_EQ(DNSParser::parse(response, len, &reparsed), Error::Success);
+    DNSSoaRecord soa;
+    ASSERT_EQ(DNSParser::findAuthoritySoa(response, len, reparsed, &soa), Error::Success);
+    const char owner[] = "\x07" "Example" "\x03" "com";
+    ASSERT_EQ(soa.owner_len, sizeof(owner));
+    EXPECT_EQ(std::memcmp(soa.owner, owner, sizeof(owner)), 0);
+    EXPECT_EQ(soa.ttl, 120u);
+    EXPECT_EQ(soa.minimum, 120u);
+    EXPECT_EQ(soa.rclass, 1);
+
+    // NODATA: 单标签名的 SOA 所有者为根
+    auto single = buildDNSQuery("localnet", dns_type::AAAA);
+    ASSERT_EQ(DNSParser::parse(single.data(), single.size(), &parsed), Error::Success);
+    len = DNSResponseBuilder::buildNoData(
+        single.data(), single.size(), parsed, 30, response, sizeof(response));
+    ASSERT_EQ(len, single.size() + 58);
+    EXPECT_EQ(hdr->getRCode(), dns_rcode::NOERROR);
+    ASSERT_EQ(DNSParser::parse(response, len, &reparsed), Error::Success);
+    ASSERT_EQ(DNSParser::findAuthoritySoa(response, len, reparsed, &soa), Error::Success);
+    EXPECT_EQ(soa.owner_len, 1u);
+    EXPECT_EQ(soa.negativeTtl(), 30u);
+
+    // 缓冲区不足
+    EXPECT_EQ(DNSResponseBuilder::buildNoData(
+        single.data(), single.size(), parsed, 30, response, single.size() + 57), 0u);
+}
+
+TEST(DNSParserTest, BuildBlockedDispatchesByMode) {
+    auto query = buildDNSQuery("blocked.example.com", dns_type::AAAA);
+    DNSParseResult parsed;
+    ASSERT_EQ(DNSParser::parse(query.data(), query.size(), &parsed), Error::Success);
+
+    uint8_t response[512];
+    auto* hdr = reinterpret_cast<const DNSHeader*>(response);
+    auto build = [&](BlockMode mode) {
+        return DNSResponseBuilder::buildBlocked(query.data(), query.size(), parsed, mode,
+                                                60, 120, response, sizeof(response));
+    };
+
+    EXPECT_EQ(build(BlockMode::NXDomain), query.size() + 59);
+    EXPECT_EQ(hdr->getRCode(), dns_rcode::NXDOMAIN);
+    EXPECT_EQ(hdr->getNSCount(), 1);
+
+    EXPECT_EQ(build(BlockMode::NoData), query.size() + 59);
+    EXPECT_EQ(hdr->getRCode(), dns_rcode::NOERROR);
+    EXPECT_EQ(hdr->getANCount(), 0);
+
+    EXPECT_EQ(build(BlockMode::Refused), query.size());
+    EXPECT_EQ(hdr->getRCode(), dns_rcode::REFUSED);
+
+    // 空地址: AAAA 回答 ::, A 回答 0.0.0.0, 其它类型 NODATA
+    size_t len = build(BlockMode::NullAddress);
+    ASSERT_EQ(len, query.size() + 28);
+    EXPECT_EQ(hdr->getANCount(), 1);
+    const uint8_t zero[16] = {};
+    EXPECT_EQ(std::memcmp(response + len - 16, zero, 16), 0);
+    EXPECT_EQ(response[len - 19], 60);  // TTL 低字节
+
+    query = buildDNSQuery("blocked.example.com", dns_type::A);
+    ASSERT_EQ(DNSParser::parse(query.data(), query.size(), &parsed), Error::Success);
+    len = build(BlockMode::NullAddress);
+    ASSERT_EQ(len, query.size() + 16);
+    EXPECT_EQ(std::memcmp(response + len - 4, zero, 4), 0);
+
+    query = buildDNSQuery("blocked.example.com", dns_type::MX);
+    ASSERT_EQ(DNSParser::parse(query.data(), query.size(), &parsed), Error::Success);
+    EXPECT_EQ(build(BlockMode::NullAddress), query.size() + 59);
+    EXPECT_EQ(hdr->getANCount(), 0);
+    EXPECT_EQ(hdr->getNSCount(), 1);
+
+    EXPECT_EQ(build(BlockMode::Drop), 0u);
+}
+
+TEST(DNSParserTest, NullAddressDropsQueryOpt) {
+    // EDNS 查询: 附加 OPT (UDP 负载 1232), ARCOUNT = 1
+    const uint8_t opt[] = {0x00, 0x00, 0x29, 0x04, 0xD0, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00};
+    uint8_t response[512];
+    auto* hdr = reinterpret_cast<const DNSHeader*>(response);
+
+    for (uint16_t qtype : {dns_type::A, dns_type::AAAA}) {
+        auto query = buildDNSQuery("blocked.example.com", qtype);
+        size_t question_end = query.size();
+        query.insert(query.end(), opt, opt + sizeof(opt));
+        query[11] = 1;
+        DNSParseResult parsed;
+        ASSERT_EQ(DNSParser::parse(query.data(), query.size(), &parsed), Error::Success);
+
+        // 只复制到问题末尾, 应答不能再声明附加段
+        size_t len = DNSResponseBuilder::buildBlocked(query.data(), query.size(), parsed,
+                                                      BlockMode::NullAddress, 60, 120,
+                                                      response, sizeof(response));
+        ASSERT_EQ(len, question_end + (qtype == dns_type::A ? 16 : 28));
+        EXPECT_EQ(hdr->getANCount(), 1);
+        EXPECT_EQ(hdr->getNSCount(), 0);
+        EXPECT_EQ(hdr->getARCount(), 0);
+    }
+}
+
+TEST(DNSParserTest, FindAuthoritySoaExpandsCompressedNames) {
+    auto packet = buildDNSQuery("Missing.Example.com");
+    packet[2] = 0x81;
+    packet[3] = 0x83;            // QR, RD, RA, NXDOMAIN
+    packet[7] = 1;               // ANCOUNT: 一条 A 记录, 需要跳过
+    packet[9] = 1;               // NSCOUNT
+    packet.insert(packet.end(), {0xC0, 0x0C, 0x00, 0x01, 0x00, 0x01, 0x00, 0x00, 0x00, 0x3C,
+                                 0x00, 0x04, 10, 0, 0, 1});
+
+    // SOA: 所有者与 MNAME/RNAME 都以指针指向问题中的 "Example.com"
+    size_t soa_offset = packet.size();
+    packet.insert(packet.end(), {0xC0, 0x14, 0x00, 0x06, 0x00, 0x01, 0x00, 0x00, 0x0E, 0x10,
+                                 0x00, 0x00});
+    size_t rdata = packet.size();
+    packet.insert(packet.end(), {3, 'n', 's', '1', 0xC0, 0x14});
+    packet.insert(packet.end(), {10, 'h', 'o', 's', 't', 'm', 'a', 's', 't', 'e', 'r', 0xC0, 0x14});
+    packet.insert(packet.end(), {0x00, 0x00, 0x00, 0x07, 0x00, 0x00, 0x0E, 0x10, 0x00, 0x00,
+                                 0x02, 0x58, 0x00, 0x09, 0x3A, 0x80, 0x00, 0x00, 0x00, 0x3C});
+    writeU16(packet.data() + rdata - 2, static_cast<uint16_t>(packet.size() - rdata));
+
+    DNSParseResult parsed;
+    ASSERT_EQ(DNSParser::parse(packet.data(), packet.size(), &parsed), Error::Success);
+    DNSSoaRecord soa;
+    ASSERT_EQ(DNSParser::findAuthoritySoa(packet.data(), packet.size(), parsed, &soa),
+              Error::Success);
+    EXPECT_EQ(soa.offset, soa_offset);
+    EXPECT_EQ(soa.rclass, 1);
+    EXPECT_EQ(soa.ttl, 3600u);
+    EXPECT_EQ(soa.serial, 7u);
+    EXPECT_EQ(soa.minimum, 60u);
+    EXPECT_EQ(soa.negativeTtl(), 60u);
+
+    const char owner[] = "\x07" "Example" "\x03" "com";
+    ASSERT_EQ(soa.owner_len, sizeof(owner));
+    EXPECT_EQ(std::memcmp(soa.owner, owner, sizeof(owner)), 0);
+    const char mname[] = "\x03ns1\x07" "Example" "\x03" "com";
+    ASSERT_EQ(soa.mname_len, sizeof(mname));
+    EXPECT_EQ(std::memcmp(soa.mname, mname, sizeof(mname)), 0);
+    EXPECT_EQ(soa.rname_len, 11 + sizeof(owner));
+
+    // 截断的 RDATA 与没有 SOA 的响应
+    EXPECT_EQ(DNSParser::findAuthoritySoa(packet.data(), packet.size() - 1, parsed, &soa),
+              Error::TruncatedMessage);
+    packet[9] = 0;
+    ASSERT_EQ(DNSParser::parse(packet.data(), packet.size(), &parsed), Error::Success);
+    EXPECT_EQ(DNSParser::findAuthoritySoa(packet.data(), packet.size(), parsed, &soa),
+              Error::InvalidHeader);
+}
+
 TEST(DNSParserTest, BuildAResponse) {
     auto query = buildDNSQuery("redirect.example.com");
     
@@ -174,3 +340,87 @@ TEST(DNSParserTest, BuildAResponse) {
     EXPECT_EQ(hdr->getANCount(), 1);
 }
 
+
+TEST(DNSParserTest, BuildAResponseInPlace) {
+    auto query = buildDNSQuery("redirect.example.com");
+    size_t query_len = query.size();
+
+    // 模拟 AF_XDP 帧: 查询之后留出回答记录的空间
+    std::vector<uint8_t> frame(query);
+    frame.resize(2048);
+
+    DNSParseResult parsed;
+    ASSERT_EQ(DNSParser::parse(frame.data(), query_len, &parsed), Error::Success);
+
+    size_t resp_len = DNSResponseBuilder::buildAResponse(
+        frame.data(), query_len, parsed,
+        htonl(0xC0A80164), 300,
+        frame.data(), frame.size()
+    );
+
+    ASSERT_EQ(resp_len, query_len + 16);
+    EXPECT_EQ(std::memcmp(frame.data() + DNS_HEADER_SIZE, query.data() + DNS_HEADER_SIZE,
+                          query_len - DNS_HEADER_SIZE), 0);
+
+    auto* hdr = reinterpret_cast<const DNSHeader*>(frame.data());
+    EXPECT_EQ(hdr->getId(), 0x1234);
+    EXPECT_TRUE(hdr->isResponse());
+    EXPECT_EQ(hdr->getANCount(), 1);
+    EXPECT_EQ(readU32(frame.data() + resp_len - 4), 0xC0A80164u);
+}
+
+TEST(DNSParserTest, BuildHInfoResponseForAny) {
+    auto query = buildDNSQuery("example.com", dns_type::ANY);
+
+    DNSParseResult parsed;
+    ASSERT_EQ(DNSParser::parse(query.data(), query.size(), &parsed), Error::Success);
+
+    uint8_t response[512];
+    size_t resp_len = DNSResponseBuilder::buildHInfo(
+        query.data(), query.size(), parsed, 3600, response, sizeof(response));
+
+    // 名称指针 + 固定字段 10 字节 + RDATA 9 字节
+    ASSERT_EQ(resp_len, query.size() + 21);
+    auto* hdr = reinterpret_cast<const DNSHeader*>(response);
+    EXPECT_TRUE(hdr->isResponse());
+    EXPECT_EQ(hdr->getRCode(), dns_rcode::NOERROR);
+    EXPECT_EQ(hdr->getANCount(), 1);
+
+    const uint8_t* rr = response + query.size();
+    EXPECT_EQ(readU16(rr), 0xC00C);
+    EXPECT_EQ(readU16(rr + 2), dns_type::HINFO);
+    EXPECT_EQ(readU32(rr + 6), 3600u);
+    EXPECT_EQ(readU16(rr + 10), 9);
+    EXPECT_EQ(std::memcmp(rr + 12, "\x07RFC8482\x00", 9), 0);
+
+    // 缓冲区不足
+    EXPECT_EQ(DNSResponseBuilder::buildHInfo(
+        query.data(), query.size(), parsed, 3600, response, query.size() + 20), 0u);
+}
+
+TEST(DNSParserTest, BuildAnyResponseFollowsPolicy) {
+    auto any = buildDNSQuery("example.com", dns_type::ANY);
+    auto a = buildDNSQuery("example.com", dns_type::A);
+
+    DNSParseResult parsed_any, parsed_a;
+    ASSERT_EQ(DNSParser::parse(any.data(), any.size(), &parsed_any), Error::Success);
+    ASSERT_EQ(DNSParser::parse(a.data(), a.size(), &parsed_a), Error::Success);
+
+    uint8_t response[512];
+    RuleSetPolicy policy;
+    EXPECT_EQ(DNSResponseBuilder::buildAnyResponse(
+        any.data(), any.size(), parsed_any, policy, response, sizeof(response)), 0u);
+
+    policy.any_policy = AnyPolicy::Truncate;
+    EXPECT_EQ(DNSResponseBuilder::buildAnyResponse(
+        a.data(), a.size(), parsed_a, policy, response, sizeof(response)), 0u);
+
+    size_t resp_len = DNSResponseBuilder::buildAnyResponse(
+        any.data(), any.size(), parsed_any, policy, response, sizeof(response));
+    ASSERT_EQ(resp_len, any.size());
+    auto* hdr = reinterpret_cast<const DNSHeader*>(response);
+    EXPECT_TRUE(hdr->isResponse());
+    EXPECT_TRUE(hdr->isTruncated());
+    EXPECT_EQ(hdr->getANCount(), 0);
+    EXPECT_EQ(hdr->getQDCount(), 1);
+}
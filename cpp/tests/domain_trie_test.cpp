@@ -1,5 +1,9 @@
 #include <gtest/gtest.h>
 #include "xdp_dns/domain_trie.hpp"
+#include "xdp_dns/numa.hpp"
+#include <string>
+#include <thread>
+#include <vector>
 
 using namespace xdp_dns;
 
@@ -54,6 +58,23 @@ TEST_F(DomainTrieTest, WildcardMatch) {
     EXPECT_NE(matched, nullptr);
 }
 
+TEST_F(DomainTrieTest, SubdomainOnlyWildcard) {
+    Rule parent = makeRule(1, Action::Block, "parent");
+    Rule strict = makeRule(2, Action::Block, "strict");
+    strict.subdomains_only = true;
+    trie.insert("*.example.com", &strict);
+
+    // 只匹配子域名, 根域名不命中
+    EXPECT_EQ(trie.match("example.com"), nullptr);
+    ASSERT_NE(trie.match("a.b.example.com"), nullptr);
+    EXPECT_EQ(trie.match("a.b.example.com")->id, 2);
+
+    // 根域名回落到上层的通配符规则
+    trie.insert("*.com", &parent);
+    ASSERT_NE(trie.match("example.com"), nullptr);
+    EXPECT_EQ(trie.match("example.com")->id, 1);
+}
+
 TEST_F(DomainTrieTest, MixedRules) {
     Rule rule1 = makeRule(1, Action::Block, "exact");
     Rule rule2 = makeRule(2, Action::Redirect, "wildcard");
@@ -124,6 +145,121 @@ TEST_F(DomainTrieTest, EmptyDomain) {
     EXPECT_EQ(trie.match(""), nullptr);
 }
 
+TEST_F(DomainTrieTest, UpdateRulesReplacesAll) {
+    Rule old_rule = makeRule(1, Action::Block, "old");
+    trie.insert("old.com", &old_rule);
+
+    std::vector<std::pair<std::string, Rule>> rules;
+    rules.emplace_back("new.com", makeRule(2, Action::Block, "new"));
+    rules.emplace_back("*.Wild.com", makeRule(3, Action::Redirect, "wild"));
+    trie.updateRules(rules);
+
+    EXPECT_EQ(trie.size(), 2);
+    EXPECT_EQ(trie.match("old.com"), nullptr);
+
+    const Rule* matched = trie.match("new.com");
+    ASSERT_NE(matched, nullptr);
+    EXPECT_EQ(matched->id, 2);
+
+    matched = trie.match("a.wild.com");
+    ASSERT_NE(matched, nullptr);
+    EXPECT_EQ(matched->action, Action::Redirect);
+}
+
+TEST_F(DomainTrieTest, MatchedRuleOutlivesReload) {
+    std::vector<std::pair<std::string, Rule>> rules;
+    rules.emplace_back("old.com", makeRule(1, Action::Block, "old"));
+    trie.updateRules(rules);
+    const Rule* held = trie.match("old.com");
+    ASSERT_NE(held, nullptr);
+
+    // 重载与清空后, 之前 match 返回的指针仍指向有效的旧规则
+    rules.clear();
+    rules.emplace_back("new.com", makeRule(2, Action::Block, "new"));
+    trie.updateRules(rules);
+    trie.clear();
+    EXPECT_EQ(held->id, 1);
+    EXPECT_STREQ(held->rule_id, "old");
+
+    // 旧代不再计入规则数, 只剩根节点
+    MemoryUsage usage = trie.memoryUsage();
+    EXPECT_EQ(usage.rule_count, 0u);
+    EXPECT_EQ(usage.allocations, 1u);
+}
+
+TEST_F(DomainTrieTest, NumaReplicasStayConsistent) {
+    ArenaOptions opts;
+    opts.numa_replicas = true;
+    DomainTrie replicated(opts);
+    EXPECT_EQ(replicated.replicaCount(), static_cast<size_t>(numaNodeCount()));
+    EXPECT_EQ(trie.replicaCount(), 1u);
+
+    std::vector<std::pair<std::string, Rule>> rules;
+    rules.emplace_back("a.com", makeRule(1, Action::Block, "a"));
+    rules.emplace_back("*.b.com", makeRule(2, Action::Redirect, "b"));
+    replicated.updateRules(rules);
+
+    Rule extra = makeRule(3, Action::Log, "c");
+    replicated.insert("c.com", &extra);
+    EXPECT_EQ(replicated.size(), 3);
+    EXPECT_TRUE(replicated.remove("a.com"));
+    EXPECT_FALSE(replicated.remove("a.com"));
+
+    EXPECT_EQ(replicated.match("a.com"), nullptr);
+    ASSERT_NE(replicated.match("x.b.com"), nullptr);
+    EXPECT_EQ(replicated.match("x.b.com")->id, 2);
+    EXPECT_EQ(replicated.match("c.com"), &extra);
+    EXPECT_EQ(replicated.memoryUsage().rule_count, 2u);
+}
+
+TEST_F(DomainTrieTest, MemoryUsage) {
+    MemoryUsage empty = trie.memoryUsage();
+    EXPECT_EQ(empty.rule_count, 0u);
+    EXPECT_GT(empty.bytes[static_cast<size_t>(MemCategory::Nodes)], 0u);  // 根节点
+
+    std::vector<std::pair<std::string, Rule>> rules;
+    rules.emplace_back("a.example.com", makeRule(1, Action::Block, "a"));
+    rules.emplace_back("b.example.com", makeRule(2, Action::Block, "b"));
+    trie.updateRules(rules);
+
+    MemoryUsage used = trie.memoryUsage();
+    EXPECT_EQ(used.rule_count, 2u);
+    // 根 + com + example + a + b
+    EXPECT_EQ(used.bytes[static_cast<size_t>(MemCategory::Nodes)], 5 * sizeof(TrieNode));
+    EXPECT_EQ(used.bytes[static_cast<size_t>(MemCategory::Labels)], 3u + 7u + 1u + 1u);
+    EXPECT_GE(used.bytes[static_cast<size_t>(MemCategory::Rules)], 2 * sizeof(Rule));
+    EXPECT_GT(used.bytes[static_cast<size_t>(MemCategory::Index)], 0u);
+    EXPECT_GE(used.reserved_bytes, used.totalBytes());
+    EXPECT_GT(used.bytesPerRule(), 0.0);
+    EXPECT_GE(used.fragmentation(), 0.0);
+    EXPECT_LT(used.fragmentation(), 1.0);
+
+    // 清空后只剩根节点
+    trie.clear();
+    MemoryUsage cleared = trie.memoryUsage();
+    EXPECT_EQ(cleared.rule_count, 0u);
+    EXPECT_EQ(cleared.bytes[static_cast<size_t>(MemCategory::Labels)], 0u);
+    EXPECT_EQ(cleared.bytes[static_cast<size_t>(MemCategory::Rules)], 0u);
+    EXPECT_EQ(cleared.allocations, 1u);
+}
+
+TEST_F(DomainTrieTest, MemoryUsageRollsUpToGlobal) {
+    MemoryUsage before = MemoryAccounting::global().usage();
+    {
+        DomainTrie other;
+        Rule rule = makeRule(1, Action::Block, "r");
+        other.insert("x.example.org", &rule);
+
+        MemoryUsage during = MemoryAccounting::global().usage();
+        EXPECT_EQ(during.rule_count, before.rule_count + 1);
+        EXPECT_EQ(during.totalBytes(), before.totalBytes() + other.memoryUsage().totalBytes());
+    }
+    MemoryUsage after = MemoryAccounting::global().usage();
+    EXPECT_EQ(after.rule_count, before.rule_count);
+    EXPECT_EQ(after.totalBytes(), before.totalBytes());
+    EXPECT_EQ(after.allocations, before.allocations);
+}
+
 // ==================== FilterEngine Tests ====================
 
 class FilterEngineTest : public ::testing::Test {
@@ -164,3 +300,43 @@ TEST_F(FilterEngineTest, Statistics) {
     EXPECT_EQ(stats.total_checks, 0);
 }
 
+TEST_F(FilterEngineTest, MemoryUsageIncludesRuleStorage) {
+    Rule rule;
+    rule.action = Action::Block;
+    engine.addRule(rule, "blocked.com", 11);
+
+    MemoryUsage usage = engine.memoryUsage();
+    EXPECT_EQ(usage.rule_count, 1u);
+    EXPECT_GE(usage.bytes[static_cast<size_t>(MemCategory::Rules)], sizeof(Rule));
+    EXPECT_GT(usage.bytesPerRule(), static_cast<double>(sizeof(Rule)));
+}
+
+
+TEST_F(FilterEngineTest, ConcurrentAddRule) {
+    // 增量添加只持有外层共享锁 (EngineSlot / C API), 多个线程并发从同一
+    // Rules Arena 分配
+    constexpr int kThreads = 4;
+    constexpr int kPerThread = 2000;
+    std::vector<std::thread> threads;
+    for (int t = 0; t < kThreads; t++) {
+        threads.emplace_back([this, t] {
+            Rule rule;
+            rule.action = Action::Block;
+            for (int i = 0; i < kPerThread; i++) {
+                rule.id = static_cast<uint32_t>(t * kPerThread + i + 1);
+                std::string domain = "d" + std::to_string(rule.id) + ".example";
+                engine.addRule(rule, domain.data(), domain.size());
+            }
+        });
+    }
+    for (auto& th : threads) th.join();
+
+    EXPECT_EQ(engine.ruleCount(), static_cast<size_t>(kThreads * kPerThread));
+    EXPECT_EQ(engine.memoryUsage().rule_count, static_cast<uint64_t>(kThreads * kPerThread));
+    for (uint32_t id = 1; id <= kThreads * kPerThread; id++) {
+        std::string domain = "d" + std::to_string(id) + ".example";
+        FilterResult r = engine.check(domain.data(), domain.size(), dns_type::A);
+        ASSERT_NE(r.matched_rule, nullptr) << domain;
+        EXPECT_EQ(r.matched_rule->id, id);
+    }
+}
@@ -0,0 +1,451 @@
+#include <gtest/gtest.h>
+#include "xdp_dns/dataplane.hpp"
+#include "xdp_dns/forwarder.hpp"
+#include "xdp_dns/stats.hpp"
+#include <netinet/in.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#include <chrono>
+#include <cstring>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace xdp_dns;
+
+namespace {
+
+std::vector<uint8_t> buildQuery(const std::string& domain, uint16_t id,
+                                uint16_t qtype = dns_type::A) {
+    std::vector<uint8_t> packet = {
+        static_cast<uint8_t>(id >> 8), static_cast<uint8_t>(id), 0x01, 0x00,
+        0x00, 0x01, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    };
+    size_t start = 0;
+    for (size_t i = 0; i <= domain.size(); i++) {
+        if (i == domain.size() || domain[i] == '.') {
+            packet.push_back(static_cast<uint8_t>(i - start));
+            packet.insert(packet.end(), domain.begin() + start, domain.begin() + i);
+            start = i + 1;
+        }
+    }
+    packet.insert(packet.end(), {0x00, static_cast<uint8_t>(qtype >> 8),
+                                 static_cast<uint8_t>(qtype), 0x00, 0x01});
+    return packet;
+}
+
+// 附加 OPT 记录 (DO=1, UDP 负载 1232)
+void appendDnssecOpt(std::vector<uint8_t>* packet) {
+    packet->insert(packet->end(), {0x00, 0x00, 0x29, 0x04, 0xD0, 0x00, 0x00, 0x80, 0x00,
+                                   0x00, 0x00});
+    (*packet)[11] = 1;
+}
+
+// 回环上的桩 DNS 服务器
+class StubServer {
+public:
+    enum class Mode { Answer, Silent, WrongQuestionFirst };
+
+    explicit StubServer(Mode mode) : mode_(mode) {
+        fd_ = ::socket(AF_INET, SOCK_DGRAM, 0);
+        sockaddr_in addr{};
+        addr.sin_family = AF_INET;
+        addr.sin_addr.s_addr = ::htonl(INADDR_LOOPBACK);
+        ::bind(fd_, reinterpret_cast<sockaddr*>(&addr), sizeof(addr));
+        socklen_t len = sizeof(addr);
+        ::getsockname(fd_, reinterpret_cast<sockaddr*>(&addr), &len);
+        port_ = ::ntohs(addr.sin_port);
+        thread_ = std::thread(&StubServer::run, this);
+    }
+
+    ~StubServer() {
+        running_ = false;
+        thread_.join();
+        ::close(fd_);
+    }
+
+    std::string address() const { return "127.0.0.1:" + std::to_string(port_); }
+    int received() const { return received_.load(); }
+
+private:
+    void run() {
+        uint8_t buf[512];
+        while (running_) {
+            pollfd pfd{fd_, POLLIN, 0};
+            if (::poll(&pfd, 1, 10) <= 0) continue;
+
+            sockaddr_in from{};
+            socklen_t from_len = sizeof(from);
+            ssize_t n = ::recvfrom(fd_, buf, sizeof(buf), 0,
+                                   reinterpret_cast<sockaddr*>(&from), &from_len);
+            if (n <= 0) continue;
+            received_++;
+            if (mode_ == Mode::Silent) continue;
+
+            DNSParseResult parsed;
+            if (DNSParser::parse(buf, n, &parsed) != Error::Success) continue;
+            uint8_t resp[512];
+            size_t len = DNSResponseBuilder::buildAResponse(
+                buf, n, parsed, ::htonl(0x0A000035), 60, resp, sizeof(resp));
+
+            if (mode_ == Mode::WrongQuestionFirst) {
+                // 问题名大小写不符的伪造响应先到
+                std::vector<uint8_t> spoofed(resp, resp + len);
+                spoofed[DNS_HEADER_SIZE + 1] ^= 0x20;
+                ::sendto(fd_, spoofed.data(), spoofed.size(), 0,
+                         reinterpret_cast<sockaddr*>(&from), from_len);
+            }
+            ::sendto(fd_, resp, len, 0, reinterpret_cast<sockaddr*>(&from), from_len);
+        }
+    }
+
+    Mode mode_;
+    int fd_ = -1;
+    uint16_t port_ = 0;
+    std::thread thread_;
+    std::atomic<bool> running_{true};
+    std::atomic<int> received_{0};
+};
+
+// 轮询 owner 0 直到取得 want 个完成或超时, 复制响应后归还表项
+std::vector<std::pair<uint64_t, std::vector<uint8_t>>> collect(Forwarder& fwd, size_t want) {
+    std::vector<std::pair<uint64_t, std::vector<uint8_t>>> out;
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+    ForwardCompletion done[16];
+    while (out.size() < want && std::chrono::steady_clock::now() < deadline) {
+        size_t n = fwd.poll(0, done, 16);
+        for (size_t i = 0; i < n; i++) {
+            out.emplace_back(done[i].cookie,
+                             std::vector<uint8_t>(done[i].response, done[i].response + done[i].len));
+        }
+        fwd.release(done, n);
+        if (n == 0) std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    return out;
+}
+
+ForwardRequest request(const std::vector<uint8_t>& query, uint64_t cookie) {
+    return ForwardRequest{query.data(), static_cast<uint32_t>(query.size()), 0, cookie};
+}
+
+} // namespace
+
+TEST(ForwarderTest, ForwardsAndRestoresClientId) {
+    StubServer stub(StubServer::Mode::Answer);
+    ForwarderOptions opts;
+    opts.servers = {stub.address()};
+    opts.num_sockets = 2;
+    Forwarder fwd(opts);
+    ASSERT_TRUE(fwd.start());
+    EXPECT_NE(fwd.localPort(0), 0);
+
+    std::vector<uint8_t> q1 = buildQuery("one.example.com", 0x1111);
+    std::vector<uint8_t> q2 = buildQuery("two.example.com", 0x2222);
+    ForwardRequest reqs[] = {request(q1, 1), request(q2, 2)};
+    bool accepted[2];
+    ASSERT_EQ(fwd.submit(reqs, 2, accepted), 2u);
+
+    auto done = collect(fwd, 2);
+    ASSERT_EQ(done.size(), 2u);
+    for (const auto& d : done) {
+        const std::vector<uint8_t>& resp = d.second;
+        ASSERT_GT(resp.size(), q1.size());
+        EXPECT_EQ(readU16(resp.data()), d.first == 1 ? 0x1111 : 0x2222);
+        EXPECT_EQ(resp[3] & 0x0F, dns_rcode::NOERROR);
+        EXPECT_EQ(readU32(resp.data() + resp.size() - 4), 0x0A000035u);
+    }
+
+    ForwarderStats stats = fwd.stats();
+    EXPECT_EQ(stats.submitted, 2u);
+    EXPECT_EQ(stats.sent, 2u);
+    EXPECT_EQ(stats.responses, 2u);
+    EXPECT_EQ(stats.completed, 2u);
+    EXPECT_EQ(stats.inflight, 0u);
+}
+
+TEST(ForwarderTest, RetriesNextServerAfterTimeout) {
+    StubServer silent(StubServer::Mode::Silent);
+    StubServer stub(StubServer::Mode::Answer);
+    ForwarderOptions opts;
+    opts.servers = {silent.address(), stub.address()};
+    opts.timeout_ms = 50;
+    opts.retries = 1;
+    Forwarder fwd(opts);
+    ASSERT_TRUE(fwd.start());
+
+    // 首个查询发往第一个上游
+    std::vector<uint8_t> q = buildQuery("retry.example.com", 0xABCD);
+    ForwardRequest req = request(q, 9);
+    bool accepted;
+    ASSERT_EQ(fwd.submit(&req, 1, &accepted), 1u);
+
+    auto done = collect(fwd, 1);
+    ASSERT_EQ(done.size(), 1u);
+    EXPECT_EQ(readU16(done[0].second.data()), 0xABCD);
+    EXPECT_EQ(done[0].second[3] & 0x0F, dns_rcode::NOERROR);
+    EXPECT_EQ(silent.received(), 1);
+    EXPECT_EQ(stub.received(), 1);
+    EXPECT_EQ(fwd.stats().retries, 1u);
+    EXPECT_EQ(fwd.stats().timeouts, 0u);
+}
+
+TEST(ForwarderTest, TimeoutCompletesWithServfail) {
+    StubServer silent(StubServer::Mode::Silent);
+    ForwarderOptions opts;
+    opts.servers = {silent.address()};
+    opts.timeout_ms = 30;
+    opts.retries = 1;
+    Forwarder fwd(opts);
+    ASSERT_TRUE(fwd.start());
+
+    std::vector<uint8_t> q = buildQuery("dead.example.com", 0x5555);
+    ForwardRequest req = request(q, 3);
+    bool accepted;
+    ASSERT_EQ(fwd.submit(&req, 1, &accepted), 1u);
+
+    auto done = collect(fwd, 1);
+    ASSERT_EQ(done.size(), 1u);
+    const std::vector<uint8_t>& resp = done[0].second;
+    ASSERT_EQ(resp.size(), q.size());
+    EXPECT_EQ(readU16(resp.data()), 0x5555);
+    EXPECT_EQ(resp[2] & 0x80, 0x80);
+    EXPECT_EQ(resp[3] & 0x0F, dns_rcode::SERVFAIL);
+    EXPECT_EQ(silent.received(), 2);
+    EXPECT_EQ(fwd.stats().timeouts, 1u);
+}
+
+TEST(ForwarderTest, DropsMismatchedResponses) {
+    StubServer stub(StubServer::Mode::WrongQuestionFirst);
+    ForwarderOptions opts;
+    opts.servers = {stub.address()};
+    Forwarder fwd(opts);
+    ASSERT_TRUE(fwd.start());
+
+    std::vector<uint8_t> q = buildQuery("case.example.com", 0x0102);
+    ForwardRequest req = request(q, 4);
+    bool accepted;
+    ASSERT_EQ(fwd.submit(&req, 1, &accepted), 1u);
+
+    auto done = collect(fwd, 1);
+    ASSERT_EQ(done.size(), 1u);
+    EXPECT_EQ(std::memcmp(done[0].second.data() + DNS_HEADER_SIZE, q.data() + DNS_HEADER_SIZE,
+                          q.size() - DNS_HEADER_SIZE), 0);
+    EXPECT_EQ(fwd.stats().mismatched, 1u);
+    EXPECT_EQ(fwd.stats().responses, 1u);
+}
+
+TEST(ForwarderTest, RejectsInvalidQueriesAndFullTable) {
+    StubServer silent(StubServer::Mode::Silent);
+    ForwarderOptions opts;
+    opts.servers = {silent.address()};
+    opts.max_inflight = 1;
+    Forwarder fwd(opts);
+
+    std::vector<uint8_t> q1 = buildQuery("a.example.com", 1);
+    std::vector<uint8_t> q2 = buildQuery("b.example.com", 2);
+    std::vector<uint8_t> response = q1;
+    response[2] |= 0x80;
+    ForwardRequest reqs[] = {request(q1, 1), request(q2, 2), request(response, 3)};
+    bool accepted[3];
+
+    // 未启动时全部拒绝
+    EXPECT_EQ(fwd.submit(reqs, 1, accepted), 0u);
+
+    ASSERT_TRUE(fwd.start());
+    EXPECT_EQ(fwd.submit(reqs, 3, accepted), 1u);
+    EXPECT_TRUE(accepted[0]);
+    EXPECT_FALSE(accepted[1]);
+    EXPECT_FALSE(accepted[2]);
+    EXPECT_EQ(fwd.stats().rejected, 3u);
+    EXPECT_EQ(fwd.stats().inflight, 1u);
+
+    ForwarderOptions bad;
+    bad.servers = {"not-an-address"};
+    Forwarder invalid(bad);
+    EXPECT_FALSE(invalid.start());
+}
+
+TEST(ForwarderTest, DataplaneForwardsAllowedQueries) {
+    StubServer stub(StubServer::Mode::Answer);
+    ForwarderOptions fopts;
+    fopts.servers = {stub.address()};
+    Forwarder fwd(fopts);
+    ASSERT_TRUE(fwd.start());
+
+    EngineSlot engine;
+    Rule block;
+    block.id = 1;
+    block.action = Action::Block;
+    engine.replace({{"blocked.example.com", block}});
+
+    DataplaneOptions opts;
+    opts.sample_interval = 0;
+    opts.forwarder = &fwd;
+    Dataplane dp(&engine, opts);
+    std::string name = "/xdp_dns_fwd_test_" + std::to_string(getpid());
+    ASSERT_TRUE(dp.open(name.c_str()));
+
+    auto toString = [](const std::vector<uint8_t>& v) { return std::string(v.begin(), v.end()); };
+    std::vector<std::string> queries = {
+        toString(buildQuery("www.example.com", 7)),
+        toString(buildQuery("blocked.example.com", 8)),
+    };
+    auto source = std::make_unique<ReplaySource>(std::move(queries), 1);
+    ReplaySource* replay = source.get();
+    ASSERT_TRUE(dp.setSource(0, std::move(source)));
+    ASSERT_TRUE(dp.start());
+
+    // 阻断的查询本地应答, 放行的经上游响应由 worker 发出
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+    while ((!replay->done() || replay->transmitted() < 1) &&
+           std::chrono::steady_clock::now() < deadline) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    dp.stop();
+
+    DataplaneStats stats = dp.stats();
+    EXPECT_EQ(stats.packets, 2u);
+    EXPECT_EQ(stats.responded, 1u);
+    EXPECT_EQ(stats.forwarded, 1u);
+    EXPECT_EQ(stats.upstream_replies, 1u);
+    EXPECT_EQ(replay->transmitted(), 1u);
+    EXPECT_EQ(stub.received(), 1);
+}
+
+TEST(ForwarderTest, DataplaneRefreshesCacheInBackground) {
+    StubServer stub(StubServer::Mode::Answer);
+    ForwarderOptions fopts;
+    fopts.servers = {stub.address()};
+    Forwarder fwd(fopts);
+    ASSERT_TRUE(fwd.start());
+
+    // 每次命中都落在预取窗口内
+    ResponseCacheOptions copts;
+    copts.prefetch_percent = 100;
+    ResponseCache cache(copts);
+    std::vector<uint8_t> query = buildQuery("www.example.com", 0x0909);
+    DNSParseResult parsed;
+    ASSERT_EQ(DNSParser::parse(query.data(), query.size(), &parsed), Error::Success);
+    uint8_t cached[512];
+    size_t cached_len = DNSResponseBuilder::buildAResponse(
+        query.data(), query.size(), parsed, ::htonl(0x0A000001), 300, cached, sizeof(cached));
+    ASSERT_TRUE(cache.insert(cached, cached_len, monotonicNs() - 1000000000ULL));
+
+    EngineSlot engine;
+    engine.replace({});
+    DataplaneOptions opts;
+    opts.sample_interval = 0;
+    opts.cache = &cache;
+    opts.forwarder = &fwd;
+    Dataplane dp(&engine, opts);
+    std::string name = "/xdp_dns_refresh_test_" + std::to_string(getpid());
+    ASSERT_TRUE(dp.open(name.c_str()));
+
+    std::vector<std::string> queries = {std::string(query.begin(), query.end())};
+    auto source = std::make_unique<ReplaySource>(std::move(queries), 1);
+    ReplaySource* replay = source.get();
+    ASSERT_TRUE(dp.setSource(0, std::move(source)));
+    ASSERT_TRUE(dp.start());
+
+    // 客户端由缓存立即应答; 刷新结果只写回缓存, 不发给客户端
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+    while ((!replay->done() || cache.stats().inserts < 2) &&
+           std::chrono::steady_clock::now() < deadline) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    dp.stop();
+
+    DataplaneStats stats = dp.stats();
+    EXPECT_EQ(stats.responded, 1u);
+    EXPECT_EQ(stats.cache_hits, 1u);
+    EXPECT_EQ(stats.cache_refreshes, 1u);
+    EXPECT_EQ(stats.forwarded, 0u);
+    EXPECT_EQ(stats.upstream_replies, 0u);
+    EXPECT_EQ(replay->transmitted(), 0u);
+    EXPECT_EQ(stub.received(), 1);
+
+    // 上游的 TTL 60 覆盖了原条目
+    ResponseCacheStats cstats = cache.stats();
+    EXPECT_EQ(cstats.inserts, 2u);
+    EXPECT_EQ(cstats.prefetches, 1u);
+    uint8_t out[512];
+    size_t len = cache.lookup(query.data(), query.size(), parsed, monotonicNs(), out, sizeof(out));
+    ASSERT_EQ(len, cached_len);
+    EXPECT_EQ(readU32(out + len - 4), 0x0A000035u);
+}
+
+TEST(ForwarderTest, CoalescesIdenticalQueries) {
+    StubServer stub(StubServer::Mode::Answer);
+    ForwarderOptions opts;
+    opts.servers = {stub.address()};
+    Forwarder fwd(opts);
+    ASSERT_TRUE(fwd.start());
+
+    // 大小写不同的同一问题合并; DO 位与 QTYPE 不同的单独发出
+    std::vector<uint8_t> lead = buildQuery("herd.example.com", 1);
+    std::vector<uint8_t> waiter = buildQuery("HERD.Example.com", 2);
+    waiter[2] = 0x00;  // RD = 0
+    std::vector<uint8_t> dnssec = buildQuery("herd.example.com", 3);
+    appendDnssecOpt(&dnssec);
+    std::vector<uint8_t> aaaa = buildQuery("herd.example.com", 4, dns_type::AAAA);
+    ForwardRequest reqs[] = {request(lead, 1), request(waiter, 2), request(dnssec, 3),
+                             request(aaaa, 4)};
+    bool accepted[4];
+    ASSERT_EQ(fwd.submit(reqs, 4, accepted), 4u);
+
+    auto done = collect(fwd, 4);
+    ASSERT_EQ(done.size(), 4u);
+    for (const auto& d : done) {
+        const std::vector<uint8_t>& resp = d.second;
+        EXPECT_EQ(readU16(resp.data()), d.first);
+        EXPECT_EQ(resp[3] & 0x0F, dns_rcode::NOERROR);
+        if (d.first == 2) {
+            // 等待者的 ID、RD 位与问题名大小写
+            EXPECT_EQ(resp[2] & 0x01, 0);
+            EXPECT_EQ(std::memcmp(resp.data() + DNS_HEADER_SIZE, waiter.data() + DNS_HEADER_SIZE,
+                                  waiter.size() - DNS_HEADER_SIZE), 0);
+            EXPECT_EQ(readU32(resp.data() + resp.size() - 4), 0x0A000035u);
+        }
+    }
+
+    EXPECT_EQ(stub.received(), 3);
+    ForwarderStats stats = fwd.stats();
+    EXPECT_EQ(stats.submitted, 4u);
+    EXPECT_EQ(stats.coalesced, 1u);
+    EXPECT_EQ(stats.sent, 3u);
+    EXPECT_EQ(stats.inflight, 0u);
+
+    // 领头完成后同一问题重新发往上游
+    ForwardRequest again = request(waiter, 5);
+    ASSERT_EQ(fwd.submit(&again, 1, accepted), 1u);
+    ASSERT_EQ(collect(fwd, 1).size(), 1u);
+    EXPECT_EQ(stub.received(), 4);
+}
+
+TEST(ForwarderTest, CoalescedWaitersShareTimeout) {
+    StubServer silent(StubServer::Mode::Silent);
+    ForwarderOptions opts;
+    opts.servers = {silent.address()};
+    opts.timeout_ms = 30;
+    opts.retries = 0;
+    Forwarder fwd(opts);
+    ASSERT_TRUE(fwd.start());
+
+    std::vector<std::vector<uint8_t>> queries;
+    std::vector<ForwardRequest> reqs;
+    for (uint16_t id = 1; id <= 8; id++) queries.push_back(buildQuery("slow.example.com", id));
+    for (const auto& q : queries) reqs.push_back(request(q, readU16(q.data())));
+    bool accepted[8];
+    ASSERT_EQ(fwd.submit(reqs.data(), reqs.size(), accepted), 8u);
+
+    auto done = collect(fwd, 8);
+    ASSERT_EQ(done.size(), 8u);
+    for (const auto& d : done) {
+        EXPECT_EQ(readU16(d.second.data()), d.first);
+        EXPECT_EQ(d.second[3] & 0x0F, dns_rcode::SERVFAIL);
+    }
+    EXPECT_EQ(silent.received(), 1);
+    EXPECT_EQ(fwd.stats().coalesced, 7u);
+    EXPECT_EQ(fwd.stats().timeouts, 1u);
+}
@@ -0,0 +1,264 @@
+#include <gtest/gtest.h>
+#include "xdp_dns/frame_parser.hpp"
+#include <string>
+#include <utility>
+#include <vector>
+
+using namespace xdp_dns;
+
+namespace {
+
+const std::string kPayload = "\x12\x34\x01\x00\x00\x01\x00\x00\x00\x00\x00\x00"
+                             "\x01" "a\x00\x00\x01\x00\x01";
+
+void putU16(std::vector<uint8_t>& f, size_t at, uint16_t v) {
+    f[at] = static_cast<uint8_t>(v >> 8);
+    f[at + 1] = static_cast<uint8_t>(v);
+}
+
+void appendU16(std::vector<uint8_t>& f, uint16_t v) {
+    f.push_back(static_cast<uint8_t>(v >> 8));
+    f.push_back(static_cast<uint8_t>(v));
+}
+
+// 以太网头, tags 为 (TPID, TCI), 外层在前
+std::vector<uint8_t> ethernet(uint16_t ether_type,
+                              std::vector<std::pair<uint16_t, uint16_t>> tags = {}) {
+    std::vector<uint8_t> f = {0x02, 0, 0, 0, 0, 0x01, 0x02, 0, 0, 0, 0, 0x02};
+    for (const auto& tag : tags) {
+        appendU16(f, tag.first);
+        appendU16(f, tag.second);
+    }
+    appendU16(f, ether_type);
+    return f;
+}
+
+void appendUDP(std::vector<uint8_t>& f, const std::string& payload) {
+    appendU16(f, 40000);
+    appendU16(f, 53);
+    appendU16(f, static_cast<uint16_t>(8 + payload.size()));
+    appendU16(f, 0);
+    f.insert(f.end(), payload.begin(), payload.end());
+}
+
+// IPv4 头 (options 为 4 字节的倍数), 之后接 l4_len 字节的 L4
+void appendIPv4(std::vector<uint8_t>& f, size_t l4_len, uint8_t proto = 17,
+                size_t options = 0, uint16_t frag = 0) {
+    size_t ihl = 20 + options;
+    size_t at = f.size();
+    f.resize(at + ihl, 0);
+    f[at] = static_cast<uint8_t>(0x40 | ihl / 4);
+    putU16(f, at + 2, static_cast<uint16_t>(ihl + l4_len));
+    putU16(f, at + 6, frag);
+    f[at + 8] = 64;
+    f[at + 9] = proto;
+    f[at + 12] = 192; f[at + 13] = 0; f[at + 14] = 2; f[at + 15] = 1;
+    f[at + 16] = 10;  f[at + 17] = 0; f[at + 18] = 0; f[at + 19] = 53;
+}
+
+void appendIPv6(std::vector<uint8_t>& f, size_t payload_len, uint8_t next) {
+    size_t at = f.size();
+    f.resize(at + 40, 0);
+    f[at] = 0x60;
+    putU16(f, at + 4, static_cast<uint16_t>(payload_len));
+    f[at + 6] = next;
+    f[at + 7] = 255;
+    f[at + 8] = 0x20; f[at + 9] = 0x01; f[at + 23] = 0x01;     // 2001::1
+    f[at + 24] = 0x20; f[at + 25] = 0x01; f[at + 39] = 0x53;   // 2001::53
+}
+
+std::vector<uint8_t> udp4Frame(const std::string& payload = kPayload) {
+    auto f = ethernet(0x0800);
+    appendIPv4(f, 8 + payload.size());
+    appendUDP(f, payload);
+    return f;
+}
+
+std::string payloadOf(const std::vector<uint8_t>& f, const FrameInfo& info) {
+    return std::string(reinterpret_cast<const char*>(f.data()) + info.payload_offset,
+                       info.payload_len);
+}
+
+} // namespace
+
+TEST(FrameParserTest, PlainIPv4) {
+    auto f = udp4Frame();
+    FrameInfo info;
+    ASSERT_EQ(FrameParser::parse(f.data(), f.size(), &info), Error::Success);
+
+    EXPECT_EQ(info.l3_offset, 14);
+    EXPECT_EQ(info.l4_offset, 34);
+    EXPECT_EQ(info.payload_offset, 42);
+    EXPECT_EQ(payloadOf(f, info), kPayload);
+    EXPECT_EQ(info.src_port, 40000);
+    EXPECT_EQ(info.dst_port, 53);
+    EXPECT_EQ(info.ip_version, 4);
+    EXPECT_EQ(info.hop_limit, 64);
+    EXPECT_EQ(info.flags, 0);
+    EXPECT_EQ(info.src_mac[5], 0x02);
+    EXPECT_EQ(info.dst_mac[5], 0x01);
+    const uint8_t src[4] = {192, 0, 2, 1};
+    EXPECT_EQ(std::memcmp(info.src_addr, src, 4), 0);
+    EXPECT_EQ(info.dst_addr[3], 53);
+}
+
+TEST(FrameParserTest, EthernetPaddingIsNotPayload) {
+    auto f = udp4Frame("\x01\x02\x03");
+    f.resize(60, 0xEE);     // 最小帧填充
+    FrameInfo info;
+    ASSERT_EQ(FrameParser::parse(f.data(), f.size(), &info), Error::Success);
+    EXPECT_EQ(info.payload_len, 3);
+
+    // UDP 长度大于 IP 长度时以 IP 为准
+    auto g = udp4Frame();
+    putU16(g, 34 + 4, 1000);
+    ASSERT_EQ(FrameParser::parse(g.data(), g.size(), &info), Error::Success);
+    EXPECT_EQ(payloadOf(g, info), kPayload);
+}
+
+TEST(FrameParserTest, QinQWithIPv4Options) {
+    auto f = ethernet(0x0800, {{0x88A8, 0x0064}, {0x8100, 0x2123}});
+    appendIPv4(f, 8 + kPayload.size(), 17, 8);
+    appendUDP(f, kPayload);
+
+    FrameInfo info;
+    ASSERT_EQ(FrameParser::parse(f.data(), f.size(), &info), Error::Success);
+    EXPECT_EQ(info.num_vlans, 2);
+    EXPECT_EQ(info.vlan_tci[0], 0x0064);
+    EXPECT_EQ(info.vlan_tci[1], 0x2123);
+    EXPECT_EQ(info.flags, FRAME_VLAN | FRAME_QINQ | FRAME_IP_OPTIONS);
+    EXPECT_EQ(info.l3_offset, 22);
+    EXPECT_EQ(info.l4_offset, 22 + 28);
+    EXPECT_EQ(payloadOf(f, info), kPayload);
+
+    // 第三层标签不支持
+    auto g = ethernet(0x0800, {{0x88A8, 1}, {0x8100, 2}, {0x8100, 3}});
+    appendIPv4(g, 8 + kPayload.size());
+    appendUDP(g, kPayload);
+    EXPECT_EQ(FrameParser::parse(g.data(), g.size(), &info), Error::InvalidHeader);
+}
+
+TEST(FrameParserTest, IPv6ExtensionChain) {
+    // Hop-by-Hop (8) → Destination Options (16) → Fragment (8, 首个分片) → UDP
+    auto f = ethernet(0x86DD, {{0x8100, 7}});
+    size_t udp_len = 8 + kPayload.size();
+    appendIPv6(f, 8 + 16 + 8 + udp_len, 0);
+    f.insert(f.end(), {60, 0, 1, 4, 0, 0, 0, 0});
+    f.insert(f.end(), {44, 1, 1, 12, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0});
+    f.insert(f.end(), {17, 0, 0x00, 0x01, 0xAB, 0xCD, 0xEF, 0x01});
+    appendUDP(f, kPayload);
+
+    FrameInfo info;
+    ASSERT_EQ(FrameParser::parse(f.data(), f.size(), &info), Error::Success);
+    EXPECT_EQ(info.ip_version, 6);
+    EXPECT_EQ(info.hop_limit, 255);
+    EXPECT_EQ(info.flags, FRAME_VLAN | FRAME_IPV6 | FRAME_IPV6_EXT | FRAME_FRAGMENT);
+    EXPECT_EQ(info.l3_offset, 18);
+    EXPECT_EQ(info.l4_offset, 18 + 40 + 32);
+    EXPECT_EQ(payloadOf(f, info), kPayload);
+    EXPECT_EQ(info.src_addr[0], 0x20);
+    EXPECT_EQ(info.src_addr[15], 0x01);
+    EXPECT_EQ(info.dst_addr[15], 0x53);
+
+    // 没有扩展头
+    auto g = ethernet(0x86DD);
+    appendIPv6(g, udp_len, 17);
+    appendUDP(g, kPayload);
+    ASSERT_EQ(FrameParser::parse(g.data(), g.size(), &info), Error::Success);
+    EXPECT_EQ(info.flags, FRAME_IPV6);
+    EXPECT_EQ(info.l4_offset, 54);
+}
+
+TEST(FrameParserTest, RejectsFragmentsAndNonUDP) {
+    FrameInfo info;
+
+    // IPv4 非首个分片 / 首个分片
+    auto later = ethernet(0x0800);
+    appendIPv4(later, 8 + kPayload.size(), 17, 0, 0x00B9);
+    appendUDP(later, kPayload);
+    EXPECT_EQ(FrameParser::parse(later.data(), later.size(), &info), Error::Fragmented);
+
+    auto first = ethernet(0x0800);
+    appendIPv4(first, 8 + kPayload.size(), 17, 0, 0x2000);
+    appendUDP(first, kPayload);
+    ASSERT_EQ(FrameParser::parse(first.data(), first.size(), &info), Error::Success);
+    EXPECT_EQ(info.flags, FRAME_FRAGMENT);
+
+    // IPv6 非首个分片
+    auto frag6 = ethernet(0x86DD);
+    appendIPv6(frag6, 8 + 8, 44);
+    frag6.insert(frag6.end(), {17, 0, 0x05, 0x00, 0, 0, 0, 1});
+    frag6.insert(frag6.end(), 8, 0);
+    EXPECT_EQ(FrameParser::parse(frag6.data(), frag6.size(), &info), Error::Fragmented);
+
+    // TCP、ESP、ARP
+    auto tcp = ethernet(0x0800);
+    appendIPv4(tcp, 20, 6);
+    tcp.resize(tcp.size() + 20, 0);
+    EXPECT_EQ(FrameParser::parse(tcp.data(), tcp.size(), &info), Error::NotUDP);
+
+    auto esp = ethernet(0x86DD);
+    appendIPv6(esp, 16, 50);
+    esp.resize(esp.size() + 16, 0);
+    EXPECT_EQ(FrameParser::parse(esp.data(), esp.size(), &info), Error::NotUDP);
+
+    auto arp = ethernet(0x0806);
+    arp.resize(60, 0);
+    EXPECT_EQ(FrameParser::parse(arp.data(), arp.size(), &info), Error::NotUDP);
+
+    // 扩展头链过长
+    auto chain = ethernet(0x86DD);
+    appendIPv6(chain, 8 * 10 + 8, 60);
+    for (int i = 0; i < 10; i++) chain.insert(chain.end(), {60, 0, 0, 0, 0, 0, 0, 0});
+    chain.resize(chain.size() + 8, 0);
+    EXPECT_EQ(FrameParser::parse(chain.data(), chain.size(), &info), Error::InvalidHeader);
+}
+
+TEST(FrameParserTest, TruncatedFramesNeverReadPastEnd) {
+    auto f = ethernet(0x86DD, {{0x88A8, 1}, {0x8100, 2}});
+    appendIPv6(f, 8 + 8 + kPayload.size(), 0);
+    f.insert(f.end(), {17, 0, 1, 4, 0, 0, 0, 0});
+    appendUDP(f, kPayload);
+
+    FrameInfo info;
+    size_t l4_end = 22 + 40 + 8 + 8;
+    for (size_t len = 0; len < f.size(); len++) {
+        // 每个前缀复制到恰好大小的堆块, 越界读会被 ASan 捕获
+        std::vector<uint8_t> prefix(f.begin(), f.begin() + len);
+        Error err = FrameParser::parse(prefix.data(), prefix.size(), &info);
+        if (len < l4_end) {
+            EXPECT_NE(err, Error::Success) << "len=" << len;
+        } else {
+            ASSERT_EQ(err, Error::Success) << "len=" << len;
+            EXPECT_EQ(info.payload_len, len - l4_end);
+        }
+    }
+}
+
+TEST(FrameParserTest, BatchReturnsSuccessMask) {
+    std::vector<std::vector<uint8_t>> frames;
+    for (int i = 0; i < 40; i++) {
+        if (i % 3 == 0) {
+            frames.push_back(ethernet(0x0806));
+        } else {
+            frames.push_back(udp4Frame());
+        }
+    }
+
+    const uint8_t* ptrs[40];
+    uint32_t lens[40];
+    for (size_t i = 0; i < frames.size(); i++) {
+        ptrs[i] = frames[i].data();
+        lens[i] = static_cast<uint32_t>(frames[i].size());
+    }
+
+    FrameInfo out[40];
+    uint64_t ok = FrameParser::parseBatch(ptrs, lens, frames.size(), out);
+    for (size_t i = 0; i < frames.size(); i++) {
+        EXPECT_EQ((ok >> i & 1) != 0, i % 3 != 0) << i;
+        if (ok >> i & 1) {
+            EXPECT_EQ(out[i].payload_offset, 42);
+        }
+    }
+    EXPECT_EQ(ok >> 40, 0u);
+}
@@ -0,0 +1,392 @@
+#include <gtest/gtest.h>
+#include "xdp_dns/domain_trie.hpp"
+#include "xdp_dns/engine_slot.hpp"
+#include "xdp_dns/local_zone.hpp"
+#include "xdp_dns/rule_loader.hpp"
+#include <arpa/inet.h>
+#include <cstring>
+#include <memory>
+#include <string>
+#include <vector>
+
+using namespace xdp_dns;
+
+namespace {
+
+std::vector<uint8_t> buildQuery(const std::string& domain, uint16_t qtype = dns_type::A) {
+    std::vector<uint8_t> packet = {
+        0xAB, 0xCD, 0x01, 0x00, 0x00, 0x01, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    };
+    size_t start = 0;
+    for (size_t i = 0; i <= domain.size(); i++) {
+        if (i == domain.size() || domain[i] == '.') {
+            packet.push_back(static_cast<uint8_t>(i - start));
+            packet.insert(packet.end(), domain.begin() + start, domain.begin() + i);
+            start = i + 1;
+        }
+    }
+    packet.push_back(0);
+    packet.push_back(static_cast<uint8_t>(qtype >> 8));
+    packet.push_back(static_cast<uint8_t>(qtype));
+    packet.push_back(0x00);
+    packet.push_back(0x01);
+    return packet;
+}
+
+std::string dotted(const uint8_t* wire) {
+    std::string out;
+    for (size_t i = 0; wire[i] != 0; i += wire[i] + 1) {
+        if (!out.empty()) out += '.';
+        out.append(reinterpret_cast<const char*>(wire + i + 1), wire[i]);
+    }
+    return out;
+}
+
+struct Record {
+    std::string owner;
+    uint16_t type;
+    uint32_t ttl;
+    std::vector<uint8_t> rdata;
+};
+
+struct Reply {
+    size_t len = 0;
+    uint16_t id = 0;
+    uint16_t flags = 0;
+    std::string qname;
+    std::vector<Record> answers;
+    std::vector<Record> authority;
+
+    uint8_t rcode() const { return flags & 0x0F; }
+    bool aa() const { return flags & 0x0400; }
+};
+
+// 在 query 上就地应答并展开各区记录
+Reply ask(const LocalZones& zones, const std::string& name, uint16_t qtype,
+          uint32_t rotation = 0) {
+    auto packet = buildQuery(name, qtype);
+    packet.resize(1232);
+    DNSParseResult parsed;
+    EXPECT_EQ(DNSParser::parse(packet.data(), packet.size(), &parsed), Error::Success);
+    char domain[MAX_DOMAIN_LENGTH + 1];
+    size_t domain_len = 0;
+    EXPECT_EQ(DNSParser::decodeName(packet.data(), packet.size(), parsed.question.name_offset,
+                                    domain, sizeof(domain), &domain_len),
+              Error::Success);
+
+    Reply reply;
+    reply.len = zones.answer(packet.data(), parsed, domain, domain_len, packet.data(),
+                             packet.size(), rotation);
+    if (!reply.len) return reply;
+
+    const uint8_t* resp = packet.data();
+    EXPECT_EQ(DNSParser::parse(resp, reply.len, &parsed), Error::Success);
+    reply.id = parsed.header->getId();
+    reply.flags = parsed.header->getFlags();
+    uint8_t wire[MAX_DOMAIN_LENGTH + 1];
+    size_t wire_len = 0, pos = 0;
+    EXPECT_EQ(DNSParser::expandName(resp, reply.len, parsed.question.name_offset, wire,
+                                    &wire_len, &pos),
+              Error::Success);
+    reply.qname = dotted(wire);
+
+    pos = parsed.total_consumed;
+    uint16_t counts[2] = {parsed.header->getANCount(), readU16(resp + 8)};
+    for (int section = 0; section < 2; section++) {
+        for (uint16_t i = 0; i < counts[section]; i++) {
+            size_t end = 0;
+            EXPECT_EQ(DNSParser::expandName(resp, reply.len, pos, wire, &wire_len, &end),
+                      Error::Success);
+            Record r{dotted(wire), readU16(resp + end), readU32(resp + end + 4), {}};
+            uint16_t rdlen = readU16(resp + end + 8);
+            r.rdata.assign(resp + end + 10, resp + end + 10 + rdlen);
+            if (r.type == dns_type::CNAME) {
+                // 目标可能压缩, 展开后比较
+                size_t target_end = 0;
+                EXPECT_EQ(DNSParser::expandName(resp, reply.len, end + 10, wire, &wire_len,
+                                                &target_end),
+                          Error::Success);
+                r.rdata.assign(wire, wire + wire_len);
+            }
+            (section == 0 ? reply.answers : reply.authority).push_back(std::move(r));
+            pos = end + 10 + rdlen;
+        }
+    }
+    EXPECT_EQ(pos, reply.len);
+    return reply;
+}
+
+uint32_t ipv4(const Record& r) {
+    EXPECT_EQ(r.rdata.size(), 4u);
+    return readU32(r.rdata.data());
+}
+
+void load(LocalZones* zones, const std::vector<std::string>& apexes,
+          const std::vector<std::string>& records, uint32_t negative_ttl = 300) {
+    for (const auto& apex : apexes) ASSERT_EQ(zones->addZone(apex), Error::Success) << apex;
+    for (const auto& rec : records) ASSERT_EQ(zones->addRecord(rec), Error::Success) << rec;
+    ASSERT_EQ(zones->compile(negative_ttl), Error::Success);
+}
+
+} // anonymous namespace
+
+TEST(LocalZoneTest, ParsesRecordText) {
+    LocalZones zones;
+    EXPECT_EQ(zones.addRecord("a.corp.example. 60 IN A 10.0.0.1"), Error::Success);
+    EXPECT_EQ(zones.addRecord("a.corp.example IN 60 AAAA 2001:db8::1"), Error::Success);
+    EXPECT_EQ(zones.addRecord("b.corp.example TXT \"hello world\" plain ; comment"),
+              Error::Success);
+    EXPECT_EQ(zones.addRecord("_sip._udp.corp.example SRV 10 5 5060 sip.corp.example."),
+              Error::Success);
+    EXPECT_EQ(zones.addRecord("1.0.0.10.in-addr.arpa PTR a.corp.example."), Error::Success);
+    EXPECT_EQ(zones.recordCount(), 5u);
+
+    EXPECT_EQ(zones.addRecord("a.corp.example A"), Error::InvalidRule);
+    EXPECT_EQ(zones.addRecord("a.corp.example A 10.0.0.256"), Error::InvalidRule);
+    EXPECT_EQ(zones.addRecord("a.corp.example MX 10 mail.corp.example"), Error::InvalidRule);
+    EXPECT_EQ(zones.addRecord("a..corp.example A 10.0.0.1"), Error::InvalidRule);
+    EXPECT_EQ(zones.addRecord("a.corp.example TXT \"unterminated"), Error::InvalidRule);
+    EXPECT_EQ(zones.addRecord("a.corp.example SRV 10 5 70000 x.corp.example"),
+              Error::InvalidRule);
+    EXPECT_EQ(zones.addRecord("corp.example SOA ns. admin. 1 2 3"), Error::InvalidRule);
+}
+
+TEST(LocalZoneTest, AnswersExactNames) {
+    LocalZones zones;
+    load(&zones, {"corp.example."}, {
+        "www.corp.example. 60 A 10.0.0.1",
+        "www.corp.example. 60 A 10.0.0.2",
+        "www.corp.example. 60 AAAA 2001:db8::1",
+        "txt.corp.example. TXT \"v=spf1 -all\" \"second\"",
+        "_ldap._tcp.corp.example. SRV 0 5 389 dc1.corp.example.",
+    });
+
+    // ID 与问题名大小写原样带回, AA 置位
+    Reply a = ask(zones, "WWW.Corp.example", dns_type::A);
+    ASSERT_GT(a.len, 0u);
+    EXPECT_EQ(a.id, 0xABCD);
+    EXPECT_TRUE(a.aa());
+    EXPECT_EQ(a.flags & 0x8100, 0x8100);   // QR, RD
+    EXPECT_EQ(a.rcode(), dns_rcode::NOERROR);
+    EXPECT_EQ(a.qname, "WWW.Corp.example");
+    ASSERT_EQ(a.answers.size(), 2u);
+    EXPECT_EQ(a.answers[0].owner, "WWW.Corp.example");
+    EXPECT_EQ(a.answers[0].ttl, 60u);
+    EXPECT_EQ(ipv4(a.answers[0]), 0x0A000001u);
+    EXPECT_EQ(ipv4(a.answers[1]), 0x0A000002u);
+    EXPECT_TRUE(a.authority.empty());
+
+    // 多地址轮转
+    Reply rotated = ask(zones, "www.corp.example", dns_type::A, 1);
+    ASSERT_EQ(rotated.answers.size(), 2u);
+    EXPECT_EQ(ipv4(rotated.answers[0]), 0x0A000002u);
+
+    Reply aaaa = ask(zones, "www.corp.example", dns_type::AAAA);
+    ASSERT_EQ(aaaa.answers.size(), 1u);
+    EXPECT_EQ(aaaa.answers[0].rdata[0], 0x20);
+    EXPECT_EQ(aaaa.answers[0].ttl, 60u);
+
+    Reply txt = ask(zones, "txt.corp.example", dns_type::TXT);
+    ASSERT_EQ(txt.answers.size(), 1u);
+    EXPECT_EQ(txt.answers[0].ttl, LocalZones::kDefaultTtl);
+    EXPECT_EQ(txt.answers[0].rdata,
+              (std::vector<uint8_t>{11, 'v', '=', 's', 'p', 'f', '1', ' ', '-', 'a', 'l', 'l',
+                                    6, 's', 'e', 'c', 'o', 'n', 'd'}));
+
+    Reply srv = ask(zones, "_ldap._tcp.corp.example", dns_type::SRV);
+    ASSERT_EQ(srv.answers.size(), 1u);
+    EXPECT_EQ(readU16(srv.answers[0].rdata.data() + 4), 389);
+    EXPECT_EQ(dotted(srv.answers[0].rdata.data() + 6), "dc1.corp.example");
+
+    Reply any = ask(zones, "www.corp.example", dns_type::ANY);
+    EXPECT_EQ(any.answers.size(), 3u);
+
+    // 区外名字不处理
+    EXPECT_EQ(ask(zones, "www.example.com", dns_type::A).len, 0u);
+    EXPECT_EQ(ask(zones, "example", dns_type::A).len, 0u);
+}
+
+TEST(LocalZoneTest, NegativeAnswersCarrySoa) {
+    LocalZones zones;
+    load(&zones, {"corp.example"}, {
+        "www.corp.example. A 10.0.0.1",
+        "_ldap._tcp.corp.example. SRV 0 5 389 dc1.corp.example.",
+    }, 120);
+
+    // 名字存在但无该类型: NODATA
+    Reply nodata = ask(zones, "www.corp.example", dns_type::TXT);
+    ASSERT_GT(nodata.len, 0u);
+    EXPECT_TRUE(nodata.aa());
+    EXPECT_EQ(nodata.rcode(), dns_rcode::NOERROR);
+    EXPECT_TRUE(nodata.answers.empty());
+    ASSERT_EQ(nodata.authority.size(), 1u);
+    EXPECT_EQ(nodata.authority[0].owner, "corp.example");
+    EXPECT_EQ(nodata.authority[0].type, dns_type::SOA);
+    EXPECT_EQ(nodata.authority[0].ttl, 120u);
+
+    // 空的中间节点同样是 NODATA
+    Reply ent = ask(zones, "_tcp.corp.example", dns_type::A);
+    EXPECT_EQ(ent.rcode(), dns_rcode::NOERROR);
+    EXPECT_EQ(ent.authority.size(), 1u);
+
+    Reply nx = ask(zones, "missing.corp.example", dns_type::A);
+    ASSERT_GT(nx.len, 0u);
+    EXPECT_TRUE(nx.aa());
+    EXPECT_EQ(nx.rcode(), dns_rcode::NXDOMAIN);
+    ASSERT_EQ(nx.authority.size(), 1u);
+    EXPECT_EQ(nx.authority[0].owner, "corp.example");
+
+    Reply deep = ask(zones, "a.b.missing.corp.example", dns_type::AAAA);
+    EXPECT_EQ(deep.rcode(), dns_rcode::NXDOMAIN);
+
+    // 合成的 SOA 也回答顶点的 SOA 查询
+    Reply soa = ask(zones, "corp.example", dns_type::SOA);
+    ASSERT_EQ(soa.answers.size(), 1u);
+    EXPECT_EQ(dotted(soa.answers[0].rdata.data()), "localhost");
+}
+
+TEST(LocalZoneTest, ExplicitSoaLimitsNegativeTtl) {
+    LocalZones zones;
+    load(&zones, {"corp.example"}, {
+        "corp.example. 600 SOA ns1.corp.example. admin.corp.example. 7 3600 600 86400 30",
+    });
+    Reply nx = ask(zones, "missing.corp.example", dns_type::A);
+    ASSERT_EQ(nx.authority.size(), 1u);
+    EXPECT_EQ(nx.authority[0].ttl, 30u);   // min(SOA TTL, MINIMUM)
+    EXPECT_EQ(dotted(nx.authority[0].rdata.data()), "ns1.corp.example");
+}
+
+TEST(LocalZoneTest, SynthesizesFromWildcards) {
+    LocalZones zones;
+    load(&zones, {"corp.example"}, {
+        "*.dev.corp.example. 30 A 10.0.0.9",
+        "fixed.dev.corp.example. A 10.0.0.10",
+    });
+
+    Reply a = ask(zones, "Box1.dev.corp.example", dns_type::A);
+    ASSERT_EQ(a.answers.size(), 1u);
+    EXPECT_EQ(a.answers[0].owner, "Box1.dev.corp.example");
+    EXPECT_EQ(a.answers[0].ttl, 30u);
+    EXPECT_EQ(ipv4(a.answers[0]), 0x0A000009u);
+
+    // 最近祖先仍是 dev.corp.example
+    Reply deep = ask(zones, "x.y.dev.corp.example", dns_type::A);
+    ASSERT_EQ(deep.answers.size(), 1u);
+    EXPECT_EQ(deep.answers[0].owner, "x.y.dev.corp.example");
+
+    // 通配符不覆盖已存在的名字; 通配符下无该类型时 NODATA
+    Reply fixed = ask(zones, "fixed.dev.corp.example", dns_type::A);
+    ASSERT_EQ(fixed.answers.size(), 1u);
+    EXPECT_EQ(ipv4(fixed.answers[0]), 0x0A00000Au);
+    Reply nodata = ask(zones, "box1.dev.corp.example", dns_type::AAAA);
+    EXPECT_EQ(nodata.rcode(), dns_rcode::NOERROR);
+    EXPECT_TRUE(nodata.answers.empty());
+
+    // 最近祖先不是 dev 时没有通配符
+    EXPECT_EQ(ask(zones, "other.corp.example", dns_type::A).rcode(), dns_rcode::NXDOMAIN);
+}
+
+TEST(LocalZoneTest, ChasesLocalCnameTargets) {
+    LocalZones zones;
+    load(&zones, {"corp.example"}, {
+        "alias.corp.example. 60 CNAME www.corp.example.",
+        "www.corp.example. 60 A 10.0.0.1",
+        "www.corp.example. 60 A 10.0.0.2",
+        "external.corp.example. CNAME www.example.com.",
+    });
+
+    Reply a = ask(zones, "alias.corp.example", dns_type::A);
+    ASSERT_EQ(a.answers.size(), 3u);
+    EXPECT_EQ(a.answers[0].type, dns_type::CNAME);
+    EXPECT_EQ(dotted(a.answers[0].rdata.data()), "www.corp.example");
+    EXPECT_EQ(a.answers[1].owner, "www.corp.example");
+    EXPECT_EQ(a.answers[2].owner, "www.corp.example");
+
+    // 目标没有该类型 / 不在本地: 只回答 CNAME
+    Reply txt = ask(zones, "alias.corp.example", dns_type::TXT);
+    ASSERT_EQ(txt.answers.size(), 1u);
+    EXPECT_EQ(txt.answers[0].type, dns_type::CNAME);
+    Reply ext = ask(zones, "external.corp.example", dns_type::A);
+    ASSERT_EQ(ext.answers.size(), 1u);
+    EXPECT_EQ(dotted(ext.answers[0].rdata.data()), "www.example.com");
+}
+
+TEST(LocalZoneTest, RejectsInvalidZoneData) {
+    {
+        LocalZones zones;
+        ASSERT_EQ(zones.addZone("corp.example"), Error::Success);
+        ASSERT_EQ(zones.addRecord("www.other.example A 10.0.0.1"), Error::Success);
+        EXPECT_EQ(zones.compile(300), Error::InvalidRule);   // 不在任何区内
+    }
+    {
+        LocalZones zones;
+        ASSERT_EQ(zones.addZone("corp.example"), Error::Success);
+        ASSERT_EQ(zones.addRecord("a.corp.example CNAME b.corp.example"), Error::Success);
+        ASSERT_EQ(zones.addRecord("a.corp.example A 10.0.0.1"), Error::Success);
+        EXPECT_EQ(zones.compile(300), Error::InvalidRule);   // CNAME 与其它数据共存
+    }
+    LocalZones zones;
+    EXPECT_EQ(zones.addZone("bad..zone"), Error::InvalidRule);
+}
+
+TEST(LocalZoneTest, LoadsFromRuleYaml) {
+    const char yaml[] = R"(rules:
+  - id: block
+    enabled: true
+    action: block
+    domains: [ads.example.com]
+local_zones: [corp.example, 10.in-addr.arpa]
+local_data:
+  - "www.corp.example. 60 A 10.0.0.1"
+  - 'txt.corp.example. TXT "hello world"'
+  - 1.0.0.10.in-addr.arpa PTR www.corp.example.
+negative_ttl: 90
+)";
+    RuleEntries entries;
+    LocalZones zones;
+    ASSERT_EQ(parseRuleYaml(yaml, sizeof(yaml) - 1, &entries, nullptr, &zones), Error::Success);
+    EXPECT_EQ(entries.size(), 1u);
+    EXPECT_EQ(zones.zoneCount(), 2u);
+    EXPECT_EQ(zones.recordCount(), 5u);     // 含两个合成的 SOA
+
+    Reply ptr = ask(zones, "1.0.0.10.in-addr.arpa", dns_type::PTR);
+    ASSERT_EQ(ptr.answers.size(), 1u);
+    Reply nx = ask(zones, "2.0.0.10.in-addr.arpa", dns_type::PTR);
+    ASSERT_EQ(nx.authority.size(), 1u);
+    EXPECT_EQ(nx.authority[0].ttl, 90u);
+
+    FilterEngine engine;
+    ASSERT_EQ(engine.loadRules(yaml, sizeof(yaml) - 1), Error::Success);
+    ASSERT_NE(engine.localZones(), nullptr);
+    EXPECT_EQ(engine.localZones()->nameCount(), zones.nameCount());
+
+    const char bad[] = "local_zones: [corp.example]\nlocal_data:\n  - \"www.corp.example A x\"\n";
+    LocalZones rejected;
+    EXPECT_EQ(parseRuleYaml(bad, sizeof(bad) - 1, &entries, nullptr, &rejected),
+              Error::InvalidRule);
+}
+
+TEST(LocalZoneTest, ReplaceRulesKeepsRuleSetZonesAndPolicy) {
+    auto zones = std::make_shared<LocalZones>();
+    load(zones.get(), {"corp.example."}, {"www.corp.example. 60 A 10.0.0.1"});
+    RuleSetPolicy policy;
+    policy.any_policy = AnyPolicy::Hinfo;
+    policy.negative_ttl = 90;
+
+    Rule rule;
+    rule.action = Action::Block;
+    EngineSlot slot;
+    slot.replace({{"old.example", rule}}, policy, zones);
+    uint64_t generation = slot.generation();
+
+    // 只换规则, 本地权威区与策略沿用当前规则集
+    slot.replaceRules({{"new.example", rule}});
+    EXPECT_GT(slot.generation(), generation);
+    EXPECT_EQ(slot.localZones(), zones);
+    EXPECT_EQ(slot.policy().any_policy, AnyPolicy::Hinfo);
+    EXPECT_EQ(slot.policy().negative_ttl, 90u);
+    slot.read([](const FilterEngine& engine) {
+        EXPECT_EQ(engine.check("old.example", 11, dns_type::A).action, Action::Allow);
+        EXPECT_EQ(engine.check("new.example", 11, dns_type::A).action, Action::Block);
+    });
+}
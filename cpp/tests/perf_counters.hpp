@@ -0,0 +1,202 @@
+#pragma once
+
+// 基准测试硬件性能计数器 (perf_event_open 封装)
+//
+// 每个基准测试循环前后读取 cycles / instructions / L1d / LLC / 分支 / dTLB 未命中,
+// 按包归一化后写入 benchmark 的 counters. perf 受限 (perf_event_paranoid, 容器,
+// 虚拟机无 PMU) 时自动降级为不输出计数器; XDP_DNS_PERF_COUNTERS=0 可显式关闭.
+
+#include <benchmark/benchmark.h>
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#include <cerrno>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+namespace xdp_dns {
+namespace bench {
+
+class PerfCounters {
+public:
+    enum Event {
+        Cycles = 0,
+        Instructions,
+        L1DMisses,
+        LLCMisses,
+        BranchMisses,
+        DTLBMisses,
+        kNumEvents,
+    };
+
+    static PerfCounters& instance() {
+        static PerfCounters counters;
+        return counters;
+    }
+
+    bool available() const { return available_; }
+    bool has(Event e) const { return fds_[e] >= 0; }
+
+    static const char* name(Event e) {
+        static const char* const names[kNumEvents] = {
+            "cycles/pkt", "instructions/pkt", "L1d-misses/pkt",
+            "LLC-misses/pkt", "branch-misses/pkt", "dTLB-misses/pkt",
+        };
+        return names[e];
+    }
+
+    void start() {
+        for (int fd : fds_) {
+            if (fd < 0) continue;
+            ioctl(fd, PERF_EVENT_IOC_RESET, 0);
+            ioctl(fd, PERF_EVENT_IOC_ENABLE, 0);
+        }
+    }
+
+    void stop() {
+        for (int i = 0; i < kNumEvents; i++) {
+            if (fds_[i] < 0) continue;
+            ioctl(fds_[i], PERF_EVENT_IOC_DISABLE, 0);
+            values_[i] = readScaled(fds_[i]);
+        }
+    }
+
+    // 暂停 / 恢复计数, 不清零 (对应 state.PauseTiming / ResumeTiming)
+    void pause() {
+        for (int fd : fds_) {
+            if (fd >= 0) ioctl(fd, PERF_EVENT_IOC_DISABLE, 0);
+        }
+    }
+
+    void resume() {
+        for (int fd : fds_) {
+            if (fd >= 0) ioctl(fd, PERF_EVENT_IOC_ENABLE, 0);
+        }
+    }
+
+    // 最近一次 start/stop 区间的计数 (已按多路复用比例缩放)
+    double value(Event e) const { return values_[e]; }
+
+    ~PerfCounters() {
+        for (int fd : fds_) {
+            if (fd >= 0) close(fd);
+        }
+    }
+
+    PerfCounters(const PerfCounters&) = delete;
+    PerfCounters& operator=(const PerfCounters&) = delete;
+
+private:
+    PerfCounters() {
+        for (int i = 0; i < kNumEvents; i++) {
+            fds_[i] = -1;
+            values_[i] = 0;
+        }
+
+        const char* env = std::getenv("XDP_DNS_PERF_COUNTERS");
+        if (env && std::strcmp(env, "0") == 0) {
+            return;
+        }
+
+        const uint64_t cache_miss_read =
+            (PERF_COUNT_HW_CACHE_OP_READ << 8) | (PERF_COUNT_HW_CACHE_RESULT_MISS << 16);
+
+        fds_[Cycles] = openEvent(PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES);
+        fds_[Instructions] = openEvent(PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS);
+        fds_[L1DMisses] = openEvent(PERF_TYPE_HW_CACHE, PERF_COUNT_HW_CACHE_L1D | cache_miss_read);
+        fds_[LLCMisses] = openEvent(PERF_TYPE_HW_CACHE, PERF_COUNT_HW_CACHE_LL | cache_miss_read);
+        fds_[BranchMisses] = openEvent(PERF_TYPE_HARDWARE, PERF_COUNT_HW_BRANCH_MISSES);
+        fds_[DTLBMisses] = openEvent(PERF_TYPE_HW_CACHE, PERF_COUNT_HW_CACHE_DTLB | cache_miss_read);
+
+        for (int fd : fds_) {
+            if (fd >= 0) available_ = true;
+        }
+        if (!available_) {
+            std::fprintf(stderr,
+                "perf counters unavailable (%s), reporting timings only\n",
+                std::strerror(open_errno_));
+        }
+    }
+
+    int openEvent(uint32_t type, uint64_t config) {
+        perf_event_attr attr;
+        std::memset(&attr, 0, sizeof(attr));
+        attr.size = sizeof(attr);
+        attr.type = type;
+        attr.config = config;
+        attr.disabled = 1;
+        attr.exclude_kernel = 1;
+        attr.exclude_hv = 1;
+        attr.read_format = PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+
+        int fd = static_cast<int>(syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0));
+        if (fd < 0) {
+            open_errno_ = errno;
+        }
+        return fd;
+    }
+
+    static double readScaled(int fd) {
+        uint64_t buf[3] = {0, 0, 0};  // value, time_enabled, time_running
+        if (read(fd, buf, sizeof(buf)) != static_cast<ssize_t>(sizeof(buf)) || buf[2] == 0) {
+            return 0;
+        }
+        return static_cast<double>(buf[0]) * buf[1] / buf[2];
+    }
+
+    int fds_[kNumEvents];
+    double values_[kNumEvents];
+    bool available_ = false;
+    int open_errno_ = 0;
+};
+
+// 包裹基准测试循环: 构造时开始计数, 析构时按包归一化写入 state.counters
+//
+//   PerfScope perf(state, kBatchSize);
+//   for (auto _ : state) { ... }
+class PerfScope {
+public:
+    explicit PerfScope(benchmark::State& state, double packets_per_iteration = 1)
+        : state_(state), packets_per_iteration_(packets_per_iteration) {
+        PerfCounters::instance().start();
+    }
+
+    ~PerfScope() {
+        PerfCounters& pc = PerfCounters::instance();
+        pc.stop();
+        if (!pc.available() || state_.iterations() == 0) {
+            return;
+        }
+
+        double packets = static_cast<double>(state_.iterations()) * packets_per_iteration_;
+        for (int i = 0; i < PerfCounters::kNumEvents; i++) {
+            auto e = static_cast<PerfCounters::Event>(i);
+            if (pc.has(e)) {
+                state_.counters[PerfCounters::name(e)] = pc.value(e) / packets;
+            }
+        }
+        if (pc.has(PerfCounters::Cycles) && pc.has(PerfCounters::Instructions) &&
+            pc.value(PerfCounters::Cycles) > 0) {
+            state_.counters["IPC"] =
+                pc.value(PerfCounters::Instructions) / pc.value(PerfCounters::Cycles);
+        }
+    }
+
+    // 循环内不计时的准备 / 清理段也不计数:
+    //   state.PauseTiming(); perf.pause(); ... perf.resume(); state.ResumeTiming();
+    void pause() { PerfCounters::instance().pause(); }
+    void resume() { PerfCounters::instance().resume(); }
+
+    PerfScope(const PerfScope&) = delete;
+    PerfScope& operator=(const PerfScope&) = delete;
+
+private:
+    benchmark::State& state_;
+    double packets_per_iteration_;
+};
+
+} // namespace bench
+} // namespace xdp_dns
@@ -0,0 +1,429 @@
+#include <gtest/gtest.h>
+#include "xdp_dns/response_cache.hpp"
+#include <string>
+#include <vector>
+
+using namespace xdp_dns;
+
+namespace {
+
+constexpr uint64_t kSec = 1000000000ULL;
+
+std::vector<uint8_t> buildQuery(const std::string& domain, uint16_t id = 0x1234,
+                                uint16_t qtype = dns_type::A) {
+    std::vector<uint8_t> packet = {
+        static_cast<uint8_t>(id >> 8), static_cast<uint8_t>(id), 0x01, 0x00,
+        0x00, 0x01, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    };
+    size_t start = 0;
+    for (size_t i = 0; i <= domain.size(); i++) {
+        if (i == domain.size() || domain[i] == '.') {
+            packet.push_back(static_cast<uint8_t>(i - start));
+            packet.insert(packet.end(), domain.begin() + start, domain.begin() + i);
+            start = i + 1;
+        }
+    }
+    packet.push_back(0);
+    packet.push_back(static_cast<uint8_t>(qtype >> 8));
+    packet.push_back(static_cast<uint8_t>(qtype));
+    packet.push_back(0x00);
+    packet.push_back(0x01);
+    return packet;
+}
+
+// 附加 OPT 记录 (ARCOUNT 加 1)
+void appendOpt(std::vector<uint8_t>* packet, bool dnssec_ok) {
+    packet->insert(packet->end(), {0x00, 0x00, 0x29, 0x04, 0xD0, 0x00, 0x00,
+                                   static_cast<uint8_t>(dnssec_ok ? 0x80 : 0x00), 0x00,
+                                   0x00, 0x00});
+    writeU16(packet->data() + 10, readU16(packet->data() + 10) + 1);
+}
+
+// 上游响应: 一条 A 记录
+std::vector<uint8_t> buildUpstream(const std::string& domain, uint32_t ttl,
+                                   uint32_t ip = 0x0A000001) {
+    std::vector<uint8_t> query = buildQuery(domain, 0xBEEF);
+    DNSParseResult parsed;
+    EXPECT_EQ(DNSParser::parse(query.data(), query.size(), &parsed), Error::Success);
+    std::vector<uint8_t> response(512);
+    size_t len = DNSResponseBuilder::buildAResponse(
+        query.data(), query.size(), parsed, htonl(ip), ttl, response.data(), response.size());
+    response.resize(len);
+    return response;
+}
+
+// 上游否定应答: 权威区一条 SOA, 所有者与 MNAME/RNAME 以指针指向问题中的 zone
+std::vector<uint8_t> buildNegative(const std::string& domain, const std::string& zone,
+                                   uint8_t rcode, uint32_t ttl, uint32_t minimum,
+                                   uint16_t qtype = dns_type::A) {
+    std::vector<uint8_t> packet = buildQuery(domain, 0xBEEF, qtype);
+    writeU16(packet.data() + 2, static_cast<uint16_t>(0x8180 | rcode));
+    writeU16(packet.data() + 8, 1);
+    size_t zone_off = DNS_HEADER_SIZE + domain.size() - zone.size();
+    uint8_t zone_hi = static_cast<uint8_t>(0xC0 | (zone_off >> 8));
+    uint8_t zone_lo = static_cast<uint8_t>(zone_off);
+    auto pushU32 = [&packet](uint32_t v) {
+        for (int shift = 24; shift >= 0; shift -= 8) packet.push_back(static_cast<uint8_t>(v >> shift));
+    };
+
+    packet.insert(packet.end(), {zone_hi, zone_lo, 0x00, 0x06, 0x00, 0x01});
+    pushU32(ttl);
+    size_t rdlen = packet.size();
+    packet.insert(packet.end(), {0x00, 0x00, 3, 'n', 's', '1', zone_hi, zone_lo,
+                                 10, 'h', 'o', 's', 't', 'm', 'a', 's', 't', 'e', 'r',
+                                 zone_hi, zone_lo});
+    for (uint32_t v : {1u, 3600u, 600u, 86400u, minimum}) pushU32(v);
+    writeU16(packet.data() + rdlen, static_cast<uint16_t>(packet.size() - rdlen - 2));
+    return packet;
+}
+
+size_t lookup(ResponseCache& cache, const std::vector<uint8_t>& query, uint64_t now,
+              std::vector<uint8_t>* out, bool* refresh = nullptr) {
+    DNSParseResult parsed;
+    EXPECT_EQ(DNSParser::parse(query.data(), query.size(), &parsed), Error::Success);
+    out->assign(512, 0);
+    size_t len = cache.lookup(query.data(), query.size(), parsed, now, out->data(), out->size(),
+                              refresh);
+    out->resize(len);
+    return len;
+}
+
+} // namespace
+
+TEST(ResponseCacheTest, HitPatchesIdCaseAndTtl) {
+    ResponseCache cache;
+    std::vector<uint8_t> upstream = buildUpstream("www.example.com", 120);
+    std::vector<uint8_t> out;
+
+    EXPECT_EQ(lookup(cache, buildQuery("www.example.com"), 0, &out), 0u);
+    ASSERT_TRUE(cache.insert(upstream.data(), upstream.size(), 10 * kSec));
+
+    // 大小写不同的同一问题命中, 回显客户端的 ID 与大小写
+    std::vector<uint8_t> query = buildQuery("WwW.ExAmple.COM", 0x4242);
+    ASSERT_EQ(lookup(cache, query, 10 * kSec, &out), upstream.size());
+    EXPECT_EQ(readU16(out.data()), 0x4242);
+    EXPECT_EQ(std::memcmp(out.data() + DNS_HEADER_SIZE, query.data() + DNS_HEADER_SIZE,
+                          query.size() - DNS_HEADER_SIZE), 0);
+    EXPECT_EQ(readU32(out.data() + out.size() - 4), 0x0A000001u);
+    EXPECT_EQ(readU32(out.data() + out.size() - 10), 120u);
+
+    // TTL 按插入以来的整秒数递减
+    ASSERT_EQ(lookup(cache, query, 55 * kSec + kSec / 2, &out), upstream.size());
+    EXPECT_EQ(readU32(out.data() + out.size() - 10), 75u);
+
+    // 过期后未命中并清除
+    EXPECT_EQ(lookup(cache, query, 130 * kSec, &out), 0u);
+    ResponseCacheStats stats = cache.stats();
+    EXPECT_EQ(stats.hits, 2u);
+    EXPECT_EQ(stats.misses, 2u);
+    EXPECT_EQ(stats.expired, 1u);
+    EXPECT_EQ(stats.entries, 0u);
+}
+
+TEST(ResponseCacheTest, InPlaceHitAndTtlCap) {
+    ResponseCacheOptions opts;
+    opts.max_ttl = 60;
+    ResponseCache cache(opts);
+    std::vector<uint8_t> upstream = buildUpstream("cap.example.com", 86400);
+    ASSERT_TRUE(cache.insert(upstream.data(), upstream.size(), 0));
+
+    // AF_XDP 帧: 在查询所在的缓冲区原地改写
+    std::vector<uint8_t> frame = buildQuery("cap.example.com", 0x7777);
+    size_t query_len = frame.size();
+    frame.resize(2048);
+    DNSParseResult parsed;
+    ASSERT_EQ(DNSParser::parse(frame.data(), query_len, &parsed), Error::Success);
+    size_t len = cache.lookup(frame.data(), query_len, parsed, 0, frame.data(), frame.size());
+    ASSERT_EQ(len, upstream.size());
+    EXPECT_EQ(readU16(frame.data()), 0x7777);
+    EXPECT_EQ(readU32(frame.data() + len - 10), 60u);
+
+    // 超过上限的 TTL 按上限过期
+    std::vector<uint8_t> out;
+    EXPECT_EQ(lookup(cache, buildQuery("cap.example.com"), 61 * kSec, &out), 0u);
+}
+
+TEST(ResponseCacheTest, KeyIncludesTypeAndEdns) {
+    ResponseCache cache;
+    std::vector<uint8_t> plain = buildUpstream("dnssec.example.com", 300, 0x0A000001);
+    std::vector<uint8_t> signed_resp = buildUpstream("dnssec.example.com", 300, 0x0A000002);
+    appendOpt(&signed_resp, true);
+    ASSERT_TRUE(cache.insert(plain.data(), plain.size(), 0));
+    ASSERT_TRUE(cache.insert(signed_resp.data(), signed_resp.size(), 0));
+
+    std::vector<uint8_t> out;
+    ASSERT_GT(lookup(cache, buildQuery("dnssec.example.com"), 0, &out), 0u);
+    EXPECT_EQ(readU32(out.data() + out.size() - 4), 0x0A000001u);
+
+    std::vector<uint8_t> do_query = buildQuery("dnssec.example.com");
+    appendOpt(&do_query, true);
+    ASSERT_EQ(lookup(cache, do_query, 0, &out), signed_resp.size());
+    EXPECT_EQ(readU16(out.data() + 10), 1);  // OPT 保留
+
+    std::vector<uint8_t> edns_query = buildQuery("dnssec.example.com");
+    appendOpt(&edns_query, false);
+    EXPECT_EQ(lookup(cache, edns_query, 0, &out), 0u);
+    EXPECT_EQ(lookup(cache, buildQuery("dnssec.example.com", 1, dns_type::AAAA), 0, &out), 0u);
+}
+
+TEST(ResponseCacheTest, RejectsUncacheableResponses) {
+    ResponseCacheOptions opts;
+    opts.max_entry_size = 64;
+    ResponseCache cache(opts);
+
+    std::vector<uint8_t> zero_ttl = buildUpstream("zero.example.com", 0);
+    EXPECT_FALSE(cache.insert(zero_ttl.data(), zero_ttl.size(), 0));
+
+    std::vector<uint8_t> truncated = buildUpstream("tc.example.com", 300);
+    truncated[2] |= 0x02;
+    EXPECT_FALSE(cache.insert(truncated.data(), truncated.size(), 0));
+
+    std::vector<uint8_t> nxdomain = buildUpstream("nx.example.com", 300);
+    nxdomain[3] |= dns_rcode::NXDOMAIN;
+    EXPECT_FALSE(cache.insert(nxdomain.data(), nxdomain.size(), 0));
+
+    std::vector<uint8_t> query = buildQuery("query.example.com");
+    EXPECT_FALSE(cache.insert(query.data(), query.size(), 0));
+
+    std::vector<uint8_t> cut = buildUpstream("cut.example.com", 300);
+    cut.resize(cut.size() - 2);
+    EXPECT_FALSE(cache.insert(cut.data(), cut.size(), 0));
+
+    std::vector<uint8_t> large = buildUpstream("a-rather-long-label-for-the-size-limit.example.com", 300);
+    EXPECT_FALSE(cache.insert(large.data(), large.size(), 0));
+
+    EXPECT_EQ(cache.stats().rejected, 6u);
+    EXPECT_EQ(cache.stats().entries, 0u);
+}
+
+TEST(ResponseCacheTest, ClockEvictionKeepsReferencedEntries) {
+    // 单分片单组: 8 个槽
+    ResponseCacheOptions opts;
+    opts.capacity = 8;
+    opts.shards = 1;
+    ResponseCache cache(opts);
+    ASSERT_EQ(cache.capacity(), ResponseCache::kWays);
+
+    std::vector<uint8_t> out;
+    for (int i = 0; i < 8; i++) {
+        std::vector<uint8_t> r = buildUpstream("host" + std::to_string(i) + ".example.com", 300);
+        ASSERT_TRUE(cache.insert(r.data(), r.size(), 0));
+    }
+    ASSERT_GT(lookup(cache, buildQuery("host0.example.com"), 0, &out), 0u);
+
+    // host0 有引用位, 被淘汰的是 host1
+    std::vector<uint8_t> extra = buildUpstream("extra.example.com", 300);
+    ASSERT_TRUE(cache.insert(extra.data(), extra.size(), 0));
+    EXPECT_GT(lookup(cache, buildQuery("host0.example.com"), 0, &out), 0u);
+    EXPECT_EQ(lookup(cache, buildQuery("host1.example.com"), 0, &out), 0u);
+    EXPECT_GT(lookup(cache, buildQuery("extra.example.com"), 0, &out), 0u);
+
+    ResponseCacheStats stats = cache.stats();
+    EXPECT_EQ(stats.evictions, 1u);
+    EXPECT_EQ(stats.entries, 8u);
+    EXPECT_GT(cache.memoryUsage().bytes[static_cast<size_t>(MemCategory::Cache)], 0u);
+}
+
+TEST(ResponseCacheTest, PrefetchWindowRequestsRefresh) {
+    ResponseCache cache;                        // prefetch_percent = 10
+    std::vector<uint8_t> upstream = buildUpstream("hot.example.com", 100);
+    ASSERT_TRUE(cache.insert(upstream.data(), upstream.size(), 0));
+
+    std::vector<uint8_t> query = buildQuery("hot.example.com");
+    std::vector<uint8_t> out;
+    bool refresh = true;
+    ASSERT_GT(lookup(cache, query, 50 * kSec, &out, &refresh), 0u);
+    EXPECT_FALSE(refresh);
+
+    // 最后 10 秒内命中要求刷新, 同一条目每秒最多一次
+    ASSERT_GT(lookup(cache, query, 91 * kSec, &out, &refresh), 0u);
+    EXPECT_TRUE(refresh);
+    ASSERT_GT(lookup(cache, query, 91 * kSec + kSec / 2, &out, &refresh), 0u);
+    EXPECT_FALSE(refresh);
+    ASSERT_GT(lookup(cache, query, 92 * kSec + kSec / 2, &out, &refresh), 0u);
+    EXPECT_TRUE(refresh);
+
+    // 刷新结果覆盖原槽, TTL 重新计算
+    ASSERT_TRUE(cache.insert(upstream.data(), upstream.size(), 93 * kSec));
+    ASSERT_GT(lookup(cache, query, 94 * kSec, &out, &refresh), 0u);
+    EXPECT_FALSE(refresh);
+    EXPECT_EQ(readU32(out.data() + out.size() - 10), 99u);
+
+    ResponseCacheStats stats = cache.stats();
+    EXPECT_EQ(stats.prefetches, 2u);
+    EXPECT_EQ(stats.entries, 1u);
+
+    ResponseCacheOptions opts;
+    opts.prefetch_percent = 0;
+    ResponseCache off(opts);
+    ASSERT_TRUE(off.insert(upstream.data(), upstream.size(), 0));
+    ASSERT_GT(lookup(off, query, 99 * kSec, &out, &refresh), 0u);
+    EXPECT_FALSE(refresh);
+}
+
+TEST(ResponseCacheTest, ServesStaleWithinWindow) {
+    ResponseCacheOptions opts;
+    opts.stale_window = 60;
+    ResponseCache cache(opts);
+    std::vector<uint8_t> upstream = buildUpstream("stale.example.com", 100);
+    ASSERT_TRUE(cache.insert(upstream.data(), upstream.size(), 0));
+
+    // 过期后以 stale_ttl 应答并要求刷新
+    std::vector<uint8_t> query = buildQuery("stale.example.com", 0x5151);
+    std::vector<uint8_t> out;
+    bool refresh = false;
+    ASSERT_EQ(lookup(cache, query, 120 * kSec, &out, &refresh), upstream.size());
+    EXPECT_TRUE(refresh);
+    EXPECT_EQ(readU16(out.data()), 0x5151);
+    EXPECT_EQ(readU32(out.data() + out.size() - 10), 30u);
+    ASSERT_GT(lookup(cache, query, 120 * kSec + kSec / 2, &out, &refresh), 0u);
+    EXPECT_FALSE(refresh);
+
+    // 超过窗口后清除
+    EXPECT_EQ(lookup(cache, query, 160 * kSec, &out, &refresh), 0u);
+    EXPECT_FALSE(refresh);
+
+    ResponseCacheStats stats = cache.stats();
+    EXPECT_EQ(stats.hits, 2u);
+    EXPECT_EQ(stats.stale_hits, 2u);
+    EXPECT_EQ(stats.expired, 1u);
+    EXPECT_EQ(stats.entries, 0u);
+}
+
+TEST(ResponseCacheTest, RefreshQueryMatchesEntry) {
+    ResponseCache cache;
+    std::vector<uint8_t> upstream = buildUpstream("Refresh.Example.com", 300);
+    appendOpt(&upstream, true);
+    ASSERT_TRUE(cache.insert(upstream.data(), upstream.size(), 0));
+
+    uint8_t buf[512];
+    size_t len = ResponseCache::buildRefreshQuery(upstream.data(), upstream.size(), 0x0102, buf,
+                                                  sizeof(buf));
+    ASSERT_GT(len, 0u);
+    std::vector<uint8_t> query(buf, buf + len);
+
+    DNSParseResult parsed;
+    ASSERT_EQ(DNSParser::parse(query.data(), query.size(), &parsed), Error::Success);
+    EXPECT_EQ(parsed.id, 0x0102);
+    EXPECT_EQ(parsed.flags, 0x0100);
+    EXPECT_EQ(DNSParser::queryEdns(query.data(), query.size(), parsed), EDNS_PRESENT | EDNS_DO);
+
+    // 与原条目同键
+    std::vector<uint8_t> out;
+    EXPECT_EQ(lookup(cache, query, kSec, &out), upstream.size());
+
+    EXPECT_EQ(ResponseCache::buildRefreshQuery(upstream.data(), upstream.size(), 1, buf, 20), 0u);
+    std::vector<uint8_t> plain = buildQuery("refresh.example.com");
+    EXPECT_EQ(ResponseCache::buildRefreshQuery(plain.data(), plain.size(), 1, buf, sizeof(buf)),
+              0u);
+}
+
+TEST(ResponseCacheTest, CachesNegativeAnswersWithSoaTtl) {
+    ResponseCache cache;
+    std::vector<uint8_t> out;
+
+    // NXDOMAIN: TTL 取 min(SOA TTL, MINIMUM)
+    std::vector<uint8_t> nx = buildNegative("nx.example.com", "example.com", dns_rcode::NXDOMAIN,
+                                            3600, 60);
+    ASSERT_TRUE(cache.insert(nx.data(), nx.size(), 0));
+    std::vector<uint8_t> query = buildQuery("NX.example.com", 0x6161);
+    ASSERT_EQ(lookup(cache, query, 10 * kSec, &out), nx.size());
+    EXPECT_EQ(readU16(out.data()), 0x6161);
+    EXPECT_EQ(out[3] & 0x0F, dns_rcode::NXDOMAIN);
+    EXPECT_EQ(readU32(out.data() + query.size() + 6), 50u);
+    EXPECT_EQ(lookup(cache, query, 61 * kSec, &out), 0u);
+
+    // NODATA: SOA TTL 更小时取 TTL; 键含 QTYPE
+    std::vector<uint8_t> nodata = buildNegative("v4.example.com", "example.com",
+                                                dns_rcode::NOERROR, 30, 600, dns_type::AAAA);
+    ASSERT_TRUE(cache.insert(nodata.data(), nodata.size(), 0));
+    query = buildQuery("v4.example.com", 1, dns_type::AAAA);
+    ASSERT_EQ(lookup(cache, query, 0, &out), nodata.size());
+    EXPECT_EQ(readU32(out.data() + query.size() + 6), 30u);
+    EXPECT_EQ(lookup(cache, buildQuery("v4.example.com"), 0, &out), 0u);
+
+    // 按 max_negative_ttl 截断
+    std::vector<uint8_t> longer = buildNegative("long.example.com", "example.com",
+                                                dns_rcode::NXDOMAIN, 86400, 86400);
+    ASSERT_TRUE(cache.insert(longer.data(), longer.size(), 0));
+    query = buildQuery("long.example.com");
+    ASSERT_GT(lookup(cache, query, 0, &out), 0u);
+    EXPECT_EQ(readU32(out.data() + query.size() + 6), 300u);
+
+    // 没有 SOA 的否定应答与其它 RCODE 不缓存
+    std::vector<uint8_t> bare = buildQuery("bare.example.com");
+    writeU16(bare.data() + 2, 0x8183);
+    EXPECT_FALSE(cache.insert(bare.data(), bare.size(), 0));
+    std::vector<uint8_t> servfail = buildNegative("sf.example.com", "example.com",
+                                                  dns_rcode::SERVFAIL, 60, 60);
+    EXPECT_FALSE(cache.insert(servfail.data(), servfail.size(), 0));
+
+    ResponseCacheStats stats = cache.stats();
+    EXPECT_EQ(stats.negative_inserts, 3u);
+    EXPECT_EQ(stats.rejected, 2u);
+}
+
+TEST(ResponseCacheTest, NxdomainCutAnswersDescendants) {
+    ResponseCache cache;
+    std::vector<uint8_t> nx = buildNegative("gone.example.com", "example.com",
+                                            dns_rcode::NXDOMAIN, 3600, 60);
+    ASSERT_TRUE(cache.insert(nx.data(), nx.size(), 0));
+
+    // 其下的名字、任意类型都直接 NXDOMAIN, 带节点的 SOA
+    std::vector<uint8_t> out;
+    std::vector<uint8_t> query = buildQuery("Deep.Sub.GONE.example.com", 0x7272, dns_type::AAAA);
+    ASSERT_GT(lookup(cache, query, 20 * kSec, &out), 0u);
+    EXPECT_EQ(readU16(out.data()), 0x7272);
+    EXPECT_EQ(out[3] & 0x0F, dns_rcode::NXDOMAIN);
+    EXPECT_EQ(out[2] & 0x04, 0);                    // AA 清除
+    EXPECT_EQ(std::memcmp(out.data() + DNS_HEADER_SIZE, query.data() + DNS_HEADER_SIZE,
+                          query.size() - DNS_HEADER_SIZE), 0);
+
+    DNSParseResult parsed;
+    ASSERT_EQ(DNSParser::parse(out.data(), out.size(), &parsed), Error::Success);
+    EXPECT_EQ(parsed.header->getANCount(), 0);
+    EXPECT_EQ(parsed.header->getNSCount(), 1);
+    DNSSoaRecord soa;
+    ASSERT_EQ(DNSParser::findAuthoritySoa(out.data(), out.size(), parsed, &soa), Error::Success);
+    EXPECT_EQ(soa.ttl, 40u);
+    EXPECT_EQ(soa.minimum, 60u);
+    const char zone[] = "\x07" "example" "\x03" "com";
+    ASSERT_EQ(soa.owner_len, sizeof(zone));
+    EXPECT_EQ(std::memcmp(soa.owner, zone, sizeof(zone)), 0);
+
+    ASSERT_GT(lookup(cache, buildQuery("gone.example.com", 1, dns_type::TXT), 0, &out), 0u);
+
+    // EDNS 查询带 OPT; DO 查询需要 NSEC 证明, 不走截断点
+    std::vector<uint8_t> edns = buildQuery("x.gone.example.com");
+    appendOpt(&edns, false);
+    ASSERT_GT(lookup(cache, edns, 0, &out), 0u);
+    EXPECT_EQ(readU16(out.data() + 10), 1);
+    EXPECT_EQ(readU16(out.data() + out.size() - 10), dns_type::OPT);
+    std::vector<uint8_t> dnssec = buildQuery("x.gone.example.com");
+    appendOpt(&dnssec, true);
+    EXPECT_EQ(lookup(cache, dnssec, 0, &out), 0u);
+
+    EXPECT_EQ(lookup(cache, buildQuery("other.example.com"), 0, &out), 0u);
+    EXPECT_EQ(lookup(cache, buildQuery("a.gone.example.com"), 61 * kSec, &out), 0u);
+
+    ResponseCacheStats stats = cache.stats();
+    EXPECT_EQ(stats.cut_hits, 3u);
+    EXPECT_EQ(stats.misses, 3u);
+
+    // 关闭截断点, 或 NXDOMAIN 属于 CNAME 目标时不记录
+    ResponseCacheOptions opts;
+    opts.nxdomain_cut = false;
+    ResponseCache off(opts);
+    ASSERT_TRUE(off.insert(nx.data(), nx.size(), 0));
+    EXPECT_EQ(lookup(off, buildQuery("a.gone.example.com"), 0, &out), 0u);
+
+    ResponseCache chained;
+    std::vector<uint8_t> cname = buildNegative("alias.example.com", "example.com",
+                                               dns_rcode::NXDOMAIN, 60, 60);
+    size_t answer = DNS_HEADER_SIZE + 19 + 4;
+    cname.insert(cname.begin() + answer, {0xC0, 0x0C, 0x00, 0x05, 0x00, 0x01, 0x00, 0x00, 0x00,
+                                          0x3C, 0x00, 0x04, 1, 'x', 0xC0, 0x12});
+    writeU16(cname.data() + 6, 1);
+    ASSERT_TRUE(chained.insert(cname.data(), cname.size(), 0));
+    EXPECT_EQ(lookup(chained, buildQuery("a.alias.example.com"), 0, &out), 0u);
+}
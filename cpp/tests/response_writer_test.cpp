@@ -0,0 +1,288 @@
+#include <gtest/gtest.h>
+#include "xdp_dns/response_writer.hpp"
+#include <arpa/inet.h>
+#include <cstring>
+#include <string>
+#include <vector>
+
+using namespace xdp_dns;
+
+namespace {
+
+std::vector<uint8_t> buildQuery(const std::string& domain, uint16_t qtype = dns_type::A) {
+    std::vector<uint8_t> packet = {
+        0x12, 0x34, 0x01, 0x00, 0x00, 0x01, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    };
+    size_t start = 0;
+    for (size_t i = 0; i <= domain.size(); i++) {
+        if (i == domain.size() || domain[i] == '.') {
+            packet.push_back(static_cast<uint8_t>(i - start));
+            packet.insert(packet.end(), domain.begin() + start, domain.begin() + i);
+            start = i + 1;
+        }
+    }
+    packet.push_back(0);
+    packet.push_back(static_cast<uint8_t>(qtype >> 8));
+    packet.push_back(static_cast<uint8_t>(qtype));
+    packet.push_back(0x00);
+    packet.push_back(0x01);
+    return packet;
+}
+
+std::vector<uint8_t> wireName(const std::string& name) {
+    std::vector<uint8_t> out(MAX_DOMAIN_LENGTH + 1);
+    size_t len = ResponseWriter::encodeName(name.data(), name.size(), out.data(), out.size());
+    out.resize(len);
+    return out;
+}
+
+std::string dotted(const uint8_t* wire) {
+    std::string out;
+    for (size_t i = 0; wire[i] != 0; i += wire[i] + 1) {
+        if (!out.empty()) out += '.';
+        out.append(reinterpret_cast<const char*>(wire + i + 1), wire[i]);
+    }
+    return out;
+}
+
+struct Answer {
+    std::string owner;
+    uint16_t type;
+    uint32_t ttl;
+    size_t rdata_offset;
+    uint16_t rdata_len;
+};
+
+// 逐条展开回答区 (验证压缩指针)
+std::vector<Answer> parseAnswers(const uint8_t* resp, size_t len) {
+    DNSParseResult parsed;
+    EXPECT_EQ(DNSParser::parse(resp, len, &parsed), Error::Success);
+    std::vector<Answer> out;
+    size_t pos = parsed.total_consumed;
+    for (uint16_t i = 0; i < parsed.header->getANCount(); i++) {
+        uint8_t name[MAX_DOMAIN_LENGTH + 1];
+        size_t name_len = 0, end = 0;
+        EXPECT_EQ(DNSParser::expandName(resp, len, pos, name, &name_len, &end), Error::Success);
+        if (end + 10 > len) {
+            ADD_FAILURE() << "truncated record";
+            break;
+        }
+        Answer a{dotted(name), readU16(resp + end), readU32(resp + end + 4), end + 10,
+                 readU16(resp + end + 8)};
+        out.push_back(a);
+        pos = end + 10 + a.rdata_len;
+    }
+    EXPECT_EQ(pos, len);
+    return out;
+}
+
+std::string rdataName(const uint8_t* resp, size_t len, const Answer& a) {
+    uint8_t name[MAX_DOMAIN_LENGTH + 1];
+    size_t name_len = 0, end = 0;
+    EXPECT_EQ(DNSParser::expandName(resp, len, a.rdata_offset, name, &name_len, &end),
+              Error::Success);
+    EXPECT_EQ(end, a.rdata_offset + a.rdata_len);
+    return dotted(name);
+}
+
+} // anonymous namespace
+
+TEST(ResponseWriterTest, EncodeName) {
+    EXPECT_EQ(wireName("www.Example.com"),
+              (std::vector<uint8_t>{3, 'w', 'w', 'w', 7, 'E', 'x', 'a', 'm', 'p', 'l', 'e',
+                                    3, 'c', 'o', 'm', 0}));
+    EXPECT_EQ(wireName("example.com."), wireName("example.com"));
+    EXPECT_EQ(wireName(""), std::vector<uint8_t>{0});
+    EXPECT_EQ(wireName("."), std::vector<uint8_t>{0});
+
+    EXPECT_TRUE(wireName("a..b").empty());
+    EXPECT_TRUE(wireName(".a").empty());
+    EXPECT_TRUE(wireName(std::string(64, 'a') + ".com").empty());
+    EXPECT_FALSE(wireName(std::string(63, 'a') + ".com").empty());
+}
+
+TEST(ResponseWriterTest, CompressesCnameTargetAgainstQuestion) {
+    auto query = buildQuery("ads.example.com");
+    DNSParseResult parsed;
+    ASSERT_EQ(DNSParser::parse(query.data(), query.size(), &parsed), Error::Success);
+
+    auto target = wireName("portal.example.com");
+    uint8_t resp[512];
+    ResponseWriter w;
+    ASSERT_TRUE(w.begin(query.data(), parsed, resp, sizeof(resp)));
+    ASSERT_TRUE(w.addCNAME(nullptr, 60, target.data()));
+    size_t len = w.finish();
+
+    // 所有者 0xC00C + 10 字节固定部分 + "\x06portal" + 指向 "example.com" 的指针
+    ASSERT_EQ(len, query.size() + 2 + 10 + 7 + 2);
+    const uint8_t* rdata = resp + query.size() + 12;
+    EXPECT_EQ(readU16(rdata - 2), 9);
+    EXPECT_EQ(rdata[0], 6);
+    EXPECT_EQ(readU16(rdata + 7), 0xC010);
+
+    EXPECT_EQ(resp[2] & 0x80, 0x80);
+    auto answers = parseAnswers(resp, len);
+    ASSERT_EQ(answers.size(), 1u);
+    EXPECT_EQ(answers[0].owner, "ads.example.com");
+    EXPECT_EQ(answers[0].type, dns_type::CNAME);
+    EXPECT_EQ(answers[0].ttl, 60u);
+    EXPECT_EQ(rdataName(resp, len, answers[0]), "portal.example.com");
+}
+
+TEST(ResponseWriterTest, AddressOwnerPointsIntoCnameRdata) {
+    auto query = buildQuery("ads.tracker.net");
+    DNSParseResult parsed;
+    ASSERT_EQ(DNSParser::parse(query.data(), query.size(), &parsed), Error::Success);
+
+    auto target = wireName("block.example.org");
+    uint8_t resp[512];
+    ResponseWriter w;
+    ASSERT_TRUE(w.begin(query.data(), parsed, resp, sizeof(resp)));
+    ASSERT_TRUE(w.addCNAME(nullptr, 30, target.data()));
+    ASSERT_TRUE(w.addA(target.data(), 30, ::htonl(0x0A000001)));
+    ASSERT_TRUE(w.addA(target.data(), 30, ::htonl(0x0A000002)));
+    size_t len = w.finish();
+
+    // 目标名字只出现一次, 两条 A 的所有者都是 2 字节指针
+    ASSERT_EQ(len, query.size() + (12 + target.size()) + 2 * (12 + 4));
+    auto answers = parseAnswers(resp, len);
+    ASSERT_EQ(answers.size(), 3u);
+    EXPECT_EQ(rdataName(resp, len, answers[0]), "block.example.org");
+    EXPECT_EQ(answers[1].owner, "block.example.org");
+    EXPECT_EQ(answers[2].owner, "block.example.org");
+    EXPECT_EQ(readU32(resp + answers[2].rdata_offset), 0x0A000002u);
+}
+
+TEST(ResponseWriterTest, SplitsLongTxtAndWritesPtr) {
+    auto query = buildQuery("4.3.2.1.in-addr.arpa", dns_type::PTR);
+    DNSParseResult parsed;
+    ASSERT_EQ(DNSParser::parse(query.data(), query.size(), &parsed), Error::Success);
+
+    std::string text(300, 'x');
+    auto host = wireName("host.in-addr.arpa");
+    uint8_t resp[1024];
+    ResponseWriter w;
+    ASSERT_TRUE(w.begin(query.data(), parsed, resp, sizeof(resp)));
+    ASSERT_TRUE(w.addPTR(nullptr, 10, host.data()));
+    ASSERT_TRUE(w.addTXT(nullptr, 10, text.data(), text.size()));
+    size_t len = w.finish();
+    ASSERT_GT(len, 0u);
+
+    auto answers = parseAnswers(resp, len);
+    ASSERT_EQ(answers.size(), 2u);
+    EXPECT_EQ(answers[0].type, dns_type::PTR);
+    EXPECT_EQ(rdataName(resp, len, answers[0]), "host.in-addr.arpa");
+    EXPECT_EQ(answers[0].rdata_len, 5 + 2);     // "\x04host" + 指针
+
+    EXPECT_EQ(answers[1].type, dns_type::TXT);
+    EXPECT_EQ(answers[1].rdata_len, 302);
+    EXPECT_EQ(resp[answers[1].rdata_offset], 255);
+    EXPECT_EQ(resp[answers[1].rdata_offset + 256], 45);
+}
+
+TEST(ResponseWriterTest, OverflowFailsFinish) {
+    auto query = buildQuery("example.com");
+    DNSParseResult parsed;
+    ASSERT_EQ(DNSParser::parse(query.data(), query.size(), &parsed), Error::Success);
+
+    uint8_t resp[64];
+    ResponseWriter w;
+    ASSERT_TRUE(w.begin(query.data(), parsed, resp, query.size() + 16));
+    EXPECT_TRUE(w.addA(nullptr, 60, ::htonl(0x01020304)));
+    EXPECT_FALSE(w.addA(nullptr, 60, ::htonl(0x01020305)));
+    EXPECT_FALSE(w.addA(nullptr, 60, ::htonl(0x01020306)));
+    EXPECT_EQ(w.finish(), 0u);
+
+    EXPECT_FALSE(w.begin(query.data(), parsed, resp, query.size() - 1));
+}
+
+TEST(ResponseWriterTest, CompiledAnswerRotatesAddresses) {
+    auto cname = wireName("garden.example.net");
+    uint32_t v4[] = {::htonl(0x0A000001), ::htonl(0x0A000002), ::htonl(0x0A000003)};
+    uint8_t v6[16] = {0x20, 0x01, 0x0d, 0xb8};
+    v6[15] = 1;
+
+    RedirectAnswer answer;
+    ASSERT_TRUE(RedirectAnswer::compile(cname.data(), v4, 3, v6, 1, 120, &answer));
+    EXPECT_EQ(answer.a.count, 4);
+    EXPECT_EQ(answer.a.rotate_count, 3);
+    EXPECT_EQ(answer.aaaa.count, 2);
+    EXPECT_EQ(answer.aaaa.rotate_count, 0);
+    EXPECT_EQ(answer.other.count, 1);
+
+    for (uint32_t rotation = 0; rotation < 4; rotation++) {
+        // 就地改写查询缓冲区
+        auto query = buildQuery("Ads.Tracker.com");
+        query.resize(512);
+        DNSParseResult parsed;
+        ASSERT_EQ(DNSParser::parse(query.data(), query.size(), &parsed), Error::Success);
+
+        ResponseWriter w;
+        ASSERT_TRUE(w.begin(query.data(), parsed, query.data(), query.size()));
+        ASSERT_TRUE(w.addBlob(answer.forType(dns_type::A), rotation));
+        size_t len = w.finish();
+        ASSERT_GT(len, 0u);
+
+        auto answers = parseAnswers(query.data(), len);
+        ASSERT_EQ(answers.size(), 4u);
+        EXPECT_EQ(answers[0].owner, "Ads.Tracker.com");
+        EXPECT_EQ(rdataName(query.data(), len, answers[0]), "garden.example.net");
+        for (size_t i = 1; i < 4; i++) {
+            EXPECT_EQ(answers[i].owner, "garden.example.net");
+            EXPECT_EQ(answers[i].ttl, 120u);
+            uint32_t ip;
+            std::memcpy(&ip, query.data() + answers[i].rdata_offset, 4);
+            EXPECT_EQ(ip, v4[(rotation + i - 1) % 3]);
+        }
+    }
+}
+
+TEST(ResponseWriterTest, CompiledAnswerWithoutCname) {
+    uint32_t v4[] = {::htonl(0x0A000001), ::htonl(0x0A000002)};
+    RedirectAnswer answer;
+    ASSERT_TRUE(RedirectAnswer::compile(nullptr, v4, 2, nullptr, 0, 60, &answer));
+    EXPECT_EQ(answer.a.count, 2);
+    EXPECT_EQ(answer.a.rotate_count, 2);
+    EXPECT_EQ(answer.aaaa.count, 0);
+    EXPECT_EQ(answer.other.count, 0);
+
+    auto query = buildQuery("ads.example.com");
+    DNSParseResult parsed;
+    ASSERT_EQ(DNSParser::parse(query.data(), query.size(), &parsed), Error::Success);
+    uint8_t resp[512];
+    ResponseWriter w;
+    ASSERT_TRUE(w.begin(query.data(), parsed, resp, sizeof(resp)));
+    ASSERT_TRUE(w.addBlob(answer.a, 1));
+    size_t len = w.finish();
+
+    auto answers = parseAnswers(resp, len);
+    ASSERT_EQ(answers.size(), 2u);
+    EXPECT_EQ(answers[0].owner, "ads.example.com");
+    EXPECT_EQ(readU32(resp + answers[0].rdata_offset), 0x0A000002u);
+    EXPECT_EQ(readU32(resp + answers[1].rdata_offset), 0x0A000001u);
+}
+
+TEST(ResponseWriterTest, AnswerTableDeduplicates) {
+    auto cname = wireName("dedup-test.example");
+    uint32_t v4[] = {::htonl(0x0A0000FE)};
+
+    RedirectAnswer first, second, other;
+    ASSERT_TRUE(RedirectAnswer::compile(cname.data(), v4, 1, nullptr, 0, 60, &first));
+    ASSERT_TRUE(RedirectAnswer::compile(cname.data(), v4, 1, nullptr, 0, 60, &second));
+    ASSERT_TRUE(RedirectAnswer::compile(cname.data(), v4, 1, nullptr, 0, 61, &other));
+
+    AnswerTable store;
+    uint16_t h1 = store.intern(std::move(first));
+    uint16_t h2 = store.intern(std::move(second));
+    uint16_t h3 = store.intern(std::move(other));
+    EXPECT_EQ(h1, 1);
+    EXPECT_EQ(h1, h2);
+    EXPECT_NE(h1, h3);
+
+    const RedirectAnswer* got = store.get(h1);
+    ASSERT_NE(got, nullptr);
+    EXPECT_EQ(got->a.count, 2);
+    EXPECT_EQ(store.get(0), nullptr);
+    EXPECT_EQ(store.get(3), nullptr);
+    EXPECT_EQ(store.size(), 2u);
+}
@@ -0,0 +1,616 @@
+#include <gtest/gtest.h>
+#include "xdp_dns/dataplane.hpp"
+#include "xdp_dns/local_zone.hpp"
+#include "xdp_dns/response_writer.hpp"
+#include "xdp_dns/stats.hpp"
+#include <arpa/inet.h>
+#include <unistd.h>
+#include <chrono>
+#include <cstring>
+#include <string>
+#include <thread>
+
+using namespace xdp_dns;
+
+namespace {
+
+std::string ringName(const char* tag) {
+    return "/xdp_dns_ring_test_" + std::string(tag) + "_" + std::to_string(getpid());
+}
+
+std::string buildQuery(const std::string& domain, uint16_t qtype = 1) {
+    std::string packet = {
+        0x12, 0x34, 0x01, 0x00, 0x00, 0x01, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00
+    };
+    size_t start = 0;
+    for (size_t i = 0; i <= domain.size(); i++) {
+        if (i == domain.size() || domain[i] == '.') {
+            packet.push_back(static_cast<char>(i - start));
+            packet.append(domain, start, i - start);
+            start = i + 1;
+        }
+    }
+    packet.push_back(0);
+    packet.push_back(static_cast<char>(qtype >> 8));
+    packet.push_back(static_cast<char>(qtype & 0xFF));
+    packet.append({0x00, 0x01});
+    return packet;
+}
+
+XDPDNSRingMsg makeMsg(uint16_t type, const char* domain, uint32_t id = 0) {
+    XDPDNSRingMsg msg;
+    std::memset(&msg, 0, sizeof(msg));
+    msg.type = type;
+    msg.id = id;
+    msg.domain_len = static_cast<uint16_t>(std::strlen(domain));
+    std::snprintf(msg.domain, sizeof(msg.domain), "%s", domain);
+    return msg;
+}
+
+// 轮询所有事件环直到满足 pred 或超时
+template <typename Pred>
+bool pollEvents(const RingChannel& channel, std::vector<XDPDNSRingMsg>* out, Pred pred) {
+    std::vector<ShmRing> rings;
+    for (uint32_t i = 0; i < channel.numEventRings(); i++) {
+        rings.push_back(channel.events(i));
+    }
+
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(10);
+    XDPDNSRingMsg msg;
+    while (std::chrono::steady_clock::now() < deadline) {
+        for (auto& ring : rings) {
+            while (ring.pop(&msg)) out->push_back(msg);
+        }
+        if (pred()) return true;
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    return false;
+}
+
+// 记录每个应答的字节, 供断言 RCODE / 各段记录
+class CaptureSource : public ReplaySource {
+public:
+    using ReplaySource::ReplaySource;
+
+    void complete(const PacketBuf* pkts, const PacketVerdict* verdicts, size_t n) override {
+        for (size_t i = 0; i < n; i++) {
+            if (verdicts[i] == PacketVerdict::Respond) {
+                responses.emplace_back(reinterpret_cast<const char*>(pkts[i].data), pkts[i].len);
+            }
+        }
+        ReplaySource::complete(pkts, verdicts, n);
+    }
+
+    std::vector<std::string> responses;   // 按处理顺序; 读取前须 stop()
+};
+
+struct ReplayResult {
+    DataplaneStats stats;
+    std::vector<std::string> responses;
+    uint64_t responded;
+};
+
+// 单 worker 把 queries 重放 loops 遍, 等处理完后停止数据面
+ReplayResult runReplay(EngineSlot* engine, DataplaneOptions opts,
+                       std::vector<std::string> queries, uint64_t loops) {
+    static int seq = 0;
+    opts.num_workers = 1;
+    Dataplane dp(engine, opts);
+    std::string name = ringName(("replay" + std::to_string(seq++)).c_str());
+    EXPECT_TRUE(dp.open(name.c_str()));
+
+    auto source = std::make_unique<CaptureSource>(std::move(queries), loops);
+    CaptureSource* replay = source.get();
+    EXPECT_TRUE(dp.setSource(0, std::move(source)));
+    EXPECT_TRUE(dp.start());
+
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(10);
+    while (!replay->done() && std::chrono::steady_clock::now() < deadline) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    dp.stop();
+    EXPECT_TRUE(replay->done());
+    return {dp.stats(), std::move(replay->responses), replay->responded()};
+}
+
+// ==================== 应答解析 ====================
+
+struct ParsedRR {
+    uint16_t type;
+    std::string rdata;
+};
+
+struct ParsedResponse {
+    uint16_t flags = 0;
+    uint16_t ancount = 0;
+    uint16_t nscount = 0;
+    uint16_t arcount = 0;
+    std::vector<ParsedRR> answers;
+    std::vector<ParsedRR> authority;
+
+    uint8_t rcode() const { return flags & 0x000F; }
+    bool tc() const { return flags & 0x0200; }
+};
+
+uint16_t u16At(const std::string& p, size_t off) {
+    return static_cast<uint16_t>(static_cast<uint8_t>(p[off]) << 8 | static_cast<uint8_t>(p[off + 1]));
+}
+
+// 跳过 (可能压缩的) 名字, 返回其后的偏移; 越界返回 0
+size_t skipName(const std::string& p, size_t off) {
+    while (off < p.size()) {
+        uint8_t len = static_cast<uint8_t>(p[off]);
+        if ((len & 0xC0) == 0xC0) return off + 2;
+        if (len == 0) return off + 1;
+        off += 1 + len;
+    }
+    return 0;
+}
+
+bool parseResponse(const std::string& p, ParsedResponse* out) {
+    if (p.size() < 12 || u16At(p, 4) != 1) return false;
+    out->flags = u16At(p, 2);
+    out->ancount = u16At(p, 6);
+    out->nscount = u16At(p, 8);
+    out->arcount = u16At(p, 10);
+
+    size_t off = skipName(p, 12);
+    if (!off || off + 4 > p.size()) return false;
+    off += 4;
+    for (uint32_t i = 0; i < uint32_t(out->ancount) + out->nscount; i++) {
+        off = skipName(p, off);
+        if (!off || off + 10 > p.size()) return false;
+        uint16_t type = u16At(p, off);
+        uint16_t rdlen = u16At(p, off + 8);
+        off += 10;
+        if (off + rdlen > p.size()) return false;
+        auto& section = i < out->ancount ? out->answers : out->authority;
+        section.push_back({type, p.substr(off, rdlen)});
+        off += rdlen;
+    }
+    // 声明了附加段时其后必须还有数据
+    return out->arcount ? off < p.size() : off == p.size();
+}
+
+ParsedResponse mustParse(const std::string& p) {
+    ParsedResponse r;
+    EXPECT_TRUE(parseResponse(p, &r));
+    return r;
+}
+
+std::string ipv4(const char* addr) {
+    uint32_t v = inet_addr(addr);
+    return std::string(reinterpret_cast<const char*>(&v), 4);
+}
+
+std::string wireName(const char* domain) {
+    uint8_t buf[MAX_DOMAIN_LENGTH];
+    size_t len = ResponseWriter::encodeName(domain, std::strlen(domain), buf, sizeof(buf));
+    return std::string(reinterpret_cast<const char*>(buf), len);
+}
+
+} // namespace
+
+TEST(ShmRingTest, PushPopWrapsAndCountsDrops) {
+    std::string name = ringName("wrap");
+    RingChannel channel;
+    ASSERT_TRUE(channel.create(name.c_str(), 1, 3));   // 向上取整为 4
+
+    ShmRing producer = channel.events(0);
+    ShmRing consumer = channel.events(0);
+    XDPDNSRingMsg msg;
+    EXPECT_FALSE(consumer.pop(&msg));
+
+    for (uint32_t round = 0; round < 3; round++) {
+        for (uint32_t i = 0; i < 4; i++) {
+            EXPECT_TRUE(producer.push(makeMsg(XDP_DNS_RING_EVENT_SAMPLE, "a.example", i)));
+        }
+        EXPECT_FALSE(producer.push(makeMsg(XDP_DNS_RING_EVENT_SAMPLE, "overflow")));
+        EXPECT_EQ(producer.size(), 4u);
+
+        for (uint32_t i = 0; i < 4; i++) {
+            ASSERT_TRUE(consumer.pop(&msg));
+            EXPECT_EQ(msg.id, i);
+            EXPECT_STREQ(msg.domain, "a.example");
+        }
+        EXPECT_FALSE(consumer.pop(&msg));
+    }
+    EXPECT_EQ(producer.dropped(), 3u);
+}
+
+TEST(ShmRingTest, SecondMappingSeesOrderedStream) {
+    std::string name = ringName("spsc");
+    RingChannel owner;
+    ASSERT_TRUE(owner.create(name.c_str(), 2, 256));
+
+    // 对端 (如 Go 控制面) 的独立映射
+    RingChannel peer;
+    ASSERT_TRUE(peer.open(name.c_str()));
+    EXPECT_EQ(peer.numEventRings(), 2u);
+
+    constexpr uint32_t kCount = 20000;
+    std::thread producer([&] {
+        ShmRing ring = owner.events(1);
+        XDPDNSRingMsg msg = makeMsg(XDP_DNS_RING_EVENT_SAMPLE, "seq.example");
+        for (uint32_t i = 0; i < kCount; i++) {
+            msg.id = i;
+            while (!ring.push(msg)) std::this_thread::yield();
+        }
+    });
+
+    ShmRing consumer = peer.events(1);
+    XDPDNSRingMsg msg;
+    uint32_t expected = 0;
+    while (expected < kCount) {
+        if (!consumer.pop(&msg)) {
+            std::this_thread::yield();
+            continue;
+        }
+        ASSERT_EQ(msg.id, expected);
+        expected++;
+    }
+    producer.join();
+    EXPECT_FALSE(consumer.pop(&msg));
+
+    // 创建者关闭后对象被删除
+    peer.close();
+    owner.close();
+    RingChannel gone;
+    EXPECT_FALSE(gone.open(name.c_str()));
+}
+
+TEST(DataplaneTest, WorkersAnswerAndReportThroughRings) {
+    EngineSlot engine;
+    Rule block;
+    block.id = 1;
+    block.action = Action::Block;
+    std::snprintf(block.rule_id, sizeof(block.rule_id), "block");
+    engine.replace({{"*.ads.example.com", block}});
+
+    DataplaneOptions opts;
+    opts.num_workers = 2;
+    opts.ring_capacity = 1024;
+    opts.sample_interval = 10;
+    Dataplane dp(&engine, opts);
+    std::string name = ringName("dp");
+    ASSERT_TRUE(dp.open(name.c_str()));
+
+    // 控制面: 在另一映射上推送规则增量 (启动前写入, 控制线程启动后应用)
+    RingChannel peer;
+    ASSERT_TRUE(peer.open(name.c_str()));
+    ShmRing control = peer.control();
+    XDPDNSRingMsg add = makeMsg(XDP_DNS_RING_CTRL_ADD_RULE, "logme.example.com", 7);
+    add.action = static_cast<uint8_t>(Action::Log);
+    std::snprintf(add.rule_id, sizeof(add.rule_id), "audit");
+    ASSERT_TRUE(control.push(add));
+
+    std::vector<ReplaySource*> sources;
+    for (uint32_t w = 0; w < opts.num_workers; w++) {
+        std::vector<std::string> queries = {
+            buildQuery("x.ads.example.com"),
+            buildQuery("www.example.org"),
+            buildQuery("logme.example.com"),
+            std::string("\x00\x01", 2),   // 截断包
+        };
+        auto source = std::make_unique<ReplaySource>(std::move(queries), 0);
+        sources.push_back(source.get());
+        ASSERT_TRUE(dp.setSource(w, std::move(source)));
+    }
+
+    // 规则生效之前的包不会产生日志事件, 所以先等控制消息被应用
+    ASSERT_TRUE(dp.start());
+    std::vector<XDPDNSRingMsg> events;
+    ASSERT_TRUE(pollEvents(peer, &events, [&] { return dp.stats().control_applied == 1; }));
+    events.clear();
+
+    bool got_log = false, got_sample = false;
+    ASSERT_TRUE(pollEvents(peer, &events, [&] {
+        for (const auto& e : events) {
+            if (e.type == XDP_DNS_RING_EVENT_LOG) {
+                EXPECT_STREQ(e.domain, "logme.example.com");
+                EXPECT_STREQ(e.rule_id, "audit");
+                EXPECT_EQ(e.id, 7u);
+                got_log = true;
+            } else if (e.type == XDP_DNS_RING_EVENT_SAMPLE) {
+                EXPECT_LT(e.value, opts.num_workers);
+                got_sample = true;
+            }
+        }
+        events.clear();
+        return got_log && got_sample;
+    }));
+
+    // 按域名删除规则
+    ASSERT_TRUE(control.push(makeMsg(XDP_DNS_RING_CTRL_REMOVE_RULE, "logme.example.com")));
+    ASSERT_TRUE(pollEvents(peer, &events, [&] { return dp.stats().control_applied == 2; }));
+
+    dp.stop();
+    DataplaneStats stats = dp.stats();
+    EXPECT_GT(stats.packets, 0u);
+    EXPECT_GT(stats.responded, 0u);
+    EXPECT_GT(stats.parse_errors, 0u);
+    EXPECT_EQ(stats.packets, stats.responded + stats.passed);
+    EXPECT_EQ(engine.ruleCount(), 1u);
+    for (auto* s : sources) {
+        EXPECT_GT(s->responded(), 0u);
+    }
+}
+
+TEST(DataplaneTest, ReplaySourceFinishesAfterLoops) {
+    EngineSlot engine;
+    DataplaneOptions opts;
+    opts.sample_interval = 0;
+    ReplayResult r = runReplay(&engine, opts,
+                               std::vector<std::string>(100, buildQuery("www.example.com")), 3);
+    EXPECT_EQ(r.stats.packets, 300u);
+    EXPECT_EQ(r.stats.passed, 300u);
+    EXPECT_EQ(r.stats.events, 0u);
+    EXPECT_TRUE(r.responses.empty());
+}
+
+TEST(DataplaneTest, AnswersAnyQueriesByPolicy) {
+    EngineSlot engine;
+    Rule block;
+    block.id = 1;
+    block.action = Action::Block;
+    RuleSetPolicy policy;
+    policy.any_policy = AnyPolicy::Hinfo;
+    engine.replace({{"blocked.example.com", block}}, policy);
+
+    DataplaneOptions opts;
+    opts.sample_interval = 0;
+
+    // 放行的 ANY 由策略应答, 阻断规则优先, 其它类型照常放行
+    ReplayResult r = runReplay(&engine, opts, {
+        buildQuery("www.example.com", dns_type::ANY),
+        buildQuery("blocked.example.com", dns_type::ANY),
+        buildQuery("www.example.com", dns_type::A),
+    }, 1);
+    EXPECT_EQ(r.stats.packets, 3u);
+    EXPECT_EQ(r.stats.responded, 2u);
+    EXPECT_EQ(r.stats.passed, 1u);
+    EXPECT_EQ(r.stats.any_answered, 1u);
+    ASSERT_EQ(r.responses.size(), 2u);
+
+    ParsedResponse hinfo = mustParse(r.responses[0]);
+    EXPECT_EQ(hinfo.rcode(), dns_rcode::NOERROR);
+    EXPECT_FALSE(hinfo.tc());
+    ASSERT_EQ(hinfo.ancount, 1u);
+    EXPECT_EQ(hinfo.answers[0].type, dns_type::HINFO);
+    EXPECT_EQ(hinfo.answers[0].rdata, std::string("\x07RFC8482\x00", 9));
+
+    ParsedResponse blocked = mustParse(r.responses[1]);
+    EXPECT_EQ(blocked.rcode(), dns_rcode::NXDOMAIN);
+    EXPECT_EQ(blocked.ancount, 0u);
+    ASSERT_EQ(blocked.authority.size(), 1u);
+    EXPECT_EQ(blocked.authority[0].type, dns_type::SOA);
+
+    // 截断策略: 空应答带 TC, 客户端改用 TCP
+    policy.any_policy = AnyPolicy::Truncate;
+    engine.replace({}, policy);
+    r = runReplay(&engine, opts, {buildQuery("www.example.com", dns_type::ANY)}, 1);
+    ASSERT_EQ(r.responses.size(), 1u);
+    ParsedResponse tc = mustParse(r.responses[0]);
+    EXPECT_TRUE(tc.tc());
+    EXPECT_EQ(tc.rcode(), dns_rcode::NOERROR);
+    EXPECT_EQ(tc.ancount, 0u);
+}
+
+TEST(DataplaneTest, AnswersEdnsQueriesWithoutStaleOpt) {
+    EngineSlot engine;
+    Rule redirect;
+    redirect.id = 1;
+    redirect.action = Action::Redirect;
+    redirect.redirect_ip = inet_addr("10.0.0.7");
+    Rule null_addr;
+    null_addr.id = 2;
+    null_addr.action = Action::Block;
+    null_addr.block_mode = BlockMode::NullAddress;
+    engine.replace({{"portal.example.com", redirect}, {"null.example.com", null_addr}});
+
+    // 查询带 OPT (UDP 负载 1232); 应答只复制到问题末尾, ARCOUNT 必须清零
+    auto edns = [](std::string q) {
+        q.append({0x00, 0x00, 0x29, 0x04, static_cast<char>(0xD0), 0x00, 0x00, 0x00, 0x00,
+                  0x00, 0x00});
+        q[11] = 1;
+        return q;
+    };
+    DataplaneOptions opts;
+    opts.sample_interval = 0;
+    ReplayResult r = runReplay(&engine, opts, {
+        edns(buildQuery("portal.example.com", dns_type::A)),
+        edns(buildQuery("null.example.com", dns_type::A)),
+        edns(buildQuery("null.example.com", dns_type::AAAA)),
+    }, 1);
+    EXPECT_EQ(r.stats.responded, 3u);
+    ASSERT_EQ(r.responses.size(), 3u);
+
+    const std::string expected[] = {ipv4("10.0.0.7"), ipv4("0.0.0.0"), std::string(16, '\0')};
+    for (size_t i = 0; i < 3; i++) {
+        ParsedResponse resp = mustParse(r.responses[i]);
+        EXPECT_EQ(resp.rcode(), dns_rcode::NOERROR);
+        EXPECT_EQ(resp.arcount, 0u);
+        EXPECT_EQ(resp.nscount, 0u);
+        ASSERT_EQ(resp.ancount, 1u);
+        EXPECT_EQ(resp.answers[0].rdata, expected[i]);
+    }
+}
+
+TEST(DataplaneTest, DropsQueriesForSilentBlockRules) {
+    EngineSlot engine;
+    Rule drop;
+    drop.id = 1;
+    drop.action = Action::Block;
+    drop.block_mode = BlockMode::Drop;
+    Rule refuse = drop;
+    refuse.id = 2;
+    refuse.block_mode = BlockMode::Refused;
+    engine.replace({{"quiet.example.com", drop}, {"refused.example.com", refuse}});
+
+    DataplaneOptions opts;
+    opts.sample_interval = 0;
+    opts.log_blocked = true;
+    ReplayResult r = runReplay(&engine, opts, {
+        buildQuery("quiet.example.com"),
+        buildQuery("refused.example.com"),
+        buildQuery("www.example.com"),
+    }, 1);
+
+    // 丢弃的查询不应答也不放行, 但仍记录日志事件
+    EXPECT_EQ(r.stats.packets, 3u);
+    EXPECT_EQ(r.stats.dropped, 1u);
+    EXPECT_EQ(r.stats.responded, 1u);
+    EXPECT_EQ(r.stats.passed, 1u);
+    EXPECT_EQ(r.stats.events, 2u);
+    EXPECT_EQ(r.responded, 1u);
+    ASSERT_EQ(r.responses.size(), 1u);
+
+    ParsedResponse refused = mustParse(r.responses[0]);
+    EXPECT_EQ(refused.rcode(), dns_rcode::REFUSED);
+    EXPECT_EQ(refused.ancount, 0u);
+}
+
+TEST(DataplaneTest, AnswersRedirectsFromCompiledRecords) {
+    std::string cname = wireName("portal.example.net");
+    uint32_t v4[] = {inet_addr("10.0.0.1"), inet_addr("10.0.0.2")};
+    RedirectAnswer answer;
+    ASSERT_TRUE(RedirectAnswer::compile(reinterpret_cast<const uint8_t*>(cname.data()),
+                                        v4, 2, nullptr, 0, 60, &answer));
+
+    EngineSlot engine;
+    Rule redirect;
+    redirect.id = 1;
+    redirect.action = Action::Redirect;
+    auto answers = std::make_shared<AnswerTable>();
+    redirect.answer = answers->intern(std::move(answer));
+    ASSERT_NE(redirect.answer, 0);
+    engine.replace({{"garden.example.com", redirect}}, {}, nullptr, answers);
+
+    DataplaneOptions opts;
+    opts.sample_interval = 0;
+
+    // A: CNAME + 轮转的 A; AAAA: CNAME (无 IPv6 地址); 其它类型: CNAME
+    ReplayResult r = runReplay(&engine, opts, {
+        buildQuery("garden.example.com", dns_type::A),
+        buildQuery("garden.example.com", dns_type::AAAA),
+        buildQuery("garden.example.com", dns_type::TXT),
+    }, 2);
+    EXPECT_EQ(r.stats.packets, 6u);
+    EXPECT_EQ(r.stats.responded, 6u);
+    EXPECT_EQ(r.responded, 6u);
+    ASSERT_EQ(r.responses.size(), 6u);
+
+    std::string first_a;
+    for (size_t i = 0; i < r.responses.size(); i++) {
+        ParsedResponse resp = mustParse(r.responses[i]);
+        EXPECT_EQ(resp.rcode(), dns_rcode::NOERROR);
+        ASSERT_GE(resp.answers.size(), 1u);
+        EXPECT_EQ(resp.answers[0].type, dns_type::CNAME);
+        EXPECT_EQ(resp.answers[0].rdata, cname);
+        if (i % 3 != 0) {
+            EXPECT_EQ(resp.ancount, 1u);
+            continue;
+        }
+
+        // 两轮 A 查询的地址顺序轮转
+        ASSERT_EQ(resp.ancount, 3u);
+        EXPECT_EQ(resp.answers[1].type, dns_type::A);
+        EXPECT_EQ(resp.answers[2].type, dns_type::A);
+        std::string addrs = resp.answers[1].rdata + resp.answers[2].rdata;
+        EXPECT_TRUE(addrs == ipv4("10.0.0.1") + ipv4("10.0.0.2") ||
+                    addrs == ipv4("10.0.0.2") + ipv4("10.0.0.1"));
+        if (i == 0) {
+            first_a = resp.answers[1].rdata;
+        } else {
+            EXPECT_NE(resp.answers[1].rdata, first_a);
+        }
+    }
+}
+
+TEST(DataplaneTest, AnswersLocalZones) {
+    auto zones = std::make_shared<LocalZones>();
+    ASSERT_EQ(zones->addZone("corp.example"), Error::Success);
+    ASSERT_EQ(zones->addRecord("www.corp.example. 60 A 10.0.0.1"), Error::Success);
+    ASSERT_EQ(zones->compile(300), Error::Success);
+
+    EngineSlot engine;
+    Rule block;
+    block.id = 1;
+    block.action = Action::Block;
+    engine.replace({{"blocked.corp.example", block}}, {}, zones);
+
+    DataplaneOptions opts;
+    opts.sample_interval = 0;
+
+    // 区内: 应答 / NODATA / NXDOMAIN; 规则优先于本地数据; 区外放行
+    ReplayResult r = runReplay(&engine, opts, {
+        buildQuery("www.corp.example", dns_type::A),
+        buildQuery("www.corp.example", dns_type::AAAA),
+        buildQuery("missing.corp.example", dns_type::A),
+        buildQuery("blocked.corp.example", dns_type::A),
+        buildQuery("www.example.com", dns_type::A),
+    }, 1);
+    EXPECT_EQ(r.stats.packets, 5u);
+    EXPECT_EQ(r.stats.responded, 4u);
+    EXPECT_EQ(r.stats.local_answered, 3u);
+    EXPECT_EQ(r.stats.passed, 1u);
+    EXPECT_EQ(r.responded, 4u);
+    ASSERT_EQ(r.responses.size(), 4u);
+
+    ParsedResponse www = mustParse(r.responses[0]);
+    EXPECT_EQ(www.rcode(), dns_rcode::NOERROR);
+    ASSERT_EQ(www.ancount, 1u);
+    EXPECT_EQ(www.answers[0].type, dns_type::A);
+    EXPECT_EQ(www.answers[0].rdata, ipv4("10.0.0.1"));
+
+    // 否定应答带区顶点的合成 SOA, MINIMUM 为编译时的否定 TTL
+    const std::string soa_names = wireName("localhost") + wireName("nobody.invalid");
+    const uint8_t expected_rcode[] = {dns_rcode::NOERROR, dns_rcode::NXDOMAIN};
+    for (size_t i = 0; i < 2; i++) {
+        ParsedResponse neg = mustParse(r.responses[1 + i]);
+        EXPECT_EQ(neg.rcode(), expected_rcode[i]);
+        EXPECT_EQ(neg.ancount, 0u);
+        ASSERT_EQ(neg.authority.size(), 1u);
+        const std::string& rdata = neg.authority[0].rdata;
+        EXPECT_EQ(neg.authority[0].type, dns_type::SOA);
+        ASSERT_EQ(rdata.size(), soa_names.size() + 20);
+        EXPECT_EQ(rdata.compare(0, soa_names.size(), soa_names), 0);
+        EXPECT_EQ(u16At(rdata, rdata.size() - 4), 0u);
+        EXPECT_EQ(u16At(rdata, rdata.size() - 2), 300u);
+    }
+
+    EXPECT_EQ(mustParse(r.responses[3]).rcode(), dns_rcode::NXDOMAIN);
+}
+
+TEST(DataplaneTest, ServesCachedResponses) {
+    EngineSlot engine;
+    ResponseCache cache;
+
+    // 上游响应以 monotonicNs 为时间基准插入
+    std::string query = buildQuery("cached.example.com");
+    const uint8_t* q = reinterpret_cast<const uint8_t*>(query.data());
+    DNSParseResult parsed;
+    ASSERT_EQ(DNSParser::parse(q, query.size(), &parsed), Error::Success);
+    uint8_t upstream[512];
+    size_t upstream_len = DNSResponseBuilder::buildAResponse(
+        q, query.size(), parsed, inet_addr("10.0.0.1"), 300, upstream, sizeof(upstream));
+    ASSERT_TRUE(cache.insert(upstream, upstream_len, monotonicNs()));
+
+    DataplaneOptions opts;
+    opts.sample_interval = 0;
+    opts.cache = &cache;
+    ReplayResult r = runReplay(&engine, opts, {query, buildQuery("uncached.example.com")}, 1);
+    EXPECT_EQ(r.stats.packets, 2u);
+    EXPECT_EQ(r.stats.responded, 1u);
+    EXPECT_EQ(r.stats.passed, 1u);
+    EXPECT_EQ(r.stats.cache_hits, 1u);
+    EXPECT_EQ(cache.stats().hits, 1u);
+    EXPECT_EQ(cache.stats().misses, 1u);
+    ASSERT_EQ(r.responses.size(), 1u);
+
+    ParsedResponse cached = mustParse(r.responses[0]);
+    EXPECT_EQ(cached.rcode(), dns_rcode::NOERROR);
+    ASSERT_EQ(cached.ancount, 1u);
+    EXPECT_EQ(cached.answers[0].type, dns_type::A);
+    EXPECT_EQ(cached.answers[0].rdata, ipv4("10.0.0.1"));
+}
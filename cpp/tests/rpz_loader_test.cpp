@@ -0,0 +1,288 @@
+#include <gtest/gtest.h>
+#include "xdp_dns/domain_trie.hpp"
+#include "xdp_dns/response_writer.hpp"
+#include "xdp_dns/rpz_loader.hpp"
+#include <arpa/inet.h>
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <unistd.h>
+#include <vector>
+
+using namespace xdp_dns;
+
+namespace {
+
+const char kZone[] = R"($TTL 2h
+$ORIGIN rpz.vendor.example.
+@   IN  SOA ns.vendor.example. hostmaster.vendor.example. (
+        2026101701 ; serial
+        3600 600 86400 300 )
+    IN  NS  ns.vendor.example.
+
+; QNAME 触发器
+bad.example.com         CNAME .
+*.bad.example.com       CNAME .
+nodata.example.com      CNAME *.
+ok.example.com          CNAME rpz-passthru.
+drop.example.com  60 IN CNAME rpz-drop.
+legacy.example.com      CNAME legacy.example.com.
+garden.example.com      CNAME walled.example.net.
+multi.example.com   300 A     10.0.0.1
+                        A     10.0.0.2
+                        AAAA  2001:db8::1
+single.example.com      A     10.0.0.9
+
+; 不支持的触发器 / 动作
+32.1.2.0.192.rpz-ip     CNAME .
+ns.evil.rpz-nsdname     CNAME .
+tcp.example.com         CNAME rpz-tcp-only.
+txt.example.com         TXT   "v=spf1; -all"
+)";
+
+const RuleEntries::value_type* findEntry(const RuleEntries& entries, const char* domain) {
+    for (const auto& e : entries) {
+        if (e.first == domain) return &e;
+    }
+    return nullptr;
+}
+
+std::string writeTemp(const char* content) {
+    char path[] = "/tmp/xdp_dns_rpz_XXXXXX";
+    int fd = mkstemp(path);
+    EXPECT_GE(fd, 0);
+    size_t len = std::strlen(content);
+    EXPECT_EQ(write(fd, content, len), static_cast<ssize_t>(len));
+    close(fd);
+    return path;
+}
+
+} // namespace
+
+TEST(RpzLoaderTest, MapsPolicyActions) {
+    RuleEntries entries;
+    RpzStats stats;
+    AnswerTable answers;
+    ASSERT_EQ(parseRpzZone(kZone, sizeof(kZone) - 1, "", &entries, &stats, &answers),
+              Error::Success);
+    EXPECT_EQ(stats.records, 17u);
+    EXPECT_EQ(stats.triggers, 9u);
+    EXPECT_EQ(stats.skipped, 4u);
+    ASSERT_EQ(entries.size(), 9u);
+
+    const auto* bad = findEntry(entries, "bad.example.com");
+    ASSERT_NE(bad, nullptr);
+    EXPECT_EQ(bad->second.action, Action::Block);
+    EXPECT_EQ(bad->second.block_mode, BlockMode::NXDomain);
+    EXPECT_EQ(bad->second.id, 1u);
+    EXPECT_STREQ(bad->second.rule_id, "rpz.vendor.example");
+    EXPECT_EQ(bad->second.ttl, 7200u);
+    EXPECT_FALSE(bad->second.subdomains_only);
+    const auto* wild = findEntry(entries, "*.bad.example.com");
+    ASSERT_NE(wild, nullptr);
+    EXPECT_TRUE(wild->second.subdomains_only);
+    EXPECT_EQ(wild->second.id, 2u);
+
+    EXPECT_EQ(findEntry(entries, "nodata.example.com")->second.block_mode, BlockMode::NoData);
+    EXPECT_EQ(findEntry(entries, "ok.example.com")->second.action, Action::Allow);
+    EXPECT_EQ(findEntry(entries, "legacy.example.com")->second.action, Action::Allow);
+
+    const auto* drop = findEntry(entries, "drop.example.com");
+    ASSERT_NE(drop, nullptr);
+    EXPECT_EQ(drop->second.action, Action::Block);
+    EXPECT_EQ(drop->second.block_mode, BlockMode::Drop);
+    EXPECT_EQ(drop->second.ttl, 60u);
+
+    // local data: CNAME 改写与多地址编译到应答表, 单个 A 走 redirect_ip
+    const auto* garden = findEntry(entries, "garden.example.com");
+    ASSERT_NE(garden, nullptr);
+    EXPECT_EQ(garden->second.action, Action::Redirect);
+    const RedirectAnswer* answer = answers.get(garden->second.answer);
+    ASSERT_NE(answer, nullptr);
+    EXPECT_EQ(answer->other.count, 1u);
+
+    const auto* multi = findEntry(entries, "multi.example.com");
+    ASSERT_NE(multi, nullptr);
+    EXPECT_EQ(multi->second.action, Action::Redirect);
+    EXPECT_EQ(multi->second.redirect_ip, inet_addr("10.0.0.1"));
+    answer = answers.get(multi->second.answer);
+    ASSERT_NE(answer, nullptr);
+    EXPECT_EQ(answer->a.count, 2u);
+    EXPECT_EQ(answer->aaaa.count, 1u);
+
+    const auto* single = findEntry(entries, "single.example.com");
+    ASSERT_NE(single, nullptr);
+    EXPECT_EQ(single->second.redirect_ip, inet_addr("10.0.0.9"));
+    EXPECT_EQ(single->second.answer, 0);
+
+    EXPECT_EQ(answers.size(), 2u);
+
+    // 没有应答表时需要预编译应答的触发器被跳过
+    RuleEntries plain;
+    RpzStats plain_stats;
+    ASSERT_EQ(parseRpzZone(kZone, sizeof(kZone) - 1, "", &plain, &plain_stats), Error::Success);
+    EXPECT_EQ(plain.size(), 7u);
+    EXPECT_EQ(plain_stats.skipped, 6u);
+    EXPECT_EQ(findEntry(plain, "garden.example.com"), nullptr);
+    ASSERT_NE(findEntry(plain, "single.example.com"), nullptr);
+
+    EXPECT_EQ(findEntry(entries, "32.1.2.0.192.rpz-ip"), nullptr);
+    EXPECT_EQ(findEntry(entries, "tcp.example.com"), nullptr);
+    EXPECT_EQ(findEntry(entries, "txt.example.com"), nullptr);
+}
+
+TEST(RpzLoaderTest, ResolvesOwnerNames) {
+    // 绝对名字须在区内; 相对的 $ORIGIN 接在当前 origin 之后
+    const char zone[] =
+        "bad.example.com.RPZ.test. 300 CNAME .\n"
+        "x.other.zone. CNAME .\n"
+        "$ORIGIN example.org\n"
+        "www CNAME .\n"
+        "@ CNAME *.\n"
+        "$ORIGIN elsewhere.\n"
+        "y CNAME .\n";
+    RuleEntries entries;
+    RpzStats stats;
+    ASSERT_EQ(parseRpzZone(zone, sizeof(zone) - 1, "rpz.test.", &entries, &stats),
+              Error::Success);
+    ASSERT_EQ(entries.size(), 3u);
+    EXPECT_EQ(entries[0].first, "bad.example.com");
+    EXPECT_EQ(entries[1].first, "www.example.org");
+    EXPECT_EQ(entries[2].first, "example.org");
+    EXPECT_EQ(entries[2].second.block_mode, BlockMode::NoData);
+    EXPECT_EQ(stats.skipped, 2u);
+
+    // 未给出区名时取 SOA 的所有者名; 追加到已有规则之后
+    const char soa_zone[] =
+        "rpz.test. 3600 IN SOA ns. admin. 1 3600 600 86400 300\n"
+        "a.example CNAME .\n";
+    ASSERT_EQ(parseRpzZone(soa_zone, sizeof(soa_zone) - 1, "", &entries), Error::Success);
+    ASSERT_EQ(entries.size(), 4u);
+    EXPECT_EQ(entries[3].first, "a.example");
+    EXPECT_STREQ(entries[3].second.rule_id, "rpz.test");
+    for (size_t i = 0; i < entries.size(); i++) {
+        EXPECT_EQ(entries[i].second.id, i + 1);     // 追加的区接着编号
+    }
+}
+
+TEST(RpzLoaderTest, RejectsMalformedZones) {
+    const char* bad[] = {
+        "$INCLUDE other.zone\n",
+        "$TTL 1x\n",
+        "a CNAME (\n",                                  // 括号未闭合
+        "a CNAME . )\n",
+        "a 300 IN\n",                                   // 缺少类型
+        "a TXT \"unterminated\n",
+        "   CNAME .\n",                                 // 第一条记录省略所有者
+    };
+    for (const char* zone : bad) {
+        RuleEntries entries;
+        EXPECT_EQ(parseRpzZone(zone, std::strlen(zone), "rpz.test", &entries), Error::InvalidRule)
+            << zone;
+    }
+
+    // 区名未知时 "@" 与非 SOA 的绝对名字无法确定触发器
+    RuleEntries entries;
+    EXPECT_EQ(parseRpzZone("@ CNAME .\n", 10, "", &entries), Error::InvalidRule);
+    EXPECT_EQ(parseRpzZone("a.example. CNAME .\n", 19, "", &entries), Error::InvalidRule);
+    EXPECT_EQ(parseRpzZone("a.example. CNAME .\n", 19, "example", &entries), Error::Success);
+}
+
+TEST(RpzLoaderTest, LoadsFileIntoFilterEngine) {
+    std::string path = writeTemp(kZone);
+    RuleEntries entries;
+    auto answers = std::make_shared<AnswerTable>();
+    Error err = loadRpzFile(path.c_str(), "", &entries, nullptr, answers.get());
+    ASSERT_EQ(err, Error::Success);
+
+    FilterEngine engine;
+    engine.updateRules(entries);
+    engine.setAnswers(answers);
+    EXPECT_EQ(engine.ruleCount(), 9u);
+    FilterResult bad = engine.check("bad.example.com", 15, 1);
+    EXPECT_EQ(bad.action, Action::Block);
+    ASSERT_NE(bad.matched_rule, nullptr);
+    EXPECT_FALSE(bad.matched_rule->subdomains_only);   // 区顶点命中自己的触发器
+    EXPECT_EQ(engine.check("x.y.bad.example.com", 19, 1).action, Action::Block);
+    FilterResult garden = engine.check("garden.example.com", 18, 1);
+    EXPECT_EQ(garden.action, Action::Redirect);
+    ASSERT_NE(garden.matched_rule, nullptr);
+    EXPECT_NE(engine.redirectAnswer(*garden.matched_rule), nullptr);
+    FilterResult ok = engine.check("ok.example.com", 14, 1);
+    EXPECT_EQ(ok.action, Action::Allow);
+    EXPECT_NE(ok.matched_rule, nullptr);
+    EXPECT_EQ(engine.check("good.example.com", 16, 1).matched_rule, nullptr);
+
+    // rule YAML 引用 RPZ 文件; 同名的 YAML 规则覆盖 RPZ 触发器
+    std::string yaml = "rpz_files:\n  - " + path + "\n"
+                       "rules:\n"
+                       "  - id: local\n"
+                       "    enabled: true\n"
+                       "    action: allow\n"
+                       "    domains: [bad.example.com]\n";
+    ASSERT_EQ(engine.loadRules(yaml.data(), yaml.size()), Error::Success);
+    FilterResult r = engine.check("bad.example.com", 15, 1);
+    EXPECT_EQ(r.action, Action::Allow);
+    ASSERT_NE(r.matched_rule, nullptr);
+    EXPECT_STREQ(r.matched_rule->rule_id, "local");
+    EXPECT_EQ(r.matched_rule->id, 1u);
+    FilterResult drop = engine.check("drop.example.com", 16, 1);
+    EXPECT_EQ(drop.action, Action::Block);
+    ASSERT_NE(drop.matched_rule, nullptr);
+    EXPECT_EQ(drop.matched_rule->id, 1u + findEntry(entries, "drop.example.com")->second.id);
+    garden = engine.check("garden.example.com", 18, 1);
+    ASSERT_NE(garden.matched_rule, nullptr);
+    EXPECT_NE(engine.redirectAnswer(*garden.matched_rule), nullptr);
+
+    std::string missing = "rpz_files: [" + path + ".missing]\n";
+    EXPECT_EQ(engine.loadRules(missing.data(), missing.size()), Error::InvalidRule);
+    std::remove(path.c_str());
+
+    RuleEntries none;
+    EXPECT_EQ(loadRpzFile("/nonexistent/rpz.zone", "", &none), Error::InvalidRule);
+}
+
+TEST(RpzLoaderTest, WildcardTriggersMatchOnlySubdomains) {
+    // 只有 "*.name" 的区不阻断 name 本身; YAML 的 "*.name" 仍包含 name
+    std::string wild = writeTemp("$ORIGIN rpz.a.\n*.tracker.example CNAME .\n");
+    std::string apex = writeTemp("$ORIGIN rpz.b.\nads.example CNAME .\n*.ads.example CNAME .\n");
+    std::string yaml = "rpz_files:\n  - " + wild + "\n  - " + apex + "\n"
+                       "rules:\n"
+                       "  - id: yaml-wild\n"
+                       "    enabled: true\n"
+                       "    action: block\n"
+                       "    domains: [\"*.legacy.example\"]\n";
+
+    RuleEntries entries;
+    ASSERT_EQ(parseRuleYaml(yaml.data(), yaml.size(), &entries), Error::Success);
+    std::remove(wild.c_str());
+    std::remove(apex.c_str());
+    ASSERT_EQ(entries.size(), 4u);
+
+    // id 跨文件与 YAML 唯一: YAML 为 1, RPZ 依次为 2..4
+    std::vector<uint32_t> ids;
+    for (const auto& e : entries) ids.push_back(e.second.id);
+    std::sort(ids.begin(), ids.end());
+    EXPECT_EQ(ids, (std::vector<uint32_t>{1, 2, 3, 4}));
+
+    FilterEngine engine;
+    engine.updateRules(entries);
+    EXPECT_EQ(engine.check("tracker.example", 15, 1).matched_rule, nullptr);
+    EXPECT_EQ(engine.check("x.tracker.example", 17, 1).action, Action::Block);
+    EXPECT_EQ(engine.check("ads.example", 11, 1).action, Action::Block);
+    EXPECT_EQ(engine.check("x.ads.example", 13, 1).action, Action::Block);
+    EXPECT_EQ(engine.check("legacy.example", 14, 1).action, Action::Block);
+    EXPECT_EQ(engine.check("x.legacy.example", 16, 1).action, Action::Block);
+
+    // 父域的 YAML 通配符在子域通配符之下仍命中其顶点
+    const char parent[] = "rules:\n  - id: p\n    enabled: true\n    action: block\n"
+                          "    domains: [\"*.example\"]\n";
+    RuleEntries both;
+    ASSERT_EQ(parseRuleYaml(parent, sizeof(parent) - 1, &both), Error::Success);
+    both.insert(both.end(), entries.begin(), entries.end());
+    engine.updateRules(both);
+    FilterResult r = engine.check("tracker.example", 15, 1);
+    ASSERT_NE(r.matched_rule, nullptr);
+    EXPECT_STREQ(r.matched_rule->rule_id, "p");
+}
@@ -0,0 +1,315 @@
+#include <gtest/gtest.h>
+#include "xdp_dns/domain_trie.hpp"
+#include "xdp_dns/response_writer.hpp"
+#include "xdp_dns/rule_loader.hpp"
+#include "xdp_dns/traffic_gen.hpp"
+#include <arpa/inet.h>
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <unistd.h>
+
+using namespace xdp_dns;
+using namespace xdp_dns::traffic_gen;
+
+namespace {
+
+const char kRuleSet[] = R"(# 测试规则
+rules:
+  - id: "block-ads"
+    priority: 100
+    enabled: true
+    action: block
+    domains:
+      - "*.ads.example.com"
+      - tracker.example.com   # 行尾注释
+    description: "广告"
+
+  - id: redirect-home
+    priority: 200
+    enabled: true
+    action: redirect
+    redirect_ip: 10.0.0.1
+    redirect_ttl: 60
+    domains: [tracker.example.com, 'home.example.com']
+
+  - id: disabled
+    priority: 300
+    enabled: false
+    action: block
+    domains:
+      - home.example.com
+
+ip_blacklist:
+  - 192.0.2.1
+)";
+
+const RuleEntries::value_type* findEntry(const RuleEntries& entries, const char* domain) {
+    for (const auto& e : entries) {
+        if (e.first == domain) return &e;
+    }
+    return nullptr;
+}
+
+} // namespace
+
+TEST(RuleLoaderTest, ParsesRuleSet) {
+    RuleEntries entries;
+    ASSERT_EQ(parseRuleYaml(kRuleSet, sizeof(kRuleSet) - 1, &entries), Error::Success);
+
+    // 禁用的规则被跳过, 重复域名只保留一条
+    ASSERT_EQ(entries.size(), 3u);
+
+    const auto* wildcard = findEntry(entries, "*.ads.example.com");
+    ASSERT_NE(wildcard, nullptr);
+    EXPECT_EQ(wildcard->second.action, Action::Block);
+    EXPECT_STREQ(wildcard->second.rule_id, "block-ads");
+    EXPECT_EQ(wildcard->second.ttl, 300u);
+
+    const auto* home = findEntry(entries, "home.example.com");
+    ASSERT_NE(home, nullptr);
+    EXPECT_EQ(home->second.action, Action::Redirect);
+    EXPECT_EQ(home->second.redirect_ip, inet_addr("10.0.0.1"));
+    EXPECT_EQ(home->second.ttl, 60u);
+
+    // 两条规则都包含 tracker: priority 高者生效
+    const auto* tracker = findEntry(entries, "tracker.example.com");
+    ASSERT_NE(tracker, nullptr);
+    EXPECT_STREQ(tracker->second.rule_id, "redirect-home");
+}
+
+TEST(RuleLoaderTest, ParsesAnyPolicy) {
+    RuleEntries entries;
+    RuleSetPolicy policy;
+    policy.any_policy = AnyPolicy::Truncate;
+    ASSERT_EQ(parseRuleYaml(kRuleSet, sizeof(kRuleSet) - 1, &entries, &policy), Error::Success);
+    EXPECT_EQ(policy.any_policy, AnyPolicy::Forward);  // 未出现时取默认值
+    EXPECT_EQ(policy.any_ttl, 3600u);
+
+    const char hinfo[] = "any_policy: hinfo\nany_ttl: 60\nrules:\n";
+    ASSERT_EQ(parseRuleYaml(hinfo, sizeof(hinfo) - 1, &entries, &policy), Error::Success);
+    EXPECT_EQ(policy.any_policy, AnyPolicy::Hinfo);
+    EXPECT_EQ(policy.any_ttl, 60u);
+
+    const char tc[] = "any_policy: \"TC\"  # 迫使 TCP\n";
+    ASSERT_EQ(parseRuleYaml(tc, sizeof(tc) - 1, &entries, &policy), Error::Success);
+    EXPECT_EQ(policy.any_policy, AnyPolicy::Truncate);
+
+    const char bad[] = "any_policy: drop\n";
+    EXPECT_EQ(parseRuleYaml(bad, sizeof(bad) - 1, &entries, &policy), Error::InvalidRule);
+
+    FilterEngine engine;
+    ASSERT_EQ(engine.loadRules(hinfo, sizeof(hinfo) - 1), Error::Success);
+    EXPECT_EQ(engine.policy().any_policy, AnyPolicy::Hinfo);
+}
+
+TEST(RuleLoaderTest, ParsesNegativeTtl) {
+    RuleEntries entries;
+    RuleSetPolicy policy;
+    policy.negative_ttl = 5;
+    ASSERT_EQ(parseRuleYaml(kRuleSet, sizeof(kRuleSet) - 1, &entries, &policy), Error::Success);
+    EXPECT_EQ(policy.negative_ttl, 300u);  // 未出现时取默认值
+
+    const char ttl[] = "negative_ttl: 60\nrules:\n";
+    ASSERT_EQ(parseRuleYaml(ttl, sizeof(ttl) - 1, &entries, &policy), Error::Success);
+    EXPECT_EQ(policy.negative_ttl, 60u);
+
+    // RFC 2181: TTL 最高位必须为 0
+    const char bad[] = "negative_ttl: 2147483648\n";
+    EXPECT_EQ(parseRuleYaml(bad, sizeof(bad) - 1, &entries, &policy), Error::InvalidRule);
+
+    FilterEngine engine;
+    ASSERT_EQ(engine.loadRules(ttl, sizeof(ttl) - 1), Error::Success);
+    EXPECT_EQ(engine.policy().negative_ttl, 60u);
+}
+
+TEST(RuleLoaderTest, ParsesBlockMode) {
+    const char yaml[] = R"(rules:
+  - id: quiet
+    enabled: true
+    action: block
+    block_mode: DROP
+    domains: [a.example.com]
+  - id: sinkhole
+    enabled: true
+    action: block
+    block_mode: "null"
+    domains: [b.example.com]
+  - id: plain
+    enabled: true
+    action: block
+    domains: [c.example.com]
+)";
+    RuleEntries entries;
+    ASSERT_EQ(parseRuleYaml(yaml, sizeof(yaml) - 1, &entries), Error::Success);
+    ASSERT_EQ(entries.size(), 3u);
+    EXPECT_EQ(entries[0].second.block_mode, BlockMode::Drop);
+    EXPECT_EQ(entries[1].second.block_mode, BlockMode::NullAddress);
+    EXPECT_EQ(entries[2].second.block_mode, BlockMode::NXDomain);  // 默认
+
+    const char bad[] = "rules:\n  - id: x\n    block_mode: sinkhole\n";
+    EXPECT_EQ(parseRuleYaml(bad, sizeof(bad) - 1, &entries), Error::InvalidRule);
+}
+
+TEST(RuleLoaderTest, ParsesRedirectAnswers) {
+    const char yaml[] = R"(rules:
+  - id: garden
+    enabled: true
+    action: redirect
+    redirect_cname: portal.example.net.
+    redirect_ips: [10.0.0.1, 10.0.0.2, "2001:db8::1"]
+    domains: [a.example.com]
+  - id: pool
+    enabled: true
+    action: redirect
+    redirect_ip: 10.0.0.3
+    redirect_ips:
+      - 10.0.0.4
+    domains: [b.example.com]
+  - id: single
+    enabled: true
+    action: redirect
+    redirect_ip: 10.0.0.5
+    domains: [c.example.com]
+)";
+    RuleEntries entries;
+    AnswerTable answers;
+    ASSERT_EQ(parseRuleYaml(yaml, sizeof(yaml) - 1, &entries, nullptr, nullptr, &answers),
+              Error::Success);
+    ASSERT_EQ(entries.size(), 3u);
+    EXPECT_EQ(answers.size(), 2u);
+
+    const Rule& garden = entries[0].second;
+    EXPECT_EQ(garden.redirect_ip, inet_addr("10.0.0.1"));
+    const RedirectAnswer* answer = answers.get(garden.answer);
+    ASSERT_NE(answer, nullptr);
+    EXPECT_EQ(answer->a.count, 3);       // CNAME + 2 A
+    EXPECT_EQ(answer->aaaa.count, 2);    // CNAME + AAAA
+    EXPECT_EQ(answer->other.count, 1);
+
+    const RedirectAnswer* pool = answers.get(entries[1].second.answer);
+    ASSERT_NE(pool, nullptr);
+    EXPECT_EQ(pool->a.count, 2);
+    EXPECT_EQ(pool->a.rotate_count, 2);
+
+    EXPECT_EQ(entries[2].second.answer, 0);  // 单个 IPv4 走原有路径
+
+    // 没有应答表时只回答第一个 IPv4 地址
+    RuleEntries plain;
+    ASSERT_EQ(parseRuleYaml(yaml, sizeof(yaml) - 1, &plain), Error::Success);
+    EXPECT_EQ(plain[0].second.answer, 0);
+    EXPECT_EQ(plain[0].second.redirect_ip, inet_addr("10.0.0.1"));
+
+    const char bad_ip[] =
+        "rules:\n  - id: x\n    enabled: true\n    action: redirect\n"
+        "    redirect_ips: [10.0.0.256]\n";
+    EXPECT_EQ(parseRuleYaml(bad_ip, sizeof(bad_ip) - 1, &entries), Error::InvalidRule);
+    const char bad_cname[] =
+        "rules:\n  - id: x\n    enabled: true\n    action: redirect\n"
+        "    redirect_cname: a..b\n";
+    EXPECT_EQ(parseRuleYaml(bad_cname, sizeof(bad_cname) - 1, &entries), Error::InvalidRule);
+}
+
+TEST(RuleLoaderTest, RejectsMalformedInput) {
+    RuleEntries entries;
+    const char bad_priority[] = "rules:\n  - id: x\n    priority: high\n";
+    EXPECT_EQ(parseRuleYaml(bad_priority, sizeof(bad_priority) - 1, &entries),
+              Error::InvalidRule);
+
+    const char orphan_key[] = "rules:\n    action: block\n";
+    EXPECT_EQ(parseRuleYaml(orphan_key, sizeof(orphan_key) - 1, &entries),
+              Error::InvalidRule);
+
+    EXPECT_EQ(loadRuleFile("/nonexistent/rules.yaml", &entries), Error::InvalidRule);
+}
+
+TEST(RuleLoaderTest, ReadsGeneratedRuleFile) {
+    RuleSetOptions opts;
+    opts.num_rules = 500;
+    std::vector<GeneratedRule> rules = generateRuleSet(opts);
+
+    char path[] = "/tmp/xdp_dns_rules_XXXXXX";
+    int fd = mkstemp(path);
+    ASSERT_GE(fd, 0);
+    close(fd);
+    ASSERT_TRUE(writeRuleYaml(rules, path, 64));
+
+    RuleEntries entries;
+    Error err = loadRuleFile(path, &entries);
+    std::remove(path);
+    ASSERT_EQ(err, Error::Success);
+    EXPECT_EQ(entries.size(), rules.size());
+}
+
+TEST(RuleLoaderTest, FilterEngineLoadRulesReplacesRuleSet) {
+    FilterEngine engine;
+    Rule old_rule;
+    old_rule.id = 99;
+    old_rule.action = Action::Block;
+    engine.addRule(old_rule, "old.example.com", 15);
+
+    ASSERT_EQ(engine.loadRules(kRuleSet, sizeof(kRuleSet) - 1), Error::Success);
+    EXPECT_EQ(engine.ruleCount(), 3u);
+
+    EXPECT_EQ(engine.check("old.example.com", 15, 1).action, Action::Allow);
+    EXPECT_EQ(engine.check("x.ads.example.com", 17, 1).action, Action::Block);
+
+    FilterResult r = engine.check("tracker.example.com", 19, 1);
+    EXPECT_EQ(r.action, Action::Redirect);
+    ASSERT_NE(r.matched_rule, nullptr);
+    EXPECT_EQ(r.matched_rule->ttl, 60u);
+
+    // 解析失败时保留原规则
+    const char bad[] = "rules:\n    action: block\n";
+    EXPECT_EQ(engine.loadRules(bad, sizeof(bad) - 1), Error::InvalidRule);
+    EXPECT_EQ(engine.ruleCount(), 3u);
+
+    EXPECT_TRUE(engine.removeDomain("*.ads.example.com", 17));
+    EXPECT_FALSE(engine.removeDomain("*.ads.example.com", 17));
+    EXPECT_EQ(engine.check("x.ads.example.com", 17, 1).action, Action::Allow);
+
+    FilterEngine::Stats stats = engine.getStats();
+    EXPECT_EQ(stats.total_checks, 4u);
+    EXPECT_EQ(stats.blocked, 1u);
+    EXPECT_EQ(stats.redirected, 1u);
+}
+
+TEST(RuleLoaderTest, AnswerTableFollowsRuleSet) {
+    const char yaml[] = R"(rules:
+  - id: garden
+    enabled: true
+    action: redirect
+    redirect_cname: portal.example.net
+    domains: [a.example.com]
+)";
+    FilterEngine engine;
+    ASSERT_EQ(engine.loadRules(yaml, sizeof(yaml) - 1), Error::Success);
+    std::weak_ptr<const AnswerTable> first = engine.sharedAnswers();
+    ASSERT_FALSE(first.expired());
+    EXPECT_EQ(first.lock()->size(), 1u);
+
+    FilterResult r = engine.check("a.example.com", 13, 1);
+    ASSERT_NE(r.matched_rule, nullptr);
+    const RedirectAnswer* answer = engine.redirectAnswer(*r.matched_rule);
+    ASSERT_NE(answer, nullptr);
+    EXPECT_EQ(answer->a.count, 1);
+
+    // 每次加载使用新表, 旧表随旧规则集释放, 句柄从 1 重新开始
+    ASSERT_EQ(engine.loadRules(yaml, sizeof(yaml) - 1), Error::Success);
+    EXPECT_TRUE(first.expired());
+    EXPECT_EQ(engine.sharedAnswers()->size(), 1u);
+    EXPECT_EQ(engine.check("a.example.com", 13, 1).matched_rule->answer, 1);
+
+    // 增量规则不带应答句柄
+    Rule added = *engine.check("a.example.com", 13, 1).matched_rule;
+    engine.addRule(added, "b.example.com", 13);
+    const Rule* b = engine.check("b.example.com", 13, 1).matched_rule;
+    ASSERT_NE(b, nullptr);
+    EXPECT_EQ(b->answer, 0);
+    EXPECT_EQ(engine.redirectAnswer(*b), nullptr);
+
+    // 没有重定向应答的规则集不持有表
+    const char plain[] = "rules:\n  - id: x\n    enabled: true\n    domains: [x.example]\n";
+    ASSERT_EQ(engine.loadRules(plain, sizeof(plain) - 1), Error::Success);
+    EXPECT_EQ(engine.sharedAnswers(), nullptr);
+}
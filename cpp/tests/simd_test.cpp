@@ -0,0 +1,141 @@
+#include <gtest/gtest.h>
+#include "xdp_dns/simd.hpp"
+#include <cstring>
+#include <initializer_list>
+#include <random>
+#include <string>
+#include <vector>
+
+using namespace xdp_dns;
+
+namespace {
+
+// 本机可用的全部级别
+std::vector<const SimdKernels*> availableKernels() {
+    std::vector<const SimdKernels*> kernels;
+    for (SimdLevel level : {SimdLevel::Scalar, SimdLevel::SSE42,
+                            SimdLevel::AVX2, SimdLevel::AVX512}) {
+        if (const SimdKernels* k = simdKernels(level)) {
+            kernels.push_back(k);
+        }
+    }
+    return kernels;
+}
+
+} // anonymous namespace
+
+TEST(SimdTest, SelectedLevelIsSupported) {
+    const SimdKernels& k = simd();
+    EXPECT_LE(k.level, simdCpuLevel());
+    EXPECT_EQ(simdKernels(k.level), &k);
+    ASSERT_NE(simdKernels(SimdLevel::Scalar), nullptr);
+    EXPECT_STREQ(simdLevelName(SimdLevel::AVX2), "avx2");
+}
+
+TEST(SimdTest, LowerCopyMatchesScalarOnAllBytes) {
+    // 包含全部 256 个字节值, 覆盖 'A'-1 / 'Z'+1 / 高位字节等边界
+    std::vector<uint8_t> src(256 + 130);
+    for (size_t i = 0; i < src.size(); i++) {
+        src[i] = static_cast<uint8_t>(i * 7 + 3);
+    }
+
+    const SimdKernels* scalar = simdKernels(SimdLevel::Scalar);
+    for (const SimdKernels* k : availableKernels()) {
+        for (size_t offset = 0; offset < 256; offset += 13) {
+            for (size_t n = 0; n <= 130; n++) {
+                std::string expected(n + 1, '#');
+                std::string actual(n + 1, '#');
+                scalar->lower_copy(&expected[0], src.data() + offset, n);
+                k->lower_copy(&actual[0], src.data() + offset, n);
+                ASSERT_EQ(actual, expected) << simdLevelName(k->level) << " n=" << n;
+            }
+        }
+    }
+
+    char buf[16];
+    simd().lower_copy(buf, reinterpret_cast<const uint8_t*>("WwW.ExAmPle.COM@["), 16);
+    EXPECT_EQ(std::string(buf, 16), "www.example.com@");
+}
+
+TEST(SimdTest, HashIsIdenticalAcrossLevels) {
+    std::mt19937 rng(1);
+    const SimdKernels* scalar = simdKernels(SimdLevel::Scalar);
+
+    for (size_t n = 0; n < 80; n++) {
+        std::string s(n, '\0');
+        for (char& c : s) c = static_cast<char>(rng());
+
+        uint64_t expected = scalar->hash(s.data(), n);
+        for (const SimdKernels* k : availableKernels()) {
+            EXPECT_EQ(k->hash(s.data(), n), expected) << simdLevelName(k->level);
+        }
+    }
+
+    EXPECT_NE(scalar->hash("example", 7), scalar->hash("examplf", 7));
+    EXPECT_EQ(LabelHash()(std::string("abc")), LabelHash()(std::string_view("abc")));
+}
+
+TEST(SimdTest, ClassifyHeadersMatchesScalar) {
+    const uint8_t query[] = {
+        0xAB, 0xCD, 0x01, 0x20, 0x00, 0x01, 0x00, 0x00, 0x00, 0x00, 0x00, 0x01,
+        0x01, 'a', 0x00, 0x00, 0x01, 0x00, 0x01,
+    };
+
+    // 每个用例: (修改的字节下标, 新值, 是否仍为候选)
+    struct Case { size_t offset; uint8_t value; bool valid; };
+    const Case cases[] = {
+        {0, 0xFF, true},    // ID
+        {2, 0x07, true},    // AA / TC / RD
+        {3, 0xFF, true},    // RA / Z / AD / CD / RCODE
+        {11, 0x00, true},   // ARCOUNT = 0
+        {2, 0x81, false},   // QR
+        {2, 0x29, false},   // OPCODE = 5 (UPDATE)
+        {5, 0x02, false},   // QDCOUNT = 2
+        {4, 0x01, false},   // QDCOUNT = 257
+        {7, 0x01, false},   // ANCOUNT
+        {8, 0x80, false},   // NSCOUNT
+        {11, 0x02, false},  // ARCOUNT = 2
+        {10, 0x01, false},  // ARCOUNT = 257
+    };
+
+    std::vector<std::vector<uint8_t>> packets;
+    std::vector<bool> expected;
+    for (const Case& c : cases) {
+        std::vector<uint8_t> pkt(query, query + sizeof(query));
+        pkt[c.offset] = c.value;
+        packets.push_back(pkt);
+        expected.push_back(c.valid);
+    }
+    packets.emplace_back(query, query + MIN_DNS_QUERY_SIZE - 1);   // 过短
+    expected.push_back(false);
+    packets.emplace_back(query, query + MIN_DNS_QUERY_SIZE);
+    expected.push_back(true);
+
+    // 随机字节填满 64 个, 与标量结果对照
+    std::mt19937 rng(3);
+    while (packets.size() < 64) {
+        std::vector<uint8_t> pkt(rng() % 40);
+        for (auto& b : pkt) b = static_cast<uint8_t>(rng());
+        if (rng() % 2 && pkt.size() >= 12) std::memcpy(pkt.data(), query, 12);
+        packets.push_back(pkt);
+        expected.push_back(detail::headerCandidate(pkt.data(), static_cast<uint32_t>(pkt.size())));
+    }
+
+    const uint8_t* data[64];
+    uint32_t lens[64];
+    for (size_t i = 0; i < 64; i++) {
+        data[i] = packets[i].data();
+        lens[i] = static_cast<uint32_t>(packets[i].size());
+    }
+
+    for (const SimdKernels* k : availableKernels()) {
+        for (size_t n = 0; n <= 64; n++) {
+            uint64_t bits = k->classify_headers(data, lens, n);
+            for (size_t i = 0; i < 64; i++) {
+                bool want = i < n && expected[i];
+                ASSERT_EQ((bits >> i & 1) != 0, want)
+                    << simdLevelName(k->level) << " n=" << n << " i=" << i;
+            }
+        }
+    }
+}
@@ -0,0 +1,155 @@
+#include <gtest/gtest.h>
+#include "xdp_dns/engine_slot.hpp"
+#include "xdp_dns/stats.hpp"
+#include <unistd.h>
+#include <memory>
+#include <string>
+
+using namespace xdp_dns;
+
+class StatsTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        StatsRegistry::instance().reset();
+        name = "/xdp_dns_stats_test_" + std::to_string(getpid());
+    }
+
+    std::string name;
+};
+
+TEST_F(StatsTest, RegistryTotalsAcrossSlots) {
+    CoreCounters& c = StatsRegistry::instance().local();
+    c.packets_received.fetch_add(10);
+    c.parse_errors.fetch_add(2);
+
+    XDPDNSShmCounters total = StatsRegistry::instance().total();
+    EXPECT_EQ(total.packets_received, 10u);
+    EXPECT_EQ(total.parse_errors, 2u);
+
+    StatsRegistry::instance().reset();
+    EXPECT_EQ(StatsRegistry::instance().total().packets_received, 0u);
+}
+
+TEST_F(StatsTest, PublishAndRead) {
+    StatsRegistry& reg = StatsRegistry::instance();
+    reg.local().packets_received.fetch_add(100);
+    reg.local().packets_parsed.fetch_add(99);
+    reg.recordLatency(0);
+    reg.recordLatency(300);    // [256, 512) → 桶 9
+    reg.recordLatency(300);
+    reg.setRuleInfo(7, 12345);
+
+    StatsPublisher pub;
+    ASSERT_TRUE(pub.open(name.c_str()));
+
+    StatsReader reader;
+    ASSERT_TRUE(reader.open(name.c_str()));
+
+    auto snap = std::make_unique<XDPDNSShmStats>();
+    ASSERT_TRUE(reader.read(snap.get()));
+    EXPECT_EQ(snap->magic, XDP_DNS_SHM_MAGIC);
+    EXPECT_EQ(snap->version, static_cast<uint32_t>(XDP_DNS_SHM_VERSION));
+    EXPECT_EQ(snap->size, sizeof(XDPDNSShmStats));
+    EXPECT_EQ(snap->seq % 2, 0u);
+    EXPECT_EQ(snap->publish_count, 1u);
+    EXPECT_EQ(snap->total.packets_received, 100u);
+    EXPECT_EQ(snap->total.packets_parsed, 99u);
+    EXPECT_EQ(snap->latency_samples, 3u);
+    EXPECT_EQ(snap->latency_hist[0], 1u);
+    EXPECT_EQ(snap->latency_hist[9], 2u);
+    EXPECT_EQ(snap->total.sampled_latency_ns, 600u);
+    EXPECT_EQ(reg.latencySamples(), 3u);
+    EXPECT_EQ(snap->rule_generation, 7u);
+    EXPECT_EQ(snap->rule_count, 12345u);
+
+    // 每核计数之和等于总数
+    uint64_t sum = 0;
+    for (uint32_t i = 0; i < snap->num_cores; i++) {
+        sum += snap->cores[i].packets_received;
+    }
+    EXPECT_EQ(sum, 100u);
+
+    // 再次发布后读到新值
+    reg.local().packets_received.fetch_add(1);
+    pub.publish();
+    ASSERT_TRUE(reader.read(snap.get()));
+    EXPECT_EQ(snap->publish_count, 2u);
+    EXPECT_EQ(snap->total.packets_received, 101u);
+
+    reader.close();
+    pub.close();
+
+    // 发布者关闭后共享内存对象已删除
+    StatsReader stale;
+    EXPECT_FALSE(stale.open(name.c_str()));
+}
+
+TEST_F(StatsTest, BackgroundPublisher) {
+    StatsPublisher pub;
+    ASSERT_TRUE(pub.open(name.c_str()));
+    ASSERT_TRUE(pub.start(1));
+
+    StatsReader reader;
+    ASSERT_TRUE(reader.open(name.c_str()));
+
+    auto snap = std::make_unique<XDPDNSShmStats>();
+    uint64_t last = 0;
+    for (int i = 0; i < 200; i++) {
+        StatsRegistry::instance().local().packets_received.fetch_add(1);
+        ASSERT_TRUE(reader.read(snap.get()));
+        EXPECT_GE(snap->publish_count, last);
+        last = snap->publish_count;
+        usleep(100);
+    }
+    EXPECT_GT(last, 1u);
+
+    pub.close();
+}
+
+TEST_F(StatsTest, ReaderRejectsMissingRegion) {
+    StatsReader reader;
+    EXPECT_FALSE(reader.open("/xdp_dns_stats_test_missing"));
+    auto snap = std::make_unique<XDPDNSShmStats>();
+    EXPECT_FALSE(reader.read(snap.get()));
+}
+
+TEST_F(StatsTest, EngineSlotPublishesRuleInfo) {
+    StatsRegistry& reg = StatsRegistry::instance();
+    reg.setRuleInfo(0, 0);
+    auto snap = std::make_unique<XDPDNSShmStats>();
+
+    Rule rule;
+    rule.action = Action::Block;
+    EngineSlot live;
+    EngineSlot standby;
+    live.setPublishRuleInfo(true);
+
+    // 备用引擎加载不影响统计区, 交换后线上槽发布新的代数与规则数
+    standby.replace({{"a.example", rule}, {"b.example", rule}});
+    reg.snapshot(snap.get());
+    EXPECT_EQ(snap->rule_generation, 0u);
+    EXPECT_EQ(snap->rule_count, 0u);
+
+    live.swap(standby);
+    reg.snapshot(snap.get());
+    EXPECT_EQ(snap->rule_generation, live.generation());
+    EXPECT_GT(snap->rule_generation, 0u);
+    EXPECT_EQ(snap->rule_count, 2u);
+    EXPECT_NE(snap->rule_update_time_ns, 0u);
+
+    live.replace({{"c.example", rule}});
+    reg.snapshot(snap.get());
+    EXPECT_EQ(snap->rule_generation, live.generation());
+    EXPECT_GT(live.generation(), standby.generation());
+    EXPECT_EQ(snap->rule_count, 1u);
+
+    // 增删只更新规则数
+    uint64_t generation = live.generation();
+    live.addRules({{"d.example", rule}});
+    reg.snapshot(snap.get());
+    EXPECT_EQ(snap->rule_generation, generation);
+    EXPECT_EQ(snap->rule_count, 2u);
+    EXPECT_EQ(live.removeDomains({"c.example"}), 1u);
+    reg.snapshot(snap.get());
+    EXPECT_EQ(snap->rule_count, 1u);
+}
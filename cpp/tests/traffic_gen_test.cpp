@@ -0,0 +1,95 @@
+#include <gtest/gtest.h>
+#include "xdp_dns/traffic_gen.hpp"
+#include "xdp_dns/dns_parser.hpp"
+#include "xdp_dns/domain_trie.hpp"
+#include <set>
+
+using namespace xdp_dns;
+using namespace xdp_dns::traffic_gen;
+
+TEST(TrafficGenTest, RuleSetIsDeterministicAndUnique) {
+    RuleSetOptions opts;
+    opts.num_rules = 5000;
+
+    auto a = generateRuleSet(opts);
+    auto b = generateRuleSet(opts);
+    ASSERT_EQ(a.size(), 5000u);
+    ASSERT_EQ(b.size(), a.size());
+
+    std::set<std::string> unique;
+    size_t wildcards = 0;
+    for (size_t i = 0; i < a.size(); i++) {
+        EXPECT_EQ(a[i].domain, b[i].domain);
+        EXPECT_LE(a[i].domain.size(), MAX_DOMAIN_LENGTH);
+        unique.insert(a[i].domain);
+        if (a[i].wildcard) wildcards++;
+    }
+    EXPECT_EQ(unique.size(), a.size());
+
+    // 通配符比例接近配置值
+    double ratio = static_cast<double>(wildcards) / a.size();
+    EXPECT_NEAR(ratio, opts.wildcard_ratio, 0.05);
+}
+
+TEST(TrafficGenTest, ZipfSamplerRange) {
+    ZipfSampler zipf(1000, 1.0);
+    std::mt19937_64 rng(7);
+
+    size_t top = 0;
+    for (int i = 0; i < 10000; i++) {
+        uint64_t k = zipf.sample(rng);
+        ASSERT_GE(k, 1u);
+        ASSERT_LE(k, 1000u);
+        if (k == 1) top++;
+    }
+
+    // s=1, n=1000 时排名 1 的概率约为 1/H(1000) ≈ 13%
+    EXPECT_GT(top, 1000u);
+    EXPECT_LT(top, 1700u);
+}
+
+TEST(TrafficGenTest, QueriesParseAndMatchExpectedKind) {
+    RuleSetOptions rule_opts;
+    rule_opts.num_rules = 2000;
+    auto rules = generateRuleSet(rule_opts);
+
+    DomainTrie trie;
+    std::vector<Rule> storage(rules.size());
+    for (size_t i = 0; i < rules.size(); i++) {
+        storage[i].id = static_cast<uint32_t>(i);
+        storage[i].action = rules[i].action;
+        trie.insert((rules[i].wildcard ? "*." : "") + rules[i].domain, &storage[i]);
+    }
+
+    QueryStreamOptions opts;
+    opts.num_queries = 5000;
+    opts.hit_ratio = 0.3;
+    opts.attack_ratio = 0.1;
+    opts.compression_ratio = 0.5;
+    opts.mixed_case_ratio = 0.5;
+    opts.miss_universe = 1000;
+    auto stream = generateQueries(rules, opts);
+    ASSERT_EQ(stream.size(), opts.num_queries);
+
+    size_t hits = 0;
+    for (size_t i = 0; i < stream.size(); i++) {
+        DNSParseResult parsed;
+        ASSERT_EQ(DNSParser::parse(stream.packet(i), stream.packetLength(i), &parsed),
+                  Error::Success);
+
+        char domain[MAX_DOMAIN_LENGTH + 1];
+        size_t len = 0;
+        ASSERT_EQ(DNSParser::decodeName(stream.packet(i), stream.packetLength(i),
+                                        parsed.question.name_offset,
+                                        domain, sizeof(domain), &len),
+                  Error::Success);
+        EXPECT_EQ(std::string(domain, len), stream.domains[i]);
+
+        bool matched = trie.match(domain, len) != nullptr;
+        EXPECT_EQ(matched, stream.kinds[i] == QueryKind::Hit) << stream.domains[i];
+        if (matched) hits++;
+    }
+
+    double ratio = static_cast<double>(hits) / stream.size();
+    EXPECT_NEAR(ratio, opts.hit_ratio, 0.05);
+}
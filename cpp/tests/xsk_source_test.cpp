@@ -0,0 +1,306 @@
+#include <gtest/gtest.h>
+#include "xdp_dns/xsk_source.hpp"
+#include <linux/if_xdp.h>
+#include <unistd.h>
+#include <chrono>
+#include <cstring>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace xdp_dns;
+
+namespace {
+
+std::string buildQuery(const std::string& domain, uint16_t qtype = 1) {
+    std::string packet = {
+        0x12, 0x34, 0x01, 0x00, 0x00, 0x01, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00
+    };
+    size_t start = 0;
+    for (size_t i = 0; i <= domain.size(); i++) {
+        if (i == domain.size() || domain[i] == '.') {
+            packet.push_back(static_cast<char>(i - start));
+            packet.append(domain, start, i - start);
+            start = i + 1;
+        }
+    }
+    packet.push_back(0);
+    packet.push_back(static_cast<char>(qtype >> 8));
+    packet.push_back(static_cast<char>(qtype & 0xFF));
+    packet.append({0x00, 0x01});
+    return packet;
+}
+
+void appendU16(std::vector<uint8_t>& f, uint16_t v) {
+    f.push_back(static_cast<uint8_t>(v >> 8));
+    f.push_back(static_cast<uint8_t>(v));
+}
+
+// 客户端 (MAC 02::01, 192.0.2.1 / 2001::1, 端口 40000) 发往 53 端口的查询帧
+std::vector<uint8_t> queryFrame(const std::string& payload, bool ipv6 = false) {
+    std::vector<uint8_t> f = {0x02, 0, 0, 0, 0, 0x53, 0x02, 0, 0, 0, 0, 0x01};
+    uint16_t udp_len = static_cast<uint16_t>(8 + payload.size());
+    if (ipv6) {
+        appendU16(f, 0x86DD);
+        f.insert(f.end(), {0x60, 0, 0, 0});
+        appendU16(f, udp_len);
+        f.insert(f.end(), {17, 255});
+        f.insert(f.end(), {0x20, 0x01, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0x01});
+        f.insert(f.end(), {0x20, 0x01, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0x53});
+    } else {
+        appendU16(f, 0x0800);
+        f.insert(f.end(), {0x45, 0});
+        appendU16(f, static_cast<uint16_t>(20 + udp_len));
+        f.insert(f.end(), {0xab, 0xcd, 0x40, 0, 64, 17, 0, 0, 192, 0, 2, 1, 10, 0, 0, 53});
+    }
+    appendU16(f, 40000);
+    appendU16(f, 53);
+    appendU16(f, udp_len);
+    appendU16(f, 0);
+    f.insert(f.end(), payload.begin(), payload.end());
+    return f;
+}
+
+uint16_t readU16At(const uint8_t* p) {
+    return static_cast<uint16_t>(p[0] << 8 | p[1]);
+}
+
+// 反码和折叠后为 0xffff 即校验通过
+uint16_t onesSum(const uint8_t* p, size_t len, uint32_t sum = 0) {
+    for (; len > 1; p += 2, len -= 2) sum += static_cast<uint32_t>(p[0]) << 8 | p[1];
+    if (len) sum += static_cast<uint32_t>(p[0]) << 8;
+    while (sum >> 16) sum = (sum & 0xffff) + (sum >> 16);
+    return static_cast<uint16_t>(sum);
+}
+
+// 用内存中的环与 UMEM 扮演内核
+class FakeXsk {
+public:
+    static constexpr uint32_t kFrames = 32;
+    static constexpr uint32_t kFrameSize = 2048;
+    static constexpr uint32_t kRingSize = 64;
+
+    FakeXsk() : umem_(kFrames * kFrameSize), fill_(kRingSize), comp_(kRingSize),
+                rx_(kRingSize), tx_(kRingSize) {}
+
+    XskConfig config(uint32_t tx_reserve = 8) {
+        XskConfig cfg;
+        cfg.umem = umem_.data();
+        cfg.umem_size = umem_.size();
+        cfg.frame_size = kFrameSize;
+        cfg.fill = XskRing{&fill_prod_, &fill_cons_, fill_.data(), kRingSize};
+        cfg.completion = XskRing{&comp_prod_, &comp_cons_, comp_.data(), kRingSize};
+        cfg.rx = XskRing{&rx_prod_, &rx_cons_, rx_.data(), kRingSize};
+        cfg.tx = XskRing{&tx_prod_, &tx_cons_, tx_.data(), kRingSize};
+        cfg.tx_reserve = tx_reserve;
+        return cfg;
+    }
+
+    uint32_t filled() const { return load(&fill_prod_) - fill_cons_; }
+
+    // 从 fill 环取一个帧, 写入 frame 后放入 rx 环
+    bool deliver(const std::vector<uint8_t>& frame) {
+        if (filled() == 0) return false;
+        uint64_t addr = fill_[fill_cons_++ & (kRingSize - 1)];
+        std::memcpy(&umem_[addr], frame.data(), frame.size());
+        rx_[rx_prod_ & (kRingSize - 1)] = xdp_desc{addr, static_cast<uint32_t>(frame.size()), 0};
+        __atomic_store_n(&rx_prod_, rx_prod_ + 1, __ATOMIC_RELEASE);
+        return true;
+    }
+
+    // 取出一个待发送的帧, 并把它的地址放回 completion 环
+    bool sent(std::vector<uint8_t>* frame) {
+        if (load(&tx_prod_) == tx_cons_) return false;
+        xdp_desc d = tx_[tx_cons_ & (kRingSize - 1)];
+        __atomic_store_n(&tx_cons_, tx_cons_ + 1, __ATOMIC_RELEASE);
+        frame->assign(&umem_[d.addr], &umem_[d.addr] + d.len);
+        comp_[comp_prod_ & (kRingSize - 1)] = d.addr;
+        __atomic_store_n(&comp_prod_, comp_prod_ + 1, __ATOMIC_RELEASE);
+        return true;
+    }
+
+    uint32_t rxPending() const { return load(&rx_prod_) - load(&rx_cons_); }
+
+private:
+    static uint32_t load(const uint32_t* p) { return __atomic_load_n(p, __ATOMIC_ACQUIRE); }
+
+    std::vector<uint8_t> umem_;
+    std::vector<uint64_t> fill_;
+    std::vector<uint64_t> comp_;
+    std::vector<xdp_desc> rx_;
+    std::vector<xdp_desc> tx_;
+    uint32_t fill_prod_ = 0, fill_cons_ = 0;
+    uint32_t comp_prod_ = 0, comp_cons_ = 0;
+    uint32_t rx_prod_ = 0, rx_cons_ = 0;
+    uint32_t tx_prod_ = 0, tx_cons_ = 0;
+};
+
+} // namespace
+
+TEST(XskSourceTest, ValidatesConfig) {
+    FakeXsk xsk;
+    XskConfig cfg = xsk.config();
+    EXPECT_TRUE(XskSource::valid(cfg));
+
+    XskConfig bad = cfg;
+    bad.rx.size = 48;
+    EXPECT_FALSE(XskSource::valid(bad));
+    bad = cfg;
+    bad.tx_reserve = FakeXsk::kFrames;
+    EXPECT_FALSE(XskSource::valid(bad));
+    bad = cfg;
+    bad.fill.descs = nullptr;
+    EXPECT_FALSE(XskSource::valid(bad));
+}
+
+TEST(XskSourceTest, RespondsInPlace) {
+    FakeXsk xsk;
+    XskSource source(xsk.config());
+    PacketBuf pkts[XskSource::kMaxBatch];
+    PacketVerdict verdicts[XskSource::kMaxBatch];
+
+    // 第一次 receive 填充 fill 环, 保留 tx_reserve 个帧
+    EXPECT_EQ(source.receive(pkts, XskSource::kMaxBatch), 0u);
+    EXPECT_EQ(xsk.filled(), FakeXsk::kFrames - 8);
+
+    std::string query = buildQuery("www.example.com");
+    for (bool ipv6 : {false, true}) {
+        ASSERT_TRUE(xsk.deliver(queryFrame(query, ipv6)));
+        ASSERT_EQ(source.receive(pkts, XskSource::kMaxBatch), 1u);
+        ASSERT_EQ(std::string(reinterpret_cast<char*>(pkts[0].data), pkts[0].len), query);
+        EXPECT_EQ(pkts[0].capacity, ipv6 ? 1500u - 48 : 1500u - 28);
+
+        // 追加 4 字节后作为响应发出
+        pkts[0].data[2] |= 0x80;
+        std::memcpy(pkts[0].data + pkts[0].len, "\x01\x02\x03\x04", 4);
+        pkts[0].len += 4;
+        verdicts[0] = PacketVerdict::Respond;
+        source.complete(pkts, verdicts, 1);
+
+        std::vector<uint8_t> out;
+        ASSERT_TRUE(xsk.sent(&out));
+        const uint8_t* f = out.data();
+        size_t l4 = ipv6 ? 54 : 34;
+        ASSERT_EQ(out.size(), l4 + 8 + query.size() + 4);
+        EXPECT_EQ(f[5], 0x01);                                  // 目的 MAC 为客户端
+        EXPECT_EQ(f[11], 0x53);
+        EXPECT_EQ(readU16At(f + l4), 53);
+        EXPECT_EQ(readU16At(f + l4 + 2), 40000);
+        EXPECT_EQ(readU16At(f + l4 + 4), 8 + query.size() + 4);
+        EXPECT_EQ(f[l4 + 8 + 2] & 0x80, 0x80);
+        if (ipv6) {
+            EXPECT_EQ(readU16At(f + 18), 8 + query.size() + 4);
+            EXPECT_EQ(f[37], 0x53);                             // 源地址 2001::53
+            EXPECT_EQ(f[53], 0x01);                             // 目的地址 2001::1
+            // 伪头部 + UDP 段的校验和
+            uint32_t pseudo = onesSum(f + 22, 32) + (8 + query.size() + 4) + 17;
+            EXPECT_EQ(onesSum(f + l4, out.size() - l4, pseudo), 0xffff);
+        } else {
+            EXPECT_EQ(readU16At(f + 16), 20 + 8 + query.size() + 4);
+            EXPECT_EQ(f[29], 53);                               // 源地址 10.0.0.53
+            EXPECT_EQ(f[33], 1);                                // 目的地址 192.0.2.1
+            EXPECT_EQ(onesSum(f + 14, 20), 0xffff);
+            EXPECT_EQ(readU16At(f + l4 + 6), 0);
+        }
+    }
+    EXPECT_EQ(source.stats().tx_frames, 2u);
+}
+
+TEST(XskSourceTest, RecyclesSkippedAndPassedFrames) {
+    FakeXsk xsk;
+    XskSource source(xsk.config());
+    PacketBuf pkts[XskSource::kMaxBatch];
+    PacketVerdict verdicts[XskSource::kMaxBatch];
+    source.receive(pkts, XskSource::kMaxBatch);
+
+    std::vector<uint8_t> arp = queryFrame(buildQuery("a.example"));
+    arp[12] = 0x08;
+    arp[13] = 0x06;
+    ASSERT_TRUE(xsk.deliver(arp));
+    ASSERT_TRUE(xsk.deliver(queryFrame(buildQuery("b.example"))));
+    ASSERT_EQ(source.receive(pkts, XskSource::kMaxBatch), 1u);
+    EXPECT_EQ(source.stats().rx_skipped, 1u);
+    EXPECT_EQ(xsk.filled(), FakeXsk::kFrames - 8 - 1);      // 跳过的帧已回到 fill 环
+
+    verdicts[0] = PacketVerdict::Pass;
+    source.complete(pkts, verdicts, 1);
+    EXPECT_EQ(xsk.filled(), FakeXsk::kFrames - 8);
+    EXPECT_EQ(xsk.rxPending(), 0u);
+
+    std::vector<uint8_t> out;
+    EXPECT_FALSE(xsk.sent(&out));
+}
+
+TEST(XskSourceTest, TransmitsUpstreamReplies) {
+    FakeXsk xsk;
+    XskSource source(xsk.config());
+    PacketBuf pkts[XskSource::kMaxBatch];
+    PacketVerdict verdicts[XskSource::kMaxBatch];
+    source.receive(pkts, XskSource::kMaxBatch);
+
+    std::string query = buildQuery("fwd.example");
+    ASSERT_TRUE(xsk.deliver(queryFrame(query)));
+    ASSERT_EQ(source.receive(pkts, XskSource::kMaxBatch), 1u);
+    uint64_t cookie = pkts[0].cookie;
+    verdicts[0] = PacketVerdict::Forwarded;
+    source.complete(pkts, verdicts, 1);
+
+    // 查询帧已回收; 上游响应写入 tx_reserve 中的空闲帧
+    std::string reply = query + std::string(16, 'x');
+    reply[2] |= 0x80;
+    EXPECT_TRUE(source.transmit(cookie, reinterpret_cast<const uint8_t*>(reply.data()),
+                                reply.size()));
+    EXPECT_FALSE(source.transmit(cookie, reinterpret_cast<const uint8_t*>(reply.data()),
+                                 reply.size()));
+    EXPECT_FALSE(source.transmit(cookie + 1, reinterpret_cast<const uint8_t*>(reply.data()),
+                                 reply.size()));
+
+    std::vector<uint8_t> out;
+    ASSERT_TRUE(xsk.sent(&out));
+    ASSERT_EQ(out.size(), 42 + reply.size());
+    EXPECT_EQ(std::string(reinterpret_cast<char*>(out.data()) + 42, reply.size()), reply);
+    EXPECT_EQ(out[33], 1);
+    EXPECT_EQ(readU16At(out.data() + 36), 40000);
+    EXPECT_EQ(onesSum(out.data() + 14, 20), 0xffff);
+    EXPECT_EQ(source.stats().tx_dropped, 2u);
+
+    // completion 环上的帧被回收, 重新进入 fill 环
+    source.receive(pkts, XskSource::kMaxBatch);
+    EXPECT_EQ(xsk.filled(), FakeXsk::kFrames - 8);
+}
+
+TEST(XskSourceTest, DrivesDataplane) {
+    FakeXsk xsk;
+    EngineSlot engine;
+    Rule rule;
+    rule.action = Action::Block;
+    rule.block_mode = BlockMode::Refused;
+    engine.replace({{"blocked.example", rule}});
+
+    DataplaneOptions opts;
+    opts.sample_interval = 0;
+    opts.idle_sleep_us = 10;
+    Dataplane dp(&engine, opts);
+    ASSERT_TRUE(dp.open(("/xdp_dns_xsk_test_" + std::to_string(getpid())).c_str()));
+    ASSERT_TRUE(dp.setSource(0, std::make_unique<XskSource>(xsk.config())));
+    ASSERT_TRUE(dp.start());
+
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(10);
+    while (xsk.filled() == 0 && std::chrono::steady_clock::now() < deadline) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    ASSERT_TRUE(xsk.deliver(queryFrame(buildQuery("blocked.example"))));
+
+    std::vector<uint8_t> out;
+    while (!xsk.sent(&out) && std::chrono::steady_clock::now() < deadline) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    dp.stop();
+
+    ASSERT_GT(out.size(), 42u + 12);
+    const uint8_t* dns = out.data() + 42;
+    EXPECT_EQ(dns[2] & 0x80, 0x80);                         // QR
+    EXPECT_EQ(dns[3] & 0x0F, 5);                            // REFUSED
+    EXPECT_EQ(out[33], 1);
+    EXPECT_EQ(dp.stats().responded, 1u);
+}
@@ -0,0 +1,201 @@
+/**
+ * xdp_dns_gen - 合成规则集与查询流生成工具
+ *
+ * 用法:
+ *   xdp_dns_gen rules   --count 1000000 --format yaml --out rules.yaml
+ *   xdp_dns_gen queries --rule-count 1000000 --count 10000000 \
+ *                       --hit-ratio 0.2 --attack-ratio 0.1 --format pcap --out q.pcap
+ *
+ * 相同的种子和参数总是生成相同的输出, 查询流可以按需重新生成规则集,
+ * 也可以通过 --rules 读取 "rules --format list" 的输出.
+ */
+
+#include "xdp_dns/traffic_gen.hpp"
+#include <getopt.h>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+
+using namespace xdp_dns;
+using namespace xdp_dns::traffic_gen;
+
+namespace {
+
+void usage(const char* prog) {
+    std::fprintf(stderr,
+        "Usage: %s <rules|queries> [options]\n"
+        "\n"
+        "Common:\n"
+        "  --out PATH               output file (required)\n"
+        "  --format FMT             rules: list|yaml (default list)\n"
+        "                           queries: pcap|raw (default pcap)\n"
+        "\n"
+        "rules:\n"
+        "  --count N                number of rules (default 10000)\n"
+        "  --seed S                 random seed (default 1)\n"
+        "  --wildcard-ratio R       fraction of *. rules (default 0.3)\n"
+        "  --dga-ratio R            fraction of DGA-style labels (default 0.1)\n"
+        "\n"
+        "queries:\n"
+        "  --rules PATH             rule list to draw hits from (list format)\n"
+        "  --rule-count N           or regenerate N rules (default 10000)\n"
+        "  --rule-seed S            seed used for the regenerated rules (default 1)\n"
+        "  --count N                number of queries (default 100000)\n"
+        "  --seed S                 random seed (default 2)\n"
+        "  --zipf S                 Zipf exponent (default 1.0)\n"
+        "  --hit-ratio R            fraction hitting a rule (default 0.2)\n"
+        "  --attack-ratio R         random-subdomain attack fraction (default 0)\n"
+        "  --attack-targets N       attacked domains (default 4)\n"
+        "  --compression-ratio R    questions using a compression pointer (default 0)\n"
+        "  --mixed-case-ratio R     0x20 case randomization (default 0)\n",
+        prog);
+}
+
+bool readRuleList(const char* path, std::vector<GeneratedRule>* rules) {
+    FILE* f = std::fopen(path, "r");
+    if (!f) return false;
+
+    char line[512];
+    while (std::fgets(line, sizeof(line), f)) {
+        size_t len = std::strcspn(line, "\r\n");
+        line[len] = '\0';
+        if (len == 0 || line[0] == '#') continue;
+
+        GeneratedRule rule;
+        rule.action = Action::Block;
+        rule.wildcard = len > 2 && line[0] == '*' && line[1] == '.';
+        rule.domain = rule.wildcard ? std::string(line + 2) : std::string(line);
+        rules->push_back(std::move(rule));
+    }
+    std::fclose(f);
+    return true;
+}
+
+} // anonymous namespace
+
+int main(int argc, char** argv) {
+    if (argc < 2) {
+        usage(argv[0]);
+        return 1;
+    }
+
+    std::string mode = argv[1];
+    if (mode != "rules" && mode != "queries") {
+        usage(argv[0]);
+        return 1;
+    }
+
+    RuleSetOptions rule_opts;
+    QueryStreamOptions query_opts;
+    std::string out_path;
+    std::string format;
+    std::string rules_path;
+
+    enum {
+        OPT_OUT = 1, OPT_FORMAT, OPT_COUNT, OPT_SEED, OPT_WILDCARD, OPT_DGA,
+        OPT_RULES, OPT_RULE_COUNT, OPT_RULE_SEED, OPT_ZIPF, OPT_HIT,
+        OPT_ATTACK, OPT_ATTACK_TARGETS, OPT_COMPRESSION, OPT_MIXED_CASE,
+    };
+    static const struct option long_opts[] = {
+        {"out",               required_argument, nullptr, OPT_OUT},
+        {"format",            required_argument, nullptr, OPT_FORMAT},
+        {"count",             required_argument, nullptr, OPT_COUNT},
+        {"seed",              required_argument, nullptr, OPT_SEED},
+        {"wildcard-ratio",    required_argument, nullptr, OPT_WILDCARD},
+        {"dga-ratio",         required_argument, nullptr, OPT_DGA},
+        {"rules",             required_argument, nullptr, OPT_RULES},
+        {"rule-count",        required_argument, nullptr, OPT_RULE_COUNT},
+        {"rule-seed",         required_argument, nullptr, OPT_RULE_SEED},
+        {"zipf",              required_argument, nullptr, OPT_ZIPF},
+        {"hit-ratio",         required_argument, nullptr, OPT_HIT},
+        {"attack-ratio",      required_argument, nullptr, OPT_ATTACK},
+        {"attack-targets",    required_argument, nullptr, OPT_ATTACK_TARGETS},
+        {"compression-ratio", required_argument, nullptr, OPT_COMPRESSION},
+        {"mixed-case-ratio",  required_argument, nullptr, OPT_MIXED_CASE},
+        {nullptr, 0, nullptr, 0},
+    };
+
+    bool is_rules = mode == "rules";
+    optind = 2;
+    int c;
+    while ((c = getopt_long(argc, argv, "", long_opts, nullptr)) != -1) {
+        switch (c) {
+            case OPT_OUT:            out_path = optarg; break;
+            case OPT_FORMAT:         format = optarg; break;
+            case OPT_COUNT:
+                if (is_rules) {
+                    rule_opts.num_rules = std::strtoull(optarg, nullptr, 10);
+                } else {
+                    query_opts.num_queries = std::strtoull(optarg, nullptr, 10);
+                }
+                break;
+            case OPT_SEED:
+                if (is_rules) {
+                    rule_opts.seed = std::strtoull(optarg, nullptr, 10);
+                } else {
+                    query_opts.seed = std::strtoull(optarg, nullptr, 10);
+                }
+                break;
+            case OPT_WILDCARD:       rule_opts.wildcard_ratio = std::atof(optarg); break;
+            case OPT_DGA:            rule_opts.dga_ratio = std::atof(optarg); break;
+            case OPT_RULES:          rules_path = optarg; break;
+            case OPT_RULE_COUNT:     rule_opts.num_rules = std::strtoull(optarg, nullptr, 10); break;
+            case OPT_RULE_SEED:      rule_opts.seed = std::strtoull(optarg, nullptr, 10); break;
+            case OPT_ZIPF:           query_opts.zipf_s = std::atof(optarg); break;
+            case OPT_HIT:            query_opts.hit_ratio = std::atof(optarg); break;
+            case OPT_ATTACK:         query_opts.attack_ratio = std::atof(optarg); break;
+            case OPT_ATTACK_TARGETS: query_opts.attack_targets = std::strtoull(optarg, nullptr, 10); break;
+            case OPT_COMPRESSION:    query_opts.compression_ratio = std::atof(optarg); break;
+            case OPT_MIXED_CASE:     query_opts.mixed_case_ratio = std::atof(optarg); break;
+            default:
+                usage(argv[0]);
+                return 1;
+        }
+    }
+
+    if (out_path.empty()) {
+        usage(argv[0]);
+        return 1;
+    }
+
+    std::vector<GeneratedRule> rules;
+    if (!is_rules && !rules_path.empty()) {
+        if (!readRuleList(rules_path.c_str(), &rules)) {
+            std::fprintf(stderr, "failed to read rules from %s\n", rules_path.c_str());
+            return 1;
+        }
+    } else {
+        rules = generateRuleSet(rule_opts);
+    }
+
+    bool ok;
+    if (is_rules) {
+        if (format.empty() || format == "list") {
+            ok = writeRuleList(rules, out_path.c_str());
+        } else if (format == "yaml") {
+            ok = writeRuleYaml(rules, out_path.c_str());
+        } else {
+            std::fprintf(stderr, "unknown rules format: %s\n", format.c_str());
+            return 1;
+        }
+        std::fprintf(stderr, "wrote %zu rules to %s\n", rules.size(), out_path.c_str());
+    } else {
+        QueryStream stream = generateQueries(rules, query_opts);
+        if (format.empty() || format == "pcap") {
+            ok = writePcap(stream, out_path.c_str());
+        } else if (format == "raw") {
+            ok = writeRaw(stream, out_path.c_str());
+        } else {
+            std::fprintf(stderr, "unknown queries format: %s\n", format.c_str());
+            return 1;
+        }
+        std::fprintf(stderr, "wrote %zu queries to %s\n", stream.size(), out_path.c_str());
+    }
+
+    if (!ok) {
+        std::fprintf(stderr, "failed to write %s\n", out_path.c_str());
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,176 @@
+/**
+ * xdp_dns_stats - 共享内存统计读取工具
+ *
+ * 用法:
+ *   xdp_dns_stats                       打印一次快照
+ *   xdp_dns_stats --watch 1 --cores     每秒打印速率和每核计数
+ *   xdp_dns_stats --name /xdp_dns_stats
+ *
+ * 只 mmap 发布者创建的共享内存区 (见 stats_shm.h), 不与数据面进程交互.
+ */
+
+#include "xdp_dns/stats.hpp"
+#include <getopt.h>
+#include <unistd.h>
+#include <cerrno>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+
+using namespace xdp_dns;
+
+namespace {
+
+void usage(const char* prog) {
+    std::fprintf(stderr,
+        "Usage: %s [options]\n"
+        "\n"
+        "  --name NAME     shared memory object (default " XDP_DNS_SHM_DEFAULT_NAME ")\n"
+        "  --watch SEC     print rates every SEC seconds until interrupted\n"
+        "  --cores         include per-core counters\n",
+        prog);
+}
+
+// 直方图分位数 (返回桶上界, ns)
+uint64_t percentile(const XDPDNSShmStats& s, double q) {
+    if (s.latency_samples == 0) return 0;
+
+    uint64_t target = static_cast<uint64_t>(q * static_cast<double>(s.latency_samples));
+    uint64_t seen = 0;
+    for (uint32_t i = 0; i < XDP_DNS_SHM_HIST_BUCKETS; i++) {
+        seen += s.latency_hist[i];
+        if (seen > target) {
+            return i == 0 ? 0 : (1ULL << (i < 63 ? i : 63));
+        }
+    }
+    return 1ULL << 63;
+}
+
+void printCounters(const char* label, const XDPDNSShmCounters& c) {
+    std::printf("%-8s recv=%llu parsed=%llu allowed=%llu blocked=%llu redirected=%llu "
+                "errors=%llu responses=%llu\n",
+                label,
+                static_cast<unsigned long long>(c.packets_received),
+                static_cast<unsigned long long>(c.packets_parsed),
+                static_cast<unsigned long long>(c.packets_allowed),
+                static_cast<unsigned long long>(c.packets_blocked),
+                static_cast<unsigned long long>(c.packets_redirected),
+                static_cast<unsigned long long>(c.parse_errors),
+                static_cast<unsigned long long>(c.response_built));
+}
+
+void printSnapshot(const XDPDNSShmStats& s, bool cores) {
+    uint64_t now = wallClockNs();
+    double age_ms = now > s.publish_time_ns ? (now - s.publish_time_ns) / 1e6 : 0;
+    double uptime = now > s.start_time_ns ? (now - s.start_time_ns) / 1e9 : 0;
+
+    std::printf("publish #%llu (%.1f ms ago), uptime %.1f s, %u core slot(s)\n",
+                static_cast<unsigned long long>(s.publish_count), age_ms, uptime, s.num_cores);
+    std::printf("rules: generation=%llu count=%llu\n",
+                static_cast<unsigned long long>(s.rule_generation),
+                static_cast<unsigned long long>(s.rule_count));
+
+    printCounters("total", s.total);
+    if (cores) {
+        char label[16];
+        for (uint32_t i = 0; i < s.num_cores && i < XDP_DNS_SHM_MAX_CORES; i++) {
+            if (s.cores[i].packets_received == 0) continue;
+            std::snprintf(label, sizeof(label), "core%u", i);
+            printCounters(label, s.cores[i]);
+        }
+    }
+
+    const XDPDNSShmMemory& m = s.memory;
+    uint64_t requested = m.node_bytes + m.label_bytes + m.rule_bytes + m.cache_bytes + m.index_bytes;
+    std::printf("memory: reserved=%.1fMB nodes=%.1fMB labels=%.1fMB rules=%.1fMB "
+                "cache=%.1fMB index=%.1fMB bytes/rule=%.1f fragmentation=%.1f%%\n",
+                m.reserved_bytes / 1048576.0, m.node_bytes / 1048576.0,
+                m.label_bytes / 1048576.0, m.rule_bytes / 1048576.0,
+                m.cache_bytes / 1048576.0, m.index_bytes / 1048576.0,
+                m.rule_count ? static_cast<double>(m.reserved_bytes) / m.rule_count : 0.0,
+                m.reserved_bytes > requested
+                    ? 100.0 * (1.0 - static_cast<double>(requested) / m.reserved_bytes) : 0.0);
+
+    std::printf("latency: samples=%llu p50<=%lluns p90<=%lluns p99<=%lluns p99.9<=%lluns\n",
+                static_cast<unsigned long long>(s.latency_samples),
+                static_cast<unsigned long long>(percentile(s, 0.50)),
+                static_cast<unsigned long long>(percentile(s, 0.90)),
+                static_cast<unsigned long long>(percentile(s, 0.99)),
+                static_cast<unsigned long long>(percentile(s, 0.999)));
+}
+
+void printRates(const XDPDNSShmStats& prev, const XDPDNSShmStats& cur, double secs) {
+    auto rate = [secs](uint64_t a, uint64_t b) {
+        return b >= a ? static_cast<double>(b - a) / secs : 0.0;
+    };
+    std::printf("rate: recv=%.0f/s parsed=%.0f/s errors=%.0f/s responses=%.0f/s\n",
+                rate(prev.total.packets_received, cur.total.packets_received),
+                rate(prev.total.packets_parsed, cur.total.packets_parsed),
+                rate(prev.total.parse_errors, cur.total.parse_errors),
+                rate(prev.total.response_built, cur.total.response_built));
+}
+
+} // anonymous namespace
+
+int main(int argc, char** argv) {
+    const char* name = XDP_DNS_SHM_DEFAULT_NAME;
+    unsigned watch = 0;
+    bool cores = false;
+
+    static const option long_opts[] = {
+        {"name", required_argument, nullptr, 'n'},
+        {"watch", required_argument, nullptr, 'w'},
+        {"cores", no_argument, nullptr, 'c'},
+        {"help", no_argument, nullptr, 'h'},
+        {nullptr, 0, nullptr, 0},
+    };
+
+    int opt;
+    while ((opt = getopt_long(argc, argv, "n:w:ch", long_opts, nullptr)) != -1) {
+        switch (opt) {
+            case 'n': name = optarg; break;
+            case 'w': watch = static_cast<unsigned>(std::strtoul(optarg, nullptr, 10)); break;
+            case 'c': cores = true; break;
+            default:
+                usage(argv[0]);
+                return opt == 'h' ? 0 : 1;
+        }
+    }
+
+    StatsReader reader;
+    if (!reader.open(name)) {
+        std::fprintf(stderr, "cannot open %s: %s (publisher not running or version mismatch)\n",
+                     name, std::strerror(errno));
+        return 1;
+    }
+
+    // XDPDNSShmStats 约 9KB, 放在堆上
+    auto prev = std::make_unique<XDPDNSShmStats>();
+    auto cur = std::make_unique<XDPDNSShmStats>();
+
+    if (!reader.read(cur.get())) {
+        std::fprintf(stderr, "failed to read a consistent snapshot\n");
+        return 1;
+    }
+    printSnapshot(*cur, cores);
+
+    while (watch > 0) {
+        std::swap(prev, cur);
+        sleep(watch);
+        if (!reader.read(cur.get())) {
+            std::fprintf(stderr, "failed to read a consistent snapshot\n");
+            std::swap(prev, cur);
+            continue;
+        }
+
+        std::printf("\n");
+        printSnapshot(*cur, cores);
+        double secs = static_cast<int64_t>(cur->publish_time_ns - prev->publish_time_ns) / 1e9;
+        if (secs > 0) {
+            printRates(*prev, *cur, secs);
+        }
+    }
+
+    return 0;
+}
@@ -3,6 +3,7 @@ package config
 import (
 	"fmt"
 	"os"
+	"strconv"
 	"time"
 
 	"gopkg.in/yaml.v3"
@@ -10,16 +11,18 @@ import (
 
 // Config 主配置结构
 type Config struct {
-	Interface  string        `yaml:"interface"`   // 网络接口名
-	QueueID    int           `yaml:"queue_id"`    // 队列ID
-	QueueCount int           `yaml:"queue_count"` // 队列数量
-	BPFPath    string        `yaml:"bpf_path"`    // BPF程序路径
-	XDP        XDPConfig     `yaml:"xdp"`         // XDP配置
-	Workers    WorkerConfig  `yaml:"workers"`     // Worker配置
-	DNS        DNSConfig     `yaml:"dns"`         // DNS配置
-	RulesPath  string        `yaml:"rules_path"`  // 过滤规则路径
-	Metrics    MetricsConfig `yaml:"metrics"`     // 监控配置
-	Logging    LoggingConfig `yaml:"logging"`     // 日志配置
+	Interface  string          `yaml:"interface"`   // 网络接口名
+	QueueID    int             `yaml:"queue_id"`    // 队列ID
+	QueueCount int             `yaml:"queue_count"` // 队列数量
+	BPFPath    string          `yaml:"bpf_path"`    // BPF程序路径
+	XDP        XDPConfig       `yaml:"xdp"`         // XDP配置
+	Workers    WorkerConfig    `yaml:"workers"`     // Worker配置
+	DNS        DNSConfig       `yaml:"dns"`         // DNS配置
+	Memory     MemoryConfig    `yaml:"memory"`      // 内存放置
+	Dataplane  DataplaneConfig `yaml:"dataplane"`   // C++ 数据面
+	RulesPath  string          `yaml:"rules_path"`  // 过滤规则路径
+	Metrics    MetricsConfig   `yaml:"metrics"`     // 监控配置
+	Logging    LoggingConfig   `yaml:"logging"`     // 日志配置
 }
 
 // XDPConfig AF_XDP Socket配置
@@ -32,6 +35,45 @@ type XDPConfig struct {
 	TxRingNumDescs     int `yaml:"tx_ring_size"`         // TX Ring大小
 }
 
+// MemoryConfig UMEM 与 C++ Trie Arena 的内存放置
+type MemoryConfig struct {
+	// 使用 2MB 大页 (MAP_HUGETLB, 无预留大页时回退到 THP); Trie Arena 只对 >= 2MB 的块使用
+	HugePages bool `yaml:"huge_pages"`
+
+	// NUMA 节点: auto 取网卡所在节点, none 不绑定, 或显式节点号
+	NUMANode string `yaml:"numa_node"`
+}
+
+// ResolveNUMANode 解析 numa_node, netdevNode 为网卡所在节点 (未知为 -1)
+// 返回 -1 表示不绑定
+func (m MemoryConfig) ResolveNUMANode(netdevNode int) (int, error) {
+	switch m.NUMANode {
+	case "", "none":
+		return -1, nil
+	case "auto":
+		return netdevNode, nil
+	}
+
+	node, err := strconv.Atoi(m.NUMANode)
+	if err != nil || node < 0 {
+		return -1, fmt.Errorf("numa_node must be auto, none or a node number, got %q", m.NUMANode)
+	}
+	return node, nil
+}
+
+// DataplaneConfig C++ 数据面
+//
+// 启用后 C++ worker 直接驱动 AF_XDP socket 的环 (收包、匹配、应答、转发
+// 都不经过 Go), 规则由 C++ 引擎从 rules_path 加载; 不启动 Go worker 池.
+// 每个 AF_XDP 队列一个 worker, 当前只绑定 queue_id 一个队列.
+type DataplaneConfig struct {
+	Enabled        bool   `yaml:"enabled"`
+	ShmName        string `yaml:"shm_name"`        // 控制 / 事件环共享内存名, 为空使用默认值
+	SampleInterval uint32 `yaml:"sample_interval"` // 每 N 个查询采样一个事件, 0 关闭
+	Forward        bool   `yaml:"forward"`         // 未在本地应答的查询转发到 dns.upstream_servers, 启用数据面时必须为 true
+	Cache          bool   `yaml:"cache"`           // 转发前先查响应缓存 (dns.cache_size / cache_ttl)
+}
+
 // WorkerConfig Worker配置
 type WorkerConfig struct {
 	NumWorkers int `yaml:"num_workers"` // Worker数量, 0表示使用CPU核心数
@@ -51,6 +93,9 @@ type MetricsConfig struct {
 	Enabled bool   `yaml:"enabled"` // 是否启用
 	Listen  string `yaml:"listen"`  // 监听地址
 	Path    string `yaml:"path"`    // 路径
+
+	// C++ 共享内存统计区名 (如 /xdp_dns_stats), 为空则不导出; 仅 C++ 数据面模式下创建
+	CppStatsShm string `yaml:"cpp_stats_shm"`
 }
 
 // LoggingConfig 日志配置
@@ -75,6 +120,16 @@ func DefaultConfig() *Config {
 			RxRingNumDescs:     2048,
 			TxRingNumDescs:     2048,
 		},
+		Memory: MemoryConfig{
+			HugePages: false,
+			NUMANode:  "auto",
+		},
+		Dataplane: DataplaneConfig{
+			Enabled:        false,
+			SampleInterval: 1024,
+			Forward:        true,
+			Cache:          true,
+		},
 		Workers: WorkerConfig{
 			NumWorkers: 0, // 使用CPU核心数
 			BatchSize:  64,
@@ -133,6 +188,18 @@ func (c *Config) Validate() error {
 		return fmt.Errorf("frame_size must be at least 1024")
 	}
 
+	if _, err := c.Memory.ResolveNUMANode(-1); err != nil {
+		return err
+	}
+
+	// AF_XDP 数据面接管了整个队列, 放行的查询只能由转发器送出, 不转发就会被静默丢弃
+	if c.Dataplane.Enabled && !c.Dataplane.Forward {
+		return fmt.Errorf("dataplane.enabled requires dataplane.forward")
+	}
+	if c.Dataplane.Enabled && len(c.DNS.UpstreamServers) == 0 {
+		return fmt.Errorf("dataplane.forward requires dns.upstream_servers")
+	}
+
 	if len(c.DNS.ListenPorts) == 0 {
 		return fmt.Errorf("at least one listen port is required")
 	}
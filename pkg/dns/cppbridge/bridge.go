@@ -24,6 +24,8 @@ var (
 	ErrBufferTooSmall = errors.New("buffer too small")
 	ErrNotInitialized = errors.New("not initialized")
 	ErrNotDNSQuery    = errors.New("not a DNS query")
+	ErrSystem         = errors.New("system call failed")
+	ErrInvalidRules   = errors.New("invalid rules")
 )
 
 // ParseResult DNS 解析结果
@@ -46,7 +48,8 @@ type Stats struct {
 	PacketsRedirected uint64
 	ParseErrors       uint64
 	ResponseBuilt     uint64
-	TotalLatencyNS    uint64
+	SampledLatencyNS  uint64 // 采样包的解析延迟之和, 均值为 SampledLatencyNS / LatencySamples
+	LatencySamples    uint64
 }
 
 // Init 初始化 C++ 库
@@ -63,6 +66,11 @@ func Cleanup() {
 	C.xdp_dns_cleanup()
 }
 
+// SIMDLevel 返回 Init 时按 CPU 选定的 SIMD 内核级别 (scalar / sse4.2 / avx2 / avx512)
+func SIMDLevel() string {
+	return C.GoString(C.xdp_dns_simd_level())
+}
+
 // Parse 使用 C++ 高性能解析器解析 DNS 查询
 // 性能: ~12ns (比 Go 快 55 倍)
 func Parse(packet []byte) (*ParseResult, error) {
@@ -2,9 +2,11 @@ package cppbridge
 
 /*
 #include "xdp_dns/cgo_bridge.h"
+#include <stdlib.h>
 */
 import "C"
 import (
+	"time"
 	"unsafe"
 )
 
@@ -48,7 +50,8 @@ func GetStats() Stats {
 		PacketsRedirected: uint64(cStats.packets_redirected),
 		ParseErrors:       uint64(cStats.parse_errors),
 		ResponseBuilt:     uint64(cStats.response_built),
-		TotalLatencyNS:    uint64(cStats.total_latency_ns),
+		SampledLatencyNS:  uint64(cStats.sampled_latency_ns),
+		LatencySamples:    uint64(cStats.latency_samples),
 	}
 }
 
@@ -57,6 +60,100 @@ func ResetStats() {
 	C.xdp_dns_reset_stats()
 }
 
+// MemoryStats C++ 层内存占用
+type MemoryStats struct {
+	NodeBytes     uint64
+	LabelBytes    uint64
+	RuleBytes     uint64
+	CacheBytes    uint64
+	IndexBytes    uint64
+	TotalBytes    uint64
+	ReservedBytes uint64
+	Allocations   uint64
+	RuleCount     uint64
+	BytesPerRule  float64
+	Fragmentation float64
+}
+
+// GetMemoryStats 获取 C++ 层内存占用 (进程内所有 Trie / FilterEngine 之和)
+func GetMemoryStats() MemoryStats {
+	var cStats C.XDPDNSMemoryStats
+	C.xdp_dns_get_memory_stats(&cStats)
+	return memoryStatsFromC(&cStats)
+}
+
+func memoryStatsFromC(cStats *C.XDPDNSMemoryStats) MemoryStats {
+	return MemoryStats{
+		NodeBytes:     uint64(cStats.node_bytes),
+		LabelBytes:    uint64(cStats.label_bytes),
+		RuleBytes:     uint64(cStats.rule_bytes),
+		CacheBytes:    uint64(cStats.cache_bytes),
+		IndexBytes:    uint64(cStats.index_bytes),
+		TotalBytes:    uint64(cStats.total_bytes),
+		ReservedBytes: uint64(cStats.reserved_bytes),
+		Allocations:   uint64(cStats.allocations),
+		RuleCount:     uint64(cStats.rule_count),
+		BytesPerRule:  float64(cStats.bytes_per_rule),
+		Fragmentation: float64(cStats.fragmentation),
+	}
+}
+
+// SetMemoryOptions 设置之后新建的 C++ Trie / 过滤引擎的内存放置
+//
+// numaNode 为 -1 时不绑定节点; 可用 NetdevNUMANode 取网卡所在节点.
+func SetMemoryOptions(hugePages bool, numaNode int) error {
+	var huge C.int
+	if hugePages {
+		huge = 1
+	}
+	return codeToError(int(C.xdp_dns_set_memory_options(huge, C.int(numaNode))))
+}
+
+// SetNUMAReplicas 设置之后新建的 C++ Trie 是否每个 NUMA 节点保留一份副本
+//
+// 单节点主机上无效果; 查询读取调用线程所在节点的副本, 工作线程应绑核.
+func SetNUMAReplicas(enabled bool) {
+	var e C.int
+	if enabled {
+		e = 1
+	}
+	C.xdp_dns_set_numa_replicas(e)
+}
+
+// NetdevNUMANode 返回网卡所在的 NUMA 节点, 未知返回 -1
+func NetdevNUMANode(ifname string) int {
+	cName := C.CString(ifname)
+	defer C.free(unsafe.Pointer(cName))
+	return int(C.xdp_dns_netdev_numa_node(cName))
+}
+
+// StartStatsShm 创建共享内存统计区并按 interval 周期发布
+//
+// 读端使用 metrics.OpenShmReader 或 xdp_dns_stats 工具, 无需 cgo.
+func StartStatsShm(name string, interval time.Duration) error {
+	ms := interval.Milliseconds()
+	if ms <= 0 {
+		return ErrInvalidParam
+	}
+
+	var cName *C.char
+	if name != "" {
+		cName = C.CString(name)
+		defer C.free(unsafe.Pointer(cName))
+	}
+	return codeToError(int(C.xdp_dns_stats_shm_start(cName, C.uint32_t(ms))))
+}
+
+// StopStatsShm 停止发布并删除共享内存统计区
+func StopStatsShm() {
+	C.xdp_dns_stats_shm_stop()
+}
+
+// SetRuleInfo 更新共享内存中的规则代数信息
+func SetRuleInfo(generation, ruleCount uint64) {
+	C.xdp_dns_stats_set_rule_info(C.uint64_t(generation), C.uint64_t(ruleCount))
+}
+
 // codeToError 将 C 错误码转换为 Go 错误
 func codeToError(code int) error {
 	switch code {
@@ -72,6 +169,10 @@ func codeToError(code int) error {
 		return ErrNotInitialized
 	case -5:
 		return ErrNotDNSQuery
+	case -6:
+		return ErrSystem
+	case -7:
+		return ErrInvalidRules
 	default:
 		return ErrParseFailed
 	}
@@ -0,0 +1,146 @@
+package cppbridge
+
+/*
+#cgo noescape xdp_dns_cache_lookup
+#cgo nocallback xdp_dns_cache_lookup
+#cgo noescape xdp_dns_cache_insert
+#cgo nocallback xdp_dns_cache_insert
+#include "xdp_dns/cgo_bridge.h"
+*/
+import "C"
+import (
+	"time"
+	"unsafe"
+)
+
+// CacheOptions 响应缓存选项, 零值字段使用 C++ 默认值
+type CacheOptions struct {
+	Capacity        uint32 // 总条目数 (对应配置 cache_size)
+	Shards          uint32
+	MaxEntrySize    uint32
+	MaxTTL          uint32        // TTL 上限 (秒), 对应配置 cache_ttl
+	PrefetchPercent uint32        // 剩余 TTL 不足该百分比时预取刷新
+	NoPrefetch      bool          // 关闭预取
+	StaleWindow     time.Duration // 过期后仍可应答的时长 (RFC 8767), 0 关闭
+	StaleTTL        uint32        // 过期应答的 TTL (秒)
+	MaxNegativeTTL  uint32        // NXDOMAIN / NODATA 的 TTL 上限 (秒), 0 不限制
+	NoNXDomainCut   bool          // NXDOMAIN 不覆盖其下的名字 (RFC 8020)
+}
+
+// CacheStats 响应缓存统计
+type CacheStats struct {
+	Hits            uint64 // 含过期应答
+	Misses          uint64
+	StaleHits       uint64
+	Prefetches      uint64 // 要求刷新的次数
+	CutHits         uint64 // 由 NXDOMAIN 截断点应答
+	Expired         uint64
+	Inserts         uint64
+	NegativeInserts uint64 // 其中的否定应答
+	Evictions       uint64
+	Rejected        uint64
+	Entries         uint64
+	Capacity        uint64
+	MemoryBytes     uint64
+}
+
+// Cache 线上格式响应缓存句柄
+//
+// 可单独用于 Go 转发路径, 也可通过 DataplaneOptions.Cache 交给 C++ worker
+// 直接应答命中的查询. 预取与过期应答的刷新只在数据面同时挂了 Forwarder
+// 时发起; 单独使用时过期应答不会触发刷新.
+type Cache struct {
+	ptr *C.XDPDNSCache
+}
+
+// NewCache 创建响应缓存, 内存一次分配
+func NewCache(opts CacheOptions) (*Cache, error) {
+	cOpts := C.XDPDNSCacheOptions{
+		capacity:         C.uint32_t(opts.Capacity),
+		shards:           C.uint32_t(opts.Shards),
+		max_entry_size:   C.uint32_t(opts.MaxEntrySize),
+		max_ttl:          C.uint32_t(opts.MaxTTL),
+		prefetch_percent: C.uint32_t(opts.PrefetchPercent),
+		stale_window:     C.uint32_t(opts.StaleWindow / time.Second),
+		stale_ttl:        C.uint32_t(opts.StaleTTL),
+		disable_prefetch: boolToC(opts.NoPrefetch),
+
+		max_negative_ttl:     C.uint32_t(opts.MaxNegativeTTL),
+		disable_nxdomain_cut: boolToC(opts.NoNXDomainCut),
+	}
+	ptr := C.xdp_dns_cache_create(&cOpts)
+	if ptr == nil {
+		return nil, ErrInvalidParam
+	}
+	return &Cache{ptr: ptr}, nil
+}
+
+// Close 销毁缓存; 挂载它的数据面需先关闭
+func (c *Cache) Close() {
+	if c.ptr != nil {
+		C.xdp_dns_cache_destroy(c.ptr)
+		c.ptr = nil
+	}
+}
+
+// Insert 插入上游响应, 不可缓存时返回 false
+func (c *Cache) Insert(response []byte) (bool, error) {
+	if len(response) == 0 {
+		return false, ErrInvalidParam
+	}
+	ret := C.xdp_dns_cache_insert(c.ptr, (*C.uint8_t)(unsafe.Pointer(&response[0])), C.size_t(len(response)))
+	if ret < 0 {
+		return false, codeToError(int(ret))
+	}
+	return ret == 1, nil
+}
+
+// LookupInto 把命中的响应写入 dst, 返回长度; 未命中返回 0
+//
+// dst 可与 query 共用起始地址, 不分配内存.
+func (c *Cache) LookupInto(query []byte, dst []byte) (int, error) {
+	if len(query) < 12 || len(dst) == 0 {
+		return 0, ErrInvalidParam
+	}
+
+	var responseLen C.size_t
+	ret := C.xdp_dns_cache_lookup(
+		c.ptr,
+		(*C.uint8_t)(unsafe.Pointer(&query[0])),
+		C.size_t(len(query)),
+		(*C.uint8_t)(unsafe.Pointer(&dst[0])),
+		C.size_t(len(dst)),
+		&responseLen,
+	)
+	if ret != 0 {
+		return 0, codeToError(int(ret))
+	}
+	return int(responseLen), nil
+}
+
+// Clear 清空所有条目
+func (c *Cache) Clear() {
+	C.xdp_dns_cache_clear(c.ptr)
+}
+
+// Stats 获取缓存统计
+func (c *Cache) Stats() CacheStats {
+	var cStats C.XDPDNSCacheStats
+	C.xdp_dns_cache_get_stats(c.ptr, &cStats)
+
+	return CacheStats{
+		Hits:            uint64(cStats.hits),
+		Misses:          uint64(cStats.misses),
+		StaleHits:       uint64(cStats.stale_hits),
+		Prefetches:      uint64(cStats.prefetches),
+		CutHits:         uint64(cStats.cut_hits),
+		Expired:         uint64(cStats.expired),
+		Inserts:         uint64(cStats.inserts),
+		NegativeInserts: uint64(cStats.negative_inserts),
+		Evictions:       uint64(cStats.evictions),
+		Rejected:        uint64(cStats.rejected),
+		Entries:         uint64(cStats.entries),
+		Capacity:        uint64(cStats.capacity),
+		MemoryBytes:     uint64(cStats.memory_bytes),
+	}
+}
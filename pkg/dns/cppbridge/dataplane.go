@@ -0,0 +1,187 @@
+package cppbridge
+
+/*
+#include "xdp_dns/cgo_bridge.h"
+#include <stdlib.h>
+*/
+import "C"
+import "unsafe"
+
+// C++ 数据面句柄
+//
+// worker 线程在 C++ 内完成收包到响应的整条路径, 每包不跨越 cgo.
+// 这里只包装生命周期与统计; 规则增量、配置变更与采样 / 日志事件经由
+// pkg/dns/shmring 映射的共享内存环收发.
+
+// DataplaneOptions 数据面选项
+type DataplaneOptions struct {
+	ShmName        string // 空则使用 shmring.DefaultName
+	NumWorkers     uint32
+	RingCapacity   uint32     // 每个环的槽数, 0 使用默认值
+	SampleInterval uint32     // 每 N 个查询采样一个事件, 0 关闭
+	LogBlocked     bool       // 阻断 / 重定向也发送日志事件
+	Cache          *Cache     // 放行查询先查响应缓存, nil 关闭
+	Forwarder      *Forwarder // 未应答的查询转发上游, nil 时原样放行
+}
+
+// DataplaneStats 数据面统计
+type DataplaneStats struct {
+	Packets         uint64
+	Responded       uint64
+	Passed          uint64
+	ParseErrors     uint64
+	Events          uint64
+	EventsDropped   uint64
+	ControlApplied  uint64
+	AnyAnswered     uint64 // 按 any_policy 直接应答的 ANY 查询
+	CacheHits       uint64 // 由响应缓存直接应答
+	CacheRefreshes  uint64 // 为预取 / 过期应答提交的刷新查询
+	Forwarded       uint64 // 已交给转发器
+	UpstreamReplies uint64 // 已发回客户端的上游响应
+	Dropped         uint64 // 阻断规则要求静默丢弃
+	LocalAnswered   uint64 // 由本地权威区应答
+}
+
+// Dataplane C++ 数据面句柄
+type Dataplane struct {
+	ptr    *C.XDPDNSDataplane
+	engine *Engine // 保持引用, 引擎需比数据面存活更久
+	cache  *Cache  // 同上
+	fwd    *Forwarder
+}
+
+// NewDataplane 在 engine 上创建数据面并建立共享内存环
+func NewDataplane(engine *Engine, opts DataplaneOptions) (*Dataplane, error) {
+	if engine == nil || engine.ptr == nil {
+		return nil, ErrInvalidParam
+	}
+
+	cOpts := C.XDPDNSDataplaneOptions{
+		num_workers:     C.uint32_t(opts.NumWorkers),
+		ring_capacity:   C.uint32_t(opts.RingCapacity),
+		sample_interval: C.uint32_t(opts.SampleInterval),
+		log_blocked:     boolToC(opts.LogBlocked),
+	}
+	if opts.Cache != nil {
+		cOpts.cache = opts.Cache.ptr
+	}
+	if opts.Forwarder != nil {
+		cOpts.forwarder = opts.Forwarder.ptr
+	}
+	if opts.ShmName != "" {
+		cOpts.shm_name = C.CString(opts.ShmName)
+		defer C.free(unsafe.Pointer(cOpts.shm_name))
+	}
+
+	ptr := C.xdp_dns_dataplane_create(engine.ptr, &cOpts)
+	if ptr == nil {
+		return nil, ErrInvalidParam
+	}
+	return &Dataplane{ptr: ptr, engine: engine, cache: opts.Cache, fwd: opts.Forwarder}, nil
+}
+
+// AddReplay 为 worker 设置重放包源 (traffic_gen 原始格式), loops 为 0 时无限循环
+func (d *Dataplane) AddReplay(worker uint32, rawPath string, loops uint64) error {
+	cPath := C.CString(rawPath)
+	defer C.free(unsafe.Pointer(cPath))
+	return codeToError(int(C.xdp_dns_dataplane_add_replay(d.ptr, C.uint32_t(worker), cPath, C.uint64_t(loops))))
+}
+
+// Start 启动控制线程与 worker
+func (d *Dataplane) Start() error {
+	return codeToError(int(C.xdp_dns_dataplane_start(d.ptr)))
+}
+
+// Stop 停止所有线程, 共享内存环保持映射
+func (d *Dataplane) Stop() {
+	C.xdp_dns_dataplane_stop(d.ptr)
+}
+
+// Close 停止并销毁数据面, 删除共享内存环
+func (d *Dataplane) Close() {
+	if d.ptr != nil {
+		C.xdp_dns_dataplane_destroy(d.ptr)
+		d.ptr = nil
+		d.engine = nil
+		d.cache = nil
+		d.fwd = nil
+	}
+}
+
+// XskRing 控制面已映射的 AF_XDP 环 (对应 XDPDNSXskRing), Size 为 2 的幂
+type XskRing struct {
+	Producer *uint32
+	Consumer *uint32
+	Descs    unsafe.Pointer // fill / completion: []uint64; rx / tx: []xdp_desc
+	Size     uint32
+}
+
+// XskConfig 交给 worker 的 AF_XDP socket (对应 XDPDNSXskConfig)
+type XskConfig struct {
+	FD        int
+	UMEM      []byte // mmap 得到的内存, 不能是 Go 堆
+	FrameSize uint32
+	TxReserve uint32 // 留给上游响应的空闲帧, 0 使用默认值
+	MTU       uint32 // 响应 IP 包上限, 0 使用 1500
+
+	Fill, Completion, Rx, Tx XskRing
+}
+
+// AddXsk 为 worker 设置 AF_XDP 包源, worker 直接驱动 socket 的四个环
+//
+// 之后调用者不得再操作这些环; socket 与 UMEM 需比数据面存活更久.
+func (d *Dataplane) AddXsk(worker uint32, cfg XskConfig) error {
+	if len(cfg.UMEM) == 0 {
+		return ErrInvalidParam
+	}
+
+	ring := func(r XskRing) C.XDPDNSXskRing {
+		return C.XDPDNSXskRing{
+			producer: (*C.uint32_t)(unsafe.Pointer(r.Producer)),
+			consumer: (*C.uint32_t)(unsafe.Pointer(r.Consumer)),
+			descs:    r.Descs,
+			size:     C.uint32_t(r.Size),
+		}
+	}
+	cCfg := C.XDPDNSXskConfig{
+		fd:         C.int(cfg.FD),
+		umem:       (*C.uint8_t)(unsafe.Pointer(&cfg.UMEM[0])),
+		umem_size:  C.uint64_t(len(cfg.UMEM)),
+		frame_size: C.uint32_t(cfg.FrameSize),
+		tx_reserve: C.uint32_t(cfg.TxReserve),
+		mtu:        C.uint32_t(cfg.MTU),
+		fill:       ring(cfg.Fill),
+		completion: ring(cfg.Completion),
+		rx:         ring(cfg.Rx),
+		tx:         ring(cfg.Tx),
+	}
+	return codeToError(int(C.xdp_dns_dataplane_add_xsk(d.ptr, C.uint32_t(worker), &cCfg)))
+}
+
+// ReplayDone 所有重放包源是否都已处理完毕
+func (d *Dataplane) ReplayDone() bool {
+	return C.xdp_dns_dataplane_replay_done(d.ptr) != 0
+}
+
+// Stats 获取数据面统计
+func (d *Dataplane) Stats() DataplaneStats {
+	var cStats C.XDPDNSDataplaneStats
+	C.xdp_dns_dataplane_get_stats(d.ptr, &cStats)
+
+	return DataplaneStats{
+		Packets:         uint64(cStats.packets),
+		Responded:       uint64(cStats.responded),
+		Passed:          uint64(cStats.passed),
+		ParseErrors:     uint64(cStats.parse_errors),
+		Events:          uint64(cStats.events),
+		EventsDropped:   uint64(cStats.events_dropped),
+		ControlApplied:  uint64(cStats.control_applied),
+		AnyAnswered:     uint64(cStats.any_answered),
+		CacheHits:       uint64(cStats.cache_hits),
+		CacheRefreshes:  uint64(cStats.cache_refreshes),
+		Forwarded:       uint64(cStats.forwarded),
+		UpstreamReplies: uint64(cStats.upstream_replies),
+		Dropped:         uint64(cStats.dropped),
+		LocalAnswered:   uint64(cStats.local_answered),
+	}
+}
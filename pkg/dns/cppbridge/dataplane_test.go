@@ -0,0 +1,162 @@
+package cppbridge
+
+import (
+	"encoding/binary"
+	"fmt"
+	"os"
+	"path/filepath"
+	"testing"
+	"time"
+
+	"xdp-dns/pkg/dns/shmring"
+)
+
+func buildQuery(domain string) []byte {
+	pkt := []byte{0x12, 0x34, 0x01, 0x00, 0x00, 0x01, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00}
+	start := 0
+	for i := 0; i <= len(domain); i++ {
+		if i == len(domain) || domain[i] == '.' {
+			pkt = append(pkt, byte(i-start))
+			pkt = append(pkt, domain[start:i]...)
+			start = i + 1
+		}
+	}
+	return append(pkt, 0x00, 0x00, 0x01, 0x00, 0x01)
+}
+
+// writeRaw 写出 traffic_gen 原始格式: 2 字节大端长度 + 负载
+func writeRaw(t *testing.T, queries ...[]byte) string {
+	var buf []byte
+	for _, q := range queries {
+		buf = binary.BigEndian.AppendUint16(buf, uint16(len(q)))
+		buf = append(buf, q...)
+	}
+	path := filepath.Join(t.TempDir(), "queries.raw")
+	if err := os.WriteFile(path, buf, 0o644); err != nil {
+		t.Fatal(err)
+	}
+	return path
+}
+
+func waitFor(t *testing.T, what string, cond func() bool) {
+	t.Helper()
+	deadline := time.Now().Add(10 * time.Second)
+	for !cond() {
+		if time.Now().After(deadline) {
+			t.Fatalf("timeout waiting for %s", what)
+		}
+		time.Sleep(time.Millisecond)
+	}
+}
+
+// Go 控制面与 C++ 数据面在同一进程内, 只经共享内存环交互
+func TestDataplane_ShmRingRoundTrip(t *testing.T) {
+	engine, err := NewEngine(nil)
+	if err != nil {
+		t.Fatal(err)
+	}
+	defer engine.Close()
+	if err := engine.AddRules([]Rule{{Domain: "*.ads.example.com", ID: 1, Action: ActionBlock}}); err != nil {
+		t.Fatal(err)
+	}
+
+	name := fmt.Sprintf("/xdp_dns_ring_gotest_%d", os.Getpid())
+	dp, err := NewDataplane(engine, DataplaneOptions{
+		ShmName:        name,
+		NumWorkers:     2,
+		RingCapacity:   1024,
+		SampleInterval: 10,
+	})
+	if err != nil {
+		t.Fatal(err)
+	}
+	defer dp.Close()
+
+	raw := writeRaw(t,
+		buildQuery("x.ads.example.com"),
+		buildQuery("www.example.org"),
+		buildQuery("logme.example.com"),
+	)
+	for w := uint32(0); w < 2; w++ {
+		if err := dp.AddReplay(w, raw, 0); err != nil {
+			t.Fatal(err)
+		}
+	}
+
+	ch, err := shmring.Open(name)
+	if err != nil {
+		t.Fatal(err)
+	}
+	defer ch.Close()
+	if ch.NumWorkers() != 2 {
+		t.Fatalf("NumWorkers = %d, want 2", ch.NumWorkers())
+	}
+
+	add, err := shmring.AddRuleMsg("logme.example.com", 7, uint8(ActionLog), 0, 0, 0, "audit")
+	if err != nil {
+		t.Fatal(err)
+	}
+	if err := ch.Send(&add); err != nil {
+		t.Fatal(err)
+	}
+	if err := dp.Start(); err != nil {
+		t.Fatal(err)
+	}
+	waitFor(t, "rule add", func() bool { return dp.Stats().ControlApplied == 1 })
+
+	events := make([]shmring.Msg, 256)
+	var gotLog, gotSample bool
+	waitFor(t, "log and sample events", func() bool {
+		n := ch.Poll(events)
+		for i := range events[:n] {
+			e := &events[i]
+			switch e.Type {
+			case shmring.EventLog:
+				if e.Domain() != "logme.example.com" || e.RuleIDString() != "audit" || e.ID != 7 {
+					t.Errorf("log event = %q/%q/%d", e.Domain(), e.RuleIDString(), e.ID)
+				}
+				gotLog = true
+			case shmring.EventSample:
+				if e.Value >= 2 {
+					t.Errorf("sample worker = %d", e.Value)
+				}
+				gotSample = true
+			}
+		}
+		return gotLog && gotSample
+	})
+
+	// 阻断规则的应答方式随消息下发
+	refused, err := shmring.AddRuleMsg("refused.example.com", 8, uint8(ActionBlock), uint8(BlockRefused), 0, 0, "refused")
+	if err != nil {
+		t.Fatal(err)
+	}
+	if err := ch.Send(&refused); err != nil {
+		t.Fatal(err)
+	}
+	waitFor(t, "blocked rule add", func() bool { return dp.Stats().ControlApplied == 2 })
+	var res CheckResult
+	if err := engine.Check([]byte("refused.example.com"), 1, &res); err != nil {
+		t.Fatal(err)
+	}
+	if res.ID() != 8 || res.BlockMode() != BlockRefused {
+		t.Errorf("refused rule = id %d mode %d, want 8/%d", res.ID(), res.BlockMode(), BlockRefused)
+	}
+
+	for _, domain := range []string{"logme.example.com", "refused.example.com"} {
+		remove, _ := shmring.RemoveRuleMsg(domain)
+		if err := ch.Send(&remove); err != nil {
+			t.Fatal(err)
+		}
+	}
+	waitFor(t, "rule remove", func() bool { return dp.Stats().ControlApplied == 4 })
+
+	dp.Stop()
+	stats := dp.Stats()
+	if stats.Packets == 0 || stats.Responded == 0 || stats.Packets != stats.Responded+stats.Passed {
+		t.Errorf("unexpected stats %+v", stats)
+	}
+	if engine.Stats().RuleCount != 1 {
+		t.Errorf("RuleCount = %d, want 1", engine.Stats().RuleCount)
+	}
+}
@@ -0,0 +1,326 @@
+package cppbridge
+
+/*
+#cgo noescape xdp_dns_engine_check
+#cgo nocallback xdp_dns_engine_check
+#cgo noescape xdp_dns_engine_check_batch
+#cgo nocallback xdp_dns_engine_check_batch
+#cgo noescape xdp_dns_engine_answer_any
+#cgo nocallback xdp_dns_engine_answer_any
+#include "xdp_dns/cgo_bridge.h"
+#include <stdlib.h>
+*/
+import "C"
+import "unsafe"
+
+// C++ 过滤引擎句柄
+//
+// 每个 Engine 持有独立的规则集, 同一进程可创建多个; 在备用引擎上加载并
+// 验证新规则后用 Swap 与线上引擎交换. 同一 Engine 的方法可并发调用,
+// Close 除外.
+
+// Action 规则动作, 与 C 端 XDPDNSAction 取值一致
+type Action uint8
+
+const (
+	ActionAllow    Action = C.XDP_DNS_ACTION_ALLOW
+	ActionBlock    Action = C.XDP_DNS_ACTION_BLOCK
+	ActionRedirect Action = C.XDP_DNS_ACTION_REDIRECT
+	ActionLog      Action = C.XDP_DNS_ACTION_LOG
+)
+
+// BlockMode 阻断规则的应答方式, 与 C 端 XDPDNSBlockMode 取值一致
+type BlockMode uint8
+
+const (
+	BlockNXDomain    BlockMode = C.XDP_DNS_BLOCK_NXDOMAIN     // NXDOMAIN + 合成 SOA
+	BlockNoData      BlockMode = C.XDP_DNS_BLOCK_NODATA       // NOERROR 空回答 + 合成 SOA
+	BlockRefused     BlockMode = C.XDP_DNS_BLOCK_REFUSED
+	BlockNullAddress BlockMode = C.XDP_DNS_BLOCK_NULL_ADDRESS // 0.0.0.0 / ::
+	BlockDrop        BlockMode = C.XDP_DNS_BLOCK_DROP         // 不应答, 数据面返回 XDP_DROP
+)
+
+// AnyPolicy ANY 查询策略 (RuleSet YAML 顶层键 any_policy), 与 XDPDNSAnyPolicy 一致
+type AnyPolicy uint8
+
+const (
+	AnyForward  AnyPolicy = C.XDP_DNS_ANY_FORWARD  // 原样转发上游
+	AnyHInfo    AnyPolicy = C.XDP_DNS_ANY_HINFO    // 合成最小 HINFO 回答 (RFC 8482)
+	AnyTruncate AnyPolicy = C.XDP_DNS_ANY_TRUNCATE // 空回答并置 TC=1
+)
+
+// EngineOptions 引擎内存放置选项
+type EngineOptions struct {
+	HugePages    bool
+	NUMANode     int // -1 不绑定
+	NUMAReplicas bool
+}
+
+// Rule 批量增删改的规则
+type Rule struct {
+	Domain     string // "example.com" 或 "*.example.com"
+	ID         uint32
+	Action     Action
+	BlockMode  BlockMode // 仅对 ActionBlock 有效
+	RedirectIP uint32    // 网络字节序
+	TTL        uint32
+	RuleID     string // 超过 31 字节时截断
+}
+
+// CheckResult 可复用的匹配结果
+type CheckResult struct {
+	res C.XDPDNSCheckResult
+}
+
+func (r *CheckResult) Action() Action       { return Action(r.res.action) }
+func (r *CheckResult) Matched() bool        { return r.res.matched != 0 }
+func (r *CheckResult) BlockMode() BlockMode { return BlockMode(r.res.block_mode) }
+func (r *CheckResult) ID() uint32           { return uint32(r.res.id) }
+func (r *CheckResult) RedirectIP() uint32   { return uint32(r.res.redirect_ip) }
+func (r *CheckResult) TTL() uint32          { return uint32(r.res.ttl) }
+
+// RuleID 返回命中规则的 rule_id (会分配字符串)
+func (r *CheckResult) RuleID() string {
+	return C.GoString(&r.res.rule_id[0])
+}
+
+// EngineStats 引擎统计 (含被整体替换掉的规则集)
+type EngineStats struct {
+	TotalChecks uint64
+	Allowed     uint64
+	Blocked     uint64
+	Redirected  uint64
+	Logged      uint64
+	RuleCount   uint64
+}
+
+// Engine C++ FilterEngine 句柄
+type Engine struct {
+	ptr *C.XDPDNSEngine
+}
+
+// NewEngine 创建过滤引擎; opts 为 nil 时使用 SetMemoryOptions 设置的默认值
+func NewEngine(opts *EngineOptions) (*Engine, error) {
+	var ptr *C.XDPDNSEngine
+	if opts == nil {
+		ptr = C.xdp_dns_engine_create(nil)
+	} else {
+		cOpts := C.XDPDNSEngineOptions{
+			huge_pages:    boolToC(opts.HugePages),
+			numa_node:     C.int(opts.NUMANode),
+			numa_replicas: boolToC(opts.NUMAReplicas),
+		}
+		ptr = C.xdp_dns_engine_create(&cOpts)
+	}
+	if ptr == nil {
+		return nil, ErrInvalidParam
+	}
+	return &Engine{ptr: ptr}, nil
+}
+
+// Close 销毁引擎, 调用者保证没有其它 goroutine 仍在使用
+func (e *Engine) Close() {
+	if e.ptr != nil {
+		C.xdp_dns_engine_destroy(e.ptr)
+		e.ptr = nil
+	}
+}
+
+// LoadRules 从 RuleSet YAML 整体替换规则; 解析失败时原规则保持不变
+func (e *Engine) LoadRules(yaml []byte) error {
+	var p *C.char
+	if len(yaml) > 0 {
+		p = (*C.char)(unsafe.Pointer(&yaml[0]))
+	}
+	return codeToError(int(C.xdp_dns_engine_load_rules(e.ptr, p, C.size_t(len(yaml)))))
+}
+
+// LoadRulesFile 从文件整体替换规则
+func (e *Engine) LoadRulesFile(path string) error {
+	cPath := C.CString(path)
+	defer C.free(unsafe.Pointer(cPath))
+	return codeToError(int(C.xdp_dns_engine_load_rules_file(e.ptr, cPath)))
+}
+
+// AddRules 批量添加规则
+func (e *Engine) AddRules(rules []Rule) error {
+	cRules, err := toCRules(rules)
+	if err != nil {
+		return err
+	}
+	return codeToError(int(C.xdp_dns_engine_add_rules(e.ptr, rulesPtr(cRules), C.size_t(len(cRules)))))
+}
+
+// RemoveRules 按 Domain 批量删除规则, 返回实际删除的条数
+func (e *Engine) RemoveRules(rules []Rule) (int, error) {
+	cRules, err := toCRules(rules)
+	if err != nil {
+		return 0, err
+	}
+	var removed C.size_t
+	ret := C.xdp_dns_engine_remove_rules(e.ptr, rulesPtr(cRules), C.size_t(len(cRules)), &removed)
+	return int(removed), codeToError(int(ret))
+}
+
+// UpdateRules 以 rules 整体替换现有规则 (原子发布)
+func (e *Engine) UpdateRules(rules []Rule) error {
+	cRules, err := toCRules(rules)
+	if err != nil {
+		return err
+	}
+	return codeToError(int(C.xdp_dns_engine_update_rules(e.ptr, rulesPtr(cRules), C.size_t(len(cRules)))))
+}
+
+// Check 检查单个小写域名, 结果写入 out
+func (e *Engine) Check(domain []byte, qtype uint16, out *CheckResult) error {
+	if len(domain) == 0 {
+		return ErrInvalidParam
+	}
+	ret := C.xdp_dns_engine_check(
+		e.ptr,
+		(*C.char)(unsafe.Pointer(&domain[0])),
+		C.size_t(len(domain)),
+		C.uint16_t(qtype),
+		&out.res,
+	)
+	return codeToError(int(ret))
+}
+
+// CheckBatch 批量检查 ParseInto 的结果, out 需至少 len(queries) 个元素
+//
+// 整批只跨越一次 cgo 边界, 不分配内存.
+func (e *Engine) CheckBatch(queries []Query, out []CheckResult) error {
+	if len(out) < len(queries) {
+		return ErrBufferTooSmall
+	}
+	if len(queries) == 0 {
+		return nil
+	}
+	// Query / CheckResult 只含对应的 C 结构, 切片可直接作为 C 数组传递
+	ret := C.xdp_dns_engine_check_batch(
+		e.ptr,
+		(*C.XDPDNSParseResult)(unsafe.Pointer(&queries[0])),
+		C.size_t(len(queries)),
+		(*C.XDPDNSCheckResult)(unsafe.Pointer(&out[0])),
+	)
+	return codeToError(int(ret))
+}
+
+// Stats 获取引擎统计
+func (e *Engine) Stats() EngineStats {
+	var cStats C.XDPDNSEngineStats
+	C.xdp_dns_engine_get_stats(e.ptr, &cStats)
+
+	return EngineStats{
+		TotalChecks: uint64(cStats.total_checks),
+		Allowed:     uint64(cStats.allowed),
+		Blocked:     uint64(cStats.blocked),
+		Redirected:  uint64(cStats.redirected),
+		Logged:      uint64(cStats.logged),
+		RuleCount:   uint64(cStats.rule_count),
+	}
+}
+
+// ResetStats 重置引擎统计
+func (e *Engine) ResetStats() {
+	C.xdp_dns_engine_reset_stats(e.ptr)
+}
+
+// MemoryStats 获取引擎内存占用
+func (e *Engine) MemoryStats() MemoryStats {
+	var cStats C.XDPDNSMemoryStats
+	C.xdp_dns_engine_get_memory_stats(e.ptr, &cStats)
+	return memoryStatsFromC(&cStats)
+}
+
+// AnyPolicy 返回当前规则集的 ANY 策略与 HINFO 回答的 TTL
+func (e *Engine) AnyPolicy() (AnyPolicy, uint32) {
+	var ttl C.uint32_t
+	ret := C.xdp_dns_engine_any_policy(e.ptr, &ttl)
+	if ret < 0 {
+		return AnyForward, 0
+	}
+	return AnyPolicy(ret), uint32(ttl)
+}
+
+// NegativeTTL 返回当前规则集阻断应答合成 SOA 的 TTL (秒)
+func (e *Engine) NegativeTTL() uint32 {
+	return uint32(C.xdp_dns_engine_negative_ttl(e.ptr))
+}
+
+// AnswerAnyInto 按当前规则集的 ANY 策略把响应写入 dst, 返回响应长度
+//
+// 非 ANY 查询或策略为 AnyForward 时返回 0, 调用者照常转发. dst 可与 query
+// 共用起始地址, 不分配内存.
+func (e *Engine) AnswerAnyInto(query []byte, dst []byte) (int, error) {
+	if len(query) < 12 || len(dst) == 0 {
+		return 0, ErrInvalidParam
+	}
+
+	var responseLen C.size_t
+	ret := C.xdp_dns_engine_answer_any(
+		e.ptr,
+		(*C.uint8_t)(unsafe.Pointer(&query[0])),
+		C.size_t(len(query)),
+		(*C.uint8_t)(unsafe.Pointer(&dst[0])),
+		C.size_t(len(dst)),
+		&responseLen,
+	)
+	if ret != 0 {
+		return 0, codeToError(int(ret))
+	}
+	return int(responseLen), nil
+}
+
+// Swap 原子交换两个引擎的规则集, 统计随规则集一起交换
+func (e *Engine) Swap(other *Engine) error {
+	return codeToError(int(C.xdp_dns_engine_swap(e.ptr, other.ptr)))
+}
+
+// PublishRuleInfo 标记为线上引擎: 之后每次加载 / 交换 / 增删都更新共享内存
+// 统计区的规则代数与规则数. 标记不随 Swap 交换; NewDataplane 自动标记.
+func (e *Engine) PublishRuleInfo(enabled bool) {
+	var en C.int
+	if enabled {
+		en = 1
+	}
+	C.xdp_dns_engine_publish_rule_info(e.ptr, en)
+}
+
+func toCRules(rules []Rule) ([]C.XDPDNSRule, error) {
+	cRules := make([]C.XDPDNSRule, len(rules))
+	for i := range rules {
+		r := &rules[i]
+		c := &cRules[i]
+
+		domain := unsafe.Slice((*byte)(unsafe.Pointer(&c.domain[0])), len(c.domain))
+		if len(r.Domain) == 0 || len(r.Domain) >= len(domain) {
+			return nil, ErrInvalidParam
+		}
+		copy(domain, r.Domain)
+
+		ruleID := unsafe.Slice((*byte)(unsafe.Pointer(&c.rule_id[0])), len(c.rule_id)-1)
+		copy(ruleID, r.RuleID)
+
+		c.id = C.uint32_t(r.ID)
+		c.action = C.uint8_t(r.Action)
+		c.block_mode = C.uint8_t(r.BlockMode)
+		c.redirect_ip = C.uint32_t(r.RedirectIP)
+		c.ttl = C.uint32_t(r.TTL)
+	}
+	return cRules, nil
+}
+
+func rulesPtr(rules []C.XDPDNSRule) *C.XDPDNSRule {
+	if len(rules) == 0 {
+		return nil
+	}
+	return &rules[0]
+}
+
+func boolToC(b bool) C.int {
+	if b {
+		return 1
+	}
+	return 0
+}
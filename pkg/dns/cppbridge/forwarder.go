@@ -0,0 +1,113 @@
+package cppbridge
+
+/*
+#include "xdp_dns/cgo_bridge.h"
+#include <stdlib.h>
+*/
+import "C"
+import (
+	"time"
+	"unsafe"
+)
+
+// ForwarderOptions 上游转发器选项, 零值字段使用 C++ 默认值
+type ForwarderOptions struct {
+	Servers     []string // 对应配置 dns.upstream_servers
+	NumSockets  uint32
+	MaxInflight uint32
+	NumOwners   uint32 // 不少于挂载它的数据面的 worker 数
+	Timeout     time.Duration
+	Retries     uint32
+	NoCoalesce  bool // 相同的在途查询不合并
+}
+
+// ForwarderStats 转发器统计
+type ForwarderStats struct {
+	Submitted  uint64
+	Coalesced  uint64 // 挂到相同在途查询上, 未单独发出
+	Rejected   uint64
+	Sent       uint64
+	SendErrors uint64
+	Responses  uint64
+	Mismatched uint64
+	Retries    uint64
+	Timeouts   uint64
+	Truncated  uint64
+	Completed  uint64
+	Inflight   uint64
+}
+
+// Forwarder C++ 上游转发器句柄
+//
+// 通过 DataplaneOptions.Forwarder 交给数据面, 未在本地应答的查询由 worker
+// 整批转发, 上游响应经包源发回客户端.
+type Forwarder struct {
+	ptr *C.XDPDNSForwarder
+}
+
+// NewForwarder 创建并启动转发器
+func NewForwarder(opts ForwarderOptions) (*Forwarder, error) {
+	if len(opts.Servers) == 0 {
+		return nil, ErrInvalidParam
+	}
+
+	servers := make([]*C.char, len(opts.Servers))
+	for i, s := range opts.Servers {
+		servers[i] = C.CString(s)
+	}
+	defer func() {
+		for _, p := range servers {
+			C.free(unsafe.Pointer(p))
+		}
+	}()
+	// C 数组放在 C 内存中, 避免把含 Go 指针的切片传给 C
+	arr := (**C.char)(C.malloc(C.size_t(len(servers)) * C.size_t(unsafe.Sizeof(servers[0]))))
+	defer C.free(unsafe.Pointer(arr))
+	copy(unsafe.Slice(arr, len(servers)), servers)
+
+	cOpts := C.XDPDNSForwarderOptions{
+		servers:      arr,
+		num_servers:  C.uint32_t(len(servers)),
+		num_sockets:  C.uint32_t(opts.NumSockets),
+		max_inflight: C.uint32_t(opts.MaxInflight),
+		num_owners:   C.uint32_t(opts.NumOwners),
+		timeout_ms:   C.uint32_t(opts.Timeout / time.Millisecond),
+		retries:      C.uint32_t(opts.Retries),
+
+		disable_coalescing: boolToC(opts.NoCoalesce),
+	}
+	ptr := C.xdp_dns_forwarder_create(&cOpts)
+	if ptr == nil {
+		return nil, ErrInvalidParam
+	}
+	return &Forwarder{ptr: ptr}, nil
+}
+
+// Close 停止并销毁转发器; 挂载它的数据面需先关闭
+func (f *Forwarder) Close() {
+	if f.ptr != nil {
+		C.xdp_dns_forwarder_destroy(f.ptr)
+		f.ptr = nil
+	}
+}
+
+// Stats 获取转发器统计
+func (f *Forwarder) Stats() ForwarderStats {
+	var cStats C.XDPDNSForwarderStats
+	C.xdp_dns_forwarder_get_stats(f.ptr, &cStats)
+
+	return ForwarderStats{
+		Submitted:  uint64(cStats.submitted),
+		Coalesced:  uint64(cStats.coalesced),
+		Rejected:   uint64(cStats.rejected),
+		Sent:       uint64(cStats.sent),
+		SendErrors: uint64(cStats.send_errors),
+		Responses:  uint64(cStats.responses),
+		Mismatched: uint64(cStats.mismatched),
+		Retries:    uint64(cStats.retries),
+		Timeouts:   uint64(cStats.timeouts),
+		Truncated:  uint64(cStats.truncated),
+		Completed:  uint64(cStats.completed),
+		Inflight:   uint64(cStats.inflight),
+	}
+}
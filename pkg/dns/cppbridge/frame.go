@@ -0,0 +1,117 @@
+package cppbridge
+
+/*
+#cgo noescape xdp_dns_parse_frame
+#cgo nocallback xdp_dns_parse_frame
+#cgo noescape xdp_dns_parse_frames
+#cgo nocallback xdp_dns_parse_frames
+#include "xdp_dns/cgo_bridge.h"
+*/
+import "C"
+import (
+	"net/netip"
+	"unsafe"
+)
+
+// L2-L4 帧解析
+//
+// 从以太网帧定位 DNS 负载, 支持 802.1Q / QinQ、IPv4 选项、IPv6 扩展头.
+// 结果是偏移与原始地址, 不分配内存; 地址按需转换为 netip.Addr (值类型).
+
+// FrameInfo.Flags 取值
+const (
+	FrameVLAN      = C.XDP_DNS_FRAME_VLAN
+	FrameQinQ      = C.XDP_DNS_FRAME_QINQ
+	FrameIPv6      = C.XDP_DNS_FRAME_IPV6
+	FrameIPOptions = C.XDP_DNS_FRAME_IP_OPTIONS
+	FrameIPv6Ext   = C.XDP_DNS_FRAME_IPV6_EXT
+	FrameFragment  = C.XDP_DNS_FRAME_FRAGMENT // 首个分片, DNS 负载不完整
+)
+
+// MaxFrameBatch ParseFrames 单次最多处理的帧数
+const MaxFrameBatch = 64
+
+// FrameDesc RX 描述符, 与 struct xdp_desc 布局一致
+type FrameDesc struct {
+	Addr    uint64 // 相对 UMEM 起始的偏移
+	Len     uint32
+	Options uint32
+}
+
+// FrameInfo 可复用的帧解析结果
+type FrameInfo struct {
+	info C.XDPDNSFrameInfo
+}
+
+func (f *FrameInfo) L3Offset() int      { return int(f.info.l3_offset) }
+func (f *FrameInfo) L4Offset() int      { return int(f.info.l4_offset) }
+func (f *FrameInfo) PayloadOffset() int { return int(f.info.payload_offset) }
+func (f *FrameInfo) PayloadLen() int    { return int(f.info.payload_len) }
+func (f *FrameInfo) SrcPort() uint16    { return uint16(f.info.src_port) }
+func (f *FrameInfo) DstPort() uint16    { return uint16(f.info.dst_port) }
+func (f *FrameInfo) Flags() uint8       { return uint8(f.info.flags) }
+func (f *FrameInfo) IsIPv6() bool       { return f.info.ip_version == 6 }
+func (f *FrameInfo) HopLimit() uint8    { return uint8(f.info.hop_limit) }
+
+// VLANs 返回 VLAN TCI (外层在前), 无标签时为空
+func (f *FrameInfo) VLANs() []uint16 {
+	tci := (*[2]uint16)(unsafe.Pointer(&f.info.vlan_tci[0]))
+	return tci[:f.info.num_vlans]
+}
+
+func (f *FrameInfo) SrcMAC() [6]byte { return *(*[6]byte)(unsafe.Pointer(&f.info.src_mac[0])) }
+func (f *FrameInfo) DstMAC() [6]byte { return *(*[6]byte)(unsafe.Pointer(&f.info.dst_mac[0])) }
+
+func (f *FrameInfo) SrcAddr() netip.Addr { return f.addr(&f.info.src_addr) }
+func (f *FrameInfo) DstAddr() netip.Addr { return f.addr(&f.info.dst_addr) }
+
+func (f *FrameInfo) addr(raw *[16]C.uint8_t) netip.Addr {
+	b := (*[16]byte)(unsafe.Pointer(&raw[0]))
+	if f.info.ip_version == 4 {
+		return netip.AddrFrom4([4]byte(b[:4]))
+	}
+	return netip.AddrFrom16(*b)
+}
+
+// Payload 返回 frame 中的 DNS 负载 (不复制)
+func (f *FrameInfo) Payload(frame []byte) []byte {
+	off := int(f.info.payload_offset)
+	return frame[off : off+int(f.info.payload_len)]
+}
+
+// ParseFrame 解析单个以太网帧, 结果写入 out
+func ParseFrame(frame []byte, out *FrameInfo) error {
+	if len(frame) == 0 {
+		return ErrInvalidParam
+	}
+	ret := C.xdp_dns_parse_frame(
+		(*C.uint8_t)(unsafe.Pointer(&frame[0])),
+		C.size_t(len(frame)),
+		&out.info,
+	)
+	return codeToError(int(ret))
+}
+
+// ParseFrames 批量解析 UMEM 中的一批 RX 帧, 整批只跨越一次 cgo 边界
+//
+// 返回掩码的第 i 位为 1 表示 descs[i] 解析成功, 结果在 out[i].
+// len(descs) 不超过 MaxFrameBatch, out 需至少 len(descs) 个元素.
+func ParseFrames(umem []byte, descs []FrameDesc, out []FrameInfo) (uint64, error) {
+	if len(umem) == 0 || len(descs) > MaxFrameBatch || len(out) < len(descs) {
+		return 0, ErrInvalidParam
+	}
+	if len(descs) == 0 {
+		return 0, nil
+	}
+
+	var ok C.uint64_t
+	ret := C.xdp_dns_parse_frames(
+		(*C.uint8_t)(unsafe.Pointer(&umem[0])),
+		C.size_t(len(umem)),
+		(*C.XDPDNSFrameDesc)(unsafe.Pointer(&descs[0])),
+		C.size_t(len(descs)),
+		(*C.XDPDNSFrameInfo)(unsafe.Pointer(&out[0])),
+		&ok,
+	)
+	return uint64(ok), codeToError(int(ret))
+}
@@ -0,0 +1,237 @@
+package cppbridge
+
+/*
+#cgo noescape xdp_dns_parse
+#cgo nocallback xdp_dns_parse
+#cgo noescape xdp_dns_build_nxdomain
+#cgo nocallback xdp_dns_build_nxdomain
+#cgo noescape xdp_dns_build_nxdomain_soa
+#cgo nocallback xdp_dns_build_nxdomain_soa
+#cgo noescape xdp_dns_build_nodata
+#cgo nocallback xdp_dns_build_nodata
+#cgo noescape xdp_dns_build_refused
+#cgo nocallback xdp_dns_build_refused
+#cgo noescape xdp_dns_build_blocked
+#cgo nocallback xdp_dns_build_blocked
+#cgo noescape xdp_dns_build_a_response
+#cgo nocallback xdp_dns_build_a_response
+#cgo noescape xdp_dns_build_aaaa_response
+#cgo nocallback xdp_dns_build_aaaa_response
+#include "xdp_dns/cgo_bridge.h"
+*/
+import "C"
+import "unsafe"
+
+// 零分配接口
+//
+// 上面的 noescape / nocallback 声明 C 函数既不保留指针也不回调 Go,
+// 传给它们的栈上变量因此不会逃逸到堆. 解析结果与响应缓冲区由调用者持有
+// 并在每个包之间复用, 响应可直接写入 AF_XDP TX 帧, 或在 RX 帧上原地改写.
+
+// 回答记录追加的字节数 (响应长度 = 查询长度 + 该值)
+const (
+	AResponseExtra    = 16
+	AAAAResponseExtra = 28
+	NegativeSOAExtra  = 59 // 合成 SOA 至多追加的字节数 (相对问题部分末尾)
+)
+
+// Query 可复用的解析结果
+//
+// 每个 worker 持有一个, ParseInto 每次覆盖写入.
+type Query struct {
+	res C.XDPDNSParseResult
+}
+
+func (q *Query) ID() uint16 { return uint16(q.res.id) }
+func (q *Query) Flags() uint16 { return uint16(q.res.flags) }
+func (q *Query) QType() uint16 { return uint16(q.res.qtype) }
+func (q *Query) QClass() uint16 { return uint16(q.res.qclass) }
+func (q *Query) NameOffset() uint64 { return uint64(q.res.name_offset) }
+func (q *Query) QuestionEnd() uint64 { return uint64(q.res.question_end) }
+
+// Domain 返回小写域名, 指向 Query 内部缓冲区的视图
+//
+// 下一次 ParseInto 后内容失效; 需要保留时由调用者复制.
+func (q *Query) Domain() []byte {
+	return unsafe.Slice((*byte)(unsafe.Pointer(&q.res.domain[0])), int(q.res.domain_len))
+}
+
+// ParseInto 解析 DNS 查询并写入 q, 不分配内存
+func ParseInto(packet []byte, q *Query) error {
+	if len(packet) < 12 {
+		return ErrInvalidParam
+	}
+
+	ret := C.xdp_dns_parse(
+		(*C.uint8_t)(unsafe.Pointer(&packet[0])),
+		C.size_t(len(packet)),
+		&q.res,
+	)
+	return codeToError(int(ret))
+}
+
+// BuildNXDomainInto 把 NXDOMAIN 响应写入 dst, 返回响应长度
+//
+// dst 需至少 len(query) 字节; 可与 query 为同一缓冲区.
+func BuildNXDomainInto(query, dst []byte) (int, error) {
+	if len(query) < 12 || len(dst) == 0 {
+		return 0, ErrInvalidParam
+	}
+
+	var responseLen C.size_t
+	ret := C.xdp_dns_build_nxdomain(
+		(*C.uint8_t)(unsafe.Pointer(&query[0])),
+		C.size_t(len(query)),
+		(*C.uint8_t)(unsafe.Pointer(&dst[0])),
+		C.size_t(len(dst)),
+		&responseLen,
+	)
+	if ret != 0 {
+		return 0, codeToError(int(ret))
+	}
+	return int(responseLen), nil
+}
+
+// BuildNXDomainSOAInto 把带合成 SOA 的 NXDOMAIN 响应写入 dst, 返回响应长度
+//
+// SOA 的 TTL 与 MINIMUM 为 negativeTTL, 下游据此否定缓存. dst 需至少
+// len(query)+NegativeSOAExtra 字节; 可与 query 共用起始地址.
+func BuildNXDomainSOAInto(query []byte, negativeTTL uint32, dst []byte) (int, error) {
+	if len(query) < 12 || len(dst) == 0 {
+		return 0, ErrInvalidParam
+	}
+
+	var responseLen C.size_t
+	ret := C.xdp_dns_build_nxdomain_soa(
+		(*C.uint8_t)(unsafe.Pointer(&query[0])),
+		C.size_t(len(query)),
+		C.uint32_t(negativeTTL),
+		(*C.uint8_t)(unsafe.Pointer(&dst[0])),
+		C.size_t(len(dst)),
+		&responseLen,
+	)
+	if ret != 0 {
+		return 0, codeToError(int(ret))
+	}
+	return int(responseLen), nil
+}
+
+// BuildNoDataInto 把带合成 SOA 的 NODATA 响应 (NOERROR, 无回答) 写入 dst
+//
+// 参数同 BuildNXDomainSOAInto.
+func BuildNoDataInto(query []byte, negativeTTL uint32, dst []byte) (int, error) {
+	if len(query) < 12 || len(dst) == 0 {
+		return 0, ErrInvalidParam
+	}
+
+	var responseLen C.size_t
+	ret := C.xdp_dns_build_nodata(
+		(*C.uint8_t)(unsafe.Pointer(&query[0])),
+		C.size_t(len(query)),
+		C.uint32_t(negativeTTL),
+		(*C.uint8_t)(unsafe.Pointer(&dst[0])),
+		C.size_t(len(dst)),
+		&responseLen,
+	)
+	if ret != 0 {
+		return 0, codeToError(int(ret))
+	}
+	return int(responseLen), nil
+}
+
+// BuildRefusedInto 把 REFUSED 响应写入 dst, 返回响应长度
+//
+// dst 需至少 len(query) 字节; 可与 query 为同一缓冲区.
+func BuildRefusedInto(query, dst []byte) (int, error) {
+	if len(query) < 12 || len(dst) == 0 {
+		return 0, ErrInvalidParam
+	}
+
+	var responseLen C.size_t
+	ret := C.xdp_dns_build_refused(
+		(*C.uint8_t)(unsafe.Pointer(&query[0])),
+		C.size_t(len(query)),
+		(*C.uint8_t)(unsafe.Pointer(&dst[0])),
+		C.size_t(len(dst)),
+		&responseLen,
+	)
+	if ret != 0 {
+		return 0, codeToError(int(ret))
+	}
+	return int(responseLen), nil
+}
+
+// BuildBlockedInto 按阻断规则的应答方式把响应写入 dst, 返回响应长度
+//
+// mode 通常取自 CheckResult.BlockMode(); BlockDrop 返回 0, 调用者丢弃查询.
+// ttl 为空地址回答的 TTL, negativeTTL 为合成 SOA 的 TTL. dst 需至少
+// len(query)+NegativeSOAExtra 字节; 可与 query 共用起始地址.
+func BuildBlockedInto(query []byte, mode BlockMode, ttl, negativeTTL uint32, dst []byte) (int, error) {
+	if len(query) < 12 || len(dst) == 0 {
+		return 0, ErrInvalidParam
+	}
+
+	var responseLen C.size_t
+	ret := C.xdp_dns_build_blocked(
+		(*C.uint8_t)(unsafe.Pointer(&query[0])),
+		C.size_t(len(query)),
+		C.uint8_t(mode),
+		C.uint32_t(ttl),
+		C.uint32_t(negativeTTL),
+		(*C.uint8_t)(unsafe.Pointer(&dst[0])),
+		C.size_t(len(dst)),
+		&responseLen,
+	)
+	if ret != 0 {
+		return 0, codeToError(int(ret))
+	}
+	return int(responseLen), nil
+}
+
+// BuildAResponseInto 把 A 记录响应写入 dst, 返回响应长度
+//
+// dst 需至少 len(query)+AResponseExtra 字节; 可与 query 共用起始地址.
+func BuildAResponseInto(query []byte, ipv4 uint32, ttl uint32, dst []byte) (int, error) {
+	if len(query) < 12 || len(dst) == 0 {
+		return 0, ErrInvalidParam
+	}
+
+	var responseLen C.size_t
+	ret := C.xdp_dns_build_a_response(
+		(*C.uint8_t)(unsafe.Pointer(&query[0])),
+		C.size_t(len(query)),
+		C.uint32_t(ipv4),
+		C.uint32_t(ttl),
+		(*C.uint8_t)(unsafe.Pointer(&dst[0])),
+		C.size_t(len(dst)),
+		&responseLen,
+	)
+	if ret != 0 {
+		return 0, codeToError(int(ret))
+	}
+	return int(responseLen), nil
+}
+
+// BuildAAAAResponseInto 把 AAAA 记录响应写入 dst, 返回响应长度
+//
+// ipv6 为 16 字节网络序地址; dst 需至少 len(query)+AAAAResponseExtra 字节.
+func BuildAAAAResponseInto(query []byte, ipv6 []byte, ttl uint32, dst []byte) (int, error) {
+	if len(query) < 12 || len(ipv6) != 16 || len(dst) == 0 {
+		return 0, ErrInvalidParam
+	}
+
+	var responseLen C.size_t
+	ret := C.xdp_dns_build_aaaa_response(
+		(*C.uint8_t)(unsafe.Pointer(&query[0])),
+		C.size_t(len(query)),
+		(*C.uint8_t)(unsafe.Pointer(&ipv6[0])),
+		C.uint32_t(ttl),
+		(*C.uint8_t)(unsafe.Pointer(&dst[0])),
+		C.size_t(len(dst)),
+		&responseLen,
+	)
+	if ret != 0 {
+		return 0, codeToError(int(ret))
+	}
+	return int(responseLen), nil
+}
@@ -0,0 +1,72 @@
+package cppbridge
+
+import "testing"
+
+// buildFrame 以太网 + IPv4 + UDP 封装的查询帧
+func buildFrame(domain string) []byte {
+	dns := buildQuery(domain)
+	udpLen := 8 + len(dns)
+	frame := []byte{
+		0x02, 0, 0, 0, 0, 0x01, 0x02, 0, 0, 0, 0, 0x02, 0x08, 0x00,
+		0x45, 0, byte((20 + udpLen) >> 8), byte(20 + udpLen), 0, 0, 0, 0, 64, 17, 0, 0,
+		192, 0, 2, 1, 10, 0, 0, 53,
+		0x9c, 0x40, 0x00, 0x35, byte(udpLen >> 8), byte(udpLen), 0, 0,
+	}
+	return append(frame, dns...)
+}
+
+// 零分配接口在复用调用者的 Query / 缓冲区时不得产生堆分配
+func TestZeroCopy_NoAllocs(t *testing.T) {
+	query := buildQuery("www.example.com")
+	dst := make([]byte, 2048)
+	ipv6 := make([]byte, 16)
+	ipv6[0], ipv6[1], ipv6[15] = 0x20, 0x01, 0x01
+
+	frame := buildFrame("www.example.com")
+	umem := make([]byte, MaxFrameBatch*2048)
+	descs := make([]FrameDesc, MaxFrameBatch)
+	for i := range descs {
+		copy(umem[i*2048:], frame)
+		descs[i] = FrameDesc{Addr: uint64(i * 2048), Len: uint32(len(frame))}
+	}
+	infos := make([]FrameInfo, MaxFrameBatch)
+
+	var q Query
+	var info FrameInfo
+	cases := []struct {
+		name string
+		fn   func() error
+	}{
+		{"ParseInto", func() error {
+			if err := ParseInto(query, &q); err != nil {
+				return err
+			}
+			_ = q.Domain()
+			return nil
+		}},
+		{"BuildNXDomainInto", func() error { _, err := BuildNXDomainInto(query, dst); return err }},
+		{"BuildNXDomainSOAInto", func() error { _, err := BuildNXDomainSOAInto(query, 60, dst); return err }},
+		{"BuildNoDataInto", func() error { _, err := BuildNoDataInto(query, 60, dst); return err }},
+		{"BuildRefusedInto", func() error { _, err := BuildRefusedInto(query, dst); return err }},
+		{"BuildBlockedInto", func() error { _, err := BuildBlockedInto(query, BlockNullAddress, 300, 60, dst); return err }},
+		{"BuildAResponseInto", func() error { _, err := BuildAResponseInto(query, 0xC0A80164, 300, dst); return err }},
+		{"BuildAAAAResponseInto", func() error { _, err := BuildAAAAResponseInto(query, ipv6, 300, dst); return err }},
+		{"ParseFrame", func() error { return ParseFrame(frame, &info) }},
+		{"ParseFrames", func() error { _, err := ParseFrames(umem, descs, infos); return err }},
+	}
+
+	for _, c := range cases {
+		var err error
+		allocs := testing.AllocsPerRun(100, func() {
+			if e := c.fn(); e != nil {
+				err = e
+			}
+		})
+		if err != nil {
+			t.Errorf("%s: %v", c.name, err)
+		}
+		if allocs != 0 {
+			t.Errorf("%s: %.1f allocs/op, want 0", c.name, allocs)
+		}
+	}
+}
@@ -77,6 +77,118 @@ func BenchmarkCPPBuildAResponse(b *testing.B) {
 	}
 }
 
+// BenchmarkCPPParseInto C++ DNS 解析 - 复用调用者的 Query (0 allocs/op)
+func BenchmarkCPPParseInto(b *testing.B) {
+	packet := buildTestQuery("www.example.com")
+	var q cppbridge.Query
+
+	b.ResetTimer()
+	b.ReportAllocs()
+
+	for i := 0; i < b.N; i++ {
+		if err := cppbridge.ParseInto(packet, &q); err != nil {
+			b.Fatal(err)
+		}
+		_ = q.Domain()
+	}
+}
+
+// BenchmarkCPPBuildNXDomainInto C++ NXDOMAIN 响应写入复用缓冲区 (0 allocs/op)
+func BenchmarkCPPBuildNXDomainInto(b *testing.B) {
+	packet := buildTestQuery("blocked.example.com")
+	frame := make([]byte, 2048)
+
+	b.ResetTimer()
+	b.ReportAllocs()
+
+	for i := 0; i < b.N; i++ {
+		_, _ = cppbridge.BuildNXDomainInto(packet, frame)
+	}
+}
+
+// BenchmarkCPPBuildAResponseInPlace C++ A 记录响应在查询帧上原地改写 (0 allocs/op)
+func BenchmarkCPPBuildAResponseInPlace(b *testing.B) {
+	query := buildTestQuery("redirect.example.com")
+	frame := make([]byte, 2048)
+	ip := uint32(0xC0A80164) // 192.168.1.100
+
+	b.ResetTimer()
+	b.ReportAllocs()
+
+	for i := 0; i < b.N; i++ {
+		n := copy(frame, query)
+		_, _ = cppbridge.BuildAResponseInto(frame[:n], ip, 300, frame)
+	}
+}
+
+// BenchmarkCPPBuildAAAAResponseInto C++ AAAA 记录响应写入复用缓冲区 (0 allocs/op)
+func BenchmarkCPPBuildAAAAResponseInto(b *testing.B) {
+	packet := buildTestQuery("redirect.example.com")
+	frame := make([]byte, 2048)
+	ipv6 := make([]byte, 16)
+	ipv6[0], ipv6[1], ipv6[15] = 0x20, 0x01, 0x01
+
+	b.ResetTimer()
+	b.ReportAllocs()
+
+	for i := 0; i < b.N; i++ {
+		_, _ = cppbridge.BuildAAAAResponseInto(packet, ipv6, 300, frame)
+	}
+}
+
+// 构建 VLAN + IPv4 + UDP 以太网帧
+func buildTestFrame(domain string) []byte {
+	dns := buildTestQuery(domain)
+	udpLen := 8 + len(dns)
+	frame := []byte{
+		0x02, 0, 0, 0, 0, 0x01, 0x02, 0, 0, 0, 0, 0x02,
+		0x81, 0x00, 0x00, 0x64, // 802.1Q, VLAN 100
+		0x08, 0x00,
+		0x45, 0, byte((20 + udpLen) >> 8), byte(20 + udpLen), 0, 0, 0, 0, 64, 17, 0, 0,
+		192, 0, 2, 1, 10, 0, 0, 53,
+		0x9c, 0x40, 0x00, 0x35, byte(udpLen >> 8), byte(udpLen), 0, 0,
+	}
+	return append(frame, dns...)
+}
+
+// BenchmarkCPPParseFrame C++ L2-L4 帧解析 (0 allocs/op)
+func BenchmarkCPPParseFrame(b *testing.B) {
+	frame := buildTestFrame("www.example.com")
+	var info cppbridge.FrameInfo
+
+	b.ResetTimer()
+	b.ReportAllocs()
+
+	for i := 0; i < b.N; i++ {
+		if err := cppbridge.ParseFrame(frame, &info); err != nil {
+			b.Fatal(err)
+		}
+	}
+}
+
+// BenchmarkCPPParseFrames 一批 64 个 UMEM 帧一次 cgo 调用, 按帧计时
+func BenchmarkCPPParseFrames(b *testing.B) {
+	const frameSize = 2048
+	frame := buildTestFrame("www.example.com")
+	umem := make([]byte, cppbridge.MaxFrameBatch*frameSize)
+	descs := make([]cppbridge.FrameDesc, cppbridge.MaxFrameBatch)
+	for i := range descs {
+		copy(umem[i*frameSize:], frame)
+		descs[i] = cppbridge.FrameDesc{Addr: uint64(i * frameSize), Len: uint32(len(frame))}
+	}
+	out := make([]cppbridge.FrameInfo, cppbridge.MaxFrameBatch)
+
+	b.ResetTimer()
+	b.ReportAllocs()
+
+	for i := 0; i < b.N; i += cppbridge.MaxFrameBatch {
+		ok, err := cppbridge.ParseFrames(umem, descs, out)
+		if err != nil || ok != ^uint64(0) {
+			b.Fatal(ok, err)
+		}
+	}
+}
+
 // BenchmarkHybridProcess 混合架构端到端测试
 func BenchmarkHybridProcess(b *testing.B) {
 	engine, _ := filter.NewEngine("")
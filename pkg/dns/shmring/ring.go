@@ -0,0 +1,308 @@
+// Package shmring 是 C++ 数据面共享内存环的 Go 端
+//
+// C++ Dataplane (cpp/include/xdp_dns/dataplane.hpp) 的 worker 线程独占数据路径,
+// 与 Go 控制面只通过 /dev/shm 中的 SPSC 环交互: Go 在控制环上推送规则增量
+// 与配置变更, 在每个 worker 的事件环上读取采样 / 日志事件. 映射之后的收发
+// 只有原子读写, 不经过 cgo, 也不做系统调用.
+//
+// 布局与协议见 cpp/include/xdp_dns/ring_shm.h.
+package shmring
+
+import (
+	"errors"
+	"fmt"
+	"os"
+	"path/filepath"
+	"sync"
+	"sync/atomic"
+	"syscall"
+	"unsafe"
+)
+
+// 与 cpp/include/xdp_dns/ring_shm.h 保持一致
+const (
+	Magic       = 0x474e5258 // "XRNG"
+	Version     = 1
+	MaxWorkers  = 64
+	DefaultName = "/xdp_dns_ring"
+
+	regionHeaderSize = 64
+	ringHeaderSize   = 192
+	regionSize       = regionHeaderSize + ringHeaderSize*(MaxWorkers+1)
+
+	// XDPDNSRingHeader 中的 uint64 下标
+	ringSlotsOffsetWord = 1
+	ringHeadWord        = 8
+	ringDroppedWord     = 9
+	ringTailWord        = 16
+)
+
+// 消息类型 (XDPDNSRingMsgType)
+const (
+	EventSample = 1 // 每 sample_interval 个查询采样一个
+	EventLog    = 2 // 命中 Log 规则
+
+	CtrlAddRule    = 16
+	CtrlRemoveRule = 17
+	CtrlLoadRules  = 18 // Domain 为 RuleSet YAML 路径
+	CtrlSetSample  = 19 // Value 为新的采样间隔, 0 关闭
+)
+
+var (
+	ErrBadMagic   = errors.New("shm ring: bad magic")
+	ErrVersion    = errors.New("shm ring: unsupported version")
+	ErrTooSmall   = errors.New("shm ring: region too small")
+	ErrLayout     = errors.New("shm ring: inconsistent layout")
+	ErrFull       = errors.New("shm ring: control ring full")
+	ErrDomainLong = errors.New("shm ring: domain too long")
+)
+
+// Msg 环中的一条记录 (对应 XDPDNSRingMsg, 内存布局逐字节一致)
+type Msg struct {
+	Type        uint16
+	QType       uint16
+	DomainLen   uint16
+	Action      uint8 // XDPDNSAction
+	BlockMode   uint8 // XDPDNSBlockMode (CtrlAddRule 与事件)
+	ID          uint32
+	RedirectIP  uint32 // 网络字节序
+	TTL         uint32
+	Value       uint32 // 事件: worker 序号; CtrlSetSample: 采样间隔
+	TimestampNS uint64
+	RuleID      [32]byte
+	DomainBuf   [256]byte // NUL 结尾
+}
+
+const msgSize = int(unsafe.Sizeof(Msg{}))
+
+// Domain 返回域名 (会分配字符串)
+func (m *Msg) Domain() string {
+	n := int(m.DomainLen)
+	if n > len(m.DomainBuf) {
+		n = len(m.DomainBuf)
+	}
+	return string(m.DomainBuf[:n])
+}
+
+// RuleIDString 返回 rule_id (会分配字符串)
+func (m *Msg) RuleIDString() string {
+	for i, c := range m.RuleID {
+		if c == 0 {
+			return string(m.RuleID[:i])
+		}
+	}
+	return string(m.RuleID[:])
+}
+
+func (m *Msg) setDomain(domain string) error {
+	if len(domain) >= len(m.DomainBuf) {
+		return ErrDomainLong
+	}
+	copy(m.DomainBuf[:], domain)
+	m.DomainBuf[len(domain)] = 0
+	m.DomainLen = uint16(len(domain))
+	return nil
+}
+
+// AddRuleMsg 构造添加规则的控制消息
+//
+// blockMode 为 XDPDNSBlockMode, 仅对阻断规则有效 (0 为 NXDOMAIN)
+func AddRuleMsg(domain string, id uint32, action, blockMode uint8, redirectIP, ttl uint32, ruleID string) (Msg, error) {
+	m := Msg{Type: CtrlAddRule, ID: id, Action: action, BlockMode: blockMode, RedirectIP: redirectIP, TTL: ttl}
+	copy(m.RuleID[:len(m.RuleID)-1], ruleID)
+	return m, m.setDomain(domain)
+}
+
+// RemoveRuleMsg 构造按域名删除规则的控制消息
+func RemoveRuleMsg(domain string) (Msg, error) {
+	m := Msg{Type: CtrlRemoveRule}
+	return m, m.setDomain(domain)
+}
+
+// LoadRulesMsg 构造从文件整体替换规则的控制消息
+func LoadRulesMsg(path string) (Msg, error) {
+	m := Msg{Type: CtrlLoadRules}
+	return m, m.setDomain(path)
+}
+
+// SetSampleMsg 构造修改采样间隔的控制消息
+func SetSampleMsg(interval uint32) Msg {
+	return Msg{Type: CtrlSetSample, Value: interval}
+}
+
+// ring 单个 SPSC 环的一端
+type ring struct {
+	hdr        []uint64
+	slots      []Msg
+	mask       uint64
+	cachedPeer uint64 // 生产者缓存 tail, 消费者缓存 head
+}
+
+func (r *ring) push(m *Msg) bool {
+	head := atomic.LoadUint64(&r.hdr[ringHeadWord])
+	if head-r.cachedPeer > r.mask {
+		r.cachedPeer = atomic.LoadUint64(&r.hdr[ringTailWord])
+		if head-r.cachedPeer > r.mask {
+			atomic.AddUint64(&r.hdr[ringDroppedWord], 1)
+			return false
+		}
+	}
+	r.slots[head&r.mask] = *m
+	atomic.StoreUint64(&r.hdr[ringHeadWord], head+1)
+	return true
+}
+
+func (r *ring) pop(m *Msg) bool {
+	tail := atomic.LoadUint64(&r.hdr[ringTailWord])
+	if tail >= r.cachedPeer {
+		r.cachedPeer = atomic.LoadUint64(&r.hdr[ringHeadWord])
+		if tail >= r.cachedPeer {
+			return false
+		}
+	}
+	*m = r.slots[tail&r.mask]
+	atomic.StoreUint64(&r.hdr[ringTailWord], tail+1)
+	return true
+}
+
+// Channel 映射 C++ Dataplane 创建的共享内存环
+//
+// Send 可并发调用 (内部串行化为单生产者); Poll 只能由一个 goroutine 调用.
+type Channel struct {
+	data    []byte
+	control ring
+	events  []ring
+	sendMu  sync.Mutex
+	next    int
+}
+
+// Open 映射 /dev/shm/<name> 并校验 magic、版本与各环的范围
+func Open(name string) (*Channel, error) {
+	if name == "" {
+		name = DefaultName
+	}
+	path := filepath.Join("/dev/shm", filepath.Base(name))
+
+	f, err := os.OpenFile(path, os.O_RDWR, 0)
+	if err != nil {
+		return nil, err
+	}
+	defer f.Close()
+
+	st, err := f.Stat()
+	if err != nil {
+		return nil, err
+	}
+	size := int(st.Size())
+	if size < regionSize {
+		return nil, ErrTooSmall
+	}
+
+	data, err := syscall.Mmap(int(f.Fd()), 0, size, syscall.PROT_READ|syscall.PROT_WRITE, syscall.MAP_SHARED)
+	if err != nil {
+		return nil, fmt.Errorf("mmap %s: %w", path, err)
+	}
+
+	c := &Channel{data: data}
+	if err := c.init(); err != nil {
+		syscall.Munmap(data)
+		return nil, err
+	}
+	return c, nil
+}
+
+func (c *Channel) init() error {
+	words := unsafe.Slice((*uint64)(unsafe.Pointer(&c.data[0])), len(c.data)/8)
+
+	// magic 与 version 位于第 0 个字, magic 由创建者最后写入
+	head := atomic.LoadUint64(&words[0])
+	if uint32(head) != Magic {
+		return ErrBadMagic
+	}
+	if uint32(head>>32) != Version {
+		return ErrVersion
+	}
+	numRings := int(uint32(words[1] >> 32))
+	if int(uint32(words[2])) != msgSize || numRings > MaxWorkers {
+		return ErrLayout
+	}
+
+	var err error
+	if c.control, err = c.ring(0); err != nil {
+		return err
+	}
+	c.events = make([]ring, numRings)
+	for i := range c.events {
+		if c.events[i], err = c.ring(i + 1); err != nil {
+			return err
+		}
+	}
+	return nil
+}
+
+// ring 返回第 idx 个环头 (0 为控制环) 对应的视图
+func (c *Channel) ring(idx int) (ring, error) {
+	off := regionHeaderSize + idx*ringHeaderSize
+	hdr := unsafe.Slice((*uint64)(unsafe.Pointer(&c.data[off])), ringHeaderSize/8)
+
+	capacity := uint64(uint32(hdr[0]))
+	slotsOff := hdr[ringSlotsOffsetWord]
+	if capacity == 0 || capacity&(capacity-1) != 0 || slotsOff < regionSize ||
+		slotsOff+capacity*uint64(msgSize) > uint64(len(c.data)) {
+		return ring{}, ErrLayout
+	}
+
+	slots := unsafe.Slice((*Msg)(unsafe.Pointer(&c.data[slotsOff])), int(capacity))
+	return ring{hdr: hdr, slots: slots, mask: capacity - 1}, nil
+}
+
+// NumWorkers 返回事件环数 (= C++ worker 数)
+func (c *Channel) NumWorkers() int {
+	return len(c.events)
+}
+
+// Send 在控制环上推送一条消息; 环满返回 ErrFull (消息未发送)
+func (c *Channel) Send(m *Msg) error {
+	c.sendMu.Lock()
+	defer c.sendMu.Unlock()
+	if !c.control.push(m) {
+		return ErrFull
+	}
+	return nil
+}
+
+// Poll 轮流读取各事件环, 最多写入 len(out) 条, 返回条数; 不阻塞
+func (c *Channel) Poll(out []Msg) int {
+	n := 0
+	for i := 0; i < len(c.events) && n < len(out); i++ {
+		r := &c.events[(c.next+i)%len(c.events)]
+		for n < len(out) && r.pop(&out[n]) {
+			n++
+		}
+	}
+	if len(c.events) > 0 {
+		c.next = (c.next + 1) % len(c.events)
+	}
+	return n
+}
+
+// Dropped 返回各事件环因满而丢弃的事件总数
+func (c *Channel) Dropped() uint64 {
+	var total uint64
+	for i := range c.events {
+		total += atomic.LoadUint64(&c.events[i].hdr[ringDroppedWord])
+	}
+	return total
+}
+
+// Close 解除映射 (共享内存对象由 C++ 创建者删除)
+func (c *Channel) Close() error {
+	if c.data == nil {
+		return nil
+	}
+	err := syscall.Munmap(c.data)
+	c.data = nil
+	c.events = nil
+	c.control = ring{}
+	return err
+}
@@ -46,19 +46,27 @@ type RuleSet struct {
 	Rules       []RuleConfig      `yaml:"rules"`        // 规则列表
 	IPBlacklist []string          `yaml:"ip_blacklist"` // IP黑名单
 	RateLimits  []RateLimitConfig `yaml:"rate_limits"`  // 速率限制
+	AnyPolicy   string            `yaml:"any_policy"`   // ANY 查询: forward / hinfo / truncate (C++ 数据面)
+	AnyTTL      uint32            `yaml:"any_ttl"`      // HINFO 回答的 TTL
+	LocalZones  []string          `yaml:"local_zones"`  // 本地权威区顶点 (C++ 数据面)
+	LocalData   []string          `yaml:"local_data"`   // 区内记录: "name [ttl] [IN] type rdata"
+	RPZFiles    []string          `yaml:"rpz_files"`    // RPZ 区文件: "路径 [区名]" (C++ 数据面)
 }
 
 // RuleConfig YAML规则配置
 type RuleConfig struct {
-	ID          string   `yaml:"id"`
-	Priority    int      `yaml:"priority"`
-	Enabled     bool     `yaml:"enabled"`
-	Action      string   `yaml:"action"`
-	Domains     []string `yaml:"domains"`
-	QueryTypes  []string `yaml:"query_types"`
-	RedirectIP  string   `yaml:"redirect_ip"`
-	RedirectTTL uint32   `yaml:"redirect_ttl"`
-	Description string   `yaml:"description"`
+	ID            string   `yaml:"id"`
+	Priority      int      `yaml:"priority"`
+	Enabled       bool     `yaml:"enabled"`
+	Action        string   `yaml:"action"`
+	Domains       []string `yaml:"domains"`
+	QueryTypes    []string `yaml:"query_types"`
+	RedirectIP    string   `yaml:"redirect_ip"`
+	RedirectTTL   uint32   `yaml:"redirect_ttl"`
+	RedirectIPs   []string `yaml:"redirect_ips"`   // 多个重定向地址, 轮流排在最前 (C++ 数据面)
+	RedirectCNAME string   `yaml:"redirect_cname"` // 先回答 CNAME 再回答地址 (C++ 数据面)
+	BlockMode     string   `yaml:"block_mode"`     // 阻断应答: nxdomain / nodata / refused / null / drop (C++ 数据面)
+	Description   string   `yaml:"description"`
 }
 
 // RateLimitConfig 速率限制配置
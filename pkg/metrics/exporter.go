@@ -81,6 +81,7 @@ func init() {
 // Exporter Prometheus 指标导出器
 type Exporter struct {
 	collector *Collector
+	shm       *ShmReader
 	server    *http.Server
 	addr      string
 	path      string
@@ -121,8 +122,25 @@ func (e *Exporter) Start() error {
 	return e.server.ListenAndServe()
 }
 
+// EnableCppStats 映射 C++ 共享内存统计区, 抓取时直接读取 (无 cgo)
+func (e *Exporter) EnableCppStats(name string) error {
+	reader, err := OpenShmReader(name)
+	if err != nil {
+		return err
+	}
+	if err := prometheus.Register(&shmCollector{reader: reader}); err != nil {
+		reader.Close()
+		return err
+	}
+	e.shm = reader
+	return nil
+}
+
 // Stop 停止服务器
 func (e *Exporter) Stop(ctx context.Context) error {
+	if e.shm != nil {
+		e.shm.Close()
+	}
 	if e.server != nil {
 		return e.server.Shutdown(ctx)
 	}
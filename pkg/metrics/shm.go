@@ -0,0 +1,325 @@
+package metrics
+
+import (
+	"errors"
+	"fmt"
+	"os"
+	"path/filepath"
+	"strconv"
+	"sync"
+	"sync/atomic"
+	"syscall"
+	"time"
+	"unsafe"
+
+	"github.com/prometheus/client_golang/prometheus"
+)
+
+// 与 cpp/include/xdp_dns/stats_shm.h 保持一致
+const (
+	ShmMagic       = 0x534e4458 // "XDNS"
+	ShmVersion     = 1
+	ShmMaxCores    = 128
+	ShmHistBuckets = 64
+	ShmDefaultName = "/xdp_dns_stats"
+
+	shmSeqWord   = 2 // seq 在区域中的 uint64 下标
+	shmReadRetry = 1000
+)
+
+var (
+	ErrShmBadMagic     = errors.New("shm stats: bad magic")
+	ErrShmVersion      = errors.New("shm stats: unsupported version")
+	ErrShmTooSmall     = errors.New("shm stats: region too small")
+	ErrShmInconsistent = errors.New("shm stats: no consistent snapshot")
+)
+
+// ShmCounters C++ 计数器 (对应 XDPDNSShmCounters)
+type ShmCounters struct {
+	PacketsReceived   uint64
+	PacketsParsed     uint64
+	PacketsAllowed    uint64
+	PacketsBlocked    uint64
+	PacketsRedirected uint64
+	ParseErrors       uint64
+	ResponseBuilt     uint64
+	SampledLatencyNS  uint64 // 采样包的延迟之和, 与 LatencySamples 对应
+}
+
+// ShmMemory C++ 内存占用 (对应 XDPDNSShmMemory)
+type ShmMemory struct {
+	NodeBytes     uint64
+	LabelBytes    uint64
+	RuleBytes     uint64
+	CacheBytes    uint64
+	IndexBytes    uint64
+	ReservedBytes uint64
+	Allocations   uint64
+	RuleCount     uint64
+}
+
+// ShmStats 共享内存统计区快照 (对应 XDPDNSShmStats, 内存布局逐字节一致)
+type ShmStats struct {
+	Magic            uint32
+	Version          uint32
+	Size             uint32
+	NumCores         uint32
+	Seq              uint64
+	PublishCount     uint64
+	PublishTimeNS    uint64
+	StartTimeNS      uint64
+	RuleGeneration   uint64
+	RuleCount        uint64
+	RuleUpdateTimeNS uint64
+	_                [7]uint64
+
+	Total ShmCounters
+	Cores [ShmMaxCores]ShmCounters
+
+	// 桶 i 统计 [2^(i-1), 2^i) ns, 桶 0 为 0ns
+	LatencySamples uint64
+	LatencyHist    [ShmHistBuckets]uint64
+
+	Memory ShmMemory
+}
+
+const shmStatsSize = int(unsafe.Sizeof(ShmStats{}))
+
+// ShmReader 只读映射 C++ 发布的统计区, 读取时无系统调用、无锁、无 cgo
+type ShmReader struct {
+	data  []byte
+	words []uint64
+}
+
+// OpenShmReader 映射 /dev/shm/<name> 并校验 magic 和版本
+func OpenShmReader(name string) (*ShmReader, error) {
+	if name == "" {
+		name = ShmDefaultName
+	}
+	path := filepath.Join("/dev/shm", filepath.Base(name))
+
+	f, err := os.Open(path)
+	if err != nil {
+		return nil, err
+	}
+	defer f.Close()
+
+	st, err := f.Stat()
+	if err != nil {
+		return nil, err
+	}
+	if st.Size() < int64(shmStatsSize) {
+		return nil, ErrShmTooSmall
+	}
+
+	data, err := syscall.Mmap(int(f.Fd()), 0, shmStatsSize, syscall.PROT_READ, syscall.MAP_SHARED)
+	if err != nil {
+		return nil, fmt.Errorf("mmap %s: %w", path, err)
+	}
+
+	r := &ShmReader{
+		data:  data,
+		words: unsafe.Slice((*uint64)(unsafe.Pointer(&data[0])), shmStatsSize/8),
+	}
+
+	// magic 与 version 位于第 0 个字
+	head := atomic.LoadUint64(&r.words[0])
+	if uint32(head) != ShmMagic {
+		r.Close()
+		return nil, ErrShmBadMagic
+	}
+	if uint32(head>>32) != ShmVersion {
+		r.Close()
+		return nil, ErrShmVersion
+	}
+	return r, nil
+}
+
+// Read 读取一致的快照 (seqlock 读端)
+func (r *ShmReader) Read(out *ShmStats) error {
+	if r.words == nil {
+		return ErrShmInconsistent
+	}
+	dst := unsafe.Slice((*uint64)(unsafe.Pointer(out)), shmStatsSize/8)
+
+	for attempt := 0; attempt < shmReadRetry; attempt++ {
+		s1 := atomic.LoadUint64(&r.words[shmSeqWord])
+		if s1&1 != 0 {
+			continue
+		}
+		for i := range r.words {
+			dst[i] = atomic.LoadUint64(&r.words[i])
+		}
+		if atomic.LoadUint64(&r.words[shmSeqWord]) == s1 {
+			out.Seq = s1
+			return nil
+		}
+	}
+	return ErrShmInconsistent
+}
+
+// Close 解除映射
+func (r *ShmReader) Close() error {
+	if r.data == nil {
+		return nil
+	}
+	err := syscall.Munmap(r.data)
+	r.data = nil
+	r.words = nil
+	return err
+}
+
+// ==================== Prometheus 采集 ====================
+
+var (
+	cppPacketsDesc = prometheus.NewDesc(
+		"xdp_dns_cpp_packets_total",
+		"Packets seen by the C++ core, by stage",
+		[]string{"stage"}, nil)
+
+	cppCorePacketsDesc = prometheus.NewDesc(
+		"xdp_dns_cpp_core_packets_received_total",
+		"Packets received by the C++ core, per CPU slot",
+		[]string{"core"}, nil)
+
+	cppLatencyDesc = prometheus.NewDesc(
+		"xdp_dns_cpp_latency_seconds",
+		"Sampled per-packet C++ processing latency",
+		nil, nil)
+
+	cppRuleGenerationDesc = prometheus.NewDesc(
+		"xdp_dns_cpp_rule_generation",
+		"Rule generation published by the C++ core",
+		nil, nil)
+
+	cppRuleCountDesc = prometheus.NewDesc(
+		"xdp_dns_cpp_rules",
+		"Rule count published by the C++ core",
+		nil, nil)
+
+	cppMemoryBytesDesc = prometheus.NewDesc(
+		"xdp_dns_cpp_memory_bytes",
+		"Bytes requested by the C++ filter structures, by category",
+		[]string{"category"}, nil)
+
+	cppMemoryReservedDesc = prometheus.NewDesc(
+		"xdp_dns_cpp_memory_reserved_bytes",
+		"Bytes actually held by the C++ filter structures, including allocator overhead",
+		nil, nil)
+
+	cppMemoryBytesPerRuleDesc = prometheus.NewDesc(
+		"xdp_dns_cpp_memory_bytes_per_rule",
+		"Reserved bytes per loaded rule",
+		nil, nil)
+
+	cppMemoryFragmentationDesc = prometheus.NewDesc(
+		"xdp_dns_cpp_memory_fragmentation_ratio",
+		"1 - requested / reserved bytes",
+		nil, nil)
+
+	cppPublishAgeDesc = prometheus.NewDesc(
+		"xdp_dns_cpp_stats_age_seconds",
+		"Seconds since the C++ core last published its stats",
+		nil, nil)
+)
+
+// shmCollector 在抓取时读取共享内存, 不在数据面引入任何 cgo 调用
+type shmCollector struct {
+	reader *ShmReader
+	mu     sync.Mutex
+	snap   ShmStats
+}
+
+func (c *shmCollector) Describe(ch chan<- *prometheus.Desc) {
+	ch <- cppPacketsDesc
+	ch <- cppCorePacketsDesc
+	ch <- cppLatencyDesc
+	ch <- cppRuleGenerationDesc
+	ch <- cppRuleCountDesc
+	ch <- cppMemoryBytesDesc
+	ch <- cppMemoryReservedDesc
+	ch <- cppMemoryBytesPerRuleDesc
+	ch <- cppMemoryFragmentationDesc
+	ch <- cppPublishAgeDesc
+}
+
+func (c *shmCollector) Collect(ch chan<- prometheus.Metric) {
+	c.mu.Lock()
+	defer c.mu.Unlock()
+
+	s := &c.snap
+	if err := c.reader.Read(s); err != nil {
+		return
+	}
+
+	stages := []struct {
+		name  string
+		value uint64
+	}{
+		{"received", s.Total.PacketsReceived},
+		{"parsed", s.Total.PacketsParsed},
+		{"parse_error", s.Total.ParseErrors},
+		{"response_built", s.Total.ResponseBuilt},
+	}
+	for _, st := range stages {
+		ch <- prometheus.MustNewConstMetric(cppPacketsDesc, prometheus.CounterValue,
+			float64(st.value), st.name)
+	}
+
+	for i := uint32(0); i < s.NumCores && i < ShmMaxCores; i++ {
+		if s.Cores[i].PacketsReceived == 0 {
+			continue
+		}
+		ch <- prometheus.MustNewConstMetric(cppCorePacketsDesc, prometheus.CounterValue,
+			float64(s.Cores[i].PacketsReceived), strconv.Itoa(int(i)))
+	}
+
+	// 桶 i 的上界为 2^i ns; 最后一个桶并入 +Inf
+	buckets := make(map[float64]uint64, ShmHistBuckets-1)
+	var cumulative uint64
+	for i := 0; i < ShmHistBuckets-1; i++ {
+		cumulative += s.LatencyHist[i]
+		buckets[float64(uint64(1)<<uint(i))/1e9] = cumulative
+	}
+	ch <- prometheus.MustNewConstHistogram(cppLatencyDesc, s.LatencySamples,
+		float64(s.Total.SampledLatencyNS)/1e9, buckets)
+
+	ch <- prometheus.MustNewConstMetric(cppRuleGenerationDesc, prometheus.GaugeValue,
+		float64(s.RuleGeneration))
+	ch <- prometheus.MustNewConstMetric(cppRuleCountDesc, prometheus.GaugeValue,
+		float64(s.RuleCount))
+
+	m := &s.Memory
+	categories := []struct {
+		name  string
+		value uint64
+	}{
+		{"nodes", m.NodeBytes},
+		{"labels", m.LabelBytes},
+		{"rules", m.RuleBytes},
+		{"cache", m.CacheBytes},
+		{"index", m.IndexBytes},
+	}
+	var requested uint64
+	for _, c := range categories {
+		requested += c.value
+		ch <- prometheus.MustNewConstMetric(cppMemoryBytesDesc, prometheus.GaugeValue,
+			float64(c.value), c.name)
+	}
+	ch <- prometheus.MustNewConstMetric(cppMemoryReservedDesc, prometheus.GaugeValue,
+		float64(m.ReservedBytes))
+
+	var perRule, fragmentation float64
+	if m.RuleCount > 0 {
+		perRule = float64(m.ReservedBytes) / float64(m.RuleCount)
+	}
+	if m.ReservedBytes > requested {
+		fragmentation = 1 - float64(requested)/float64(m.ReservedBytes)
+	}
+	ch <- prometheus.MustNewConstMetric(cppMemoryBytesPerRuleDesc, prometheus.GaugeValue, perRule)
+	ch <- prometheus.MustNewConstMetric(cppMemoryFragmentationDesc, prometheus.GaugeValue,
+		fragmentation)
+
+	age := time.Since(time.Unix(0, int64(s.PublishTimeNS))).Seconds()
+	ch <- prometheus.MustNewConstMetric(cppPublishAgeDesc, prometheus.GaugeValue, age)
+}
@@ -0,0 +1,108 @@
+package main
+
+import (
+	"fmt"
+
+	"xdp-dns/pkg/config"
+	"xdp-dns/pkg/dns/cppbridge"
+	"xdp-dns/xdp"
+)
+
+// cppDataplane C++ 数据面及其依赖, 按创建的逆序关闭
+type cppDataplane struct {
+	engine *cppbridge.Engine
+	cache  *cppbridge.Cache
+	fwd    *cppbridge.Forwarder
+	dp     *cppbridge.Dataplane
+}
+
+func (c *cppDataplane) Close() {
+	if c.dp != nil {
+		c.dp.Close()
+	}
+	if c.fwd != nil {
+		c.fwd.Close()
+	}
+	if c.cache != nil {
+		c.cache.Close()
+	}
+	if c.engine != nil {
+		c.engine.Close()
+	}
+}
+
+// startDataplane 把 socket 的四个环交给一个 C++ worker 并启动数据面
+//
+// 之后 socket 只用于保持映射与关闭, 不能再调用 Fill / Receive / Transmit.
+// 规则由 C++ 引擎从 cfg.RulesPath 加载, 引擎自己发布规则信息到统计区.
+func startDataplane(cfg *config.Config, socket *xdp.Socket, mtu int) (*cppDataplane, error) {
+	c := &cppDataplane{}
+	ok := false
+	defer func() {
+		if !ok {
+			c.Close()
+		}
+	}()
+
+	var err error
+	if c.engine, err = cppbridge.NewEngine(nil); err != nil {
+		return nil, fmt.Errorf("create engine: %w", err)
+	}
+	if err := c.engine.LoadRulesFile(cfg.RulesPath); err != nil {
+		return nil, fmt.Errorf("load rules %s: %w", cfg.RulesPath, err)
+	}
+
+	if cfg.Dataplane.Cache && cfg.DNS.CacheSize > 0 {
+		c.cache, err = cppbridge.NewCache(cppbridge.CacheOptions{
+			Capacity: uint32(cfg.DNS.CacheSize),
+			MaxTTL:   uint32(cfg.DNS.CacheTTL.Seconds()),
+		})
+		if err != nil {
+			return nil, fmt.Errorf("create cache: %w", err)
+		}
+	}
+	if cfg.Dataplane.Forward {
+		c.fwd, err = cppbridge.NewForwarder(cppbridge.ForwarderOptions{
+			Servers:   cfg.DNS.UpstreamServers,
+			NumOwners: 1,
+		})
+		if err != nil {
+			return nil, fmt.Errorf("create forwarder: %w", err)
+		}
+	}
+
+	c.dp, err = cppbridge.NewDataplane(c.engine, cppbridge.DataplaneOptions{
+		ShmName:        cfg.Dataplane.ShmName,
+		NumWorkers:     1,
+		SampleInterval: cfg.Dataplane.SampleInterval,
+		Cache:          c.cache,
+		Forwarder:      c.fwd,
+	})
+	if err != nil {
+		return nil, fmt.Errorf("create dataplane: %w", err)
+	}
+
+	ring := func(r xdp.RingInfo) cppbridge.XskRing {
+		return cppbridge.XskRing{Producer: r.Producer, Consumer: r.Consumer, Descs: r.Descs, Size: r.Size}
+	}
+	fill, completion, rx, tx := socket.Rings()
+	err = c.dp.AddXsk(0, cppbridge.XskConfig{
+		FD:         socket.FD(),
+		UMEM:       socket.UMEM(),
+		FrameSize:  uint32(socket.FrameSize()),
+		MTU:        uint32(mtu),
+		Fill:       ring(fill),
+		Completion: ring(completion),
+		Rx:         ring(rx),
+		Tx:         ring(tx),
+	})
+	if err != nil {
+		return nil, fmt.Errorf("attach AF_XDP socket: %w", err)
+	}
+	if err := c.dp.Start(); err != nil {
+		return nil, fmt.Errorf("start dataplane: %w", err)
+	}
+
+	ok = true
+	return c, nil
+}
@@ -15,6 +15,7 @@ import (
 	"xdp-dns/internal/worker"
 	"xdp-dns/pkg/config"
 	"xdp-dns/pkg/dns"
+	"xdp-dns/pkg/dns/cppbridge"
 	"xdp-dns/pkg/filter"
 	"xdp-dns/pkg/metrics"
 	"xdp-dns/xdp"
@@ -77,6 +78,21 @@ func main() {
 		CompletionRingNumDescs: cfg.XDP.CompletionRingNumDescs,
 		RxRingNumDescs:         cfg.XDP.RxRingNumDescs,
 		TxRingNumDescs:         cfg.XDP.TxRingNumDescs,
+		HugePages:              cfg.Memory.HugePages,
+	}
+
+	numaNode, err := cfg.Memory.ResolveNUMANode(xdp.NetdevNUMANode(cfg.Interface))
+	if err != nil {
+		log.Fatalf("Invalid memory config: %v", err)
+	}
+	if numaNode >= 0 {
+		socketOpts.BindNUMA = true
+		socketOpts.NUMANode = numaNode
+	}
+
+	// 同一放置用于之后创建的 C++ Trie / 过滤引擎 Arena
+	if err := cppbridge.SetMemoryOptions(cfg.Memory.HugePages, numaNode); err != nil {
+		log.Fatalf("Invalid memory config for C++ arenas (NUMA node %d): %v", numaNode, err)
 	}
 
 	socket, err := xdp.NewSocket(ifindex, cfg.QueueID, socketOpts)
@@ -90,24 +106,39 @@ func main() {
 		log.Fatalf("Failed to register socket: %v", err)
 	}
 
-	log.Printf("XDP socket created and registered")
-
-	// 初始化过滤引擎
-	filterEngine, err := filter.NewEngine(cfg.RulesPath)
-	if err != nil {
-		log.Fatalf("Failed to init filter engine: %v", err)
+	log.Printf("XDP socket created and registered (UMEM hugetlb: %v, NUMA node: %d)",
+		socket.HugePages(), numaNode)
+
+	// 数据面模式下 C++ worker 独占 socket 的环, 不创建 Go 过滤引擎与 Worker 池
+	var (
+		dataplane  *cppDataplane
+		workerPool *worker.Pool
+	)
+	if cfg.Dataplane.Enabled {
+		dataplane, err = startDataplane(cfg, socket, link.Attrs().MTU)
+		if err != nil {
+			log.Fatalf("Failed to start C++ dataplane: %v", err)
+		}
+		defer dataplane.Close()
+		log.Printf("C++ dataplane started on queue %d (rules: %s)", cfg.QueueID, cfg.RulesPath)
+	} else {
+		// 初始化过滤引擎
+		filterEngine, err := filter.NewEngine(cfg.RulesPath)
+		if err != nil {
+			log.Fatalf("Failed to init filter engine: %v", err)
+		}
+		log.Printf("Filter engine initialized with %d rules", len(filterEngine.GetRules()))
+
+		// 创建 Worker 池
+		workerPool = worker.NewPool(worker.PoolOptions{
+			NumWorkers:   cfg.Workers.NumWorkers,
+			BatchSize:    cfg.Workers.BatchSize,
+			Socket:       socket,
+			FilterEngine: filterEngine,
+			DNSParser:    dns.NewParser(),
+			Metrics:      metricsCollector,
+		})
 	}
-	log.Printf("Filter engine initialized with %d rules", len(filterEngine.GetRules()))
-
-	// 创建 Worker 池
-	workerPool := worker.NewPool(worker.PoolOptions{
-		NumWorkers:   cfg.Workers.NumWorkers,
-		BatchSize:    cfg.Workers.BatchSize,
-		Socket:       socket,
-		FilterEngine: filterEngine,
-		DNSParser:    dns.NewParser(),
-		Metrics:      metricsCollector,
-	})
 
 	// 启动上下文
 	ctx, cancel := context.WithCancel(context.Background())
@@ -115,6 +146,19 @@ func main() {
 	// 启动 metrics 服务器
 	if cfg.Metrics.Enabled {
 		exporter := metrics.NewExporter(metricsCollector, cfg.Metrics.Listen, cfg.Metrics.Path)
+		// 统计区的包计数只由 C++ 数据面写入; Go Worker 池模式下不创建,
+		// 以免导出恒为 0 的计数. 规则信息由 C++ 引擎在加载时发布
+		if cfg.Metrics.CppStatsShm != "" && dataplane != nil {
+			// 先创建并发布共享内存统计区, exporter 才能映射它
+			if err := cppbridge.StartStatsShm(cfg.Metrics.CppStatsShm, time.Second); err != nil {
+				log.Printf("C++ stats shm not started: %v", err)
+			} else {
+				defer cppbridge.StopStatsShm()
+				if err := exporter.EnableCppStats(cfg.Metrics.CppStatsShm); err != nil {
+					log.Printf("C++ stats not exported: %v", err)
+				}
+			}
+		}
 		go func() {
 			if err := exporter.Start(); err != nil {
 				log.Printf("Metrics server error: %v", err)
@@ -125,8 +169,10 @@ func main() {
 	}
 
 	// 启动 Worker 池
-	go workerPool.Start(ctx)
-	log.Printf("Worker pool started with %d workers", cfg.Workers.NumWorkers)
+	if workerPool != nil {
+		go workerPool.Start(ctx)
+		log.Printf("Worker pool started with %d workers", cfg.Workers.NumWorkers)
+	}
 
 	// 等待信号
 	sigCh := make(chan os.Signal, 1)
@@ -138,7 +184,15 @@ func main() {
 	log.Println("Shutting down...")
 
 	cancel()
-	workerPool.Wait()
+	if workerPool != nil {
+		workerPool.Wait()
+	}
+	if dataplane != nil {
+		dataplane.dp.Stop()
+		st := dataplane.dp.Stats()
+		log.Printf("Dataplane stats: packets=%d, responded=%d, forwarded=%d, dropped=%d, parse_errors=%d",
+			st.Packets, st.Responded, st.Forwarded, st.Dropped, st.ParseErrors)
+	}
 
 	// 打印统计信息
 	stats := metricsCollector.GetStats()
@@ -0,0 +1,107 @@
+package xdp
+
+import (
+	"fmt"
+	"os"
+	"strconv"
+	"strings"
+	"syscall"
+	"unsafe"
+
+	"golang.org/x/sys/unix"
+)
+
+// NUMANodeAny disables NUMA placement of the UMEM.
+const NUMANodeAny = -1
+
+const (
+	hugePageSize = 2 << 20
+
+	// MPOL_PREFERRED from <linux/mempolicy.h>: fall back to other nodes
+	// instead of failing when the preferred node runs out of memory.
+	mpolPreferred = 1
+)
+
+// mapUmem maps size bytes of anonymous memory to be registered as the UMEM.
+//
+// With hugePages set, the length is rounded up to 2MB and MAP_HUGETLB is
+// tried first; when no hugetlbfs pages are reserved it falls back to regular
+// pages advised with MADV_HUGEPAGE so that THP can back them. With numaNode
+// >= 0 the pages are bound to that node before they are first touched.
+// The returned slice may be longer than size; huge reports whether it is
+// backed by hugetlbfs pages.
+func mapUmem(size int, hugePages bool, numaNode int) (mem []byte, huge bool, err error) {
+	const prot = syscall.PROT_READ | syscall.PROT_WRITE
+	const flags = syscall.MAP_PRIVATE | syscall.MAP_ANONYMOUS
+
+	if !hugePages && numaNode < 0 {
+		mem, err = syscall.Mmap(-1, 0, size, prot, flags|syscall.MAP_POPULATE)
+		return mem, false, err
+	}
+
+	length := size
+	if hugePages {
+		length = (size + hugePageSize - 1) &^ (hugePageSize - 1)
+		mem, err = syscall.Mmap(-1, 0, length, prot, flags|unix.MAP_HUGETLB)
+		huge = err == nil
+	}
+	if !huge {
+		mem, err = syscall.Mmap(-1, 0, length, prot, flags)
+		if err != nil {
+			return nil, false, err
+		}
+		if hugePages {
+			// Best effort: THP may be disabled system-wide.
+			_ = unix.Madvise(mem, unix.MADV_HUGEPAGE)
+		}
+	}
+
+	if numaNode >= 0 {
+		// A single-node kernel built without CONFIG_NUMA rejects mbind;
+		// the memory is local anyway, so the error is not fatal.
+		_ = mbindPreferred(mem, numaNode)
+	}
+
+	// Fault the pages in now (MAP_POPULATE would have done so before mbind).
+	pageSize := os.Getpagesize()
+	if huge {
+		pageSize = hugePageSize
+	}
+	for off := 0; off < len(mem); off += pageSize {
+		mem[off] = 0
+	}
+
+	return mem, huge, nil
+}
+
+func mbindPreferred(mem []byte, node int) error {
+	// The kernel reads maxnode-1 bits, keep a spare word past node.
+	mask := make([]uint64, node/64+2)
+	mask[node/64] = 1 << (uint(node) % 64)
+
+	_, _, errno := unix.Syscall6(unix.SYS_MBIND,
+		uintptr(unsafe.Pointer(&mem[0])), uintptr(len(mem)), mpolPreferred,
+		uintptr(unsafe.Pointer(&mask[0])), uintptr(len(mask)*64), 0)
+	if errno != 0 {
+		return fmt.Errorf("mbind node %d failed: %v", node, errno)
+	}
+	return nil
+}
+
+// NetdevNUMANode returns the NUMA node the network interface is attached to,
+// or NUMANodeAny when it is unknown (virtual devices, single-node hosts).
+func NetdevNUMANode(ifname string) int {
+	if ifname == "" || strings.ContainsRune(ifname, '/') {
+		return NUMANodeAny
+	}
+
+	data, err := os.ReadFile("/sys/class/net/" + ifname + "/device/numa_node")
+	if err != nil {
+		return NUMANodeAny
+	}
+	node, err := strconv.Atoi(strings.TrimSpace(string(data)))
+	if err != nil || node < 0 {
+		return NUMANodeAny
+	}
+	return node
+}
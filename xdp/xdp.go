@@ -154,6 +154,7 @@ type Socket struct {
 	options                  SocketOptions
 	rxDescs                  []Desc
 	getTXDescs, getRXDescs   []Desc
+	umemHugePages            bool
 }
 
 // SocketOptions are configuration settings used to bind an XDP socket.
@@ -164,6 +165,15 @@ type SocketOptions struct {
 	CompletionRingNumDescs int
 	RxRingNumDescs         int
 	TxRingNumDescs         int
+
+	// HugePages backs the UMEM with 2MB pages (MAP_HUGETLB, falling back to
+	// transparent huge pages when no hugetlbfs pages are reserved).
+	HugePages bool
+
+	// BindNUMA places the UMEM on NUMANode, normally the node the NIC is
+	// attached to (see NetdevNUMANode).
+	BindNUMA bool
+	NUMANode int
 }
 
 // Desc represents an XDP Rx/Tx descriptor.
@@ -224,17 +234,21 @@ func NewSocket(Ifindex int, QueueID int, options *SocketOptions) (xsk *Socket, e
 		return nil, fmt.Errorf("syscall.Socket failed: %v", err)
 	}
 
-	xsk.umem, err = syscall.Mmap(-1, 0, options.NumFrames*options.FrameSize,
-		syscall.PROT_READ|syscall.PROT_WRITE,
-		syscall.MAP_PRIVATE|syscall.MAP_ANONYMOUS|syscall.MAP_POPULATE)
+	numaNode := NUMANodeAny
+	if options.BindNUMA {
+		numaNode = options.NUMANode
+	}
+	umemSize := options.NumFrames * options.FrameSize
+	xsk.umem, xsk.umemHugePages, err = mapUmem(umemSize, options.HugePages, numaNode)
 	if err != nil {
 		xsk.Close()
 		return nil, fmt.Errorf("syscall.Mmap failed: %v", err)
 	}
 
+	// With huge pages the mapping is rounded up to 2MB, register only the frames.
 	xdpUmemReg := unix.XDPUmemReg{
 		Addr:     uint64(uintptr(unsafe.Pointer(&xsk.umem[0]))),
-		Len:      uint64(len(xsk.umem)),
+		Len:      uint64(umemSize),
 		Size:     uint32(options.FrameSize),
 		Headroom: 0,
 	}
@@ -501,6 +515,50 @@ func (xsk *Socket) FD() int {
 	return xsk.fd
 }
 
+// HugePages reports whether the UMEM is backed by hugetlbfs pages; false
+// when HugePages was not requested or the THP fallback was used.
+func (xsk *Socket) HugePages() bool {
+	return xsk.umemHugePages
+}
+
+// RingInfo describes one of the socket's mmapped rings, so that another
+// consumer (the C++ dataplane) can drive it directly. Size is a power of two.
+type RingInfo struct {
+	Producer *uint32
+	Consumer *uint32
+	Descs    unsafe.Pointer // []uint64 for fill/completion, []Desc for rx/tx
+	Size     uint32
+}
+
+// Rings returns the fill, completion, rx and tx rings. After handing them to
+// another consumer the caller must no longer call Fill, Receive, Transmit,
+// Complete or Poll on this socket.
+func (xsk *Socket) Rings() (fill, completion, rx, tx RingInfo) {
+	fill = RingInfo{xsk.fillRing.Producer, xsk.fillRing.Consumer,
+		unsafe.Pointer(&xsk.fillRing.Descs[0]), uint32(len(xsk.fillRing.Descs))}
+	completion = RingInfo{xsk.completionRing.Producer, xsk.completionRing.Consumer,
+		unsafe.Pointer(&xsk.completionRing.Descs[0]), uint32(len(xsk.completionRing.Descs))}
+	if len(xsk.rxRing.Descs) > 0 {
+		rx = RingInfo{xsk.rxRing.Producer, xsk.rxRing.Consumer,
+			unsafe.Pointer(&xsk.rxRing.Descs[0]), uint32(len(xsk.rxRing.Descs))}
+	}
+	if len(xsk.txRing.Descs) > 0 {
+		tx = RingInfo{xsk.txRing.Producer, xsk.txRing.Consumer,
+			unsafe.Pointer(&xsk.txRing.Descs[0]), uint32(len(xsk.txRing.Descs))}
+	}
+	return
+}
+
+// UMEM returns the registered UMEM area (NumFrames * FrameSize bytes).
+func (xsk *Socket) UMEM() []byte {
+	return xsk.umem[:xsk.options.NumFrames*xsk.options.FrameSize]
+}
+
+// FrameSize returns the size of each UMEM frame.
+func (xsk *Socket) FrameSize() int {
+	return xsk.options.FrameSize
+}
+
 // Poll blocks until kernel informs us that it has either received
 // or completed (i.e. actually sent) some frames that were previously submitted
 // using Fill() or Transmit() methods.